@@ -29,14 +29,19 @@ namespace zg {
 
 class Context;
 class PipelineRender;
+class PipelineRenderPending;
+class PipelineRenderPermutations;
+class ShaderArchive;
 class MemoryHeap;
 class Buffer;
+class FileRead;
 class TextureHeap;
 class Texture2D;
 class Framebuffer;
 class Fence;
 class CommandQueue;
 class CommandList;
+class TextureStreamer;
 
 
 // Results
@@ -57,7 +62,8 @@ enum class [[nodiscard]] Result : ZgResult {
 	INVALID_ARGUMENT = ZG_ERROR_INVALID_ARGUMENT,
 	SHADER_COMPILE_ERROR = ZG_ERROR_SHADER_COMPILE_ERROR,
 	OUT_OF_COMMAND_LISTS = ZG_ERROR_OUT_OF_COMMAND_LISTS,
-	INVALID_COMMAND_LIST_STATE = ZG_ERROR_INVALID_COMMAND_LIST_STATE
+	INVALID_COMMAND_LIST_STATE = ZG_ERROR_INVALID_COMMAND_LIST_STATE,
+	OUT_OF_DESCRIPTORS = ZG_ERROR_OUT_OF_DESCRIPTORS
 };
 
 constexpr bool isSuccess(Result code) noexcept { return code == Result::SUCCESS; }
@@ -128,6 +134,10 @@ public:
 	// See zgContextGetStats()
 	Result getStats(ZgStats& statsOut) noexcept;
 
+	// See zgContextGetCpuAllocationStats()
+	Result getCpuAllocationStats(
+		ZgCpuAllocationTagStats* statsOut, uint32_t maxNumStats, uint32_t& numStatsOut) noexcept;
+
 	// Private members
 	// --------------------------------------------------------------------------------------------
 private:
@@ -149,6 +159,14 @@ public:
 	const char* pixelShaderPath = nullptr;
 	const char* vertexShaderSrc = nullptr;
 	const char* pixelShaderSrc = nullptr;
+	const void* vertexShaderBytecode = nullptr;
+	uint32_t vertexShaderBytecodeSizeBytes = 0;
+	const void* pixelShaderBytecode = nullptr;
+	uint32_t pixelShaderBytecodeSizeBytes = 0;
+	uint32_t numDefines = 0;
+	ZgShaderDefine defines[ZG_MAX_NUM_SHADER_DEFINES] = {};
+	uint32_t numSpecializationConstants = 0;
+	ZgSpecializationConstant specializationConstants[ZG_MAX_NUM_SPECIALIZATION_CONSTANTS] = {};
 
 	// Constructors & destructors
 	// --------------------------------------------------------------------------------------------
@@ -174,6 +192,8 @@ public:
 
 	PipelineRenderBuilder& addPushConstant(uint32_t constantBufferRegister) noexcept;
 
+	PipelineRenderBuilder& addRootConstantBuffer(uint32_t constantBufferRegister) noexcept;
+
 	PipelineRenderBuilder& addSampler(uint32_t samplerRegister, ZgSampler sampler) noexcept;
 
 	PipelineRenderBuilder& addSampler(
@@ -189,6 +209,14 @@ public:
 	PipelineRenderBuilder& addPixelShaderPath(const char* entry, const char* path) noexcept;
 	PipelineRenderBuilder& addVertexShaderSource(const char* entry, const char* src) noexcept;
 	PipelineRenderBuilder& addPixelShaderSource(const char* entry, const char* src) noexcept;
+	PipelineRenderBuilder& addVertexShaderBytecode(
+		const char* entry, const void* data, uint32_t sizeBytes) noexcept;
+	PipelineRenderBuilder& addPixelShaderBytecode(
+		const char* entry, const void* data, uint32_t sizeBytes) noexcept;
+
+	// Only used when building from HLSL and SPIR-V respectively
+	PipelineRenderBuilder& addDefine(const char* name, const char* value = nullptr) noexcept;
+	PipelineRenderBuilder& addSpecializationConstant(uint32_t constantId, uint32_t value) noexcept;
 
 	PipelineRenderBuilder& setWireframeRendering(bool wireframeEnabled) noexcept;
 	PipelineRenderBuilder& setCullingEnabled(bool cullingEnabled) noexcept;
@@ -212,6 +240,79 @@ public:
 		PipelineRender& pipelineOut, ZgShaderModel model = ZG_SHADER_MODEL_6_0) const noexcept;
 	Result buildFromSourceHLSL(
 		PipelineRender& pipelineOut, ZgShaderModel model = ZG_SHADER_MODEL_6_0) const noexcept;
+
+	// Creates the pipeline from the shader bytecode, which must be SPIR-V or DXIL respectively
+	Result buildFromMemorySPIRV(PipelineRender& pipelineOut) const noexcept;
+	Result buildFromMemoryDXIL(PipelineRender& pipelineOut) const noexcept;
+
+	// Asynchronous versions of the above, see zgPipelineRenderCreateFromFileSPIRVAsync()
+	Result buildFromFileSPIRV(PipelineRenderPending& pendingOut) const noexcept;
+	Result buildFromFileHLSL(
+		PipelineRenderPending& pendingOut, ZgShaderModel model = ZG_SHADER_MODEL_6_0) const noexcept;
+	Result buildFromSourceHLSL(
+		PipelineRenderPending& pendingOut, ZgShaderModel model = ZG_SHADER_MODEL_6_0) const noexcept;
+	Result buildFromMemorySPIRV(PipelineRenderPending& pendingOut) const noexcept;
+	Result buildFromMemoryDXIL(PipelineRenderPending& pendingOut) const noexcept;
+
+	// Permutation set versions of the above, the builder's defines and specialization constants
+	// are the base of each permutation. See zgPipelineRenderPermutationsCreateFromFileSPIRV().
+	Result buildFromFileSPIRV(PipelineRenderPermutations& permutationsOut) const noexcept;
+	Result buildFromFileHLSL(PipelineRenderPermutations& permutationsOut,
+		ZgShaderModel model = ZG_SHADER_MODEL_6_0) const noexcept;
+	Result buildFromSourceHLSL(PipelineRenderPermutations& permutationsOut,
+		ZgShaderModel model = ZG_SHADER_MODEL_6_0) const noexcept;
+	Result buildFromMemorySPIRV(PipelineRenderPermutations& permutationsOut) const noexcept;
+
+	// Creates the pipeline from a shader archive, the shader paths and sources are ignored
+	Result buildFromArchive(
+		PipelineRender& pipelineOut,
+		const ShaderArchive& archive,
+		const char* pipelineName) const noexcept;
+	Result buildFromArchive(
+		PipelineRenderPending& pendingOut,
+		const ShaderArchive& archive,
+		const char* pipelineName) const noexcept;
+};
+
+
+// ShaderArchive
+// ------------------------------------------------------------------------------------------------
+
+class ShaderArchive final {
+public:
+	// Members
+	// --------------------------------------------------------------------------------------------
+
+	ZgShaderArchive* archive = nullptr;
+
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	ShaderArchive() noexcept = default;
+	ShaderArchive(const ShaderArchive&) = delete;
+	ShaderArchive& operator= (const ShaderArchive&) = delete;
+	ShaderArchive(ShaderArchive&& o) noexcept { this->swap(o); }
+	ShaderArchive& operator= (ShaderArchive&& o) noexcept { this->swap(o); return *this; }
+	~ShaderArchive() noexcept { this->release(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	bool valid() const noexcept { return this->archive != nullptr; }
+
+	// See zgShaderArchiveLoad()
+	Result load(const char* path) noexcept;
+
+	void swap(ShaderArchive& other) noexcept;
+
+	// See zgShaderArchiveRelease()
+	void release() noexcept;
+
+	// ShaderArchive methods
+	// --------------------------------------------------------------------------------------------
+
+	// See zgShaderArchiveContains()
+	Result contains(const char* pipelineName, bool& containsOut) const noexcept;
 };
 
 
@@ -246,6 +347,10 @@ public:
 	Result createFromFileSPIRV(
 		const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept;
 
+	// See zgPipelineRenderCreateFromMemorySPIRV()
+	Result createFromMemorySPIRV(
+		const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept;
+
 	// See ZgPipelineRenderCreateInfoFileHLSL()
 	Result createFromFileHLSL(
 		const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept;
@@ -254,6 +359,14 @@ public:
 	Result createFromSourceHLSL(
 		const ZgPipelineRenderCreateInfoSourceHLSL& createInfo) noexcept;
 
+	// See zgPipelineRenderCreateFromMemoryDXIL()
+	Result createFromMemoryDXIL(
+		const ZgPipelineRenderCreateInfoMemoryDXIL& createInfo) noexcept;
+
+	// See zgPipelineRenderCreateFromArchive()
+	Result createFromArchive(
+		const ZgPipelineRenderCreateInfoArchive& createInfo) noexcept;
+
 	void swap(PipelineRender& other) noexcept;
 
 	// See zgPipelineRenderRelease()
@@ -261,6 +374,139 @@ public:
 };
 
 
+// PipelineRenderPending
+// ------------------------------------------------------------------------------------------------
+
+class PipelineRenderPending final {
+public:
+	// Members
+	// --------------------------------------------------------------------------------------------
+
+	ZgPipelineRenderPending* pending = nullptr;
+
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	PipelineRenderPending() noexcept = default;
+	PipelineRenderPending(const PipelineRenderPending&) = delete;
+	PipelineRenderPending& operator= (const PipelineRenderPending&) = delete;
+	PipelineRenderPending(PipelineRenderPending&& o) noexcept { this->swap(o); }
+	PipelineRenderPending& operator= (PipelineRenderPending&& o) noexcept
+	{
+		this->swap(o);
+		return *this;
+	}
+	~PipelineRenderPending() noexcept { this->release(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	bool valid() const noexcept { return this->pending != nullptr; }
+
+	// See zgPipelineRenderCreateFromFileSPIRVAsync()
+	Result createFromFileSPIRV(
+		const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept;
+
+	// See zgPipelineRenderCreateFromMemorySPIRVAsync()
+	Result createFromMemorySPIRV(
+		const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept;
+
+	// See zgPipelineRenderCreateFromFileHLSLAsync()
+	Result createFromFileHLSL(
+		const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept;
+
+	// See zgPipelineRenderCreateFromSourceHLSLAsync()
+	Result createFromSourceHLSL(
+		const ZgPipelineRenderCreateInfoSourceHLSL& createInfo) noexcept;
+
+	// See zgPipelineRenderCreateFromMemoryDXILAsync()
+	Result createFromMemoryDXIL(
+		const ZgPipelineRenderCreateInfoMemoryDXIL& createInfo) noexcept;
+
+	// See zgPipelineRenderCreateFromArchiveAsync()
+	Result createFromArchive(
+		const ZgPipelineRenderCreateInfoArchive& createInfo) noexcept;
+
+	void swap(PipelineRenderPending& other) noexcept;
+
+	// See zgPipelineRenderPendingRelease()
+	void release() noexcept;
+
+	// PipelineRenderPending methods
+	// --------------------------------------------------------------------------------------------
+
+	// See zgPipelineRenderPendingIsReady()
+	Result isReady(bool& readyOut) const noexcept;
+
+	// See zgPipelineRenderPendingWait()
+	Result wait(PipelineRender& pipelineOut) noexcept;
+};
+
+
+// PipelineRenderPermutations
+// ------------------------------------------------------------------------------------------------
+
+class PipelineRenderPermutations final {
+public:
+	// Members
+	// --------------------------------------------------------------------------------------------
+
+	ZgPipelineRenderPermutations* permutations = nullptr;
+
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	PipelineRenderPermutations() noexcept = default;
+	PipelineRenderPermutations(const PipelineRenderPermutations&) = delete;
+	PipelineRenderPermutations& operator= (const PipelineRenderPermutations&) = delete;
+	PipelineRenderPermutations(PipelineRenderPermutations&& o) noexcept { this->swap(o); }
+	PipelineRenderPermutations& operator= (PipelineRenderPermutations&& o) noexcept
+	{
+		this->swap(o);
+		return *this;
+	}
+	~PipelineRenderPermutations() noexcept { this->release(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	bool valid() const noexcept { return this->permutations != nullptr; }
+
+	// See zgPipelineRenderPermutationsCreateFromFileSPIRV()
+	Result createFromFileSPIRV(
+		const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept;
+
+	// See zgPipelineRenderPermutationsCreateFromMemorySPIRV()
+	Result createFromMemorySPIRV(
+		const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept;
+
+	// See zgPipelineRenderPermutationsCreateFromFileHLSL()
+	Result createFromFileHLSL(
+		const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept;
+
+	// See zgPipelineRenderPermutationsCreateFromSourceHLSL()
+	Result createFromSourceHLSL(
+		const ZgPipelineRenderCreateInfoSourceHLSL& createInfo) noexcept;
+
+	void swap(PipelineRenderPermutations& other) noexcept;
+
+	// See zgPipelineRenderPermutationsRelease()
+	void release() noexcept;
+
+	// PipelineRenderPermutations methods
+	// --------------------------------------------------------------------------------------------
+
+	// See zgPipelineRenderPermutationsGet(), the pipeline is owned by the set
+	Result get(
+		const ZgPipelineRenderPermutation* permutation,
+		ZgPipelineRender*& pipelineOut,
+		ZgPipelineRenderSignature& signatureOut) noexcept;
+
+	// See zgPipelineRenderPermutationsGetStats()
+	Result getStats(ZgPipelineRenderPermutationsStats& statsOut) noexcept;
+};
+
+
 // MemoryHeap
 // ------------------------------------------------------------------------------------------------
 
@@ -305,6 +551,12 @@ public:
 	// See zgMemoryHeapTexture2DCreate()
 	Result texture2DCreate(
 		Texture2D& textureOut, const ZgTexture2DCreateInfo& createInfo) noexcept;
+
+	// See zgMemoryHeapSetResidencyPriority()
+	Result setResidencyPriority(ZgResidencyPriority priority) noexcept;
+
+	// See zgMemoryHeapGetStats()
+	Result getStats(ZgMemoryHeapStats& statsOut) noexcept;
 };
 
 
@@ -344,8 +596,60 @@ public:
 	// See zgBufferMemcpyTo()
 	Result memcpyTo(uint64_t bufferOffsetBytes, const void* srcMemory, uint64_t numBytes);
 
+	// See zgBufferReadFile()
+	Result readFile(
+		uint64_t bufferOffsetBytes,
+		const char* path,
+		uint64_t fileOffsetBytes,
+		uint64_t numBytes,
+		FileRead& fileReadOut) noexcept;
+
 	// See zgBufferSetDebugName()
 	Result setDebugName(const char* name) noexcept;
+
+	// See zgBufferGetBindlessIndex()
+	Result getBindlessIndex(uint32_t& indexOut) const noexcept;
+};
+
+
+// FileRead
+// ------------------------------------------------------------------------------------------------
+
+class FileRead final {
+public:
+	// Members
+	// --------------------------------------------------------------------------------------------
+
+	ZgFileRead* fileRead = nullptr;
+
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	FileRead() noexcept = default;
+	FileRead(const FileRead&) = delete;
+	FileRead& operator= (const FileRead&) = delete;
+	FileRead(FileRead&& other) noexcept { this->swap(other); }
+	FileRead& operator= (FileRead&& other) noexcept { this->swap(other); return *this; }
+	~FileRead() noexcept { this->release(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	bool valid() const noexcept { return this->fileRead != nullptr; }
+
+	void swap(FileRead& other) noexcept;
+
+	// See zgFileReadRelease()
+	void release() noexcept;
+
+	// FileRead methods
+	// --------------------------------------------------------------------------------------------
+
+	// See zgFileReadCheckIfDone()
+	Result checkIfDone(bool& doneOut) noexcept;
+
+	// See zgFileReadWaitOnCpuBlocking()
+	Result waitOnCpuBlocking() noexcept;
 };
 
 
@@ -387,8 +691,17 @@ public:
 		ZgTexture2DAllocationInfo& allocationInfoOut,
 		const ZgTexture2DCreateInfo& createInfo) noexcept;
 
+	// See zgTexture2DCalculateTransientPlacement()
+	static Result calculateTransientPlacement(
+		ZgTransientTexture2D* textures,
+		uint32_t numTextures,
+		uint64_t& heapSizeInBytesOut) noexcept;
+
 	// See zgTexture2DSetDebugName()
 	Result setDebugName(const char* name) noexcept;
+
+	// See zgTexture2DGetBindlessIndex()
+	Result getBindlessIndex(uint32_t& indexOut) const noexcept;
 };
 
 
@@ -657,19 +970,41 @@ public:
 		const ZgImageViewConstCpu& srcImageCpu,
 		Buffer& tempUploadBuffer) noexcept;
 
+	// See zgCommandListMemcpyToTextureMipChain()
+	Result memcpyToTextureMipChain(
+		Texture2D& dstTexture,
+		const ZgImageViewConstCpu* srcImagesCpu,
+		uint32_t numMipLevels,
+		Buffer& tempUploadBuffer,
+		uint64_t tempUploadBufferOffsetBytes = 0) noexcept;
+
 	// See zgCommandListEnableQueueTransitionBuffer()
 	Result enableQueueTransition(Buffer& buffer) noexcept;
 
 	// See zgCommandListEnableQueueTransitionTexture()
 	Result enableQueueTransition(Texture2D& texture) noexcept;
 
+	// See zgCommandListActivateTransientTexture()
+	Result activateTransientTexture(Texture2D& texture) noexcept;
+
 	// See zgCommandListSetPushConstant()
 	Result setPushConstant(
 		uint32_t shaderRegister, const void* data, uint32_t dataSizeInBytes) noexcept;
 
+	// See zgCommandListSetRootConstantBuffer()
+	Result setRootConstantBuffer(
+		uint32_t shaderRegister, Buffer& buffer, uint64_t offsetInBytes) noexcept;
+
 	// See zgCommandListSetPipelineBindings()
 	Result setPipelineBindings(const PipelineBindings& bindings) noexcept;
 
+	// See zgCommandListUseBindlessResources()
+	Result useBindlessResources(
+		ZgBuffer* const* buffers,
+		uint32_t numBuffers,
+		ZgTexture2D* const* textures,
+		uint32_t numTextures) noexcept;
+
 	// See zgCommandListSetPipelineRender()
 	Result setPipeline(PipelineRender& pipeline) noexcept;
 
@@ -710,6 +1045,53 @@ public:
 };
 
 
+// TextureStreamer
+// ------------------------------------------------------------------------------------------------
+
+class TextureStreamer final {
+public:
+	// Members
+	// --------------------------------------------------------------------------------------------
+
+	ZgTextureStreamer* streamer = nullptr;
+
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	TextureStreamer() noexcept = default;
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator= (const TextureStreamer&) = delete;
+	TextureStreamer(TextureStreamer&& other) noexcept { this->swap(other); }
+	TextureStreamer& operator= (TextureStreamer&& other) noexcept { this->swap(other); return *this; }
+	~TextureStreamer() noexcept { this->release(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	bool valid() const noexcept { return this->streamer != nullptr; }
+
+	// See zgTextureStreamerCreate()
+	Result create(const ZgTextureStreamerCreateInfo& createInfo) noexcept;
+
+	void swap(TextureStreamer& other) noexcept;
+
+	// See zgTextureStreamerRelease()
+	void release() noexcept;
+
+	// TextureStreamer methods
+	// --------------------------------------------------------------------------------------------
+
+	// See zgTextureStreamerRequest()
+	Result request(const ZgTextureStreamRequest& request, uint64_t& requestIdOut) noexcept;
+
+	// See zgTextureStreamerGetCompleted()
+	Result getCompleted(
+		ZgTextureStreamCompletion* completionsOut,
+		uint32_t maxNumCompletions,
+		uint32_t& numCompletionsOut) noexcept;
+};
+
+
 // Transformation and projection matrices
 // ------------------------------------------------------------------------------------------------
 
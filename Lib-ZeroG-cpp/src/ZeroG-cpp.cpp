@@ -87,6 +87,103 @@ Result Context::getStats(ZgStats& statsOut) noexcept
 	return (Result)zgContextGetStats(&statsOut);
 }
 
+Result Context::getCpuAllocationStats(
+	ZgCpuAllocationTagStats* statsOut, uint32_t maxNumStats, uint32_t& numStatsOut) noexcept
+{
+	return (Result)zgContextGetCpuAllocationStats(statsOut, maxNumStats, &numStatsOut);
+}
+
+
+// PipelineRenderBuilder: Statics
+// ------------------------------------------------------------------------------------------------
+
+static ZgPipelineRenderCreateInfoFileSPIRV fileSPIRVCreateInfo(
+	const PipelineRenderBuilder& builder) noexcept
+{
+	ZgPipelineRenderCreateInfoFileSPIRV createInfo = {};
+	createInfo.common = builder.commonInfo;
+	createInfo.vertexShaderPath = builder.vertexShaderPath;
+	createInfo.pixelShaderPath = builder.pixelShaderPath;
+	createInfo.numSpecializationConstants = builder.numSpecializationConstants;
+	for (uint32_t i = 0; i < builder.numSpecializationConstants; i++) {
+		createInfo.specializationConstants[i] = builder.specializationConstants[i];
+	}
+	return createInfo;
+}
+
+static ZgPipelineRenderCreateInfoMemorySPIRV memorySPIRVCreateInfo(
+	const PipelineRenderBuilder& builder) noexcept
+{
+	ZgPipelineRenderCreateInfoMemorySPIRV createInfo = {};
+	createInfo.common = builder.commonInfo;
+	createInfo.vertexShaderSpirv = reinterpret_cast<const uint32_t*>(builder.vertexShaderBytecode);
+	createInfo.vertexShaderSpirvSizeBytes = builder.vertexShaderBytecodeSizeBytes;
+	createInfo.pixelShaderSpirv = reinterpret_cast<const uint32_t*>(builder.pixelShaderBytecode);
+	createInfo.pixelShaderSpirvSizeBytes = builder.pixelShaderBytecodeSizeBytes;
+	createInfo.numSpecializationConstants = builder.numSpecializationConstants;
+	for (uint32_t i = 0; i < builder.numSpecializationConstants; i++) {
+		createInfo.specializationConstants[i] = builder.specializationConstants[i];
+	}
+	return createInfo;
+}
+
+static ZgPipelineRenderCreateInfoMemoryDXIL memoryDXILCreateInfo(
+	const PipelineRenderBuilder& builder) noexcept
+{
+	ZgPipelineRenderCreateInfoMemoryDXIL createInfo = {};
+	createInfo.common = builder.commonInfo;
+	createInfo.vertexShaderDxil = builder.vertexShaderBytecode;
+	createInfo.vertexShaderDxilSizeBytes = builder.vertexShaderBytecodeSizeBytes;
+	createInfo.pixelShaderDxil = builder.pixelShaderBytecode;
+	createInfo.pixelShaderDxilSizeBytes = builder.pixelShaderBytecodeSizeBytes;
+	return createInfo;
+}
+
+static ZgPipelineRenderCreateInfoArchive archiveCreateInfo(
+	const PipelineRenderBuilder& builder,
+	const ShaderArchive& archive,
+	const char* pipelineName) noexcept
+{
+	ZgPipelineRenderCreateInfoArchive createInfo = {};
+	createInfo.common = builder.commonInfo;
+	createInfo.archive = archive.archive;
+	createInfo.pipelineName = pipelineName;
+	return createInfo;
+}
+
+static ZgPipelineRenderCreateInfoFileHLSL fileHLSLCreateInfo(
+	const PipelineRenderBuilder& builder, ZgShaderModel model) noexcept
+{
+	ZgPipelineRenderCreateInfoFileHLSL createInfo = {};
+	createInfo.common = builder.commonInfo;
+	createInfo.vertexShaderPath = builder.vertexShaderPath;
+	createInfo.pixelShaderPath = builder.pixelShaderPath;
+	createInfo.shaderModel = model;
+	createInfo.dxcCompilerFlags[0] = "-Zi";
+	createInfo.dxcCompilerFlags[1] = "-O3";
+	createInfo.numDefines = builder.numDefines;
+	for (uint32_t i = 0; i < builder.numDefines; i++) {
+		createInfo.defines[i] = builder.defines[i];
+	}
+	return createInfo;
+}
+
+static ZgPipelineRenderCreateInfoSourceHLSL sourceHLSLCreateInfo(
+	const PipelineRenderBuilder& builder, ZgShaderModel model) noexcept
+{
+	ZgPipelineRenderCreateInfoSourceHLSL createInfo = {};
+	createInfo.common = builder.commonInfo;
+	createInfo.vertexShaderSrc = builder.vertexShaderSrc;
+	createInfo.pixelShaderSrc = builder.pixelShaderSrc;
+	createInfo.shaderModel = model;
+	createInfo.dxcCompilerFlags[0] = "-Zi";
+	createInfo.dxcCompilerFlags[1] = "-O3";
+	createInfo.numDefines = builder.numDefines;
+	for (uint32_t i = 0; i < builder.numDefines; i++) {
+		createInfo.defines[i] = builder.defines[i];
+	}
+	return createInfo;
+}
 
 // PipelineRenderBuilder: Methods
 // ------------------------------------------------------------------------------------------------
@@ -133,6 +230,16 @@ PipelineRenderBuilder& PipelineRenderBuilder::addPushConstant(
 	return *this;
 }
 
+PipelineRenderBuilder& PipelineRenderBuilder::addRootConstantBuffer(
+	uint32_t constantBufferRegister) noexcept
+{
+	assert(commonInfo.numRootConstantBuffers < ZG_MAX_NUM_CONSTANT_BUFFERS);
+	commonInfo.rootConstantBufferRegisters[commonInfo.numRootConstantBuffers] =
+		constantBufferRegister;
+	commonInfo.numRootConstantBuffers += 1;
+	return *this;
+}
+
 PipelineRenderBuilder& PipelineRenderBuilder::addSampler(
 	uint32_t samplerRegister, ZgSampler sampler) noexcept
 {
@@ -198,6 +305,44 @@ PipelineRenderBuilder& PipelineRenderBuilder::addPixelShaderSource(
 	return *this;
 }
 
+PipelineRenderBuilder& PipelineRenderBuilder::addVertexShaderBytecode(
+	const char* entry, const void* data, uint32_t sizeBytes) noexcept
+{
+	commonInfo.vertexShaderEntry = entry;
+	vertexShaderBytecode = data;
+	vertexShaderBytecodeSizeBytes = sizeBytes;
+	return *this;
+}
+
+PipelineRenderBuilder& PipelineRenderBuilder::addPixelShaderBytecode(
+	const char* entry, const void* data, uint32_t sizeBytes) noexcept
+{
+	commonInfo.pixelShaderEntry = entry;
+	pixelShaderBytecode = data;
+	pixelShaderBytecodeSizeBytes = sizeBytes;
+	return *this;
+}
+
+PipelineRenderBuilder& PipelineRenderBuilder::addDefine(
+	const char* name, const char* value) noexcept
+{
+	assert(numDefines < ZG_MAX_NUM_SHADER_DEFINES);
+	defines[numDefines].name = name;
+	defines[numDefines].value = value;
+	numDefines += 1;
+	return *this;
+}
+
+PipelineRenderBuilder& PipelineRenderBuilder::addSpecializationConstant(
+	uint32_t constantId, uint32_t value) noexcept
+{
+	assert(numSpecializationConstants < ZG_MAX_NUM_SPECIALIZATION_CONSTANTS);
+	specializationConstants[numSpecializationConstants].constantId = constantId;
+	specializationConstants[numSpecializationConstants].value = value;
+	numSpecializationConstants += 1;
+	return *this;
+}
+
 PipelineRenderBuilder& PipelineRenderBuilder::setWireframeRendering(
 	bool wireframeEnabled) noexcept
 {
@@ -269,46 +414,133 @@ PipelineRenderBuilder& PipelineRenderBuilder::setDepthFunc(ZgDepthFunc depthFunc
 Result PipelineRenderBuilder::buildFromFileSPIRV(
 	PipelineRender& pipelineOut) const noexcept
 {
-	// Build create info
-	ZgPipelineRenderCreateInfoFileSPIRV createInfo = {};
-	createInfo.common = this->commonInfo;
-	createInfo.vertexShaderPath = this->vertexShaderPath;
-	createInfo.pixelShaderPath = this->pixelShaderPath;
-
-	// Build pipeline
-	return pipelineOut.createFromFileSPIRV(createInfo);
+	return pipelineOut.createFromFileSPIRV(fileSPIRVCreateInfo(*this));
 }
 
 Result PipelineRenderBuilder::buildFromFileHLSL(
 	PipelineRender& pipelineOut, ZgShaderModel model) const noexcept
 {
-	// Build create info
-	ZgPipelineRenderCreateInfoFileHLSL createInfo = {};
-	createInfo.common = this->commonInfo;
-	createInfo.vertexShaderPath = this->vertexShaderPath;
-	createInfo.pixelShaderPath = this->pixelShaderPath;
-	createInfo.shaderModel = model;
-	createInfo.dxcCompilerFlags[0] = "-Zi";
-	createInfo.dxcCompilerFlags[1] = "-O3";
-
-	// Build pipeline
-	return pipelineOut.createFromFileHLSL(createInfo);
+	return pipelineOut.createFromFileHLSL(fileHLSLCreateInfo(*this, model));
 }
 
 Result PipelineRenderBuilder::buildFromSourceHLSL(
 	PipelineRender& pipelineOut, ZgShaderModel model) const noexcept
 {
-	// Build create info
-	ZgPipelineRenderCreateInfoSourceHLSL createInfo = {};
-	createInfo.common = this->commonInfo;
-	createInfo.vertexShaderSrc = this->vertexShaderSrc;
-	createInfo.pixelShaderSrc= this->pixelShaderSrc;
-	createInfo.shaderModel = model;
-	createInfo.dxcCompilerFlags[0] = "-Zi";
-	createInfo.dxcCompilerFlags[1] = "-O3";
+	return pipelineOut.createFromSourceHLSL(sourceHLSLCreateInfo(*this, model));
+}
+
+Result PipelineRenderBuilder::buildFromMemorySPIRV(
+	PipelineRender& pipelineOut) const noexcept
+{
+	return pipelineOut.createFromMemorySPIRV(memorySPIRVCreateInfo(*this));
+}
+
+Result PipelineRenderBuilder::buildFromMemoryDXIL(
+	PipelineRender& pipelineOut) const noexcept
+{
+	return pipelineOut.createFromMemoryDXIL(memoryDXILCreateInfo(*this));
+}
+
+Result PipelineRenderBuilder::buildFromFileSPIRV(
+	PipelineRenderPending& pendingOut) const noexcept
+{
+	return pendingOut.createFromFileSPIRV(fileSPIRVCreateInfo(*this));
+}
+
+Result PipelineRenderBuilder::buildFromFileHLSL(
+	PipelineRenderPending& pendingOut, ZgShaderModel model) const noexcept
+{
+	return pendingOut.createFromFileHLSL(fileHLSLCreateInfo(*this, model));
+}
+
+Result PipelineRenderBuilder::buildFromSourceHLSL(
+	PipelineRenderPending& pendingOut, ZgShaderModel model) const noexcept
+{
+	return pendingOut.createFromSourceHLSL(sourceHLSLCreateInfo(*this, model));
+}
+
+Result PipelineRenderBuilder::buildFromMemorySPIRV(
+	PipelineRenderPending& pendingOut) const noexcept
+{
+	return pendingOut.createFromMemorySPIRV(memorySPIRVCreateInfo(*this));
+}
+
+Result PipelineRenderBuilder::buildFromMemoryDXIL(
+	PipelineRenderPending& pendingOut) const noexcept
+{
+	return pendingOut.createFromMemoryDXIL(memoryDXILCreateInfo(*this));
+}
+
+Result PipelineRenderBuilder::buildFromFileSPIRV(
+	PipelineRenderPermutations& permutationsOut) const noexcept
+{
+	return permutationsOut.createFromFileSPIRV(fileSPIRVCreateInfo(*this));
+}
+
+Result PipelineRenderBuilder::buildFromFileHLSL(
+	PipelineRenderPermutations& permutationsOut, ZgShaderModel model) const noexcept
+{
+	return permutationsOut.createFromFileHLSL(fileHLSLCreateInfo(*this, model));
+}
+
+Result PipelineRenderBuilder::buildFromSourceHLSL(
+	PipelineRenderPermutations& permutationsOut, ZgShaderModel model) const noexcept
+{
+	return permutationsOut.createFromSourceHLSL(sourceHLSLCreateInfo(*this, model));
+}
+
+Result PipelineRenderBuilder::buildFromMemorySPIRV(
+	PipelineRenderPermutations& permutationsOut) const noexcept
+{
+	return permutationsOut.createFromMemorySPIRV(memorySPIRVCreateInfo(*this));
+}
+
+Result PipelineRenderBuilder::buildFromArchive(
+	PipelineRender& pipelineOut,
+	const ShaderArchive& archive,
+	const char* pipelineName) const noexcept
+{
+	return pipelineOut.createFromArchive(archiveCreateInfo(*this, archive, pipelineName));
+}
+
+Result PipelineRenderBuilder::buildFromArchive(
+	PipelineRenderPending& pendingOut,
+	const ShaderArchive& archive,
+	const char* pipelineName) const noexcept
+{
+	return pendingOut.createFromArchive(archiveCreateInfo(*this, archive, pipelineName));
+}
+
+
+// ShaderArchive: State methods
+// ------------------------------------------------------------------------------------------------
+
+Result ShaderArchive::load(const char* path) noexcept
+{
+	this->release();
+	return (Result)zgShaderArchiveLoad(&this->archive, path);
+}
+
+void ShaderArchive::swap(ShaderArchive& other) noexcept
+{
+	std::swap(this->archive, other.archive);
+}
+
+void ShaderArchive::release() noexcept
+{
+	if (this->archive != nullptr) zgShaderArchiveRelease(this->archive);
+	this->archive = nullptr;
+}
+
+// ShaderArchive: ShaderArchive methods
+// ------------------------------------------------------------------------------------------------
 
-	// Build pipeline
-	return pipelineOut.createFromSourceHLSL(createInfo);
+Result ShaderArchive::contains(const char* pipelineName, bool& containsOut) const noexcept
+{
+	ZgBool contains = ZG_FALSE;
+	Result res = (Result)zgShaderArchiveContains(this->archive, pipelineName, &contains);
+	containsOut = contains == ZG_FALSE ? false : true;
+	return res;
 }
 
 
@@ -323,6 +555,14 @@ Result PipelineRender::createFromFileSPIRV(
 		&this->pipeline, &this->signature, &createInfo);
 }
 
+Result PipelineRender::createFromMemorySPIRV(
+	const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderCreateFromMemorySPIRV(
+		&this->pipeline, &this->signature, &createInfo);
+}
+
 Result PipelineRender::createFromFileHLSL(
 	const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept
 {
@@ -339,6 +579,22 @@ Result PipelineRender::createFromSourceHLSL(
 		&this->pipeline, &this->signature, &createInfo);
 }
 
+Result PipelineRender::createFromMemoryDXIL(
+	const ZgPipelineRenderCreateInfoMemoryDXIL& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderCreateFromMemoryDXIL(
+		&this->pipeline, &this->signature, &createInfo);
+}
+
+Result PipelineRender::createFromArchive(
+	const ZgPipelineRenderCreateInfoArchive& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderCreateFromArchive(
+		&this->pipeline, &this->signature, &createInfo);
+}
+
 void PipelineRender::swap(PipelineRender& other) noexcept
 {
 	std::swap(this->pipeline, other.pipeline);
@@ -353,6 +609,146 @@ void PipelineRender::release() noexcept
 }
 
 
+// PipelineRenderPending: State methods
+// ------------------------------------------------------------------------------------------------
+
+Result PipelineRenderPending::createFromFileSPIRV(
+	const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderCreateFromFileSPIRVAsync(&this->pending, &createInfo);
+}
+
+Result PipelineRenderPending::createFromMemorySPIRV(
+	const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderCreateFromMemorySPIRVAsync(&this->pending, &createInfo);
+}
+
+Result PipelineRenderPending::createFromFileHLSL(
+	const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderCreateFromFileHLSLAsync(&this->pending, &createInfo);
+}
+
+Result PipelineRenderPending::createFromSourceHLSL(
+	const ZgPipelineRenderCreateInfoSourceHLSL& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderCreateFromSourceHLSLAsync(&this->pending, &createInfo);
+}
+
+Result PipelineRenderPending::createFromMemoryDXIL(
+	const ZgPipelineRenderCreateInfoMemoryDXIL& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderCreateFromMemoryDXILAsync(&this->pending, &createInfo);
+}
+
+Result PipelineRenderPending::createFromArchive(
+	const ZgPipelineRenderCreateInfoArchive& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderCreateFromArchiveAsync(&this->pending, &createInfo);
+}
+
+void PipelineRenderPending::swap(PipelineRenderPending& other) noexcept
+{
+	std::swap(this->pending, other.pending);
+}
+
+void PipelineRenderPending::release() noexcept
+{
+	if (this->pending != nullptr) zgPipelineRenderPendingRelease(this->pending);
+	this->pending = nullptr;
+}
+
+// PipelineRenderPending: PipelineRenderPending methods
+// ------------------------------------------------------------------------------------------------
+
+Result PipelineRenderPending::isReady(bool& readyOut) const noexcept
+{
+	ZgBool ready = ZG_FALSE;
+	Result res = (Result)zgPipelineRenderPendingIsReady(this->pending, &ready);
+	readyOut = ready == ZG_FALSE ? false : true;
+	return res;
+}
+
+Result PipelineRenderPending::wait(PipelineRender& pipelineOut) noexcept
+{
+	pipelineOut.release();
+	return (Result)zgPipelineRenderPendingWait(
+		this->pending, &pipelineOut.pipeline, &pipelineOut.signature);
+}
+
+
+// PipelineRenderPermutations: State methods
+// ------------------------------------------------------------------------------------------------
+
+Result PipelineRenderPermutations::createFromFileSPIRV(
+	const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderPermutationsCreateFromFileSPIRV(
+		&this->permutations, &createInfo);
+}
+
+Result PipelineRenderPermutations::createFromMemorySPIRV(
+	const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderPermutationsCreateFromMemorySPIRV(
+		&this->permutations, &createInfo);
+}
+
+Result PipelineRenderPermutations::createFromFileHLSL(
+	const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderPermutationsCreateFromFileHLSL(
+		&this->permutations, &createInfo);
+}
+
+Result PipelineRenderPermutations::createFromSourceHLSL(
+	const ZgPipelineRenderCreateInfoSourceHLSL& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgPipelineRenderPermutationsCreateFromSourceHLSL(
+		&this->permutations, &createInfo);
+}
+
+void PipelineRenderPermutations::swap(PipelineRenderPermutations& other) noexcept
+{
+	std::swap(this->permutations, other.permutations);
+}
+
+void PipelineRenderPermutations::release() noexcept
+{
+	if (this->permutations != nullptr) zgPipelineRenderPermutationsRelease(this->permutations);
+	this->permutations = nullptr;
+}
+
+// PipelineRenderPermutations: PipelineRenderPermutations methods
+// ------------------------------------------------------------------------------------------------
+
+Result PipelineRenderPermutations::get(
+	const ZgPipelineRenderPermutation* permutation,
+	ZgPipelineRender*& pipelineOut,
+	ZgPipelineRenderSignature& signatureOut) noexcept
+{
+	return (Result)zgPipelineRenderPermutationsGet(
+		this->permutations, permutation, &pipelineOut, &signatureOut);
+}
+
+Result PipelineRenderPermutations::getStats(
+	ZgPipelineRenderPermutationsStats& statsOut) noexcept
+{
+	return (Result)zgPipelineRenderPermutationsGetStats(this->permutations, &statsOut);
+}
+
+
 // MemoryHeap: State methods
 // ------------------------------------------------------------------------------------------------
 
@@ -406,6 +802,16 @@ Result MemoryHeap::texture2DCreate(
 		this->memoryHeap, &textureOut.texture, &createInfo);
 }
 
+Result MemoryHeap::setResidencyPriority(ZgResidencyPriority priority) noexcept
+{
+	return (Result)zgMemoryHeapSetResidencyPriority(this->memoryHeap, priority);
+}
+
+Result MemoryHeap::getStats(ZgMemoryHeapStats& statsOut) noexcept
+{
+	return (Result)zgMemoryHeapGetStats(this->memoryHeap, &statsOut);
+}
+
 
 // Buffer: State methods
 // --------------------------------------------------------------------------------------------
@@ -431,11 +837,64 @@ Result Buffer::memcpyTo(uint64_t bufferOffsetBytes, const void* srcMemory, uint6
 	return (Result)zgBufferMemcpyTo(this->buffer, bufferOffsetBytes, srcMemory, numBytes);
 }
 
+Result Buffer::readFile(
+	uint64_t bufferOffsetBytes,
+	const char* path,
+	uint64_t fileOffsetBytes,
+	uint64_t numBytes,
+	FileRead& fileReadOut) noexcept
+{
+	fileReadOut.release();
+	return (Result)zgBufferReadFile(
+		this->buffer,
+		bufferOffsetBytes,
+		path,
+		fileOffsetBytes,
+		numBytes,
+		&fileReadOut.fileRead);
+}
+
 Result Buffer::setDebugName(const char* name) noexcept
 {
 	return (Result)zgBufferSetDebugName(this->buffer, name);
 }
 
+Result Buffer::getBindlessIndex(uint32_t& indexOut) const noexcept
+{
+	return (Result)zgBufferGetBindlessIndex(this->buffer, &indexOut);
+}
+
+
+// FileRead: State methods
+// ------------------------------------------------------------------------------------------------
+
+void FileRead::swap(FileRead& other) noexcept
+{
+	std::swap(this->fileRead, other.fileRead);
+}
+
+void FileRead::release() noexcept
+{
+	if (this->fileRead != nullptr) zgFileReadRelease(this->fileRead);
+	this->fileRead = nullptr;
+}
+
+// FileRead: FileRead methods
+// ------------------------------------------------------------------------------------------------
+
+Result FileRead::checkIfDone(bool& doneOut) noexcept
+{
+	ZgBool done = ZG_FALSE;
+	Result res = (Result)zgFileReadCheckIfDone(this->fileRead, &done);
+	doneOut = done == ZG_FALSE ? false : true;
+	return res;
+}
+
+Result FileRead::waitOnCpuBlocking() noexcept
+{
+	return (Result)zgFileReadWaitOnCpuBlocking(this->fileRead);
+}
+
 
 // Texture2D: State methods
 // ------------------------------------------------------------------------------------------------
@@ -462,11 +921,25 @@ Result Texture2D::getAllocationInfo(
 	return (Result)zgTexture2DGetAllocationInfo(&allocationInfoOut, &createInfo);
 }
 
+Result Texture2D::calculateTransientPlacement(
+	ZgTransientTexture2D* textures,
+	uint32_t numTextures,
+	uint64_t& heapSizeInBytesOut) noexcept
+{
+	return (Result)zgTexture2DCalculateTransientPlacement(
+		textures, numTextures, &heapSizeInBytesOut);
+}
+
 Result Texture2D::setDebugName(const char* name) noexcept
 {
 	return (Result)zgTexture2DSetDebugName(this->texture, name);
 }
 
+Result Texture2D::getBindlessIndex(uint32_t& indexOut) const noexcept
+{
+	return (Result)zgTexture2DGetBindlessIndex(this->texture, &indexOut);
+}
+
 
 // FramebufferBuilder: Methods
 // ------------------------------------------------------------------------------------------------
@@ -738,6 +1211,22 @@ Result CommandList::memcpyToTexture(
 		tempUploadBuffer.buffer);
 }
 
+Result CommandList::memcpyToTextureMipChain(
+	Texture2D& dstTexture,
+	const ZgImageViewConstCpu* srcImagesCpu,
+	uint32_t numMipLevels,
+	Buffer& tempUploadBuffer,
+	uint64_t tempUploadBufferOffsetBytes) noexcept
+{
+	return (Result)zgCommandListMemcpyToTextureMipChain(
+		this->commandList,
+		dstTexture.texture,
+		srcImagesCpu,
+		numMipLevels,
+		tempUploadBuffer.buffer,
+		tempUploadBufferOffsetBytes);
+}
+
 Result CommandList::enableQueueTransition(Buffer& buffer) noexcept
 {
 	return (Result)zgCommandListEnableQueueTransitionBuffer(this->commandList, buffer.buffer);
@@ -748,6 +1237,11 @@ Result CommandList::enableQueueTransition(Texture2D& texture) noexcept
 	return (Result)zgCommandListEnableQueueTransitionTexture(this->commandList, texture.texture);
 }
 
+Result CommandList::activateTransientTexture(Texture2D& texture) noexcept
+{
+	return (Result)zgCommandListActivateTransientTexture(this->commandList, texture.texture);
+}
+
 Result CommandList::setPushConstant(
 	uint32_t shaderRegister, const void* data, uint32_t dataSizeInBytes) noexcept
 {
@@ -755,12 +1249,29 @@ Result CommandList::setPushConstant(
 		this->commandList, shaderRegister, data, dataSizeInBytes);
 }
 
+Result CommandList::setRootConstantBuffer(
+	uint32_t shaderRegister, Buffer& buffer, uint64_t offsetInBytes) noexcept
+{
+	return (Result)zgCommandListSetRootConstantBuffer(
+		this->commandList, shaderRegister, buffer.buffer, offsetInBytes);
+}
+
 Result CommandList::setPipelineBindings(const PipelineBindings& bindings) noexcept
 {
 	ZgPipelineBindings cBindings = bindings.toCApi();
 	return (Result)zgCommandListSetPipelineBindings(this->commandList, &cBindings);
 }
 
+Result CommandList::useBindlessResources(
+	ZgBuffer* const* buffers,
+	uint32_t numBuffers,
+	ZgTexture2D* const* textures,
+	uint32_t numTextures) noexcept
+{
+	return (Result)zgCommandListUseBindlessResources(
+		this->commandList, buffers, numBuffers, textures, numTextures);
+}
+
 Result CommandList::setPipeline(PipelineRender& pipeline) noexcept
 {
 	return (Result)zgCommandListSetPipelineRender(this->commandList, pipeline.pipeline);
@@ -825,6 +1336,45 @@ Result CommandList::drawTrianglesIndexed(uint32_t startIndex, uint32_t numTriang
 }
 
 
+// TextureStreamer: State methods
+// ------------------------------------------------------------------------------------------------
+
+Result TextureStreamer::create(const ZgTextureStreamerCreateInfo& createInfo) noexcept
+{
+	this->release();
+	return (Result)zgTextureStreamerCreate(&this->streamer, &createInfo);
+}
+
+void TextureStreamer::swap(TextureStreamer& other) noexcept
+{
+	std::swap(this->streamer, other.streamer);
+}
+
+void TextureStreamer::release() noexcept
+{
+	if (this->streamer != nullptr) zgTextureStreamerRelease(this->streamer);
+	this->streamer = nullptr;
+}
+
+// TextureStreamer: TextureStreamer methods
+// ------------------------------------------------------------------------------------------------
+
+Result TextureStreamer::request(
+	const ZgTextureStreamRequest& request, uint64_t& requestIdOut) noexcept
+{
+	return (Result)zgTextureStreamerRequest(this->streamer, &request, &requestIdOut);
+}
+
+Result TextureStreamer::getCompleted(
+	ZgTextureStreamCompletion* completionsOut,
+	uint32_t maxNumCompletions,
+	uint32_t& numCompletionsOut) noexcept
+{
+	return (Result)zgTextureStreamerGetCompleted(
+		this->streamer, completionsOut, maxNumCompletions, &numCompletionsOut);
+}
+
+
 // Transformation and projection matrices
 // ------------------------------------------------------------------------------------------------
 
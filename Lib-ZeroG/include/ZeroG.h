@@ -64,12 +64,24 @@ extern "C" {
 // A handle representing a render pipeline
 ZG_HANDLE(ZgPipelineRender);
 
+// A handle representing a render pipeline which is being created asynchronously
+ZG_HANDLE(ZgPipelineRenderPending);
+
+// A handle representing a set of render pipeline permutations compiled on demand
+ZG_HANDLE(ZgPipelineRenderPermutations);
+
+// A handle representing a loaded shader archive
+ZG_HANDLE(ZgShaderArchive);
+
 // A handle representing a memory heap (to allocate buffers and textures from)
 ZG_HANDLE(ZgMemoryHeap);
 
 // A handle representing a buffer
 ZG_HANDLE(ZgBuffer);
 
+// A handle representing an in-progress read of a file into a buffer
+ZG_HANDLE(ZgFileRead);
+
 // A handle representing a 2-dimensional texture
 ZG_HANDLE(ZgTexture2D);
 
@@ -85,6 +97,9 @@ ZG_HANDLE(ZgCommandQueue);
 // A handle representing a command list
 ZG_HANDLE(ZgCommandList);
 
+// A handle representing a background texture streamer
+ZG_HANDLE(ZgTextureStreamer);
+
 // Bool
 // ------------------------------------------------------------------------------------------------
 
@@ -105,7 +120,7 @@ typedef struct ZgFramebufferRect ZgFramebufferRect;
 // ------------------------------------------------------------------------------------------------
 
 // The API version used to compile ZeroG.
-static const uint32_t ZG_COMPILED_API_VERSION = 7;
+static const uint32_t ZG_COMPILED_API_VERSION = 10;
 
 // Returns the API version of the ZeroG DLL you have linked with
 //
@@ -175,7 +190,8 @@ enum ZgResultEnum {
 	ZG_ERROR_INVALID_ARGUMENT = -5,
 	ZG_ERROR_SHADER_COMPILE_ERROR = -6,
 	ZG_ERROR_OUT_OF_COMMAND_LISTS = -7,
-	ZG_ERROR_INVALID_COMMAND_LIST_STATE = -8
+	ZG_ERROR_INVALID_COMMAND_LIST_STATE = -8,
+	ZG_ERROR_OUT_OF_DESCRIPTORS = -9
 };
 typedef int32_t ZgResult;
 
@@ -236,6 +252,155 @@ struct ZgAllocator {
 };
 typedef struct ZgAllocator ZgAllocator;
 
+// Residency
+// ------------------------------------------------------------------------------------------------
+
+// The priority of a memory heap when deciding which heaps to evict from GPU memory. Low priority
+// heaps are evicted first, then normal and high. Within the same priority the least recently used
+// heaps are evicted first.
+enum ZgResidencyPriorityEnum {
+	ZG_RESIDENCY_PRIORITY_NORMAL = 0,
+	ZG_RESIDENCY_PRIORITY_LOW,
+	ZG_RESIDENCY_PRIORITY_HIGH
+};
+typedef uint32_t ZgResidencyPriority;
+
+// Settings for the residency policy.
+//
+// If enabled, ZeroG checks the memory usage against the budget given by the OS at the beginning
+// of each frame (zgContextSwapchainBeginFrame()). If the usage is above the eviction threshold,
+// memory heaps not in use by the GPU are evicted until the usage is below the threshold again.
+// Evicted heaps are automatically made resident again the next time they are used, which can
+// cause a stall. The number of evicted heaps etc is reported per frame in ZgStats.
+//
+// If the residency policy is not required, just leave all fields zero in this struct.
+struct ZgResidencySettings {
+
+	// [Optional] Enables the residency policy
+	ZgBool enabled;
+
+	// [Optional] The fraction of the memory budget above which heaps are evicted. Defaults to
+	//            0.9 if set to 0.
+	float evictionThreshold;
+
+	// [Optional] Called for each heap evicted. Called from the thread that called
+	//            zgContextSwapchainBeginFrame(), before it returns.
+	void (*evictionCallback)(void* userPtr, ZgMemoryHeap* heap, uint64_t sizeInBytes);
+
+	// [Optional] User specified pointer that is provided to the eviction callback.
+	void* userPtr;
+};
+typedef struct ZgResidencySettings ZgResidencySettings;
+
+// Job system
+// ------------------------------------------------------------------------------------------------
+
+// A task run by the job system, taskIdx is in [0, numTasks)
+typedef void ZgTaskFunc(void* taskData, uint32_t taskIdx);
+
+// Settings for ZeroG's internal parallelism.
+//
+// Some internal work (e.g. cross-compiling shaders and copying texture data into upload buffers)
+// can be split into tasks and run in parallel. By default everything is done on the calling
+// thread. Either let ZeroG create its own work-stealing thread pool by setting numWorkerThreads,
+// or run the tasks on the host engine's scheduler by setting parallelFor.
+struct ZgJobSystemSettings {
+
+	// [Optional] Number of worker threads in ZeroG's internal thread pool. Ignored if parallelFor
+	//            is set. If 0 no thread pool is created.
+	uint32_t numWorkerThreads;
+
+	// [Optional] Host scheduler. Must call taskFunc(taskData, i) exactly once for every i in
+	//            [0, numTasks), on any threads (including the calling one), and must not return
+	//            until all calls have returned. May be called from multiple threads at once.
+	void (*parallelFor)(
+		void* userPtr, uint32_t numTasks, ZgTaskFunc* taskFunc, void* taskData);
+
+	// [Optional] User specified pointer that is provided to parallelFor.
+	void* userPtr;
+};
+typedef struct ZgJobSystemSettings ZgJobSystemSettings;
+
+// Pipeline cache
+// ------------------------------------------------------------------------------------------------
+
+// Settings for the on-disk pipeline cache.
+//
+// When enabled the results of compiling a pipeline's shaders (compiled bytecode and the reflected
+// pipeline signature) are stored on disk, keyed by a hash of everything that affects them: the
+// shader source or SPIR-V bytes, entry points, shader model, DXC compiler flags and the
+// ZgPipelineRenderCreateInfoCommon. Creating the same pipeline again skips cross-compilation, DXC
+// and reflection entirely. Files included by HLSL shaders are recorded when compiling, and an
+// entry is only used if they are unchanged.
+struct ZgPipelineCacheSettings {
+
+	// [Optional] Directory to store the cache in, created if it does not exist. If not set the
+	//            cache is disabled.
+	const char* directory;
+
+	// [Optional] Maximum total size of the cache. Least recently used entries are evicted when it
+	//            is exceeded. Defaults to 256 MiB if 0.
+	uint64_t maxSizeBytes;
+};
+typedef struct ZgPipelineCacheSettings ZgPipelineCacheSettings;
+
+// Shader hot-reload
+// ------------------------------------------------------------------------------------------------
+
+// Settings for shader hot-reload, intended for development only.
+//
+// When enabled the source files of pipelines created from files, i.e. through
+// zgPipelineRenderCreateFromFileHLSL() and zgPipelineRenderCreateFromFileSPIRV() (and their async
+// variants), are watched for changes. So are any files #include:d by HLSL shaders. When a file
+// changes only the pipelines depending on it are recompiled, on a background thread.
+//
+// Recompiled pipelines are swapped in by zgContextSwapchainBeginFrame(), the ZgPipelineRender
+// handles stay the same. If command lists are being recorded when it is called the swap is
+// postponed to a later frame, so that a pipeline never changes while a command list is using it.
+// The old shaders are kept alive until all work submitted before the swap has finished. A pipeline
+// is kept as is if it fails to compile, or if its signature changed (since that requires changes
+// to the code using it).
+struct ZgShaderHotReloadSettings {
+
+	// [Optional] Enables shader hot-reload
+	ZgBool enabled;
+
+	// [Optional] How often to check for modified files, in milliseconds. Defaults to 100 if 0.
+	uint32_t pollIntervalMs;
+};
+typedef struct ZgShaderHotReloadSettings ZgShaderHotReloadSettings;
+
+// Descriptors
+// ------------------------------------------------------------------------------------------------
+
+// Settings for the shader-visible descriptor heap used to bind resources to pipelines (D3D12).
+//
+// The start of the heap can be reserved for bindless resources, see zgBufferGetBindlessIndex().
+// The rest of the heap is divided into segments. A command list takes a whole segment at a time
+// and allocates its descriptor tables from it. When the command list is executed its segments are
+// tagged with its fence value, they are only reused once the GPU is done with them. If all
+// segments are in use, allocating one waits for the oldest executed command list to finish. If
+// none of them has been executed (i.e. all segments belong to command lists still being recorded)
+// the allocation fails with ZG_ERROR_OUT_OF_DESCRIPTORS.
+//
+// Use the descriptor counters in ZgStats to size the heap.
+struct ZgDescriptorSettings {
+
+	// [Optional] The number of descriptors in the heap, including the bindless ones. Defaults to
+	//            1000000 if 0.
+	uint32_t numDescriptors;
+
+	// [Optional] The number of descriptors in each segment, a command list uses at least one
+	//            segment if it binds any resources. Defaults to 4096 if 0, minimum 256.
+	uint32_t numDescriptorsPerSegment;
+
+	// [Optional] The number of descriptors reserved for bindless resources, i.e. the maximum
+	//            number of buffers and textures that can exist at the same time. Bindless is
+	//            disabled if 0 (the default).
+	uint32_t numBindlessDescriptors;
+};
+typedef struct ZgDescriptorSettings ZgDescriptorSettings;
+
 // Context
 // ------------------------------------------------------------------------------------------------
 
@@ -259,6 +424,25 @@ struct ZgContextInitSettings {
 	// [Optional] The allocator used to allocate CPU memory
 	ZgAllocator allocator;
 
+	// [Optional] Tracks all CPU allocations by name, see zgContextGetCpuAllocationStats(). Adds
+	//            a small overhead (and header) to each allocation, so it's disabled by default.
+	ZgBool trackCpuAllocations;
+
+	// [Optional] Settings for the memory residency policy
+	ZgResidencySettings residency;
+
+	// [Optional] Settings for internal parallelism
+	ZgJobSystemSettings jobs;
+
+	// [Optional] Settings for the on-disk pipeline cache
+	ZgPipelineCacheSettings pipelineCache;
+
+	// [Optional] Settings for shader hot-reload
+	ZgShaderHotReloadSettings shaderHotReload;
+
+	// [Optional] Settings for the descriptor heap
+	ZgDescriptorSettings descriptors;
+
 	// [Mandatory] Platform specific native handle.
 	//
 	// On Windows, this is a HWND, i.e. native window handle.
@@ -339,6 +523,41 @@ struct ZgStats {
 
 	// The amount of "non-local" memory used by the application.
 	uint64_t nonLocalUsageBytes;
+
+	// Residency policy counters for the last completed frame, i.e. between the two latest calls
+	// to zgContextSwapchainBeginFrame(). Always zero if the residency policy is not enabled.
+	uint32_t numHeapsEvicted;
+	uint32_t numHeapsMadeResident;
+	uint64_t bytesEvicted;
+	uint64_t bytesMadeResident;
+
+	// Pipeline cache counters since the context was initialized, and the current size of the
+	// cache on disk. Always zero if the pipeline cache is not enabled.
+	uint64_t pipelineCacheNumHits;
+	uint64_t pipelineCacheNumMisses;
+	uint64_t pipelineCacheNumEvictions;
+	uint64_t pipelineCacheSizeBytes;
+
+	// Shader hot-reload counters since the context was initialized. Always zero if shader
+	// hot-reload is not enabled.
+	uint64_t shaderHotReloadNumReloads;
+	uint64_t shaderHotReloadNumFailures;
+
+	// Descriptor heap usage, see ZgDescriptorSettings. The number of descriptors in segments
+	// currently used by command lists being recorded or executed, the highest that number has been
+	// since the context was initialized, and the size of the heap. Also the number of times a
+	// segment allocation had to wait for the GPU, or failed because all segments were in use by
+	// command lists being recorded.
+	uint32_t descriptorsNumInUse;
+	uint32_t descriptorsPeakNumInUse;
+	uint32_t descriptorsNumTotal;
+	uint64_t descriptorsNumWaits;
+	uint64_t descriptorsNumFailures;
+
+	// The number of bindless descriptors in use (i.e. buffers and textures with a bindless
+	// index) and reserved, see ZgDescriptorSettings::numBindlessDescriptors.
+	uint32_t descriptorsBindlessNumInUse;
+	uint32_t descriptorsBindlessNumTotal;
 };
 typedef struct ZgStats ZgStats;
 
@@ -346,6 +565,43 @@ typedef struct ZgStats ZgStats;
 // of times) per frame.
 ZG_API ZgResult zgContextGetStats(ZgStats* statsOut);
 
+// The maximum number of distinct allocation names tracked by zgContextGetCpuAllocationStats(),
+// allocations with names beyond this are aggregated under the name "Other".
+static const uint32_t ZG_MAX_NUM_CPU_ALLOCATION_TAGS = 256;
+
+// CPU allocation statistics for all allocations made with the same name (see ZgAllocator)
+struct ZgCpuAllocationTagStats {
+
+	// The name passed to ZgAllocator::allocate(), truncated if too long
+	char name[64];
+
+	// The number of allocations with this name currently alive
+	uint64_t numLiveAllocations;
+
+	// The number of bytes allocated with this name currently alive
+	uint64_t liveBytes;
+
+	// The highest number of bytes alive with this name at any point
+	uint64_t peakLiveBytes;
+
+	// The total number of allocations made with this name since the context was initialized
+	uint64_t totalNumAllocations;
+};
+typedef struct ZgCpuAllocationTagStats ZgCpuAllocationTagStats;
+
+// Gets statistics for all CPU memory allocated by ZeroG through the ZgAllocator, aggregated by
+// the name of the allocations.
+//
+// Writes at most maxNumStats entries to statsOut and the number of entries available to
+// numStatsOut. Call with statsOut set to nullptr to only query the number of entries.
+//
+// Requires ZgContextInitSettings::trackCpuAllocations, otherwise numStatsOut is set to 0 and
+// ZG_WARNING_GENERIC is returned.
+ZG_API ZgResult zgContextGetCpuAllocationStats(
+	ZgCpuAllocationTagStats* statsOut,
+	uint32_t maxNumStats,
+	uint32_t* numStatsOut);
+
 // Texture formats
 // ------------------------------------------------------------------------------------------------
 
@@ -456,6 +712,10 @@ struct ZgConstantBufferDesc {
 	// constant. In addition, Microsoft recommends keeping the root signature smaller than 16
 	// words to maximize performance on some hardware.
 	ZgBool pushConstant;
+
+	// Whether the buffer is bound as a root constant buffer or not, see
+	// zgCommandListSetRootConstantBuffer()
+	ZgBool rootConstantBuffer;
 };
 typedef struct ZgConstantBufferDesc ZgConstantBufferDesc;
 
@@ -492,6 +752,10 @@ struct ZgPipelineRenderSignature {
 	// Render targets
 	uint32_t numRenderTargets;
 	ZgTextureFormat renderTargets[ZG_MAX_NUM_RENDER_TARGETS];
+
+	// Whether the shaders access bindless textures and/or buffers, see zgBufferGetBindlessIndex()
+	ZgBool bindlessTextures;
+	ZgBool bindlessBuffers;
 };
 typedef struct ZgPipelineRenderSignature ZgPipelineRenderSignature;
 
@@ -681,6 +945,12 @@ struct ZgPipelineRenderCreateInfoCommon {
 
 	// Depth test settings
 	ZgDepthTestSettings depthTest;
+
+	// A list of constant buffer registers which should be bound directly as root constant buffers,
+	// see zgCommandListSetRootConstantBuffer(). Can't also be push constants. These are not part
+	// of the pipeline bindings, so changing them doesn't require any descriptors.
+	uint32_t numRootConstantBuffers;
+	uint32_t rootConstantBufferRegisters[ZG_MAX_NUM_CONSTANT_BUFFERS];
 };
 typedef struct ZgPipelineRenderCreateInfoCommon ZgPipelineRenderCreateInfoCommon;
 
@@ -694,6 +964,19 @@ ZG_API ZgResult zgPipelineRenderGetSignature(
 // Pipeline Render - SPIRV
 // ------------------------------------------------------------------------------------------------
 
+// The maximum number of specialization constants that can be set when creating a pipeline
+static const uint32_t ZG_MAX_NUM_SPECIALIZATION_CONSTANTS = 16;
+
+// Overrides the default value of a SPIR-V specialization constant, i.e. a constant declared with
+// layout(constant_id = X) in GLSL or [[vk::constant_id(X)]] in HLSL. Applies to both the vertex
+// and pixel shader, a constant id only has to exist in one of them. Only 32-bit scalars are
+// supported, booleans are 0 or 1 and floats are specified by their bit pattern.
+struct ZgSpecializationConstant {
+	uint32_t constantId;
+	uint32_t value;
+};
+typedef struct ZgSpecializationConstant ZgSpecializationConstant;
+
 struct ZgPipelineRenderCreateInfoFileSPIRV {
 
 	// The common information always needed to create a render pipeline
@@ -702,6 +985,10 @@ struct ZgPipelineRenderCreateInfoFileSPIRV {
 	// Paths to the shader files
 	const char* vertexShaderPath;
 	const char* pixelShaderPath;
+
+	// Specialization constants to override, each constant id may only appear once
+	uint32_t numSpecializationConstants;
+	ZgSpecializationConstant specializationConstants[ZG_MAX_NUM_SPECIALIZATION_CONSTANTS];
 };
 typedef struct ZgPipelineRenderCreateInfoFileSPIRV ZgPipelineRenderCreateInfoFileSPIRV;
 
@@ -710,6 +997,31 @@ ZG_API ZgResult zgPipelineRenderCreateFromFileSPIRV(
 	ZgPipelineRenderSignature* signatureOut,
 	const ZgPipelineRenderCreateInfoFileSPIRV* createInfo);
 
+struct ZgPipelineRenderCreateInfoMemorySPIRV {
+
+	// The common information always needed to create a render pipeline
+	ZgPipelineRenderCreateInfoCommon common;
+
+	// The SPIR-V words of each shader, sizes are in bytes and must be a multiple of 4. Only needs
+	// to stay valid for the duration of the call.
+	const uint32_t* vertexShaderSpirv;
+	uint32_t vertexShaderSpirvSizeBytes;
+	const uint32_t* pixelShaderSpirv;
+	uint32_t pixelShaderSpirvSizeBytes;
+
+	// Specialization constants to override, each constant id may only appear once
+	uint32_t numSpecializationConstants;
+	ZgSpecializationConstant specializationConstants[ZG_MAX_NUM_SPECIALIZATION_CONSTANTS];
+};
+typedef struct ZgPipelineRenderCreateInfoMemorySPIRV ZgPipelineRenderCreateInfoMemorySPIRV;
+
+// Same as zgPipelineRenderCreateFromFileSPIRV(), but with SPIR-V that is already in memory (e.g.
+// loaded from a pak file or generated at runtime). Shares pipeline cache entries with it.
+ZG_API ZgResult zgPipelineRenderCreateFromMemorySPIRV(
+	ZgPipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoMemorySPIRV* createInfo);
+
 // Pipeline Render - HLSL
 // ------------------------------------------------------------------------------------------------
 
@@ -726,6 +1038,18 @@ typedef uint32_t ZgShaderModel;
 // The maximum number of compiler flags allowed to the DXC shader compiler
 static const uint32_t ZG_MAX_NUM_DXC_COMPILER_FLAGS = 8;
 
+// The maximum number of preprocessor defines allowed to the DXC shader compiler
+static const uint32_t ZG_MAX_NUM_SHADER_DEFINES = 16;
+
+// A preprocessor define, the same as passing "-D name=value" to DXC. If value is null the name is
+// defined as 1. Defines are not compiler flags, so they don't count against
+// ZG_MAX_NUM_DXC_COMPILER_FLAGS.
+struct ZgShaderDefine {
+	const char* name;
+	const char* value;
+};
+typedef struct ZgShaderDefine ZgShaderDefine;
+
 struct ZgPipelineRenderCreateInfoFileHLSL {
 
 	// The common information always needed to create a render pipeline
@@ -738,6 +1062,10 @@ struct ZgPipelineRenderCreateInfoFileHLSL {
 	// Information to the DXC compiler
 	ZgShaderModel shaderModel;
 	const char* dxcCompilerFlags[ZG_MAX_NUM_DXC_COMPILER_FLAGS];
+
+	// Preprocessor defines, each name may only appear once
+	uint32_t numDefines;
+	ZgShaderDefine defines[ZG_MAX_NUM_SHADER_DEFINES];
 };
 typedef struct ZgPipelineRenderCreateInfoFileHLSL ZgPipelineRenderCreateInfoFileHLSL;
 
@@ -758,6 +1086,10 @@ struct ZgPipelineRenderCreateInfoSourceHLSL {
 	// Information to the DXC compiler
 	ZgShaderModel shaderModel;
 	const char* dxcCompilerFlags[ZG_MAX_NUM_DXC_COMPILER_FLAGS];
+
+	// Preprocessor defines, each name may only appear once
+	uint32_t numDefines;
+	ZgShaderDefine defines[ZG_MAX_NUM_SHADER_DEFINES];
 };
 typedef struct ZgPipelineRenderCreateInfoSourceHLSL ZgPipelineRenderCreateInfoSourceHLSL;
 
@@ -766,6 +1098,211 @@ ZG_API ZgResult zgPipelineRenderCreateFromSourceHLSL(
 	ZgPipelineRenderSignature* signatureOut,
 	const ZgPipelineRenderCreateInfoSourceHLSL* createInfo);
 
+// Pipeline Render - DXIL
+// ------------------------------------------------------------------------------------------------
+
+struct ZgPipelineRenderCreateInfoMemoryDXIL {
+
+	// The common information always needed to create a render pipeline. The entry points are
+	// compiled into the DXIL, they are optional and only used for logging.
+	ZgPipelineRenderCreateInfoCommon common;
+
+	// Complete DXIL containers as output by DXC (including reflection, i.e. not compiled with
+	// -Qstrip_reflect), sizes in bytes. Only needs to stay valid for the duration of the call.
+	const void* vertexShaderDxil;
+	uint32_t vertexShaderDxilSizeBytes;
+	const void* pixelShaderDxil;
+	uint32_t pixelShaderDxilSizeBytes;
+};
+typedef struct ZgPipelineRenderCreateInfoMemoryDXIL ZgPipelineRenderCreateInfoMemoryDXIL;
+
+// Creates a pipeline from precompiled DXIL, no shader compilation is performed. Only supported
+// by the D3D12 backend.
+ZG_API ZgResult zgPipelineRenderCreateFromMemoryDXIL(
+	ZgPipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoMemoryDXIL* createInfo);
+
+// Pipeline Render - Shader archive
+// ------------------------------------------------------------------------------------------------
+
+// A shader archive is a single file with precompiled shaders for many render pipelines, created
+// from SPIR-V at build time by ZeroG-ShaderCompiler (see zgCompileShaderArchive() in ZeroG.cmake).
+// It contains the cross-compiled shaders and reflection of each pipeline, so creating a pipeline
+// from an archive skips reading individual files, SPIR-V reflection and cross-compilation.
+//
+// The archive is memory mapped and validated once when loaded, looking up pipelines in it is a
+// constant time hash table lookup. It must not be released while pipelines are being created
+// from it (including asynchronously), but pipelines created from it may outlive it.
+ZG_API ZgResult zgShaderArchiveLoad(
+	ZgShaderArchive** archiveOut,
+	const char* path);
+
+ZG_API void zgShaderArchiveRelease(
+	ZgShaderArchive* archive);
+
+// Checks if the archive contains a pipeline with the specified name
+ZG_API ZgResult zgShaderArchiveContains(
+	const ZgShaderArchive* archive,
+	const char* pipelineName,
+	ZgBool* containsOut);
+
+struct ZgPipelineRenderCreateInfoArchive {
+
+	// The common information always needed to create a render pipeline. The entry points are
+	// ignored, they are fixed by ZeroG-ShaderCompiler.
+	ZgPipelineRenderCreateInfoCommon common;
+
+	// The archive and the name the pipeline was given when the archive was compiled
+	const ZgShaderArchive* archive;
+	const char* pipelineName;
+};
+typedef struct ZgPipelineRenderCreateInfoArchive ZgPipelineRenderCreateInfoArchive;
+
+ZG_API ZgResult zgPipelineRenderCreateFromArchive(
+	ZgPipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoArchive* createInfo);
+
+// Pipeline Render - Async
+// ------------------------------------------------------------------------------------------------
+
+// Asynchronous versions of the pipeline creation functions above. They return a pending handle
+// immediately, while the pipeline is created (shader cross-compilation, DXC compilation and PSO
+// creation) on the job system's worker threads. The create info (including all strings and
+// shader bytecode in it) is copied, so it does not need to outlive the call.
+//
+// Requires internal worker threads (ZgJobSystemSettings::numWorkerThreads), otherwise the
+// pipeline is created on the calling thread and the handle is ready once the call returns.
+//
+// Returns an error directly only if the arguments are invalid or the handle could not be
+// allocated. Errors from the actual creation are returned by zgPipelineRenderPendingWait().
+ZG_API ZgResult zgPipelineRenderCreateFromFileSPIRVAsync(
+	ZgPipelineRenderPending** pendingOut,
+	const ZgPipelineRenderCreateInfoFileSPIRV* createInfo);
+
+ZG_API ZgResult zgPipelineRenderCreateFromMemorySPIRVAsync(
+	ZgPipelineRenderPending** pendingOut,
+	const ZgPipelineRenderCreateInfoMemorySPIRV* createInfo);
+
+ZG_API ZgResult zgPipelineRenderCreateFromFileHLSLAsync(
+	ZgPipelineRenderPending** pendingOut,
+	const ZgPipelineRenderCreateInfoFileHLSL* createInfo);
+
+ZG_API ZgResult zgPipelineRenderCreateFromSourceHLSLAsync(
+	ZgPipelineRenderPending** pendingOut,
+	const ZgPipelineRenderCreateInfoSourceHLSL* createInfo);
+
+ZG_API ZgResult zgPipelineRenderCreateFromMemoryDXILAsync(
+	ZgPipelineRenderPending** pendingOut,
+	const ZgPipelineRenderCreateInfoMemoryDXIL* createInfo);
+
+ZG_API ZgResult zgPipelineRenderCreateFromArchiveAsync(
+	ZgPipelineRenderPending** pendingOut,
+	const ZgPipelineRenderCreateInfoArchive* createInfo);
+
+// Releases the pending handle. Blocks until the creation has finished if it has not already, an
+// in-flight creation can not be cancelled. If the pipeline was never retrieved with
+// zgPipelineRenderPendingWait() it is released as well.
+//
+// All pending handles must be released before zgContextDeinit() is called.
+ZG_API void zgPipelineRenderPendingRelease(
+	ZgPipelineRenderPending* pending);
+
+// Checks if the creation has finished, i.e. if zgPipelineRenderPendingWait() would not block.
+ZG_API ZgResult zgPipelineRenderPendingIsReady(
+	const ZgPipelineRenderPending* pending,
+	ZgBool* readyOut);
+
+// Blocks until the creation has finished (helping out with queued jobs while waiting) and returns
+// its result. On success ownership of the pipeline is transferred to the caller, who must release
+// it with zgPipelineRenderRelease() as usual. Can only retrieve the pipeline once.
+ZG_API ZgResult zgPipelineRenderPendingWait(
+	ZgPipelineRenderPending* pending,
+	ZgPipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut);
+
+// Pipeline Render - Permutations
+// ------------------------------------------------------------------------------------------------
+
+// A permutation set creates variants of a base pipeline on demand, each variant compiled with the
+// base create info's defines (HLSL) or specialization constants (SPIR-V) plus those of a
+// permutation. Meant for e.g. material systems with a large number of possible permutations, of
+// which only the ones actually requested are compiled.
+//
+// Each distinct permutation is compiled at most once, the first time it is requested (also if
+// compilation fails, in which case the error is remembered and returned on every request).
+// Permutations whose compiled shaders end up identical share a single pipeline, e.g. when a
+// define only affects code that was optimized away.
+//
+// The pipelines are owned by the set and must not be released by the user, they stay valid until
+// the set is released. They are not registered for shader hot-reload. All functions are
+// thread-safe, the set may not be released while a permutation is requested though. All sets must
+// be released before zgContextDeinit() is called.
+
+// The defines or specialization constants a permutation adds to those of the base create info.
+// One with the same name (or constant id) as in the base create info replaces it. The order does
+// not matter, permutations with the same set of defines and constants are the same permutation.
+struct ZgPipelineRenderPermutation {
+
+	// Defines (HLSL only), ignored if the base create info is SPIR-V
+	uint32_t numDefines;
+	ZgShaderDefine defines[ZG_MAX_NUM_SHADER_DEFINES];
+
+	// Specialization constants (SPIR-V only), ignored if the base create info is HLSL
+	uint32_t numSpecializationConstants;
+	ZgSpecializationConstant specializationConstants[ZG_MAX_NUM_SPECIALIZATION_CONSTANTS];
+};
+typedef struct ZgPipelineRenderPermutation ZgPipelineRenderPermutation;
+
+struct ZgPipelineRenderPermutationsStats {
+
+	// The number of distinct permutations that have been requested, including failed ones
+	uint32_t numPermutations;
+
+	// The number of permutations that failed to compile
+	uint32_t numFailedPermutations;
+
+	// The number of unique pipelines the successful permutations share
+	uint32_t numPipelines;
+};
+typedef struct ZgPipelineRenderPermutationsStats ZgPipelineRenderPermutationsStats;
+
+// Creates a permutation set, nothing is compiled until a permutation is requested. The create
+// info (including all strings and SPIR-V in it) is copied, shader files are read when compiling.
+ZG_API ZgResult zgPipelineRenderPermutationsCreateFromFileSPIRV(
+	ZgPipelineRenderPermutations** permutationsOut,
+	const ZgPipelineRenderCreateInfoFileSPIRV* createInfo);
+
+ZG_API ZgResult zgPipelineRenderPermutationsCreateFromMemorySPIRV(
+	ZgPipelineRenderPermutations** permutationsOut,
+	const ZgPipelineRenderCreateInfoMemorySPIRV* createInfo);
+
+ZG_API ZgResult zgPipelineRenderPermutationsCreateFromFileHLSL(
+	ZgPipelineRenderPermutations** permutationsOut,
+	const ZgPipelineRenderCreateInfoFileHLSL* createInfo);
+
+ZG_API ZgResult zgPipelineRenderPermutationsCreateFromSourceHLSL(
+	ZgPipelineRenderPermutations** permutationsOut,
+	const ZgPipelineRenderCreateInfoSourceHLSL* createInfo);
+
+// Releases the set and all pipelines created by it
+ZG_API void zgPipelineRenderPermutationsRelease(
+	ZgPipelineRenderPermutations* permutations);
+
+// Returns the pipeline for a permutation, compiling it on the calling thread if it has not been
+// requested before. If another thread is compiling the same permutation, waits for it instead.
+// The permutation may be null, which is the same as one without defines and constants.
+ZG_API ZgResult zgPipelineRenderPermutationsGet(
+	ZgPipelineRenderPermutations* permutations,
+	const ZgPipelineRenderPermutation* permutation,
+	ZgPipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut);
+
+ZG_API ZgResult zgPipelineRenderPermutationsGetStats(
+	ZgPipelineRenderPermutations* permutations,
+	ZgPipelineRenderPermutationsStats* statsOut);
+
 // Memory Heap
 // ------------------------------------------------------------------------------------------------
 
@@ -808,6 +1345,9 @@ struct ZgMemoryHeapCreateInfo {
 
 	// The type of memory
 	ZgMemoryType memoryType;
+
+	// [Optional] The residency priority of the heap, see ZgResidencySettings
+	ZgResidencyPriority residencyPriority;
 };
 typedef struct ZgMemoryHeapCreateInfo ZgMemoryHeapCreateInfo;
 
@@ -818,6 +1358,42 @@ ZG_API ZgResult zgMemoryHeapCreate(
 ZG_API ZgResult zgMemoryHeapRelease(
 	ZgMemoryHeap* memoryHeap);
 
+ZG_API ZgResult zgMemoryHeapSetResidencyPriority(
+	ZgMemoryHeap* memoryHeap,
+	ZgResidencyPriority priority);
+
+// Statistics about how the memory of a heap is used by the buffers and textures placed in it
+struct ZgMemoryHeapStats {
+
+	// The size of the heap in bytes
+	uint64_t sizeInBytes;
+
+	// The number of bytes occupied by live buffers and textures. Memory shared by several
+	// resources (i.e. aliased) is only counted once.
+	uint64_t usedBytes;
+
+	// The number of bytes not occupied by any resource
+	uint64_t freeBytes;
+
+	// The size of the largest contiguous free block of memory in the heap
+	uint64_t largestFreeBlockInBytes;
+
+	// The number of live buffers and textures placed in the heap
+	uint32_t numAllocations;
+
+	// The number of contiguous free blocks of memory in the heap
+	uint32_t numFreeBlocks;
+
+	// How fragmented the free memory is, "1 - largestFreeBlock / free". 0 means all free memory
+	// is in one contiguous block, values close to 1 means it is spread out in many small blocks.
+	float fragmentation;
+};
+typedef struct ZgMemoryHeapStats ZgMemoryHeapStats;
+
+ZG_API ZgResult zgMemoryHeapGetStats(
+	ZgMemoryHeap* memoryHeap,
+	ZgMemoryHeapStats* statsOut);
+
 // Buffer
 // ------------------------------------------------------------------------------------------------
 
@@ -850,6 +1426,33 @@ ZG_API ZgResult zgBufferSetDebugName(
 	ZgBuffer* buffer,
 	const char* name);
 
+// Reads a range of a file directly into an UPLOAD buffer, without any intermediate CPU copy.
+//
+// The read is performed asynchronously where supported by the platform. The returned ZgFileRead
+// works similar to a ZgFence, it can be polled or waited upon to know when the read has finished.
+// The buffer range must not be used (by the CPU or GPU) until the read is done. Releasing the
+// ZgFileRead before the read is done cancels it.
+//
+// If numBytes is 0 the rest of the file (starting at fileOffsetBytes) is read.
+ZG_API ZgResult zgBufferReadFile(
+	ZgBuffer* dstBuffer,
+	uint64_t bufferOffsetBytes,
+	const char* path,
+	uint64_t fileOffsetBytes,
+	uint64_t numBytes,
+	ZgFileRead** fileReadOut);
+
+ZG_API void zgFileReadRelease(
+	ZgFileRead* fileRead);
+
+// Checks if the read is done. Returns the error if the read has failed.
+ZG_API ZgResult zgFileReadCheckIfDone(
+	ZgFileRead* fileRead,
+	ZgBool* doneOut);
+
+ZG_API ZgResult zgFileReadWaitOnCpuBlocking(
+	ZgFileRead* fileRead);
+
 // Textures
 // ------------------------------------------------------------------------------------------------
 
@@ -916,6 +1519,12 @@ struct ZgTexture2DAllocationInfo {
 
 	// The alignment of the texture in bytes
 	uint32_t alignmentInBytes;
+
+	// The size in bytes of the upload buffer region required to upload all mip levels of the
+	// texture at once using zgCommandListMemcpyToTextureMipChain(). Always a multiple of
+	// ZG_TEXTURE_UPLOAD_ALIGNMENT, so several textures can be packed back-to-back in the same
+	// upload buffer.
+	uint32_t uploadSizeInBytes;
 };
 typedef struct ZgTexture2DAllocationInfo ZgTexture2DAllocationInfo;
 
@@ -929,6 +1538,32 @@ ZG_API ZgResult zgMemoryHeapTexture2DCreate(
 	ZgTexture2D** textureOut,
 	const ZgTexture2DCreateInfo* createInfo);
 
+// A render target or depth buffer that is only used during a window of passes within a frame
+struct ZgTransientTexture2D {
+
+	// The texture to create. The "offsetInBytes" and "sizeInBytes" members are calculated by
+	// zgTexture2DCalculateTransientPlacement() and need not be set.
+	ZgTexture2DCreateInfo createInfo;
+
+	// The index of the first and last pass (inclusive) in the frame that uses this texture.
+	uint32_t firstPassIdx;
+	uint32_t lastPassIdx;
+};
+typedef struct ZgTransientTexture2D ZgTransientTexture2D;
+
+// Calculates where to place a set of transient textures in a ZG_MEMORY_TYPE_FRAMEBUFFER heap.
+//
+// Textures whose pass windows do not overlap may be placed at the same memory, i.e. aliased. The
+// "offsetInBytes" and "sizeInBytes" of each create info is written, after which a heap of size
+// heapSizeInBytesOut can be created and the textures created in it using the create infos.
+//
+// Because the textures may alias each other, zgCommandListActivateTransientTexture() must be
+// called before a transient texture is used in its first pass each frame.
+ZG_API ZgResult zgTexture2DCalculateTransientPlacement(
+	ZgTransientTexture2D* textures,
+	uint32_t numTextures,
+	uint64_t* heapSizeInBytesOut);
+
 ZG_API void zgTexture2DRelease(
 	ZgTexture2D* texture);
 
@@ -936,6 +1571,47 @@ ZG_API ZgResult zgTexture2DSetDebugName(
 	ZgTexture2D* texture,
 	const char* name);
 
+// Bindless
+// ------------------------------------------------------------------------------------------------
+
+// In bindless mode every buffer and texture gets a stable index into a global descriptor table
+// when it is created, enabled by setting ZgDescriptorSettings::numBindlessDescriptors. Shaders
+// access the resources through the index (e.g. passed in a push constant) instead of through
+// zgCommandListSetPipelineBindings(), so draws using different resources need no rebinding.
+//
+// The table is declared as an unbounded array in its own register space (HLSL) or descriptor set
+// (SPIR-V), binding 0. Textures and buffers share the same indices:
+//
+//     Texture2D gTextures[] : register(t0, space1);
+//     ByteAddressBuffer gBuffers[] : register(t0, space2);
+//
+//     layout(set = 1, binding = 0) uniform texture2D textures[];
+//     layout(set = 2, binding = 0) readonly buffer Buffers { uint data[]; } buffers[];
+//
+// Indices that may differ between pixels in a draw must be wrapped in NonUniformResourceIndex()
+// (HLSL) or nonuniformEXT() (GLSL). Only supported by the D3D12 backend, which requires resource
+// binding tier 2. The index of a released resource may be given to a new resource, so the GPU
+// must be done using the old one first (same as for any other use of a released resource).
+
+// The register space (HLSL) or descriptor set (SPIR-V) of the bindless textures
+static const uint32_t ZG_BINDLESS_TEXTURES_REGISTER_SPACE = 1;
+
+// The register space (HLSL) or descriptor set (SPIR-V) of the bindless buffers
+static const uint32_t ZG_BINDLESS_BUFFERS_REGISTER_SPACE = 2;
+
+// Gets the bindless index of a buffer. Fails if bindless is not enabled or if the buffer can't be
+// read by shaders (i.e. is in a DOWNLOAD heap). Buffers are accessed as raw (byte address)
+// buffers, a buffer whose size isn't a multiple of 4 is truncated.
+ZG_API ZgResult zgBufferGetBindlessIndex(
+	const ZgBuffer* buffer,
+	uint32_t* indexOut);
+
+// Gets the bindless index of a texture, all mip levels are accessible. Fails if bindless is not
+// enabled.
+ZG_API ZgResult zgTexture2DGetBindlessIndex(
+	const ZgTexture2D* texture,
+	uint32_t* indexOut);
+
 // Framebuffer
 // ------------------------------------------------------------------------------------------------
 
@@ -1041,6 +1717,7 @@ struct ZgImageViewConstCpu {
 	uint32_t height;
 	uint32_t pitchInBytes;
 };
+typedef struct ZgImageViewConstCpu ZgImageViewConstCpu;
 
 // Copies an image from the CPU to a texture on the GPU.
 //
@@ -1056,6 +1733,30 @@ ZG_API ZgResult zgCommandListMemcpyToTexture(
 	const ZgImageViewConstCpu* srcImageCpu,
 	ZgBuffer* tempUploadBuffer);
 
+// The alignment required of the upload buffer offset passed to
+// zgCommandListMemcpyToTextureMipChain().
+static const uint32_t ZG_TEXTURE_UPLOAD_ALIGNMENT = 512;
+
+// Copies a full mip chain from the CPU to a texture on the GPU using a single upload buffer.
+//
+// srcImagesCpu must contain one image per mip level of the texture (numMipLevels must equal the
+// number of mipmaps the texture was created with), level 0 first. All levels are (synchronously)
+// copied into the upload buffer starting at tempUploadBufferOffsetBytes, and then asynchronously
+// copied to the texture.
+//
+// The upload buffer region must be at least the "uploadSizeInBytes" returned by
+// zgTexture2DGetAllocationInfo(), and the offset must be a multiple of
+// ZG_TEXTURE_UPLOAD_ALIGNMENT. By using different offsets, multiple textures can be uploaded
+// through the same upload buffer. The upload buffer must not be touched until this command list
+// has finished executing.
+ZG_API ZgResult zgCommandListMemcpyToTextureMipChain(
+	ZgCommandList* commandList,
+	ZgTexture2D* dstTexture,
+	const ZgImageViewConstCpu* srcImagesCpu,
+	uint32_t numMipLevels,
+	ZgBuffer* tempUploadBuffer,
+	uint64_t tempUploadBufferOffsetBytes);
+
 // Transitions the specified buffer from copy queue -> other queues and vice versa.
 //
 // In order to switch a resource from usage on a e.g. copy queue to a graphics queue or vice versa
@@ -1075,12 +1776,40 @@ ZG_API ZgResult zgCommandListEnableQueueTransitionTexture(
 	ZgCommandList* commandList,
 	ZgTexture2D* texture);
 
+// Activates a transient texture (see zgTexture2DCalculateTransientPlacement()) before its first
+// use in a frame.
+//
+// Inserts an aliasing barrier (any texture sharing memory with this one is no longer valid) and
+// discards the previous contents of the texture. The texture must be a render target or depth
+// buffer, and should be cleared or fully overwritten afterwards.
+ZG_API ZgResult zgCommandListActivateTransientTexture(
+	ZgCommandList* commandList,
+	ZgTexture2D* texture);
+
 ZG_API ZgResult zgCommandListSetPushConstant(
 	ZgCommandList* commandList,
 	uint32_t shaderRegister,
 	const void* data,
 	uint32_t dataSizeInBytes);
 
+// The required alignment of offsets passed to zgCommandListSetRootConstantBuffer()
+static const uint64_t ZG_ROOT_CONSTANT_BUFFER_ALIGNMENT = 256;
+
+// Binds a range of a buffer to a root constant buffer register of the bound pipeline (see
+// ZgPipelineRenderCreateInfoCommon::rootConstantBufferRegisters).
+//
+// The buffer's GPU address plus the offset is stored directly in the root signature (D3D12), so
+// no descriptors are created. This allows e.g. the per-draw constants of many draws to be stored
+// at different offsets in one large (UPLOAD or DEVICE) buffer. The offset must be a multiple of
+// ZG_ROOT_CONSTANT_BUFFER_ALIGNMENT and the buffer must contain the entire constant buffer from
+// the offset. Like push constants, the binding is reset when a pipeline with a different layout
+// is set.
+ZG_API ZgResult zgCommandListSetRootConstantBuffer(
+	ZgCommandList* commandList,
+	uint32_t shaderRegister,
+	ZgBuffer* buffer,
+	uint64_t offsetInBytes);
+
 struct ZgConstantBufferBinding {
 	uint32_t shaderRegister;
 	ZgBuffer* buffer;
@@ -1108,6 +1837,20 @@ ZG_API ZgResult zgCommandListSetPipelineBindings(
 	ZgCommandList* commandList,
 	const ZgPipelineBindings* bindings);
 
+// Declares that the draws recorded after this call may access the buffers and textures through
+// their bindless indices. They are transitioned to a shader readable state and made resident when
+// the command list is executed, which is otherwise done by zgCommandListSetPipelineBindings().
+//
+// Only has to be called once per command list for each resource (e.g. once per pass for all
+// resources of all materials), unless the resource is used as something else (e.g. rendered to
+// or copied to) in between.
+ZG_API ZgResult zgCommandListUseBindlessResources(
+	ZgCommandList* commandList,
+	ZgBuffer* const* buffers,
+	uint32_t numBuffers,
+	ZgTexture2D* const* textures,
+	uint32_t numTextures);
+
 ZG_API ZgResult zgCommandListSetPipelineRender(
 	ZgCommandList* commandList,
 	ZgPipelineRender* pipeline);
@@ -1171,6 +1914,91 @@ ZG_API ZgResult zgCommandListDrawTrianglesIndexed(
 	uint32_t startIndex,
 	uint32_t numTriangles);
 
+// Texture streamer
+// ------------------------------------------------------------------------------------------------
+
+// A texture streamer uploads textures in the background using the copy queue.
+//
+// Requests are handled by a background thread owned by the streamer, highest priority first.
+// Multiple requests are batched into a single copy command list, all using a fixed size upload
+// ring buffer owned by the streamer. None of the functions below block on the GPU, they are meant
+// to be called from the render thread every frame.
+//
+// Once a request is returned by zgTextureStreamerGetCompleted() the texture has been transitioned
+// using zgCommandListEnableQueueTransitionTexture() and the copy queue has signaled its fence, so
+// the texture can immediately be used on the present queue.
+
+struct ZgTextureStreamerCreateInfo {
+
+	// The size in bytes of the upload ring buffer. Must be at least as large as the largest
+	// texture (i.e. its "uploadSizeInBytes") that will be streamed.
+	uint64_t uploadRingSizeInBytes;
+
+	// The maximum number of requests that can be in the streamer at the same time, this includes
+	// pending, in-flight and completed (but not yet retrieved) requests.
+	uint32_t maxNumRequests;
+
+	// The maximum number of copy command lists (batches) that can be in-flight at the same time.
+	uint32_t maxNumBatchesInFlight;
+};
+typedef struct ZgTextureStreamerCreateInfo ZgTextureStreamerCreateInfo;
+
+struct ZgTextureStreamRequest {
+
+	// The texture to upload to, must not be used by anything else until the request has
+	// completed.
+	ZgTexture2D* texture;
+
+	// The full mip chain of the texture, see zgCommandListMemcpyToTextureMipChain(). The CPU
+	// memory must be kept alive until the request has completed.
+	uint32_t numMipLevels;
+	ZgImageViewConstCpu mipLevels[ZG_MAX_NUM_MIPMAPS];
+
+	// The "uploadSizeInBytes" of the texture, acquired from zgTexture2DGetAllocationInfo().
+	// Requests specifying less than the texture actually requires are rejected.
+	uint32_t uploadSizeInBytes;
+
+	// The priority of the request, higher priority requests are uploaded first. Requests with the
+	// same priority are uploaded in the order they were requested.
+	uint32_t priority;
+};
+typedef struct ZgTextureStreamRequest ZgTextureStreamRequest;
+
+struct ZgTextureStreamCompletion {
+
+	// The identifier returned by zgTextureStreamerRequest()
+	uint64_t requestId;
+
+	// The texture that was uploaded to
+	ZgTexture2D* texture;
+
+	// Whether the upload succeeded or not
+	ZgResult result;
+};
+typedef struct ZgTextureStreamCompletion ZgTextureStreamCompletion;
+
+ZG_API ZgResult zgTextureStreamerCreate(
+	ZgTextureStreamer** streamerOut,
+	const ZgTextureStreamerCreateInfo* createInfo);
+
+// Releases the texture streamer. Waits until all in-flight batches have finished executing,
+// pending requests that have not yet started are dropped.
+ZG_API void zgTextureStreamerRelease(
+	ZgTextureStreamer* streamer);
+
+// Enqueues a request. Never blocks, returns ZG_ERROR_GENERIC if the streamer is full.
+ZG_API ZgResult zgTextureStreamerRequest(
+	ZgTextureStreamer* streamer,
+	const ZgTextureStreamRequest* request,
+	uint64_t* requestIdOut);
+
+// Retrieves (and removes) up to maxNumCompletions completed requests. Never blocks.
+ZG_API ZgResult zgTextureStreamerGetCompleted(
+	ZgTextureStreamer* streamer,
+	ZgTextureStreamCompletion* completionsOut,
+	uint32_t maxNumCompletions,
+	uint32_t* numCompletionsOut);
+
 // This entire header is pure C
 #ifdef __cplusplus
 } // extern "C"
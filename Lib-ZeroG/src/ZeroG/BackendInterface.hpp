@@ -20,6 +20,8 @@
 
 #include "ZeroG.h"
 
+namespace zg { struct ShaderArchivePipeline; }
+
 // Backend interface
 // ------------------------------------------------------------------------------------------------
 
@@ -53,6 +55,11 @@ struct ZgBackend {
 		ZgPipelineRenderSignature* signatureOut,
 		const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept = 0;
 
+	virtual ZgResult pipelineRenderCreateFromMemorySPIRV(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept = 0;
+
 	virtual ZgResult pipelineRenderCreateFromFileHLSL(
 		ZgPipelineRender** pipelineOut,
 		ZgPipelineRenderSignature* signatureOut,
@@ -63,13 +70,40 @@ struct ZgBackend {
 		ZgPipelineRenderSignature* signatureOut,
 		const ZgPipelineRenderCreateInfoSourceHLSL& createInfo) noexcept = 0;
 
+	virtual ZgResult pipelineRenderCreateFromMemoryDXIL(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoMemoryDXIL& createInfo) noexcept = 0;
+
+	// The pipeline's blobs point directly into a loaded shader archive
+	virtual ZgResult pipelineRenderCreateFromArchive(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoCommon& createInfo,
+		const zg::ShaderArchivePipeline& pipeline) noexcept = 0;
+
 	virtual ZgResult pipelineRenderRelease(
 		ZgPipelineRender* pipeline) noexcept = 0;
 
+	// Moves the replacement's shaders into the pipeline, keeping the pipeline's handle valid. The
+	// previous shaders are released once the GPU has finished all work submitted so far. Returns
+	// ZG_WARNING_GENERIC without doing anything if command lists which might use the pipeline are
+	// being recorded, in which case the caller keeps the replacement and should try again later.
+	// Otherwise takes ownership of the replacement, even on failure. Used by shader hot-reload.
+	virtual ZgResult pipelineRenderReplace(
+		ZgPipelineRender* pipeline,
+		ZgPipelineRender* replacement) noexcept = 0;
+
 	virtual ZgResult pipelineRenderGetSignature(
 		const ZgPipelineRender* pipeline,
 		ZgPipelineRenderSignature* signatureOut) const noexcept = 0;
 
+	// A hash of the pipeline's compiled shaders, equal for pipelines whose shaders compiled to the
+	// same code. Used to share pipelines between permutations.
+	virtual ZgResult pipelineRenderGetBytecodeHash(
+		const ZgPipelineRender* pipeline,
+		uint64_t& hashOut) const noexcept = 0;
+
 	// Memory methods
 	// --------------------------------------------------------------------------------------------
 
@@ -80,12 +114,24 @@ struct ZgBackend {
 	virtual ZgResult memoryHeapRelease(
 		ZgMemoryHeap* memoryHeap) noexcept = 0;
 
+	virtual ZgResult memoryHeapSetResidencyPriority(
+		ZgMemoryHeap* memoryHeap,
+		ZgResidencyPriority priority) noexcept = 0;
+
 	virtual ZgResult bufferMemcpyTo(
 		ZgBuffer* dstBufferInterface,
 		uint64_t bufferOffsetBytes,
 		const uint8_t* srcMemory,
 		uint64_t numBytes) noexcept = 0;
 
+	virtual ZgResult bufferReadFile(
+		ZgBuffer* dstBufferInterface,
+		uint64_t bufferOffsetBytes,
+		const char* path,
+		uint64_t fileOffsetBytes,
+		uint64_t numBytes,
+		ZgFileRead** fileReadOut) noexcept = 0;
+
 	// Texture methods
 	// --------------------------------------------------------------------------------------------
 
@@ -130,6 +176,8 @@ struct ZgMemoryHeap {
 	virtual ZgResult texture2DCreate(
 		ZgTexture2D** textureOut,
 		const ZgTexture2DCreateInfo& createInfo) noexcept = 0;
+
+	virtual ZgResult getStats(ZgMemoryHeapStats& statsOut) noexcept = 0;
 };
 
 // Buffers
@@ -140,6 +188,19 @@ struct ZgBuffer {
 
 	virtual ZgResult setDebugName(
 		const char* name) noexcept = 0;
+
+	virtual ZgResult getBindlessIndex(
+		uint32_t& indexOut) const noexcept = 0;
+};
+
+// File reads
+// ------------------------------------------------------------------------------------------------
+
+struct ZgFileRead {
+	virtual ~ZgFileRead() noexcept {}
+
+	virtual ZgResult checkIfDone(bool& doneOut) noexcept = 0;
+	virtual ZgResult waitOnCpuBlocking() noexcept = 0;
 };
 
 // Textures
@@ -150,6 +211,14 @@ struct ZgTexture2D {
 
 	virtual ZgResult setDebugName(
 		const char* name) noexcept = 0;
+
+	virtual ZgResult getBindlessIndex(
+		uint32_t& indexOut) const noexcept = 0;
+
+	// The number of bytes memcpyToTextureMipChain() writes to the upload buffer for the texture's
+	// full mip chain, rounded up to ZG_TEXTURE_UPLOAD_ALIGNMENT
+	virtual ZgResult getUploadSizeInBytes(
+		uint64_t& sizeOut) const noexcept = 0;
 };
 
 // Framebuffer
@@ -204,18 +273,38 @@ struct ZgCommandList {
 		const ZgImageViewConstCpu& srcImageCpu,
 		ZgBuffer* tempUploadBuffer) noexcept = 0;
 
+	virtual ZgResult memcpyToTextureMipChain(
+		ZgTexture2D* dstTexture,
+		const ZgImageViewConstCpu* srcImagesCpu,
+		uint32_t numMipLevels,
+		ZgBuffer* tempUploadBuffer,
+		uint64_t tempUploadBufferOffsetBytes) noexcept = 0;
+
 	virtual ZgResult enableQueueTransitionBuffer(ZgBuffer* buffer) noexcept = 0;
 
 	virtual ZgResult enableQueueTransitionTexture(ZgTexture2D* texture) noexcept = 0;
 
+	virtual ZgResult activateTransientTexture(ZgTexture2D* texture) noexcept = 0;
+
 	virtual ZgResult setPushConstant(
 		uint32_t shaderRegister,
 		const void* data,
 		uint32_t dataSizeInBytes) noexcept = 0;
 
+	virtual ZgResult setRootConstantBuffer(
+		uint32_t shaderRegister,
+		ZgBuffer* buffer,
+		uint64_t offsetInBytes) noexcept = 0;
+
 	virtual ZgResult setPipelineBindings(
 		const ZgPipelineBindings& bindings) noexcept = 0;
 
+	virtual ZgResult useBindlessResources(
+		ZgBuffer* const* buffers,
+		uint32_t numBuffers,
+		ZgTexture2D* const* textures,
+		uint32_t numTextures) noexcept = 0;
+
 	virtual ZgResult setPipelineRender(
 		ZgPipelineRender* pipeline) noexcept = 0;
 
@@ -22,6 +22,8 @@
 
 #include "ZeroG/BackendInterface.hpp"
 
+namespace zg { class JobSystem; class PipelineCache; class ShaderHotReload; }
+
 // Context definition
 // ------------------------------------------------------------------------------------------------
 
@@ -29,6 +31,9 @@ struct ZgContext final {
 	ZgAllocator allocator = {};
 	ZgLogger logger = {};
 	ZgBackend* backend = nullptr;
+	zg::JobSystem* jobSystem = nullptr;
+	zg::PipelineCache* pipelineCache = nullptr;
+	zg::ShaderHotReload* shaderHotReload = nullptr;
 };
 
 // Global implicit context accessor
@@ -0,0 +1,306 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/JobSystem.hpp"
+
+#include "ZeroG/Context.hpp"
+#include "ZeroG/util/CpuAllocation.hpp"
+#include "ZeroG/util/Logging.hpp"
+
+namespace zg {
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+constexpr uint32_t JOB_SYSTEM_DEQUE_CAPACITY = 4096;
+
+// Index of the worker the current thread is, ~0u if it is not a worker thread
+static thread_local uint32_t currentWorkerIdx = ~0u;
+
+// JobSystem: State methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult JobSystem::create(const ZgJobSystemSettings& settings) noexcept
+{
+	this->destroy();
+	mSettings = settings;
+
+	// No thread pool needed if host scheduler is used
+	if (mSettings.parallelFor != nullptr || mSettings.numWorkerThreads == 0) return ZG_SUCCESS;
+
+	if (!mWorkers.create(mSettings.numWorkerThreads, "ZeroG - JobSystem")) {
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+	for (uint32_t i = 0; i < mSettings.numWorkerThreads; i++) {
+		Worker* worker = zgNew<Worker>("ZeroG - JobSystem - Worker");
+		if (worker == nullptr) {
+			this->destroy();
+			return ZG_ERROR_CPU_OUT_OF_MEMORY;
+		}
+		mWorkers.add(worker);
+		worker->deque.create(JOB_SYSTEM_DEQUE_CAPACITY, "ZeroG - JobSystem - Deque");
+		if (worker->deque.capacity() == 0) {
+			this->destroy();
+			return ZG_ERROR_CPU_OUT_OF_MEMORY;
+		}
+	}
+
+	// Start threads once all workers exist, since they steal from each other
+	mExitRequested = false;
+	for (uint32_t i = 0; i < mWorkers.size(); i++) {
+		mWorkers[i]->thread = std::thread([this, i]() { this->workerLoop(i); });
+	}
+
+	return ZG_SUCCESS;
+}
+
+void JobSystem::destroy() noexcept
+{
+	// Wake up and join all worker threads
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mExitRequested = true;
+	}
+	mSleepCondVar.notify_all();
+	for (uint32_t i = 0; i < mWorkers.size(); i++) {
+		if (mWorkers[i]->thread.joinable()) mWorkers[i]->thread.join();
+	}
+
+	// Run jobs still queued (i.e. submitted detached jobs nobody waited on) so their
+	// completion counters reach zero
+	Job job;
+	while (this->popOrStealJob(~0u, job)) this->executeJob(job);
+
+	for (uint32_t i = 0; i < mWorkers.size(); i++) {
+		zgDelete(mWorkers[i]);
+	}
+	mWorkers.destroy();
+
+	mSettings = {};
+	mNextWorkerIdx = 0;
+	mNumQueuedJobs = 0;
+}
+
+// JobSystem: Methods
+// ------------------------------------------------------------------------------------------------
+
+void JobSystem::parallelFor(uint32_t numTasks, ZgTaskFunc* taskFunc, void* taskData) noexcept
+{
+	if (numTasks == 0) return;
+
+	// Use host scheduler if available
+	if (mSettings.parallelFor != nullptr) {
+		mSettings.parallelFor(mSettings.userPtr, numTasks, taskFunc, taskData);
+		return;
+	}
+
+	// Run serially if there is nothing to gain from pushing jobs
+	if (mWorkers.size() == 0 || numTasks == 1) {
+		for (uint32_t i = 0; i < numTasks; i++) taskFunc(taskData, i);
+		return;
+	}
+
+	// Push all tasks except the first one as jobs, the first one is run directly by this thread.
+	// Worker threads push to their own deque, other threads spread their jobs over all workers.
+	std::atomic_uint32_t numRemaining(numTasks);
+	uint32_t numPushed = 0;
+	for (uint32_t i = 1; i < numTasks; i++) {
+		Job job;
+		job.taskFunc = taskFunc;
+		job.taskData = taskData;
+		job.taskIdx = i;
+		job.numRemaining = &numRemaining;
+
+		uint32_t workerIdx = currentWorkerIdx != ~0u ?
+			currentWorkerIdx : (mNextWorkerIdx.fetch_add(1) % mWorkers.size());
+		if (this->pushJob(workerIdx, job)) numPushed += 1;
+		else this->executeJob(job); // Deque full, just run it
+	}
+
+	// Wake up workers
+	if (numPushed != 0) {
+		{
+			// Lock so a worker can't miss the notification between checking for jobs and waiting
+			std::lock_guard<std::mutex> lock(mSleepMutex);
+		}
+		if (numPushed == 1) mSleepCondVar.notify_one();
+		else mSleepCondVar.notify_all();
+	}
+
+	// Run first task
+	Job firstJob;
+	firstJob.taskFunc = taskFunc;
+	firstJob.taskData = taskData;
+	firstJob.taskIdx = 0;
+	firstJob.numRemaining = &numRemaining;
+	this->executeJob(firstJob);
+
+	// Help out until all tasks are done. The jobs executed here are not necessarily from this
+	// parallelFor() call, which keeps the thread busy if others have stolen all of ours.
+	this->waitFor(numRemaining);
+}
+
+void JobSystem::submit(
+	ZgTaskFunc* taskFunc, void* taskData, std::atomic_uint32_t& numRemaining) noexcept
+{
+	Job job;
+	job.taskFunc = taskFunc;
+	job.taskData = taskData;
+	job.taskIdx = 0;
+	job.numRemaining = &numRemaining;
+	numRemaining.fetch_add(1);
+
+	// Nowhere to queue the job if there are no worker threads, the host scheduler only provides
+	// blocking parallel for loops.
+	if (mWorkers.size() == 0) {
+		this->executeJob(job);
+		return;
+	}
+
+	uint32_t workerIdx = currentWorkerIdx != ~0u ?
+		currentWorkerIdx : (mNextWorkerIdx.fetch_add(1) % mWorkers.size());
+	if (!this->pushJob(workerIdx, job)) {
+		this->executeJob(job); // Deque full, just run it
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+	}
+	mSleepCondVar.notify_one();
+}
+
+void JobSystem::waitFor(const std::atomic_uint32_t& numRemaining) noexcept
+{
+	while (numRemaining.load(std::memory_order_acquire) != 0) {
+		Job job;
+		if (this->popOrStealJob(currentWorkerIdx, job)) this->executeJob(job);
+		else std::this_thread::yield();
+	}
+}
+
+// JobSystem: Private methods
+// ------------------------------------------------------------------------------------------------
+
+void JobSystem::workerLoop(uint32_t workerIdx) noexcept
+{
+	currentWorkerIdx = workerIdx;
+
+	while (true) {
+		Job job;
+		if (this->popOrStealJob(workerIdx, job)) {
+			this->executeJob(job);
+			continue;
+		}
+
+		// Sleep until there are jobs available or exit is requested
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mSleepCondVar.wait(lock, [this]() {
+			return mExitRequested.load() || mNumQueuedJobs.load() != 0;
+		});
+		if (mExitRequested) break;
+	}
+
+	currentWorkerIdx = ~0u;
+}
+
+bool JobSystem::pushJob(uint32_t workerIdx, const Job& job) noexcept
+{
+	Worker& worker = *mWorkers[workerIdx];
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	if (!worker.deque.add(job)) return false;
+	mNumQueuedJobs.fetch_add(1);
+	return true;
+}
+
+bool JobSystem::popOrStealJob(uint32_t ownWorkerIdx, Job& jobOut) noexcept
+{
+	if (mNumQueuedJobs.load() == 0) return false;
+
+	// Pop newest job from own deque (LIFO, likely hot in cache)
+	if (ownWorkerIdx != ~0u) {
+		Worker& worker = *mWorkers[ownWorkerIdx];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (worker.deque.popLast(jobOut)) {
+			mNumQueuedJobs.fetch_sub(1);
+			return true;
+		}
+	}
+
+	// Steal oldest job from another worker's deque (FIFO), starting with the next worker
+	const uint32_t numWorkers = mWorkers.size();
+	const uint32_t startIdx = ownWorkerIdx != ~0u ? ownWorkerIdx + 1 : 0;
+	for (uint32_t i = 0; i < numWorkers; i++) {
+		uint32_t victimIdx = (startIdx + i) % numWorkers;
+		if (victimIdx == ownWorkerIdx) continue;
+		Worker& victim = *mWorkers[victimIdx];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (victim.deque.pop(jobOut)) {
+			mNumQueuedJobs.fetch_sub(1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::executeJob(const Job& job) noexcept
+{
+	job.taskFunc(job.taskData, job.taskIdx);
+	job.numRemaining->fetch_sub(1, std::memory_order_release);
+}
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+void parallelFor(uint32_t numTasks, ZgTaskFunc* taskFunc, void* taskData) noexcept
+{
+	JobSystem* jobSystem = getContext().jobSystem;
+	if (jobSystem != nullptr) {
+		jobSystem->parallelFor(numTasks, taskFunc, taskData);
+	}
+	else {
+		for (uint32_t i = 0; i < numTasks; i++) taskFunc(taskData, i);
+	}
+}
+
+void submit(ZgTaskFunc* taskFunc, void* taskData, std::atomic_uint32_t& numRemaining) noexcept
+{
+	JobSystem* jobSystem = getContext().jobSystem;
+	if (jobSystem != nullptr) {
+		jobSystem->submit(taskFunc, taskData, numRemaining);
+	}
+	else {
+		numRemaining.fetch_add(1);
+		taskFunc(taskData, 0);
+		numRemaining.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+void waitFor(const std::atomic_uint32_t& numRemaining) noexcept
+{
+	JobSystem* jobSystem = getContext().jobSystem;
+	if (jobSystem != nullptr) {
+		jobSystem->waitFor(numRemaining);
+	}
+	else {
+		while (numRemaining.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+	}
+}
+
+} // namespace zg
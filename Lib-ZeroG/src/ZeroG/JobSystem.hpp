@@ -0,0 +1,129 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "ZeroG.h"
+#include "ZeroG/util/RingBuffer.hpp"
+#include "ZeroG/util/Vector.hpp"
+
+namespace zg {
+
+// JobSystem
+// ------------------------------------------------------------------------------------------------
+
+// Runs parallel work, either on an internal work-stealing thread pool or on a host scheduler (see
+// ZgJobSystemSettings). Each worker thread has its own deque of jobs. Workers push and pop jobs
+// at the back of their own deque, and steal from the front of other workers' deques when they
+// run out of work. Threads outside the pool distribute their jobs over the workers' deques.
+class JobSystem final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	JobSystem() noexcept = default;
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator= (const JobSystem&) = delete;
+	JobSystem(JobSystem&&) = delete;
+	JobSystem& operator= (JobSystem&&) = delete;
+	~JobSystem() noexcept { this->destroy(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	ZgResult create(const ZgJobSystemSettings& settings) noexcept;
+	void destroy() noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	// Calls taskFunc(taskData, i) for every i in [0, numTasks) and returns once all calls have
+	// returned. The calling thread helps out executing jobs while waiting. Safe to call from
+	// multiple threads at once, and from within tasks.
+	void parallelFor(uint32_t numTasks, ZgTaskFunc* taskFunc, void* taskData) noexcept;
+
+	// Queues taskFunc(taskData, 0) to run on a worker thread and returns immediately. numRemaining
+	// is incremented before the job is queued and decremented once it has returned. The job is
+	// run directly on the calling thread if there are no internal worker threads.
+	void submit(
+		ZgTaskFunc* taskFunc, void* taskData, std::atomic_uint32_t& numRemaining) noexcept;
+
+	// Blocks until numRemaining reaches 0, executing queued jobs while waiting.
+	void waitFor(const std::atomic_uint32_t& numRemaining) noexcept;
+
+	// Getters
+	// --------------------------------------------------------------------------------------------
+
+	uint32_t numWorkerThreads() const noexcept { return mWorkers.size(); }
+
+private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	struct Job final {
+		ZgTaskFunc* taskFunc = nullptr;
+		void* taskData = nullptr;
+		uint32_t taskIdx = 0;
+		std::atomic_uint32_t* numRemaining = nullptr;
+	};
+
+	struct Worker final {
+		std::mutex mutex;
+		RingBuffer<Job> deque;
+		std::thread thread;
+	};
+
+	// Private methods
+	// --------------------------------------------------------------------------------------------
+
+	void workerLoop(uint32_t workerIdx) noexcept;
+	bool pushJob(uint32_t workerIdx, const Job& job) noexcept;
+	bool popOrStealJob(uint32_t ownWorkerIdx, Job& jobOut) noexcept;
+	void executeJob(const Job& job) noexcept;
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	ZgJobSystemSettings mSettings = {};
+	Vector<Worker*> mWorkers;
+	std::atomic_uint32_t mNextWorkerIdx = 0;
+	std::atomic_uint32_t mNumQueuedJobs = 0;
+	std::atomic_bool mExitRequested = false;
+	std::mutex mSleepMutex;
+	std::condition_variable mSleepCondVar;
+};
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+// Runs the tasks on the context's job system. Runs them serially on the calling thread if there
+// is none.
+void parallelFor(uint32_t numTasks, ZgTaskFunc* taskFunc, void* taskData) noexcept;
+
+// Submits a detached job to the context's job system, see JobSystem::submit() and
+// JobSystem::waitFor(). Runs the job directly on the calling thread if there is no job system.
+void submit(ZgTaskFunc* taskFunc, void* taskData, std::atomic_uint32_t& numRemaining) noexcept;
+void waitFor(const std::atomic_uint32_t& numRemaining) noexcept;
+
+} // namespace zg
@@ -23,6 +23,7 @@
 
 #include "ZeroG/Context.hpp"
 #include "ZeroG/util/Assert.hpp"
+#include "ZeroG/util/ScopedArena.hpp"
 
 // About
 // ------------------------------------------------------------------------------------------------
@@ -30,62 +31,97 @@
 // By linking these defintions operator new and delete is overloaded for all code in the ZeroG dll.
 // This is mainly used to make third-party libraries (such as SPIRV-Cross) use the user defined
 // ZeroG allocator instead of the normal global heap.
+//
+// If a zg::ScopedArena is active on the calling thread allocations are made from it instead, and
+// deleting memory owned by it is a no-op.
+//
+// Only done on Windows, where operator new and delete are resolved per module. On Linux the
+// overloads would either replace the operators of the entire process, or (if made local to the
+// shared library) only apply to the standard library code inlined into ZeroG. The latter means
+// e.g. a std::string allocated by out-of-line libstdc++ code could be freed by ZeroG's operator
+// delete, or the other way around.
 
-// Operator new
+#ifdef _WIN32
+
+// Helpers
 // ------------------------------------------------------------------------------------------------
 
-#ifdef _WIN32
+static void* zgOperatorNew(std::size_t count, const char* name) noexcept
+{
+	zg::ScopedArena* arena = zg::ScopedArena::current();
+	if (arena != nullptr) return arena->allocate(count);
 
-void* operator new (std::size_t count)
+	ZgAllocator& allocator = zg::getContext().allocator;
+	return allocator.allocate(allocator.userPtr, uint32_t(count), name);
+}
+
+static void zgOperatorDelete(void* ptr) noexcept
 {
+	if (ptr == nullptr) return;
+
+	// Memory owned by an arena is freed when the arena is destroyed
+	zg::ScopedArena* arena = zg::ScopedArena::current();
+	if (arena != nullptr && arena->owns(ptr)) return;
+
 	ZgAllocator& allocator = zg::getContext().allocator;
-	return allocator.allocate(allocator.userPtr, uint32_t(count), "operator new");
+	if (allocator.deallocate != nullptr) {
+		return allocator.deallocate(allocator.userPtr, ptr);
+	}
+	else {
+#ifndef NDEBUG
+		printf("ZeroG: No allocator set, attempting to deallocate: %llx. Expected if process is terminating.\n",
+			(unsigned long long)uintptr_t(ptr));
+#endif
+	}
+}
+
+// Operator new
+// ------------------------------------------------------------------------------------------------
+
+void* operator new (std::size_t count)
+{
+	return zgOperatorNew(count, "operator new");
 }
 
 void* operator new[] (std::size_t count)
 {
-	ZgAllocator& allocator = zg::getContext().allocator;
-	return allocator.allocate(allocator.userPtr, uint32_t(count), "operator new[]");
+	return zgOperatorNew(count, "operator new[]");
 }
 
 void* operator new (std::size_t count, std::align_val_t val)
 {
 	ZG_ASSERT(size_t(val) <= 32);
-	ZgAllocator& allocator = zg::getContext().allocator;
-	return allocator.allocate(allocator.userPtr, uint32_t(count), "operator new");
+	return zgOperatorNew(count, "operator new");
 }
 
 void* operator new[] (std::size_t count, std::align_val_t val)
 {
 	ZG_ASSERT(size_t(val) <= 32);
-	ZgAllocator& allocator = zg::getContext().allocator;
-	return allocator.allocate(allocator.userPtr, uint32_t(count), "operator new[]");
+	return zgOperatorNew(count, "operator new[]");
 }
 
 void* operator new (std::size_t count, const std::nothrow_t&) noexcept
 {
-	ZgAllocator& allocator = zg::getContext().allocator;
-	return allocator.allocate(allocator.userPtr, uint32_t(count), "operator new");
+	return zgOperatorNew(count, "operator new");
 }
 
 void* operator new[] (std::size_t count, const std::nothrow_t&) noexcept
 {
-	ZgAllocator& allocator = zg::getContext().allocator;
-	return allocator.allocate(allocator.userPtr, uint32_t(count), "operator new[]");
+	return zgOperatorNew(count, "operator new[]");
 }
 
-void* operator new (std::size_t count, std::align_val_t val, const std::nothrow_t&) noexcept
+void* operator new (
+	std::size_t count, std::align_val_t val, const std::nothrow_t&) noexcept
 {
 	ZG_ASSERT(size_t(val) <= 32);
-	ZgAllocator& allocator = zg::getContext().allocator;
-	return allocator.allocate(allocator.userPtr, uint32_t(count), "operator new");
+	return zgOperatorNew(count, "operator new");
 }
 
-void* operator new[] (std::size_t count, std::align_val_t val, const std::nothrow_t&) noexcept
+void* operator new[] (
+	std::size_t count, std::align_val_t val, const std::nothrow_t&) noexcept
 {
 	ZG_ASSERT(size_t(val) <= 32);
-	ZgAllocator& allocator = zg::getContext().allocator;
-	return allocator.allocate(allocator.userPtr, uint32_t(count), "operator new[]");
+	return zgOperatorNew(count, "operator new[]");
 }
 
 // Operator delete
@@ -93,122 +129,50 @@ void* operator new[] (std::size_t count, std::align_val_t val, const std::nothro
 
 void operator delete (void* ptr) noexcept
 {
-	ZgAllocator& allocator = zg::getContext().allocator;
-	if (allocator.deallocate != nullptr) {
-		return allocator.deallocate(allocator.userPtr, ptr);
-	}
-	else {
-#ifndef NDEBUG
-		printf("ZeroG: No allocator set, attempting to deallocate: %llx. Expected if process is terminating.\n",
-			uint64_t(ptr));
-#endif
-	}
+	zgOperatorDelete(ptr);
 }
 
 void operator delete[] (void* ptr) noexcept
 {
-	ZgAllocator& allocator = zg::getContext().allocator;
-	if (allocator.deallocate != nullptr) {
-		return allocator.deallocate(allocator.userPtr, ptr);
-	}
-	else {
-#ifndef NDEBUG
-		printf("ZeroG: No allocator set, attempting to deallocate: %llx. Expected if process is terminating.\n",
-			uint64_t(ptr));
-#endif
-	}
+	zgOperatorDelete(ptr);
 }
 
 void operator delete (void* ptr, std::align_val_t val) noexcept
 {
 	ZG_ASSERT(size_t(val) <= 32);
-	ZgAllocator& allocator = zg::getContext().allocator;
-	if (allocator.deallocate != nullptr) {
-		return allocator.deallocate(allocator.userPtr, ptr);
-	}
-	else {
-#ifndef NDEBUG
-		printf("ZeroG: No allocator set, attempting to deallocate: %llx. Expected if process is terminating.\n",
-			uint64_t(ptr));
-#endif
-	}
+	zgOperatorDelete(ptr);
 }
 
 void operator delete[] (void* ptr, std::align_val_t val) noexcept
 {
 	ZG_ASSERT(size_t(val) <= 32);
-	ZgAllocator& allocator = zg::getContext().allocator;
-	if (allocator.deallocate != nullptr) {
-		return allocator.deallocate(allocator.userPtr, ptr);
-	}
-	else {
-#ifndef NDEBUG
-		printf("ZeroG: No allocator set, attempting to deallocate: %llx. Expected if process is terminating.\n",
-			uint64_t(ptr));
-#endif
-	}
+	zgOperatorDelete(ptr);
 }
 
 void operator delete (void* ptr, std::size_t sz) noexcept
 {
 	(void)sz;
-	ZgAllocator& allocator = zg::getContext().allocator;
-	if (allocator.deallocate != nullptr) {
-		return allocator.deallocate(allocator.userPtr, ptr);
-	}
-	else {
-#ifndef NDEBUG
-		printf("ZeroG: No allocator set, attempting to deallocate: %llx. Expected if process is terminating.\n",
-			uint64_t(ptr));
-#endif
-	}
+	zgOperatorDelete(ptr);
 }
 
 void operator delete[] (void* ptr, std::size_t sz) noexcept
 {
 	(void)sz;
-	ZgAllocator& allocator = zg::getContext().allocator;
-	if (allocator.deallocate != nullptr) {
-		return allocator.deallocate(allocator.userPtr, ptr);
-	}
-	else {
-#ifndef NDEBUG
-		printf("ZeroG: No allocator set, attempting to deallocate: %llx. Expected if process is terminating.\n",
-			uint64_t(ptr));
-#endif
-	}
+	zgOperatorDelete(ptr);
 }
 
 void operator delete (void* ptr, std::size_t sz, std::align_val_t val) noexcept
 {
 	ZG_ASSERT(size_t(val) <= 32);
 	(void)sz;
-	ZgAllocator& allocator = zg::getContext().allocator;
-	if (allocator.deallocate != nullptr) {
-		return allocator.deallocate(allocator.userPtr, ptr);
-	}
-	else {
-#ifndef NDEBUG
-		printf("ZeroG: No allocator set, attempting to deallocate: %llx. Expected if process is terminating.\n",
-			uint64_t(ptr));
-#endif
-	}
+	zgOperatorDelete(ptr);
 }
 
 void operator delete[] (void* ptr, std::size_t sz, std::align_val_t val) noexcept
 {
 	ZG_ASSERT(size_t(val) <= 32);
 	(void)sz;
-	ZgAllocator& allocator = zg::getContext().allocator;
-	if (allocator.deallocate != nullptr) {
-		return allocator.deallocate(allocator.userPtr, ptr);
-	}
-	else {
-#ifndef NDEBUG
-		printf("ZeroG: No allocator set, attempting to deallocate: %llx. Expected if process is terminating.\n",
-			uint64_t(ptr));
-#endif
-	}
+	zgOperatorDelete(ptr);
 }
 
 #endif
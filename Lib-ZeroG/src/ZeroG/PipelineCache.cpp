@@ -0,0 +1,315 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/PipelineCache.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#include "ZeroG/util/FileIO.hpp"
+#include "ZeroG/util/Hash.hpp"
+#include "ZeroG/util/Logging.hpp"
+
+namespace zg {
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+namespace fs = std::filesystem;
+
+constexpr uint64_t PIPELINE_CACHE_DEFAULT_MAX_SIZE_BYTES = 256ull * 1024ull * 1024ull;
+constexpr uint32_t PIPELINE_CACHE_FILE_MAGIC = 0x4350475A; // "ZGPC"
+constexpr uint32_t PIPELINE_CACHE_FILE_VERSION = 1;
+constexpr uint32_t PIPELINE_CACHE_ENTRY_PATH_LENGTH = PIPELINE_CACHE_MAX_PATH_LENGTH + 64;
+constexpr const char* PIPELINE_CACHE_FILE_EXTENSION = ".zgpc";
+
+struct PipelineCacheFileHeader final {
+	uint32_t magic = PIPELINE_CACHE_FILE_MAGIC;
+	uint32_t version = PIPELINE_CACHE_FILE_VERSION;
+	uint64_t key = 0;
+	uint32_t numDependencies = 0;
+	uint32_t padding = 0;
+	uint64_t payloadSizeBytes = 0;
+};
+
+static int64_t fileTimeNow() noexcept
+{
+	return int64_t(fs::file_time_type::clock::now().time_since_epoch().count());
+}
+
+// Parses the key from an entry's file name, i.e. 16 hex digits followed by the extension
+static bool parseEntryFileName(const fs::path& path, uint64_t& keyOut) noexcept
+{
+	if (path.extension() != PIPELINE_CACHE_FILE_EXTENSION) return false;
+	std::string stem = path.stem().string();
+	if (stem.size() != 16) return false;
+	char* end = nullptr;
+	keyOut = std::strtoull(stem.c_str(), &end, 16);
+	return end == stem.c_str() + 16;
+}
+
+// PipelineCache: State methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult PipelineCache::create(const ZgPipelineCacheSettings& settings) noexcept
+{
+	this->destroy();
+
+	// Do nothing if no cache directory is specified
+	if (settings.directory == nullptr) return ZG_SUCCESS;
+	if (std::strlen(settings.directory) >= PIPELINE_CACHE_MAX_PATH_LENGTH) {
+		ZG_ERROR("PipelineCache: Directory path too long, cache disabled");
+		return ZG_SUCCESS;
+	}
+	std::strcpy(mDirectory, settings.directory);
+	mMaxSizeBytes = settings.maxSizeBytes != 0 ?
+		settings.maxSizeBytes : PIPELINE_CACHE_DEFAULT_MAX_SIZE_BYTES;
+
+	std::error_code ec;
+	fs::create_directories(mDirectory, ec);
+	if (ec || !fs::is_directory(mDirectory, ec)) {
+		ZG_ERROR("PipelineCache: Could not create directory \"%s\", cache disabled", mDirectory);
+		return ZG_SUCCESS;
+	}
+
+	// Find existing entries
+	std::lock_guard<std::mutex> lock(mMutex);
+	for (fs::directory_iterator itr(mDirectory, ec), end; !ec && itr != end; itr.increment(ec)) {
+		uint64_t key = 0;
+		if (!itr->is_regular_file(ec) || !parseEntryFileName(itr->path(), key)) continue;
+
+		Entry entry;
+		entry.key = key;
+		entry.sizeBytes = itr->file_size(ec);
+		if (ec) continue;
+		entry.lastUsed = int64_t(itr->last_write_time(ec).time_since_epoch().count());
+		if (ec) continue;
+		if (!mEntries.add(entry)) break;
+		mStats.sizeBytes += entry.sizeBytes;
+	}
+
+	// The max size might have been lowered since the last run
+	this->evictUnmutexed(~0ull);
+
+	ZG_INFO("PipelineCache: Using \"%s\", %u entries (%.1f MiB)",
+		mDirectory, mEntries.size(), double(mStats.sizeBytes) / (1024.0 * 1024.0));
+	mEnabled = true;
+	return ZG_SUCCESS;
+}
+
+void PipelineCache::destroy() noexcept
+{
+	mEnabled = false;
+	mDirectory[0] = '\0';
+	mMaxSizeBytes = 0;
+	mEntries.destroy();
+	mTmpFileCounter = 0;
+	mStats = {};
+}
+
+// PipelineCache: Methods
+// ------------------------------------------------------------------------------------------------
+
+bool PipelineCache::load(uint64_t key, Vector<uint8_t>& payloadOut) noexcept
+{
+	if (!mEnabled) return false;
+
+	// Check if there is an entry, it might still be evicted by another thread while we read it
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (this->findEntryUnmutexed(key) == nullptr) {
+			mStats.numMisses += 1;
+			return false;
+		}
+	}
+
+	char path[PIPELINE_CACHE_ENTRY_PATH_LENGTH] = {};
+	this->entryPath(path, key);
+	Vector<uint8_t> file = readBinaryFile(path);
+
+	// Validate entry, and that none of the files it was created from have changed
+	bool valid = file.size() >= sizeof(PipelineCacheFileHeader);
+	PipelineCacheFileHeader header;
+	if (valid) {
+		std::memcpy(&header, file.data(), sizeof(PipelineCacheFileHeader));
+		valid = header.magic == PIPELINE_CACHE_FILE_MAGIC
+			&& header.version == PIPELINE_CACHE_FILE_VERSION
+			&& header.key == key
+			&& file.size() == sizeof(PipelineCacheFileHeader)
+				+ header.numDependencies * sizeof(PipelineCacheDependency)
+				+ header.payloadSizeBytes;
+	}
+	for (uint32_t i = 0; valid && i < header.numDependencies; i++) {
+		PipelineCacheDependency dependency;
+		std::memcpy(&dependency,
+			file.data() + sizeof(PipelineCacheFileHeader) + i * sizeof(PipelineCacheDependency),
+			sizeof(PipelineCacheDependency));
+		dependency.path[PIPELINE_CACHE_MAX_PATH_LENGTH - 1] = '\0';
+		Vector<uint8_t> contents = readBinaryFile(dependency.path);
+		valid = hashBytes(contents.data(), contents.size()) == dependency.contentHash;
+	}
+	if (valid) {
+		valid = payloadOut.create(uint32_t(header.payloadSizeBytes), "ZeroG - PipelineCache");
+		if (valid && header.payloadSizeBytes != 0) {
+			payloadOut.addMany(uint32_t(header.payloadSizeBytes));
+			std::memcpy(payloadOut.data(),
+				file.data() + file.size() - header.payloadSizeBytes, header.payloadSizeBytes);
+		}
+	}
+
+	// Mark entry as used, also on disk so the order is kept between runs
+	int64_t now = fileTimeNow();
+	if (valid) {
+		std::error_code ec;
+		fs::last_write_time(path, fs::file_time_type(fs::file_time_type::duration(now)), ec);
+	}
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (!valid) {
+		mStats.numMisses += 1;
+		return false;
+	}
+	Entry* entry = this->findEntryUnmutexed(key);
+	if (entry != nullptr) entry->lastUsed = now;
+	mStats.numHits += 1;
+	return true;
+}
+
+void PipelineCache::store(
+	uint64_t key,
+	const void* payload,
+	uint64_t payloadSizeBytes,
+	const PipelineCacheDependency* dependencies,
+	uint32_t numDependencies) noexcept
+{
+	if (!mEnabled) return;
+
+	// Write to a temporary file first and then rename it, so that a partially written entry is
+	// never visible
+	char path[PIPELINE_CACHE_ENTRY_PATH_LENGTH] = {};
+	this->entryPath(path, key);
+	char tmpPath[PIPELINE_CACHE_ENTRY_PATH_LENGTH] = {};
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		char suffix[32] = {};
+		std::snprintf(suffix, sizeof(suffix), ".%u.tmp", mTmpFileCounter++);
+		this->entryPath(tmpPath, key, suffix);
+	}
+
+	PipelineCacheFileHeader header;
+	header.key = key;
+	header.numDependencies = numDependencies;
+	header.payloadSizeBytes = payloadSizeBytes;
+
+	std::FILE* file = std::fopen(tmpPath, "wb");
+	if (file == nullptr) {
+		ZG_ERROR("PipelineCache: Could not open \"%s\" for writing", tmpPath);
+		return;
+	}
+	bool success = std::fwrite(&header, sizeof(header), 1, file) == 1;
+	if (success && numDependencies != 0) {
+		success = std::fwrite(dependencies,
+			sizeof(PipelineCacheDependency), numDependencies, file) == numDependencies;
+	}
+	if (success && payloadSizeBytes != 0) {
+		success = std::fwrite(payload, payloadSizeBytes, 1, file) == 1;
+	}
+	success &= std::fclose(file) == 0;
+
+	std::error_code ec;
+	if (success) fs::rename(tmpPath, path, ec);
+	if (!success || ec) {
+		ZG_ERROR("PipelineCache: Could not write entry \"%s\"", path);
+		fs::remove(tmpPath, ec);
+		return;
+	}
+
+	uint64_t sizeBytes = sizeof(PipelineCacheFileHeader)
+		+ numDependencies * sizeof(PipelineCacheDependency) + payloadSizeBytes;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	Entry* entry = this->findEntryUnmutexed(key);
+	if (entry == nullptr) {
+		Entry newEntry;
+		newEntry.key = key;
+		if (!mEntries.add(newEntry)) return;
+		entry = &mEntries.last();
+	}
+	mStats.sizeBytes -= entry->sizeBytes;
+	mStats.sizeBytes += sizeBytes;
+	entry->sizeBytes = sizeBytes;
+	entry->lastUsed = fileTimeNow();
+
+	this->evictUnmutexed(key);
+}
+
+// PipelineCache: Getters
+// ------------------------------------------------------------------------------------------------
+
+PipelineCacheStats PipelineCache::stats() noexcept
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStats;
+}
+
+// PipelineCache: Private methods
+// ------------------------------------------------------------------------------------------------
+
+void PipelineCache::entryPath(char* pathOut, uint64_t key, const char* suffix) const noexcept
+{
+	std::snprintf(pathOut, PIPELINE_CACHE_ENTRY_PATH_LENGTH, "%s/%016llx%s%s",
+		mDirectory, (unsigned long long)key, PIPELINE_CACHE_FILE_EXTENSION, suffix);
+}
+
+PipelineCache::Entry* PipelineCache::findEntryUnmutexed(uint64_t key) noexcept
+{
+	for (uint32_t i = 0; i < mEntries.size(); i++) {
+		if (mEntries[i].key == key) return &mEntries[i];
+	}
+	return nullptr;
+}
+
+void PipelineCache::evictUnmutexed(uint64_t keepKey) noexcept
+{
+	while (mStats.sizeBytes > mMaxSizeBytes) {
+
+		// Find least recently used entry, never evict the one we want to keep (i.e. the one
+		// just stored) even if it alone is larger than the max size
+		uint32_t lruIdx = ~0u;
+		for (uint32_t i = 0; i < mEntries.size(); i++) {
+			if (mEntries[i].key == keepKey) continue;
+			if (lruIdx == ~0u || mEntries[i].lastUsed < mEntries[lruIdx].lastUsed) lruIdx = i;
+		}
+		if (lruIdx == ~0u) break;
+
+		char path[PIPELINE_CACHE_ENTRY_PATH_LENGTH] = {};
+		this->entryPath(path, mEntries[lruIdx].key);
+		std::error_code ec;
+		fs::remove(path, ec);
+
+		// Order doesn't matter, replace entry with the last one
+		mStats.sizeBytes -= mEntries[lruIdx].sizeBytes;
+		mStats.numEvictions += 1;
+		mEntries[lruIdx] = mEntries.last();
+		mEntries.pop();
+	}
+}
+
+} // namespace zg
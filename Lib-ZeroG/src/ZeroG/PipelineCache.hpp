@@ -0,0 +1,131 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+#include "ZeroG.h"
+#include "ZeroG/util/SmallVector.hpp"
+#include "ZeroG/util/Vector.hpp"
+
+namespace zg {
+
+// Pipeline cache types
+// ------------------------------------------------------------------------------------------------
+
+constexpr uint32_t PIPELINE_CACHE_MAX_PATH_LENGTH = 320;
+
+// A file (e.g. an included shader header) an entry was created from. The entry is only valid as
+// long as the contents of the file still hash to the same value.
+struct PipelineCacheDependency final {
+	char path[PIPELINE_CACHE_MAX_PATH_LENGTH] = {};
+	uint64_t contentHash = 0;
+};
+
+struct PipelineCacheStats final {
+	uint64_t numHits = 0;
+	uint64_t numMisses = 0;
+	uint64_t numEvictions = 0;
+	uint64_t sizeBytes = 0;
+};
+
+// PipelineCache
+// ------------------------------------------------------------------------------------------------
+
+// On-disk key-value store for compiled pipeline data, see ZgPipelineCacheSettings. The payload
+// stored for a key is opaque to the cache, it is up to the backend to decide what to store and to
+// hash everything affecting it into the key.
+//
+// Each entry is a file in the cache directory named after its key. The last write time of the
+// file doubles as the entry's last use time, so the least recently used order survives between
+// runs. All methods are thread-safe.
+class PipelineCache final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	PipelineCache() noexcept = default;
+	PipelineCache(const PipelineCache&) = delete;
+	PipelineCache& operator= (const PipelineCache&) = delete;
+	PipelineCache(PipelineCache&&) = delete;
+	PipelineCache& operator= (PipelineCache&&) = delete;
+	~PipelineCache() noexcept { this->destroy(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	// Scans the cache directory for existing entries. A cache directory that can't be created
+	// is not an error, the cache is simply disabled.
+	ZgResult create(const ZgPipelineCacheSettings& settings) noexcept;
+	void destroy() noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	// Loads the payload stored for the key. Returns false (a miss) if there is no such entry, or
+	// if any of the files it depends on have changed.
+	bool load(uint64_t key, Vector<uint8_t>& payloadOut) noexcept;
+
+	// Stores an entry, replacing any existing entry with the same key. Evicts the least recently
+	// used entries if the cache grows larger than its max size.
+	void store(
+		uint64_t key,
+		const void* payload,
+		uint64_t payloadSizeBytes,
+		const PipelineCacheDependency* dependencies,
+		uint32_t numDependencies) noexcept;
+
+	// Getters
+	// --------------------------------------------------------------------------------------------
+
+	bool enabled() const noexcept { return mEnabled; }
+	PipelineCacheStats stats() noexcept;
+
+private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	struct Entry final {
+		uint64_t key = 0;
+		uint64_t sizeBytes = 0;
+		int64_t lastUsed = 0;
+	};
+
+	// Private methods
+	// --------------------------------------------------------------------------------------------
+
+	void entryPath(char* pathOut, uint64_t key, const char* suffix = "") const noexcept;
+	Entry* findEntryUnmutexed(uint64_t key) noexcept;
+	void evictUnmutexed(uint64_t keepKey) noexcept;
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	bool mEnabled = false;
+	char mDirectory[PIPELINE_CACHE_MAX_PATH_LENGTH] = {};
+	uint64_t mMaxSizeBytes = 0;
+
+	std::mutex mMutex;
+	SmallVector<Entry, 64> mEntries;
+	uint32_t mTmpFileCounter = 0;
+	PipelineCacheStats mStats;
+};
+
+} // namespace zg
@@ -0,0 +1,304 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/PipelineRenderPending.hpp"
+
+#include <cstring>
+
+#include "ZeroG/BackendInterface.hpp"
+#include "ZeroG/Context.hpp"
+#include "ZeroG/JobSystem.hpp"
+#include "ZeroG/ShaderArchive.hpp"
+#include "ZeroG/ShaderHotReload.hpp"
+#include "ZeroG/util/Logging.hpp"
+#include "ZeroG/util/Strings.hpp"
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+// Entry points, (vertex and pixel) shader paths or sources, DXC compiler flags and define names
+// and values
+constexpr uint32_t PIPELINE_RENDER_PENDING_MAX_NUM_STRINGS =
+	4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * ZG_MAX_NUM_SHADER_DEFINES;
+
+// ZgPipelineRenderPending: Constructors & destructors
+// ------------------------------------------------------------------------------------------------
+
+ZgPipelineRenderPending::~ZgPipelineRenderPending() noexcept
+{
+	// The creation job references this object, so it must finish before we can be destroyed
+	zg::waitFor(mNumRemaining);
+	if (mPipeline != nullptr && !mPipelineRetrieved) {
+		zg::getBackend()->pipelineRenderRelease(mPipeline);
+	}
+}
+
+// ZgPipelineRenderPending: Methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult ZgPipelineRenderPending::createFromFileSPIRV(
+	const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept
+{
+	mType = Type::FILE_SPIRV;
+	mCreateInfoFileSPIRV = createInfo;
+	ZgPipelineRenderCreateInfoFileSPIRV& info = mCreateInfoFileSPIRV;
+
+	const char** strings[] = {
+		&info.common.vertexShaderEntry,
+		&info.common.pixelShaderEntry,
+		&info.vertexShaderPath,
+		&info.pixelShaderPath
+	};
+	if (!this->copyStrings(strings, 4)) return ZG_ERROR_CPU_OUT_OF_MEMORY;
+
+	zg::submit(createTask, this, mNumRemaining);
+	return ZG_SUCCESS;
+}
+
+ZgResult ZgPipelineRenderPending::createFromMemorySPIRV(
+	const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept
+{
+	mType = Type::MEMORY_SPIRV;
+	mCreateInfoMemorySPIRV = createInfo;
+	ZgPipelineRenderCreateInfoMemorySPIRV& info = mCreateInfoMemorySPIRV;
+
+	const char** strings[] = {
+		&info.common.vertexShaderEntry,
+		&info.common.pixelShaderEntry
+	};
+	if (!this->copyStrings(strings, 2)) return ZG_ERROR_CPU_OUT_OF_MEMORY;
+
+	const void* blobs[] = { info.vertexShaderSpirv, info.pixelShaderSpirv };
+	const uint32_t sizesBytes[] = {
+		info.vertexShaderSpirvSizeBytes,
+		info.pixelShaderSpirvSizeBytes
+	};
+	if (!this->copyBlobs(blobs, sizesBytes, 2)) return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	info.vertexShaderSpirv = reinterpret_cast<const uint32_t*>(blobs[0]);
+	info.pixelShaderSpirv = reinterpret_cast<const uint32_t*>(blobs[1]);
+
+	zg::submit(createTask, this, mNumRemaining);
+	return ZG_SUCCESS;
+}
+
+ZgResult ZgPipelineRenderPending::createFromFileHLSL(
+	const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept
+{
+	mType = Type::FILE_HLSL;
+	mCreateInfoFileHLSL = createInfo;
+	ZgPipelineRenderCreateInfoFileHLSL& info = mCreateInfoFileHLSL;
+
+	const char** strings[PIPELINE_RENDER_PENDING_MAX_NUM_STRINGS] = {
+		&info.common.vertexShaderEntry,
+		&info.common.pixelShaderEntry,
+		&info.vertexShaderPath,
+		&info.pixelShaderPath
+	};
+	for (uint32_t i = 0; i < ZG_MAX_NUM_DXC_COMPILER_FLAGS; i++) {
+		strings[4 + i] = &info.dxcCompilerFlags[i];
+	}
+	for (uint32_t i = 0; i < ZG_MAX_NUM_SHADER_DEFINES; i++) {
+		strings[4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * i] = &info.defines[i].name;
+		strings[4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * i + 1] = &info.defines[i].value;
+	}
+	if (!this->copyStrings(strings, PIPELINE_RENDER_PENDING_MAX_NUM_STRINGS)) {
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+
+	zg::submit(createTask, this, mNumRemaining);
+	return ZG_SUCCESS;
+}
+
+ZgResult ZgPipelineRenderPending::createFromSourceHLSL(
+	const ZgPipelineRenderCreateInfoSourceHLSL& createInfo) noexcept
+{
+	mType = Type::SOURCE_HLSL;
+	mCreateInfoSourceHLSL = createInfo;
+	ZgPipelineRenderCreateInfoSourceHLSL& info = mCreateInfoSourceHLSL;
+
+	const char** strings[PIPELINE_RENDER_PENDING_MAX_NUM_STRINGS] = {
+		&info.common.vertexShaderEntry,
+		&info.common.pixelShaderEntry,
+		&info.vertexShaderSrc,
+		&info.pixelShaderSrc
+	};
+	for (uint32_t i = 0; i < ZG_MAX_NUM_DXC_COMPILER_FLAGS; i++) {
+		strings[4 + i] = &info.dxcCompilerFlags[i];
+	}
+	for (uint32_t i = 0; i < ZG_MAX_NUM_SHADER_DEFINES; i++) {
+		strings[4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * i] = &info.defines[i].name;
+		strings[4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * i + 1] = &info.defines[i].value;
+	}
+	if (!this->copyStrings(strings, PIPELINE_RENDER_PENDING_MAX_NUM_STRINGS)) {
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+
+	zg::submit(createTask, this, mNumRemaining);
+	return ZG_SUCCESS;
+}
+
+ZgResult ZgPipelineRenderPending::createFromMemoryDXIL(
+	const ZgPipelineRenderCreateInfoMemoryDXIL& createInfo) noexcept
+{
+	mType = Type::MEMORY_DXIL;
+	mCreateInfoMemoryDXIL = createInfo;
+	ZgPipelineRenderCreateInfoMemoryDXIL& info = mCreateInfoMemoryDXIL;
+
+	const char** strings[] = {
+		&info.common.vertexShaderEntry,
+		&info.common.pixelShaderEntry
+	};
+	if (!this->copyStrings(strings, 2)) return ZG_ERROR_CPU_OUT_OF_MEMORY;
+
+	const void* blobs[] = { info.vertexShaderDxil, info.pixelShaderDxil };
+	const uint32_t sizesBytes[] = {
+		info.vertexShaderDxilSizeBytes,
+		info.pixelShaderDxilSizeBytes
+	};
+	if (!this->copyBlobs(blobs, sizesBytes, 2)) return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	info.vertexShaderDxil = blobs[0];
+	info.pixelShaderDxil = blobs[1];
+
+	zg::submit(createTask, this, mNumRemaining);
+	return ZG_SUCCESS;
+}
+
+ZgResult ZgPipelineRenderPending::createFromArchive(
+	const ZgPipelineRenderCreateInfoArchive& createInfo) noexcept
+{
+	mType = Type::ARCHIVE;
+	mCreateInfoArchive = createInfo;
+	ZgPipelineRenderCreateInfoArchive& info = mCreateInfoArchive;
+
+	// The archive itself is not copied, it must stay loaded until the pipeline is created
+	const char** strings[] = {
+		&info.common.vertexShaderEntry,
+		&info.common.pixelShaderEntry,
+		&info.pipelineName
+	};
+	if (!this->copyStrings(strings, 3)) return ZG_ERROR_CPU_OUT_OF_MEMORY;
+
+	zg::submit(createTask, this, mNumRemaining);
+	return ZG_SUCCESS;
+}
+
+bool ZgPipelineRenderPending::isReady() const noexcept
+{
+	return mNumRemaining.load(std::memory_order_acquire) == 0;
+}
+
+ZgResult ZgPipelineRenderPending::wait(
+	ZgPipelineRender** pipelineOut, ZgPipelineRenderSignature* signatureOut) noexcept
+{
+	zg::waitFor(mNumRemaining);
+	if (mResult != ZG_SUCCESS) return mResult;
+	if (mPipelineRetrieved) return ZG_ERROR_INVALID_ARGUMENT;
+
+	// Pipelines created from files are hot-reloadable once owned by the user. If they can't be
+	// watched the pipeline stays owned by us and is released with the pending object.
+	zg::ShaderHotReload* hotReload = zg::getContext().shaderHotReload;
+	ZgResult res = ZG_SUCCESS;
+	if (mType == Type::FILE_SPIRV) {
+		res = hotReload->registerPipeline(mPipeline, mSignature, mCreateInfoFileSPIRV);
+	}
+	else if (mType == Type::FILE_HLSL) {
+		res = hotReload->registerPipeline(mPipeline, mSignature, mCreateInfoFileHLSL);
+	}
+	if (res != ZG_SUCCESS) return res;
+
+	mPipelineRetrieved = true;
+	*pipelineOut = mPipeline;
+	*signatureOut = mSignature;
+	return ZG_SUCCESS;
+}
+
+// ZgPipelineRenderPending: Private methods
+// ------------------------------------------------------------------------------------------------
+
+bool ZgPipelineRenderPending::copyStrings(const char** strings[], uint32_t numStrings) noexcept
+{
+	return zg::copyStrings(
+		mStrings, strings, numStrings, "ZeroG - PipelineRenderPending - Strings");
+}
+
+bool ZgPipelineRenderPending::copyBlobs(
+	const void* blobs[], const uint32_t sizesBytes[], uint32_t numBlobs) noexcept
+{
+	// Allocate all blobs at once, mBlobs can't grow since we point into it
+	uint32_t numBytes = 0;
+	for (uint32_t i = 0; i < numBlobs; i++) {
+		numBytes += (sizesBytes[i] + 3) & ~3u;
+	}
+	if (numBytes == 0) return true;
+	if (!mBlobs.create(numBytes, "ZeroG - PipelineRenderPending - Blobs")) return false;
+
+	for (uint32_t i = 0; i < numBlobs; i++) {
+		uint32_t offset = mBlobs.size();
+		mBlobs.addMany((sizesBytes[i] + 3) & ~3u);
+		std::memcpy(mBlobs.data() + offset, blobs[i], sizesBytes[i]);
+		blobs[i] = mBlobs.data() + offset;
+	}
+	return true;
+}
+
+void ZgPipelineRenderPending::createTask(void* taskData, uint32_t taskIdx) noexcept
+{
+	(void)taskIdx;
+	ZgPipelineRenderPending& pending = *reinterpret_cast<ZgPipelineRenderPending*>(taskData);
+	ZgBackend* backend = zg::getBackend();
+
+	switch (pending.mType) {
+	case Type::FILE_SPIRV:
+		pending.mResult = backend->pipelineRenderCreateFromFileSPIRV(
+			&pending.mPipeline, &pending.mSignature, pending.mCreateInfoFileSPIRV);
+		break;
+	case Type::MEMORY_SPIRV:
+		pending.mResult = backend->pipelineRenderCreateFromMemorySPIRV(
+			&pending.mPipeline, &pending.mSignature, pending.mCreateInfoMemorySPIRV);
+		break;
+	case Type::FILE_HLSL:
+		pending.mResult = backend->pipelineRenderCreateFromFileHLSL(
+			&pending.mPipeline, &pending.mSignature, pending.mCreateInfoFileHLSL);
+		break;
+	case Type::SOURCE_HLSL:
+		pending.mResult = backend->pipelineRenderCreateFromSourceHLSL(
+			&pending.mPipeline, &pending.mSignature, pending.mCreateInfoSourceHLSL);
+		break;
+	case Type::MEMORY_DXIL:
+		pending.mResult = backend->pipelineRenderCreateFromMemoryDXIL(
+			&pending.mPipeline, &pending.mSignature, pending.mCreateInfoMemoryDXIL);
+		break;
+	case Type::ARCHIVE:
+		{
+			const ZgPipelineRenderCreateInfoArchive& info = pending.mCreateInfoArchive;
+			zg::ShaderArchivePipeline pipeline;
+			if (!zg::getShaderArchivePipeline(
+				pipeline, info.archive->file.data(), info.pipelineName)) {
+				ZG_ERROR("Shader archive does not contain pipeline \"%s\"", info.pipelineName);
+				pending.mResult = ZG_ERROR_INVALID_ARGUMENT;
+				break;
+			}
+			pending.mResult = backend->pipelineRenderCreateFromArchive(
+				&pending.mPipeline, &pending.mSignature, info.common, pipeline);
+		}
+		break;
+	default:
+		pending.mResult = ZG_ERROR_GENERIC;
+		break;
+	}
+}
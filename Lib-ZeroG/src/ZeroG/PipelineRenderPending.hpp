@@ -0,0 +1,106 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "ZeroG.h"
+#include "ZeroG/util/Vector.hpp"
+
+// ZgPipelineRenderPending
+// ------------------------------------------------------------------------------------------------
+
+// A render pipeline being created asynchronously on the job system. Backend agnostic, the actual
+// creation is done by the backend's ordinary (thread-safe) pipeline creation functions.
+struct ZgPipelineRenderPending final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	ZgPipelineRenderPending() noexcept = default;
+	ZgPipelineRenderPending(const ZgPipelineRenderPending&) = delete;
+	ZgPipelineRenderPending& operator= (const ZgPipelineRenderPending&) = delete;
+	ZgPipelineRenderPending(ZgPipelineRenderPending&&) = delete;
+	ZgPipelineRenderPending& operator= (ZgPipelineRenderPending&&) = delete;
+	~ZgPipelineRenderPending() noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	// Copies the create info and submits the creation to the job system. May only be called once.
+	ZgResult createFromFileSPIRV(const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept;
+	ZgResult createFromMemorySPIRV(const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept;
+	ZgResult createFromFileHLSL(const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept;
+	ZgResult createFromSourceHLSL(const ZgPipelineRenderCreateInfoSourceHLSL& createInfo) noexcept;
+	ZgResult createFromMemoryDXIL(const ZgPipelineRenderCreateInfoMemoryDXIL& createInfo) noexcept;
+	ZgResult createFromArchive(const ZgPipelineRenderCreateInfoArchive& createInfo) noexcept;
+
+	bool isReady() const noexcept;
+
+	// Blocks until the creation has finished. Transfers ownership of the pipeline on success.
+	ZgResult wait(
+		ZgPipelineRender** pipelineOut, ZgPipelineRenderSignature* signatureOut) noexcept;
+
+private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	enum class Type : uint32_t {
+		UNDEFINED = 0,
+		FILE_SPIRV,
+		MEMORY_SPIRV,
+		FILE_HLSL,
+		SOURCE_HLSL,
+		MEMORY_DXIL,
+		ARCHIVE
+	};
+
+	// Private methods
+	// --------------------------------------------------------------------------------------------
+
+	// Copies the strings into mStrings and points the given string pointers to the copies
+	bool copyStrings(const char** strings[], uint32_t numStrings) noexcept;
+
+	// Copies the (vertex and pixel shader) blobs into mBlobs and points the given blob pointers to
+	// the copies. Each copy starts at a 4 byte aligned offset, so SPIR-V words stay aligned.
+	bool copyBlobs(const void* blobs[], const uint32_t sizesBytes[], uint32_t numBlobs) noexcept;
+
+	static void createTask(void* taskData, uint32_t taskIdx) noexcept;
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	Type mType = Type::UNDEFINED;
+	ZgPipelineRenderCreateInfoFileSPIRV mCreateInfoFileSPIRV = {};
+	ZgPipelineRenderCreateInfoMemorySPIRV mCreateInfoMemorySPIRV = {};
+	ZgPipelineRenderCreateInfoFileHLSL mCreateInfoFileHLSL = {};
+	ZgPipelineRenderCreateInfoSourceHLSL mCreateInfoSourceHLSL = {};
+	ZgPipelineRenderCreateInfoMemoryDXIL mCreateInfoMemoryDXIL = {};
+	ZgPipelineRenderCreateInfoArchive mCreateInfoArchive = {};
+	zg::Vector<char> mStrings;
+	zg::Vector<uint8_t> mBlobs;
+
+	// Written by the creation job, read once mNumRemaining is 0
+	std::atomic_uint32_t mNumRemaining = 0;
+	ZgResult mResult = ZG_SUCCESS;
+	ZgPipelineRender* mPipeline = nullptr;
+	ZgPipelineRenderSignature mSignature = {};
+	bool mPipelineRetrieved = false;
+};
@@ -0,0 +1,439 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/PipelineRenderPermutations.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ZeroG/BackendInterface.hpp"
+#include "ZeroG/Context.hpp"
+#include "ZeroG/util/Hash.hpp"
+#include "ZeroG/util/Logging.hpp"
+#include "ZeroG/util/Strings.hpp"
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+// Entry points, (vertex and pixel) shader paths or sources, DXC compiler flags and define names
+// and values
+constexpr uint32_t PIPELINE_RENDER_PERMUTATIONS_MAX_NUM_STRINGS =
+	4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * ZG_MAX_NUM_SHADER_DEFINES;
+
+constexpr uint32_t PIPELINE_RENDER_PERMUTATIONS_MIN_TABLE_SIZE = 64;
+
+static bool copySpirv(zg::Vector<uint32_t>& out, const uint32_t* spirv, uint32_t sizeBytes) noexcept
+{
+	uint32_t numWords = sizeBytes / 4;
+	if (!out.create(numWords, "ZeroG - PipelineRenderPermutations - SPIR-V")) return false;
+	out.addMany(numWords);
+	std::memcpy(out.data(), spirv, numWords * 4);
+	return true;
+}
+
+// ZgPipelineRenderPermutations: Constructors & destructors
+// ------------------------------------------------------------------------------------------------
+
+ZgPipelineRenderPermutations::~ZgPipelineRenderPermutations() noexcept
+{
+	for (uint32_t i = 0; i < mPipelines.size(); i++) {
+		zg::getBackend()->pipelineRenderRelease(mPipelines[i].pipeline);
+	}
+}
+
+// ZgPipelineRenderPermutations: State methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult ZgPipelineRenderPermutations::createFromFileSPIRV(
+	const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept
+{
+	mType = Type::FILE_SPIRV;
+	mCreateInfoFileSPIRV = createInfo;
+	ZgPipelineRenderCreateInfoFileSPIRV& info = mCreateInfoFileSPIRV;
+
+	const char** strings[] = {
+		&info.common.vertexShaderEntry,
+		&info.common.pixelShaderEntry,
+		&info.vertexShaderPath,
+		&info.pixelShaderPath
+	};
+	if (!zg::copyStrings(mStrings, strings, 4, "ZeroG - PipelineRenderPermutations - Strings")) {
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+	return ZG_SUCCESS;
+}
+
+ZgResult ZgPipelineRenderPermutations::createFromMemorySPIRV(
+	const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept
+{
+	mType = Type::MEMORY_SPIRV;
+	mCreateInfoMemorySPIRV = createInfo;
+	ZgPipelineRenderCreateInfoMemorySPIRV& info = mCreateInfoMemorySPIRV;
+
+	const char** strings[] = {
+		&info.common.vertexShaderEntry,
+		&info.common.pixelShaderEntry
+	};
+	if (!zg::copyStrings(mStrings, strings, 2, "ZeroG - PipelineRenderPermutations - Strings")) {
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+
+	if (!copySpirv(mVertexSpirv, info.vertexShaderSpirv, info.vertexShaderSpirvSizeBytes) ||
+		!copySpirv(mPixelSpirv, info.pixelShaderSpirv, info.pixelShaderSpirvSizeBytes)) {
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+	info.vertexShaderSpirv = mVertexSpirv.data();
+	info.pixelShaderSpirv = mPixelSpirv.data();
+	return ZG_SUCCESS;
+}
+
+ZgResult ZgPipelineRenderPermutations::createFromFileHLSL(
+	const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept
+{
+	mType = Type::FILE_HLSL;
+	mCreateInfoFileHLSL = createInfo;
+	ZgPipelineRenderCreateInfoFileHLSL& info = mCreateInfoFileHLSL;
+
+	const char** strings[PIPELINE_RENDER_PERMUTATIONS_MAX_NUM_STRINGS] = {
+		&info.common.vertexShaderEntry,
+		&info.common.pixelShaderEntry,
+		&info.vertexShaderPath,
+		&info.pixelShaderPath
+	};
+	for (uint32_t i = 0; i < ZG_MAX_NUM_DXC_COMPILER_FLAGS; i++) {
+		strings[4 + i] = &info.dxcCompilerFlags[i];
+	}
+	for (uint32_t i = 0; i < ZG_MAX_NUM_SHADER_DEFINES; i++) {
+		strings[4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * i] = &info.defines[i].name;
+		strings[4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * i + 1] = &info.defines[i].value;
+	}
+	if (!zg::copyStrings(mStrings, strings, PIPELINE_RENDER_PERMUTATIONS_MAX_NUM_STRINGS,
+		"ZeroG - PipelineRenderPermutations - Strings")) {
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+	return ZG_SUCCESS;
+}
+
+ZgResult ZgPipelineRenderPermutations::createFromSourceHLSL(
+	const ZgPipelineRenderCreateInfoSourceHLSL& createInfo) noexcept
+{
+	mType = Type::SOURCE_HLSL;
+	mCreateInfoSourceHLSL = createInfo;
+	ZgPipelineRenderCreateInfoSourceHLSL& info = mCreateInfoSourceHLSL;
+
+	const char** strings[PIPELINE_RENDER_PERMUTATIONS_MAX_NUM_STRINGS] = {
+		&info.common.vertexShaderEntry,
+		&info.common.pixelShaderEntry,
+		&info.vertexShaderSrc,
+		&info.pixelShaderSrc
+	};
+	for (uint32_t i = 0; i < ZG_MAX_NUM_DXC_COMPILER_FLAGS; i++) {
+		strings[4 + i] = &info.dxcCompilerFlags[i];
+	}
+	for (uint32_t i = 0; i < ZG_MAX_NUM_SHADER_DEFINES; i++) {
+		strings[4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * i] = &info.defines[i].name;
+		strings[4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * i + 1] = &info.defines[i].value;
+	}
+	if (!zg::copyStrings(mStrings, strings, PIPELINE_RENDER_PERMUTATIONS_MAX_NUM_STRINGS,
+		"ZeroG - PipelineRenderPermutations - Strings")) {
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+	return ZG_SUCCESS;
+}
+
+// ZgPipelineRenderPermutations: Methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult ZgPipelineRenderPermutations::get(
+	const ZgPipelineRenderPermutation* permutation,
+	ZgPipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut) noexcept
+{
+	Merged merged;
+	uint64_t key = 0;
+	ZgResult mergeRes = this->merge(merged, key, permutation);
+	if (mergeRes != ZG_SUCCESS) return mergeRes;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	// Fast path, the permutation has already been requested (and is probably compiled)
+	uint32_t variantIdx = this->findVariant(key);
+	if (variantIdx != ~0u) {
+		mCompiledCondition.wait(lock, [&]() { return mVariants[variantIdx].compiled; });
+		const Variant& variant = mVariants[variantIdx];
+		if (variant.result != ZG_SUCCESS) return variant.result;
+		*pipelineOut = mPipelines[variant.pipelineIdx].pipeline;
+		*signatureOut = mPipelines[variant.pipelineIdx].signature;
+		return ZG_SUCCESS;
+	}
+
+	// Add the variant before compiling, so other threads requesting it wait instead of compiling
+	// it a second time
+	variantIdx = this->addVariant(key);
+	if (variantIdx == ~0u) return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	lock.unlock();
+
+	ZgPipelineRender* pipeline = nullptr;
+	ZgPipelineRenderSignature signature = {};
+	ZgResult res = this->compile(merged, &pipeline, &signature);
+	uint64_t bytecodeHash = 0;
+	bool hasBytecodeHash = res == ZG_SUCCESS &&
+		zg::getBackend()->pipelineRenderGetBytecodeHash(pipeline, bytecodeHash) == ZG_SUCCESS;
+
+	lock.lock();
+
+	// Share an existing pipeline if the shaders compiled to the same code
+	uint32_t pipelineIdx = ~0u;
+	if (hasBytecodeHash) {
+		for (uint32_t i = 0; i < mPipelines.size(); i++) {
+			if (mPipelines[i].hasBytecodeHash && mPipelines[i].bytecodeHash == bytecodeHash) {
+				pipelineIdx = i;
+				break;
+			}
+		}
+	}
+
+	ZgPipelineRender* pipelineToRelease = nullptr;
+	if (res == ZG_SUCCESS && pipelineIdx != ~0u) {
+		ZG_NOISE("Pipeline permutation (key: %llx) compiled to the same shaders as an earlier one",
+			(unsigned long long)key);
+		pipelineToRelease = pipeline;
+	}
+	else if (res == ZG_SUCCESS) {
+		Pipeline entry;
+		entry.pipeline = pipeline;
+		entry.signature = signature;
+		entry.hasBytecodeHash = hasBytecodeHash;
+		entry.bytecodeHash = bytecodeHash;
+		if (mPipelines.add(entry)) {
+			pipelineIdx = mPipelines.size() - 1;
+		}
+		else {
+			res = ZG_ERROR_CPU_OUT_OF_MEMORY;
+			pipelineToRelease = pipeline;
+		}
+	}
+
+	Variant& variant = mVariants[variantIdx];
+	variant.compiled = true;
+	variant.result = res;
+	variant.pipelineIdx = pipelineIdx;
+	if (res != ZG_SUCCESS) mNumFailedVariants += 1;
+	if (res == ZG_SUCCESS) {
+		*pipelineOut = mPipelines[pipelineIdx].pipeline;
+		*signatureOut = mPipelines[pipelineIdx].signature;
+	}
+	lock.unlock();
+	mCompiledCondition.notify_all();
+
+	if (pipelineToRelease != nullptr) zg::getBackend()->pipelineRenderRelease(pipelineToRelease);
+	return res;
+}
+
+ZgPipelineRenderPermutationsStats ZgPipelineRenderPermutations::stats() noexcept
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	ZgPipelineRenderPermutationsStats stats = {};
+	stats.numPermutations = mVariants.size();
+	stats.numFailedPermutations = mNumFailedVariants;
+	stats.numPipelines = mPipelines.size();
+	return stats;
+}
+
+// ZgPipelineRenderPermutations: Private methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult ZgPipelineRenderPermutations::merge(
+	Merged& mergedOut,
+	uint64_t& keyOut,
+	const ZgPipelineRenderPermutation* permutation) noexcept
+{
+	uint64_t hash = zg::HASH_SEED;
+
+	if (mType == Type::FILE_HLSL || mType == Type::SOURCE_HLSL) {
+		const bool isFile = mType == Type::FILE_HLSL;
+		const ZgShaderDefine* baseDefines =
+			isFile ? mCreateInfoFileHLSL.defines : mCreateInfoSourceHLSL.defines;
+		uint32_t numBaseDefines =
+			isFile ? mCreateInfoFileHLSL.numDefines : mCreateInfoSourceHLSL.numDefines;
+		uint32_t numDefines = 0;
+		for (uint32_t i = 0; i < numBaseDefines; i++) {
+			mergedOut.defines[numDefines++] = baseDefines[i];
+		}
+
+		// Defines of the permutation replace base defines with the same name
+		uint32_t numPermutationDefines = permutation != nullptr ? permutation->numDefines : 0;
+		for (uint32_t i = 0; i < numPermutationDefines; i++) {
+			const ZgShaderDefine& define = permutation->defines[i];
+			uint32_t idx = 0;
+			while (idx < numDefines && std::strcmp(mergedOut.defines[idx].name, define.name) != 0) {
+				idx += 1;
+			}
+			if (idx == ZG_MAX_NUM_SHADER_DEFINES) {
+				ZG_ERROR("Pipeline permutation has more than ZG_MAX_NUM_SHADER_DEFINES defines");
+				return ZG_ERROR_INVALID_ARGUMENT;
+			}
+			if (idx == numDefines) numDefines += 1;
+			mergedOut.defines[idx] = define;
+		}
+		mergedOut.numDefines = numDefines;
+
+		std::sort(mergedOut.defines, mergedOut.defines + numDefines,
+			[](const ZgShaderDefine& lhs, const ZgShaderDefine& rhs) {
+			return std::strcmp(lhs.name, rhs.name) < 0;
+		});
+		hash = zg::hashValue(numDefines, hash);
+		for (uint32_t i = 0; i < numDefines; i++) {
+			const ZgShaderDefine& define = mergedOut.defines[i];
+			hash = zg::hashString(define.name, hash);
+			hash = zg::hashString(define.value == nullptr ? "1" : define.value, hash);
+		}
+	}
+	else {
+		const bool isFile = mType == Type::FILE_SPIRV;
+		const ZgSpecializationConstant* baseConstants = isFile ?
+			mCreateInfoFileSPIRV.specializationConstants :
+			mCreateInfoMemorySPIRV.specializationConstants;
+		uint32_t numBaseConstants = isFile ?
+			mCreateInfoFileSPIRV.numSpecializationConstants :
+			mCreateInfoMemorySPIRV.numSpecializationConstants;
+		uint32_t numConstants = 0;
+		for (uint32_t i = 0; i < numBaseConstants; i++) {
+			mergedOut.specializationConstants[numConstants++] = baseConstants[i];
+		}
+
+		// Constants of the permutation replace base constants with the same id
+		uint32_t numPermutationConstants =
+			permutation != nullptr ? permutation->numSpecializationConstants : 0;
+		for (uint32_t i = 0; i < numPermutationConstants; i++) {
+			const ZgSpecializationConstant& constant = permutation->specializationConstants[i];
+			uint32_t idx = 0;
+			while (idx < numConstants &&
+				mergedOut.specializationConstants[idx].constantId != constant.constantId) {
+				idx += 1;
+			}
+			if (idx == ZG_MAX_NUM_SPECIALIZATION_CONSTANTS) {
+				ZG_ERROR("Pipeline permutation has more than ZG_MAX_NUM_SPECIALIZATION_CONSTANTS "
+					"specialization constants");
+				return ZG_ERROR_INVALID_ARGUMENT;
+			}
+			if (idx == numConstants) numConstants += 1;
+			mergedOut.specializationConstants[idx] = constant;
+		}
+		mergedOut.numSpecializationConstants = numConstants;
+
+		std::sort(mergedOut.specializationConstants,
+			mergedOut.specializationConstants + numConstants,
+			[](const ZgSpecializationConstant& lhs, const ZgSpecializationConstant& rhs) {
+			return lhs.constantId < rhs.constantId;
+		});
+		hash = zg::hashValue(numConstants, hash);
+		for (uint32_t i = 0; i < numConstants; i++) {
+			hash = zg::hashValue(mergedOut.specializationConstants[i].constantId, hash);
+			hash = zg::hashValue(mergedOut.specializationConstants[i].value, hash);
+		}
+	}
+
+	keyOut = hash;
+	return ZG_SUCCESS;
+}
+
+ZgResult ZgPipelineRenderPermutations::compile(
+	const Merged& merged,
+	ZgPipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut) noexcept
+{
+	ZgBackend* backend = zg::getBackend();
+	switch (mType) {
+	case Type::FILE_SPIRV:
+	{
+		ZgPipelineRenderCreateInfoFileSPIRV info = mCreateInfoFileSPIRV;
+		info.numSpecializationConstants = merged.numSpecializationConstants;
+		std::memcpy(info.specializationConstants, merged.specializationConstants,
+			sizeof(merged.specializationConstants));
+		return backend->pipelineRenderCreateFromFileSPIRV(pipelineOut, signatureOut, info);
+	}
+	case Type::MEMORY_SPIRV:
+	{
+		ZgPipelineRenderCreateInfoMemorySPIRV info = mCreateInfoMemorySPIRV;
+		info.numSpecializationConstants = merged.numSpecializationConstants;
+		std::memcpy(info.specializationConstants, merged.specializationConstants,
+			sizeof(merged.specializationConstants));
+		return backend->pipelineRenderCreateFromMemorySPIRV(pipelineOut, signatureOut, info);
+	}
+	case Type::FILE_HLSL:
+	{
+		ZgPipelineRenderCreateInfoFileHLSL info = mCreateInfoFileHLSL;
+		info.numDefines = merged.numDefines;
+		std::memcpy(info.defines, merged.defines, sizeof(merged.defines));
+		return backend->pipelineRenderCreateFromFileHLSL(pipelineOut, signatureOut, info);
+	}
+	case Type::SOURCE_HLSL:
+	{
+		ZgPipelineRenderCreateInfoSourceHLSL info = mCreateInfoSourceHLSL;
+		info.numDefines = merged.numDefines;
+		std::memcpy(info.defines, merged.defines, sizeof(merged.defines));
+		return backend->pipelineRenderCreateFromSourceHLSL(pipelineOut, signatureOut, info);
+	}
+	case Type::UNDEFINED: break;
+	}
+	return ZG_ERROR_GENERIC;
+}
+
+uint32_t ZgPipelineRenderPermutations::findVariant(uint64_t key) const noexcept
+{
+	if (mTable.size() == 0) return ~0u;
+	const uint32_t mask = mTable.size() - 1;
+	for (uint32_t slot = uint32_t(key) & mask; mTable[slot] != 0; slot = (slot + 1) & mask) {
+		uint32_t variantIdx = mTable[slot] - 1;
+		if (mVariants[variantIdx].key == key) return variantIdx;
+	}
+	return ~0u;
+}
+
+uint32_t ZgPipelineRenderPermutations::addVariant(uint64_t key) noexcept
+{
+	// Keep the table at most half full, so probe sequences stay short
+	if ((mVariants.size() + 1) * 2 > mTable.size()) {
+		uint32_t newSize = std::max(PIPELINE_RENDER_PERMUTATIONS_MIN_TABLE_SIZE, mTable.size() * 2);
+		zg::SmallVector<uint32_t, 0> newTable;
+		if (!newTable.create(newSize, "ZeroG - PipelineRenderPermutations - Table")) return ~0u;
+		newTable.addMany(newSize);
+		const uint32_t mask = newSize - 1;
+		for (uint32_t i = 0; i < mVariants.size(); i++) {
+			uint32_t slot = uint32_t(mVariants[i].key) & mask;
+			while (newTable[slot] != 0) slot = (slot + 1) & mask;
+			newTable[slot] = i + 1;
+		}
+		mTable.swap(newTable);
+	}
+
+	if (mVariants.capacity() == 0) {
+		if (!mVariants.create(64, "ZeroG - PipelineRenderPermutations - Variants")) return ~0u;
+	}
+	Variant variant;
+	variant.key = key;
+	if (!mVariants.add(variant)) return ~0u;
+	uint32_t variantIdx = mVariants.size() - 1;
+
+	const uint32_t mask = mTable.size() - 1;
+	uint32_t slot = uint32_t(key) & mask;
+	while (mTable[slot] != 0) slot = (slot + 1) & mask;
+	mTable[slot] = variantIdx + 1;
+	return variantIdx;
+}
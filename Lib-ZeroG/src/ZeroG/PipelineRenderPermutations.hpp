@@ -0,0 +1,152 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "ZeroG.h"
+#include "ZeroG/util/SmallVector.hpp"
+#include "ZeroG/util/Vector.hpp"
+
+// ZgPipelineRenderPermutations
+// ------------------------------------------------------------------------------------------------
+
+// Variants of a base pipeline compiled on demand, see zgPipelineRenderPermutationsGet(). Backend
+// agnostic, the variants are created by the backend's ordinary (thread-safe) pipeline creation
+// functions with the permutation's defines or specialization constants merged into a copy of the
+// base create info.
+//
+// Permutations are keyed by a 64-bit hash of their merged and sorted defines or specialization
+// constants (as with the pipeline cache, collisions are assumed never to happen) and looked up in
+// an open addressing hash table, so requesting an already compiled permutation is cheap enough to
+// do per draw. Variants whose compiled shaders hash the same (see
+// ZgBackend::pipelineRenderGetBytecodeHash()) share one pipeline.
+struct ZgPipelineRenderPermutations final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	ZgPipelineRenderPermutations() noexcept = default;
+	ZgPipelineRenderPermutations(const ZgPipelineRenderPermutations&) = delete;
+	ZgPipelineRenderPermutations& operator= (const ZgPipelineRenderPermutations&) = delete;
+	ZgPipelineRenderPermutations(ZgPipelineRenderPermutations&&) = delete;
+	ZgPipelineRenderPermutations& operator= (ZgPipelineRenderPermutations&&) = delete;
+	~ZgPipelineRenderPermutations() noexcept;
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	// Copies the base create info. May only be called once.
+	ZgResult createFromFileSPIRV(const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept;
+	ZgResult createFromMemorySPIRV(
+		const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept;
+	ZgResult createFromFileHLSL(const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept;
+	ZgResult createFromSourceHLSL(const ZgPipelineRenderCreateInfoSourceHLSL& createInfo) noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	// Returns the pipeline of the permutation (which may be null), compiling it if necessary. The
+	// set keeps ownership of the pipeline.
+	ZgResult get(
+		const ZgPipelineRenderPermutation* permutation,
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut) noexcept;
+
+	ZgPipelineRenderPermutationsStats stats() noexcept;
+
+private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	enum class Type : uint32_t {
+		UNDEFINED = 0,
+		FILE_SPIRV,
+		MEMORY_SPIRV,
+		FILE_HLSL,
+		SOURCE_HLSL
+	};
+
+	// The base create info's defines or specialization constants merged with a permutation's
+	struct Merged final {
+		uint32_t numDefines = 0;
+		ZgShaderDefine defines[ZG_MAX_NUM_SHADER_DEFINES] = {};
+		uint32_t numSpecializationConstants = 0;
+		ZgSpecializationConstant specializationConstants[ZG_MAX_NUM_SPECIALIZATION_CONSTANTS] = {};
+	};
+
+	// A requested permutation, index into mPipelines once compiled successfully
+	struct Variant final {
+		uint64_t key = 0;
+		bool compiled = false;
+		ZgResult result = ZG_SUCCESS;
+		uint32_t pipelineIdx = ~0u;
+	};
+
+	// A unique pipeline, shared by all variants whose shaders compiled to the same code
+	struct Pipeline final {
+		ZgPipelineRender* pipeline = nullptr;
+		ZgPipelineRenderSignature signature = {};
+		bool hasBytecodeHash = false;
+		uint64_t bytecodeHash = 0;
+	};
+
+	// Private methods
+	// --------------------------------------------------------------------------------------------
+
+	// Merges the permutation into the base create info's defines or specialization constants and
+	// sorts them, so that the same permutation always results in the same key
+	ZgResult merge(
+		Merged& mergedOut,
+		uint64_t& keyOut,
+		const ZgPipelineRenderPermutation* permutation) noexcept;
+
+	// Creates the pipeline of a permutation through the backend, called without the lock held
+	ZgResult compile(
+		const Merged& merged,
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut) noexcept;
+
+	// Returns the index of the variant with the key, or ~0u if there is none. Requires the lock.
+	uint32_t findVariant(uint64_t key) const noexcept;
+
+	// Adds a variant and inserts it into the hash table, returns ~0u on failure. Requires the lock.
+	uint32_t addVariant(uint64_t key) noexcept;
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	Type mType = Type::UNDEFINED;
+	ZgPipelineRenderCreateInfoFileSPIRV mCreateInfoFileSPIRV = {};
+	ZgPipelineRenderCreateInfoMemorySPIRV mCreateInfoMemorySPIRV = {};
+	ZgPipelineRenderCreateInfoFileHLSL mCreateInfoFileHLSL = {};
+	ZgPipelineRenderCreateInfoSourceHLSL mCreateInfoSourceHLSL = {};
+	zg::Vector<char> mStrings;
+	zg::Vector<uint32_t> mVertexSpirv;
+	zg::Vector<uint32_t> mPixelSpirv;
+
+	std::mutex mMutex;
+	std::condition_variable mCompiledCondition; // Notified each time a variant is compiled
+	zg::SmallVector<Variant, 0> mVariants;
+	zg::SmallVector<uint32_t, 0> mTable; // Power of 2 capacity, variant index + 1 or 0 if empty
+	zg::SmallVector<Pipeline, 0> mPipelines;
+	uint32_t mNumFailedVariants = 0;
+};
@@ -0,0 +1,282 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/ResidencyPolicy.hpp"
+
+#include <algorithm>
+
+#include "ZeroG/util/Logging.hpp"
+
+namespace zg {
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+constexpr float DEFAULT_EVICTION_THRESHOLD = 0.9f;
+
+// Normal priority is 0 so it's the default, so can't compare priorities directly
+static uint32_t priorityRank(ZgResidencyPriority priority) noexcept
+{
+	switch (priority) {
+	case ZG_RESIDENCY_PRIORITY_LOW: return 0;
+	case ZG_RESIDENCY_PRIORITY_NORMAL: return 1;
+	case ZG_RESIDENCY_PRIORITY_HIGH: return 2;
+	default: break;
+	}
+	return 1;
+}
+
+// ResidencyPolicy: State methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult ResidencyPolicy::create(
+	const ZgResidencySettings& settings,
+	void (*evictHeapFunc)(void* userPtr, ZgMemoryHeap* heap),
+	void* evictHeapUserPtr) noexcept
+{
+	this->destroy();
+
+	// Do nothing if residency policy is not enabled
+	if (settings.enabled == ZG_FALSE) return ZG_SUCCESS;
+
+	mSettings = settings;
+	mEvictionThreshold = settings.evictionThreshold;
+	if (mEvictionThreshold <= 0.0f || mEvictionThreshold > 1.0f) {
+		mEvictionThreshold = DEFAULT_EVICTION_THRESHOLD;
+	}
+	mEvictHeapFunc = evictHeapFunc;
+	mEvictHeapUserPtr = evictHeapUserPtr;
+
+	bool allocSuccess = true;
+	allocSuccess &= mEntries.create(
+		RESIDENCY_POLICY_MAX_NUM_HEAPS, "ZeroG - ResidencyPolicy - Entries");
+	allocSuccess &= mCandidates.create(
+		RESIDENCY_POLICY_MAX_NUM_HEAPS, "ZeroG - ResidencyPolicy - Candidates");
+	allocSuccess &= mEvicted.create(
+		RESIDENCY_POLICY_MAX_NUM_HEAPS, "ZeroG - ResidencyPolicy - Evicted");
+	if (!allocSuccess) {
+		this->destroy();
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+
+	mEnabled = true;
+	return ZG_SUCCESS;
+}
+
+void ResidencyPolicy::destroy() noexcept
+{
+	mEnabled = false;
+	mEvictionThreshold = 0.0f;
+	mSettings = {};
+	mEvictHeapFunc = nullptr;
+	mEvictHeapUserPtr = nullptr;
+
+	mEntries.destroy();
+	mCandidates.destroy();
+	mEvicted.destroy();
+	mTick = 0;
+	mCurrentFrameCounters = {};
+	mLastFrameCounters = {};
+}
+
+// ResidencyPolicy: Methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult ResidencyPolicy::addHeap(
+	ZgMemoryHeap* heap, uint64_t sizeBytes, ZgResidencyPriority priority) noexcept
+{
+	if (!mEnabled) return ZG_SUCCESS;
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	Entry entry;
+	entry.heap = heap;
+	entry.sizeBytes = sizeBytes;
+	entry.priority = priority;
+	entry.lastUsedTick = mTick;
+
+	// If the heap can't be tracked it will simply never be evicted
+	if (!mEntries.add(entry)) {
+		ZG_ERROR("ResidencyPolicy: Too many heaps, heap will not be considered for eviction");
+		return ZG_WARNING_GENERIC;
+	}
+	return ZG_SUCCESS;
+}
+
+void ResidencyPolicy::removeHeap(ZgMemoryHeap* heap) noexcept
+{
+	if (!mEnabled) return;
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	Entry* entry = this->findEntryUnmutexed(heap);
+	if (entry == nullptr) return;
+
+	// Order doesn't matter, replace entry with the last one
+	*entry = mEntries.last();
+	mEntries.pop();
+}
+
+ZgResult ResidencyPolicy::setPriority(ZgMemoryHeap* heap, ZgResidencyPriority priority) noexcept
+{
+	if (!mEnabled) return ZG_SUCCESS;
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	Entry* entry = this->findEntryUnmutexed(heap);
+	if (entry == nullptr) return ZG_WARNING_GENERIC;
+	entry->priority = priority;
+	return ZG_SUCCESS;
+}
+
+void ResidencyPolicy::markUsed(
+	ZgMemoryHeap* const* heaps,
+	uint32_t numHeaps,
+	uint32_t queueIdx,
+	uint64_t fenceValue) noexcept
+{
+	if (!mEnabled) return;
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mTick += 1;
+	for (uint32_t i = 0; i < numHeaps; i++) {
+		Entry* entry = this->findEntryUnmutexed(heaps[i]);
+		if (entry == nullptr) continue;
+		this->markEntryUsedUnmutexed(*entry, queueIdx, fenceValue);
+	}
+}
+
+void ResidencyPolicy::markAllUsed(uint32_t queueIdx, uint64_t fenceValue) noexcept
+{
+	if (!mEnabled) return;
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mTick += 1;
+	for (uint32_t i = 0; i < mEntries.size(); i++) {
+		this->markEntryUsedUnmutexed(mEntries[i], queueIdx, fenceValue);
+	}
+}
+
+void ResidencyPolicy::newFrame(
+	uint64_t budgetBytes,
+	uint64_t usageBytes,
+	const uint64_t completedFenceValues[RESIDENCY_POLICY_MAX_NUM_QUEUES]) noexcept
+{
+	if (!mEnabled) return;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		// Rotate per-frame counters
+		mLastFrameCounters = mCurrentFrameCounters;
+		mCurrentFrameCounters = {};
+		mEvicted.clear();
+
+		// Don't do anything if usage is below threshold
+		uint64_t thresholdBytes = uint64_t(double(budgetBytes) * double(mEvictionThreshold));
+		if (usageBytes <= thresholdBytes) return;
+		uint64_t bytesToEvict = usageBytes - thresholdBytes;
+
+		// Find all resident heaps not currently in use by the GPU
+		mCandidates.clear();
+		for (uint32_t i = 0; i < mEntries.size(); i++) {
+			const Entry& entry = mEntries[i];
+			if (!entry.resident) continue;
+			bool inUse = false;
+			for (uint32_t q = 0; q < RESIDENCY_POLICY_MAX_NUM_QUEUES; q++) {
+				inUse |= entry.lastUsedFenceValues[q] > completedFenceValues[q];
+			}
+			if (inUse) continue;
+			mCandidates.add(i);
+		}
+
+		// Sort candidates, low priority first and then least recently used
+		std::sort(mCandidates.data(), mCandidates.data() + mCandidates.size(),
+			[this](uint32_t lhsIdx, uint32_t rhsIdx) {
+			const Entry& lhs = mEntries[lhsIdx];
+			const Entry& rhs = mEntries[rhsIdx];
+			uint32_t lhsRank = priorityRank(lhs.priority);
+			uint32_t rhsRank = priorityRank(rhs.priority);
+			if (lhsRank != rhsRank) return lhsRank < rhsRank;
+			return lhs.lastUsedTick < rhs.lastUsedTick;
+		});
+
+		// Evict heaps until enough memory is freed
+		uint64_t bytesEvicted = 0;
+		for (uint32_t i = 0; i < mCandidates.size() && bytesEvicted < bytesToEvict; i++) {
+			Entry& entry = mEntries[mCandidates[i]];
+			mEvictHeapFunc(mEvictHeapUserPtr, entry.heap);
+			entry.resident = false;
+			bytesEvicted += entry.sizeBytes;
+
+			mCurrentFrameCounters.numHeapsEvicted += 1;
+			mCurrentFrameCounters.bytesEvicted += entry.sizeBytes;
+
+			EvictedHeap evicted;
+			evicted.heap = entry.heap;
+			evicted.sizeBytes = entry.sizeBytes;
+			mEvicted.add(evicted);
+		}
+
+		if (bytesEvicted < bytesToEvict) {
+			ZG_NOISE("ResidencyPolicy: Could only evict %llu of %llu bytes wanted",
+				(unsigned long long)bytesEvicted, (unsigned long long)bytesToEvict);
+		}
+	}
+
+	// Call user eviction callback outside of mutex, in case the user wants to release the heap
+	if (mSettings.evictionCallback != nullptr) {
+		for (uint32_t i = 0; i < mEvicted.size(); i++) {
+			mSettings.evictionCallback(
+				mSettings.userPtr, mEvicted[i].heap, mEvicted[i].sizeBytes);
+		}
+	}
+}
+
+// ResidencyPolicy: Getters
+// ------------------------------------------------------------------------------------------------
+
+ResidencyCounters ResidencyPolicy::lastFrameCounters() noexcept
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mLastFrameCounters;
+}
+
+// ResidencyPolicy: Private methods
+// ------------------------------------------------------------------------------------------------
+
+ResidencyPolicy::Entry* ResidencyPolicy::findEntryUnmutexed(ZgMemoryHeap* heap) noexcept
+{
+	for (uint32_t i = 0; i < mEntries.size(); i++) {
+		if (mEntries[i].heap == heap) return &mEntries[i];
+	}
+	return nullptr;
+}
+
+void ResidencyPolicy::markEntryUsedUnmutexed(
+	Entry& entry, uint32_t queueIdx, uint64_t fenceValue) noexcept
+{
+	entry.lastUsedTick = mTick;
+	entry.lastUsedFenceValues[queueIdx] = std::max(entry.lastUsedFenceValues[queueIdx], fenceValue);
+
+	// The backend makes evicted heaps resident again when they are used
+	if (!entry.resident) {
+		entry.resident = true;
+		mCurrentFrameCounters.numHeapsMadeResident += 1;
+		mCurrentFrameCounters.bytesMadeResident += entry.sizeBytes;
+	}
+}
+
+} // namespace zg
@@ -0,0 +1,154 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+#include "ZeroG.h"
+#include "ZeroG/util/Vector.hpp"
+
+namespace zg {
+
+// Constants
+// ------------------------------------------------------------------------------------------------
+
+constexpr uint32_t RESIDENCY_POLICY_MAX_NUM_QUEUES = 2;
+constexpr uint32_t RESIDENCY_POLICY_MAX_NUM_HEAPS = 4096;
+
+// Residency counters
+// ------------------------------------------------------------------------------------------------
+
+struct ResidencyCounters final {
+	uint32_t numHeapsEvicted = 0;
+	uint32_t numHeapsMadeResident = 0;
+	uint64_t bytesEvicted = 0;
+	uint64_t bytesMadeResident = 0;
+};
+
+// Residency policy
+// ------------------------------------------------------------------------------------------------
+
+// Backend-neutral policy deciding which memory heaps to evict when memory usage nears the budget.
+//
+// The backend registers its heaps, marks them as used (together with the fence value of the
+// queue they are used on) when command lists are executed and calls newFrame() once per frame
+// with the current memory budget and usage. Heaps that are not in use by the GPU are then
+// evicted in order of priority (low first) and least recently used, until the usage is below
+// the eviction threshold. The backend is responsible for making evicted heaps resident again
+// when they are used.
+class ResidencyPolicy final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	ResidencyPolicy() noexcept = default;
+	ResidencyPolicy(const ResidencyPolicy&) = delete;
+	ResidencyPolicy& operator= (const ResidencyPolicy&) = delete;
+	ResidencyPolicy(ResidencyPolicy&&) = delete;
+	ResidencyPolicy& operator= (ResidencyPolicy&&) = delete;
+	~ResidencyPolicy() noexcept { this->destroy(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	// The evict function is called by the policy to actually evict a heap. It is called with the
+	// policy's internal mutex held, so it must not call back into the policy.
+	ZgResult create(
+		const ZgResidencySettings& settings,
+		void (*evictHeapFunc)(void* userPtr, ZgMemoryHeap* heap),
+		void* evictHeapUserPtr) noexcept;
+	void destroy() noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	ZgResult addHeap(ZgMemoryHeap* heap, uint64_t sizeBytes, ZgResidencyPriority priority) noexcept;
+	void removeHeap(ZgMemoryHeap* heap) noexcept;
+	ZgResult setPriority(ZgMemoryHeap* heap, ZgResidencyPriority priority) noexcept;
+
+	// Marks heaps as used on the specified queue. The fence value must be the value that will be
+	// signaled once the GPU is done with the work using the heaps, and this must be called
+	// before the work is submitted to the GPU.
+	void markUsed(
+		ZgMemoryHeap* const* heaps,
+		uint32_t numHeaps,
+		uint32_t queueIdx,
+		uint64_t fenceValue) noexcept;
+
+	// Marks all heaps as used, for when the set of heaps used by some work is not known.
+	void markAllUsed(uint32_t queueIdx, uint64_t fenceValue) noexcept;
+
+	// Starts a new frame, rotating the per-frame counters and evicting heaps if the memory usage
+	// is above the eviction threshold. completedFenceValues contains the last completed fence
+	// value of each queue. Any eviction callback is called before this function returns.
+	void newFrame(
+		uint64_t budgetBytes,
+		uint64_t usageBytes,
+		const uint64_t completedFenceValues[RESIDENCY_POLICY_MAX_NUM_QUEUES]) noexcept;
+
+	// Getters
+	// --------------------------------------------------------------------------------------------
+
+	bool isEnabled() const noexcept { return mEnabled; }
+	ResidencyCounters lastFrameCounters() noexcept;
+
+private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	struct Entry final {
+		ZgMemoryHeap* heap = nullptr;
+		uint64_t sizeBytes = 0;
+		ZgResidencyPriority priority = ZG_RESIDENCY_PRIORITY_NORMAL;
+		bool resident = true;
+		uint64_t lastUsedTick = 0;
+		uint64_t lastUsedFenceValues[RESIDENCY_POLICY_MAX_NUM_QUEUES] = {};
+	};
+
+	struct EvictedHeap final {
+		ZgMemoryHeap* heap = nullptr;
+		uint64_t sizeBytes = 0;
+	};
+
+	// Private methods
+	// --------------------------------------------------------------------------------------------
+
+	Entry* findEntryUnmutexed(ZgMemoryHeap* heap) noexcept;
+	void markEntryUsedUnmutexed(Entry& entry, uint32_t queueIdx, uint64_t fenceValue) noexcept;
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	bool mEnabled = false;
+	float mEvictionThreshold = 0.0f;
+	ZgResidencySettings mSettings = {};
+	void (*mEvictHeapFunc)(void* userPtr, ZgMemoryHeap* heap) = nullptr;
+	void* mEvictHeapUserPtr = nullptr;
+
+	std::mutex mMutex;
+	Vector<Entry> mEntries;
+	Vector<uint32_t> mCandidates;
+	Vector<EvictedHeap> mEvicted;
+	uint64_t mTick = 0;
+	ResidencyCounters mCurrentFrameCounters;
+	ResidencyCounters mLastFrameCounters;
+};
+
+} // namespace zg
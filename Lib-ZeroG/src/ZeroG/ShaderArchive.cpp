@@ -0,0 +1,233 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/ShaderArchive.hpp"
+
+#include <cstring>
+
+#include "ZeroG/util/Hash.hpp"
+#include "ZeroG/util/Logging.hpp"
+
+namespace zg {
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+static bool rangeInArchive(uint64_t offset, uint64_t sizeBytes, uint64_t archiveSizeBytes) noexcept
+{
+	return offset <= archiveSizeBytes && sizeBytes <= (archiveSizeBytes - offset);
+}
+
+static bool isTextBlob(ShaderArchiveBlobType type) noexcept
+{
+	switch (type) {
+	case ShaderArchiveBlobType::NAME:
+	case ShaderArchiveBlobType::VERTEX_HLSL:
+	case ShaderArchiveBlobType::PIXEL_HLSL:
+	case ShaderArchiveBlobType::VERTEX_MSL:
+	case ShaderArchiveBlobType::PIXEL_MSL:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// The reflection is used as is by the backends, so its counts must be within the signature's
+// arrays
+static bool reflectionValid(const SpirvPipelineReflection& spirvReflection) noexcept
+{
+	const ZgPipelineRenderSignature& signature = spirvReflection.reflection.signature;
+	return
+		signature.numVertexAttributes <= ZG_MAX_NUM_VERTEX_ATTRIBUTES &&
+		signature.numConstantBuffers <= ZG_MAX_NUM_CONSTANT_BUFFERS &&
+		signature.numTextures <= ZG_MAX_NUM_TEXTURES &&
+		signature.numRenderTargets <= ZG_MAX_NUM_RENDER_TARGETS;
+}
+
+// Shader archive format
+// ------------------------------------------------------------------------------------------------
+
+uint64_t shaderArchiveNameHash(const char* name) noexcept
+{
+	return hashString(name);
+}
+
+// Shader archive reading
+// ------------------------------------------------------------------------------------------------
+
+ZgResult validateShaderArchive(const uint8_t* archive, uint64_t archiveSizeBytes) noexcept
+{
+	if (archive == nullptr || archiveSizeBytes < sizeof(ShaderArchiveHeader)) {
+		ZG_ERROR("Shader archive is too small to contain a header");
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	const ShaderArchiveHeader& header = *reinterpret_cast<const ShaderArchiveHeader*>(archive);
+	if (header.magic != SHADER_ARCHIVE_MAGIC) {
+		ZG_ERROR("Not a shader archive");
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+	if (header.version != SHADER_ARCHIVE_VERSION ||
+		header.reflectionSizeBytes != sizeof(SpirvPipelineReflection)) {
+		ZG_ERROR("Shader archive version %u does not match runtime version %u, recompile it",
+			header.version, SHADER_ARCHIVE_VERSION);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+	if (header.fileSizeBytes != archiveSizeBytes) {
+		ZG_ERROR("Shader archive is truncated, expected %llu bytes but got %llu",
+			(unsigned long long)header.fileSizeBytes, (unsigned long long)archiveSizeBytes);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Validate index and entry tables
+	bool numSlotsPow2 = header.numSlots != 0 && (header.numSlots & (header.numSlots - 1)) == 0;
+	bool tablesValid =
+		numSlotsPow2 &&
+		header.numSlots > header.numEntries &&
+		(header.slotsOffset % alignof(ShaderArchiveSlot)) == 0 &&
+		(header.entriesOffset % alignof(ShaderArchiveEntry)) == 0 &&
+		rangeInArchive(header.slotsOffset,
+			uint64_t(header.numSlots) * sizeof(ShaderArchiveSlot), archiveSizeBytes) &&
+		rangeInArchive(header.entriesOffset,
+			uint64_t(header.numEntries) * sizeof(ShaderArchiveEntry), archiveSizeBytes);
+	if (!tablesValid) {
+		ZG_ERROR("Shader archive has invalid index or entry table");
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	const ShaderArchiveSlot* slots =
+		reinterpret_cast<const ShaderArchiveSlot*>(archive + header.slotsOffset);
+	const ShaderArchiveEntry* entries =
+		reinterpret_cast<const ShaderArchiveEntry*>(archive + header.entriesOffset);
+
+	// Validate slots, every non-empty slot must point to an entry with the same hash
+	uint32_t numOccupiedSlots = 0;
+	for (uint32_t i = 0; i < header.numSlots; i++) {
+		const ShaderArchiveSlot& slot = slots[i];
+		if (slot.entryIdx == SHADER_ARCHIVE_EMPTY_SLOT) continue;
+		if (slot.entryIdx >= header.numEntries ||
+			entries[slot.entryIdx].nameHash != slot.nameHash) {
+			ZG_ERROR("Shader archive slot %u is invalid", i);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+		numOccupiedSlots += 1;
+	}
+	if (numOccupiedSlots != header.numEntries) {
+		ZG_ERROR("Shader archive index has %u slots in use, but there are %u entries",
+			numOccupiedSlots, header.numEntries);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Validate blobs of all entries. The shader compiler always writes all of them, and each
+	// backend needs some of them, so an entry missing any blob is corrupt.
+	for (uint32_t i = 0; i < header.numEntries; i++) {
+		const ShaderArchiveEntry& entry = entries[i];
+		for (uint32_t j = 0; j < uint32_t(ShaderArchiveBlobType::COUNT); j++) {
+			ShaderArchiveBlobType type = ShaderArchiveBlobType(j);
+			const ShaderArchiveBlob& blob = entry.blobs[j];
+
+			bool valid =
+				blob.sizeBytes != 0 &&
+				blob.sizeBytes <= UINT32_MAX &&
+				rangeInArchive(blob.offset, blob.sizeBytes, archiveSizeBytes) &&
+				(blob.offset % SHADER_ARCHIVE_BLOB_ALIGNMENT) == 0;
+
+			// Text must be non-empty and null-terminated
+			if (valid && isTextBlob(type)) {
+				valid = blob.sizeBytes >= 2 && archive[blob.offset + blob.sizeBytes - 1] == '\0';
+			}
+			if (valid && type == ShaderArchiveBlobType::REFLECTION) {
+				valid = blob.sizeBytes == sizeof(SpirvPipelineReflection) && reflectionValid(
+					*reinterpret_cast<const SpirvPipelineReflection*>(archive + blob.offset));
+			}
+			if (!valid) {
+				ZG_ERROR("Shader archive entry %u has a missing or invalid blob (type %u)", i, j);
+				return ZG_ERROR_INVALID_ARGUMENT;
+			}
+		}
+	}
+
+	return ZG_SUCCESS;
+}
+
+const ShaderArchiveEntry* findShaderArchiveEntry(
+	const uint8_t* archive, const char* name) noexcept
+{
+	const ShaderArchiveHeader& header = *reinterpret_cast<const ShaderArchiveHeader*>(archive);
+	const ShaderArchiveSlot* slots =
+		reinterpret_cast<const ShaderArchiveSlot*>(archive + header.slotsOffset);
+	const ShaderArchiveEntry* entries =
+		reinterpret_cast<const ShaderArchiveEntry*>(archive + header.entriesOffset);
+
+	// Probe linearly from the home slot until the entry or an empty slot is found. There is
+	// always at least one empty slot, so this terminates.
+	uint64_t nameHash = shaderArchiveNameHash(name);
+	uint32_t mask = header.numSlots - 1;
+	for (uint32_t i = uint32_t(nameHash) & mask; ; i = (i + 1) & mask) {
+		const ShaderArchiveSlot& slot = slots[i];
+		if (slot.entryIdx == SHADER_ARCHIVE_EMPTY_SLOT) return nullptr;
+		if (slot.nameHash != nameHash) continue;
+
+		// Compare names as well, in case of a hash collision
+		const ShaderArchiveEntry& entry = entries[slot.entryIdx];
+		uint64_t nameSize = 0;
+		const uint8_t* entryName =
+			getShaderArchiveBlob(archive, entry, ShaderArchiveBlobType::NAME, nameSize);
+		if (std::strcmp(reinterpret_cast<const char*>(entryName), name) == 0) return &entry;
+	}
+}
+
+bool getShaderArchivePipeline(
+	ShaderArchivePipeline& pipelineOut, const uint8_t* archive, const char* name) noexcept
+{
+	pipelineOut = {};
+	const ShaderArchiveEntry* entry = findShaderArchiveEntry(archive, name);
+	if (entry == nullptr) return false;
+
+	auto getBlob = [&](ShaderArchiveBlobType type, uint32_t& sizeBytesOut) {
+		uint64_t sizeBytes = 0;
+		const uint8_t* blob = getShaderArchiveBlob(archive, *entry, type, sizeBytes);
+		sizeBytesOut = uint32_t(sizeBytes);
+		return blob;
+	};
+	auto getText = [&](ShaderArchiveBlobType type, uint32_t& sizeBytesOut) {
+		const char* text = reinterpret_cast<const char*>(getBlob(type, sizeBytesOut));
+		if (sizeBytesOut != 0) sizeBytesOut -= 1; // Don't count null-terminator
+		return text;
+	};
+
+	uint32_t unusedSize = 0;
+	pipelineOut.name = getText(ShaderArchiveBlobType::NAME, unusedSize);
+	pipelineOut.reflection = reinterpret_cast<const SpirvPipelineReflection*>(
+		getBlob(ShaderArchiveBlobType::REFLECTION, unusedSize));
+	pipelineOut.vertexSpirv =
+		getBlob(ShaderArchiveBlobType::VERTEX_SPIRV, pipelineOut.vertexSpirvSizeBytes);
+	pipelineOut.pixelSpirv =
+		getBlob(ShaderArchiveBlobType::PIXEL_SPIRV, pipelineOut.pixelSpirvSizeBytes);
+	pipelineOut.vertexHlsl =
+		getText(ShaderArchiveBlobType::VERTEX_HLSL, pipelineOut.vertexHlslSizeBytes);
+	pipelineOut.pixelHlsl =
+		getText(ShaderArchiveBlobType::PIXEL_HLSL, pipelineOut.pixelHlslSizeBytes);
+	pipelineOut.vertexMsl =
+		getText(ShaderArchiveBlobType::VERTEX_MSL, pipelineOut.vertexMslSizeBytes);
+	pipelineOut.pixelMsl =
+		getText(ShaderArchiveBlobType::PIXEL_MSL, pipelineOut.pixelMslSizeBytes);
+	return true;
+}
+
+} // namespace zg
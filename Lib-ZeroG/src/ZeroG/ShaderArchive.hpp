@@ -0,0 +1,157 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+
+#include "ZeroG/SpirvCross.hpp"
+#include "ZeroG/util/FileIO.hpp"
+
+namespace zg {
+
+// Shader archive format
+// ------------------------------------------------------------------------------------------------
+
+// A shader archive is a single file with precompiled shaders for a number of render pipelines,
+// created at build time by the offline shader compiler (Tool-ZeroG-ShaderCompiler). Each entry
+// holds the SPIR-V of a pipeline's vertex and pixel shader, the HLSL and MSL cross-compiled from
+// it and its reflection. Entries are found by name through a hash table, so lookups don't depend
+// on the number of entries in the archive. At runtime archives are memory mapped and used in place
+// (see ZgShaderArchive below), which is why everything in them is aligned.
+//
+// Layout, all offsets are relative to the start of the file:
+//
+//     ShaderArchiveHeader
+//     ShaderArchiveSlot[numSlots]        Open addressing (linear probing) by hash of entry name
+//     ShaderArchiveEntry[numEntries]
+//     Blobs, each aligned to SHADER_ARCHIVE_BLOB_ALIGNMENT
+//
+// The archive is written in the byte order of the machine that compiled it, which in practice is
+// always little-endian.
+
+constexpr uint32_t SHADER_ARCHIVE_MAGIC = 0x4153475A; // "ZGSA"
+constexpr uint32_t SHADER_ARCHIVE_VERSION = 3;
+constexpr uint64_t SHADER_ARCHIVE_BLOB_ALIGNMENT = 16;
+constexpr uint32_t SHADER_ARCHIVE_EMPTY_SLOT = ~0u;
+
+enum class ShaderArchiveBlobType : uint32_t {
+	NAME = 0, // Null-terminated name of the entry
+	REFLECTION, // SpirvPipelineReflection
+	VERTEX_SPIRV,
+	PIXEL_SPIRV,
+	VERTEX_HLSL, // Null-terminated
+	PIXEL_HLSL, // Null-terminated
+	VERTEX_MSL, // Null-terminated
+	PIXEL_MSL, // Null-terminated
+	COUNT
+};
+
+struct ShaderArchiveHeader final {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t numEntries;
+	uint32_t numSlots; // Power of two, larger than numEntries
+	uint32_t reflectionSizeBytes; // sizeof(SpirvPipelineReflection) of the compiler
+	uint32_t padding;
+	uint64_t fileSizeBytes;
+	uint64_t slotsOffset;
+	uint64_t entriesOffset;
+};
+static_assert(sizeof(ShaderArchiveHeader) == 48, "ShaderArchiveHeader is not tightly packed");
+
+struct ShaderArchiveSlot final {
+	uint64_t nameHash;
+	uint32_t entryIdx; // SHADER_ARCHIVE_EMPTY_SLOT if empty
+	uint32_t padding;
+};
+static_assert(sizeof(ShaderArchiveSlot) == 16, "ShaderArchiveSlot is not tightly packed");
+
+struct ShaderArchiveBlob final {
+	uint64_t offset;
+	uint64_t sizeBytes; // Including null-terminator for text blobs, 0 if not present
+};
+
+struct ShaderArchiveEntry final {
+	uint64_t nameHash;
+	ShaderArchiveBlob blobs[uint32_t(ShaderArchiveBlobType::COUNT)];
+};
+
+// Hashes the name of an entry, the index slot to start probing at is the hash masked by
+// numSlots - 1.
+uint64_t shaderArchiveNameHash(const char* name) noexcept;
+
+// Shader archive reading
+// ------------------------------------------------------------------------------------------------
+
+// Validates the header of a shader archive and checks that all slots, entries and blobs lie
+// within it, that every entry has all blobs and that the reflection counts are within limits.
+// Archives are validated once when loaded, after that no lookup needs bounds checks.
+ZgResult validateShaderArchive(const uint8_t* archive, uint64_t archiveSizeBytes) noexcept;
+
+// Finds an entry by name in a validated archive, returns nullptr if there is no such entry.
+const ShaderArchiveEntry* findShaderArchiveEntry(
+	const uint8_t* archive, const char* name) noexcept;
+
+// Returns a pointer to a blob of an entry in a validated archive, or nullptr if not present.
+inline const uint8_t* getShaderArchiveBlob(
+	const uint8_t* archive,
+	const ShaderArchiveEntry& entry,
+	ShaderArchiveBlobType type,
+	uint64_t& sizeBytesOut) noexcept
+{
+	const ShaderArchiveBlob& blob = entry.blobs[uint32_t(type)];
+	sizeBytesOut = blob.sizeBytes;
+	if (blob.sizeBytes == 0) return nullptr;
+	return archive + blob.offset;
+}
+
+// Pointers to everything stored for a pipeline in a validated archive, all pointing directly into
+// the archive. Sizes of text blobs do not include the null-terminator.
+struct ShaderArchivePipeline final {
+	const char* name = nullptr;
+	const SpirvPipelineReflection* reflection = nullptr;
+	const uint8_t* vertexSpirv = nullptr;
+	uint32_t vertexSpirvSizeBytes = 0;
+	const uint8_t* pixelSpirv = nullptr;
+	uint32_t pixelSpirvSizeBytes = 0;
+	const char* vertexHlsl = nullptr;
+	uint32_t vertexHlslSizeBytes = 0;
+	const char* pixelHlsl = nullptr;
+	uint32_t pixelHlslSizeBytes = 0;
+	const char* vertexMsl = nullptr;
+	uint32_t vertexMslSizeBytes = 0;
+	const char* pixelMsl = nullptr;
+	uint32_t pixelMslSizeBytes = 0;
+};
+
+// Finds a pipeline by name in a validated archive. Returns false if there is no such pipeline.
+bool getShaderArchivePipeline(
+	ShaderArchivePipeline& pipelineOut, const uint8_t* archive, const char* name) noexcept;
+
+} // namespace zg
+
+// ZgShaderArchive
+// ------------------------------------------------------------------------------------------------
+
+// A shader archive loaded at runtime. The file is memory mapped and validated once on load, after
+// that looking up pipelines involves no file I/O, allocations or copies.
+struct ZgShaderArchive final {
+	zg::MappedFile file;
+	uint32_t numPipelines = 0;
+};
@@ -0,0 +1,457 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/ShaderHotReload.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "ZeroG/BackendInterface.hpp"
+#include "ZeroG/Context.hpp"
+#include "ZeroG/util/FileIO.hpp"
+#include "ZeroG/util/Logging.hpp"
+#include "ZeroG/util/Strings.hpp"
+
+namespace zg {
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+namespace fs = std::filesystem;
+
+constexpr uint32_t SHADER_HOT_RELOAD_DEFAULT_POLL_INTERVAL_MS = 100;
+
+// Entry points, (vertex and pixel) shader paths, DXC compiler flags and define names and values
+constexpr uint32_t SHADER_HOT_RELOAD_MAX_NUM_STRINGS =
+	4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * ZG_MAX_NUM_SHADER_DEFINES;
+
+static bool fileExists(const fs::path& path) noexcept
+{
+	std::error_code ec;
+	return fs::is_regular_file(path, ec);
+}
+
+// Parses the name of an #include directive, i.e. the part within quotes or angle brackets.
+// Returns false if the line is not an #include directive.
+static bool parseInclude(
+	const char* line, const char* lineEnd, const char*& nameOut, uint32_t& nameLenOut) noexcept
+{
+	auto skipSpaces = [&]() {
+		while (line < lineEnd && (*line == ' ' || *line == '\t')) line++;
+	};
+
+	skipSpaces();
+	if (line == lineEnd || *line != '#') return false;
+	line++;
+	skipSpaces();
+	constexpr uint32_t INCLUDE_LEN = 7;
+	if (uint32_t(lineEnd - line) < INCLUDE_LEN || std::strncmp(line, "include", INCLUDE_LEN) != 0) {
+		return false;
+	}
+	line += INCLUDE_LEN;
+	skipSpaces();
+	if (line == lineEnd || (*line != '"' && *line != '<')) return false;
+	char closing = *line == '"' ? '"' : '>';
+	line++;
+
+	const char* nameEnd = line;
+	while (nameEnd < lineEnd && *nameEnd != closing) nameEnd++;
+	if (nameEnd == lineEnd || nameEnd == line) return false;
+	nameOut = line;
+	nameLenOut = uint32_t(nameEnd - line);
+	return true;
+}
+
+// Returns the include directories among the DXC compiler flags, i.e. "-I <dir>", "-I<dir>" or the
+// same with "/I".
+static SmallVector<fs::path, 4> includeDirectories(
+	const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept
+{
+	SmallVector<fs::path, 4> directories;
+	for (uint32_t i = 0; i < ZG_MAX_NUM_DXC_COMPILER_FLAGS; i++) {
+		const char* flag = createInfo.dxcCompilerFlags[i];
+		if (flag == nullptr) continue;
+		if ((flag[0] != '-' && flag[0] != '/') || flag[1] != 'I') continue;
+
+		const char* directory = flag + 2;
+		while (*directory == ' ') directory++;
+		if (*directory == '\0') {
+			if (i + 1 >= ZG_MAX_NUM_DXC_COMPILER_FLAGS) continue;
+			directory = createInfo.dxcCompilerFlags[i + 1];
+			if (directory == nullptr) continue;
+		}
+		directories.add(fs::path(directory));
+	}
+	return directories;
+}
+
+// ShaderHotReload: State methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult ShaderHotReload::create(const ZgShaderHotReloadSettings& settings) noexcept
+{
+	this->destroy();
+	if (!settings.enabled) return ZG_SUCCESS;
+
+	ZgResult watcherRes = mWatcher.create();
+	if (watcherRes != ZG_SUCCESS) return watcherRes;
+	mEntries.create(64, "ZeroG - ShaderHotReload - Entries");
+
+	mPollIntervalMs = settings.pollIntervalMs != 0 ?
+		settings.pollIntervalMs : SHADER_HOT_RELOAD_DEFAULT_POLL_INTERVAL_MS;
+	mExitRequested = false;
+	mEnabled = true;
+	mThread = std::thread(&ShaderHotReload::reloadThread, this);
+
+	ZG_INFO("Shader hot-reload enabled, checking for modified files every %u ms",
+		mPollIntervalMs);
+	return ZG_SUCCESS;
+}
+
+void ShaderHotReload::destroy() noexcept
+{
+	if (!mEnabled) return;
+
+	// Stop the reload thread, it finishes the compilation it's in the middle of first
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mExitRequested = true;
+	}
+	mCondVar.notify_one();
+	if (mThread.joinable()) mThread.join();
+
+	for (uint32_t i = 0; i < mEntries.size(); i++) {
+		this->releaseEntryUnmutexed(mEntries[i]);
+	}
+	mEntries.destroy();
+	mWatcher.destroy();
+	mStats = {};
+	mEnabled = false;
+}
+
+// ShaderHotReload: Methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult ShaderHotReload::registerPipeline(
+	ZgPipelineRender* pipeline,
+	const ZgPipelineRenderSignature& signature,
+	const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept
+{
+	if (!mEnabled) return ZG_SUCCESS;
+
+	Entry* entry = zgNew<Entry>("ZeroG - ShaderHotReload - Entry");
+	if (entry == nullptr) {
+		ZG_ERROR("Shader hot-reload: Out of memory, can't watch pipeline");
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+	entry->pipeline = pipeline;
+	entry->signature = signature;
+	entry->isHLSL = true;
+	entry->createInfoHLSL = createInfo;
+	ZgPipelineRenderCreateInfoFileHLSL& info = entry->createInfoHLSL;
+
+	const char** strings[SHADER_HOT_RELOAD_MAX_NUM_STRINGS] = {
+		&info.common.vertexShaderEntry,
+		&info.common.pixelShaderEntry,
+		&info.vertexShaderPath,
+		&info.pixelShaderPath
+	};
+	for (uint32_t i = 0; i < ZG_MAX_NUM_DXC_COMPILER_FLAGS; i++) {
+		strings[4 + i] = &info.dxcCompilerFlags[i];
+	}
+	for (uint32_t i = 0; i < ZG_MAX_NUM_SHADER_DEFINES; i++) {
+		strings[4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * i] = &info.defines[i].name;
+		strings[4 + ZG_MAX_NUM_DXC_COMPILER_FLAGS + 2 * i + 1] = &info.defines[i].value;
+	}
+	if (!copyStrings(entry->strings, strings, SHADER_HOT_RELOAD_MAX_NUM_STRINGS,
+		"ZeroG - ShaderHotReload - Strings")) {
+		ZG_ERROR("Shader hot-reload: Out of memory, can't watch pipeline");
+		zgDelete(entry);
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+	return this->addEntry(entry);
+}
+
+ZgResult ShaderHotReload::registerPipeline(
+	ZgPipelineRender* pipeline,
+	const ZgPipelineRenderSignature& signature,
+	const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept
+{
+	if (!mEnabled) return ZG_SUCCESS;
+
+	Entry* entry = zgNew<Entry>("ZeroG - ShaderHotReload - Entry");
+	if (entry == nullptr) {
+		ZG_ERROR("Shader hot-reload: Out of memory, can't watch pipeline");
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+	entry->pipeline = pipeline;
+	entry->signature = signature;
+	entry->isHLSL = false;
+	entry->createInfoSPIRV = createInfo;
+	ZgPipelineRenderCreateInfoFileSPIRV& info = entry->createInfoSPIRV;
+
+	const char** strings[] = {
+		&info.common.vertexShaderEntry,
+		&info.common.pixelShaderEntry,
+		&info.vertexShaderPath,
+		&info.pixelShaderPath
+	};
+	if (!copyStrings(entry->strings, strings, 4, "ZeroG - ShaderHotReload - Strings")) {
+		ZG_ERROR("Shader hot-reload: Out of memory, can't watch pipeline");
+		zgDelete(entry);
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+	return this->addEntry(entry);
+}
+
+void ShaderHotReload::unregisterPipeline(ZgPipelineRender* pipeline) noexcept
+{
+	if (!mEnabled) return;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	for (uint32_t i = 0; i < mEntries.size(); i++) {
+		Entry* entry = mEntries[i];
+		if (entry->pipeline != pipeline) continue;
+		mEntries.remove(i);
+
+		// The reload thread is using the entry, let it delete it once done
+		if (entry->compiling) entry->released = true;
+		else this->releaseEntryUnmutexed(entry);
+		return;
+	}
+}
+
+void ShaderHotReload::applyReloaded() noexcept
+{
+	if (!mEnabled) return;
+
+	ZgBackend* backend = getBackend();
+	std::lock_guard<std::mutex> lock(mMutex);
+	for (uint32_t i = 0; i < mEntries.size(); i++) {
+		Entry& entry = *mEntries[i];
+		if (entry.reloaded == nullptr) continue;
+
+		// The backend takes ownership of the recompiled pipeline, even on failure. Unless command
+		// lists are being recorded, in which case we try again next frame.
+		ZgPipelineRender* reloaded = entry.reloaded;
+		ZgResult res = backend->pipelineRenderReplace(entry.pipeline, reloaded);
+		if (res == ZG_WARNING_GENERIC) continue;
+		entry.reloaded = nullptr;
+		if (res != ZG_SUCCESS) {
+			ZG_ERROR("Shader hot-reload: Backend could not swap in recompiled pipeline");
+			mStats.numFailures += 1;
+			continue;
+		}
+		mStats.numReloads += 1;
+
+		const char* vertexPath = entry.isHLSL ?
+			entry.createInfoHLSL.vertexShaderPath : entry.createInfoSPIRV.vertexShaderPath;
+		const char* pixelPath = entry.isHLSL ?
+			entry.createInfoHLSL.pixelShaderPath : entry.createInfoSPIRV.pixelShaderPath;
+		ZG_INFO("Shader hot-reload: Reloaded pipeline (\"%s\", \"%s\")", vertexPath, pixelPath);
+	}
+}
+
+ShaderHotReloadStats ShaderHotReload::stats() noexcept
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStats;
+}
+
+// ShaderHotReload: Private methods
+// ------------------------------------------------------------------------------------------------
+
+void ShaderHotReload::findDependencies(
+	const Entry& entry, Dependencies& dependenciesOut) noexcept
+{
+	const char* vertexPath = entry.isHLSL ?
+		entry.createInfoHLSL.vertexShaderPath : entry.createInfoSPIRV.vertexShaderPath;
+	const char* pixelPath = entry.isHLSL ?
+		entry.createInfoHLSL.pixelShaderPath : entry.createInfoSPIRV.pixelShaderPath;
+
+	auto addDependency = [&](const std::string& path) {
+		if (path.size() >= FILE_WATCHER_MAX_PATH_LENGTH) return false;
+		for (uint32_t i = 0; i < dependenciesOut.size(); i++) {
+			if (std::strcmp(dependenciesOut[i].path, path.c_str()) == 0) return false;
+		}
+		Dependency dependency;
+		std::memcpy(dependency.path, path.c_str(), path.size() + 1);
+		return dependenciesOut.add(dependency);
+	};
+	addDependency(fs::path(vertexPath).lexically_normal().generic_string());
+	addDependency(fs::path(pixelPath).lexically_normal().generic_string());
+	if (!entry.isHLSL) return;
+
+	// Scan the shaders (and, since new dependencies are appended, everything they include) for
+	// #include directives. Includes are resolved the same way as by DXC's default include
+	// handler: relative to the including file, then relative to each include directory. Includes
+	// that can't be found are skipped, they might be inside code that is #if:ed out.
+	SmallVector<fs::path, 4> directories = includeDirectories(entry.createInfoHLSL);
+	for (uint32_t depIdx = 0; depIdx < dependenciesOut.size(); depIdx++) {
+		fs::path includingPath = dependenciesOut[depIdx].path;
+		Vector<uint8_t> source = readBinaryFile(dependenciesOut[depIdx].path);
+		const char* itr = reinterpret_cast<const char*>(source.data());
+		const char* end = itr + source.size();
+
+		while (itr < end) {
+			const char* lineEnd = itr;
+			while (lineEnd < end && *lineEnd != '\n') lineEnd++;
+
+			const char* name = nullptr;
+			uint32_t nameLen = 0;
+			if (parseInclude(itr, lineEnd, name, nameLen)) {
+				fs::path includeName(std::string(name, nameLen));
+				fs::path resolved = includingPath.parent_path() / includeName;
+				for (uint32_t i = 0; !fileExists(resolved) && i < directories.size(); i++) {
+					resolved = directories[i] / includeName;
+				}
+				if (fileExists(resolved)) {
+					addDependency(resolved.lexically_normal().generic_string());
+				}
+			}
+			itr = lineEnd + 1;
+		}
+	}
+}
+
+ZgResult ShaderHotReload::addEntry(Entry* entry) noexcept
+{
+	Dependencies dependencies;
+	findDependencies(*entry, dependencies);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (!mEntries.add(entry)) {
+		ZG_ERROR("Shader hot-reload: Out of memory, can't watch pipeline");
+		this->releaseEntryUnmutexed(entry);
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+	this->watchDependenciesUnmutexed(*entry, dependencies);
+	return ZG_SUCCESS;
+}
+
+void ShaderHotReload::watchDependenciesUnmutexed(
+	Entry& entry, const Dependencies& dependencies) noexcept
+{
+	entry.fileIndices.clear();
+	for (uint32_t i = 0; i < dependencies.size(); i++) {
+		uint32_t fileIdx = mWatcher.addFile(dependencies[i].path);
+		if (fileIdx != ~0u) entry.fileIndices.add(fileIdx);
+	}
+}
+
+void ShaderHotReload::releaseEntryUnmutexed(Entry* entry) noexcept
+{
+	if (entry->reloaded != nullptr) getBackend()->pipelineRenderRelease(entry->reloaded);
+	zgDelete(entry);
+}
+
+void ShaderHotReload::reloadThread() noexcept
+{
+	SmallVector<uint32_t, 16> modifiedFiles;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (true) {
+		mCondVar.wait_for(
+			lock, std::chrono::milliseconds(mPollIntervalMs), [this]() { return mExitRequested; });
+		if (mExitRequested) break;
+
+		// Mark the pipelines depending on any modified file as dirty
+		modifiedFiles.clear();
+		mWatcher.poll(modifiedFiles);
+		for (uint32_t i = 0; i < modifiedFiles.size(); i++) {
+			ZG_INFO("Shader hot-reload: \"%s\" was modified", mWatcher.path(modifiedFiles[i]));
+		}
+		for (uint32_t i = 0; i < mEntries.size(); i++) {
+			Entry& entry = *mEntries[i];
+			for (uint32_t j = 0; j < entry.fileIndices.size() && !entry.dirty; j++) {
+				for (uint32_t k = 0; k < modifiedFiles.size(); k++) {
+					if (entry.fileIndices[j] == modifiedFiles[k]) entry.dirty = true;
+				}
+			}
+		}
+
+		// Recompile dirty pipelines one at a time, without holding the lock while compiling
+		while (!mExitRequested) {
+			Entry* entry = nullptr;
+			for (uint32_t i = 0; i < mEntries.size(); i++) {
+				if (mEntries[i]->dirty) {
+					entry = mEntries[i];
+					break;
+				}
+			}
+			if (entry == nullptr) break;
+			entry->dirty = false;
+			entry->compiling = true;
+			lock.unlock();
+
+			// The create info is never modified after registration, safe to read unlocked
+			ZgBackend* backend = getBackend();
+			ZgPipelineRender* pipeline = nullptr;
+			ZgPipelineRenderSignature signature = {};
+			ZgResult res = entry->isHLSL ?
+				backend->pipelineRenderCreateFromFileHLSL(
+					&pipeline, &signature, entry->createInfoHLSL) :
+				backend->pipelineRenderCreateFromFileSPIRV(
+					&pipeline, &signature, entry->createInfoSPIRV);
+			Dependencies dependencies;
+			findDependencies(*entry, dependencies);
+
+			lock.lock();
+			entry->compiling = false;
+
+			// The pipeline was released while we were compiling
+			if (entry->released) {
+				if (pipeline != nullptr) backend->pipelineRenderRelease(pipeline);
+				zgDelete(entry);
+				continue;
+			}
+
+			// Watch the files it was compiled from this time, the includes might have changed.
+			// Done even on failure, the error might be fixed in a new include.
+			this->watchDependenciesUnmutexed(*entry, dependencies);
+
+			const char* vertexPath = entry->isHLSL ?
+				entry->createInfoHLSL.vertexShaderPath : entry->createInfoSPIRV.vertexShaderPath;
+			if (res != ZG_SUCCESS) {
+				ZG_ERROR("Shader hot-reload: Could not recompile pipeline (\"%s\"), keeping the"
+					" previous version", vertexPath);
+				mStats.numFailures += 1;
+				continue;
+			}
+
+			// The code using the pipeline was written for the old signature, so a pipeline with a
+			// different signature can't be swapped in. Signatures have no padding and backends
+			// zero-initialize them, so they can be compared bytewise.
+			if (std::memcmp(&signature, &entry->signature, sizeof(signature)) != 0) {
+				ZG_ERROR("Shader hot-reload: The signature of pipeline (\"%s\") changed, restart"
+					" required to reload it", vertexPath);
+				backend->pipelineRenderRelease(pipeline);
+				mStats.numFailures += 1;
+				continue;
+			}
+
+			// Replace any previous recompilation that has not been swapped in yet
+			if (entry->reloaded != nullptr) backend->pipelineRenderRelease(entry->reloaded);
+			entry->reloaded = pipeline;
+		}
+	}
+}
+
+} // namespace zg
@@ -0,0 +1,152 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "ZeroG.h"
+#include "ZeroG/util/FileWatcher.hpp"
+#include "ZeroG/util/SmallVector.hpp"
+#include "ZeroG/util/Vector.hpp"
+
+namespace zg {
+
+// Shader hot-reload types
+// ------------------------------------------------------------------------------------------------
+
+struct ShaderHotReloadStats final {
+	uint64_t numReloads = 0;
+	uint64_t numFailures = 0;
+};
+
+// ShaderHotReload
+// ------------------------------------------------------------------------------------------------
+
+// Recompiles pipelines created from files when their source files change, see
+// ZgShaderHotReloadSettings. Backend agnostic, pipelines are recompiled through the backend's
+// ordinary (thread-safe) pipeline creation functions and swapped in by the backend.
+//
+// A background thread polls a FileWatcher and recompiles the pipelines depending on any modified
+// file, one at a time. The dependencies of a pipeline are found by scanning its shaders for
+// #include directives each time it is compiled, so that new includes are picked up. All methods
+// are thread-safe.
+class ShaderHotReload final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	ShaderHotReload() noexcept = default;
+	ShaderHotReload(const ShaderHotReload&) = delete;
+	ShaderHotReload& operator= (const ShaderHotReload&) = delete;
+	ShaderHotReload(ShaderHotReload&&) = delete;
+	ShaderHotReload& operator= (ShaderHotReload&&) = delete;
+	~ShaderHotReload() noexcept { this->destroy(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	// Starts the background thread if hot-reload is enabled, otherwise does nothing
+	ZgResult create(const ZgShaderHotReloadSettings& settings) noexcept;
+	void destroy() noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	// Starts watching the files of a newly created pipeline. The create info is copied. Does
+	// nothing (and returns ZG_SUCCESS) if hot-reload is disabled.
+	ZgResult registerPipeline(
+		ZgPipelineRender* pipeline,
+		const ZgPipelineRenderSignature& signature,
+		const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept;
+	ZgResult registerPipeline(
+		ZgPipelineRender* pipeline,
+		const ZgPipelineRenderSignature& signature,
+		const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept;
+
+	// Stops watching a pipeline, must be called before it is released
+	void unregisterPipeline(ZgPipelineRender* pipeline) noexcept;
+
+	// Swaps in every pipeline that has been recompiled since the last call. If command lists are
+	// being recorded the backend postpones the swap, it is then retried on the next call.
+	void applyReloaded() noexcept;
+
+	// Getters
+	// --------------------------------------------------------------------------------------------
+
+	bool enabled() const noexcept { return mEnabled; }
+	ShaderHotReloadStats stats() noexcept;
+
+private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	struct Entry final {
+		ZgPipelineRender* pipeline = nullptr;
+		ZgPipelineRenderSignature signature = {};
+
+		// The create info used to recompile the pipeline, strings are copied into strings
+		bool isHLSL = false;
+		ZgPipelineRenderCreateInfoFileHLSL createInfoHLSL = {};
+		ZgPipelineRenderCreateInfoFileSPIRV createInfoSPIRV = {};
+		Vector<char> strings;
+
+		// Indices (in mWatcher) of the files the pipeline was last compiled from
+		SmallVector<uint32_t, 8> fileIndices;
+
+		bool dirty = false;
+		bool compiling = false;
+		bool released = false; // Unregistered while compiling, deleted by the reload thread
+		ZgPipelineRender* reloaded = nullptr; // Recompiled pipeline waiting to be swapped in
+	};
+
+	struct Dependency final {
+		char path[FILE_WATCHER_MAX_PATH_LENGTH] = {};
+	};
+
+	using Dependencies = SmallVector<Dependency, 8>;
+
+	// Private methods
+	// --------------------------------------------------------------------------------------------
+
+	static void findDependencies(const Entry& entry, Dependencies& dependenciesOut) noexcept;
+	ZgResult addEntry(Entry* entry) noexcept;
+	void watchDependenciesUnmutexed(Entry& entry, const Dependencies& dependencies) noexcept;
+	void releaseEntryUnmutexed(Entry* entry) noexcept;
+	void reloadThread() noexcept;
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	bool mEnabled = false;
+	uint32_t mPollIntervalMs = 0;
+	std::thread mThread;
+
+	// State shared with the reload thread, protected by mMutex
+	std::mutex mMutex;
+	std::condition_variable mCondVar;
+	bool mExitRequested = false;
+	FileWatcher mWatcher;
+	SmallVector<Entry*, 0> mEntries;
+	ShaderHotReloadStats mStats;
+};
+
+} // namespace zg
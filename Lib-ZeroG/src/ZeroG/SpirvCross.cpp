@@ -0,0 +1,866 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/SpirvCross.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ZeroG/util/ScopedArena.hpp"
+#include "ZeroG/util/Strings.hpp"
+
+namespace zg {
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+enum class ShaderStage {
+	VERTEX,
+	PIXEL
+};
+
+static const char* stageToString(ShaderStage stage) noexcept
+{
+	return stage == ShaderStage::VERTEX ? "Vertex" : "Pixel";
+}
+
+struct ConstBufferMeta final {
+	ZgConstantBufferDesc desc = {};
+	bool vertexAccess = false;
+	bool pixelAccess = false;
+};
+
+struct TextureMeta final {
+	ZgTextureDesc desc = {};
+	bool vertexAccess = false;
+	bool pixelAccess = false;
+};
+
+// Everything found so far when reflecting the shaders of a pipeline one stage at a time
+struct ReflectionState final {
+	ZgVertexAttribute vertexInputs[ZG_MAX_NUM_VERTEX_ATTRIBUTES] = {};
+	uint32_t numVertexInputs = 0;
+
+	ConstBufferMeta constBuffers[ZG_MAX_NUM_CONSTANT_BUFFERS];
+	uint32_t numConstBuffers = 0;
+
+	TextureMeta textures[ZG_MAX_NUM_TEXTURES];
+	uint32_t numTextures = 0;
+
+	uint32_t samplerRegisterMask = 0;
+
+	uint32_t pushConstantSizeBytes = 0;
+	bool pushConstantVertexAccess = false;
+	bool pushConstantPixelAccess = false;
+
+	uint32_t numRenderTargets = 0;
+
+	bool bindlessTextures = false;
+	bool bindlessBuffers = false;
+};
+
+static uint32_t roundUpTo16(uint32_t value) noexcept
+{
+	return (value + 15) & ~15u;
+}
+
+static ZgVertexAttributeType spirvTypeToAttribute(spvc_type type) noexcept
+{
+	if (spvc_type_get_columns(type) != 1) return ZG_VERTEX_ATTRIBUTE_UNDEFINED;
+	if (spvc_type_get_num_array_dimensions(type) != 0) return ZG_VERTEX_ATTRIBUTE_UNDEFINED;
+
+	uint32_t vectorSize = spvc_type_get_vector_size(type);
+	if (vectorSize < 1 || vectorSize > 4) return ZG_VERTEX_ATTRIBUTE_UNDEFINED;
+
+	switch (spvc_type_get_basetype(type)) {
+	case SPVC_BASETYPE_FP32: return ZG_VERTEX_ATTRIBUTE_F32 + (vectorSize - 1);
+	case SPVC_BASETYPE_INT32: return ZG_VERTEX_ATTRIBUTE_S32 + (vectorSize - 1);
+	case SPVC_BASETYPE_UINT32: return ZG_VERTEX_ATTRIBUTE_U32 + (vectorSize - 1);
+	default: break;
+	}
+	return ZG_VERTEX_ATTRIBUTE_UNDEFINED;
+}
+
+// Returns the binding of a resource, errors out if it is an array or not in descriptor set 0
+static ZgResult getResourceBinding(
+	uint32_t& bindingOut,
+	spvc_compiler compiler,
+	const spvc_reflected_resource& resource,
+	ShaderStage stage) noexcept
+{
+	// Error out if resource uses more than one register
+	// TODO: This should probably be relaxed
+	spvc_type type = spvc_compiler_get_type_handle(compiler, resource.type_id);
+	if (spvc_type_get_num_array_dimensions(type) != 0) {
+		ZG_ERROR("Multiple registers for a single resource not allowed");
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
+	// Error out if another descriptor set than 0 is used
+	uint32_t set = spvc_compiler_get_decoration(compiler, resource.id, SpvDecorationDescriptorSet);
+	if (set != 0) {
+		ZG_ERROR("%s shader resource %s uses descriptor set %u, only 0 is allowed",
+			stageToString(stage), resource.name, set);
+		return ZG_ERROR_SHADER_COMPILE_ERROR;
+	}
+
+	bindingOut = spvc_compiler_get_decoration(compiler, resource.id, SpvDecorationBinding);
+	return ZG_SUCCESS;
+}
+
+// Checks if a resource is in the descriptor set of a bindless table, in which case it must be an
+// unbounded array at binding 0
+static ZgResult checkBindlessTable(
+	bool& bindlessOut,
+	spvc_compiler compiler,
+	const spvc_reflected_resource& resource,
+	uint32_t bindlessSet,
+	ShaderStage stage) noexcept
+{
+	bindlessOut = false;
+	uint32_t set = spvc_compiler_get_decoration(compiler, resource.id, SpvDecorationDescriptorSet);
+	if (set != bindlessSet) return ZG_SUCCESS;
+
+	uint32_t binding = spvc_compiler_get_decoration(compiler, resource.id, SpvDecorationBinding);
+	spvc_type type = spvc_compiler_get_type_handle(compiler, resource.type_id);
+	bool runtimeArray = spvc_type_get_num_array_dimensions(type) == 1 &&
+		spvc_type_get_array_dimension(type, 0) == 0;
+	if (!runtimeArray || binding != 0) {
+		ZG_ERROR("%s shader resource %s (set = %u, binding = %u) is not a valid bindless table, "
+			"it must be an unbounded array at binding 0",
+			stageToString(stage), resource.name, set, binding);
+		return ZG_ERROR_SHADER_COMPILE_ERROR;
+	}
+
+	bindlessOut = true;
+	return ZG_SUCCESS;
+}
+
+static ZgResult addConstBuffer(
+	ReflectionState& state,
+	uint32_t shaderRegister,
+	uint32_t sizeInBytes,
+	ShaderStage stage) noexcept
+{
+	// See if buffer was already found/used by the other shader stage
+	ConstBufferMeta* cbuffer = nullptr;
+	for (uint32_t i = 0; i < state.numConstBuffers; i++) {
+		if (state.constBuffers[i].desc.shaderRegister == shaderRegister) {
+			cbuffer = &state.constBuffers[i];
+			break;
+		}
+	}
+
+	if (cbuffer == nullptr) {
+
+		// Error out if we have too many constant buffers
+		if (state.numConstBuffers >= ZG_MAX_NUM_CONSTANT_BUFFERS) {
+			ZG_ERROR("Too many constant buffers, only %u allowed", ZG_MAX_NUM_CONSTANT_BUFFERS);
+			return ZG_ERROR_SHADER_COMPILE_ERROR;
+		}
+
+		cbuffer = &state.constBuffers[state.numConstBuffers];
+		state.numConstBuffers += 1;
+		cbuffer->desc.shaderRegister = shaderRegister;
+	}
+
+	cbuffer->desc.sizeInBytes = std::max(cbuffer->desc.sizeInBytes, sizeInBytes);
+	if (stage == ShaderStage::VERTEX) cbuffer->vertexAccess = true;
+	else cbuffer->pixelAccess = true;
+	return ZG_SUCCESS;
+}
+
+static ZgResult addTexture(
+	ReflectionState& state,
+	uint32_t textureRegister,
+	ShaderStage stage) noexcept
+{
+	// See if texture was already found/used by the other shader stage
+	TextureMeta* texture = nullptr;
+	for (uint32_t i = 0; i < state.numTextures; i++) {
+		if (state.textures[i].desc.textureRegister == textureRegister) {
+			texture = &state.textures[i];
+			break;
+		}
+	}
+
+	if (texture == nullptr) {
+
+		// Error out if we have too many textures
+		if (state.numTextures >= ZG_MAX_NUM_TEXTURES) {
+			ZG_ERROR("Too many textures, only %u allowed", ZG_MAX_NUM_TEXTURES);
+			return ZG_ERROR_SHADER_COMPILE_ERROR;
+		}
+
+		texture = &state.textures[state.numTextures];
+		state.numTextures += 1;
+		texture->desc.textureRegister = textureRegister;
+	}
+
+	if (stage == ShaderStage::VERTEX) texture->vertexAccess = true;
+	else texture->pixelAccess = true;
+	return ZG_SUCCESS;
+}
+
+static ZgResult addSampler(
+	ReflectionState& state,
+	uint32_t samplerRegister,
+	const char* name) noexcept
+{
+	// Error out if sampler has invalid register
+	if (samplerRegister >= ZG_MAX_NUM_SAMPLERS) {
+		ZG_ERROR("Sampler %s is bound to register %u, only %u samplers allowed",
+			name, samplerRegister, ZG_MAX_NUM_SAMPLERS);
+		return ZG_ERROR_SHADER_COMPILE_ERROR;
+	}
+
+	// Mark sampler as found
+	state.samplerRegisterMask |= (1u << samplerRegister);
+	return ZG_SUCCESS;
+}
+
+static ZgResult reflectStage(
+	ReflectionState& state,
+	spvc_context context,
+	const uint8_t* spirv,
+	uint32_t spirvSizeBytes,
+	ShaderStage stage) noexcept
+{
+	if (spirv == nullptr || spirvSizeBytes == 0 || (spirvSizeBytes % 4) != 0) {
+		ZG_ERROR("%s shader is not valid SPIR-V", stageToString(stage));
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Parse SPIR-V
+	spvc_parsed_ir parsedIr = nullptr;
+	if (CHECK_SPIRV_CROSS(context) spvc_context_parse_spirv(context,
+		reinterpret_cast<const SpvId*>(spirv), spirvSizeBytes / 4, &parsedIr) != SPVC_SUCCESS) {
+		return ZG_ERROR_SHADER_COMPILE_ERROR;
+	}
+
+	// Create a compiler without any backend, it is only used for reflection
+	spvc_compiler compiler = nullptr;
+	if (CHECK_SPIRV_CROSS(context) spvc_context_create_compiler(context, SPVC_BACKEND_NONE,
+		parsedIr, SPVC_CAPTURE_MODE_TAKE_OWNERSHIP, &compiler) != SPVC_SUCCESS) {
+		return ZG_ERROR_SHADER_COMPILE_ERROR;
+	}
+
+	// Find the entry point for the stage
+	SpvExecutionModel executionModel =
+		stage == ShaderStage::VERTEX ? SpvExecutionModelVertex : SpvExecutionModelFragment;
+	const spvc_entry_point* entryPoints = nullptr;
+	size_t numEntryPoints = 0;
+	CHECK_SPIRV_CROSS(context) spvc_compiler_get_entry_points(
+		compiler, &entryPoints, &numEntryPoints);
+	const char* entryName = nullptr;
+	for (size_t i = 0; i < numEntryPoints; i++) {
+		if (entryPoints[i].execution_model == executionModel) {
+			entryName = entryPoints[i].name;
+			break;
+		}
+	}
+	if (entryName == nullptr) {
+		ZG_ERROR("%s shader has no %s entry point", stageToString(stage),
+			stage == ShaderStage::VERTEX ? "vertex" : "fragment");
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+	CHECK_SPIRV_CROSS(context) spvc_compiler_set_entry_point(compiler, entryName, executionModel);
+
+	// Only reflect resources the entry point actually uses, same as DXIL reflection
+	spvc_set activeVariables = nullptr;
+	spvc_resources resources = nullptr;
+	if (CHECK_SPIRV_CROSS(context) spvc_compiler_get_active_interface_variables(
+		compiler, &activeVariables) != SPVC_SUCCESS) {
+		return ZG_ERROR_SHADER_COMPILE_ERROR;
+	}
+	if (CHECK_SPIRV_CROSS(context) spvc_compiler_create_shader_resources_for_active_variables(
+		compiler, &resources, activeVariables) != SPVC_SUCCESS) {
+		return ZG_ERROR_SHADER_COMPILE_ERROR;
+	}
+
+	auto getResources = [&](spvc_resource_type type, size_t& numOut) {
+		const spvc_reflected_resource* list = nullptr;
+		numOut = 0;
+		CHECK_SPIRV_CROSS(context) spvc_resources_get_resource_list_for_type(
+			resources, type, &list, &numOut);
+		return list;
+	};
+
+	// Vertex inputs
+	if (stage == ShaderStage::VERTEX) {
+		size_t numInputs = 0;
+		const spvc_reflected_resource* inputs =
+			getResources(SPVC_RESOURCE_TYPE_STAGE_INPUT, numInputs);
+		if (numInputs > ZG_MAX_NUM_VERTEX_ATTRIBUTES) {
+			ZG_ERROR("Too many vertex attributes, only %u allowed", ZG_MAX_NUM_VERTEX_ATTRIBUTES);
+			return ZG_ERROR_SHADER_COMPILE_ERROR;
+		}
+		for (size_t i = 0; i < numInputs; i++) {
+			ZgVertexAttribute& attrib = state.vertexInputs[state.numVertexInputs];
+			state.numVertexInputs += 1;
+			attrib.location =
+				spvc_compiler_get_decoration(compiler, inputs[i].id, SpvDecorationLocation);
+			attrib.type =
+				spirvTypeToAttribute(spvc_compiler_get_type_handle(compiler, inputs[i].type_id));
+			if (attrib.type == ZG_VERTEX_ATTRIBUTE_UNDEFINED) {
+				ZG_ERROR("Vertex attribute %s (location = %u) has an unsupported type",
+					inputs[i].name, attrib.location);
+				return ZG_ERROR_SHADER_COMPILE_ERROR;
+			}
+		}
+	}
+
+	// Render targets
+	else {
+		size_t numOutputs = 0;
+		getResources(SPVC_RESOURCE_TYPE_STAGE_OUTPUT, numOutputs);
+		state.numRenderTargets = uint32_t(numOutputs);
+	}
+
+	// Uniform buffers
+	size_t numUniformBuffers = 0;
+	const spvc_reflected_resource* uniformBuffers =
+		getResources(SPVC_RESOURCE_TYPE_UNIFORM_BUFFER, numUniformBuffers);
+	for (size_t i = 0; i < numUniformBuffers; i++) {
+		uint32_t binding = 0;
+		ZgResult res = getResourceBinding(binding, compiler, uniformBuffers[i], stage);
+		if (res != ZG_SUCCESS) return res;
+
+		size_t sizeBytes = 0;
+		spvc_type type = spvc_compiler_get_type_handle(compiler, uniformBuffers[i].base_type_id);
+		CHECK_SPIRV_CROSS(context) spvc_compiler_get_declared_struct_size(
+			compiler, type, &sizeBytes);
+
+		res = addConstBuffer(state, binding, roundUpTo16(uint32_t(sizeBytes)), stage);
+		if (res != ZG_SUCCESS) return res;
+	}
+
+	// Push constants, added once the register is known
+	size_t numPushConstants = 0;
+	const spvc_reflected_resource* pushConstants =
+		getResources(SPVC_RESOURCE_TYPE_PUSH_CONSTANT, numPushConstants);
+	for (size_t i = 0; i < numPushConstants; i++) {
+		size_t sizeBytes = 0;
+		spvc_type type = spvc_compiler_get_type_handle(compiler, pushConstants[i].base_type_id);
+		CHECK_SPIRV_CROSS(context) spvc_compiler_get_declared_struct_size(
+			compiler, type, &sizeBytes);
+		state.pushConstantSizeBytes =
+			std::max(state.pushConstantSizeBytes, roundUpTo16(uint32_t(sizeBytes)));
+		if (stage == ShaderStage::VERTEX) state.pushConstantVertexAccess = true;
+		else state.pushConstantPixelAccess = true;
+	}
+
+	// Combined image samplers, occupy both a texture and a sampler register
+	size_t numSampledImages = 0;
+	const spvc_reflected_resource* sampledImages =
+		getResources(SPVC_RESOURCE_TYPE_SAMPLED_IMAGE, numSampledImages);
+	for (size_t i = 0; i < numSampledImages; i++) {
+		uint32_t binding = 0;
+		ZgResult res = getResourceBinding(binding, compiler, sampledImages[i], stage);
+		if (res != ZG_SUCCESS) return res;
+		res = addTexture(state, binding, stage);
+		if (res != ZG_SUCCESS) return res;
+		res = addSampler(state, binding, sampledImages[i].name);
+		if (res != ZG_SUCCESS) return res;
+	}
+
+	// Separate images
+	size_t numImages = 0;
+	const spvc_reflected_resource* images =
+		getResources(SPVC_RESOURCE_TYPE_SEPARATE_IMAGE, numImages);
+	for (size_t i = 0; i < numImages; i++) {
+		bool bindless = false;
+		ZgResult res = checkBindlessTable(
+			bindless, compiler, images[i], ZG_BINDLESS_TEXTURES_REGISTER_SPACE, stage);
+		if (res != ZG_SUCCESS) return res;
+		if (bindless) {
+			state.bindlessTextures = true;
+			continue;
+		}
+
+		uint32_t binding = 0;
+		res = getResourceBinding(binding, compiler, images[i], stage);
+		if (res != ZG_SUCCESS) return res;
+		res = addTexture(state, binding, stage);
+		if (res != ZG_SUCCESS) return res;
+	}
+
+	// Separate samplers
+	size_t numSamplers = 0;
+	const spvc_reflected_resource* samplers =
+		getResources(SPVC_RESOURCE_TYPE_SEPARATE_SAMPLERS, numSamplers);
+	for (size_t i = 0; i < numSamplers; i++) {
+		uint32_t binding = 0;
+		ZgResult res = getResourceBinding(binding, compiler, samplers[i], stage);
+		if (res != ZG_SUCCESS) return res;
+		res = addSampler(state, binding, samplers[i].name);
+		if (res != ZG_SUCCESS) return res;
+	}
+
+	// Storage buffers, only read-only bindless buffers (become ByteAddressBuffers in HLSL)
+	size_t numStorageBuffers = 0;
+	const spvc_reflected_resource* storageBuffers =
+		getResources(SPVC_RESOURCE_TYPE_STORAGE_BUFFER, numStorageBuffers);
+	for (size_t i = 0; i < numStorageBuffers; i++) {
+		bool bindless = false;
+		ZgResult res = checkBindlessTable(
+			bindless, compiler, storageBuffers[i], ZG_BINDLESS_BUFFERS_REGISTER_SPACE, stage);
+		if (res != ZG_SUCCESS) return res;
+		const spvc_reflected_resource& buffer = storageBuffers[i];
+		bool readOnly =
+			spvc_compiler_has_decoration(compiler, buffer.id, SpvDecorationNonWritable) ||
+			spvc_compiler_has_member_decoration(
+				compiler, buffer.base_type_id, 0, SpvDecorationNonWritable);
+		if (!bindless || !readOnly) {
+			ZG_ERROR("%s shader storage buffer %s is not supported, storage buffers are only "
+				"supported as read-only bindless buffers (set = %u)",
+				stageToString(stage), buffer.name, ZG_BINDLESS_BUFFERS_REGISTER_SPACE);
+			return ZG_ERROR_SHADER_COMPILE_ERROR;
+		}
+		state.bindlessBuffers = true;
+	}
+
+	return ZG_SUCCESS;
+}
+
+static ZgResult buildReflection(
+	SpirvPipelineReflection& reflectionOut,
+	ReflectionState& state) noexcept
+{
+	ZgPipelineRenderSignature& signature = reflectionOut.reflection.signature;
+
+	// Sort vertex attributes by location, SPIR-V does not define an order
+	std::sort(state.vertexInputs, state.vertexInputs + state.numVertexInputs,
+		[](const ZgVertexAttribute& lhs, const ZgVertexAttribute& rhs) {
+		return lhs.location < rhs.location;
+	});
+	signature.numVertexAttributes = state.numVertexInputs;
+	for (uint32_t i = 0; i < state.numVertexInputs; i++) {
+		signature.vertexAttributes[i] = state.vertexInputs[i];
+	}
+
+	// Assign the push constant block the lowest register not used by any uniform buffer
+	uint32_t& pushConstantRegister = reflectionOut.pushConstantRegister;
+	pushConstantRegister = ~0u;
+	if (state.pushConstantVertexAccess || state.pushConstantPixelAccess) {
+		for (uint32_t reg = 0; pushConstantRegister == ~0u; reg++) {
+			bool used = false;
+			for (uint32_t i = 0; i < state.numConstBuffers; i++) {
+				used = used || state.constBuffers[i].desc.shaderRegister == reg;
+			}
+			if (!used) pushConstantRegister = reg;
+		}
+
+		if (state.pushConstantVertexAccess) {
+			ZgResult res = addConstBuffer(state, pushConstantRegister,
+				state.pushConstantSizeBytes, ShaderStage::VERTEX);
+			if (res != ZG_SUCCESS) return res;
+		}
+		if (state.pushConstantPixelAccess) {
+			ZgResult res = addConstBuffer(state, pushConstantRegister,
+				state.pushConstantSizeBytes, ShaderStage::PIXEL);
+			if (res != ZG_SUCCESS) return res;
+		}
+	}
+
+	// Sort buffers by register and copy them to signature
+	std::sort(state.constBuffers, state.constBuffers + state.numConstBuffers,
+		[](const ConstBufferMeta& lhs, const ConstBufferMeta& rhs) {
+		return lhs.desc.shaderRegister < rhs.desc.shaderRegister;
+	});
+	signature.numConstantBuffers = state.numConstBuffers;
+	for (uint32_t i = 0; i < state.numConstBuffers; i++) {
+		signature.constantBuffers[i] = state.constBuffers[i].desc;
+		if (signature.constantBuffers[i].shaderRegister == pushConstantRegister) {
+			signature.constantBuffers[i].pushConstant = ZG_TRUE;
+		}
+		reflectionOut.reflection.constBufferVertexAccess[i] = state.constBuffers[i].vertexAccess;
+		reflectionOut.reflection.constBufferPixelAccess[i] = state.constBuffers[i].pixelAccess;
+	}
+
+	// Sort texture descs by register and copy them to signature
+	std::sort(state.textures, state.textures + state.numTextures,
+		[](const TextureMeta& lhs, const TextureMeta& rhs) {
+		return lhs.desc.textureRegister < rhs.desc.textureRegister;
+	});
+	signature.numTextures = state.numTextures;
+	for (uint32_t i = 0; i < state.numTextures; i++) {
+		signature.textures[i] = state.textures[i].desc;
+	}
+
+	reflectionOut.samplerRegisterMask = state.samplerRegisterMask;
+	signature.numRenderTargets = state.numRenderTargets;
+	signature.bindlessTextures = state.bindlessTextures ? ZG_TRUE : ZG_FALSE;
+	signature.bindlessBuffers = state.bindlessBuffers ? ZG_TRUE : ZG_FALSE;
+
+	return ZG_SUCCESS;
+}
+
+static Vector<char> copySource(const char* prefix, const char* source, const char* name) noexcept
+{
+	uint32_t prefixLen = uint32_t(std::strlen(prefix));
+	uint32_t srcLen = uint32_t(std::strlen(source));
+	Vector<char> sourceTmp;
+	sourceTmp.create(prefixLen + srcLen + 1, name);
+	sourceTmp.addMany(prefixLen + srcLen);
+	std::memcpy(sourceTmp.data(), prefix, prefixLen);
+	std::memcpy(sourceTmp.data() + prefixLen, source, srcLen);
+	sourceTmp[prefixLen + srcLen] = '\0';
+	return sourceTmp;
+}
+
+// HLSL has no specialization constants, SPIRV-Cross instead declares each one with a
+// "#ifndef SPIRV_CROSS_CONSTANT_ID_<id>" macro defaulting to the value in the SPIR-V. Writes the
+// #define lines overriding the defaults of the constants that exist in the shader.
+static bool specializationConstantDefines(
+	char* definesOut,
+	uint32_t definesOutSize,
+	spvc_compiler compiler,
+	const ZgSpecializationConstant* constants,
+	uint32_t numConstants) noexcept
+{
+	definesOut[0] = '\0';
+	if (numConstants == 0) return true;
+
+	const spvc_specialization_constant* shaderConstants = nullptr;
+	size_t numShaderConstants = 0;
+	if (spvc_compiler_get_specialization_constants(
+		compiler, &shaderConstants, &numShaderConstants) != SPVC_SUCCESS) {
+		return false;
+	}
+
+	char* tmpStr = definesOut;
+	uint32_t bytesLeft = definesOutSize;
+	for (size_t i = 0; i < numShaderConstants; i++) {
+
+		// Constants not overridden keep their default, as do constants only in the other shader
+		const ZgSpecializationConstant* constant = nullptr;
+		for (uint32_t j = 0; j < numConstants; j++) {
+			if (constants[j].constantId == shaderConstants[i].constant_id) {
+				constant = &constants[j];
+				break;
+			}
+		}
+		if (constant == nullptr) continue;
+
+		spvc_constant handle = spvc_compiler_get_constant_handle(compiler, shaderConstants[i].id);
+		spvc_type type =
+			spvc_compiler_get_type_handle(compiler, spvc_constant_get_type(handle));
+		const char* name = "#define SPIRV_CROSS_CONSTANT_ID_";
+		switch (spvc_type_get_basetype(type)) {
+		case SPVC_BASETYPE_BOOLEAN:
+			printfAppend(tmpStr, bytesLeft, "%s%u %s\n",
+				name, constant->constantId, constant->value != 0 ? "true" : "false");
+			break;
+		case SPVC_BASETYPE_INT32:
+			printfAppend(tmpStr, bytesLeft, "%s%u int(%i)\n",
+				name, constant->constantId, int32_t(constant->value));
+			break;
+		case SPVC_BASETYPE_UINT32:
+			printfAppend(tmpStr, bytesLeft, "%s%u %uu\n",
+				name, constant->constantId, constant->value);
+			break;
+		case SPVC_BASETYPE_FP32:
+			printfAppend(tmpStr, bytesLeft, "%s%u asfloat(%uu)\n",
+				name, constant->constantId, constant->value);
+			break;
+		default:
+			ZG_ERROR("Specialization constant %u is not a 32-bit scalar, can't be overridden",
+				constant->constantId);
+			return false;
+		}
+	}
+	return true;
+}
+
+// SPIR-V reflection
+// ------------------------------------------------------------------------------------------------
+
+ZgResult reflectSpirvPipelineRender(
+	SpirvPipelineReflection& reflectionOut,
+	const uint8_t* vertexSpirv,
+	uint32_t vertexSpirvSizeBytes,
+	const uint8_t* pixelSpirv,
+	uint32_t pixelSpirvSizeBytes) noexcept
+{
+	reflectionOut = {};
+	ReflectionState state;
+
+	// On Windows all operator new calls made by SPIRV-Cross are served by a scoped arena, nothing
+	// allocated by it is kept once the reflected data has been copied into the state.
+	ScopedArena arena;
+
+	// Initialize SPIRV-Cross
+	spvc_context context = nullptr;
+	if (CHECK_SPIRV_CROSS(nullptr) spvc_context_create(&context) != SPVC_SUCCESS) {
+		return ZG_ERROR_GENERIC;
+	}
+
+	ZgResult res = reflectStage(state, context,
+		vertexSpirv, vertexSpirvSizeBytes, ShaderStage::VERTEX);
+	if (res == ZG_SUCCESS) {
+		res = reflectStage(state, context,
+			pixelSpirv, pixelSpirvSizeBytes, ShaderStage::PIXEL);
+	}
+
+	// Deinitialize SPIRV-Cross
+	spvc_context_destroy(context);
+	if (res != ZG_SUCCESS) return res;
+
+	return buildReflection(reflectionOut, state);
+}
+
+ZgResult validateSpirvPipelineRender(
+	PipelineRenderReflection& reflectionOut,
+	const SpirvPipelineReflection& spirvReflection,
+	const ZgPipelineRenderCreateInfoCommon& createInfo) noexcept
+{
+	reflectionOut = spirvReflection.reflection;
+	ZgPipelineRenderSignature& signature = reflectionOut.signature;
+	const ZgPipelineRenderSignature& reflected = spirvReflection.reflection.signature;
+
+	// Validate that the user has specified correct number of vertex attributes
+	if (createInfo.numVertexAttributes != reflected.numVertexAttributes) {
+		ZG_ERROR("Invalid ZgPipelineRenderingCreateInfo. It specifies %u vertex"
+			" attributes, shader reflection finds %u",
+			createInfo.numVertexAttributes, reflected.numVertexAttributes);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Validate vertex attributes, SPIR-V does not define an order so match them by location
+	for (uint32_t i = 0; i < createInfo.numVertexAttributes; i++) {
+
+		const ZgVertexAttribute& attrib = createInfo.vertexAttributes[i];
+
+		const ZgVertexAttribute* reflectedAttrib = nullptr;
+		for (uint32_t j = 0; j < reflected.numVertexAttributes; j++) {
+			if (reflected.vertexAttributes[j].location == attrib.location) {
+				reflectedAttrib = &reflected.vertexAttributes[j];
+				break;
+			}
+		}
+
+		if (reflectedAttrib == nullptr) {
+			ZG_ERROR("Invalid ZgPipelineRenderingCreateInfo. It specifies that the %u:th"
+				" vertex attribute has location %u, shader reflection finds no such location",
+				i,
+				attrib.location);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+
+		// Check that the reflected type is the same as the specified type
+		if (reflectedAttrib->type != attrib.type) {
+			ZG_ERROR("Invalid ZgPipelineRenderingCreateInfo. It specifies that the %u:th"
+				" vertex attribute is of type %s, shader reflection finds %s",
+				i,
+				vertexAttributeTypeToString(attrib.type),
+				vertexAttributeTypeToString(reflectedAttrib->type));
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+
+		// Set vertex attribute in signature
+		signature.vertexAttributes[i] = attrib;
+	}
+
+	// Go through buffers and check if any of them are marked as push constants
+	bool pushConstantRegisterUsed[ZG_MAX_NUM_CONSTANT_BUFFERS] = {};
+	for (uint32_t i = 0; i < signature.numConstantBuffers; i++) {
+		ZgConstantBufferDesc& cbuffer = signature.constantBuffers[i];
+		for (uint32_t j = 0; j < createInfo.numPushConstants; j++) {
+			if (cbuffer.shaderRegister == createInfo.pushConstantRegisters[j]) {
+				if (pushConstantRegisterUsed[j]) {
+					ZG_ASSERT(pushConstantRegisterUsed[j]);
+					return ZG_ERROR_INVALID_ARGUMENT;
+				}
+				cbuffer.pushConstant = ZG_TRUE;
+				pushConstantRegisterUsed[j] = true;
+				break;
+			}
+		}
+	}
+
+	// Check that all push constant registers specified was actually used
+	for (uint32_t i = 0; i < createInfo.numPushConstants; i++) {
+		if (!pushConstantRegisterUsed[i]) {
+			ZG_ERROR(
+				"Shader register %u was registered as a push constant, but never used in the shader",
+				createInfo.pushConstantRegisters[i]);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+	}
+
+	// Mark the buffers bound as root constant buffers, they can't also be push constants
+	for (uint32_t i = 0; i < createInfo.numRootConstantBuffers; i++) {
+		uint32_t shaderRegister = createInfo.rootConstantBufferRegisters[i];
+		ZgConstantBufferDesc* cbuffer = nullptr;
+		for (uint32_t j = 0; j < signature.numConstantBuffers; j++) {
+			ZgConstantBufferDesc& candidate = signature.constantBuffers[j];
+			if (candidate.shaderRegister == shaderRegister) cbuffer = &candidate;
+		}
+		if (cbuffer == nullptr) {
+			ZG_ERROR("Shader register %u was registered as a root constant buffer, but never used "
+				"in the shader", shaderRegister);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+		if (cbuffer->pushConstant || cbuffer->rootConstantBuffer) {
+			ZG_ERROR("Shader register %u was registered as a root constant buffer more than once, "
+				"or also as a push constant", shaderRegister);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+		cbuffer->rootConstantBuffer = ZG_TRUE;
+	}
+
+	// Check that samplers are only bound to specified registers and that all of them are used
+	for (uint32_t i = 0; i < ZG_MAX_NUM_SAMPLERS; i++) {
+		bool used = (spirvReflection.samplerRegisterMask & (1u << i)) != 0;
+		if (used && i >= createInfo.numSamplers) {
+			ZG_ERROR("A sampler is bound to register %u, num specified samplers is %u",
+				i, createInfo.numSamplers);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+		if (!used && i < createInfo.numSamplers) {
+			ZG_ERROR(
+				"%u samplers were specified, however sampler %u is not used by the pipeline",
+				createInfo.numSamplers, i);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+	}
+
+	// Check that the correct number of render targets is specified
+	if (reflected.numRenderTargets != createInfo.numRenderTargets) {
+		ZG_ERROR("%u render targets were specified, however %u is used by the pipeline",
+			createInfo.numRenderTargets, reflected.numRenderTargets);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Copy render target info to signature
+	for (uint32_t i = 0; i < reflected.numRenderTargets; i++) {
+		signature.renderTargets[i] = createInfo.renderTargets[i];
+	}
+
+	return ZG_SUCCESS;
+}
+
+// SPIR-V cross-compilation
+// ------------------------------------------------------------------------------------------------
+
+Vector<char> crossCompileSpirvToHLSL(
+	spvc_context context,
+	const uint8_t* spirv,
+	uint32_t spirvSizeBytes,
+	uint32_t pushConstantRegister,
+	const ZgSpecializationConstant* specializationConstants,
+	uint32_t numSpecializationConstants) noexcept
+{
+	// Parse SPIR-V
+	spvc_parsed_ir parsedIr = nullptr;
+	if (CHECK_SPIRV_CROSS(context) spvc_context_parse_spirv(context,
+		reinterpret_cast<const SpvId*>(spirv), spirvSizeBytes / 4, &parsedIr) != SPVC_SUCCESS) {
+		return Vector<char>();
+	}
+
+	// Create compiler
+	spvc_compiler compiler = nullptr;
+	if (CHECK_SPIRV_CROSS(context) spvc_context_create_compiler(context, SPVC_BACKEND_HLSL,
+		parsedIr, SPVC_CAPTURE_MODE_TAKE_OWNERSHIP, &compiler) != SPVC_SUCCESS) {
+		return Vector<char>();
+	}
+
+	// SPIR-V push constant blocks have no binding, give them the register they were assigned
+	// when reflecting the SPIR-V. Otherwise DXC would pick one, which might not be the same.
+	if (pushConstantRegister != ~0u) {
+		spvc_resources resources = nullptr;
+		CHECK_SPIRV_CROSS(context) spvc_compiler_create_shader_resources(compiler, &resources);
+		const spvc_reflected_resource* pushConstants = nullptr;
+		size_t numPushConstants = 0;
+		CHECK_SPIRV_CROSS(context) spvc_resources_get_resource_list_for_type(
+			resources, SPVC_RESOURCE_TYPE_PUSH_CONSTANT, &pushConstants, &numPushConstants);
+		for (size_t i = 0; i < numPushConstants; i++) {
+			spvc_compiler_set_decoration(
+				compiler, pushConstants[i].id, SpvDecorationBinding, pushConstantRegister);
+		}
+	}
+
+	// Override the default values of specialization constants
+	char specializationDefines[ZG_MAX_NUM_SPECIALIZATION_CONSTANTS * 64] = {};
+	if (!specializationConstantDefines(specializationDefines, sizeof(specializationDefines),
+		compiler, specializationConstants, numSpecializationConstants)) {
+		return Vector<char>();
+	}
+
+	// Set some compiler options
+	spvc_compiler_options options = nullptr;
+	CHECK_SPIRV_CROSS(context) spvc_compiler_create_compiler_options(compiler, &options);
+
+	// Set which version of HLSL to target
+	// For now target shader model 6.0, which is the lowest ZeroG supports
+	// TODO: Expose this?
+	CHECK_SPIRV_CROSS(context) spvc_compiler_options_set_uint(
+		options, SPVC_COMPILER_OPTION_HLSL_SHADER_MODEL, 60);
+
+	// Apply compiler options
+	CHECK_SPIRV_CROSS(context) spvc_compiler_install_compiler_options(compiler, options);
+
+	// Compile to HLSL
+	const char* hlslSource = nullptr;
+	if (CHECK_SPIRV_CROSS(context) spvc_compiler_compile(
+		compiler, &hlslSource) != SPVC_SUCCESS) {
+		return Vector<char>();
+	}
+
+	// Allocate memory and copy HLSL source to Vector<char> and return it
+	return copySource(specializationDefines, hlslSource, "HLSL Source");
+}
+
+Vector<char> crossCompileSpirvToMSL(
+	spvc_context context,
+	const uint8_t* spirv,
+	uint32_t spirvSizeBytes) noexcept
+{
+	// Parse SPIR-V
+	spvc_parsed_ir parsedIr = nullptr;
+	if (CHECK_SPIRV_CROSS(context) spvc_context_parse_spirv(context,
+		reinterpret_cast<const SpvId*>(spirv), spirvSizeBytes / 4, &parsedIr) != SPVC_SUCCESS) {
+		return Vector<char>();
+	}
+
+	// Create compiler
+	spvc_compiler compiler = nullptr;
+	if (CHECK_SPIRV_CROSS(context) spvc_context_create_compiler(context, SPVC_BACKEND_MSL,
+		parsedIr, SPVC_CAPTURE_MODE_TAKE_OWNERSHIP, &compiler) != SPVC_SUCCESS) {
+		return Vector<char>();
+	}
+
+	// Target MSL 2.0, which is what the Metal backend is written against
+	spvc_compiler_options options = nullptr;
+	CHECK_SPIRV_CROSS(context) spvc_compiler_create_compiler_options(compiler, &options);
+	CHECK_SPIRV_CROSS(context) spvc_compiler_options_set_uint(
+		options, SPVC_COMPILER_OPTION_MSL_VERSION, SPVC_MAKE_MSL_VERSION(2, 0, 0));
+	CHECK_SPIRV_CROSS(context) spvc_compiler_install_compiler_options(compiler, options);
+
+	// Compile to MSL
+	const char* mslSource = nullptr;
+	if (CHECK_SPIRV_CROSS(context) spvc_compiler_compile(
+		compiler, &mslSource) != SPVC_SUCCESS) {
+		return Vector<char>();
+	}
+
+	return copySource("", mslSource, "MSL Source");
+}
+
+} // namespace zg
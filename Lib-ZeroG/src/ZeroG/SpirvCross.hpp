@@ -0,0 +1,139 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+
+#include "spirv_cross_c.h"
+
+#include "ZeroG.h"
+#include "ZeroG/util/Assert.hpp"
+#include "ZeroG/util/Logging.hpp"
+#include "ZeroG/util/Vector.hpp"
+
+namespace zg {
+
+// SPIRV-Cross error checking
+// ------------------------------------------------------------------------------------------------
+
+#define CHECK_SPIRV_CROSS(context) (zg::CheckSpirvCrossImpl(context, __FILE__, __LINE__)) %
+
+struct CheckSpirvCrossImpl final {
+	spvc_context ctx = nullptr;
+	const char* file;
+	int line;
+
+	CheckSpirvCrossImpl() = delete;
+	CheckSpirvCrossImpl(spvc_context ctx, const char* file, int line) noexcept
+	:
+		ctx(ctx), file(file), line(line)
+	{ }
+
+	spvc_result operator% (spvc_result result) noexcept
+	{
+		if (result == SPVC_SUCCESS) return result;
+
+		// Get error string if context was specified
+		const char* errorStr = "<NO ERROR MESSAGE>";
+		if (ctx != nullptr) errorStr = spvc_context_get_last_error_string(ctx);
+
+		// Log error message
+		logWrapper(file, line, ZG_LOG_LEVEL_ERROR, "SPIRV-Cross error: %s\n", errorStr);
+
+		ZG_ASSERT(false);
+
+		return result;
+	}
+};
+
+// Pipeline reflection
+// ------------------------------------------------------------------------------------------------
+
+// The result of reflecting the shaders of a render pipeline, regardless of shader language and
+// backend.
+struct PipelineRenderReflection final {
+	ZgPipelineRenderSignature signature = {};
+
+	// Which shader stages access each constant buffer, in the same order as in the signature
+	bool constBufferVertexAccess[ZG_MAX_NUM_CONSTANT_BUFFERS] = {};
+	bool constBufferPixelAccess[ZG_MAX_NUM_CONSTANT_BUFFERS] = {};
+};
+
+// SPIR-V reflection
+// ------------------------------------------------------------------------------------------------
+
+// The result of reflecting the SPIR-V shaders of a render pipeline, before it has been validated
+// against a create info. Trivially copyable, so it can be stored as is in shader archives.
+struct SpirvPipelineReflection final {
+
+	// The signature as found in the shaders. Vertex attributes only have location and type set
+	// and are sorted by location, of the render targets only the count is known.
+	PipelineRenderReflection reflection;
+
+	// The constant buffer register assigned to the push constant block, ~0u if there is none
+	uint32_t pushConstantRegister = ~0u;
+
+	// Bit i is set if sampler register i is used by either shader
+	uint32_t samplerRegisterMask = 0;
+};
+
+// Reflects a SPIR-V vertex and pixel shader.
+//
+// Bindings in descriptor set 0 map directly to registers: uniform buffers to constant buffer
+// registers, sampled and separate images to texture registers and (combined) samplers to sampler
+// registers. SPIR-V push constant blocks have no binding, they are assigned the lowest constant
+// buffer register not used by a uniform buffer in either shader and are always push constants.
+ZgResult reflectSpirvPipelineRender(
+	SpirvPipelineReflection& reflectionOut,
+	const uint8_t* vertexSpirv,
+	uint32_t vertexSpirvSizeBytes,
+	const uint8_t* pixelSpirv,
+	uint32_t pixelSpirvSizeBytes) noexcept;
+
+// Validates the reflection of a pipeline's SPIR-V against its create info the same way the
+// backends validate their own shader reflection, and builds the final signature.
+ZgResult validateSpirvPipelineRender(
+	PipelineRenderReflection& reflectionOut,
+	const SpirvPipelineReflection& spirvReflection,
+	const ZgPipelineRenderCreateInfoCommon& createInfo) noexcept;
+
+// SPIR-V cross-compilation
+// ------------------------------------------------------------------------------------------------
+
+// Cross-compiles a SPIR-V shader to HLSL targeting shader model 6.0. The push constant block (if
+// any) is bound to pushConstantRegister, which should be the register it was assigned when the
+// SPIR-V was reflected. The specialization constants (if any) that exist in the shader get their
+// default values overridden, constants that don't exist in it are ignored. Returns an empty vector
+// on failure, otherwise the null-terminated source.
+Vector<char> crossCompileSpirvToHLSL(
+	spvc_context context,
+	const uint8_t* spirv,
+	uint32_t spirvSizeBytes,
+	uint32_t pushConstantRegister,
+	const ZgSpecializationConstant* specializationConstants,
+	uint32_t numSpecializationConstants) noexcept;
+
+// Cross-compiles a SPIR-V shader to Metal Shading Language. Returns an empty vector on failure,
+// otherwise the null-terminated source.
+Vector<char> crossCompileSpirvToMSL(
+	spvc_context context,
+	const uint8_t* spirv,
+	uint32_t spirvSizeBytes) noexcept;
+
+} // namespace zg
@@ -0,0 +1,358 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/TextureStreamer.hpp"
+
+#include <algorithm>
+
+#include "ZeroG/Context.hpp"
+#include "ZeroG/util/CpuAllocation.hpp"
+#include "ZeroG/util/Logging.hpp"
+
+// Texture streamer: State methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult ZgTextureStreamer::create(const ZgTextureStreamerCreateInfo& createInfo) noexcept
+{
+	this->destroy();
+	ZgBackend* backend = zg::getBackend();
+
+	// Get copy queue
+	ZgResult res = backend->getCopyQueue(&mCopyQueue);
+	if (res != ZG_SUCCESS) return res;
+
+	// Create upload ring buffer
+	ZgMemoryHeapCreateInfo heapInfo = {};
+	heapInfo.sizeInBytes = createInfo.uploadRingSizeInBytes;
+	heapInfo.memoryType = ZG_MEMORY_TYPE_UPLOAD;
+	res = backend->memoryHeapCreate(&mUploadHeap, heapInfo);
+	if (res != ZG_SUCCESS) return res;
+
+	ZgBufferCreateInfo bufferInfo = {};
+	bufferInfo.offsetInBytes = 0;
+	bufferInfo.sizeInBytes = createInfo.uploadRingSizeInBytes;
+	res = mUploadHeap->bufferCreate(&mUploadBuffer, bufferInfo);
+	if (res != ZG_SUCCESS) return res;
+	mUploadBuffer->setDebugName("ZeroG - TextureStreamer - UploadRing");
+	mUploadRingSize = createInfo.uploadRingSizeInBytes;
+
+	// Create one fence per batch that can be in-flight
+	mBatchesInFlight.create(createInfo.maxNumBatchesInFlight, "ZeroG - TextureStreamer");
+	bool allocSuccess = mFences.create(createInfo.maxNumBatchesInFlight, "ZeroG - TextureStreamer");
+	allocSuccess = allocSuccess &&
+		mPendingRequests.create(createInfo.maxNumRequests, "ZeroG - TextureStreamer");
+	allocSuccess = allocSuccess &&
+		mCompletedRequests.create(createInfo.maxNumRequests, "ZeroG - TextureStreamer");
+	if (!allocSuccess) return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	for (uint32_t i = 0; i < createInfo.maxNumBatchesInFlight; i++) {
+		ZgFence* fence = nullptr;
+		res = backend->fenceCreate(&fence);
+		if (res != ZG_SUCCESS) return res;
+		mFences.add(fence);
+	}
+
+	mMaxNumRequests = createInfo.maxNumRequests;
+	mExitRequested = false;
+
+	// Start streaming thread
+	mThread = std::thread([this]() { this->streamingThread(); });
+
+	return ZG_SUCCESS;
+}
+
+void ZgTextureStreamer::destroy() noexcept
+{
+	// Stop streaming thread, it finishes all in-flight batches before exiting
+	if (mThread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mExitRequested = true;
+		}
+		mCondVar.notify_one();
+		mThread.join();
+	}
+
+	// Release resources
+	for (uint32_t i = 0; i < mFences.size(); i++) {
+		zg::zgDelete(mFences[i]);
+	}
+	mFences.destroy();
+	zg::zgDelete(mUploadBuffer);
+	if (mUploadHeap != nullptr) zg::getBackend()->memoryHeapRelease(mUploadHeap);
+
+	mCopyQueue = nullptr;
+	mUploadHeap = nullptr;
+	mUploadBuffer = nullptr;
+	mUploadRingSize = 0;
+
+	mBatchesInFlight.destroy();
+	mRingHead = 0;
+	mRingTail = 0;
+	mNumBatchesSubmitted = 0;
+
+	mExitRequested = false;
+	mNextRequestId = 1;
+	mMaxNumRequests = 0;
+	mNumRequestsInFlight = 0;
+	mPendingRequests.destroy();
+	mCompletedRequests.destroy();
+}
+
+// Texture streamer: Methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult ZgTextureStreamer::request(
+	const ZgTextureStreamRequest& request, uint64_t& requestIdOut) noexcept
+{
+	// The mip chain is written according to the texture's footprints, so size the slot in the
+	// upload ring from those. A smaller specified size means the request is for another texture.
+	uint64_t uploadSizeBytes = 0;
+	ZgResult res = request.texture->getUploadSizeInBytes(uploadSizeBytes);
+	if (res != ZG_SUCCESS) return res;
+	if (request.uploadSizeInBytes < uploadSizeBytes) {
+		ZG_ERROR("Texture requires %llu bytes to upload, request specifies only %u bytes",
+			uploadSizeBytes, request.uploadSizeInBytes);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Check that the request can ever fit in the upload ring
+	if (uploadSizeBytes > mUploadRingSize) {
+		ZG_ERROR("Texture requires %llu bytes to upload, upload ring is only %llu bytes",
+			uploadSizeBytes, mUploadRingSize);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		// Check that there is room for another request
+		uint32_t numRequests =
+			mPendingRequests.size() + mNumRequestsInFlight + mCompletedRequests.size();
+		if (numRequests >= mMaxNumRequests) return ZG_ERROR_GENERIC;
+
+		PendingRequest pending;
+		pending.id = mNextRequestId;
+		pending.request = request;
+		pending.uploadSizeBytes = uploadSizeBytes;
+		mPendingRequests.add(pending);
+		mNextRequestId += 1;
+		requestIdOut = pending.id;
+	}
+
+	// Wake up streaming thread
+	mCondVar.notify_one();
+	return ZG_SUCCESS;
+}
+
+ZgResult ZgTextureStreamer::getCompleted(
+	ZgTextureStreamCompletion* completionsOut,
+	uint32_t maxNumCompletions,
+	uint32_t& numCompletionsOut) noexcept
+{
+	// Pop the oldest completions, does not need to take the mutex
+	uint32_t numCompletions = 0;
+	while (numCompletions < maxNumCompletions) {
+		if (!mCompletedRequests.pop(completionsOut[numCompletions])) break;
+		numCompletions += 1;
+	}
+
+	numCompletionsOut = numCompletions;
+	return ZG_SUCCESS;
+}
+
+// Texture streamer: Private methods
+// ------------------------------------------------------------------------------------------------
+
+void ZgTextureStreamer::streamingThread() noexcept
+{
+	PendingRequest batchRequests[MAX_NUM_REQUESTS_PER_BATCH];
+	uint64_t ringOffsets[MAX_NUM_REQUESTS_PER_BATCH] = {};
+
+	while (true) {
+
+		// Retire batches the GPU has finished with, without blocking
+		retireFinishedBatches(false);
+
+		// If nothing is in-flight the entire ring is free, restart at the beginning of it
+		if (mBatchesInFlight.size() == 0) {
+			mRingHead = ((mRingHead + mUploadRingSize - 1) / mUploadRingSize) * mUploadRingSize;
+			mRingTail = mRingHead;
+		}
+
+		uint32_t numBatchRequests = 0;
+		uint64_t ringHead = mRingHead;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+
+			// Sleep until there is something to do
+			if (mBatchesInFlight.size() == 0) {
+				mCondVar.wait(lock, [this]() {
+					return mExitRequested || mPendingRequests.size() > 0;
+				});
+			}
+			if (mExitRequested) break;
+
+			// Pick requests in priority order as long as they fit in the upload ring
+			bool batchAvailable = mBatchesInFlight.size() < mFences.size();
+			while (batchAvailable &&
+				numBatchRequests < MAX_NUM_REQUESTS_PER_BATCH &&
+				mPendingRequests.size() > 0) {
+
+				// Find highest priority request, oldest first if same priority
+				uint32_t bestIdx = 0;
+				for (uint32_t i = 1; i < mPendingRequests.size(); i++) {
+					const PendingRequest& best = mPendingRequests[bestIdx];
+					const PendingRequest& other = mPendingRequests[i];
+					if (other.request.priority > best.request.priority ||
+						(other.request.priority == best.request.priority && other.id < best.id)) {
+						bestIdx = i;
+					}
+				}
+				const PendingRequest& pending = mPendingRequests[bestIdx];
+
+				// Allocate range in upload ring, wrap to beginning if it does not fit at the end
+				uint64_t sizeBytes = pending.uploadSizeBytes;
+				uint64_t ringBegin = ringHead;
+				uint64_t offsetInRing = ringBegin % mUploadRingSize;
+				if ((offsetInRing + sizeBytes) > mUploadRingSize) {
+					ringBegin += (mUploadRingSize - offsetInRing);
+				}
+				if ((ringBegin + sizeBytes - mRingTail) > mUploadRingSize) break;
+
+				batchRequests[numBatchRequests] = pending;
+				ringOffsets[numBatchRequests] = ringBegin % mUploadRingSize;
+				numBatchRequests += 1;
+				ringHead = ringBegin + sizeBytes;
+
+				// Remove request by swapping with last, order is determined by priority and id
+				mPendingRequests[bestIdx] = mPendingRequests.last();
+				mPendingRequests.pop();
+			}
+			mNumRequestsInFlight += numBatchRequests;
+		}
+
+		// Record and submit batch
+		if (numBatchRequests > 0) {
+			recordBatch(batchRequests, ringOffsets, numBatchRequests, ringHead);
+			mRingHead = ringHead;
+		}
+
+		// Nothing could be started, wait for the oldest batch to free up the ring
+		else if (mBatchesInFlight.size() > 0) {
+			retireFinishedBatches(true);
+		}
+	}
+
+	// Wait for all in-flight batches before exiting
+	while (mBatchesInFlight.size() > 0) {
+		retireFinishedBatches(true);
+	}
+}
+
+void ZgTextureStreamer::retireFinishedBatches(bool waitForOldest) noexcept
+{
+	bool first = true;
+	while (mBatchesInFlight.size() > 0) {
+		Batch& batch = mBatchesInFlight.first();
+
+		// Check if batch is finished
+		if (waitForOldest && first) {
+			batch.fence->waitOnCpuBlocking();
+		}
+		else {
+			bool signaled = false;
+			batch.fence->checkIfSignaled(signaled);
+			if (!signaled) break;
+		}
+		first = false;
+
+		// Report completed requests
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (uint32_t i = 0; i < batch.numRequests; i++) {
+				mCompletedRequests.add(batch.completions[i]);
+			}
+			mNumRequestsInFlight -= batch.numRequests;
+		}
+
+		// Free up the batch's range in the upload ring
+		mRingTail = batch.ringEnd;
+		mBatchesInFlight.pop();
+	}
+}
+
+void ZgTextureStreamer::recordBatch(
+	const PendingRequest* requests,
+	const uint64_t* ringOffsets,
+	uint32_t numRequests,
+	uint64_t ringEnd) noexcept
+{
+	Batch batch;
+	batch.fence = mFences[uint32_t(mNumBatchesSubmitted % mFences.size())];
+	batch.ringEnd = ringEnd;
+	batch.numRequests = numRequests;
+	for (uint32_t i = 0; i < numRequests; i++) {
+		batch.completions[i].requestId = requests[i].id;
+		batch.completions[i].texture = requests[i].request.texture;
+		batch.completions[i].result = ZG_SUCCESS;
+	}
+
+	// Record all uploads into a single command list
+	ZgCommandList* commandList = nullptr;
+	ZgResult res = mCopyQueue->beginCommandListRecording(&commandList);
+	if (res == ZG_SUCCESS) {
+		for (uint32_t i = 0; i < numRequests; i++) {
+			const ZgTextureStreamRequest& request = requests[i].request;
+			ZgResult uploadRes = commandList->memcpyToTextureMipChain(
+				request.texture,
+				request.mipLevels,
+				request.numMipLevels,
+				mUploadBuffer,
+				ringOffsets[i]);
+
+			// Transition texture so it can be used on the present queue once fence is signaled
+			if (uploadRes == ZG_SUCCESS) {
+				uploadRes = commandList->enableQueueTransitionTexture(request.texture);
+			}
+			if (uploadRes != ZG_SUCCESS) {
+				ZG_ERROR("Failed to stream texture (request %llu): %s",
+					requests[i].id, zgResultToString(uploadRes));
+				batch.completions[i].result = uploadRes;
+			}
+		}
+		res = mCopyQueue->executeCommandList(commandList);
+	}
+	if (res == ZG_SUCCESS) {
+		res = mCopyQueue->signalOnGpu(*batch.fence);
+	}
+
+	// If the batch could not be submitted there is nothing to wait for, report it immediately
+	if (res != ZG_SUCCESS) {
+		ZG_ERROR("Failed to submit texture streaming batch: %s", zgResultToString(res));
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (uint32_t i = 0; i < numRequests; i++) {
+			if (batch.completions[i].result == ZG_SUCCESS) batch.completions[i].result = res;
+			mCompletedRequests.add(batch.completions[i]);
+		}
+		mNumRequestsInFlight -= numRequests;
+		return;
+	}
+
+	mBatchesInFlight.add(std::move(batch));
+	mNumBatchesSubmitted += 1;
+}
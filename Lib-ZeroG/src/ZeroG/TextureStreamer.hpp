@@ -0,0 +1,124 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "ZeroG.h"
+#include "ZeroG/BackendInterface.hpp"
+#include "ZeroG/util/MpmcQueue.hpp"
+#include "ZeroG/util/RingBuffer.hpp"
+#include "ZeroG/util/Vector.hpp"
+
+// Texture streamer
+// ------------------------------------------------------------------------------------------------
+
+struct ZgTextureStreamer final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	ZgTextureStreamer() noexcept = default;
+	ZgTextureStreamer(const ZgTextureStreamer&) = delete;
+	ZgTextureStreamer& operator= (const ZgTextureStreamer&) = delete;
+	ZgTextureStreamer(ZgTextureStreamer&&) = delete;
+	ZgTextureStreamer& operator= (ZgTextureStreamer&&) = delete;
+	~ZgTextureStreamer() noexcept { this->destroy(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	ZgResult create(const ZgTextureStreamerCreateInfo& createInfo) noexcept;
+	void destroy() noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	ZgResult request(const ZgTextureStreamRequest& request, uint64_t& requestIdOut) noexcept;
+
+	ZgResult getCompleted(
+		ZgTextureStreamCompletion* completionsOut,
+		uint32_t maxNumCompletions,
+		uint32_t& numCompletionsOut) noexcept;
+
+private:
+	// Private structs
+	// --------------------------------------------------------------------------------------------
+
+	static constexpr uint32_t MAX_NUM_REQUESTS_PER_BATCH = 32;
+
+	struct PendingRequest final {
+		uint64_t id = 0;
+		ZgTextureStreamRequest request = {};
+
+		// Size of the request's slot in the upload ring, from the texture's own footprints
+		uint64_t uploadSizeBytes = 0;
+	};
+
+	struct Batch final {
+		ZgFence* fence = nullptr;
+		uint64_t ringEnd = 0;
+		uint32_t numRequests = 0;
+		ZgTextureStreamCompletion completions[MAX_NUM_REQUESTS_PER_BATCH] = {};
+	};
+
+	// Private methods
+	// --------------------------------------------------------------------------------------------
+
+	void streamingThread() noexcept;
+	void retireFinishedBatches(bool waitForOldest) noexcept;
+	void recordBatch(
+		const PendingRequest* requests,
+		const uint64_t* ringOffsets,
+		uint32_t numRequests,
+		uint64_t ringEnd) noexcept;
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	// Resources, only created/destroyed on the creating thread
+	ZgCommandQueue* mCopyQueue = nullptr;
+	ZgMemoryHeap* mUploadHeap = nullptr;
+	ZgBuffer* mUploadBuffer = nullptr;
+	uint64_t mUploadRingSize = 0;
+	zg::Vector<ZgFence*> mFences;
+	std::thread mThread;
+
+	// State only accessed by the streaming thread
+	zg::RingBuffer<Batch> mBatchesInFlight;
+	uint64_t mRingHead = 0; // Next (unwrapped) byte to allocate
+	uint64_t mRingTail = 0; // Oldest (unwrapped) byte still in use by an in-flight batch
+	uint64_t mNumBatchesSubmitted = 0;
+
+	// State shared between threads, protected by mMutex
+	std::mutex mMutex;
+	std::condition_variable mCondVar;
+	bool mExitRequested = false;
+	uint64_t mNextRequestId = 1;
+	uint32_t mMaxNumRequests = 0;
+	uint32_t mNumRequestsInFlight = 0;
+	zg::Vector<PendingRequest> mPendingRequests;
+
+	// Completions are added by the streaming thread while holding mMutex (so that the request
+	// count stays consistent), but can be popped by any thread without it
+	zg::MpmcQueue<ZgTextureStreamCompletion> mCompletedRequests;
+};
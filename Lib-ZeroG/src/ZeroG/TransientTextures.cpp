@@ -0,0 +1,119 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/TransientTextures.hpp"
+
+#include <algorithm>
+
+#include "ZeroG/Context.hpp"
+#include "ZeroG/util/Vector.hpp"
+
+namespace zg {
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+struct Placement final {
+	uint32_t textureIdx = ~0u;
+	uint64_t sizeInBytes = 0;
+	uint64_t alignmentInBytes = 0;
+	uint64_t offsetInBytes = 0;
+};
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) noexcept
+{
+	return ((value + alignment - 1) / alignment) * alignment;
+}
+
+static bool lifetimesOverlap(const ZgTransientTexture2D& a, const ZgTransientTexture2D& b) noexcept
+{
+	return a.firstPassIdx <= b.lastPassIdx && b.firstPassIdx <= a.lastPassIdx;
+}
+
+// Transient texture placement
+// ------------------------------------------------------------------------------------------------
+
+ZgResult calculateTransientPlacement(
+	ZgTransientTexture2D* textures, uint32_t numTextures, uint64_t& heapSizeInBytesOut) noexcept
+{
+	heapSizeInBytesOut = 0;
+	ZgBackend* backend = getBackend();
+
+	// Get size and alignment of all textures
+	Vector<Placement> placements;
+	if (!placements.create(numTextures, "ZeroG - Transient placements")) {
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+	for (uint32_t i = 0; i < numTextures; i++) {
+		ZgTexture2DAllocationInfo allocInfo = {};
+		ZgResult res = backend->texture2DGetAllocationInfo(allocInfo, textures[i].createInfo);
+		if (res != ZG_SUCCESS) return res;
+
+		Placement placement;
+		placement.textureIdx = i;
+		placement.sizeInBytes = allocInfo.sizeInBytes;
+		placement.alignmentInBytes = std::max(allocInfo.alignmentInBytes, 1u);
+		placements.add(placement);
+	}
+
+	// Place the largest textures first, they are the hardest to fit into gaps
+	std::sort(placements.data(), placements.data() + placements.size(),
+		[](const Placement& lhs, const Placement& rhs) {
+		if (lhs.sizeInBytes != rhs.sizeInBytes) return lhs.sizeInBytes > rhs.sizeInBytes;
+		return lhs.textureIdx < rhs.textureIdx;
+	});
+
+	for (uint32_t i = 0; i < numTextures; i++) {
+		Placement& placement = placements[i];
+		const ZgTransientTexture2D& texture = textures[placement.textureIdx];
+
+		// Move the texture past any already placed texture it conflicts with until there are no
+		// conflicts left. The offset only ever increases, so this is guaranteed to terminate.
+		uint64_t offset = 0;
+		bool moved = true;
+		while (moved) {
+			moved = false;
+			for (uint32_t j = 0; j < i; j++) {
+				const Placement& other = placements[j];
+				if (!lifetimesOverlap(texture, textures[other.textureIdx])) continue;
+				uint64_t otherEnd = other.offsetInBytes + other.sizeInBytes;
+				bool memoryOverlaps =
+					offset < otherEnd && other.offsetInBytes < (offset + placement.sizeInBytes);
+				if (memoryOverlaps) {
+					offset = alignUp(otherEnd, placement.alignmentInBytes);
+					moved = true;
+				}
+			}
+		}
+
+		placement.offsetInBytes = offset;
+		heapSizeInBytesOut = std::max(heapSizeInBytesOut, offset + placement.sizeInBytes);
+	}
+
+	// Write placements to create infos
+	for (uint32_t i = 0; i < numTextures; i++) {
+		const Placement& placement = placements[i];
+		ZgTexture2DCreateInfo& createInfo = textures[placement.textureIdx].createInfo;
+		createInfo.offsetInBytes = placement.offsetInBytes;
+		createInfo.sizeInBytes = placement.sizeInBytes;
+	}
+
+	return ZG_SUCCESS;
+}
+
+} // namespace zg
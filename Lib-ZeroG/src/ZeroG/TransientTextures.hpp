@@ -0,0 +1,39 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+
+#include "ZeroG.h"
+
+namespace zg {
+
+// Transient texture placement
+// ------------------------------------------------------------------------------------------------
+
+// Calculates offsets for a set of transient textures within a single framebuffer heap.
+//
+// Textures are placed largest first, each at the lowest aligned offset that does not overlap any
+// previously placed texture whose pass window overlaps its own. Textures that are never alive at
+// the same time may thus share memory. Writes "offsetInBytes" and "sizeInBytes" of each texture's
+// create info and returns the total size of the heap required.
+ZgResult calculateTransientPlacement(
+	ZgTransientTexture2D* textures, uint32_t numTextures, uint64_t& heapSizeInBytesOut) noexcept;
+
+} // namespace zg
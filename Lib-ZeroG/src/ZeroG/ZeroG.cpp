@@ -21,8 +21,17 @@
 
 #include "ZeroG/BackendInterface.hpp"
 #include "ZeroG/Context.hpp"
+#include "ZeroG/JobSystem.hpp"
+#include "ZeroG/PipelineCache.hpp"
+#include "ZeroG/PipelineRenderPending.hpp"
+#include "ZeroG/PipelineRenderPermutations.hpp"
+#include "ZeroG/ShaderArchive.hpp"
+#include "ZeroG/ShaderHotReload.hpp"
+#include "ZeroG/TextureStreamer.hpp"
+#include "ZeroG/TransientTextures.hpp"
 #include "ZeroG/util/CpuAllocation.hpp"
 #include "ZeroG/util/ErrorReporting.hpp"
+#include "ZeroG/util/FileIO.hpp"
 #include "ZeroG/util/Logging.hpp"
 
 #if defined(_WIN32)
@@ -80,6 +89,7 @@ ZG_API const char* zgResultToString(ZgResult result)
 	case ZG_ERROR_SHADER_COMPILE_ERROR: return "ZG_ERROR_SHADER_COMPILE_ERROR";
 	case ZG_ERROR_OUT_OF_COMMAND_LISTS: return "ZG_ERROR_OUT_OF_COMMAND_LISTS";
 	case ZG_ERROR_INVALID_COMMAND_LIST_STATE: return "ZG_ERROR_INVALID_COMMAND_LIST_STATE";
+	case ZG_ERROR_OUT_OF_DESCRIPTORS: return "ZG_ERROR_OUT_OF_DESCRIPTORS";
 	}
 	return "<UNKNOWN RESULT>";
 }
@@ -113,6 +123,9 @@ ZG_API ZgResult zgContextInit(const ZgContextInitSettings* initSettings)
 	if (usingDefaultAllocator) allocator = zg::getDefaultAllocator();
 	else allocator = settings.allocator;
 
+	// Wrap allocator so CPU allocations can be tracked by name, if requested
+	if (settings.trackCpuAllocations) allocator = zg::createTrackingAllocator(allocator);
+
 	// Set temporary context with logger and allocator. Required so rest of initialization can
 	// allocate memory and log.
 	ZgContext tmpContext = {};
@@ -127,6 +140,7 @@ ZG_API ZgResult zgContextInit(const ZgContextInitSettings* initSettings)
 	// Log which allocator is used
 	if (usingDefaultAllocator) ZG_INFO("zgContextInit(): Using default allocator");
 	else ZG_INFO("zgContextInit(): Using user-provided allocator");
+	if (settings.trackCpuAllocations) ZG_INFO("zgContextInit(): Tracking CPU allocations");
 
 	// Create and allocate requested backend api
 	switch (initSettings->backend) {
@@ -181,6 +195,47 @@ ZG_API ZgResult zgContextInit(const ZgContextInitSettings* initSettings)
 		return ZG_ERROR_GENERIC;
 	}
 
+	// Create job system, either an internal thread pool or a wrapper around the host scheduler
+	tmpContext.jobSystem = zg::zgNew<zg::JobSystem>("ZeroG - JobSystem");
+	ZgResult jobSystemRes = tmpContext.jobSystem == nullptr ?
+		ZG_ERROR_CPU_OUT_OF_MEMORY : tmpContext.jobSystem->create(settings.jobs);
+	if (jobSystemRes != ZG_SUCCESS) {
+		ZG_ERROR("zgContextInit(): Could not create job system, exiting.");
+		zg::zgDelete(tmpContext.jobSystem);
+		zg::zgDelete(tmpContext.backend);
+		return jobSystemRes;
+	}
+	if (settings.jobs.parallelFor != nullptr) {
+		ZG_INFO("zgContextInit(): Using host scheduler for internal parallelism");
+	}
+	else {
+		ZG_INFO("zgContextInit(): Using %u internal worker threads",
+			tmpContext.jobSystem->numWorkerThreads());
+	}
+
+	// Create pipeline cache, disabled unless a cache directory is specified
+	tmpContext.pipelineCache = zg::zgNew<zg::PipelineCache>("ZeroG - PipelineCache");
+	ZgResult pipelineCacheRes = tmpContext.pipelineCache->create(settings.pipelineCache);
+	if (pipelineCacheRes != ZG_SUCCESS) {
+		ZG_ERROR("zgContextInit(): Could not create pipeline cache, exiting.");
+		zg::zgDelete(tmpContext.pipelineCache);
+		zg::zgDelete(tmpContext.jobSystem);
+		zg::zgDelete(tmpContext.backend);
+		return pipelineCacheRes;
+	}
+
+	// Create shader hot-reload, which does nothing unless enabled
+	tmpContext.shaderHotReload = zg::zgNew<zg::ShaderHotReload>("ZeroG - ShaderHotReload");
+	ZgResult hotReloadRes = tmpContext.shaderHotReload->create(settings.shaderHotReload);
+	if (hotReloadRes != ZG_SUCCESS) {
+		ZG_ERROR("zgContextInit(): Could not create shader hot-reload, exiting.");
+		zg::zgDelete(tmpContext.shaderHotReload);
+		zg::zgDelete(tmpContext.pipelineCache);
+		zg::zgDelete(tmpContext.jobSystem);
+		zg::zgDelete(tmpContext.backend);
+		return hotReloadRes;
+	}
+
 	// Set context
 	zg::setContext(tmpContext);
 	return ZG_SUCCESS;
@@ -192,9 +247,22 @@ ZG_API ZgResult zgContextDeinit(void)
 
 	ZgContext& ctx = zg::getContext();
 
+	// Delete shader hot-reload first, its thread compiles pipelines using the job system and the
+	// backend
+	zg::zgDelete(ctx.shaderHotReload);
+	ctx.shaderHotReload = nullptr;
+
+	// Delete job system before backend, so that queued jobs (which may use the backend) are
+	// finished first. Anything run during backend destruction will run serially.
+	zg::zgDelete(ctx.jobSystem);
+	ctx.jobSystem = nullptr;
+
 	// Delete backend
 	zg::zgDelete(ctx.backend);
 
+	// Delete pipeline cache
+	zg::zgDelete(ctx.pipelineCache);
+
 	// Reset context
 	ctx = {};
 
@@ -211,6 +279,8 @@ ZG_API ZgResult zgContextSwapchainResize(
 ZG_API ZgResult zgContextSwapchainBeginFrame(
 	ZgFramebuffer** framebufferOut)
 {
+	// Swap in pipelines recompiled by shader hot-reload, postponed if command lists are recording
+	zg::getContext().shaderHotReload->applyReloaded();
 	return zg::getBackend()->swapchainBeginFrame(framebufferOut);
 }
 
@@ -225,15 +295,56 @@ ZG_API ZgResult zgContextSwapchainFinishFrame(void)
 ZG_API ZgResult zgContextGetStats(ZgStats* statsOut)
 {
 	ZG_ARG_CHECK(statsOut == nullptr, "");
-	return zg::getBackend()->getStats(*statsOut);
+	ZgResult res = zg::getBackend()->getStats(*statsOut);
+	if (res != ZG_SUCCESS) return res;
+
+	// Backend agnostic stats
+	zg::PipelineCacheStats pipelineCacheStats = zg::getContext().pipelineCache->stats();
+	statsOut->pipelineCacheNumHits = pipelineCacheStats.numHits;
+	statsOut->pipelineCacheNumMisses = pipelineCacheStats.numMisses;
+	statsOut->pipelineCacheNumEvictions = pipelineCacheStats.numEvictions;
+	statsOut->pipelineCacheSizeBytes = pipelineCacheStats.sizeBytes;
+	zg::ShaderHotReloadStats hotReloadStats = zg::getContext().shaderHotReload->stats();
+	statsOut->shaderHotReloadNumReloads = hotReloadStats.numReloads;
+	statsOut->shaderHotReloadNumFailures = hotReloadStats.numFailures;
+	return ZG_SUCCESS;
+}
+
+ZG_API ZgResult zgContextGetCpuAllocationStats(
+	ZgCpuAllocationTagStats* statsOut,
+	uint32_t maxNumStats,
+	uint32_t* numStatsOut)
+{
+	ZG_ARG_CHECK(numStatsOut == nullptr, "");
+	if (!zg::isTrackingAllocator(zg::getAllocator())) {
+		*numStatsOut = 0;
+		return ZG_WARNING_GENERIC;
+	}
+	zg::getCpuAllocationStats(statsOut, maxNumStats, *numStatsOut);
+	return ZG_SUCCESS;
 }
 
 // Pipeline Render - Common
 // ------------------------------------------------------------------------------------------------
 
+// Validates the parts of the create info shared by all the ways to create a render pipeline
+static ZgResult validatePipelineRenderCommon(const ZgPipelineRenderCreateInfoCommon& common)
+{
+	ZG_ARG_CHECK(common.numVertexAttributes == 0, "Must specify at least one vertex attribute");
+	ZG_ARG_CHECK(common.numVertexAttributes > ZG_MAX_NUM_VERTEX_ATTRIBUTES, "Too many vertex attributes specified");
+	ZG_ARG_CHECK(common.numVertexBufferSlots == 0, "Must specify at least one vertex buffer");
+	ZG_ARG_CHECK(common.numVertexBufferSlots > ZG_MAX_NUM_VERTEX_ATTRIBUTES, "Too many vertex buffers specified");
+	ZG_ARG_CHECK(common.numPushConstants > ZG_MAX_NUM_CONSTANT_BUFFERS, "Too many push constants specified");
+	ZG_ARG_CHECK(common.numRootConstantBuffers > ZG_MAX_NUM_CONSTANT_BUFFERS, "Too many root constant buffers specified");
+	ZG_ARG_CHECK(common.numSamplers > ZG_MAX_NUM_SAMPLERS, "Too many samplers specified");
+	ZG_ARG_CHECK(common.numRenderTargets > ZG_MAX_NUM_RENDER_TARGETS, "Too many render targets specified");
+	return ZG_SUCCESS;
+}
+
 ZG_API ZgResult zgPipelineRenderRelease(
 	ZgPipelineRender* pipeline)
 {
+	zg::getContext().shaderHotReload->unregisterPipeline(pipeline);
 	return zg::getBackend()->pipelineRenderRelease(pipeline);
 }
 
@@ -259,13 +370,43 @@ ZG_API ZgResult zgPipelineRenderCreateFromFileSPIRV(
 	ZG_ARG_CHECK(createInfo->common.vertexShaderEntry == nullptr, "");
 	ZG_ARG_CHECK(createInfo->pixelShaderPath == nullptr, "");
 	ZG_ARG_CHECK(createInfo->common.pixelShaderEntry == nullptr, "");
-	ZG_ARG_CHECK(createInfo->common.numVertexAttributes == 0, "Must specify at least one vertex attribute");
-	ZG_ARG_CHECK(createInfo->common.numVertexAttributes >= ZG_MAX_NUM_VERTEX_ATTRIBUTES, "Too many vertex attributes specified");
-	ZG_ARG_CHECK(createInfo->common.numVertexBufferSlots == 0, "Must specify at least one vertex buffer");
-	ZG_ARG_CHECK(createInfo->common.numVertexBufferSlots >= ZG_MAX_NUM_VERTEX_ATTRIBUTES, "Too many vertex buffers specified");
-	ZG_ARG_CHECK(createInfo->common.numPushConstants >= ZG_MAX_NUM_CONSTANT_BUFFERS, "Too many push constants specified");
+	ZG_ARG_CHECK(createInfo->numSpecializationConstants > ZG_MAX_NUM_SPECIALIZATION_CONSTANTS, "Too many specialization constants specified");
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
 
-	return zg::getBackend()->pipelineRenderCreateFromFileSPIRV(
+	res = zg::getBackend()->pipelineRenderCreateFromFileSPIRV(
+		pipelineOut, signatureOut, *createInfo);
+	if (res != ZG_SUCCESS) return res;
+	res = zg::getContext().shaderHotReload->registerPipeline(
+		*pipelineOut, *signatureOut, *createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::getBackend()->pipelineRenderRelease(*pipelineOut);
+		*pipelineOut = nullptr;
+	}
+	return res;
+}
+
+ZG_API ZgResult zgPipelineRenderCreateFromMemorySPIRV(
+	ZgPipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoMemorySPIRV* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(pipelineOut == nullptr, "");
+	ZG_ARG_CHECK(signatureOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderSpirv == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderSpirvSizeBytes == 0, "");
+	ZG_ARG_CHECK((createInfo->vertexShaderSpirvSizeBytes % 4) != 0, "SPIR-V size must be a multiple of 4 bytes");
+	ZG_ARG_CHECK(createInfo->common.vertexShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderSpirv == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderSpirvSizeBytes == 0, "");
+	ZG_ARG_CHECK((createInfo->pixelShaderSpirvSizeBytes % 4) != 0, "SPIR-V size must be a multiple of 4 bytes");
+	ZG_ARG_CHECK(createInfo->common.pixelShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->numSpecializationConstants > ZG_MAX_NUM_SPECIALIZATION_CONSTANTS, "Too many specialization constants specified");
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	return zg::getBackend()->pipelineRenderCreateFromMemorySPIRV(
 		pipelineOut, signatureOut, *createInfo);
 }
 
@@ -285,14 +426,23 @@ ZG_API ZgResult zgPipelineRenderCreateFromFileHLSL(
 	ZG_ARG_CHECK(createInfo->pixelShaderPath == nullptr, "");
 	ZG_ARG_CHECK(createInfo->common.pixelShaderEntry == nullptr, "");
 	ZG_ARG_CHECK(createInfo->shaderModel == ZG_SHADER_MODEL_UNDEFINED, "Must specify shader model");
-	ZG_ARG_CHECK(createInfo->common.numVertexAttributes == 0, "Must specify at least one vertex attribute");
-	ZG_ARG_CHECK(createInfo->common.numVertexAttributes >= ZG_MAX_NUM_VERTEX_ATTRIBUTES, "Too many vertex attributes specified");
-	ZG_ARG_CHECK(createInfo->common.numVertexBufferSlots == 0, "Must specify at least one vertex buffer");
-	ZG_ARG_CHECK(createInfo->common.numVertexBufferSlots >= ZG_MAX_NUM_VERTEX_ATTRIBUTES, "Too many vertex buffers specified");
-	ZG_ARG_CHECK(createInfo->common.numPushConstants >= ZG_MAX_NUM_CONSTANT_BUFFERS, "Too many push constants specified");
+	ZG_ARG_CHECK(createInfo->numDefines > ZG_MAX_NUM_SHADER_DEFINES, "Too many defines specified");
+	for (uint32_t i = 0; i < createInfo->numDefines; i++) {
+		ZG_ARG_CHECK(createInfo->defines[i].name == nullptr, "Define names must not be null");
+	}
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
 
-	return zg::getBackend()->pipelineRenderCreateFromFileHLSL(
+	res = zg::getBackend()->pipelineRenderCreateFromFileHLSL(
 		pipelineOut, signatureOut, *createInfo);
+	if (res != ZG_SUCCESS) return res;
+	res = zg::getContext().shaderHotReload->registerPipeline(
+		*pipelineOut, *signatureOut, *createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::getBackend()->pipelineRenderRelease(*pipelineOut);
+		*pipelineOut = nullptr;
+	}
+	return res;
 }
 
 ZG_API ZgResult zgPipelineRenderCreateFromSourceHLSL(
@@ -308,16 +458,456 @@ ZG_API ZgResult zgPipelineRenderCreateFromSourceHLSL(
 	ZG_ARG_CHECK(createInfo->pixelShaderSrc == nullptr, "");
 	ZG_ARG_CHECK(createInfo->common.pixelShaderEntry == nullptr, "");
 	ZG_ARG_CHECK(createInfo->shaderModel == ZG_SHADER_MODEL_UNDEFINED, "Must specify shader model");
-	ZG_ARG_CHECK(createInfo->common.numVertexAttributes == 0, "Must specify at least one vertex attribute");
-	ZG_ARG_CHECK(createInfo->common.numVertexAttributes >= ZG_MAX_NUM_VERTEX_ATTRIBUTES, "Too many vertex attributes specified");
-	ZG_ARG_CHECK(createInfo->common.numVertexBufferSlots == 0, "Must specify at least one vertex buffer");
-	ZG_ARG_CHECK(createInfo->common.numVertexBufferSlots >= ZG_MAX_NUM_VERTEX_ATTRIBUTES, "Too many vertex buffers specified");
-	ZG_ARG_CHECK(createInfo->common.numPushConstants >= ZG_MAX_NUM_CONSTANT_BUFFERS, "Too many push constants specified");
+	ZG_ARG_CHECK(createInfo->numDefines > ZG_MAX_NUM_SHADER_DEFINES, "Too many defines specified");
+	for (uint32_t i = 0; i < createInfo->numDefines; i++) {
+		ZG_ARG_CHECK(createInfo->defines[i].name == nullptr, "Define names must not be null");
+	}
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
 
 	return zg::getBackend()->pipelineRenderCreateFromSourceHLSL(
 		pipelineOut, signatureOut, *createInfo);
 }
 
+// Pipeline Render - DXIL
+// ------------------------------------------------------------------------------------------------
+
+ZG_API ZgResult zgPipelineRenderCreateFromMemoryDXIL(
+	ZgPipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoMemoryDXIL* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(pipelineOut == nullptr, "");
+	ZG_ARG_CHECK(signatureOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderDxil == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderDxilSizeBytes == 0, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderDxil == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderDxilSizeBytes == 0, "");
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	return zg::getBackend()->pipelineRenderCreateFromMemoryDXIL(
+		pipelineOut, signatureOut, *createInfo);
+}
+
+// Pipeline Render - Shader archive
+// ------------------------------------------------------------------------------------------------
+
+ZG_API ZgResult zgShaderArchiveLoad(
+	ZgShaderArchive** archiveOut,
+	const char* path)
+{
+	ZG_ARG_CHECK(archiveOut == nullptr, "");
+	ZG_ARG_CHECK(path == nullptr, "");
+
+	ZgShaderArchive* archive = zg::zgNew<ZgShaderArchive>("ZeroG - ShaderArchive");
+	ZgResult mapRes = archive->file.map(path);
+	if (mapRes != ZG_SUCCESS) {
+		zg::zgDelete(archive);
+		return mapRes;
+	}
+	ZgResult validateRes = zg::validateShaderArchive(archive->file.data(), archive->file.size());
+	if (validateRes != ZG_SUCCESS) {
+		ZG_ERROR("\"%s\" is not a valid shader archive", path);
+		zg::zgDelete(archive);
+		return validateRes;
+	}
+
+	const zg::ShaderArchiveHeader& header =
+		*reinterpret_cast<const zg::ShaderArchiveHeader*>(archive->file.data());
+	archive->numPipelines = header.numEntries;
+	ZG_INFO("Loaded shader archive \"%s\" with %u pipelines", path, archive->numPipelines);
+
+	*archiveOut = archive;
+	return ZG_SUCCESS;
+}
+
+ZG_API void zgShaderArchiveRelease(
+	ZgShaderArchive* archive)
+{
+	if (archive == nullptr) return;
+	zg::zgDelete(archive);
+}
+
+ZG_API ZgResult zgShaderArchiveContains(
+	const ZgShaderArchive* archive,
+	const char* pipelineName,
+	ZgBool* containsOut)
+{
+	ZG_ARG_CHECK(archive == nullptr, "");
+	ZG_ARG_CHECK(pipelineName == nullptr, "");
+	ZG_ARG_CHECK(containsOut == nullptr, "");
+	const zg::ShaderArchiveEntry* entry =
+		zg::findShaderArchiveEntry(archive->file.data(), pipelineName);
+	*containsOut = entry != nullptr ? ZG_TRUE : ZG_FALSE;
+	return ZG_SUCCESS;
+}
+
+ZG_API ZgResult zgPipelineRenderCreateFromArchive(
+	ZgPipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoArchive* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(pipelineOut == nullptr, "");
+	ZG_ARG_CHECK(signatureOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->archive == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pipelineName == nullptr, "");
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	zg::ShaderArchivePipeline pipeline;
+	if (!zg::getShaderArchivePipeline(
+		pipeline, createInfo->archive->file.data(), createInfo->pipelineName)) {
+		ZG_ERROR("Shader archive does not contain pipeline \"%s\"", createInfo->pipelineName);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	return zg::getBackend()->pipelineRenderCreateFromArchive(
+		pipelineOut, signatureOut, createInfo->common, pipeline);
+}
+
+// Pipeline Render - Async
+// ------------------------------------------------------------------------------------------------
+
+ZG_API ZgResult zgPipelineRenderCreateFromFileSPIRVAsync(
+	ZgPipelineRenderPending** pendingOut,
+	const ZgPipelineRenderCreateInfoFileSPIRV* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(pendingOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderPath == nullptr, "");
+	ZG_ARG_CHECK(createInfo->common.vertexShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderPath == nullptr, "");
+	ZG_ARG_CHECK(createInfo->common.pixelShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->numSpecializationConstants > ZG_MAX_NUM_SPECIALIZATION_CONSTANTS, "Too many specialization constants specified");
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	ZgPipelineRenderPending* pending =
+		zg::zgNew<ZgPipelineRenderPending>("ZeroG - PipelineRenderPending");
+	res = pending->createFromFileSPIRV(*createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::zgDelete(pending);
+		return res;
+	}
+	*pendingOut = pending;
+	return ZG_SUCCESS;
+}
+
+ZG_API ZgResult zgPipelineRenderCreateFromMemorySPIRVAsync(
+	ZgPipelineRenderPending** pendingOut,
+	const ZgPipelineRenderCreateInfoMemorySPIRV* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(pendingOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderSpirv == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderSpirvSizeBytes == 0, "");
+	ZG_ARG_CHECK((createInfo->vertexShaderSpirvSizeBytes % 4) != 0, "SPIR-V size must be a multiple of 4 bytes");
+	ZG_ARG_CHECK(createInfo->common.vertexShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderSpirv == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderSpirvSizeBytes == 0, "");
+	ZG_ARG_CHECK((createInfo->pixelShaderSpirvSizeBytes % 4) != 0, "SPIR-V size must be a multiple of 4 bytes");
+	ZG_ARG_CHECK(createInfo->common.pixelShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->numSpecializationConstants > ZG_MAX_NUM_SPECIALIZATION_CONSTANTS, "Too many specialization constants specified");
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	ZgPipelineRenderPending* pending =
+		zg::zgNew<ZgPipelineRenderPending>("ZeroG - PipelineRenderPending");
+	res = pending->createFromMemorySPIRV(*createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::zgDelete(pending);
+		return res;
+	}
+	*pendingOut = pending;
+	return ZG_SUCCESS;
+}
+
+ZG_API ZgResult zgPipelineRenderCreateFromFileHLSLAsync(
+	ZgPipelineRenderPending** pendingOut,
+	const ZgPipelineRenderCreateInfoFileHLSL* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(pendingOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderPath == nullptr, "");
+	ZG_ARG_CHECK(createInfo->common.vertexShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderPath == nullptr, "");
+	ZG_ARG_CHECK(createInfo->common.pixelShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->shaderModel == ZG_SHADER_MODEL_UNDEFINED, "Must specify shader model");
+	ZG_ARG_CHECK(createInfo->numDefines > ZG_MAX_NUM_SHADER_DEFINES, "Too many defines specified");
+	for (uint32_t i = 0; i < createInfo->numDefines; i++) {
+		ZG_ARG_CHECK(createInfo->defines[i].name == nullptr, "Define names must not be null");
+	}
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	ZgPipelineRenderPending* pending =
+		zg::zgNew<ZgPipelineRenderPending>("ZeroG - PipelineRenderPending");
+	res = pending->createFromFileHLSL(*createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::zgDelete(pending);
+		return res;
+	}
+	*pendingOut = pending;
+	return ZG_SUCCESS;
+}
+
+ZG_API ZgResult zgPipelineRenderCreateFromSourceHLSLAsync(
+	ZgPipelineRenderPending** pendingOut,
+	const ZgPipelineRenderCreateInfoSourceHLSL* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(pendingOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderSrc == nullptr, "");
+	ZG_ARG_CHECK(createInfo->common.vertexShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderSrc == nullptr, "");
+	ZG_ARG_CHECK(createInfo->common.pixelShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->shaderModel == ZG_SHADER_MODEL_UNDEFINED, "Must specify shader model");
+	ZG_ARG_CHECK(createInfo->numDefines > ZG_MAX_NUM_SHADER_DEFINES, "Too many defines specified");
+	for (uint32_t i = 0; i < createInfo->numDefines; i++) {
+		ZG_ARG_CHECK(createInfo->defines[i].name == nullptr, "Define names must not be null");
+	}
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	ZgPipelineRenderPending* pending =
+		zg::zgNew<ZgPipelineRenderPending>("ZeroG - PipelineRenderPending");
+	res = pending->createFromSourceHLSL(*createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::zgDelete(pending);
+		return res;
+	}
+	*pendingOut = pending;
+	return ZG_SUCCESS;
+}
+
+ZG_API ZgResult zgPipelineRenderCreateFromMemoryDXILAsync(
+	ZgPipelineRenderPending** pendingOut,
+	const ZgPipelineRenderCreateInfoMemoryDXIL* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(pendingOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderDxil == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderDxilSizeBytes == 0, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderDxil == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderDxilSizeBytes == 0, "");
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	ZgPipelineRenderPending* pending =
+		zg::zgNew<ZgPipelineRenderPending>("ZeroG - PipelineRenderPending");
+	res = pending->createFromMemoryDXIL(*createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::zgDelete(pending);
+		return res;
+	}
+	*pendingOut = pending;
+	return ZG_SUCCESS;
+}
+
+ZG_API ZgResult zgPipelineRenderCreateFromArchiveAsync(
+	ZgPipelineRenderPending** pendingOut,
+	const ZgPipelineRenderCreateInfoArchive* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(pendingOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->archive == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pipelineName == nullptr, "");
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	ZgPipelineRenderPending* pending =
+		zg::zgNew<ZgPipelineRenderPending>("ZeroG - PipelineRenderPending");
+	res = pending->createFromArchive(*createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::zgDelete(pending);
+		return res;
+	}
+	*pendingOut = pending;
+	return ZG_SUCCESS;
+}
+
+ZG_API void zgPipelineRenderPendingRelease(
+	ZgPipelineRenderPending* pending)
+{
+	if (pending == nullptr) return;
+	zg::zgDelete(pending);
+}
+
+ZG_API ZgResult zgPipelineRenderPendingIsReady(
+	const ZgPipelineRenderPending* pending,
+	ZgBool* readyOut)
+{
+	ZG_ARG_CHECK(pending == nullptr, "");
+	ZG_ARG_CHECK(readyOut == nullptr, "");
+	*readyOut = pending->isReady() ? ZG_TRUE : ZG_FALSE;
+	return ZG_SUCCESS;
+}
+
+ZG_API ZgResult zgPipelineRenderPendingWait(
+	ZgPipelineRenderPending* pending,
+	ZgPipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut)
+{
+	ZG_ARG_CHECK(pending == nullptr, "");
+	ZG_ARG_CHECK(pipelineOut == nullptr, "");
+	ZG_ARG_CHECK(signatureOut == nullptr, "");
+	return pending->wait(pipelineOut, signatureOut);
+}
+
+// Pipeline Render - Permutations
+// ------------------------------------------------------------------------------------------------
+
+ZG_API ZgResult zgPipelineRenderPermutationsCreateFromFileSPIRV(
+	ZgPipelineRenderPermutations** permutationsOut,
+	const ZgPipelineRenderCreateInfoFileSPIRV* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(permutationsOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderPath == nullptr, "");
+	ZG_ARG_CHECK(createInfo->common.vertexShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderPath == nullptr, "");
+	ZG_ARG_CHECK(createInfo->common.pixelShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->numSpecializationConstants > ZG_MAX_NUM_SPECIALIZATION_CONSTANTS, "Too many specialization constants specified");
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	ZgPipelineRenderPermutations* permutations =
+		zg::zgNew<ZgPipelineRenderPermutations>("ZeroG - PipelineRenderPermutations");
+	res = permutations->createFromFileSPIRV(*createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::zgDelete(permutations);
+		return res;
+	}
+	*permutationsOut = permutations;
+	return ZG_SUCCESS;
+}
+
+ZG_API ZgResult zgPipelineRenderPermutationsCreateFromMemorySPIRV(
+	ZgPipelineRenderPermutations** permutationsOut,
+	const ZgPipelineRenderCreateInfoMemorySPIRV* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(permutationsOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderSpirv == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderSpirvSizeBytes == 0, "");
+	ZG_ARG_CHECK((createInfo->vertexShaderSpirvSizeBytes % 4) != 0, "SPIR-V size must be a multiple of 4 bytes");
+	ZG_ARG_CHECK(createInfo->common.vertexShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderSpirv == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderSpirvSizeBytes == 0, "");
+	ZG_ARG_CHECK((createInfo->pixelShaderSpirvSizeBytes % 4) != 0, "SPIR-V size must be a multiple of 4 bytes");
+	ZG_ARG_CHECK(createInfo->common.pixelShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->numSpecializationConstants > ZG_MAX_NUM_SPECIALIZATION_CONSTANTS, "Too many specialization constants specified");
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	ZgPipelineRenderPermutations* permutations =
+		zg::zgNew<ZgPipelineRenderPermutations>("ZeroG - PipelineRenderPermutations");
+	res = permutations->createFromMemorySPIRV(*createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::zgDelete(permutations);
+		return res;
+	}
+	*permutationsOut = permutations;
+	return ZG_SUCCESS;
+}
+
+ZG_API ZgResult zgPipelineRenderPermutationsCreateFromFileHLSL(
+	ZgPipelineRenderPermutations** permutationsOut,
+	const ZgPipelineRenderCreateInfoFileHLSL* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(permutationsOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderPath == nullptr, "");
+	ZG_ARG_CHECK(createInfo->common.vertexShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderPath == nullptr, "");
+	ZG_ARG_CHECK(createInfo->common.pixelShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->shaderModel == ZG_SHADER_MODEL_UNDEFINED, "Must specify shader model");
+	ZG_ARG_CHECK(createInfo->numDefines > ZG_MAX_NUM_SHADER_DEFINES, "Too many defines specified");
+	for (uint32_t i = 0; i < createInfo->numDefines; i++) {
+		ZG_ARG_CHECK(createInfo->defines[i].name == nullptr, "Define names must not be null");
+	}
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	ZgPipelineRenderPermutations* permutations =
+		zg::zgNew<ZgPipelineRenderPermutations>("ZeroG - PipelineRenderPermutations");
+	res = permutations->createFromFileHLSL(*createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::zgDelete(permutations);
+		return res;
+	}
+	*permutationsOut = permutations;
+	return ZG_SUCCESS;
+}
+
+ZG_API ZgResult zgPipelineRenderPermutationsCreateFromSourceHLSL(
+	ZgPipelineRenderPermutations** permutationsOut,
+	const ZgPipelineRenderCreateInfoSourceHLSL* createInfo)
+{
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(permutationsOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo->vertexShaderSrc == nullptr, "");
+	ZG_ARG_CHECK(createInfo->common.vertexShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->pixelShaderSrc == nullptr, "");
+	ZG_ARG_CHECK(createInfo->common.pixelShaderEntry == nullptr, "");
+	ZG_ARG_CHECK(createInfo->shaderModel == ZG_SHADER_MODEL_UNDEFINED, "Must specify shader model");
+	ZG_ARG_CHECK(createInfo->numDefines > ZG_MAX_NUM_SHADER_DEFINES, "Too many defines specified");
+	for (uint32_t i = 0; i < createInfo->numDefines; i++) {
+		ZG_ARG_CHECK(createInfo->defines[i].name == nullptr, "Define names must not be null");
+	}
+	ZgResult res = validatePipelineRenderCommon(createInfo->common);
+	if (res != ZG_SUCCESS) return res;
+
+	ZgPipelineRenderPermutations* permutations =
+		zg::zgNew<ZgPipelineRenderPermutations>("ZeroG - PipelineRenderPermutations");
+	res = permutations->createFromSourceHLSL(*createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::zgDelete(permutations);
+		return res;
+	}
+	*permutationsOut = permutations;
+	return ZG_SUCCESS;
+}
+
+ZG_API void zgPipelineRenderPermutationsRelease(
+	ZgPipelineRenderPermutations* permutations)
+{
+	if (permutations == nullptr) return;
+	zg::zgDelete(permutations);
+}
+
+ZG_API ZgResult zgPipelineRenderPermutationsGet(
+	ZgPipelineRenderPermutations* permutations,
+	const ZgPipelineRenderPermutation* permutation,
+	ZgPipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut)
+{
+	ZG_ARG_CHECK(permutations == nullptr, "");
+	ZG_ARG_CHECK(pipelineOut == nullptr, "");
+	ZG_ARG_CHECK(signatureOut == nullptr, "");
+	if (permutation != nullptr) {
+		ZG_ARG_CHECK(permutation->numDefines > ZG_MAX_NUM_SHADER_DEFINES, "Too many defines specified");
+		ZG_ARG_CHECK(permutation->numSpecializationConstants > ZG_MAX_NUM_SPECIALIZATION_CONSTANTS, "Too many specialization constants specified");
+		for (uint32_t i = 0; i < permutation->numDefines; i++) {
+			ZG_ARG_CHECK(permutation->defines[i].name == nullptr, "Define names must not be null");
+		}
+	}
+	return permutations->get(permutation, pipelineOut, signatureOut);
+}
+
+ZG_API ZgResult zgPipelineRenderPermutationsGetStats(
+	ZgPipelineRenderPermutations* permutations,
+	ZgPipelineRenderPermutationsStats* statsOut)
+{
+	ZG_ARG_CHECK(permutations == nullptr, "");
+	ZG_ARG_CHECK(statsOut == nullptr, "");
+	*statsOut = permutations->stats();
+	return ZG_SUCCESS;
+}
+
 // Memory Heap
 // ------------------------------------------------------------------------------------------------
 
@@ -327,6 +917,7 @@ ZG_API ZgResult zgMemoryHeapCreate(
 {
 	ZG_ARG_CHECK(createInfo == nullptr, "");
 	ZG_ARG_CHECK(createInfo->sizeInBytes == 0, "Can't create an empty memory heap");
+	ZG_ARG_CHECK(createInfo->residencyPriority > ZG_RESIDENCY_PRIORITY_HIGH, "Invalid residency priority");
 
 	return zg::getBackend()->memoryHeapCreate(memoryHeapOut, *createInfo);
 }
@@ -337,6 +928,24 @@ ZG_API ZgResult zgMemoryHeapRelease(
 	return zg::getBackend()->memoryHeapRelease(memoryHeap);
 }
 
+ZG_API ZgResult zgMemoryHeapSetResidencyPriority(
+	ZgMemoryHeap* memoryHeap,
+	ZgResidencyPriority priority)
+{
+	ZG_ARG_CHECK(memoryHeap == nullptr, "");
+	ZG_ARG_CHECK(priority > ZG_RESIDENCY_PRIORITY_HIGH, "Invalid residency priority");
+	return zg::getBackend()->memoryHeapSetResidencyPriority(memoryHeap, priority);
+}
+
+ZG_API ZgResult zgMemoryHeapGetStats(
+	ZgMemoryHeap* memoryHeap,
+	ZgMemoryHeapStats* statsOut)
+{
+	ZG_ARG_CHECK(memoryHeap == nullptr, "");
+	ZG_ARG_CHECK(statsOut == nullptr, "");
+	return memoryHeap->getStats(*statsOut);
+}
+
 // Buffer
 // ------------------------------------------------------------------------------------------------
 
@@ -379,6 +988,55 @@ ZG_API ZgResult zgBufferSetDebugName(
 	return buffer->setDebugName(name);
 }
 
+ZG_API ZgResult zgBufferReadFile(
+	ZgBuffer* dstBuffer,
+	uint64_t bufferOffsetBytes,
+	const char* path,
+	uint64_t fileOffsetBytes,
+	uint64_t numBytes,
+	ZgFileRead** fileReadOut)
+{
+	ZG_ARG_CHECK(dstBuffer == nullptr, "");
+	ZG_ARG_CHECK(path == nullptr, "");
+	ZG_ARG_CHECK(fileReadOut == nullptr, "");
+
+	// Read rest of file if no size is specified
+	if (numBytes == 0) {
+		uint64_t fileSize = zg::fileSize(path);
+		ZG_ARG_CHECK(fileSize <= fileOffsetBytes, "File offset is outside the file");
+		numBytes = fileSize - fileOffsetBytes;
+	}
+
+	return zg::getBackend()->bufferReadFile(
+		dstBuffer, bufferOffsetBytes, path, fileOffsetBytes, numBytes, fileReadOut);
+}
+
+ZG_API void zgFileReadRelease(
+	ZgFileRead* fileRead)
+{
+	if (fileRead == nullptr) return;
+	zg::zgDelete(fileRead);
+}
+
+ZG_API ZgResult zgFileReadCheckIfDone(
+	ZgFileRead* fileRead,
+	ZgBool* doneOut)
+{
+	ZG_ARG_CHECK(fileRead == nullptr, "");
+	ZG_ARG_CHECK(doneOut == nullptr, "");
+	bool done = false;
+	ZgResult res = fileRead->checkIfDone(done);
+	*doneOut = done ? ZG_TRUE : ZG_FALSE;
+	return res;
+}
+
+ZG_API ZgResult zgFileReadWaitOnCpuBlocking(
+	ZgFileRead* fileRead)
+{
+	ZG_ARG_CHECK(fileRead == nullptr, "");
+	return fileRead->waitOnCpuBlocking();
+}
+
 // Textures
 // ------------------------------------------------------------------------------------------------
 
@@ -408,6 +1066,24 @@ ZG_API ZgResult zgMemoryHeapTexture2DCreate(
 	return memoryHeap->texture2DCreate(textureOut, *createInfo);
 }
 
+ZG_API ZgResult zgTexture2DCalculateTransientPlacement(
+	ZgTransientTexture2D* textures,
+	uint32_t numTextures,
+	uint64_t* heapSizeInBytesOut)
+{
+	ZG_ARG_CHECK(textures == nullptr && numTextures != 0, "");
+	ZG_ARG_CHECK(heapSizeInBytesOut == nullptr, "");
+	for (uint32_t i = 0; i < numTextures; i++) {
+		const ZgTransientTexture2D& texture = textures[i];
+		ZG_ARG_CHECK(texture.createInfo.usage == ZG_TEXTURE_USAGE_DEFAULT,
+			"Transient textures must be render targets or depth buffers");
+		ZG_ARG_CHECK(texture.createInfo.numMipmaps == 0, "Must specify at least 1 mipmap layer (i.e. the full image)");
+		ZG_ARG_CHECK(texture.createInfo.numMipmaps > ZG_MAX_NUM_MIPMAPS, "Too many mipmaps specified");
+		ZG_ARG_CHECK(texture.firstPassIdx > texture.lastPassIdx, "First pass must not be after last pass");
+	}
+	return zg::calculateTransientPlacement(textures, numTextures, *heapSizeInBytesOut);
+}
+
 ZG_API void zgTexture2DRelease(
 	ZgTexture2D* texture)
 {
@@ -424,6 +1100,42 @@ ZG_API ZgResult zgTexture2DSetDebugName(
 	return texture->setDebugName(name);
 }
 
+// Validates the CPU images of a mip chain to be uploaded to a texture
+static ZgResult validateMipChainImages(const ZgImageViewConstCpu* images, uint32_t numMipLevels)
+{
+	ZG_ARG_CHECK(images == nullptr, "");
+	ZG_ARG_CHECK(numMipLevels == 0, "Must upload at least one mip level");
+	ZG_ARG_CHECK(numMipLevels > ZG_MAX_NUM_MIPMAPS, "Too many mip levels");
+	for (uint32_t i = 0; i < numMipLevels; i++) {
+		ZG_ARG_CHECK(images[i].data == nullptr, "");
+		ZG_ARG_CHECK(images[i].width == 0, "");
+		ZG_ARG_CHECK(images[i].height == 0, "");
+		ZG_ARG_CHECK(images[i].pitchInBytes < images[i].width, "");
+	}
+	return ZG_SUCCESS;
+}
+
+// Bindless
+// ------------------------------------------------------------------------------------------------
+
+ZG_API ZgResult zgBufferGetBindlessIndex(
+	const ZgBuffer* buffer,
+	uint32_t* indexOut)
+{
+	ZG_ARG_CHECK(buffer == nullptr, "");
+	ZG_ARG_CHECK(indexOut == nullptr, "");
+	return buffer->getBindlessIndex(*indexOut);
+}
+
+ZG_API ZgResult zgTexture2DGetBindlessIndex(
+	const ZgTexture2D* texture,
+	uint32_t* indexOut)
+{
+	ZG_ARG_CHECK(texture == nullptr, "");
+	ZG_ARG_CHECK(indexOut == nullptr, "");
+	return texture->getBindlessIndex(*indexOut);
+}
+
 // Framebuffer
 // ------------------------------------------------------------------------------------------------
 
@@ -580,6 +1292,26 @@ ZG_API ZgResult zgCommandListMemcpyToTexture(
 		tempUploadBuffer);
 }
 
+ZG_API ZgResult zgCommandListMemcpyToTextureMipChain(
+	ZgCommandList* commandList,
+	ZgTexture2D* dstTexture,
+	const ZgImageViewConstCpu* srcImagesCpu,
+	uint32_t numMipLevels,
+	ZgBuffer* tempUploadBuffer,
+	uint64_t tempUploadBufferOffsetBytes)
+{
+	ZG_ARG_CHECK((tempUploadBufferOffsetBytes % ZG_TEXTURE_UPLOAD_ALIGNMENT) != 0,
+		"Upload buffer offset must be a multiple of ZG_TEXTURE_UPLOAD_ALIGNMENT");
+	ZgResult res = validateMipChainImages(srcImagesCpu, numMipLevels);
+	if (res != ZG_SUCCESS) return res;
+	return commandList->memcpyToTextureMipChain(
+		dstTexture,
+		srcImagesCpu,
+		numMipLevels,
+		tempUploadBuffer,
+		tempUploadBufferOffsetBytes);
+}
+
 ZG_API ZgResult zgCommandListEnableQueueTransitionBuffer(
 	ZgCommandList* commandList,
 	ZgBuffer* buffer)
@@ -594,6 +1326,14 @@ ZG_API ZgResult zgCommandListEnableQueueTransitionTexture(
 	return commandList->enableQueueTransitionTexture(texture);
 }
 
+ZG_API ZgResult zgCommandListActivateTransientTexture(
+	ZgCommandList* commandList,
+	ZgTexture2D* texture)
+{
+	ZG_ARG_CHECK(texture == nullptr, "");
+	return commandList->activateTransientTexture(texture);
+}
+
 ZG_API ZgResult zgCommandListSetPushConstant(
 	ZgCommandList* commandList,
 	uint32_t shaderRegister,
@@ -604,6 +1344,17 @@ ZG_API ZgResult zgCommandListSetPushConstant(
 	return commandList->setPushConstant(shaderRegister, data, dataSizeInBytes);
 }
 
+ZG_API ZgResult zgCommandListSetRootConstantBuffer(
+	ZgCommandList* commandList,
+	uint32_t shaderRegister,
+	ZgBuffer* buffer,
+	uint64_t offsetInBytes)
+{
+	ZG_ARG_CHECK(buffer == nullptr, "");
+	ZG_ARG_CHECK((offsetInBytes % ZG_ROOT_CONSTANT_BUFFER_ALIGNMENT) != 0, "Offset must be 256 byte aligned");
+	return commandList->setRootConstantBuffer(shaderRegister, buffer, offsetInBytes);
+}
+
 ZG_API ZgResult zgCommandListSetPipelineBindings(
 	ZgCommandList* commandList,
 	const ZgPipelineBindings* bindings)
@@ -611,6 +1362,18 @@ ZG_API ZgResult zgCommandListSetPipelineBindings(
 	return commandList->setPipelineBindings(*bindings);
 }
 
+ZG_API ZgResult zgCommandListUseBindlessResources(
+	ZgCommandList* commandList,
+	ZgBuffer* const* buffers,
+	uint32_t numBuffers,
+	ZgTexture2D* const* textures,
+	uint32_t numTextures)
+{
+	ZG_ARG_CHECK(numBuffers != 0 && buffers == nullptr, "");
+	ZG_ARG_CHECK(numTextures != 0 && textures == nullptr, "");
+	return commandList->useBindlessResources(buffers, numBuffers, textures, numTextures);
+}
+
 ZG_API ZgResult zgCommandListSetPipelineRender(
 	ZgCommandList* commandList,
 	ZgPipelineRender* pipeline)
@@ -697,3 +1460,65 @@ ZG_API ZgResult zgCommandListDrawTrianglesIndexed(
 {
 	return commandList->drawTrianglesIndexed(startIndex, numTriangles);
 }
+
+// Texture streamer
+// ------------------------------------------------------------------------------------------------
+
+ZG_API ZgResult zgTextureStreamerCreate(
+	ZgTextureStreamer** streamerOut,
+	const ZgTextureStreamerCreateInfo* createInfo)
+{
+	ZG_ARG_CHECK(streamerOut == nullptr, "");
+	ZG_ARG_CHECK(createInfo == nullptr, "");
+	ZG_ARG_CHECK(createInfo->uploadRingSizeInBytes == 0, "Can't create an empty upload ring");
+	ZG_ARG_CHECK((createInfo->uploadRingSizeInBytes % ZG_TEXTURE_UPLOAD_ALIGNMENT) != 0,
+		"Upload ring size must be a multiple of ZG_TEXTURE_UPLOAD_ALIGNMENT");
+	ZG_ARG_CHECK(createInfo->maxNumRequests == 0, "");
+	ZG_ARG_CHECK(createInfo->maxNumBatchesInFlight == 0, "");
+
+	ZgTextureStreamer* streamer = zg::zgNew<ZgTextureStreamer>("ZeroG - TextureStreamer");
+	ZgResult res = streamer->create(*createInfo);
+	if (res != ZG_SUCCESS) {
+		zg::zgDelete(streamer);
+		return res;
+	}
+
+	*streamerOut = streamer;
+	return ZG_SUCCESS;
+}
+
+ZG_API void zgTextureStreamerRelease(
+	ZgTextureStreamer* streamer)
+{
+	if (streamer == nullptr) return;
+	zg::zgDelete(streamer);
+}
+
+ZG_API ZgResult zgTextureStreamerRequest(
+	ZgTextureStreamer* streamer,
+	const ZgTextureStreamRequest* request,
+	uint64_t* requestIdOut)
+{
+	ZG_ARG_CHECK(streamer == nullptr, "");
+	ZG_ARG_CHECK(request == nullptr, "");
+	ZG_ARG_CHECK(requestIdOut == nullptr, "");
+	ZG_ARG_CHECK(request->texture == nullptr, "");
+	ZG_ARG_CHECK(request->uploadSizeInBytes == 0, "Must specify upload size of texture");
+
+	// Validated here since the images are only used later, on the streaming thread
+	ZgResult res = validateMipChainImages(request->mipLevels, request->numMipLevels);
+	if (res != ZG_SUCCESS) return res;
+	return streamer->request(*request, *requestIdOut);
+}
+
+ZG_API ZgResult zgTextureStreamerGetCompleted(
+	ZgTextureStreamer* streamer,
+	ZgTextureStreamCompletion* completionsOut,
+	uint32_t maxNumCompletions,
+	uint32_t* numCompletionsOut)
+{
+	ZG_ARG_CHECK(streamer == nullptr, "");
+	ZG_ARG_CHECK(completionsOut == nullptr, "");
+	ZG_ARG_CHECK(numCompletionsOut == nullptr, "");
+	return streamer->getCompleted(completionsOut, maxNumCompletions, *numCompletionsOut);
+}
@@ -27,8 +27,11 @@
 #include "ZeroG/d3d12/D3D12Framebuffer.hpp"
 #include "ZeroG/d3d12/D3D12MemoryHeap.hpp"
 #include "ZeroG/d3d12/D3D12PipelineRender.hpp"
+#include "ZeroG/d3d12/D3D12RootSignatureCache.hpp"
 #include "ZeroG/d3d12/D3D12Textures.hpp"
 #include "ZeroG/util/CpuAllocation.hpp"
+#include "ZeroG/util/SmallVector.hpp"
+#include "ZeroG/ResidencyPolicy.hpp"
 
 namespace zg {
 
@@ -37,18 +40,44 @@ namespace zg {
 
 constexpr uint32_t NUM_SWAP_CHAIN_BUFFERS = 3;
 
+constexpr uint32_t RESIDENCY_QUEUE_IDX_PRESENT = 0;
+constexpr uint32_t RESIDENCY_QUEUE_IDX_COPY = 1;
+
+static bool countsTowardsLocalBudget(ZgMemoryType memoryType) noexcept
+{
+	return memoryType == ZG_MEMORY_TYPE_DEVICE
+		|| memoryType == ZG_MEMORY_TYPE_TEXTURE
+		|| memoryType == ZG_MEMORY_TYPE_FRAMEBUFFER;
+}
+
 // D3D12 Backend State
 // ------------------------------------------------------------------------------------------------
 
+// A DXC compiler may only be used by one thread at a time, so pipelines created concurrently
+// (e.g. asynchronously on the job system) each use their own instance
+struct D3D12DxcInstance final {
+	ComPtr<IDxcLibrary> library;
+	ComPtr<IDxcCompiler> compiler;
+	IDxcIncludeHandler* includeHandler = nullptr;
+	bool inUse = false;
+};
+
+// A pipeline whose shaders were replaced by shader hot-reload, holding the old shaders until every
+// queue has passed its fence value
+struct D3D12RetiredPipeline final {
+	D3D12PipelineRender* pipeline = nullptr;
+	uint64_t presentFenceValue = 0;
+	uint64_t copyFenceValue = 0;
+};
+
 // We keep a separate state in order to create an easy way to control the order things are
 // destroyed in. E.g., we would like to destroy everything but the absolute minimal required in
 // order to check check for dangling objects using ReportLiveObjects.
 struct D3D12BackendState final {
 
-	// DXC compiler DLLs, lazily loaded if needed
-	ComPtr<IDxcLibrary> dxcLibrary;
-	ComPtr<IDxcCompiler> dxcCompiler;
-	IDxcIncludeHandler* dxcIncludeHandler = nullptr;
+	// DXC compiler instances, lazily created if needed
+	std::mutex dxcMutex;
+	SmallVector<D3D12DxcInstance*, 4> dxcInstances;
 
 	// Device
 	ComPtr<IDXGIAdapter4> dxgiAdapter;
@@ -63,9 +92,18 @@ struct D3D12BackendState final {
 	// Residency manager
 	D3DX12Residency::ResidencyManager residencyManager;
 
+	// Residency policy, decides which heaps to proactively evict when close to memory budget
+	ResidencyPolicy residencyPolicy;
+
 	// Global descriptor ring buffers
 	D3D12DescriptorRingBuffer globalDescriptorRingBuffer;
 
+	// Root signatures shared between pipelines
+	D3D12RootSignatureCache rootSignatureCache;
+
+	// Pipelines replaced by shader hot-reload, protected by the context mutex
+	SmallVector<D3D12RetiredPipeline, 0> retiredPipelines;
+
 	// Command queues
 	D3D12CommandQueue commandQueuePresent;
 	//D3D12CommandQueue commandQueueAsyncCompute;
@@ -85,6 +123,27 @@ struct D3D12BackendState final {
 	std::atomic_uint64_t resourceUniqueIdentifierCounter = 1;
 };
 
+// Evicts a heap on request of the residency policy
+static void evictHeap(void* userPtr, ZgMemoryHeap* heapIn) noexcept
+{
+	D3D12BackendState& state = *reinterpret_cast<D3D12BackendState*>(userPtr);
+	D3D12MemoryHeap& heap = *static_cast<D3D12MemoryHeap*>(heapIn);
+
+	// D3DX12Residency has no way to evict a specific object. But it checks the residency status
+	// of every object in a residency set when it is executed, and makes evicted objects resident
+	// again. So we stop tracking the heap, evict it ourselves and then start tracking it again,
+	// now as evicted.
+	state.residencyManager.EndTrackingObject(&heap.managedObject);
+	if (heap.managedObject.ResidencyStatus ==
+		D3DX12Residency::ManagedObject::RESIDENCY_STATUS::RESIDENT) {
+		ID3D12Pageable* pageable = heap.heap.Get();
+		CHECK_D3D12 state.device->Evict(1, &pageable);
+		heap.managedObject.ResidencyStatus =
+			D3DX12Residency::ManagedObject::RESIDENCY_STATUS::EVICTED;
+	}
+	state.residencyManager.BeginTrackingObject(&heap.managedObject);
+}
+
 // D3D12 Backend implementation
 // ------------------------------------------------------------------------------------------------
 
@@ -105,12 +164,20 @@ public:
 		mState->commandQueuePresent.flush();
 		mState->commandQueueCopy.flush();
 
-		// Release include handler
+		// Release pipelines replaced by shader hot-reload, the GPU is done with all of them
+		for (uint32_t i = 0; i < mState->retiredPipelines.size(); i++) {
+			zgDelete(mState->retiredPipelines[i].pipeline);
+		}
+		mState->retiredPipelines.destroy();
+
+		// Release DXC compiler instances
 		// TODO: Probably correct...?
-		if (mState->dxcIncludeHandler != nullptr) {
-			mState->dxcIncludeHandler->Release();
-			mState->dxcIncludeHandler = nullptr;
+		for (uint32_t i = 0; i < mState->dxcInstances.size(); i++) {
+			D3D12DxcInstance* dxc = mState->dxcInstances[i];
+			if (dxc->includeHandler != nullptr) dxc->includeHandler->Release();
+			zgDelete(dxc);
 		}
+		mState->dxcInstances.destroy();
 
 		// Destroy residency manager (which apparently has to be done manually...)
 		mState->residencyManager.Destroy();
@@ -272,41 +339,55 @@ public:
 			return ZG_ERROR_GENERIC;
 		}
 
+		// Create residency policy
+		{
+			ZgResult res = mState->residencyPolicy.create(settings.residency, evictHeap, mState);
+			if (res != ZG_SUCCESS) return res;
+		}
+
+		// Bindless needs unbounded descriptor tables covering the whole bindless region
+		if (settings.descriptors.numBindlessDescriptors != 0) {
+			D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+			CHECK_D3D12 mState->device->CheckFeatureSupport(
+				D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options));
+			if (options.ResourceBindingTier < D3D12_RESOURCE_BINDING_TIER_2) {
+				ZG_ERROR("Bindless resources require resource binding tier 2");
+				return ZG_ERROR_NO_SUITABLE_DEVICE;
+			}
+		}
+
 		// Allocate descriptors
-		const uint32_t NUM_DESCRIPTORS = 1000000;
-		ZG_INFO("Attempting to allocate %u descriptors for the global ring buffer",
-			NUM_DESCRIPTORS);
 		{
-			ZgResult res = mState->globalDescriptorRingBuffer.create(
-				*mState->device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, NUM_DESCRIPTORS);
+			ZgResult res = mState->globalDescriptorRingBuffer.create(*mState->device.Get(),
+				D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, settings.descriptors);
 			if (res != ZG_SUCCESS) {
 				ZG_ERROR("Failed to allocate descriptors");
-				return ZG_ERROR_GPU_OUT_OF_MEMORY;
+				return res;
 			}
 		}
 
 		// Create command queue
 		const uint32_t MAX_NUM_COMMAND_LISTS_SWAPCHAIN_QUEUE = 256;
-		const uint32_t MAX_NUM_BUFFERS_PER_COMMAND_LIST_SWAPCHAIN_QUEUE = 1024;
 		ZgResult res = mState->commandQueuePresent.create(
 			D3D12_COMMAND_LIST_TYPE_DIRECT,
 			mState->device,
 			&mState->residencyManager,
+			&mState->residencyPolicy,
+			RESIDENCY_QUEUE_IDX_PRESENT,
 			&mState->globalDescriptorRingBuffer,
-			MAX_NUM_COMMAND_LISTS_SWAPCHAIN_QUEUE,
-			MAX_NUM_BUFFERS_PER_COMMAND_LIST_SWAPCHAIN_QUEUE);
+			MAX_NUM_COMMAND_LISTS_SWAPCHAIN_QUEUE);
 		if (res != ZG_SUCCESS) return res;
 
 		// Create copy queue
 		const uint32_t MAX_NUM_COMMAND_LISTS_COPY_QUEUE = 128;
-		const uint32_t MAX_NUM_BUFFERS_PER_COMMAND_LIST_COPY_QUEUE = 1024;
 		res = mState->commandQueueCopy.create(
 			D3D12_COMMAND_LIST_TYPE_COPY,
 			mState->device,
 			&mState->residencyManager,
+			&mState->residencyPolicy,
+			RESIDENCY_QUEUE_IDX_COPY,
 			&mState->globalDescriptorRingBuffer,
-			MAX_NUM_COMMAND_LISTS_COPY_QUEUE,
-			MAX_NUM_BUFFERS_PER_COMMAND_LIST_COPY_QUEUE);
+			MAX_NUM_COMMAND_LISTS_COPY_QUEUE);
 		if (res != ZG_SUCCESS) return res;
 		
 
@@ -514,8 +595,38 @@ public:
 	ZgResult swapchainBeginFrame(
 		ZgFramebuffer** framebufferOut) noexcept override final
 	{
+		// Run residency policy, outside context mutex because the user's eviction callback is
+		// called from it.
+		if (mState->residencyPolicy.isEnabled()) {
+			DXGI_QUERY_VIDEO_MEMORY_INFO memoryInfo = {};
+			CHECK_D3D12 mState->dxgiAdapter->QueryVideoMemoryInfo(
+				0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &memoryInfo);
+			uint64_t completedFenceValues[RESIDENCY_POLICY_MAX_NUM_QUEUES] = {};
+			completedFenceValues[RESIDENCY_QUEUE_IDX_PRESENT] =
+				mState->commandQueuePresent.completedFenceValue();
+			completedFenceValues[RESIDENCY_QUEUE_IDX_COPY] =
+				mState->commandQueueCopy.completedFenceValue();
+			mState->residencyPolicy.newFrame(
+				memoryInfo.Budget, memoryInfo.CurrentUsage, completedFenceValues);
+		}
+
 		std::lock_guard<std::mutex> lock(mContextMutex);
 
+		// Release pipelines replaced by shader hot-reload which the GPU is done with
+		uint64_t completedPresentFenceValue = mState->commandQueuePresent.completedFenceValue();
+		uint64_t completedCopyFenceValue = mState->commandQueueCopy.completedFenceValue();
+		for (uint32_t i = 0; i < mState->retiredPipelines.size();) {
+			const D3D12RetiredPipeline& retired = mState->retiredPipelines[i];
+			if (retired.presentFenceValue <= completedPresentFenceValue &&
+				retired.copyFenceValue <= completedCopyFenceValue) {
+				zgDelete(mState->retiredPipelines[i].pipeline);
+				mState->retiredPipelines.remove(i);
+			}
+			else {
+				i++;
+			}
+		}
+
 		// Retrieve current back buffer to be rendered to
 		D3D12Framebuffer& backBuffer = mState->swapchainFramebuffers[mState->currentBackBufferIdx];
 
@@ -614,6 +725,16 @@ public:
 		statsOut.nonLocalBugetBytes = memoryInfoNonLocal.Budget;
 		statsOut.nonLocalUsageBytes = memoryInfoNonLocal.CurrentUsage;
 
+		// Set residency policy stats
+		ResidencyCounters residencyCounters = mState->residencyPolicy.lastFrameCounters();
+		statsOut.numHeapsEvicted = residencyCounters.numHeapsEvicted;
+		statsOut.numHeapsMadeResident = residencyCounters.numHeapsMadeResident;
+		statsOut.bytesEvicted = residencyCounters.bytesEvicted;
+		statsOut.bytesMadeResident = residencyCounters.bytesMadeResident;
+
+		// Set descriptor stats
+		mState->globalDescriptorRingBuffer.getStats(statsOut);
+
 		return ZG_SUCCESS;
 	}
 
@@ -625,9 +746,10 @@ public:
 		ZgPipelineRenderSignature* signatureOut,
 		const ZgPipelineRenderCreateInfoFileSPIRV& createInfo) noexcept override final
 	{
-		// Initialize DXC compiler if necessary
+		// Grab a DXC compiler, creating one if necessary
+		D3D12DxcInstance* dxc = nullptr;
 		{
-			ZgResult res = initializeDxcCompiler();
+			ZgResult res = acquireDxcInstance(dxc);
 			if (res != ZG_SUCCESS) return res;
 		}
 		
@@ -637,24 +759,57 @@ public:
 			&d3d12pipeline,
 			signatureOut,
 			createInfo,
-			*mState->dxcLibrary.Get(),
-			*mState->dxcCompiler.Get(),
-			mState->dxcIncludeHandler,
+			*dxc->library.Get(),
+			*dxc->compiler.Get(),
+			dxc->includeHandler,
+			mState->rootSignatureCache,
 			*mState->device.Get());
+		releaseDxcInstance(dxc);
 		if (res != ZG_SUCCESS) return res;
 		
 		*pipelineOut = d3d12pipeline;
 		return res;
 	}
 
+	ZgResult pipelineRenderCreateFromMemorySPIRV(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept override final
+	{
+		// Grab a DXC compiler, creating one if necessary
+		D3D12DxcInstance* dxc = nullptr;
+		{
+			ZgResult res = acquireDxcInstance(dxc);
+			if (res != ZG_SUCCESS) return res;
+		}
+
+		// Create pipeline
+		D3D12PipelineRender* d3d12pipeline = nullptr;
+		ZgResult res = createPipelineRenderMemorySPIRV(
+			&d3d12pipeline,
+			signatureOut,
+			createInfo,
+			*dxc->library.Get(),
+			*dxc->compiler.Get(),
+			dxc->includeHandler,
+			mState->rootSignatureCache,
+			*mState->device.Get());
+		releaseDxcInstance(dxc);
+		if (res != ZG_SUCCESS) return res;
+
+		*pipelineOut = d3d12pipeline;
+		return res;
+	}
+
 	ZgResult pipelineRenderCreateFromFileHLSL(
 		ZgPipelineRender** pipelineOut,
 		ZgPipelineRenderSignature* signatureOut,
 		const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept override final
 	{
-		// Initialize DXC compiler if necessary
+		// Grab a DXC compiler, creating one if necessary
+		D3D12DxcInstance* dxc = nullptr;
 		{
-			ZgResult res = initializeDxcCompiler();
+			ZgResult res = acquireDxcInstance(dxc);
 			if (res != ZG_SUCCESS) return res;
 		}
 		
@@ -664,10 +819,12 @@ public:
 			&d3d12pipeline,
 			signatureOut,
 			createInfo,
-			*mState->dxcLibrary.Get(),
-			*mState->dxcCompiler.Get(),
-			mState->dxcIncludeHandler,
+			*dxc->library.Get(),
+			*dxc->compiler.Get(),
+			dxc->includeHandler,
+			mState->rootSignatureCache,
 			*mState->device.Get());
+		releaseDxcInstance(dxc);
 		if (res != ZG_SUCCESS) return res;
 		
 		*pipelineOut = d3d12pipeline;
@@ -679,9 +836,10 @@ public:
 		ZgPipelineRenderSignature* signatureOut,
 		const ZgPipelineRenderCreateInfoSourceHLSL& createInfo) noexcept override final
 	{
-		// Initialize DXC compiler if necessary
+		// Grab a DXC compiler, creating one if necessary
+		D3D12DxcInstance* dxc = nullptr;
 		{
-			ZgResult res = initializeDxcCompiler();
+			ZgResult res = acquireDxcInstance(dxc);
 			if (res != ZG_SUCCESS) return res;
 		}
 		
@@ -691,16 +849,78 @@ public:
 			&d3d12pipeline,
 			signatureOut,
 			createInfo,
-			*mState->dxcLibrary.Get(),
-			*mState->dxcCompiler.Get(),
-			mState->dxcIncludeHandler,
+			*dxc->library.Get(),
+			*dxc->compiler.Get(),
+			dxc->includeHandler,
+			mState->rootSignatureCache,
 			*mState->device.Get());
+		releaseDxcInstance(dxc);
 		if (res != ZG_SUCCESS) return res;
 		
 		*pipelineOut = d3d12pipeline;
 		return res;
 	}
 
+	ZgResult pipelineRenderCreateFromMemoryDXIL(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoMemoryDXIL& createInfo) noexcept override final
+	{
+		// Grab a DXC compiler, creating one if necessary
+		D3D12DxcInstance* dxc = nullptr;
+		{
+			ZgResult res = acquireDxcInstance(dxc);
+			if (res != ZG_SUCCESS) return res;
+		}
+
+		// Create pipeline
+		D3D12PipelineRender* d3d12pipeline = nullptr;
+		ZgResult res = createPipelineRenderMemoryDXIL(
+			&d3d12pipeline,
+			signatureOut,
+			createInfo,
+			*dxc->library.Get(),
+			mState->rootSignatureCache,
+			*mState->device.Get());
+		releaseDxcInstance(dxc);
+		if (res != ZG_SUCCESS) return res;
+
+		*pipelineOut = d3d12pipeline;
+		return res;
+	}
+
+	ZgResult pipelineRenderCreateFromArchive(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoCommon& createInfo,
+		const ShaderArchivePipeline& pipeline) noexcept override final
+	{
+		// Grab a DXC compiler, creating one if necessary
+		D3D12DxcInstance* dxc = nullptr;
+		{
+			ZgResult res = acquireDxcInstance(dxc);
+			if (res != ZG_SUCCESS) return res;
+		}
+
+		// Create pipeline
+		D3D12PipelineRender* d3d12pipeline = nullptr;
+		ZgResult res = createPipelineRenderArchive(
+			&d3d12pipeline,
+			signatureOut,
+			createInfo,
+			pipeline,
+			*dxc->library.Get(),
+			*dxc->compiler.Get(),
+			dxc->includeHandler,
+			mState->rootSignatureCache,
+			*mState->device.Get());
+		releaseDxcInstance(dxc);
+		if (res != ZG_SUCCESS) return res;
+
+		*pipelineOut = d3d12pipeline;
+		return res;
+	}
+
 	ZgResult pipelineRenderRelease(
 		ZgPipelineRender* pipeline) noexcept override final
 	{
@@ -709,6 +929,41 @@ public:
 		return ZG_SUCCESS;
 	}
 
+	ZgResult pipelineRenderReplace(
+		ZgPipelineRender* pipelineIn,
+		ZgPipelineRender* replacementIn) noexcept override final
+	{
+		D3D12PipelineRender* pipeline = reinterpret_cast<D3D12PipelineRender*>(pipelineIn);
+		D3D12PipelineRender* replacement = reinterpret_cast<D3D12PipelineRender*>(replacementIn);
+
+		std::lock_guard<std::mutex> lock(mContextMutex);
+
+		// The pipeline is swapped in place, which is only safe if no command list is reading it
+		// while doing so. Render pipelines can only be set on the present queue, so the swap is
+		// postponed if any command lists are being recorded on it. Holding its lock prevents new
+		// ones from being started until the swap is done.
+		{
+			std::unique_lock<std::mutex> queueLock =
+				mState->commandQueuePresent.lockIfNotRecording();
+			if (!queueLock.owns_lock()) return ZG_WARNING_GENERIC;
+			pipeline->swap(*replacement);
+		}
+
+		// After swapping the replacement holds the old shaders. Command lists which have already
+		// been executed may still use them, so keep them until every queue has finished all work
+		// submitted so far.
+		D3D12RetiredPipeline retired;
+		retired.pipeline = replacement;
+		retired.presentFenceValue = mState->commandQueuePresent.signalOnGpuInternal();
+		retired.copyFenceValue = mState->commandQueueCopy.signalOnGpuInternal();
+		if (!mState->retiredPipelines.add(retired)) {
+			mState->commandQueuePresent.waitOnCpuInternal(retired.presentFenceValue);
+			mState->commandQueueCopy.waitOnCpuInternal(retired.copyFenceValue);
+			zgDelete(replacement);
+		}
+		return ZG_SUCCESS;
+	}
+
 	ZgResult pipelineRenderGetSignature(
 		const ZgPipelineRender* pipelineIn,
 		ZgPipelineRenderSignature* signatureOut) const noexcept override final
@@ -719,6 +974,16 @@ public:
 		return ZG_SUCCESS;
 	}
 
+	ZgResult pipelineRenderGetBytecodeHash(
+		const ZgPipelineRender* pipelineIn,
+		uint64_t& hashOut) const noexcept override final
+	{
+		const D3D12PipelineRender* pipeline =
+			reinterpret_cast<const D3D12PipelineRender*>(pipelineIn);
+		hashOut = pipeline->bytecodeHash;
+		return ZG_SUCCESS;
+	}
+
 	// Memory methods
 	// --------------------------------------------------------------------------------------------
 
@@ -727,12 +992,24 @@ public:
 		const ZgMemoryHeapCreateInfo& createInfo) noexcept override final
 	{
 		std::lock_guard<std::mutex> lock(mContextMutex);
-		return createMemoryHeap(
+		D3D12MemoryHeap* heap = nullptr;
+		ZgResult res = createMemoryHeap(
 			*mState->device.Get(),
 			&mState->resourceUniqueIdentifierCounter,
+			&mState->globalDescriptorRingBuffer.bindlessDescriptors,
 			mState->residencyManager,
-			reinterpret_cast<D3D12MemoryHeap**>(memoryHeapOut),
+			&heap,
 			createInfo);
+		if (res != ZG_SUCCESS) return res;
+
+		// Only heaps in "local" memory are considered for eviction by the residency policy
+		if (countsTowardsLocalBudget(createInfo.memoryType)) {
+			mState->residencyPolicy.addHeap(
+				heap, createInfo.sizeInBytes, createInfo.residencyPriority);
+		}
+
+		*memoryHeapOut = heap;
+		return ZG_SUCCESS;
 	}
 
 	ZgResult memoryHeapRelease(
@@ -742,12 +1019,22 @@ public:
 
 		// Stop tracking
 		D3D12MemoryHeap* heap = static_cast<D3D12MemoryHeap*>(memoryHeapIn);
+		mState->residencyPolicy.removeHeap(heap);
 		mState->residencyManager.EndTrackingObject(&heap->managedObject);
 
 		zgDelete(heap);
 		return ZG_SUCCESS;
 	}
 
+	ZgResult memoryHeapSetResidencyPriority(
+		ZgMemoryHeap* memoryHeapIn,
+		ZgResidencyPriority priority) noexcept override final
+	{
+		D3D12MemoryHeap* heap = static_cast<D3D12MemoryHeap*>(memoryHeapIn);
+		mState->residencyPolicy.setPriority(heap, priority);
+		return setMemoryHeapResidencyPriority(*heap, priority);
+	}
+
 	ZgResult bufferMemcpyTo(
 		ZgBuffer* dstBufferInterface,
 		uint64_t bufferOffsetBytes,
@@ -782,6 +1069,46 @@ public:
 		return ZG_SUCCESS;
 	}
 
+	ZgResult bufferReadFile(
+		ZgBuffer* dstBufferInterface,
+		uint64_t bufferOffsetBytes,
+		const char* path,
+		uint64_t fileOffsetBytes,
+		uint64_t numBytes,
+		ZgFileRead** fileReadOut) noexcept override final
+	{
+		D3D12Buffer& dstBuffer = *reinterpret_cast<D3D12Buffer*>(dstBufferInterface);
+		if (dstBuffer.memoryHeap->memoryType != ZG_MEMORY_TYPE_UPLOAD) return ZG_ERROR_INVALID_ARGUMENT;
+		if ((bufferOffsetBytes + numBytes) > dstBuffer.sizeBytes) return ZG_ERROR_INVALID_ARGUMENT;
+
+		// Not gonna read from buffer
+		D3D12_RANGE readRange = {};
+		readRange.Begin = 0;
+		readRange.End = 0;
+
+		// Map buffer, stays mapped until the file read is released
+		void* mappedPtr = nullptr;
+		if (D3D12_FAIL(dstBuffer.resource->Map(0, &readRange, &mappedPtr))) {
+			return ZG_ERROR_GENERIC;
+		}
+
+		D3D12FileRead* fileRead = zgNew<D3D12FileRead>("ZeroG - D3D12FileRead");
+		fileRead->resource = dstBuffer.resource;
+		fileRead->writtenRange.Begin = bufferOffsetBytes;
+		fileRead->writtenRange.End = bufferOffsetBytes + numBytes;
+
+		// Start reading file straight into the mapped buffer
+		ZgResult res = fileRead->fileRead.start(
+			path, fileOffsetBytes, numBytes, reinterpret_cast<uint8_t*>(mappedPtr) + bufferOffsetBytes);
+		if (res != ZG_SUCCESS) {
+			zgDelete(fileRead);
+			return res;
+		}
+
+		*fileReadOut = fileRead;
+		return ZG_SUCCESS;
+	}
+
 	// Texture methods
 	// --------------------------------------------------------------------------------------------
 
@@ -798,6 +1125,14 @@ public:
 		// Return allocation info
 		allocationInfoOut.sizeInBytes = (uint32_t)allocInfo.SizeInBytes;
 		allocationInfoOut.alignmentInBytes = (uint32_t)allocInfo.Alignment;
+
+		// Get size required to upload all mip levels through a single upload buffer
+		uint64_t uploadSizeBytes = 0;
+		mState->device->GetCopyableFootprints(
+			&desc, 0, createInfo.numMipmaps, 0, nullptr, nullptr, nullptr, &uploadSizeBytes);
+		uploadSizeBytes = ((uploadSizeBytes + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) /
+			D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT) * D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+		allocationInfoOut.uploadSizeInBytes = (uint32_t)uploadSizeBytes;
 		return ZG_SUCCESS;
 	}
 
@@ -840,35 +1175,60 @@ private:
 	// Private methods
 	// --------------------------------------------------------------------------------------------
 
-	ZgResult initializeDxcCompiler() noexcept
+	ZgResult acquireDxcInstance(D3D12DxcInstance*& dxcOut) noexcept
 	{
-		// Initialize DXC compiler if necessary
+		std::lock_guard<std::mutex> lock(mState->dxcMutex);
+
+		// Use a free instance if one is available
+		for (uint32_t i = 0; i < mState->dxcInstances.size(); i++) {
+			D3D12DxcInstance* dxc = mState->dxcInstances[i];
+			if (dxc->inUse) continue;
+			dxc->inUse = true;
+			dxcOut = dxc;
+			return ZG_SUCCESS;
+		}
+
+		// Otherwise create a new one
 		// TODO: Provide our own allocator
-		std::lock_guard<std::mutex> lock(mContextMutex);
-		if (mState->dxcLibrary == nullptr) {
+		D3D12DxcInstance* dxc = zgNew<D3D12DxcInstance>("ZeroG - D3D12DxcInstance");
 
-			// Initialize DXC library
-			HRESULT res = DxcCreateInstance(CLSID_DxcLibrary, IID_PPV_ARGS(&mState->dxcLibrary));
-			if (!SUCCEEDED(res)) return ZG_ERROR_GENERIC;
+		// Initialize DXC library
+		HRESULT res = DxcCreateInstance(CLSID_DxcLibrary, IID_PPV_ARGS(&dxc->library));
+		if (!SUCCEEDED(res)) {
+			zgDelete(dxc);
+			return ZG_ERROR_GENERIC;
+		}
 
-			// Initialize DXC compiler
-			res = DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&mState->dxcCompiler));
-			if (!SUCCEEDED(res)) {
-				mState->dxcLibrary = nullptr;
-				return ZG_ERROR_GENERIC;
-			}
+		// Initialize DXC compiler
+		res = DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&dxc->compiler));
+		if (!SUCCEEDED(res)) {
+			zgDelete(dxc);
+			return ZG_ERROR_GENERIC;
+		}
 
-			// Create include handler
-			res = mState->dxcLibrary->CreateIncludeHandler(&mState->dxcIncludeHandler);
-			if (!SUCCEEDED(res)) {
-				mState->dxcLibrary = nullptr;
-				mState->dxcCompiler = nullptr;
-				return ZG_ERROR_GENERIC;
-			}
+		// Create include handler
+		res = dxc->library->CreateIncludeHandler(&dxc->includeHandler);
+		if (!SUCCEEDED(res)) {
+			zgDelete(dxc);
+			return ZG_ERROR_GENERIC;
 		}
+
+		if (!mState->dxcInstances.add(dxc)) {
+			dxc->includeHandler->Release();
+			zgDelete(dxc);
+			return ZG_ERROR_CPU_OUT_OF_MEMORY;
+		}
+		dxc->inUse = true;
+		dxcOut = dxc;
 		return ZG_SUCCESS;
 	}
 
+	void releaseDxcInstance(D3D12DxcInstance* dxc) noexcept
+	{
+		std::lock_guard<std::mutex> lock(mState->dxcMutex);
+		dxc->inUse = false;
+	}
+
 	void logDebugMessages() noexcept
 	{
 		if (!mDebugMode) return;
@@ -0,0 +1,146 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/d3d12/D3D12BindlessDescriptors.hpp"
+
+#include "ZeroG/util/Assert.hpp"
+
+namespace zg {
+
+// D3D12BindlessDescriptors: State methods
+// ------------------------------------------------------------------------------------------------
+
+void D3D12BindlessDescriptors::create(
+	ID3D12Device3& device,
+	D3D12_CPU_DESCRIPTOR_HANDLE tableStartCpu,
+	D3D12_GPU_DESCRIPTOR_HANDLE tableStartGpu,
+	uint32_t descriptorSize,
+	uint32_t numDescriptors) noexcept
+{
+	mDevice = &device;
+	mTableStartCpu = tableStartCpu;
+	this->tableStartGpu = tableStartGpu;
+	mDescriptorSize = descriptorSize;
+	mNumDescriptors = numDescriptors;
+	if (numDescriptors == 0) return;
+
+	// All indices are initially free, in reverse order so that the lowest ones are used first
+	mFreeIndices.create(numDescriptors, "ZeroG - D3D12BindlessDescriptors - FreeIndices");
+	for (uint32_t i = 0; i < numDescriptors; i++) {
+		mFreeIndices.add(numDescriptors - i - 1);
+	}
+}
+
+// D3D12BindlessDescriptors: Methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult D3D12BindlessDescriptors::createBufferView(
+	ID3D12Resource* resource,
+	uint64_t sizeBytes,
+	uint32_t& indexOut) noexcept
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE descriptor = {};
+	ZgResult res = this->allocate(indexOut, descriptor);
+	if (res != ZG_SUCCESS) return res;
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Buffer.FirstElement = 0;
+	srvDesc.Buffer.NumElements = uint32_t(sizeBytes / 4);
+	srvDesc.Buffer.StructureByteStride = 0;
+	srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
+	mDevice->CreateShaderResourceView(resource, &srvDesc, descriptor);
+
+	return ZG_SUCCESS;
+}
+
+ZgResult D3D12BindlessDescriptors::createTextureView(
+	ID3D12Resource* resource,
+	DXGI_FORMAT format,
+	uint32_t& indexOut) noexcept
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE descriptor = {};
+	ZgResult res = this->allocate(indexOut, descriptor);
+	if (res != ZG_SUCCESS) return res;
+
+	// If depth format, convert to SRV compatible format
+	if (format == DXGI_FORMAT_D32_FLOAT) {
+		format = DXGI_FORMAT_R32_FLOAT;
+	}
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = format;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.Texture2D.MipLevels = (uint32_t)-1; // All mip-levels from most detailed and down
+	srvDesc.Texture2D.PlaneSlice = 0;
+	srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+	mDevice->CreateShaderResourceView(resource, &srvDesc, descriptor);
+
+	return ZG_SUCCESS;
+}
+
+void D3D12BindlessDescriptors::release(uint32_t index) noexcept
+{
+	ZG_ASSERT(index < mNumDescriptors);
+
+	// A shader indexing a released resource reads zeroes instead of a dangling view
+	D3D12_CPU_DESCRIPTOR_HANDLE descriptor = {};
+	descriptor.ptr = mTableStartCpu.ptr + uint64_t(mDescriptorSize) * index;
+	D3D12_SHADER_RESOURCE_VIEW_DESC nullDesc = {};
+	nullDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	nullDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	nullDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	nullDesc.Texture2D.MipLevels = 1;
+	mDevice->CreateShaderResourceView(nullptr, &nullDesc, descriptor);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	mFreeIndices.add(index);
+}
+
+void D3D12BindlessDescriptors::getStats(ZgStats& statsOut) noexcept
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	statsOut.descriptorsBindlessNumInUse = mNumDescriptors - mFreeIndices.size();
+	statsOut.descriptorsBindlessNumTotal = mNumDescriptors;
+}
+
+// D3D12BindlessDescriptors: Private methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult D3D12BindlessDescriptors::allocate(
+	uint32_t& indexOut,
+	D3D12_CPU_DESCRIPTOR_HANDLE& descriptorOut) noexcept
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mFreeIndices.size() == 0) {
+			ZG_ERROR("Out of bindless descriptors, all %u are in use. Increase "
+				"ZgDescriptorSettings::numBindlessDescriptors.", mNumDescriptors);
+			return ZG_ERROR_OUT_OF_DESCRIPTORS;
+		}
+		mFreeIndices.pop(indexOut);
+	}
+	descriptorOut.ptr = mTableStartCpu.ptr + uint64_t(mDescriptorSize) * indexOut;
+	return ZG_SUCCESS;
+}
+
+} // namespace zg
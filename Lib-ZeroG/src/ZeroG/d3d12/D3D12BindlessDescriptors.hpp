@@ -0,0 +1,108 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <mutex>
+
+#include "ZeroG.h"
+#include "ZeroG/d3d12/D3D12Common.hpp"
+#include "ZeroG/util/Vector.hpp"
+
+namespace zg {
+
+// D3D12BindlessDescriptors
+// ------------------------------------------------------------------------------------------------
+
+// The part of the global descriptor heap reserved for bindless resources, see
+// ZgDescriptorSettings::numBindlessDescriptors.
+//
+// Every buffer and texture created while bindless is enabled gets a shader resource view here,
+// which stays in place for the lifetime of the resource. Its index in the table is the bindless
+// index of the resource. Freed indices are overwritten with null descriptors. Thread-safe.
+class D3D12BindlessDescriptors final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	D3D12BindlessDescriptors() noexcept = default;
+	D3D12BindlessDescriptors(const D3D12BindlessDescriptors&) = delete;
+	D3D12BindlessDescriptors& operator= (const D3D12BindlessDescriptors&) = delete;
+	D3D12BindlessDescriptors(D3D12BindlessDescriptors&&) = delete;
+	D3D12BindlessDescriptors& operator= (D3D12BindlessDescriptors&&) = delete;
+	~D3D12BindlessDescriptors() noexcept = default;
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	// The table is numDescriptors descriptors starting at the given handles, bindless is disabled
+	// if numDescriptors is 0
+	void create(
+		ID3D12Device3& device,
+		D3D12_CPU_DESCRIPTOR_HANDLE tableStartCpu,
+		D3D12_GPU_DESCRIPTOR_HANDLE tableStartGpu,
+		uint32_t descriptorSize,
+		uint32_t numDescriptors) noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	bool enabled() const noexcept { return mNumDescriptors != 0; }
+
+	// Creates a raw (byte address buffer) view of a buffer, returns its index
+	ZgResult createBufferView(
+		ID3D12Resource* resource,
+		uint64_t sizeBytes,
+		uint32_t& indexOut) noexcept;
+
+	// Creates a view of all mip levels of a texture, returns its index
+	ZgResult createTextureView(
+		ID3D12Resource* resource,
+		DXGI_FORMAT format,
+		uint32_t& indexOut) noexcept;
+
+	// Replaces the view with a null descriptor and frees the index
+	void release(uint32_t index) noexcept;
+
+	// Fills in the bindless descriptor fields of ZgStats
+	void getStats(ZgStats& statsOut) noexcept;
+
+	// Public members
+	// --------------------------------------------------------------------------------------------
+
+	D3D12_GPU_DESCRIPTOR_HANDLE tableStartGpu = {};
+
+private:
+	// Private methods
+	// --------------------------------------------------------------------------------------------
+
+	ZgResult allocate(uint32_t& indexOut, D3D12_CPU_DESCRIPTOR_HANDLE& descriptorOut) noexcept;
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	ID3D12Device3* mDevice = nullptr;
+	D3D12_CPU_DESCRIPTOR_HANDLE mTableStartCpu = {};
+	uint32_t mDescriptorSize = 0;
+	uint32_t mNumDescriptors = 0;
+
+	std::mutex mMutex;
+	Vector<uint32_t> mFreeIndices;
+};
+
+} // namespace zg
@@ -25,7 +25,11 @@ namespace zg {
 
 D3D12Buffer::~D3D12Buffer() noexcept
 {
-
+	if (heapRangeTracker != nullptr) {
+		heapRangeTracker->removeRange(offsetInHeapBytes, sizeInHeapBytes);
+		heapRangeTracker->release();
+	}
+	if (bindlessIndex != ~0u) bindlessDescriptors->release(bindlessIndex);
 }
 
 // D3D12Buffer: Methods
@@ -47,4 +51,38 @@ ZgResult D3D12Buffer::setDebugName(const char* name) noexcept
 	return ZG_SUCCESS;
 }
 
+ZgResult D3D12Buffer::getBindlessIndex(uint32_t& indexOut) const noexcept
+{
+	if (bindlessIndex == ~0u) {
+		ZG_ERROR("Buffer has no bindless index, bindless is not enabled or it's a DOWNLOAD "
+			"buffer");
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+	indexOut = bindlessIndex;
+	return ZG_SUCCESS;
+}
+
+// D3D12FileRead: Constructors & destructors
+// ------------------------------------------------------------------------------------------------
+
+D3D12FileRead::~D3D12FileRead() noexcept
+{
+	// Make sure the OS is done writing to the buffer before unmapping it
+	fileRead.destroy();
+	if (resource != nullptr) resource->Unmap(0, &writtenRange);
+}
+
+// D3D12FileRead: Methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult D3D12FileRead::checkIfDone(bool& doneOut) noexcept
+{
+	return fileRead.checkIfDone(doneOut);
+}
+
+ZgResult D3D12FileRead::waitOnCpuBlocking() noexcept
+{
+	return fileRead.waitBlocking();
+}
+
 } // namespace zg
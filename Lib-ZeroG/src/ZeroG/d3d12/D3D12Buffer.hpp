@@ -21,8 +21,11 @@
 #include <atomic>
 
 #include "ZeroG.h"
+#include "ZeroG/d3d12/D3D12BindlessDescriptors.hpp"
 #include "ZeroG/d3d12/D3D12Common.hpp"
 #include "ZeroG/BackendInterface.hpp"
+#include "ZeroG/util/FileIO.hpp"
+#include "ZeroG/util/HeapRangeTracker.hpp"
 
 namespace zg {
 
@@ -54,6 +57,16 @@ public:
 	uint64_t sizeBytes = 0;
 	ComPtr<ID3D12Resource> resource;
 
+	// The range occupied by the buffer in the heap, for heap statistics. The tracker is shared
+	// with (and may outlive) the heap.
+	HeapRangeTracker* heapRangeTracker = nullptr;
+	uint64_t offsetInHeapBytes = 0;
+	uint64_t sizeInHeapBytes = 0;
+
+	// The view of the buffer in the bindless descriptor table, ~0u if it has none
+	D3D12BindlessDescriptors* bindlessDescriptors = nullptr;
+	uint32_t bindlessIndex = ~0u;
+
 	// The current resource state of the buffer. Committed because the state has been committed
 	// in a command list which has been executed on a queue. There may be pending state changes
 	// in command lists not yet executed.
@@ -64,6 +77,39 @@ public:
 	// --------------------------------------------------------------------------------------------
 
 	ZgResult setDebugName(const char* name) noexcept override final;
+	ZgResult getBindlessIndex(uint32_t& indexOut) const noexcept override final;
+};
+
+// D3D12 File Read
+// ------------------------------------------------------------------------------------------------
+
+// A file being read directly into a mapped upload buffer. The buffer stays mapped until the file
+// read is destroyed.
+class D3D12FileRead final : public ZgFileRead {
+public:
+
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	D3D12FileRead() = default;
+	D3D12FileRead(const D3D12FileRead&) = delete;
+	D3D12FileRead& operator= (const D3D12FileRead&) = delete;
+	D3D12FileRead(D3D12FileRead&&) = delete;
+	D3D12FileRead& operator= (D3D12FileRead&&) = delete;
+	~D3D12FileRead() noexcept;
+
+	// Members
+	// --------------------------------------------------------------------------------------------
+
+	ComPtr<ID3D12Resource> resource;
+	D3D12_RANGE writtenRange = {};
+	AsyncFileRead fileRead;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	ZgResult checkIfDone(bool& doneOut) noexcept override final;
+	ZgResult waitOnCpuBlocking() noexcept override final;
 };
 
 } // namespace zg
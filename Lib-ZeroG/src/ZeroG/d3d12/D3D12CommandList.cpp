@@ -22,8 +22,10 @@
 
 #include "ZeroG/d3d12/D3D12MemoryHeap.hpp"
 #include "ZeroG/d3d12/D3D12Textures.hpp"
+#include "ZeroG/JobSystem.hpp"
 #include "ZeroG/util/Assert.hpp"
 #include "ZeroG/util/ErrorReporting.hpp"
+#include "ZeroG/util/Hash.hpp"
 
 namespace zg {
 
@@ -49,21 +51,98 @@ static uint32_t numBytesPerPixelForFormat(ZgTextureFormat format) noexcept
 	return 0;
 }
 
+// Copies the rows of a mip chain into a mapped upload buffer. The rows of all mip levels are
+// numbered consecutively and split into equally sized ranges, one per task.
+struct MipChainCopyTaskData final {
+	const ZgImageViewConstCpu* srcImages = nullptr;
+	uint32_t numMipLevels = 0;
+	uint8_t* dstMipPtrs[ZG_MAX_NUM_MIPMAPS] = {};
+	uint32_t dstRowPitches[ZG_MAX_NUM_MIPMAPS] = {};
+	uint32_t numBytesPerRow[ZG_MAX_NUM_MIPMAPS] = {};
+	uint32_t firstRowIdx[ZG_MAX_NUM_MIPMAPS + 1] = {};
+	uint32_t numRowsPerTask = 0;
+};
+
+// Don't bother splitting up copies smaller than this
+constexpr uint64_t MIP_CHAIN_COPY_MIN_BYTES_PER_TASK = 256 * 1024;
+
+static void copyMipChainRowsTask(void* taskDataPtr, uint32_t taskIdx) noexcept
+{
+	const MipChainCopyTaskData& taskData =
+		*reinterpret_cast<const MipChainCopyTaskData*>(taskDataPtr);
+	const uint32_t taskRowsBegin = taskIdx * taskData.numRowsPerTask;
+	const uint32_t taskRowsEnd = std::min(
+		taskRowsBegin + taskData.numRowsPerTask, taskData.firstRowIdx[taskData.numMipLevels]);
+
+	for (uint32_t i = 0; i < taskData.numMipLevels; i++) {
+		const uint32_t mipRowsBegin = taskData.firstRowIdx[i];
+		const uint32_t mipRowsEnd = taskData.firstRowIdx[i + 1];
+		const uint32_t rowsBegin = std::max(taskRowsBegin, mipRowsBegin);
+		const uint32_t rowsEnd = std::min(taskRowsEnd, mipRowsEnd);
+
+		const ZgImageViewConstCpu& srcImageCpu = taskData.srcImages[i];
+		for (uint32_t row = rowsBegin; row < rowsEnd; row++) {
+			uint32_t y = row - mipRowsBegin;
+			const uint8_t* rowPtr =
+				((const uint8_t*)srcImageCpu.data) + srcImageCpu.pitchInBytes * y;
+			uint8_t* dstPtr = taskData.dstMipPtrs[i] + uint64_t(taskData.dstRowPitches[i]) * y;
+			memcpy(dstPtr, rowPtr, taskData.numBytesPerRow[i]);
+		}
+	}
+}
+
+static bool bindingsEqual(const ZgPipelineBindings& lhs, const ZgPipelineBindings& rhs) noexcept
+{
+	if (lhs.numConstantBuffers != rhs.numConstantBuffers) return false;
+	if (lhs.numTextures != rhs.numTextures) return false;
+	for (uint32_t i = 0; i < lhs.numConstantBuffers; i++) {
+		const ZgConstantBufferBinding& l = lhs.constantBuffers[i];
+		const ZgConstantBufferBinding& r = rhs.constantBuffers[i];
+		if (l.shaderRegister != r.shaderRegister || l.buffer != r.buffer) return false;
+	}
+	for (uint32_t i = 0; i < lhs.numTextures; i++) {
+		const ZgTextureBinding& l = lhs.textures[i];
+		const ZgTextureBinding& r = rhs.textures[i];
+		if (l.textureRegister != r.textureRegister || l.texture != r.texture) return false;
+	}
+	return true;
+}
+
+// Key of a descriptor table in the descriptor table cache, the bindings must be in table order
+static uint64_t descriptorTableKey(
+	uint64_t tableLayoutHash,
+	const ZgConstantBufferBinding* const* constBufferBindings,
+	uint32_t numConstantBuffers,
+	const ZgTextureBinding* const* textureBindings,
+	uint32_t numTextures) noexcept
+{
+	uint64_t key = tableLayoutHash;
+	for (uint32_t i = 0; i < numConstantBuffers; i++) {
+		const ZgConstantBufferBinding* binding = constBufferBindings[i];
+		key = hashValue(binding != nullptr ? binding->buffer : nullptr, key);
+	}
+	for (uint32_t i = 0; i < numTextures; i++) {
+		const ZgTextureBinding* binding = textureBindings[i];
+		key = hashValue(binding != nullptr ? binding->texture : nullptr, key);
+	}
+	return key;
+}
+
 // D3D12CommandList: State methods
 // ------------------------------------------------------------------------------------------------
 
 void D3D12CommandList::create(
-	uint32_t maxNumBuffers,
 	ComPtr<ID3D12Device3> device,
 	D3DX12Residency::ResidencyManager* residencyManager,
 	D3D12DescriptorRingBuffer* descriptorBuffer) noexcept
 {
 	mDevice = device;
 	mDescriptorBuffer = descriptorBuffer;
-	pendingBufferIdentifiers.create(maxNumBuffers, "ZeroG - D3D12CommandList - Internal");
-	pendingBufferStates.create(maxNumBuffers, "ZeroG - D3D12CommandList - Internal");
-	pendingTextureIdentifiers.create(maxNumBuffers, "ZeroG - D3D12CommandList - Internal");
-	pendingTextureStates.create(maxNumBuffers, "ZeroG - D3D12CommandList - Internal");
+	pendingBufferIdentifiers.create(0, "ZeroG - D3D12CommandList - Internal");
+	pendingBufferStates.create(0, "ZeroG - D3D12CommandList - Internal");
+	pendingTextureIdentifiers.create(0, "ZeroG - D3D12CommandList - Internal");
+	pendingTextureStates.create(0, "ZeroG - D3D12CommandList - Internal");
+	referencedHeaps.create(0, "ZeroG - D3D12CommandList - Internal");
 
 	residencySet = residencyManager->CreateResidencySet();
 }
@@ -81,11 +160,23 @@ void D3D12CommandList::swap(D3D12CommandList& other) noexcept
 	this->pendingTextureIdentifiers.swap(other.pendingTextureIdentifiers);
 	this->pendingTextureStates.swap(other.pendingTextureStates);
 
+	this->referencedHeaps.swap(other.referencedHeaps);
+	std::swap(this->referencedHeapsOverflowed, other.referencedHeapsOverflowed);
+
+	this->descriptorSegments.segments.swap(other.descriptorSegments.segments);
+	std::swap(this->descriptorSegments.numUsedInLast, other.descriptorSegments.numUsedInLast);
+
 	std::swap(this->mDevice, other.mDevice);
 	std::swap(this->mResidencyManager, other.mResidencyManager);
 	std::swap(this->mDescriptorBuffer, other.mDescriptorBuffer);
 	std::swap(this->mPipelineSet, other.mPipelineSet);
 	std::swap(this->mBoundPipeline, other.mBoundPipeline);
+	std::swap(this->mBoundRootSignature, other.mBoundRootSignature);
+	std::swap(this->mDescriptorHeapSet, other.mDescriptorHeapSet);
+	std::swap(this->mBoundTableValid, other.mBoundTableValid);
+	std::swap(this->mBoundTableLayoutHash, other.mBoundTableLayoutHash);
+	std::swap(this->mBoundTableBindings, other.mBoundTableBindings);
+	this->mDescriptorTableCache.swap(other.mDescriptorTableCache);
 	std::swap(this->mFramebufferSet, other.mFramebufferSet);
 	std::swap(this->mFramebuffer, other.mFramebuffer);
 }
@@ -106,11 +197,23 @@ void D3D12CommandList::destroy() noexcept
 	pendingTextureIdentifiers.destroy();
 	pendingTextureStates.destroy();
 
+	referencedHeaps.destroy();
+	referencedHeapsOverflowed = false;
+
+	if (mDescriptorBuffer != nullptr) mDescriptorBuffer->releaseSegments(descriptorSegments);
+	descriptorSegments.segments.destroy();
+
 	mDevice = nullptr;
 	mResidencyManager = nullptr;
 	mDescriptorBuffer = nullptr;
 	mPipelineSet = false;
 	mBoundPipeline = nullptr;
+	mBoundRootSignature = nullptr;
+	mDescriptorHeapSet = false;
+	mBoundTableValid = false;
+	mBoundTableLayoutHash = 0;
+	mBoundTableBindings = {};
+	mDescriptorTableCache.destroy();
 	mFramebufferSet = false;
 	mFramebuffer = nullptr;
 }
@@ -153,8 +256,8 @@ ZgResult D3D12CommandList::memcpyBufferToBuffer(
 		srcBufferOffsetBytes == 0;
 
 	// Add buffers to residency set
-	residencySet->Insert(&srcBuffer.memoryHeap->managedObject);
-	residencySet->Insert(&dstBuffer.memoryHeap->managedObject);
+	insertIntoResidencySet(srcBuffer.memoryHeap);
+	insertIntoResidencySet(dstBuffer.memoryHeap);
 
 	// Copy entire buffer
 	if (copyEntireBuffer) {
@@ -244,8 +347,8 @@ ZgResult D3D12CommandList::memcpyToTexture(
 	if (stateRes != ZG_SUCCESS) return stateRes;
 
 	// Insert into residency set
-	residencySet->Insert(&tmpBuffer.memoryHeap->managedObject);
-	residencySet->Insert(&dstTexture.textureHeap->managedObject);
+	insertIntoResidencySet(tmpBuffer.memoryHeap);
+	insertIntoResidencySet(dstTexture.textureHeap);
 
 	// Issue copy command
 	D3D12_TEXTURE_COPY_LOCATION tmpCopyLoc = {};
@@ -253,11 +356,11 @@ ZgResult D3D12CommandList::memcpyToTexture(
 	tmpCopyLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
 	tmpCopyLoc.PlacedFootprint = dstTexture.subresourceFootprints[dstTextureMipLevel];
 	
-	// TODO: THIS IS A HACK
 	// Essentially, in D3D12 you are meant to upload all of your subresources (i.e. mip levels)
 	// at the same time. All of these mip levels will be in THE SAME temporary upload buffer. What
 	// we instead have done here is said that each mip level will be in its own temporary upload
 	// buffer, thus we need to modify the placed footprint so that it does not have an offset.
+	// See memcpyToTextureMipChain() for the version that uploads all levels through one buffer.
 	tmpCopyLoc.PlacedFootprint.Offset = 0; 
 
 	D3D12_TEXTURE_COPY_LOCATION dstCopyLoc = {};
@@ -270,6 +373,127 @@ ZgResult D3D12CommandList::memcpyToTexture(
 	return ZG_SUCCESS;
 }
 
+ZgResult D3D12CommandList::memcpyToTextureMipChain(
+	ZgTexture2D* dstTextureIn,
+	const ZgImageViewConstCpu* srcImagesCpu,
+	uint32_t numMipLevels,
+	ZgBuffer* tempUploadBufferIn,
+	uint64_t tempUploadBufferOffsetBytes) noexcept
+{
+	// Cast input to D3D12
+	D3D12Texture2D& dstTexture = *reinterpret_cast<D3D12Texture2D*>(dstTextureIn);
+	D3D12Buffer& tmpBuffer = *reinterpret_cast<D3D12Buffer*>(tempUploadBufferIn);
+
+	// Check that all mip levels are specified
+	if (numMipLevels != dstTexture.numMipmaps) {
+		ZG_ERROR("memcpyToTextureMipChain(): Texture has %u mip levels, %u images specified",
+			dstTexture.numMipmaps, numMipLevels);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Check that temp buffer is upload
+	if (tmpBuffer.memoryHeap->memoryType != ZG_MEMORY_TYPE_UPLOAD) return ZG_ERROR_INVALID_ARGUMENT;
+
+	// Check that offset is properly aligned
+	if ((tempUploadBufferOffsetBytes % D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT) != 0) {
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Check that the CPU images have correct dimensions and format
+	uint32_t dstTexMipWidth = dstTexture.width;
+	uint32_t dstTexMipHeight = dstTexture.height;
+	for (uint32_t i = 0; i < numMipLevels; i++) {
+		const ZgImageViewConstCpu& srcImageCpu = srcImagesCpu[i];
+		if (srcImageCpu.format != dstTexture.zgFormat) return ZG_ERROR_INVALID_ARGUMENT;
+		if (srcImageCpu.width != dstTexMipWidth) return ZG_ERROR_INVALID_ARGUMENT;
+		if (srcImageCpu.height != dstTexMipHeight) return ZG_ERROR_INVALID_ARGUMENT;
+		dstTexMipWidth /= 2;
+		dstTexMipHeight /= 2;
+	}
+
+	// The footprints are calculated with the texture's heap offset as base offset, the layout of
+	// the mip levels in the upload buffer is relative to the first footprint.
+	const uint64_t footprintsBaseOffset = dstTexture.subresourceFootprints[0].Offset;
+	uint64_t requiredSize = dstTexture.mipChainUploadSizeBytes();
+
+	// Check that upload buffer is big enough
+	if (tmpBuffer.sizeBytes < (tempUploadBufferOffsetBytes + requiredSize)) {
+		ZG_ERROR("Temporary buffer is too small, it is %llu bytes, but %llu bytes is required"
+			" at offset %llu.",
+			tmpBuffer.sizeBytes,
+			requiredSize,
+			tempUploadBufferOffsetBytes);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Not gonna read from temp buffer
+	D3D12_RANGE readRange = {};
+	readRange.Begin = 0;
+	readRange.End = 0;
+
+	// Map buffer
+	void* mappedPtr = nullptr;
+	if (D3D12_FAIL(tmpBuffer.resource->Map(0, &readRange, &mappedPtr))) {
+		return ZG_ERROR_GENERIC;
+	}
+
+	// Memcpy all cpu images to tmp buffer, split over multiple tasks if large enough
+	uint32_t numBytesPerPixel = numBytesPerPixelForFormat(dstTexture.zgFormat);
+	MipChainCopyTaskData copyData;
+	copyData.srcImages = srcImagesCpu;
+	copyData.numMipLevels = numMipLevels;
+	uint64_t numBytesToCopy = 0;
+	for (uint32_t i = 0; i < numMipLevels; i++) {
+		const ZgImageViewConstCpu& srcImageCpu = srcImagesCpu[i];
+		const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = dstTexture.subresourceFootprints[i];
+		copyData.dstMipPtrs[i] = reinterpret_cast<uint8_t*>(mappedPtr) +
+			tempUploadBufferOffsetBytes + (footprint.Offset - footprintsBaseOffset);
+		copyData.dstRowPitches[i] = footprint.Footprint.RowPitch;
+		copyData.numBytesPerRow[i] = srcImageCpu.width * numBytesPerPixel;
+		ZG_ASSERT(copyData.numBytesPerRow[i] <= dstTexture.rowSizesInBytes[i]);
+		copyData.firstRowIdx[i + 1] = copyData.firstRowIdx[i] + srcImageCpu.height;
+		numBytesToCopy += uint64_t(copyData.numBytesPerRow[i]) * srcImageCpu.height;
+	}
+	const uint32_t numRows = copyData.firstRowIdx[numMipLevels];
+	const uint32_t numTasks = uint32_t(std::max(std::min(
+		numBytesToCopy / MIP_CHAIN_COPY_MIN_BYTES_PER_TASK, uint64_t(numRows)), uint64_t(1)));
+	copyData.numRowsPerTask = (numRows + numTasks - 1) / numTasks;
+	parallelFor(numTasks, copyMipChainRowsTask, &copyData);
+
+	// Unmap buffer
+	D3D12_RANGE writtenRange = {};
+	writtenRange.Begin = tempUploadBufferOffsetBytes;
+	writtenRange.End = tempUploadBufferOffsetBytes + requiredSize;
+	tmpBuffer.resource->Unmap(0, &writtenRange);
+
+	// Set texture resource state
+	ZgResult stateRes = setTextureStateAllMipLevels(dstTexture, D3D12_RESOURCE_STATE_COPY_DEST);
+	if (stateRes != ZG_SUCCESS) return stateRes;
+
+	// Insert into residency set
+	insertIntoResidencySet(tmpBuffer.memoryHeap);
+	insertIntoResidencySet(dstTexture.textureHeap);
+
+	// Issue copy commands, one per mip level
+	for (uint32_t i = 0; i < numMipLevels; i++) {
+		D3D12_TEXTURE_COPY_LOCATION tmpCopyLoc = {};
+		tmpCopyLoc.pResource = tmpBuffer.resource.Get();
+		tmpCopyLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+		tmpCopyLoc.PlacedFootprint = dstTexture.subresourceFootprints[i];
+		tmpCopyLoc.PlacedFootprint.Offset =
+			tempUploadBufferOffsetBytes + (tmpCopyLoc.PlacedFootprint.Offset - footprintsBaseOffset);
+
+		D3D12_TEXTURE_COPY_LOCATION dstCopyLoc = {};
+		dstCopyLoc.pResource = dstTexture.resource.Get();
+		dstCopyLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+		dstCopyLoc.SubresourceIndex = i;
+
+		commandList->CopyTextureRegion(&dstCopyLoc, 0, 0, 0, &tmpCopyLoc, nullptr);
+	}
+
+	return ZG_SUCCESS;
+}
+
 ZgResult D3D12CommandList::enableQueueTransitionBuffer(ZgBuffer* bufferIn) noexcept
 {
 	// Cast to D3D12
@@ -301,6 +525,41 @@ ZgResult D3D12CommandList::enableQueueTransitionTexture(ZgTexture2D* textureIn)
 	return ZG_SUCCESS;
 }
 
+ZgResult D3D12CommandList::activateTransientTexture(ZgTexture2D* textureIn) noexcept
+{
+	// Cast to D3D12
+	D3D12Texture2D& texture = *reinterpret_cast<D3D12Texture2D*>(textureIn);
+
+	// Only render targets and depth buffers can be transient
+	D3D12_RESOURCE_STATES targetState = D3D12_RESOURCE_STATE_RENDER_TARGET;
+	if (texture.usage == ZG_TEXTURE_USAGE_DEPTH_BUFFER) {
+		targetState = D3D12_RESOURCE_STATE_DEPTH_WRITE;
+	}
+	else if (texture.usage != ZG_TEXTURE_USAGE_RENDER_TARGET) {
+		ZG_ERROR("activateTransientTexture(): Texture must be a render target or depth buffer");
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Aliasing barrier, we don't know which texture previously used the memory so let D3D12
+	// assume it could be any of them.
+	CD3DX12_RESOURCE_BARRIER barrier =
+		CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, texture.resource.Get());
+	commandList->ResourceBarrier(1, &barrier);
+
+	// Set texture resource state
+	ZgResult res = setTextureStateAllMipLevels(texture, targetState);
+	if (res != ZG_SUCCESS) return res;
+
+	// The previous contents of an aliased texture are garbage, discard them so the texture is
+	// properly initialized (compression metadata and such) before use.
+	commandList->DiscardResource(texture.resource.Get(), nullptr);
+
+	// Insert into residency set
+	insertIntoResidencySet(texture.textureHeap);
+
+	return ZG_SUCCESS;
+}
+
 ZgResult D3D12CommandList::setPushConstant(
 	uint32_t shaderRegister,
 	const void* dataPtr,
@@ -309,17 +568,9 @@ ZgResult D3D12CommandList::setPushConstant(
 	// Require that a pipeline has been set so we can query its parameters
 	if (!mPipelineSet) return ZG_ERROR_INVALID_COMMAND_LIST_STATE;
 
-	// Linear search to find push constant mapping
-	uint32_t mappingIdx = ~0u;
-	for (uint32_t i = 0; i < mBoundPipeline->numPushConstants; i++) {
-		if (mBoundPipeline->pushConstants[i].shaderRegister == shaderRegister) {
-			mappingIdx = i;
-			break;
-		}
-	}
-
 	// Return invalid argument if there is no push constant associated with the given register
-	if (mappingIdx == ~0u) return ZG_ERROR_INVALID_ARGUMENT;
+	const uint8_t mappingIdx = mBoundPipeline->pushConstantLookup.find(shaderRegister);
+	if (mappingIdx == REGISTER_LOOKUP_NO_MAPPING) return ZG_ERROR_INVALID_ARGUMENT;
 	const D3D12PushConstantMapping& mapping = mBoundPipeline->pushConstants[mappingIdx];
 
 	// Sanity check to attempt to see if user provided enough bytes to read
@@ -342,6 +593,55 @@ ZgResult D3D12CommandList::setPushConstant(
 	return ZG_SUCCESS;
 }
 
+ZgResult D3D12CommandList::setRootConstantBuffer(
+	uint32_t shaderRegister,
+	ZgBuffer* bufferIn,
+	uint64_t offsetInBytes) noexcept
+{
+	D3D12Buffer& buffer = *reinterpret_cast<D3D12Buffer*>(bufferIn);
+
+	// Require that a pipeline has been set so we can query its parameters
+	if (!mPipelineSet) return ZG_ERROR_INVALID_COMMAND_LIST_STATE;
+
+	// Return invalid argument if there is no root constant buffer at the given register
+	const uint8_t mappingIdx = mBoundPipeline->rootConstBufferLookup.find(shaderRegister);
+	if (mappingIdx == REGISTER_LOOKUP_NO_MAPPING) return ZG_ERROR_INVALID_ARGUMENT;
+	const D3D12RootConstantBufferMapping& mapping = mBoundPipeline->rootConstBuffers[mappingIdx];
+
+	// Check that the constant buffer fits in the buffer after the offset
+	if (buffer.sizeBytes < (offsetInBytes + mapping.sizeInBytes)) {
+		ZG_ERROR("Root constant buffer at shader register %u is %u bytes, buffer is too small,"
+			" it is %llu bytes and the offset is %llu.",
+			shaderRegister,
+			mapping.sizeInBytes,
+			buffer.sizeBytes,
+			offsetInBytes);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Set buffer resource state, upload buffers must stay in GENERIC_READ
+	ZgResult res = ZG_SUCCESS;
+	if (buffer.memoryHeap->memoryType == ZG_MEMORY_TYPE_DEVICE) {
+		res = setBufferState(buffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+	}
+	else if (buffer.memoryHeap->memoryType == ZG_MEMORY_TYPE_UPLOAD) {
+		res = setBufferState(buffer, D3D12_RESOURCE_STATE_GENERIC_READ);
+	}
+	else {
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+	if (res != ZG_SUCCESS) return res;
+
+	// Set root constant buffer view
+	commandList->SetGraphicsRootConstantBufferView(
+		mapping.parameterIndex, buffer.resource->GetGPUVirtualAddress() + offsetInBytes);
+
+	// Insert into residency set
+	insertIntoResidencySet(buffer.memoryHeap);
+
+	return ZG_SUCCESS;
+}
+
 ZgResult D3D12CommandList::setPipelineBindings(
 	const ZgPipelineBindings& bindings) noexcept
 {
@@ -353,12 +653,44 @@ ZgResult D3D12CommandList::setPipelineBindings(
 	// If no bindings specified, do nothing.
 	if (bindings.numConstantBuffers == 0 && bindings.numTextures == 0) return ZG_SUCCESS;
 
+	// Put the bindings in the same order as the pipeline's mappings using its register lookups.
+	// Bindings to registers the pipeline doesn't use are ignored, if a register is bound more than
+	// once the first binding is used.
+	const ZgConstantBufferBinding* constBufferBindings[ZG_MAX_NUM_CONSTANT_BUFFERS];
+	orderBindingsByMapping(constBufferBindings, mBoundPipeline->constBufferLookup,
+		bindings.constantBuffers, bindings.numConstantBuffers,
+		[](const ZgConstantBufferBinding& binding) { return binding.shaderRegister; });
+	const ZgTextureBinding* textureBindings[ZG_MAX_NUM_TEXTURES];
+	orderBindingsByMapping(textureBindings, mBoundPipeline->textureLookup,
+		bindings.textures, bindings.numTextures,
+		[](const ZgTextureBinding& binding) { return binding.textureRegister; });
+
+	// If the currently bound descriptor table was created for the same table layout and the same
+	// bindings it is still valid, in which case only resource states and residency are tracked
+	const bool reuseBoundTable =
+		mBoundTableValid &&
+		mBoundTableLayoutHash == mBoundPipeline->tableLayoutHash &&
+		bindingsEqual(mBoundTableBindings, bindings);
+
+	// Otherwise check if a table has already been created for the same layout and resources, in
+	// which case it only needs to be bound
+	uint64_t tableKey = 0;
+	bool tableCached = false;
+	D3D12_GPU_DESCRIPTOR_HANDLE rangeStartGpu = {};
+	if (!reuseBoundTable) {
+		tableKey = descriptorTableKey(mBoundPipeline->tableLayoutHash,
+			constBufferBindings, numConstantBuffers, textureBindings, numTextures);
+		tableCached = mDescriptorTableCache.get(tableKey, rangeStartGpu);
+	}
+	const bool createViews = !reuseBoundTable && !tableCached;
+
 	// Allocate descriptors
 	D3D12_CPU_DESCRIPTOR_HANDLE rangeStartCpu = {};
-	D3D12_GPU_DESCRIPTOR_HANDLE rangeStartGpu = {};
-	ZgResult allocRes = mDescriptorBuffer->allocateDescriptorRange(
-		numConstantBuffers + numTextures, rangeStartCpu, rangeStartGpu);
-	if (allocRes != ZG_SUCCESS) return allocRes;
+	if (createViews) {
+		ZgResult allocRes = mDescriptorBuffer->allocateDescriptorRange(descriptorSegments,
+			numConstantBuffers + numTextures, rangeStartCpu, rangeStartGpu);
+		if (allocRes != ZG_SUCCESS) return allocRes;
+	}
 
 	// Create constant buffer views and fill (CPU) descriptors
 	for (uint32_t i = 0; i < numConstantBuffers; i++) {
@@ -370,26 +702,16 @@ ZgResult D3D12CommandList::setPipelineBindings(
 		cpuDescriptor.ptr =
 			rangeStartCpu.ptr + mDescriptorBuffer->descriptorSize * mapping.tableOffset;
 
-		// Linear search to find matching argument among the bindings
-		uint32_t bindingIdx = ~0u;
-		for (uint32_t j = 0; j < bindings.numConstantBuffers; j++) {
-			const ZgConstantBufferBinding& binding = bindings.constantBuffers[j];
-			if (binding.shaderRegister == mapping.shaderRegister) {
-				bindingIdx = j;
-				break;
-			}
-		}
-
 		// If we can't find argument we need to insert null descriptor
-		if (bindingIdx == ~0u) {
+		const ZgConstantBufferBinding* binding = constBufferBindings[i];
+		if (binding == nullptr) {
 			// TODO: Not sure if possible to implement?
 			ZG_ASSERT(false);
 			return ZG_WARNING_UNIMPLEMENTED;
 		}
 
 		// Get buffer from binding and cast it to D3D12 buffer
-		D3D12Buffer* buffer =
-			reinterpret_cast<D3D12Buffer*>(bindings.constantBuffers[bindingIdx].buffer);
+		D3D12Buffer* buffer = reinterpret_cast<D3D12Buffer*>(binding->buffer);
 
 		// D3D12 requires that a Constant Buffer View is at least 256 bytes, and a multiple of 256.
 		// Round up constant buffer size to nearest 256 alignment
@@ -405,16 +727,18 @@ ZgResult D3D12CommandList::setPipelineBindings(
 		}
 
 		// Create constant buffer view
-		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
-		cbvDesc.BufferLocation = buffer->resource->GetGPUVirtualAddress();
-		cbvDesc.SizeInBytes = bufferSize256Aligned;
-		mDevice->CreateConstantBufferView(&cbvDesc, cpuDescriptor);
+		if (createViews) {
+			D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
+			cbvDesc.BufferLocation = buffer->resource->GetGPUVirtualAddress();
+			cbvDesc.SizeInBytes = bufferSize256Aligned;
+			mDevice->CreateConstantBufferView(&cbvDesc, cpuDescriptor);
+		}
 
 		// Set buffer resource state
 		setBufferState(*buffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
 
 		// Insert into residency set
-		residencySet->Insert(&buffer->memoryHeap->managedObject);
+		insertIntoResidencySet(buffer->memoryHeap);
 	}
 
 	// Create shader resource views and fill (CPU) descriptors
@@ -428,23 +752,14 @@ ZgResult D3D12CommandList::setPipelineBindings(
 		cpuDescriptor.ptr =
 			rangeStartCpu.ptr + mDescriptorBuffer->descriptorSize * mapping.tableOffset;
 
-		// Linear search to find matching argument among the bindings
-		uint32_t bindingIdx = ~0u;
-		for (uint32_t j = 0; j < bindings.numTextures; j++) {
-			const ZgTextureBinding& binding = bindings.textures[j];
-			if (binding.textureRegister == mapping.textureRegister) {
-				bindingIdx = j;
-				break;
-			}
-		}
-
 		// If binding found, get D3D12 texture and its resource and format. Otherwise set default
 		// in order to create null descriptor
+		const ZgTextureBinding* binding = textureBindings[i];
 		D3D12Texture2D* texture = nullptr;
 		ID3D12Resource* resource = nullptr;
 		DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		if (bindingIdx != ~0u) {
-			texture = reinterpret_cast<D3D12Texture2D*>(bindings.textures[bindingIdx].texture);
+		if (binding != nullptr) {
+			texture = reinterpret_cast<D3D12Texture2D*>(binding->texture);
 			resource = texture->resource.Get();
 			format = texture->format;
 		}
@@ -456,18 +771,20 @@ ZgResult D3D12CommandList::setPipelineBindings(
 
 		// Create shader resource view
 		// Will be null descriptor if no binding found
-		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-		srvDesc.Format = format;
-		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-		srvDesc.Texture2D.MostDetailedMip = 0;
-		srvDesc.Texture2D.MipLevels = (uint32_t)-1; // All mip-levels from most detailed and downwards
-		srvDesc.Texture2D.PlaneSlice = 0;
-		srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
-		mDevice->CreateShaderResourceView(resource, &srvDesc, cpuDescriptor);
+		if (createViews) {
+			D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+			srvDesc.Format = format;
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+			srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+			srvDesc.Texture2D.MostDetailedMip = 0;
+			srvDesc.Texture2D.MipLevels = (uint32_t)-1; // All mip-levels from most detailed and down
+			srvDesc.Texture2D.PlaneSlice = 0;
+			srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+			mDevice->CreateShaderResourceView(resource, &srvDesc, cpuDescriptor);
+		}
 
 		// Set texture resource state and insert into residency set if not null descriptor
-		if (bindingIdx != ~0u) {
+		if (binding != nullptr) {
 
 			// Set texture resource state
 			setTextureStateAllMipLevels(
@@ -475,13 +792,69 @@ ZgResult D3D12CommandList::setPipelineBindings(
 				D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
 
 			// Insert into residency set
-			residencySet->Insert(&texture->textureHeap->managedObject);
+			insertIntoResidencySet(texture->textureHeap);
+		}
+	}
+
+	// Cache newly created descriptor table
+	if (createViews) mDescriptorTableCache.insert(tableKey, rangeStartGpu);
+
+	// Set descriptor table to root signature, unless the bound one is still valid
+	if (!reuseBoundTable) {
+		commandList->SetGraphicsRootDescriptorTable(
+			mBoundPipeline->dynamicBuffersParameterIndex, rangeStartGpu);
+		mBoundTableValid = true;
+		mBoundTableLayoutHash = mBoundPipeline->tableLayoutHash;
+		mBoundTableBindings = bindings;
+	}
+
+	return ZG_SUCCESS;
+}
+
+ZgResult D3D12CommandList::useBindlessResources(
+	ZgBuffer* const* buffers,
+	uint32_t numBuffers,
+	ZgTexture2D* const* textures,
+	uint32_t numTextures) noexcept
+{
+	// The bindless table itself never changes, only resource states and residency are tracked
+	const D3D12_RESOURCE_STATES shaderResourceState =
+		D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+	for (uint32_t i = 0; i < numBuffers; i++) {
+		D3D12Buffer& buffer = *reinterpret_cast<D3D12Buffer*>(buffers[i]);
+		if (buffer.bindlessIndex == ~0u) {
+			ZG_ERROR("Buffer %u has no bindless index", i);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+
+		// Set buffer resource state, upload buffers must stay in GENERIC_READ
+		ZgResult res = ZG_SUCCESS;
+		if (buffer.memoryHeap->memoryType == ZG_MEMORY_TYPE_DEVICE) {
+			res = setBufferState(buffer, shaderResourceState);
+		}
+		else {
+			res = setBufferState(buffer, D3D12_RESOURCE_STATE_GENERIC_READ);
 		}
+		if (res != ZG_SUCCESS) return res;
+
+		// Insert into residency set
+		insertIntoResidencySet(buffer.memoryHeap);
 	}
 
-	// Set descriptor table to root signature
-	commandList->SetGraphicsRootDescriptorTable(
-		mBoundPipeline->dynamicBuffersParameterIndex, rangeStartGpu);
+	for (uint32_t i = 0; i < numTextures; i++) {
+		D3D12Texture2D& texture = *reinterpret_cast<D3D12Texture2D*>(textures[i]);
+		if (texture.bindlessIndex == ~0u) {
+			ZG_ERROR("Texture %u has no bindless index", i);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+
+		// Set texture resource state
+		ZgResult res = setTextureStateAllMipLevels(texture, shaderResourceState);
+		if (res != ZG_SUCCESS) return res;
+
+		// Insert into residency set
+		insertIntoResidencySet(texture.textureHeap);
+	}
 
 	return ZG_SUCCESS;
 }
@@ -491,19 +864,51 @@ ZgResult D3D12CommandList::setPipelineRender(
 {
 	D3D12PipelineRender& pipeline = *reinterpret_cast<D3D12PipelineRender*>(pipelineIn);
 	
-	// If a pipeline is already set for this command list, return error. We currently only allow a
-	// single pipeline per command list.
-	if (mPipelineSet) return ZG_ERROR_INVALID_COMMAND_LIST_STATE;
+	// Set pipeline, unless it is already bound
+	if (mPipelineSet && mBoundPipeline == &pipeline) return ZG_SUCCESS;
+	const D3D12BindlessDescriptors& bindless = mDescriptorBuffer->bindlessDescriptors;
+	bool usesBindless = pipeline.bindlessTexturesParameterIndex != ~0u ||
+		pipeline.bindlessBuffersParameterIndex != ~0u;
+	if (usesBindless && !bindless.enabled()) {
+		ZG_ERROR("Pipeline uses bindless resources, but bindless is not enabled "
+			"(ZgDescriptorSettings::numBindlessDescriptors)");
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+	if (!mPipelineSet || mBoundPipeline->pipelineState.Get() != pipeline.pipelineState.Get()) {
+		commandList->SetPipelineState(pipeline.pipelineState.Get());
+	}
 	mPipelineSet = true;
 	mBoundPipeline = &pipeline;
 
-	// Set pipeline
-	commandList->SetPipelineState(pipeline.pipelineState.Get());
-	commandList->SetGraphicsRootSignature(pipeline.rootSignature.Get());
+	// Root signatures are shared between pipelines with identical layouts. Changing the root
+	// signature invalidates all root arguments, so push constants and the descriptor table must be
+	// set again. If it stays the same the root arguments are kept.
+	bool rootSignatureChanged = mBoundRootSignature != pipeline.rootSignature.Get();
+	if (rootSignatureChanged) {
+		commandList->SetGraphicsRootSignature(pipeline.rootSignature.Get());
+		mBoundRootSignature = pipeline.rootSignature.Get();
+		mBoundTableValid = false;
+	}
 
-	// Set descriptor heap
-	ID3D12DescriptorHeap* heaps[] = { mDescriptorBuffer->descriptorHeap.Get() };
-	commandList->SetDescriptorHeaps(1, heaps);
+	// Set descriptor heap, it's the same for the entire command list
+	if (!mDescriptorHeapSet) {
+		ID3D12DescriptorHeap* heaps[] = { mDescriptorBuffer->descriptorHeap.Get() };
+		commandList->SetDescriptorHeaps(1, heaps);
+		mDescriptorHeapSet = true;
+	}
+
+	// The bindless tables are the same for all pipelines, so they only need to be set when the
+	// root signature changes (requires the descriptor heap to be set)
+	if (rootSignatureChanged) {
+		if (pipeline.bindlessTexturesParameterIndex != ~0u) {
+			commandList->SetGraphicsRootDescriptorTable(
+				pipeline.bindlessTexturesParameterIndex, bindless.tableStartGpu);
+		}
+		if (pipeline.bindlessBuffersParameterIndex != ~0u) {
+			commandList->SetGraphicsRootDescriptorTable(
+				pipeline.bindlessBuffersParameterIndex, bindless.tableStartGpu);
+		}
+	}
 
 	return ZG_SUCCESS;
 }
@@ -585,7 +990,7 @@ ZgResult D3D12CommandList::setFramebuffer(
 			setTextureState(*renderTarget, 0, D3D12_RESOURCE_STATE_RENDER_TARGET);
 
 			// Insert into residency set
-			residencySet->Insert(&renderTarget->textureHeap->managedObject);
+			insertIntoResidencySet(renderTarget->textureHeap);
 		}
 
 		// Depth buffer
@@ -597,7 +1002,7 @@ ZgResult D3D12CommandList::setFramebuffer(
 			setTextureState(*depthBuffer, 0, D3D12_RESOURCE_STATE_DEPTH_WRITE);
 
 			// Insert into residency set
-			residencySet->Insert(&depthBuffer->textureHeap->managedObject);
+			insertIntoResidencySet(depthBuffer->textureHeap);
 		}
 	}
 
@@ -781,7 +1186,7 @@ ZgResult D3D12CommandList::setIndexBuffer(
 	commandList->IASetIndexBuffer(&indexBufferView);
 
 	// Insert into residency set
-	residencySet->Insert(&indexBuffer.memoryHeap->managedObject);
+	insertIntoResidencySet(indexBuffer.memoryHeap);
 
 	return ZG_SUCCESS;
 }
@@ -825,7 +1230,7 @@ ZgResult D3D12CommandList::setVertexBuffer(
 	commandList->IASetVertexBuffers(vertexBufferSlot, 1, &vertexBufferView);
 
 	// Insert into residency set
-	residencySet->Insert(&vertexBuffer.memoryHeap->managedObject);
+	insertIntoResidencySet(vertexBuffer.memoryHeap);
 
 	return ZG_SUCCESS;
 }
@@ -868,8 +1273,20 @@ ZgResult D3D12CommandList::reset() noexcept
 	pendingTextureIdentifiers.clear();
 	pendingTextureStates.clear();
 
+	referencedHeaps.clear();
+	referencedHeapsOverflowed = false;
+
+	// Only holds segments if the command list was never executed
+	mDescriptorBuffer->releaseSegments(descriptorSegments);
+
 	mPipelineSet = false;
 	mBoundPipeline = nullptr;
+	mBoundRootSignature = nullptr;
+	mDescriptorHeapSet = false;
+	mBoundTableValid = false;
+	mBoundTableLayoutHash = 0;
+	mBoundTableBindings = {};
+	mDescriptorTableCache.clear();
 	mFramebufferSet = false;
 	mFramebuffer = nullptr;
 	return ZG_SUCCESS;
@@ -878,6 +1295,19 @@ ZgResult D3D12CommandList::reset() noexcept
 // D3D12CommandList: Private methods
 // ------------------------------------------------------------------------------------------------
 
+void D3D12CommandList::insertIntoResidencySet(D3D12MemoryHeap* heap) noexcept
+{
+	residencySet->Insert(&heap->managedObject);
+
+	// Also remember the heap so the residency policy can be told it's in use on execution
+	for (uint32_t i = 0; i < referencedHeaps.size(); i++) {
+		if (referencedHeaps[i] == heap) return;
+	}
+	if (!referencedHeaps.add(heap)) {
+		referencedHeapsOverflowed = true;
+	}
+}
+
 ZgResult D3D12CommandList::getPendingBufferStates(
 	D3D12Buffer& buffer,
 	D3D12_RESOURCE_STATES neededState,
@@ -896,15 +1326,13 @@ ZgResult D3D12CommandList::getPendingBufferStates(
 	// If buffer does not have a pending state, create one
 	if (bufferStateIdx == ~0u) {
 
-		// Check if we have enough space for another pending state
-		if (pendingBufferStates.size() == pendingBufferStates.capacity()) {
-			return ZG_ERROR_GENERIC;
-		}
-
 		// Create pending buffer state
 		bufferStateIdx = pendingBufferStates.size();
-		pendingBufferIdentifiers.add(buffer.identifier);
-		pendingBufferStates.add(PendingBufferState());
+		if (!pendingBufferIdentifiers.add(buffer.identifier)) return ZG_ERROR_CPU_OUT_OF_MEMORY;
+		if (!pendingBufferStates.add(PendingBufferState())) {
+			pendingBufferIdentifiers.pop();
+			return ZG_ERROR_CPU_OUT_OF_MEMORY;
+		}
 
 		// Set initial pending buffer state
 		pendingBufferStates.last().buffer = &buffer;
@@ -957,18 +1385,16 @@ ZgResult D3D12CommandList::getPendingTextureStates(
 	// If texture does not have a pending state, create one
 	if (textureStateIdx == ~0u) {
 
-		// Check if we have enough space for another pending state
-		if (pendingTextureStates.size() == pendingTextureStates.capacity()) {
-			return ZG_ERROR_GENERIC;
-		}
-
 		// Create pending buffer state
 		textureStateIdx = pendingTextureStates.size();
 		TextureMipIdentifier identifier;
 		identifier.identifier = texture.identifier;
 		identifier.mipLevel = mipLevel;
-		pendingTextureIdentifiers.add(identifier);
-		pendingTextureStates.add(PendingTextureState());
+		if (!pendingTextureIdentifiers.add(identifier)) return ZG_ERROR_CPU_OUT_OF_MEMORY;
+		if (!pendingTextureStates.add(PendingTextureState())) {
+			pendingTextureIdentifiers.pop();
+			return ZG_ERROR_CPU_OUT_OF_MEMORY;
+		}
 		
 		// Set initial pending buffer state
 		pendingTextureStates.last().texture = &texture;
@@ -1010,12 +1436,19 @@ ZgResult D3D12CommandList::setTextureStateAllMipLevels(
 	D3D12Texture2D& texture,
 	D3D12_RESOURCE_STATES targetState) noexcept
 {
-	// Get pending states
-	PendingTextureState* pendingStates[ZG_MAX_NUM_MIPMAPS] = {};
+	// Get pending states. Store indices while gathering, creating a pending state might grow the
+	// array and invalidate pointers to earlier ones.
+	uint32_t pendingStateIndices[ZG_MAX_NUM_MIPMAPS] = {};
 	for (uint32_t i = 0; i < texture.numMipmaps; i++) {
+		PendingTextureState* pendingState = nullptr;
 		ZgResult pendingStateRes = getPendingTextureStates(
-			texture, i, targetState, pendingStates[i]);
+			texture, i, targetState, pendingState);
 		if (pendingStateRes != ZG_SUCCESS) return pendingStateRes;
+		pendingStateIndices[i] = uint32_t(pendingState - pendingTextureStates.data());
+	}
+	PendingTextureState* pendingStates[ZG_MAX_NUM_MIPMAPS] = {};
+	for (uint32_t i = 0; i < texture.numMipmaps; i++) {
+		pendingStates[i] = &pendingTextureStates[pendingStateIndices[i]];
 	}
 
 	// Create all necessary barriers
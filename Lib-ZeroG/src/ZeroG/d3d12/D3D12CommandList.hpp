@@ -21,14 +21,19 @@
 #include "ZeroG.h"
 #include "ZeroG/d3d12/D3D12Common.hpp"
 #include "ZeroG/d3d12/D3D12DescriptorRingBuffer.hpp"
+#include "ZeroG/d3d12/D3D12DescriptorTableCache.hpp"
 #include "ZeroG/d3d12/D3D12Framebuffer.hpp"
 #include "ZeroG/d3d12/D3D12Buffer.hpp"
 #include "ZeroG/d3d12/D3D12PipelineRender.hpp"
 #include "ZeroG/BackendInterface.hpp"
-#include "ZeroG/util/Vector.hpp"
+#include "ZeroG/util/SmallVector.hpp"
 
 namespace zg {
 
+// Number of pending states (and referenced heaps) a command list can keep track of before it
+// needs to allocate memory
+constexpr uint32_t COMMAND_LIST_NUM_INLINE_STATES = 32;
+
 // D3D12CommandList
 // ------------------------------------------------------------------------------------------------
 
@@ -48,7 +53,6 @@ public:
 	// --------------------------------------------------------------------------------------------
 
 	void create(
-		uint32_t maxNumBuffers,
 		ComPtr<ID3D12Device3> device,
 		D3DX12Residency::ResidencyManager* residencyManager,
 		D3D12DescriptorRingBuffer* descriptorBuffer) noexcept;
@@ -71,18 +75,38 @@ public:
 		const ZgImageViewConstCpu& srcImageCpu,
 		ZgBuffer* tempUploadBuffer) noexcept override final;
 
+	ZgResult memcpyToTextureMipChain(
+		ZgTexture2D* dstTexture,
+		const ZgImageViewConstCpu* srcImagesCpu,
+		uint32_t numMipLevels,
+		ZgBuffer* tempUploadBuffer,
+		uint64_t tempUploadBufferOffsetBytes) noexcept override final;
+
 	ZgResult enableQueueTransitionBuffer(ZgBuffer* buffer) noexcept override final;
 
 	ZgResult enableQueueTransitionTexture(ZgTexture2D* texture) noexcept override final;
 
+	ZgResult activateTransientTexture(ZgTexture2D* texture) noexcept override final;
+
 	ZgResult setPushConstant(
 		uint32_t shaderRegister,
 		const void* data,
 		uint32_t dataSizeInBytes) noexcept override final;
 
+	ZgResult setRootConstantBuffer(
+		uint32_t shaderRegister,
+		ZgBuffer* buffer,
+		uint64_t offsetInBytes) noexcept override final;
+
 	ZgResult setPipelineBindings(
 		const ZgPipelineBindings& bindings) noexcept override final;
 
+	ZgResult useBindlessResources(
+		ZgBuffer* const* buffers,
+		uint32_t numBuffers,
+		ZgTexture2D* const* textures,
+		uint32_t numTextures) noexcept override final;
+
 	ZgResult setPipelineRender(
 		ZgPipelineRender* pipeline) noexcept override final;
 
@@ -139,20 +163,30 @@ public:
 
 	D3DX12Residency::ResidencySet* residencySet = nullptr;
 
-	Vector<uint64_t> pendingBufferIdentifiers;
-	Vector<PendingBufferState> pendingBufferStates;
+	SmallVector<uint64_t, COMMAND_LIST_NUM_INLINE_STATES> pendingBufferIdentifiers;
+	SmallVector<PendingBufferState, COMMAND_LIST_NUM_INLINE_STATES> pendingBufferStates;
 
 	struct TextureMipIdentifier {
 		uint64_t identifier = ~0u;
 		uint32_t mipLevel = ~0u;
 	};
-	Vector<TextureMipIdentifier> pendingTextureIdentifiers;
-	Vector<PendingTextureState> pendingTextureStates;
+	SmallVector<TextureMipIdentifier, COMMAND_LIST_NUM_INLINE_STATES> pendingTextureIdentifiers;
+	SmallVector<PendingTextureState, COMMAND_LIST_NUM_INLINE_STATES> pendingTextureStates;
+
+	// The heaps inserted into the residency set. If memory for tracking them can't be allocated
+	// the overflow flag is set instead, meaning that any heap could have been referenced.
+	SmallVector<ZgMemoryHeap*, COMMAND_LIST_NUM_INLINE_STATES> referencedHeaps;
+	bool referencedHeapsOverflowed = false;
+
+	// The descriptor ring buffer segments used by the command list, retired when executed
+	D3D12DescriptorSegments descriptorSegments;
 
 private:
 	// Private methods
 	// --------------------------------------------------------------------------------------------
 
+	void insertIntoResidencySet(D3D12MemoryHeap* heap) noexcept;
+
 	ZgResult getPendingBufferStates(
 		D3D12Buffer& buffer,
 		D3D12_RESOURCE_STATES neededState,
@@ -181,8 +215,14 @@ private:
 	ComPtr<ID3D12Device3> mDevice;
 	D3DX12Residency::ResidencyManager* mResidencyManager = nullptr;
 	D3D12DescriptorRingBuffer* mDescriptorBuffer = nullptr;
-	bool mPipelineSet = false; // Only allow a single pipeline per command list
+	bool mPipelineSet = false;
 	D3D12PipelineRender* mBoundPipeline = nullptr;
+	ID3D12RootSignature* mBoundRootSignature = nullptr;
+	bool mDescriptorHeapSet = false;
+	bool mBoundTableValid = false; // Whether the bound descriptor table matches the fields below
+	uint64_t mBoundTableLayoutHash = 0;
+	ZgPipelineBindings mBoundTableBindings = {};
+	D3D12DescriptorTableCache mDescriptorTableCache;
 	bool mFramebufferSet = false; // Only allow a single framebuffer to be set.
 	D3D12Framebuffer* mFramebuffer = nullptr;
 };
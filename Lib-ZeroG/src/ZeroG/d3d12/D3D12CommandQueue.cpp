@@ -78,13 +78,16 @@ ZgResult D3D12CommandQueue::create(
 	D3D12_COMMAND_LIST_TYPE type,
 	ComPtr<ID3D12Device3>& device,
 	D3DX12Residency::ResidencyManager* residencyManager,
+	ResidencyPolicy* residencyPolicy,
+	uint32_t residencyQueueIdx,
 	D3D12DescriptorRingBuffer* descriptorBuffer,
-	uint32_t maxNumCommandLists,
-	uint32_t maxNumBuffersPerCommandList) noexcept
+	uint32_t maxNumCommandLists) noexcept
 {
 	mType = type;
 	mDevice = device;
 	mResidencyManager = residencyManager;
+	mResidencyPolicy = residencyPolicy;
+	mResidencyQueueIdx = residencyQueueIdx;
 	mDescriptorBuffer = descriptorBuffer;
 
 	// Create command queue
@@ -104,11 +107,14 @@ ZgResult D3D12CommandQueue::create(
 		return ZG_ERROR_GENERIC;
 	}
 
+	// The fence starts out with the initial value as its completed value, so the first value
+	// signaled must be larger. Otherwise the first submission is considered done immediately.
+	mCommandQueueFenceValue += 1;
+
 	// Create command queue fence event
 	mCommandQueueFenceEvent = ::CreateEvent(NULL, false, false, NULL);
 
 	// Allocate memory for command lists
-	mMaxNumBuffersPerCommandList = maxNumBuffersPerCommandList;
 	mCommandListStorage.create(
 		maxNumCommandLists, "ZeroG - D3D12CommandQueue - CommandListStorage");
 	mCommandListQueue.create(
@@ -178,11 +184,32 @@ void D3D12CommandQueue::waitOnCpuInternal(uint64_t fenceValue) noexcept
 	}
 }
 
+void D3D12CommandQueue::waitOnCpuUnlocked(uint64_t fenceValue) noexcept
+{
+	// A null event makes SetEventOnCompletion() block until the fence value is reached, which
+	// unlike the shared event is safe to do from several threads at once
+	if (!isFenceValueDone(fenceValue)) {
+		CHECK_D3D12 mCommandQueueFence->SetEventOnCompletion(fenceValue, nullptr);
+	}
+}
+
 bool D3D12CommandQueue::isFenceValueDone(uint64_t fenceValue) noexcept
 {
 	return mCommandQueueFence->GetCompletedValue() >= fenceValue;
 }
 
+uint64_t D3D12CommandQueue::completedFenceValue() noexcept
+{
+	return mCommandQueueFence->GetCompletedValue();
+}
+
+std::unique_lock<std::mutex> D3D12CommandQueue::lockIfNotRecording() noexcept
+{
+	std::unique_lock<std::mutex> lock(mQueueMutex);
+	if (mNumRecordingCommandLists != 0) lock.unlock();
+	return lock;
+}
+
 // D3D12CommandQueue: Private  methods
 // ------------------------------------------------------------------------------------------------
 
@@ -216,6 +243,7 @@ ZgResult D3D12CommandQueue::beginCommandListRecordingUnmutexed(
 	CHECK_D3D12 commandList->residencySet->Open();
 
 	// Return command list
+	mNumRecordingCommandLists += 1;
 	*commandListOut = commandList;
 	return ZG_SUCCESS;
 }
@@ -224,6 +252,8 @@ ZgResult D3D12CommandQueue::executeCommandListUnmutexed(ZgCommandList* commandLi
 {
 	// Cast to D3D12
 	D3D12CommandList& commandList = *static_cast<D3D12CommandList*>(commandListIn);
+	ZG_ASSERT(mNumRecordingCommandLists != 0);
+	mNumRecordingCommandLists -= 1;
 
 	// Close command list
 	if (D3D12_FAIL(commandList.commandList->Close())) {
@@ -235,10 +265,24 @@ ZgResult D3D12CommandQueue::executeCommandListUnmutexed(ZgCommandList* commandLi
 		return ZG_ERROR_GENERIC;
 	}
 
+	// Tell residency policy which heaps are used before anything is submitted, so they can't be
+	// evicted while in use. The state change command list executed below signals at most once
+	// before this command list does, hence the +1.
+	uint64_t upperBoundFenceValue = mCommandQueueFenceValue + 1;
+	if (commandList.referencedHeapsOverflowed) {
+		mResidencyPolicy->markAllUsed(mResidencyQueueIdx, upperBoundFenceValue);
+	}
+	else {
+		mResidencyPolicy->markUsed(commandList.referencedHeaps.data(),
+			commandList.referencedHeaps.size(), mResidencyQueueIdx, upperBoundFenceValue);
+	}
+
 	// Create and execute a quick command list to insert barriers and commit pending states
 	ZgResult res = this->executePreCommandListStateChanges(
-		commandList.pendingBufferStates,
-		commandList.pendingTextureStates);
+		commandList.pendingBufferStates.data(),
+		commandList.pendingBufferStates.size(),
+		commandList.pendingTextureStates.data(),
+		commandList.pendingTextureStates.size());
 	if (res != ZG_SUCCESS) return res;
 
 	// Execute command list
@@ -249,6 +293,9 @@ ZgResult D3D12CommandQueue::executeCommandListUnmutexed(ZgCommandList* commandLi
 	// Signal
 	commandList.fenceValue = this->signalOnGpuUnmutexed();
 
+	// The command list's descriptors can be reused once the GPU has executed it
+	mDescriptorBuffer->retireSegments(commandList.descriptorSegments, this, commandList.fenceValue);
+
 	// Add command list to queue
 	mCommandListQueue.add(&commandList);
 
@@ -295,26 +342,26 @@ ZgResult D3D12CommandQueue::createCommandList(D3D12CommandList*& commandListOut)
 	}
 
 	// Initialize command list
-	commandList.create(mMaxNumBuffersPerCommandList, mDevice, mResidencyManager,
-		mDescriptorBuffer);
+	commandList.create(mDevice, mResidencyManager, mDescriptorBuffer);
 
 	commandListOut = &commandList;
 	return ZG_SUCCESS;
 }
 
 ZgResult D3D12CommandQueue::executePreCommandListStateChanges(
-	Vector<PendingBufferState>& pendingBufferStates,
-	Vector<PendingTextureState>& pendingTextureStates) noexcept
+	const PendingBufferState* pendingBufferStates,
+	uint32_t numPendingBufferStates,
+	const PendingTextureState* pendingTextureStates,
+	uint32_t numPendingTextureStates) noexcept
 {
-	// Temporary storage array for the barriers to insert
-	uint32_t numBarriers = 0;
-	constexpr uint32_t MAX_NUM_BARRIERS = 512;
-	CD3DX12_RESOURCE_BARRIER barriers[MAX_NUM_BARRIERS] = {};
-	constexpr uint32_t MAX_NUM_RESIDENCY_OBJECTS = 1024;
-	D3DX12Residency::ManagedObject* residencyObjects[MAX_NUM_RESIDENCY_OBJECTS] = {};
+	// Temporary storage for the barriers to insert, only allocates if there are many
+	SmallVector<CD3DX12_RESOURCE_BARRIER, 64> barriers;
+	barriers.create(0, "ZeroG - D3D12CommandQueue - Barriers");
+	SmallVector<D3DX12Residency::ManagedObject*, 64> residencyObjects;
+	residencyObjects.create(0, "ZeroG - D3D12CommandQueue - Barriers");
 
 	// Gather buffer barriers
-	for (uint32_t i = 0; i < pendingBufferStates.size(); i++) {
+	for (uint32_t i = 0; i < numPendingBufferStates; i++) {
 		const PendingBufferState& state = pendingBufferStates[i];
 
 		// Don't insert barrier if resource already is in correct state
@@ -322,26 +369,18 @@ ZgResult D3D12CommandQueue::executePreCommandListStateChanges(
 			continue;
 		}
 
-		// Error out if we don't have enough space in our temp array
-		if (numBarriers >= MAX_NUM_BARRIERS) {
-			ZG_ERROR("Internal error, need to insert too many barriers. Fixable, please contact ZeroG devs.");
-			return ZG_ERROR_GENERIC;
-		}
-
-		// Create barrier
-		barriers[numBarriers] = CD3DX12_RESOURCE_BARRIER::Transition(
+		// Create barrier and store residency object
+		bool barrierAdded = barriers.add(CD3DX12_RESOURCE_BARRIER::Transition(
 			state.buffer->resource.Get(),
 			state.buffer->lastCommittedState,
-			state.neededInitialState);
-
-		// Store residency set
-		residencyObjects[numBarriers] = &state.buffer->memoryHeap->managedObject;
-
-		numBarriers += 1;
+			state.neededInitialState));
+		bool residencyObjectAdded =
+			residencyObjects.add(&state.buffer->memoryHeap->managedObject);
+		if (!barrierAdded || !residencyObjectAdded) return ZG_ERROR_CPU_OUT_OF_MEMORY;
 	}
 
 	// Gather texture barriers
-	for (uint32_t i = 0; i < pendingTextureStates.size(); i++) {
+	for (uint32_t i = 0; i < numPendingTextureStates; i++) {
 		const PendingTextureState& state = pendingTextureStates[i];
 
 		// Don't insert barrier if resource already is in correct state
@@ -349,27 +388,19 @@ ZgResult D3D12CommandQueue::executePreCommandListStateChanges(
 			continue;
 		}
 
-		// Error out if we don't have enough space in our temp array
-		if (numBarriers >= MAX_NUM_BARRIERS) {
-			ZG_ERROR("Internal error, need to insert too many barriers. Fixable, please contact ZeroG devs.");
-			return ZG_ERROR_GENERIC;
-		}
-
-		// Create barrier
-		barriers[numBarriers] = CD3DX12_RESOURCE_BARRIER::Transition(
+		// Create barrier and store residency object
+		bool barrierAdded = barriers.add(CD3DX12_RESOURCE_BARRIER::Transition(
 			state.texture->resource.Get(),
 			state.texture->lastCommittedStates[state.mipLevel],
 			state.neededInitialState,
-			state.mipLevel);
-
-		// Store residency set
-		residencyObjects[numBarriers] = &state.texture->textureHeap->managedObject;
-
-		numBarriers += 1;
+			state.mipLevel));
+		bool residencyObjectAdded =
+			residencyObjects.add(&state.texture->textureHeap->managedObject);
+		if (!barrierAdded || !residencyObjectAdded) return ZG_ERROR_CPU_OUT_OF_MEMORY;
 	}
 
 	// Exit if we do not need to insert any barriers
-	if (numBarriers == 0) return ZG_SUCCESS;
+	if (barriers.size() == 0) return ZG_SUCCESS;
 
 	// Get command list to execute barriers in
 	D3D12CommandList* commandList = nullptr;
@@ -378,10 +409,10 @@ ZgResult D3D12CommandQueue::executePreCommandListStateChanges(
 	if (res != ZG_SUCCESS) return res;
 
 	// Insert barrier call
-	commandList->commandList->ResourceBarrier(numBarriers, barriers);
+	commandList->commandList->ResourceBarrier(barriers.size(), barriers.data());
 
 	// Add all managed objects to residency set
-	for (uint32_t i = 0; i < numBarriers; i++) {
+	for (uint32_t i = 0; i < residencyObjects.size(); i++) {
 		commandList->residencySet->Insert(residencyObjects[i]);
 	}
 
@@ -394,11 +425,11 @@ ZgResult D3D12CommandQueue::executePreCommandListStateChanges(
 	// TODO: This is problematic and we probably need to something smarter. TL;DR, this comitted
 	//       state is shared between all queues. Maybe it is enough to just put a mutex around it,
 	//       but it is not obvious to me that that would be enough.
-	for (uint32_t i = 0; i < pendingBufferStates.size(); i++) {
+	for (uint32_t i = 0; i < numPendingBufferStates; i++) {
 		const PendingBufferState& state = pendingBufferStates[i];
 		state.buffer->lastCommittedState = state.currentState;
 	}
-	for (uint32_t i = 0; i < pendingTextureStates.size(); i++) {
+	for (uint32_t i = 0; i < numPendingTextureStates; i++) {
 		const PendingTextureState& state = pendingTextureStates[i];
 		state.texture->lastCommittedStates[state.mipLevel] = state.currentState;
 	}
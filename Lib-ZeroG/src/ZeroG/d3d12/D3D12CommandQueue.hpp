@@ -28,6 +28,7 @@
 #include "ZeroG/util/RingBuffer.hpp"
 #include "ZeroG/util/Vector.hpp"
 #include "ZeroG/BackendInterface.hpp"
+#include "ZeroG/ResidencyPolicy.hpp"
 
 namespace zg {
 
@@ -85,9 +86,10 @@ public:
 		D3D12_COMMAND_LIST_TYPE type,
 		ComPtr<ID3D12Device3>& device,
 		D3DX12Residency::ResidencyManager* residencyManager,
+		ResidencyPolicy* residencyPolicy,
+		uint32_t residencyQueueIdx,
 		D3D12DescriptorRingBuffer* descriptorBuffer,
-		uint32_t maxNumCommandLists,
-		uint32_t maxNumBuffersPerCommandList) noexcept;
+		uint32_t maxNumCommandLists) noexcept;
 
 	// Virtual methods
 	// --------------------------------------------------------------------------------------------
@@ -103,7 +105,17 @@ public:
 
 	uint64_t signalOnGpuInternal() noexcept;
 	void waitOnCpuInternal(uint64_t fenceValue) noexcept;
+
+	// Waits for the fence value without locking the queue, so other threads can keep using the
+	// queue meanwhile
+	void waitOnCpuUnlocked(uint64_t fenceValue) noexcept;
+
 	bool isFenceValueDone(uint64_t fenceValue) noexcept;
+	uint64_t completedFenceValue() noexcept;
+
+	// Locks the queue if no command lists are currently being recorded on it, returns an unlocked
+	// lock otherwise. No command list can begin recording on the queue while it is held.
+	std::unique_lock<std::mutex> lockIfNotRecording() noexcept;
 
 	// Getters
 	// --------------------------------------------------------------------------------------------
@@ -122,8 +134,10 @@ private:
 	ZgResult createCommandList(D3D12CommandList*& commandListOut) noexcept;
 
 	ZgResult executePreCommandListStateChanges(
-		Vector<PendingBufferState>& pendingBufferStates,
-		Vector<PendingTextureState>& pendingTextureStates) noexcept;
+		const PendingBufferState* pendingBufferStates,
+		uint32_t numPendingBufferStates,
+		const PendingTextureState* pendingTextureStates,
+		uint32_t numPendingTextureStates) noexcept;
 
 	// Private members
 	// --------------------------------------------------------------------------------------------
@@ -132,6 +146,8 @@ private:
 	D3D12_COMMAND_LIST_TYPE mType;
 	ComPtr<ID3D12Device3> mDevice;
 	D3DX12Residency::ResidencyManager* mResidencyManager = nullptr;
+	ResidencyPolicy* mResidencyPolicy = nullptr;
+	uint32_t mResidencyQueueIdx = 0;
 	D3D12DescriptorRingBuffer* mDescriptorBuffer = nullptr;
 	
 	ComPtr<ID3D12CommandQueue> mCommandQueue;
@@ -140,9 +156,9 @@ private:
 	uint64_t mCommandQueueFenceValue = 0;
 	HANDLE mCommandQueueFenceEvent = nullptr;
 
-	uint32_t mMaxNumBuffersPerCommandList = 0;
 	Vector<D3D12CommandList> mCommandListStorage;
 	RingBuffer<D3D12CommandList*> mCommandListQueue;
+	uint32_t mNumRecordingCommandLists = 0;
 };
 
 } // namespace zg
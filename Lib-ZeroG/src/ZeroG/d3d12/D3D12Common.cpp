@@ -112,6 +112,12 @@ bool utf8ToWide(WCHAR* wideOut, uint32_t numWideChars, const char* utf8In) noexc
 	return res != 0;
 }
 
+bool wideToUtf8(char* utf8Out, uint32_t numBytes, const WCHAR* wideIn) noexcept
+{
+	int res = WideCharToMultiByte(CP_UTF8, 0, wideIn, -1, utf8Out, numBytes, NULL, NULL);
+	return res != 0;
+}
+
 HRESULT CheckD3D12Impl::operator% (HRESULT result) noexcept
 {
 	if (SUCCEEDED(result)) return result;
@@ -109,6 +109,7 @@ DXGI_FORMAT zgToDxgiTextureFormat(ZgTextureFormat format) noexcept;
 // ------------------------------------------------------------------------------------------------
 
 bool utf8ToWide(WCHAR* wideOut, uint32_t numWideChars, const char* utf8In) noexcept;
+bool wideToUtf8(char* utf8Out, uint32_t numBytes, const WCHAR* wideIn) noexcept;
 
 // Checks result (HRESULT) from D3D call and log if not success, returns result unmodified
 #define CHECK_D3D12 (CheckD3D12Impl(__FILE__, __LINE__)) %
@@ -18,8 +18,23 @@
 
 #include "ZeroG/d3d12/D3D12DescriptorRingBuffer.hpp"
 
+#include <algorithm>
+
+#include "ZeroG/d3d12/D3D12CommandQueue.hpp"
+#include "ZeroG/util/Assert.hpp"
+
 namespace zg {
 
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+constexpr uint32_t DEFAULT_NUM_DESCRIPTORS = 1000000;
+constexpr uint32_t DEFAULT_NUM_DESCRIPTORS_PER_SEGMENT = 4096;
+constexpr uint32_t MIN_NUM_DESCRIPTORS_PER_SEGMENT = 256;
+
+// D3D12DescriptorRingBuffer: Constructors & destructors
+// ------------------------------------------------------------------------------------------------
+
 D3D12DescriptorRingBuffer::~D3D12DescriptorRingBuffer() noexcept
 {
 	if (descriptorHeap != nullptr) {
@@ -34,14 +49,41 @@ D3D12DescriptorRingBuffer::~D3D12DescriptorRingBuffer() noexcept
 ZgResult D3D12DescriptorRingBuffer::create(
 	ID3D12Device3& device,
 	D3D12_DESCRIPTOR_HEAP_TYPE type,
-	uint32_t numDescriptors) noexcept
+	const ZgDescriptorSettings& settings) noexcept
 {
 	mDevice = &device;
-	mNumDescriptors = numDescriptors;
+
+	// Divide heap into segments
+	uint32_t numDescriptors = settings.numDescriptors;
+	if (numDescriptors == 0) numDescriptors = DEFAULT_NUM_DESCRIPTORS;
+	mNumDescriptorsPerSegment = settings.numDescriptorsPerSegment;
+	if (mNumDescriptorsPerSegment == 0) {
+		mNumDescriptorsPerSegment = DEFAULT_NUM_DESCRIPTORS_PER_SEGMENT;
+	}
+	if (mNumDescriptorsPerSegment < MIN_NUM_DESCRIPTORS_PER_SEGMENT) {
+		mNumDescriptorsPerSegment = MIN_NUM_DESCRIPTORS_PER_SEGMENT;
+	}
+
+	// The bindless descriptors are reserved at the start of the heap, before the segments
+	mNumReservedDescriptors = settings.numBindlessDescriptors;
+	if (mNumReservedDescriptors >= numDescriptors) {
+		ZG_ERROR("%u bindless descriptors leaves no room for segments in a heap of %u descriptors",
+			mNumReservedDescriptors, numDescriptors);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+	mNumSegments = (numDescriptors - mNumReservedDescriptors) / mNumDescriptorsPerSegment;
+	if (mNumSegments == 0) {
+		ZG_ERROR("Descriptor heap of %u descriptors is smaller than a segment (%u descriptors)",
+			numDescriptors - mNumReservedDescriptors, mNumDescriptorsPerSegment);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+	ZG_INFO("Attempting to allocate %u descriptors for the global ring buffer (%u segments, "
+		"%u bindless)", mNumReservedDescriptors + mNumSegments * mNumDescriptorsPerSegment,
+		mNumSegments, mNumReservedDescriptors);
 
 	D3D12_DESCRIPTOR_HEAP_DESC desc = {};
 	desc.Type = type;
-	desc.NumDescriptors = numDescriptors;
+	desc.NumDescriptors = mNumReservedDescriptors + mNumSegments * mNumDescriptorsPerSegment;
 	desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 	desc.NodeMask = 0;
 
@@ -63,6 +105,20 @@ ZgResult D3D12DescriptorRingBuffer::create(
 	mHeapStartCpu = descriptorHeap->GetCPUDescriptorHandleForHeapStart();
 	mHeapStartGpu = descriptorHeap->GetGPUDescriptorHandleForHeapStart();
 
+	// Bindless descriptors are at the very start of the heap
+	bindlessDescriptors.create(
+		device, mHeapStartCpu, mHeapStartGpu, descriptorSize, mNumReservedDescriptors);
+
+	// All segments are initially free, in reverse order so that the first ones are used first
+	mFreeSegments.create(mNumSegments, "ZeroG - D3D12DescriptorRingBuffer - FreeSegments");
+	for (uint32_t i = 0; i < mNumSegments; i++) {
+		mFreeSegments.add(mNumSegments - i - 1);
+	}
+	for (QueueRetiredSegments& retired : mRetiredSegments) {
+		retired.segments.create(
+			mNumSegments, "ZeroG - D3D12DescriptorRingBuffer - RetiredSegments");
+	}
+
 	return ZG_SUCCESS;
 }
 
@@ -70,27 +126,169 @@ ZgResult D3D12DescriptorRingBuffer::create(
 // ------------------------------------------------------------------------------------------------
 
 ZgResult D3D12DescriptorRingBuffer::allocateDescriptorRange(
+	D3D12DescriptorSegments& owner,
 	uint32_t numDescriptors,
 	D3D12_CPU_DESCRIPTOR_HANDLE& rangeStartCpu,
 	D3D12_GPU_DESCRIPTOR_HANDLE& rangeStartGpu) noexcept
 {
-	// Allocate range
-	uint64_t rangeStart = mHeadPointer.fetch_add(numDescriptors);
+	if (numDescriptors > mNumDescriptorsPerSegment) {
+		ZG_ERROR("Can't allocate %u descriptors at once, segments are %u descriptors",
+			numDescriptors, mNumDescriptorsPerSegment);
+		return ZG_ERROR_OUT_OF_DESCRIPTORS;
+	}
 
-	// Map range to the ringbuffers allowed indices
-	uint32_t mappedRangeStart = uint32_t(rangeStart % uint64_t(mNumDescriptors));
-	
-	// Check if range fits continuously, if not, try again recursively
-	bool rangeIsContinuous = (mappedRangeStart + numDescriptors) <= mNumDescriptors;
-	if (!rangeIsContinuous) {
-		return this->allocateDescriptorRange(numDescriptors, rangeStartCpu, rangeStartGpu);
+	// Acquire a new segment if the range does not fit in the current one
+	bool fits = owner.segments.size() != 0 &&
+		(owner.numUsedInLast + numDescriptors) <= mNumDescriptorsPerSegment;
+	if (!fits) {
+		uint32_t segmentIdx = ~0u;
+		ZgResult res = this->acquireSegment(segmentIdx);
+		if (res != ZG_SUCCESS) return res;
+		if (owner.segments.capacity() == 0) {
+			owner.segments.create(4, "ZeroG - D3D12DescriptorSegments");
+		}
+		if (!owner.segments.add(segmentIdx)) {
+			std::lock_guard<std::mutex> lock(mMutex);
+			mFreeSegments.add(segmentIdx);
+			return ZG_ERROR_CPU_OUT_OF_MEMORY;
+		}
+		owner.numUsedInLast = 0;
 	}
 
-	// Return descriptors to the start of the range
-	rangeStartCpu.ptr = mHeapStartCpu.ptr + descriptorSize * mappedRangeStart;
-	rangeStartGpu.ptr = mHeapStartGpu.ptr + descriptorSize * mappedRangeStart;
+	// Allocate range from the end of the segment
+	uint32_t rangeStart = mNumReservedDescriptors +
+		owner.segments.last() * mNumDescriptorsPerSegment + owner.numUsedInLast;
+	owner.numUsedInLast += numDescriptors;
+	rangeStartCpu.ptr = mHeapStartCpu.ptr + uint64_t(descriptorSize) * rangeStart;
+	rangeStartGpu.ptr = mHeapStartGpu.ptr + uint64_t(descriptorSize) * rangeStart;
 
 	return ZG_SUCCESS;
 }
 
+void D3D12DescriptorRingBuffer::retireSegments(
+	D3D12DescriptorSegments& owner,
+	D3D12CommandQueue* queue,
+	uint64_t fenceValue) noexcept
+{
+	if (owner.segments.size() == 0) return;
+	std::lock_guard<std::mutex> lock(mMutex);
+	QueueRetiredSegments* queueRetired = this->retiredSegmentsForQueue(queue);
+	ZG_ASSERT(queueRetired != nullptr);
+	for (uint32_t i = 0; i < owner.segments.size(); i++) {
+		RetiredSegment retired;
+		retired.segmentIdx = owner.segments[i];
+		retired.fenceValue = fenceValue;
+		retired.retireIdx = mNextRetireIdx;
+		mNextRetireIdx += 1;
+		queueRetired->segments.add(retired);
+	}
+	owner.segments.clear();
+	owner.numUsedInLast = 0;
+}
+
+void D3D12DescriptorRingBuffer::releaseSegments(D3D12DescriptorSegments& owner) noexcept
+{
+	if (owner.segments.size() == 0) return;
+	std::lock_guard<std::mutex> lock(mMutex);
+	for (uint32_t i = 0; i < owner.segments.size(); i++) {
+		mFreeSegments.add(owner.segments[i]);
+	}
+	owner.segments.clear();
+	owner.numUsedInLast = 0;
+}
+
+void D3D12DescriptorRingBuffer::getStats(ZgStats& statsOut) noexcept
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	this->reclaimSegments();
+	uint32_t numSegmentsInUse = mNumSegments - mFreeSegments.size();
+	statsOut.descriptorsNumInUse = numSegmentsInUse * mNumDescriptorsPerSegment;
+	statsOut.descriptorsPeakNumInUse = mPeakNumSegmentsInUse * mNumDescriptorsPerSegment;
+	statsOut.descriptorsNumTotal = mNumSegments * mNumDescriptorsPerSegment;
+	statsOut.descriptorsNumWaits = mNumWaits;
+	statsOut.descriptorsNumFailures = mNumFailures;
+	bindlessDescriptors.getStats(statsOut);
+}
+
+// D3D12DescriptorRingBuffer: Private methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult D3D12DescriptorRingBuffer::acquireSegment(uint32_t& segmentIdxOut) noexcept
+{
+	while (true) {
+		D3D12CommandQueue* waitQueue = nullptr;
+		uint64_t waitFenceValue = 0;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			// Reclaim segments first, so that the peak reflects how many are actually needed
+			this->reclaimSegments();
+			if (mFreeSegments.size() != 0) {
+				mFreeSegments.pop(segmentIdxOut);
+				uint32_t numSegmentsInUse = mNumSegments - mFreeSegments.size();
+				mPeakNumSegmentsInUse = std::max(mPeakNumSegmentsInUse, numSegmentsInUse);
+				return ZG_SUCCESS;
+			}
+
+			// Find the oldest retired segment over all queues
+			const QueueRetiredSegments* oldest = nullptr;
+			for (const QueueRetiredSegments& retired : mRetiredSegments) {
+				if (retired.segments.size() == 0) continue;
+				if (oldest == nullptr ||
+					retired.segments.first().retireIdx < oldest->segments.first().retireIdx) {
+					oldest = &retired;
+				}
+			}
+
+			// If no segment is retired they are all owned by command lists being recorded, waiting
+			// for them would deadlock
+			if (oldest == nullptr) {
+				mNumFailures += 1;
+				ZG_ERROR("Out of descriptors, all %u segments are used by command lists being "
+					"recorded. Increase ZgDescriptorSettings::numDescriptors.", mNumSegments);
+				return ZG_ERROR_OUT_OF_DESCRIPTORS;
+			}
+
+			waitQueue = oldest->queue;
+			waitFenceValue = oldest->segments.first().fenceValue;
+			mNumWaits += 1;
+			if (mNumWaits == 1) {
+				ZG_WARNING("Out of free descriptor segments, waiting for the GPU. Further waits "
+					"are only counted in ZgStats::descriptorsNumWaits.");
+			}
+		}
+
+		// Wait for the oldest retired segment without holding any lock, neither this ring buffer's
+		// nor the queue's, then try again. Another thread may grab the reclaimed segment first.
+		waitQueue->waitOnCpuUnlocked(waitFenceValue);
+	}
+}
+
+D3D12DescriptorRingBuffer::QueueRetiredSegments* D3D12DescriptorRingBuffer::retiredSegmentsForQueue(
+	D3D12CommandQueue* queue) noexcept
+{
+	for (QueueRetiredSegments& retired : mRetiredSegments) {
+		if (retired.queue == queue) return &retired;
+		if (retired.queue == nullptr) {
+			retired.queue = queue;
+			return &retired;
+		}
+	}
+	return nullptr;
+}
+
+void D3D12DescriptorRingBuffer::reclaimSegments() noexcept
+{
+	for (QueueRetiredSegments& retired : mRetiredSegments) {
+		if (retired.segments.size() == 0) continue;
+		const uint64_t completedFenceValue = retired.queue->completedFenceValue();
+		while (retired.segments.size() != 0) {
+			const RetiredSegment& segment = retired.segments.first();
+			if (segment.fenceValue > completedFenceValue) break;
+			mFreeSegments.add(segment.segmentIdx);
+			retired.segments.pop();
+		}
+	}
+}
+
 } // namespace zg
@@ -18,22 +18,42 @@
 
 #pragma once
 
-#include <atomic>
+#include <mutex>
 
+#include "ZeroG.h"
+#include "ZeroG/d3d12/D3D12BindlessDescriptors.hpp"
 #include "ZeroG/d3d12/D3D12Common.hpp"
+#include "ZeroG/util/RingBuffer.hpp"
+#include "ZeroG/util/SmallVector.hpp"
+#include "ZeroG/util/Vector.hpp"
 
 namespace zg {
 
+class D3D12CommandQueue;
+
+// D3D12DescriptorSegments
+// ------------------------------------------------------------------------------------------------
+
+// The segments of a D3D12DescriptorRingBuffer owned by a command list, descriptor ranges are
+// allocated linearly from the last one. Only accessed by the thread recording the command list.
+struct D3D12DescriptorSegments final {
+	SmallVector<uint32_t, 4> segments;
+	uint32_t numUsedInLast = 0;
+};
+
 // D3D12DescriptorRingBuffer class
 // ------------------------------------------------------------------------------------------------
 
 // A GPU descriptor ring buffer
 //
-// Meant to be used as a single descriptor heap used for all queues, command lists and frames.
-// Essentially an atomic counter keeps track of the head of the ring buffer, anyone can allocate
-// a range of descriptors from the top. The idea is that the heap itself will be so large that by
-// the time the head has wrapped around and reached previously allocated descriptors they are no
-// longer in use.
+// Meant to be used as a single descriptor heap used for all queues, command lists and frames, see
+// ZgDescriptorSettings. The bindless descriptors (if any) are reserved at the start of the heap,
+// see D3D12BindlessDescriptors, the rest is divided into fixed size segments. A command list
+// acquires a segment at a time and allocates descriptor ranges from it without any
+// synchronization. When the command list is executed its segments are retired, tagged with the
+// queue and fence value of the execution, and become free again once the fence has been reached.
+// Retired segments are kept in one list per queue, as a queue's fence values are reached in order
+// a segment only has to wait for its own queue, not for segments retired earlier on other queues.
 class D3D12DescriptorRingBuffer final {
 public:
 	// Constructors & destructors
@@ -52,31 +72,89 @@ public:
 	ZgResult create(
 		ID3D12Device3& device,
 		D3D12_DESCRIPTOR_HEAP_TYPE type,
-		uint32_t numDescriptors) noexcept;
+		const ZgDescriptorSettings& settings) noexcept;
 
 	// Methods
 	// --------------------------------------------------------------------------------------------
 
+	// Allocates a continuous range of descriptors from the owner's last segment, acquiring a new
+	// segment if it does not fit. Acquiring a segment may block until the GPU is done with one.
 	ZgResult allocateDescriptorRange(
+		D3D12DescriptorSegments& owner,
 		uint32_t numDescriptors,
 		D3D12_CPU_DESCRIPTOR_HANDLE& rangeStartCpu,
 		D3D12_GPU_DESCRIPTOR_HANDLE& rangeStartGpu) noexcept;
 
+	// Hands back the owner's segments, to be reused once the queue's fence reaches fenceValue
+	void retireSegments(
+		D3D12DescriptorSegments& owner,
+		D3D12CommandQueue* queue,
+		uint64_t fenceValue) noexcept;
+
+	// Hands back the owner's segments for immediate reuse, must not be referenced by the GPU
+	void releaseSegments(D3D12DescriptorSegments& owner) noexcept;
+
+	// Fills in the descriptor fields of ZgStats, including the bindless ones
+	void getStats(ZgStats& statsOut) noexcept;
+
 	// Public members
 	// --------------------------------------------------------------------------------------------
 	
 	ComPtr<ID3D12DescriptorHeap> descriptorHeap;
 	uint32_t descriptorSize;
 
+	// The bindless descriptors reserved at the start of the heap
+	D3D12BindlessDescriptors bindlessDescriptors;
+
 private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	struct RetiredSegment final {
+		uint32_t segmentIdx = ~0u;
+		uint64_t fenceValue = 0;
+		uint64_t retireIdx = 0; // Order in which segments were retired, over all queues
+	};
+
+	// The segments retired on a queue, in fence value order
+	struct QueueRetiredSegments final {
+		D3D12CommandQueue* queue = nullptr;
+		RingBuffer<RetiredSegment> segments;
+	};
+
+	// The present and the copy queue
+	static constexpr uint32_t MAX_NUM_QUEUES = 2;
+
+	// Private methods
+	// --------------------------------------------------------------------------------------------
+
+	ZgResult acquireSegment(uint32_t& segmentIdxOut) noexcept;
+
+	// Returns the retired segments of the queue, nullptr if MAX_NUM_QUEUES is exceeded. Requires
+	// the lock.
+	QueueRetiredSegments* retiredSegmentsForQueue(D3D12CommandQueue* queue) noexcept;
+
+	// Moves retired segments whose fences have been reached to the free list, checking each queue
+	// separately. Requires the lock.
+	void reclaimSegments() noexcept;
+
 	// Private members
 	// --------------------------------------------------------------------------------------------
 
 	ID3D12Device3* mDevice = nullptr;
-	std::atomic_uint64_t mHeadPointer = 0;
-	uint32_t mNumDescriptors = 0;
+	uint32_t mNumReservedDescriptors = 0;
+	uint32_t mNumSegments = 0;
+	uint32_t mNumDescriptorsPerSegment = 0;
 	D3D12_CPU_DESCRIPTOR_HANDLE mHeapStartCpu;
 	D3D12_GPU_DESCRIPTOR_HANDLE mHeapStartGpu;
+
+	std::mutex mMutex;
+	Vector<uint32_t> mFreeSegments;
+	QueueRetiredSegments mRetiredSegments[MAX_NUM_QUEUES];
+	uint64_t mNextRetireIdx = 0;
+	uint32_t mPeakNumSegmentsInUse = 0;
+	uint64_t mNumWaits = 0;
+	uint64_t mNumFailures = 0;
 };
 
 } // namespace zg
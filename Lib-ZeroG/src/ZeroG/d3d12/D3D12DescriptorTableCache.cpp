@@ -0,0 +1,105 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/d3d12/D3D12DescriptorTableCache.hpp"
+
+#include <algorithm>
+
+namespace zg {
+
+// D3D12DescriptorTableCache: State methods
+// ------------------------------------------------------------------------------------------------
+
+void D3D12DescriptorTableCache::swap(D3D12DescriptorTableCache& other) noexcept
+{
+	mSlots.swap(other.mSlots);
+	std::swap(mNumOccupied, other.mNumOccupied);
+}
+
+void D3D12DescriptorTableCache::destroy() noexcept
+{
+	mSlots.destroy();
+	mNumOccupied = 0;
+}
+
+void D3D12DescriptorTableCache::clear() noexcept
+{
+	if (mNumOccupied == 0) return;
+	for (uint32_t i = 0; i < mSlots.size(); i++) {
+		mSlots[i] = Slot();
+	}
+	mNumOccupied = 0;
+}
+
+// D3D12DescriptorTableCache: Methods
+// ------------------------------------------------------------------------------------------------
+
+bool D3D12DescriptorTableCache::get(
+	uint64_t key,
+	D3D12_GPU_DESCRIPTOR_HANDLE& tableOut) const noexcept
+{
+	if (mNumOccupied != 0) {
+		const Slot& slot = mSlots[findSlot(key)];
+		if (slot.occupied) {
+			tableOut = slot.table;
+			return true;
+		}
+	}
+	return false;
+}
+
+void D3D12DescriptorTableCache::insert(
+	uint64_t key,
+	D3D12_GPU_DESCRIPTOR_HANDLE table) noexcept
+{
+	// Allocate slots on first use
+	if (mSlots.size() == 0) {
+		bool success = mSlots.create(
+			D3D12_DESCRIPTOR_TABLE_CACHE_NUM_SLOTS, "ZeroG - D3D12DescriptorTableCache");
+		if (!success || !mSlots.addMany(D3D12_DESCRIPTOR_TABLE_CACHE_NUM_SLOTS)) return;
+	}
+
+	// Start over when half full, keeping every table ever created is not worth the memory
+	uint32_t slotIdx = findSlot(key);
+	if (!mSlots[slotIdx].occupied && (mNumOccupied + 1) > (mSlots.size() / 2)) {
+		this->clear();
+		slotIdx = findSlot(key);
+	}
+
+	Slot& slot = mSlots[slotIdx];
+	if (!slot.occupied) mNumOccupied += 1;
+	slot.occupied = true;
+	slot.key = key;
+	slot.table = table;
+}
+
+// D3D12DescriptorTableCache: Private methods
+// ------------------------------------------------------------------------------------------------
+
+uint32_t D3D12DescriptorTableCache::findSlot(uint64_t key) const noexcept
+{
+	// Linear probing, the table is never more than half full so an empty slot is always found
+	const uint32_t mask = mSlots.size() - 1;
+	uint32_t idx = uint32_t(key ^ (key >> 32)) & mask;
+	while (mSlots[idx].occupied && mSlots[idx].key != key) {
+		idx = (idx + 1) & mask;
+	}
+	return idx;
+}
+
+} // namespace zg
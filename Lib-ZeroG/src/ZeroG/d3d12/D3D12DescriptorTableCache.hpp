@@ -0,0 +1,97 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+
+#include "ZeroG/d3d12/D3D12Common.hpp"
+#include "ZeroG/util/SmallVector.hpp"
+
+namespace zg {
+
+// The number of slots in a command list's descriptor table cache, it is cleared when half full
+constexpr uint32_t D3D12_DESCRIPTOR_TABLE_CACHE_NUM_SLOTS = 1024;
+
+// D3D12DescriptorTableCache
+// ------------------------------------------------------------------------------------------------
+
+// Descriptor tables created by a command list, so that binding the same resources to a pipeline
+// with the same table layout again reuses the table instead of allocating a new range and
+// recreating all its views.
+//
+// Keyed by a hash of the table layout and the resources in table order (as with the pipeline
+// cache, collisions are assumed never to happen) and looked up in an open addressing hash table.
+// Not thread-safe, each command list has its own cache which is cleared when the command list is
+// reset. Until then the tables stay valid, they are in the command list's own descriptor segments
+// (see D3D12DescriptorSegments). Clearing also matters as resources may have been released and
+// their addresses reused since.
+class D3D12DescriptorTableCache final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	D3D12DescriptorTableCache() noexcept = default;
+	D3D12DescriptorTableCache(const D3D12DescriptorTableCache&) = delete;
+	D3D12DescriptorTableCache& operator= (const D3D12DescriptorTableCache&) = delete;
+	D3D12DescriptorTableCache(D3D12DescriptorTableCache&&) = delete;
+	D3D12DescriptorTableCache& operator= (D3D12DescriptorTableCache&&) = delete;
+	~D3D12DescriptorTableCache() noexcept { this->destroy(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	void swap(D3D12DescriptorTableCache& other) noexcept;
+	void destroy() noexcept;
+
+	// Forgets all tables, keeps the memory allocated
+	void clear() noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	// Returns whether there is a table for the key
+	bool get(uint64_t key, D3D12_GPU_DESCRIPTOR_HANDLE& tableOut) const noexcept;
+
+	// Inserts or replaces the table for the key. Silently does nothing if out of memory.
+	void insert(uint64_t key, D3D12_GPU_DESCRIPTOR_HANDLE table) noexcept;
+
+private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	struct Slot final {
+		bool occupied = false;
+		uint64_t key = 0;
+		D3D12_GPU_DESCRIPTOR_HANDLE table = {};
+	};
+
+	// Private methods
+	// --------------------------------------------------------------------------------------------
+
+	// Returns the slot with the key, or the empty slot where it would be inserted
+	uint32_t findSlot(uint64_t key) const noexcept;
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	SmallVector<Slot, 0> mSlots;
+	uint32_t mNumOccupied = 0;
+};
+
+} // namespace zg
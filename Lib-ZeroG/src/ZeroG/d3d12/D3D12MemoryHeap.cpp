@@ -91,7 +91,7 @@ D3D12_RESOURCE_DESC createInfoToResourceDesc(const ZgTexture2DCreateInfo& info)
 
 D3D12MemoryHeap::~D3D12MemoryHeap() noexcept
 {
-
+	if (rangeTracker != nullptr) rangeTracker->release();
 }
 
 // D3D12MemoryHeap: Virtual methods
@@ -146,6 +146,7 @@ ZgResult D3D12MemoryHeap::bufferCreate(
 
 	// Allocate buffer
 	D3D12Buffer* buffer = zgNew<D3D12Buffer>("ZeroG - D3D12Buffer");
+	if (buffer == nullptr) return ZG_ERROR_CPU_OUT_OF_MEMORY;
 
 	// Copy stuff
 	buffer->identifier = std::atomic_fetch_add(resourceUniqueIdentifierCounter, 1);
@@ -154,6 +155,29 @@ ZgResult D3D12MemoryHeap::bufferCreate(
 	buffer->resource = resource;
 	buffer->lastCommittedState = initialResourceState;
 
+	// Track range occupied by buffer, buffers are always 64KiB aligned in size
+	buffer->offsetInHeapBytes = createInfo.offsetInBytes;
+	buffer->sizeInHeapBytes = ((createInfo.sizeInBytes + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1)
+		/ D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) * D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	if (rangeTracker->addRange(buffer->offsetInHeapBytes, buffer->sizeInHeapBytes) == ZG_SUCCESS) {
+		rangeTracker->retain();
+		buffer->heapRangeTracker = rangeTracker;
+	}
+
+	// Create bindless view last, so that nothing after it can fail and leak the index. Readback
+	// buffers can't be read by shaders.
+	if (bindlessDescriptors->enabled() && memoryType != ZG_MEMORY_TYPE_DOWNLOAD) {
+		uint32_t bindlessIndex = ~0u;
+		ZgResult res = bindlessDescriptors->createBufferView(
+			resource.Get(), createInfo.sizeInBytes, bindlessIndex);
+		if (res != ZG_SUCCESS) {
+			zgDelete(buffer);
+			return res;
+		}
+		buffer->bindlessDescriptors = bindlessDescriptors;
+		buffer->bindlessIndex = bindlessIndex;
+	}
+
 	// Return buffer
 	*bufferOut = buffer;
 	return ZG_SUCCESS;
@@ -230,6 +254,7 @@ ZgResult D3D12MemoryHeap::texture2DCreate(
 
 	// Allocate texture
 	D3D12Texture2D* texture = zgNew<D3D12Texture2D>("ZeroG - D3D12Texture");
+	if (texture == nullptr) return ZG_ERROR_CPU_OUT_OF_MEMORY;
 
 	// Copy stuff
 	texture->identifier = std::atomic_fetch_add(resourceUniqueIdentifierCounter, 1);
@@ -255,17 +280,45 @@ ZgResult D3D12MemoryHeap::texture2DCreate(
 		texture->lastCommittedStates[i] = initialResourceState;
 	}
 
+	// Track range occupied by texture
+	texture->offsetInHeapBytes = createInfo.offsetInBytes;
+	texture->sizeInHeapBytes = allocationInfo.SizeInBytes;
+	if (rangeTracker->addRange(texture->offsetInHeapBytes, texture->sizeInHeapBytes) == ZG_SUCCESS) {
+		rangeTracker->retain();
+		texture->heapRangeTracker = rangeTracker;
+	}
+
+	// Create bindless view last, so that nothing after it can fail and leak the index
+	if (bindlessDescriptors->enabled()) {
+		uint32_t bindlessIndex = ~0u;
+		ZgResult res =
+			bindlessDescriptors->createTextureView(resource.Get(), desc.Format, bindlessIndex);
+		if (res != ZG_SUCCESS) {
+			zgDelete(texture);
+			return res;
+		}
+		texture->bindlessDescriptors = bindlessDescriptors;
+		texture->bindlessIndex = bindlessIndex;
+	}
+
 	// Return texture
 	*textureOut = texture;
 	return ZG_SUCCESS;
 }
 
+ZgResult D3D12MemoryHeap::getStats(ZgMemoryHeapStats& statsOut) noexcept
+{
+	rangeTracker->getStats(statsOut);
+	return ZG_SUCCESS;
+}
+
 // D3D12 Memory Heap functions
 // ------------------------------------------------------------------------------------------------
 
 ZgResult createMemoryHeap(
 	ID3D12Device3& device,
 	std::atomic_uint64_t* resourceUniqueIdentifierCounter,
+	D3D12BindlessDescriptors* bindlessDescriptors,
 	D3DX12Residency::ResidencyManager& residencyManager,
 	D3D12MemoryHeap** heapOut,
 	const ZgMemoryHeapCreateInfo& createInfo) noexcept
@@ -305,6 +358,7 @@ ZgResult createMemoryHeap(
 
 	// Allocate memory heap
 	D3D12MemoryHeap* memoryHeap = zgNew<D3D12MemoryHeap>("ZeroG - D3D12MemoryHeap");
+	if (memoryHeap == nullptr) return ZG_ERROR_CPU_OUT_OF_MEMORY;
 
 	// Create residency manager object and begin tracking
 	memoryHeap->managedObject.Initialize(heap.Get(), createInfo.sizeInBytes);
@@ -313,9 +367,16 @@ ZgResult createMemoryHeap(
 	// Copy stuff
 	memoryHeap->device = &device;
 	memoryHeap->resourceUniqueIdentifierCounter = resourceUniqueIdentifierCounter;
+	memoryHeap->bindlessDescriptors = bindlessDescriptors;
 	memoryHeap->memoryType = createInfo.memoryType;
 	memoryHeap->sizeBytes = createInfo.sizeInBytes;
 	memoryHeap->heap = heap;
+	memoryHeap->rangeTracker = HeapRangeTracker::create(createInfo.sizeInBytes);
+
+	// Set residency priority
+	if (createInfo.residencyPriority != ZG_RESIDENCY_PRIORITY_NORMAL) {
+		setMemoryHeapResidencyPriority(*memoryHeap, createInfo.residencyPriority);
+	}
 
 	// Log that we created a memory heap
 	if (createInfo.sizeInBytes < 1024) {
@@ -336,4 +397,24 @@ ZgResult createMemoryHeap(
 	return ZG_SUCCESS;
 }
 
+ZgResult setMemoryHeapResidencyPriority(
+	D3D12MemoryHeap& heap,
+	ZgResidencyPriority priority) noexcept
+{
+	D3D12_RESIDENCY_PRIORITY d3d12Priority = [&]() {
+		switch (priority) {
+		case ZG_RESIDENCY_PRIORITY_LOW: return D3D12_RESIDENCY_PRIORITY_LOW;
+		case ZG_RESIDENCY_PRIORITY_HIGH: return D3D12_RESIDENCY_PRIORITY_HIGH;
+		default: break;
+		}
+		return D3D12_RESIDENCY_PRIORITY_NORMAL;
+	}();
+
+	ID3D12Pageable* pageable = heap.heap.Get();
+	if (D3D12_FAIL(heap.device->SetResidencyPriority(1, &pageable, &d3d12Priority))) {
+		return ZG_ERROR_GENERIC;
+	}
+	return ZG_SUCCESS;
+}
+
 } // namespace zg
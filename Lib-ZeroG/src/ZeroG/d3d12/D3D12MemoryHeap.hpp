@@ -59,16 +59,20 @@ public:
 		ZgTexture2D** textureOut,
 		const ZgTexture2DCreateInfo& createInfo) noexcept override final;
 
+	ZgResult getStats(ZgMemoryHeapStats& statsOut) noexcept override final;
+
 	// Members
 	// --------------------------------------------------------------------------------------------
 
 	ID3D12Device3* device = nullptr;
 	std::atomic_uint64_t* resourceUniqueIdentifierCounter = nullptr;
+	D3D12BindlessDescriptors* bindlessDescriptors = nullptr;
 
 	ZgMemoryType memoryType = ZG_MEMORY_TYPE_UNDEFINED;
 	uint64_t sizeBytes = 0;
 	ComPtr<ID3D12Heap> heap;
 	D3DX12Residency::ManagedObject managedObject;
+	HeapRangeTracker* rangeTracker = nullptr;
 };
 
 // D3D12 Memory Heap functions
@@ -77,8 +81,15 @@ public:
 ZgResult createMemoryHeap(
 	ID3D12Device3& device,
 	std::atomic_uint64_t* resourceUniqueIdentifierCounter,
+	D3D12BindlessDescriptors* bindlessDescriptors,
 	D3DX12Residency::ResidencyManager& residencyManager,
 	D3D12MemoryHeap** heapOut,
 	const ZgMemoryHeapCreateInfo& createInfo) noexcept;
 
+// Sets the OS residency priority of the heap, i.e. how likely the OS is to demote it when there
+// is memory pressure.
+ZgResult setMemoryHeapResidencyPriority(
+	D3D12MemoryHeap& heap,
+	ZgResidencyPriority priority) noexcept;
+
 } // namespace zg
@@ -20,12 +20,21 @@
 
 #include <algorithm>
 #include <chrono>
+#include <climits>
 #include <cstdio>
+#include <cstring>
 
-#include "spirv_cross_c.h"
-
+#include "ZeroG/Context.hpp"
+#include "ZeroG/JobSystem.hpp"
+#include "ZeroG/PipelineCache.hpp"
+#include "ZeroG/ShaderArchive.hpp"
+#include "ZeroG/SpirvCross.hpp"
 #include "ZeroG/util/Assert.hpp"
 #include "ZeroG/util/CpuAllocation.hpp"
+#include "ZeroG/util/FileIO.hpp"
+#include "ZeroG/util/Hash.hpp"
+#include "ZeroG/util/ScopedArena.hpp"
+#include "ZeroG/util/SmallVector.hpp"
 #include "ZeroG/util/Strings.hpp"
 #include "ZeroG/util/Vector.hpp"
 
@@ -47,166 +56,39 @@ static float calculateDeltaMillis(time_point& previousTime) noexcept
 	return delta;
 }
 
-static Vector<uint8_t> readBinaryFile(const char* path) noexcept
-{
-	// Open file
-	std::FILE* file = std::fopen(path, "rb");
-	if (file == NULL) return Vector<uint8_t>();
-
-	// Get size of file
-	std::fseek(file, 0, SEEK_END);
-	int64_t size = std::ftell(file);
-	if (size <= 0) {
-		std::fclose(file);
-		return Vector<uint8_t>();
-	}
-	std::fseek(file, 0, SEEK_SET);
-
-	// Allocate memory for file
-	Vector<uint8_t> data;
-	data.create(uint32_t(size), "binary file");
-	data.addMany(uint32_t(size));
-
-	// Read file
-	size_t bytesRead = std::fread(data.data(), 1, data.size(), file);
-	if (bytesRead != size_t(size)) {
-		std::fclose(file);
-		return Vector<uint8_t>();
-	}
-
-	// Close file and return data
-	std::fclose(file);
-	return data;
-}
-
-#define CHECK_SPIRV_CROSS(context) (zg::CheckSpirvCrossImpl(context, __FILE__, __LINE__)) %
-
-struct CheckSpirvCrossImpl final {
-	spvc_context ctx = nullptr;
-	const char* file;
-	int line;
-
-	CheckSpirvCrossImpl() = delete;
-	CheckSpirvCrossImpl(spvc_context ctx, const char* file, int line) noexcept
-	:
-		ctx(ctx), file(file), line(line)
-	{ }
-
-	spvc_result operator% (spvc_result result) noexcept
-	{
-		if (result == SPVC_SUCCESS) return result;
-
-		// Get error string if context was specified
-		const char* errorStr = "<NO ERROR MESSAGE>";
-		if (ctx != nullptr) errorStr = spvc_context_get_last_error_string(ctx);
-
-		// Log error message
-		logWrapper(file, line, ZG_LOG_LEVEL_ERROR, "SPIRV-Cross error: %s\n", errorStr);
-
-		ZG_ASSERT(false);
-
-		return result;
-	}
+// Cross-compiles one SPIR-V shader per task, each task uses its own SPIRV-Cross context
+struct CrossCompileTaskData final {
+	const uint8_t* spirv[2] = {};
+	uint32_t spirvSizeBytes[2] = {};
+	uint32_t pushConstantRegister = ~0u;
+	const ZgSpecializationConstant* specializationConstants = nullptr;
+	uint32_t numSpecializationConstants = 0;
+	Vector<char> hlslSrc[2];
 };
 
-static Vector<char> crossCompileSpirvToHLSL(
-	spvc_context context,
-	const Vector<uint8_t>& spirvData) noexcept
+static void crossCompileSpirvToHLSLTask(void* taskDataPtr, uint32_t taskIdx) noexcept
 {
-	// Parse SPIR-V
-	spvc_parsed_ir parsedIr = nullptr;
-	CHECK_SPIRV_CROSS(context) spvc_context_parse_spirv(
-		context, reinterpret_cast<const SpvId*>(spirvData.data()), spirvData.size() / 4, &parsedIr);
+	CrossCompileTaskData& taskData = *reinterpret_cast<CrossCompileTaskData*>(taskDataPtr);
 
-	// Create compiler
-	spvc_compiler compiler = nullptr;
-	CHECK_SPIRV_CROSS(context) spvc_context_create_compiler(
-		context, SPVC_BACKEND_HLSL, parsedIr, SPVC_CAPTURE_MODE_TAKE_OWNERSHIP, &compiler);
+	// All operator new calls made by SPIRV-Cross are served by a scoped arena and freed in bulk
+	// when leaving the scope. The HLSL source is copied out into a Vector, which uses the ZeroG
+	// allocator directly, so nothing allocated in the arena is kept.
+	ScopedArena arena;
 
-	// Reflection resources
-	// TODO: Attempt to fix stuff through reflection, does not seem to work properly when outputting
-	//       HLSL?
-	/*	spvc_resources resources = nullptr;
-	CHECK_SPIRV_CROSS(logger, context) spvc_compiler_create_shader_resources(compiler, &resources);
-
-	// Attempt to fix vertex input attribute
-	const spvc_reflected_resource* vertexInputs = nullptr;
-	size_t numVertexInputs = 0;
-	CHECK_SPIRV_CROSS(logger, context) spvc_resources_get_resource_list_for_type(
-		resources, SPVC_RESOURCE_TYPE_STAGE_INPUT, &vertexInputs, &numVertexInputs);
-
-	for (size_t i = 0; i < numVertexInputs; i++) {
-		spvc_reflected_resource vertexInput = vertexInputs[i];
-
-
-	const spvc_reflected_resource* constantBuffers = nullptr;
-	size_t numConstantBuffers = 0;
-	CHECK_SPIRV_CROSS(logger, context) spvc_resources_get_resource_list_for_type(
-		resources, SPVC_RESOURCE_TYPE_UNIFORM_BUFFER, &constantBuffers, &numConstantBuffers);
-
-
-	// Fix constant buffers
-	// TODO: This is bad, should fix per type, not per instance
-	for (size_t i = 0; i < numConstantBuffers; i++) {
-
-		const spvc_reflected_resource& cb = constantBuffers[i];
-		spvc_type type = spvc_compiler_get_type_handle(compiler, cb.base_type_id);
-		uint32_t numMembers = spvc_type_get_num_member_types(type);
-
-		printf("Constant buffer %u: %s, numMembers: %u\n", i, constantBuffers[i].name, numMembers);
-
-		//uint32_t numMembers = spvc_type_get_num_member_types(cb.type_id);
-
-		// Remove "type_" from type name of constant buffer
-		spvc_compiler_set_name(compiler, constantBuffers[i].id, constantBuffers[i].name + 5);
-	}
-	*/
-
-	// Set some compiler options
-	spvc_compiler_options options = nullptr;
-	CHECK_SPIRV_CROSS(context) spvc_compiler_create_compiler_options(compiler, &options);
-
-	// Set which version of HLSL to target
-	// For now target shader model 6.0, which is the lowest ZeroG supports
-	// TODO: Expose this?
-	CHECK_SPIRV_CROSS(context) spvc_compiler_options_set_uint(
-		options, SPVC_COMPILER_OPTION_HLSL_SHADER_MODEL, 60);
-
-	// Apply compiler options
-	CHECK_SPIRV_CROSS(context) spvc_compiler_install_compiler_options(compiler, options);
+	// Initialize SPIRV-Cross
+	spvc_context spvcContext = nullptr;
+	spvc_result res = CHECK_SPIRV_CROSS(nullptr) spvc_context_create(&spvcContext);
+	if (res != SPVC_SUCCESS) return;
 
-	// Attempt to fix entry points
-	/*const spvc_entry_point* entryPoints = nullptr;
-	size_t numEntryPoints = 0;
-	CHECK_SPIRV_CROSS(logger, context) spvc_compiler_get_entry_points(
-		compiler, &entryPoints, &numEntryPoints);
+	taskData.hlslSrc[taskIdx] = crossCompileSpirvToHLSL(spvcContext,
+		taskData.spirv[taskIdx], taskData.spirvSizeBytes[taskIdx], taskData.pushConstantRegister,
+		taskData.specializationConstants, taskData.numSpecializationConstants);
 
-	for (size_t i = 0; i < numEntryPoints; i++) {
-		switch (entryPoints[i].execution_model) {
-		case SpvExecutionModelVertex:
-			CHECK_SPIRV_CROSS(logger, context) spvc_compiler_rename_entry_point(
-				compiler, entryPoints[i].name, vertexEntryPoint, SpvExecutionModelVertex);
-			break;
+	// Deinitialize SPIRV-Cross
+	spvc_context_destroy(spvcContext);
 
-		case SpvExecutionModelFragment:
-			CHECK_SPIRV_CROSS(logger, context) spvc_compiler_rename_entry_point(
-				compiler, entryPoints[i].name, pixelEntryPoint, SpvExecutionModelFragment);
-			break;
-		}
-	}*/
-
-	// Compile to HLSL
-	const char* hlslSource = nullptr;
-	CHECK_SPIRV_CROSS(context) spvc_compiler_compile(compiler, &hlslSource);
-
-	// Allocate memory and copy HLSL source to Vector<char> and return it
-	uint32_t hlslSrcLen = uint32_t(std::strlen(hlslSource));
-	Vector<char> hlslSourceTmp;
-	hlslSourceTmp.create(hlslSrcLen + 1, "HLSL Source");
-	hlslSourceTmp.addMany(hlslSrcLen);
-	std::memcpy(hlslSourceTmp.data(), hlslSource, hlslSrcLen);
-	hlslSourceTmp[hlslSrcLen] = '\0';
-	return hlslSourceTmp;
+	ZG_NOISE("SPIRV-Cross used %llu bytes of arena memory",
+		(unsigned long long)arena.numBytesAllocated());
 }
 
 static bool relativeToAbsolute(char* pathOut, uint32_t pathOutSize, const char* pathIn) noexcept
@@ -230,6 +112,34 @@ static bool fixPath(WCHAR* pathOut, uint32_t pathOutNumChars, const char* utf8In
 )
 static constexpr uint32_t DFCC_DXIL = DXIL_FOURCC('D', 'X', 'I', 'L');
 
+// Hashes the DXIL program part of a DXIL container. The rest of the container (debug info, the
+// container hash, etc) can differ between shaders compiled to identical programs, e.g. with
+// different defines. Falls back to hashing the whole container if it can't be parsed.
+static uint64_t hashDxilProgram(
+	const uint8_t* container, uint32_t sizeBytes, uint64_t seed) noexcept
+{
+	// DxilContainerHeader: fourcc, 16 byte digest, version, container size and part count. It is
+	// followed by one uint32_t offset per part, each part starts with its fourcc and size.
+	constexpr uint32_t HEADER_SIZE = 32;
+	uint32_t numParts = 0;
+	if (sizeBytes >= HEADER_SIZE) std::memcpy(&numParts, container + 28, sizeof(uint32_t));
+	if (sizeBytes < HEADER_SIZE || numParts > (sizeBytes - HEADER_SIZE) / 4) {
+		return hashBytes(container, sizeBytes, seed);
+	}
+	for (uint32_t i = 0; i < numParts; i++) {
+		uint32_t offset = 0;
+		std::memcpy(&offset, container + HEADER_SIZE + i * 4, sizeof(uint32_t));
+		if (offset > sizeBytes || sizeBytes - offset < 8) break;
+		uint32_t fourCC = 0;
+		uint32_t partSizeBytes = 0;
+		std::memcpy(&fourCC, container + offset, sizeof(uint32_t));
+		std::memcpy(&partSizeBytes, container + offset + 4, sizeof(uint32_t));
+		if (partSizeBytes > sizeBytes - offset - 8) break;
+		if (fourCC == DFCC_DXIL) return hashBytes(container + offset + 8, partSizeBytes, seed);
+	}
+	return hashBytes(container, sizeBytes, seed);
+}
+
 static HRESULT getShaderReflection(
 	ComPtr<IDxcBlob>& blob, ComPtr<ID3D12ShaderReflection>& reflectionOut) noexcept
 {
@@ -285,6 +195,22 @@ static ZgResult dxcCreateHlslBlobFromFile(
 	return ZG_SUCCESS;
 }
 
+static ZgResult dxcCreateDxilBlob(
+	IDxcLibrary& dxcLibrary,
+	const void* dxil,
+	uint32_t dxilSizeBytes,
+	ComPtr<IDxcBlob>& blobOut) noexcept
+{
+	// Wrap the caller's memory in a blob without copying it, it is only used during creation
+	ComPtr<IDxcBlobEncoding> encodingBlob;
+	if (D3D12_FAIL(dxcLibrary.CreateBlobWithEncodingFromPinned(
+		dxil, dxilSizeBytes, 0, &encodingBlob))) {
+		return ZG_ERROR_GENERIC;
+	}
+	blobOut = encodingBlob;
+	return ZG_SUCCESS;
+}
+
 static ZgResult dxcCreateHlslBlobFromSource(
 	IDxcLibrary& dxcLibrary,
 	const char* source,
@@ -309,6 +235,8 @@ static ZgResult compileHlslShader(
 	const char* shaderName,
 	const char* entryName,
 	const char* const * compilerFlags,
+	const ZgShaderDefine* defines,
+	uint32_t numDefines,
 	HlslShaderType shaderType) noexcept
 {
 	// Convert entry point to wide string
@@ -345,6 +273,25 @@ static ZgResult compileHlslShader(
 		numArgs++;
 	}
 
+	// Convert defines to wide strings, a null value is left as is which DXC defines as 1
+	WCHAR defineNamesContainer[ZG_MAX_NUM_SHADER_DEFINES][64] = {};
+	WCHAR defineValuesContainer[ZG_MAX_NUM_SHADER_DEFINES][128] = {};
+	DxcDefine dxcDefines[ZG_MAX_NUM_SHADER_DEFINES] = {};
+	for (uint32_t i = 0; i < numDefines; i++) {
+		if (!utf8ToWide(defineNamesContainer[i], 64, defines[i].name)) {
+			ZG_ERROR("Shader \"%s\": Define name \"%s\" is too long", shaderName, defines[i].name);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+		dxcDefines[i].Name = defineNamesContainer[i];
+		if (defines[i].value == nullptr) continue;
+		if (!utf8ToWide(defineValuesContainer[i], 128, defines[i].value)) {
+			ZG_ERROR("Shader \"%s\": Value of define \"%s\" is too long",
+				shaderName, defines[i].name);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+		dxcDefines[i].Value = defineValuesContainer[i];
+	}
+
 	// Compile shader
 	ComPtr<IDxcOperationResult> result;
 	if (D3D12_FAIL(dxcCompiler.Compile(
@@ -354,8 +301,8 @@ static ZgResult compileHlslShader(
 		targetProfile,
 		args,
 		numArgs,
-		nullptr,
-		0,
+		dxcDefines,
+		numDefines,
 		dxcIncludeHandler,
 		&result))) {
 		return ZG_ERROR_SHADER_COMPILE_ERROR;
@@ -466,30 +413,6 @@ static DXGI_FORMAT vertexAttributeTypeToFormat(ZgVertexAttributeType type) noexc
 	return DXGI_FORMAT_UNKNOWN;
 }
 
-static const char* vertexAttributeTypeToString(ZgVertexAttributeType type) noexcept
-{
-	switch (type) {
-	case ZG_VERTEX_ATTRIBUTE_F32: return "ZG_VERTEX_ATTRIBUTE_F32";
-	case ZG_VERTEX_ATTRIBUTE_F32_2: return "ZG_VERTEX_ATTRIBUTE_F32_2";
-	case ZG_VERTEX_ATTRIBUTE_F32_3: return "ZG_VERTEX_ATTRIBUTE_F32_3";
-	case ZG_VERTEX_ATTRIBUTE_F32_4: return "ZG_VERTEX_ATTRIBUTE_F32_4";
-
-	case ZG_VERTEX_ATTRIBUTE_S32: return "ZG_VERTEX_ATTRIBUTE_S32";
-	case ZG_VERTEX_ATTRIBUTE_S32_2: return "ZG_VERTEX_ATTRIBUTE_S32_2";
-	case ZG_VERTEX_ATTRIBUTE_S32_3: return "ZG_VERTEX_ATTRIBUTE_S32_3";
-	case ZG_VERTEX_ATTRIBUTE_S32_4: return "ZG_VERTEX_ATTRIBUTE_S32_4";
-
-	case ZG_VERTEX_ATTRIBUTE_U32: return "ZG_VERTEX_ATTRIBUTE_U32";
-	case ZG_VERTEX_ATTRIBUTE_U32_2: return "ZG_VERTEX_ATTRIBUTE_U32_2";
-	case ZG_VERTEX_ATTRIBUTE_U32_3: return "ZG_VERTEX_ATTRIBUTE_U32_3";
-	case ZG_VERTEX_ATTRIBUTE_U32_4: return "ZG_VERTEX_ATTRIBUTE_U32_4";
-
-	default: break;
-	}
-	ZG_ASSERT(false);
-	return "";
-}
-
 static ZgVertexAttributeType vertexReflectionToAttribute(
 	D3D_REGISTER_COMPONENT_TYPE compType, BYTE mask) noexcept
 {
@@ -542,6 +465,13 @@ static D3D12_TEXTURE_ADDRESS_MODE wrappingModeToD3D12(ZgWrappingMode wrappingMod
 	return D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
 }
 
+static D3D12_SHADER_VISIBILITY constBufferVisibility(bool vertexAccess, bool pixelAccess) noexcept
+{
+	if (vertexAccess && !pixelAccess) return D3D12_SHADER_VISIBILITY_VERTEX;
+	if (!vertexAccess && pixelAccess) return D3D12_SHADER_VISIBILITY_PIXEL;
+	return D3D12_SHADER_VISIBILITY_ALL;
+}
+
 static void logPipelineInfo(
 	const ZgPipelineRenderCreateInfoCommon& createInfo,
 	const char* vertexShaderName,
@@ -582,10 +512,11 @@ static void logPipelineInfo(
 	for (uint32_t i = 0; i < signature.numConstantBuffers; i++) {
 		const ZgConstantBufferDesc& cbuffer = signature.constantBuffers[i];
 		printfAppend(tmpStr, bytesLeft,
-			" - Register: %u -- Size: %u bytes -- Push constant: %s\n",
+			" - Register: %u -- Size: %u bytes -- Push constant: %s -- Root constant buffer: %s\n",
 			cbuffer.shaderRegister,
 			cbuffer.sizeInBytes,
-			cbuffer.pushConstant ? "YES" : "NO");
+			cbuffer.pushConstant ? "YES" : "NO",
+			cbuffer.rootConstantBuffer ? "YES" : "NO");
 	}
 
 	// Print textures
@@ -597,6 +528,10 @@ static void logPipelineInfo(
 			texture.textureRegister);
 	}
 
+	// Print bindless tables
+	printfAppend(tmpStr, bytesLeft, "\nBindless textures: %s -- Bindless buffers: %s\n",
+		signature.bindlessTextures ? "YES" : "NO",
+		signature.bindlessBuffers ? "YES" : "NO");
 
 	// Log
 	ZG_NOISE("%s", tmpStrOriginal);
@@ -605,78 +540,294 @@ static void logPipelineInfo(
 	allocator.deallocate(allocator.userPtr, tmpStrOriginal);
 }
 
-static ZgResult createPipelineRenderInternal(
-	D3D12PipelineRender** pipelineOut,
-	ZgPipelineRenderSignature* signatureOut,
+// Pipeline cache helpers
+// ------------------------------------------------------------------------------------------------
+
+// Bump whenever the cached payload, or the way it is compiled, changes
+constexpr uint32_t D3D12_PIPELINE_CACHE_VERSION = 5;
+
+// Everything produced by compiling and reflecting the shaders of a pipeline, i.e. what is stored
+// in the pipeline cache. The root signature and PSO are always recreated from this.
+struct CompiledPipelineRender final {
+	PipelineRenderReflection reflection;
+	Vector<uint8_t> vertexBytecode;
+	Vector<uint8_t> pixelBytecode;
+};
+
+// Cache payload layout, followed by the vertex and pixel shader bytecode
+struct CompiledPipelineRenderHeader final {
+	ZgPipelineRenderSignature signature;
+	uint8_t constBufferVertexAccess[ZG_MAX_NUM_CONSTANT_BUFFERS];
+	uint8_t constBufferPixelAccess[ZG_MAX_NUM_CONSTANT_BUFFERS];
+	uint32_t vertexBytecodeSizeBytes;
+	uint32_t pixelBytecodeSizeBytes;
+};
+
+static bool copyBytecode(Vector<uint8_t>& out, const void* data, uint32_t numBytes) noexcept
+{
+	if (!out.create(numBytes, "ZeroG - CompiledPipelineRender")) return false;
+	out.addMany(numBytes);
+	std::memcpy(out.data(), data, numBytes);
+	return true;
+}
+
+static uint64_t pipelineCacheKey(
+	const char* sourceKind,
+	const void* vertexSrc,
+	uint64_t vertexSrcSizeBytes,
+	const void* pixelSrc,
+	uint64_t pixelSrcSizeBytes,
 	const ZgPipelineRenderCreateInfoCommon& createInfo,
-	time_point compileStartTime,
 	ZgShaderModel shaderModel,
 	const char* const dxcCompilerFlags[],
-	const ComPtr<IDxcBlobEncoding>& vertexEncodingBlob,
-	const ComPtr<IDxcBlobEncoding> pixelEncodingBlob,
-	const char* vertexShaderName,
-	const char* pixelShaderName,
-	IDxcCompiler& dxcCompiler,
-	IDxcIncludeHandler* dxcIncludeHandler,
-	ID3D12Device3& device) noexcept
+	const ZgShaderDefine* defines,
+	uint32_t numDefines,
+	const ZgSpecializationConstant* specializationConstants,
+	uint32_t numSpecializationConstants) noexcept
 {
-	// Pick out which vertex and pixel shader type to compile with
-	HlslShaderType vertexShaderType = HlslShaderType::VERTEX_SHADER_6_0;
-	HlslShaderType pixelShaderType = HlslShaderType::PIXEL_SHADER_6_0;
-	switch (shaderModel) {
-	case ZG_SHADER_MODEL_6_0:
-		vertexShaderType = HlslShaderType::VERTEX_SHADER_6_0;
-		pixelShaderType = HlslShaderType::PIXEL_SHADER_6_0;
-		break;
-	case ZG_SHADER_MODEL_6_1:
-		vertexShaderType = HlslShaderType::VERTEX_SHADER_6_1;
-		pixelShaderType = HlslShaderType::PIXEL_SHADER_6_1;
-		break;
-	case ZG_SHADER_MODEL_6_2:
-		vertexShaderType = HlslShaderType::VERTEX_SHADER_6_2;
-		pixelShaderType = HlslShaderType::PIXEL_SHADER_6_2;
-		break;
-	case ZG_SHADER_MODEL_6_3:
-		vertexShaderType = HlslShaderType::VERTEX_SHADER_6_3;
-		pixelShaderType = HlslShaderType::PIXEL_SHADER_6_3;
-		break;
+	uint64_t hash = hashString("ZeroG D3D12 pipeline");
+	hash = hashValue(D3D12_PIPELINE_CACHE_VERSION, hash);
+	hash = hashString(sourceKind, hash);
+
+	// Shader sources
+	hash = hashValue(vertexSrcSizeBytes, hash);
+	hash = hashBytes(vertexSrc, vertexSrcSizeBytes, hash);
+	hash = hashValue(pixelSrcSizeBytes, hash);
+	hash = hashBytes(pixelSrc, pixelSrcSizeBytes, hash);
+
+	// Compiler settings
+	hash = hashString(createInfo.vertexShaderEntry, hash);
+	hash = hashString(createInfo.pixelShaderEntry, hash);
+	hash = hashValue(shaderModel, hash);
+	for (uint32_t i = 0; i < ZG_MAX_NUM_DXC_COMPILER_FLAGS; i++) {
+		hash = hashString(dxcCompilerFlags[i], hash);
+	}
+	hash = hashValue(numDefines, hash);
+	for (uint32_t i = 0; i < numDefines; i++) {
+		hash = hashString(defines[i].name, hash);
+		hash = hashString(defines[i].value == nullptr ? "1" : defines[i].value, hash);
+	}
+	hash = hashValue(numSpecializationConstants, hash);
+	for (uint32_t i = 0; i < numSpecializationConstants; i++) {
+		hash = hashValue(specializationConstants[i].constantId, hash);
+		hash = hashValue(specializationConstants[i].value, hash);
 	}
 
-	// Compile vertex shader
-	ComPtr<IDxcBlob> vertexBlob;
-	ComPtr<ID3D12ShaderReflection> vertexReflection;
-	ZgResult vertexShaderRes = compileHlslShader(
-		dxcCompiler,
-		dxcIncludeHandler,
-		vertexBlob,
-		vertexReflection,
-		vertexEncodingBlob,
-		vertexShaderName,
-		createInfo.vertexShaderEntry,
-		dxcCompilerFlags,
-		vertexShaderType);
-	if (vertexShaderRes != ZG_SUCCESS) return vertexShaderRes;
+	// The rest of the common create info. Only the used part of each array is hashed, so that
+	// stale values in unused entries don't cause cache misses. All hashed structs consist of 4 byte
+	// members, so there is no padding to worry about.
+	hash = hashValue(createInfo.numVertexAttributes, hash);
+	for (uint32_t i = 0; i < createInfo.numVertexAttributes; i++) {
+		hash = hashValue(createInfo.vertexAttributes[i], hash);
+	}
+	hash = hashValue(createInfo.numVertexBufferSlots, hash);
+	for (uint32_t i = 0; i < createInfo.numVertexBufferSlots; i++) {
+		hash = hashValue(createInfo.vertexBufferStridesBytes[i], hash);
+	}
+	hash = hashValue(createInfo.numPushConstants, hash);
+	for (uint32_t i = 0; i < createInfo.numPushConstants; i++) {
+		hash = hashValue(createInfo.pushConstantRegisters[i], hash);
+	}
+	hash = hashValue(createInfo.numRootConstantBuffers, hash);
+	for (uint32_t i = 0; i < createInfo.numRootConstantBuffers; i++) {
+		hash = hashValue(createInfo.rootConstantBufferRegisters[i], hash);
+	}
+	hash = hashValue(createInfo.numSamplers, hash);
+	for (uint32_t i = 0; i < createInfo.numSamplers; i++) {
+		hash = hashValue(createInfo.samplers[i], hash);
+	}
+	hash = hashValue(createInfo.numRenderTargets, hash);
+	for (uint32_t i = 0; i < createInfo.numRenderTargets; i++) {
+		hash = hashValue(createInfo.renderTargets[i], hash);
+	}
+	hash = hashValue(createInfo.rasterizer, hash);
+	hash = hashValue(createInfo.blending, hash);
+	hash = hashValue(createInfo.depthTest, hash);
 
-	// Compile pixel shader
-	ComPtr<IDxcBlob> pixelBlob;
-	ComPtr<ID3D12ShaderReflection> pixelReflection;
-	ZgResult pixelShaderRes = compileHlslShader(
-		dxcCompiler,
-		dxcIncludeHandler,
-		pixelBlob,
-		pixelReflection,
-		pixelEncodingBlob,
-		pixelShaderName,
-		createInfo.pixelShaderEntry,
-		dxcCompilerFlags,
-		pixelShaderType);
-	if (pixelShaderRes != ZG_SUCCESS) return pixelShaderRes;
+	return hash;
+}
+
+static bool loadFromPipelineCache(uint64_t key, CompiledPipelineRender& compiledOut) noexcept
+{
+	PipelineCache* cache = getContext().pipelineCache;
+	if (cache == nullptr || !cache->enabled()) return false;
+
+	Vector<uint8_t> payload;
+	if (!cache->load(key, payload)) return false;
+
+	// Parse header and validate sizes
+	CompiledPipelineRenderHeader header = {};
+	if (payload.size() < sizeof(CompiledPipelineRenderHeader)) return false;
+	std::memcpy(&header, payload.data(), sizeof(CompiledPipelineRenderHeader));
+	uint64_t expectedSizeBytes = uint64_t(sizeof(CompiledPipelineRenderHeader)) +
+		header.vertexBytecodeSizeBytes + header.pixelBytecodeSizeBytes;
+	if (payload.size() != expectedSizeBytes) {
+		ZG_ERROR("Pipeline cache entry %016llx is corrupt, ignoring it", (unsigned long long)key);
+		return false;
+	}
+
+	compiledOut.reflection.signature = header.signature;
+	for (uint32_t i = 0; i < ZG_MAX_NUM_CONSTANT_BUFFERS; i++) {
+		compiledOut.reflection.constBufferVertexAccess[i] = header.constBufferVertexAccess[i] != 0;
+		compiledOut.reflection.constBufferPixelAccess[i] = header.constBufferPixelAccess[i] != 0;
+	}
+
+	const uint8_t* vertexBytecode = payload.data() + sizeof(CompiledPipelineRenderHeader);
+	const uint8_t* pixelBytecode = vertexBytecode + header.vertexBytecodeSizeBytes;
+	if (!copyBytecode(compiledOut.vertexBytecode, vertexBytecode, header.vertexBytecodeSizeBytes) ||
+		!copyBytecode(compiledOut.pixelBytecode, pixelBytecode, header.pixelBytecodeSizeBytes)) {
+		return false;
+	}
+	return true;
+}
+
+static void storeInPipelineCache(
+	uint64_t key,
+	const CompiledPipelineRender& compiled,
+	const PipelineCacheDependency* dependencies,
+	uint32_t numDependencies) noexcept
+{
+	PipelineCache* cache = getContext().pipelineCache;
+	if (cache == nullptr || !cache->enabled()) return;
+
+	CompiledPipelineRenderHeader header = {};
+	header.signature = compiled.reflection.signature;
+	for (uint32_t i = 0; i < ZG_MAX_NUM_CONSTANT_BUFFERS; i++) {
+		header.constBufferVertexAccess[i] = compiled.reflection.constBufferVertexAccess[i] ? 1 : 0;
+		header.constBufferPixelAccess[i] = compiled.reflection.constBufferPixelAccess[i] ? 1 : 0;
+	}
+	header.vertexBytecodeSizeBytes = compiled.vertexBytecode.size();
+	header.pixelBytecodeSizeBytes = compiled.pixelBytecode.size();
+
+	// Serialize payload
+	uint32_t payloadSizeBytes = uint32_t(sizeof(CompiledPipelineRenderHeader)) +
+		header.vertexBytecodeSizeBytes + header.pixelBytecodeSizeBytes;
+	Vector<uint8_t> payload;
+	if (!payload.create(payloadSizeBytes, "ZeroG - PipelineCache payload")) return;
+	payload.addMany(payloadSizeBytes);
+	uint8_t* dst = payload.data();
+	std::memcpy(dst, &header, sizeof(CompiledPipelineRenderHeader));
+	dst += sizeof(CompiledPipelineRenderHeader);
+	std::memcpy(dst, compiled.vertexBytecode.data(), header.vertexBytecodeSizeBytes);
+	dst += header.vertexBytecodeSizeBytes;
+	std::memcpy(dst, compiled.pixelBytecode.data(), header.pixelBytecodeSizeBytes);
+
+	cache->store(key, payload.data(), payload.size(), dependencies, numDependencies);
+}
 
+// Include handler which forwards to DXC's default one, but records the absolute path and content
+// hash of every included file so that cache entries can be invalidated when an include changes.
+// Lives on the stack for the duration of a compile, so there is no reference counting.
+class RecordingIncludeHandler final : public IDxcIncludeHandler {
+public:
+	RecordingIncludeHandler(IDxcIncludeHandler* defaultHandler) noexcept
+	:
+		mDefaultHandler(defaultHandler)
+	{ }
+
+	HRESULT STDMETHODCALLTYPE LoadSource(
+		LPCWSTR filename, IDxcBlob** includeSourceOut) noexcept override
+	{
+		if (mDefaultHandler == nullptr) return E_FAIL;
+		HRESULT res = mDefaultHandler->LoadSource(filename, includeSourceOut);
+		if (SUCCEEDED(res)) this->record(filename);
+		return res;
+	}
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** objectOut) noexcept override
+	{
+		if (riid == __uuidof(IUnknown) || riid == __uuidof(IDxcIncludeHandler)) {
+			*objectOut = static_cast<IDxcIncludeHandler*>(this);
+			return S_OK;
+		}
+		*objectOut = nullptr;
+		return E_NOINTERFACE;
+	}
+
+	ULONG STDMETHODCALLTYPE AddRef() noexcept override { return 1; }
+	ULONG STDMETHODCALLTYPE Release() noexcept override { return 1; }
+
+	// False if any include could not be recorded, in which case the result must not be cached
+	bool allRecorded() const noexcept { return mAllRecorded; }
+	const SmallVector<PipelineCacheDependency, 8>& dependencies() const noexcept
+	{
+		return mDependencies;
+	}
+
+private:
+	void record(LPCWSTR filename) noexcept
+	{
+		PipelineCacheDependency dependency;
+		char relativePath[PIPELINE_CACHE_MAX_PATH_LENGTH] = {};
+		if (!wideToUtf8(relativePath, PIPELINE_CACHE_MAX_PATH_LENGTH, filename) ||
+			!relativeToAbsolute(dependency.path, PIPELINE_CACHE_MAX_PATH_LENGTH, relativePath)) {
+			mAllRecorded = false;
+			return;
+		}
+
+		// The same header can be included multiple times
+		for (uint32_t i = 0; i < mDependencies.size(); i++) {
+			if (std::strcmp(mDependencies[i].path, dependency.path) == 0) return;
+		}
+
+		Vector<uint8_t> contents = readBinaryFile(dependency.path);
+		if (contents.size() == 0) {
+			mAllRecorded = false;
+			return;
+		}
+		dependency.contentHash = hashBytes(contents.data(), contents.size());
+		if (!mDependencies.add(dependency)) mAllRecorded = false;
+	}
+
+	IDxcIncludeHandler* mDefaultHandler = nullptr;
+	SmallVector<PipelineCacheDependency, 8> mDependencies;
+	bool mAllRecorded = true;
+};
+
+// Finds the bindless tables of a shader, see ZG_BINDLESS_TEXTURES_REGISTER_SPACE and
+// ZG_BINDLESS_BUFFERS_REGISTER_SPACE. No other resources may use their register spaces.
+static ZgResult reflectDxilBindless(
+	ZgPipelineRenderSignature& signatureOut,
+	ID3D12ShaderReflection& reflection,
+	uint32_t numBoundResources) noexcept
+{
+	for (uint32_t i = 0; i < numBoundResources; i++) {
+		D3D12_SHADER_INPUT_BIND_DESC resDesc = {};
+		CHECK_D3D12 reflection.GetResourceBindingDesc(i, &resDesc);
+
+		bool texturesSpace = resDesc.Space == ZG_BINDLESS_TEXTURES_REGISTER_SPACE;
+		bool buffersSpace = resDesc.Space == ZG_BINDLESS_BUFFERS_REGISTER_SPACE;
+		if (!texturesSpace && !buffersSpace) continue;
+
+		// Must be an unbounded array at register 0 of the expected type
+		bool unbounded = resDesc.BindCount == 0 || resDesc.BindCount == UINT_MAX;
+		bool validType = (texturesSpace && resDesc.Type == D3D_SIT_TEXTURE) ||
+			(buffersSpace && resDesc.Type == D3D_SIT_BYTEADDRESS);
+		if (!unbounded || !validType || resDesc.BindPoint != 0) {
+			ZG_ERROR("Shader resource %s (register = %u, space = %u) is not a valid bindless "
+				"table. Register space %u is reserved for \"%s[] : register(t0, space%u)\".",
+				resDesc.Name, resDesc.BindPoint, resDesc.Space, resDesc.Space,
+				texturesSpace ? "Texture2D" : "ByteAddressBuffer", resDesc.Space);
+			return ZG_ERROR_SHADER_COMPILE_ERROR;
+		}
+
+		if (texturesSpace) signatureOut.bindlessTextures = ZG_TRUE;
+		else signatureOut.bindlessBuffers = ZG_TRUE;
+	}
+	return ZG_SUCCESS;
+}
+
+static ZgResult reflectDxilPipelineRender(
+	PipelineRenderReflection& reflectionOut,
+	const ZgPipelineRenderCreateInfoCommon& createInfo,
+	ID3D12ShaderReflection& vertexReflection,
+	ID3D12ShaderReflection& pixelReflection) noexcept
+{
 	// Get shader description froms reflection data
 	D3D12_SHADER_DESC vertexDesc = {};
-	CHECK_D3D12 vertexReflection->GetDesc(&vertexDesc);
+	CHECK_D3D12 vertexReflection.GetDesc(&vertexDesc);
 	D3D12_SHADER_DESC pixelDesc = {};
-	CHECK_D3D12 pixelReflection->GetDesc(&pixelDesc);
+	CHECK_D3D12 pixelReflection.GetDesc(&pixelDesc);
 
 	// Validate that the user has specified correct number of vertex attributes
 	if (createInfo.numVertexAttributes != vertexDesc.InputParameters) {
@@ -685,7 +836,7 @@ static ZgResult createPipelineRenderInternal(
 			createInfo.numVertexAttributes, vertexDesc.InputParameters);
 		return ZG_ERROR_INVALID_ARGUMENT;
 	}
-	signatureOut->numVertexAttributes = createInfo.numVertexAttributes;
+	reflectionOut.signature.numVertexAttributes = createInfo.numVertexAttributes;
 
 	// Validate vertex attributes
 	for (uint32_t i = 0; i < createInfo.numVertexAttributes; i++) {
@@ -694,7 +845,7 @@ static ZgResult createPipelineRenderInternal(
 
 		// Get signature for the i:th vertex attribute
 		D3D12_SIGNATURE_PARAMETER_DESC sign = {};
-		CHECK_D3D12 vertexReflection->GetInputParameterDesc(i, &sign);
+		CHECK_D3D12 vertexReflection.GetInputParameterDesc(i, &sign);
 
 		// Get the type found in the shader
 		ZgVertexAttributeType reflectedType =
@@ -721,7 +872,7 @@ static ZgResult createPipelineRenderInternal(
 		}
 
 		// Set vertex attribute in signature
-		signatureOut->vertexAttributes[i] = attrib;
+		reflectionOut.signature.vertexAttributes[i] = attrib;
 	}
 
 	// Build up list of all constant buffers
@@ -736,7 +887,7 @@ static ZgResult createPipelineRenderInternal(
 	// First add all constant buffers from vertex shader
 	for (uint32_t i = 0; i < vertexDesc.BoundResources; i++) {
 		D3D12_SHADER_INPUT_BIND_DESC resDesc = {};
-		CHECK_D3D12 vertexReflection->GetResourceBindingDesc(i, &resDesc);
+		CHECK_D3D12 vertexReflection.GetResourceBindingDesc(i, &resDesc);
 
 		// Continue if not a constant buffer
 		if (resDesc.Type != D3D_SIT_CBUFFER) continue;
@@ -765,7 +916,7 @@ static ZgResult createPipelineRenderInternal(
 
 		// Get constant buffer reflection
 		ID3D12ShaderReflectionConstantBuffer* cbufferReflection =
-			vertexReflection->GetConstantBufferByName(resDesc.Name);
+			vertexReflection.GetConstantBufferByName(resDesc.Name);
 		D3D12_SHADER_BUFFER_DESC cbufferDesc = {};
 		CHECK_D3D12 cbufferReflection->GetDesc(&cbufferDesc);
 
@@ -782,7 +933,7 @@ static ZgResult createPipelineRenderInternal(
 	// Then add constant buffers from pixel shader
 	for (uint32_t i = 0; i < pixelDesc.BoundResources; i++) {
 		D3D12_SHADER_INPUT_BIND_DESC resDesc = {};
-		CHECK_D3D12 pixelReflection->GetResourceBindingDesc(i, &resDesc);
+		CHECK_D3D12 pixelReflection.GetResourceBindingDesc(i, &resDesc);
 
 		// Continue if not a constant buffer
 		if (resDesc.Type != D3D_SIT_CBUFFER) continue;
@@ -827,7 +978,7 @@ static ZgResult createPipelineRenderInternal(
 
 		// Get constant buffer reflection
 		ID3D12ShaderReflectionConstantBuffer* cbufferReflection =
-			pixelReflection->GetConstantBufferByName(resDesc.Name);
+			pixelReflection.GetConstantBufferByName(resDesc.Name);
 		D3D12_SHADER_BUFFER_DESC cbufferDesc = {};
 		CHECK_D3D12 cbufferReflection->GetDesc(&cbufferDesc);
 
@@ -874,13 +1025,42 @@ static ZgResult createPipelineRenderInternal(
 		}
 	}
 
+	// Mark the buffers bound as root constant buffers, they can't also be push constants
+	for (uint32_t i = 0; i < createInfo.numRootConstantBuffers; i++) {
+		uint32_t shaderRegister = createInfo.rootConstantBufferRegisters[i];
+		ZgConstantBufferDesc* cbuffer = nullptr;
+		for (uint32_t j = 0; j < numConstBuffers; j++) {
+			ZgConstantBufferDesc& candidate = constBuffers[j].desc;
+			if (candidate.shaderRegister == shaderRegister) cbuffer = &candidate;
+		}
+		if (cbuffer == nullptr) {
+			ZG_ERROR("Shader register %u was registered as a root constant buffer, but never used "
+				"in the shader", shaderRegister);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+		if (cbuffer->pushConstant || cbuffer->rootConstantBuffer) {
+			ZG_ERROR("Shader register %u was registered as a root constant buffer more than once, "
+				"or also as a push constant", shaderRegister);
+			return ZG_ERROR_INVALID_ARGUMENT;
+		}
+		cbuffer->rootConstantBuffer = ZG_TRUE;
+	}
+
 	// Copy constant buffer information to signature
-	signatureOut->numConstantBuffers = numConstBuffers;
+	reflectionOut.signature.numConstantBuffers = numConstBuffers;
 	for (uint32_t i = 0; i < numConstBuffers; i++) {
-		signatureOut->constantBuffers[i] = constBuffers[i].desc;
+		reflectionOut.signature.constantBuffers[i] = constBuffers[i].desc;
 	}
 
 
+	// Find bindless tables
+	ZgResult bindlessRes =
+		reflectDxilBindless(reflectionOut.signature, vertexReflection, vertexDesc.BoundResources);
+	if (bindlessRes != ZG_SUCCESS) return bindlessRes;
+	bindlessRes =
+		reflectDxilBindless(reflectionOut.signature, pixelReflection, pixelDesc.BoundResources);
+	if (bindlessRes != ZG_SUCCESS) return bindlessRes;
+
 	// Gather all textures
 	struct TextureMeta {
 		ZgTextureDesc desc = {};
@@ -893,10 +1073,11 @@ static ZgResult createPipelineRenderInternal(
 	// First add all textures from vertex shader
 	for (uint32_t i = 0; i < vertexDesc.BoundResources; i++) {
 		D3D12_SHADER_INPUT_BIND_DESC resDesc = {};
-		CHECK_D3D12 vertexReflection->GetResourceBindingDesc(i, &resDesc);
+		CHECK_D3D12 vertexReflection.GetResourceBindingDesc(i, &resDesc);
 
-		// Continue if not a texture
+		// Continue if not a texture, or if part of the bindless table
 		if (resDesc.Type != D3D_SIT_TEXTURE) continue;
+		if (resDesc.Space == ZG_BINDLESS_TEXTURES_REGISTER_SPACE) continue;
 
 		// Error out if texture uses more than one register
 		// TODO: This should probably be relaxed
@@ -931,10 +1112,11 @@ static ZgResult createPipelineRenderInternal(
 	// Then add textures from pixel shader
 	for (uint32_t i = 0; i < pixelDesc.BoundResources; i++) {
 		D3D12_SHADER_INPUT_BIND_DESC resDesc = {};
-		CHECK_D3D12 pixelReflection->GetResourceBindingDesc(i, &resDesc);
+		CHECK_D3D12 pixelReflection.GetResourceBindingDesc(i, &resDesc);
 
-		// Continue if not a texture
+		// Continue if not a texture, or if part of the bindless table
 		if (resDesc.Type != D3D_SIT_TEXTURE) continue;
+		if (resDesc.Space == ZG_BINDLESS_TEXTURES_REGISTER_SPACE) continue;
 
 		// See if texture was already found/used by vertex shader
 		uint32_t vertexTextureIdx = ~0u;
@@ -989,9 +1171,9 @@ static ZgResult createPipelineRenderInternal(
 	});
 
 	// Copy texture information to signature
-	signatureOut->numTextures = numTextures;
+	reflectionOut.signature.numTextures = numTextures;
 	for (uint32_t i = 0; i < numTextures; i++) {
-		signatureOut->textures[i] = textureMetas[i].desc;
+		reflectionOut.signature.textures[i] = textureMetas[i].desc;
 	}
 
 
@@ -999,7 +1181,7 @@ static ZgResult createPipelineRenderInternal(
 	bool samplerSet[ZG_MAX_NUM_SAMPLERS] = {};
 	for (uint32_t i = 0; i < vertexDesc.BoundResources; i++) {
 		D3D12_SHADER_INPUT_BIND_DESC resDesc = {};
-		CHECK_D3D12 vertexReflection->GetResourceBindingDesc(i, &resDesc);
+		CHECK_D3D12 vertexReflection.GetResourceBindingDesc(i, &resDesc);
 
 		// Continue if not a sampler
 		if (resDesc.Type != D3D_SIT_SAMPLER) continue;
@@ -1018,7 +1200,7 @@ static ZgResult createPipelineRenderInternal(
 	}
 	for (uint32_t i = 0; i < pixelDesc.BoundResources; i++) {
 		D3D12_SHADER_INPUT_BIND_DESC resDesc = {};
-		CHECK_D3D12 pixelReflection->GetResourceBindingDesc(i, &resDesc);
+		CHECK_D3D12 pixelReflection.GetResourceBindingDesc(i, &resDesc);
 
 		// Continue if not a sampler
 		if (resDesc.Type != D3D_SIT_SAMPLER) continue;
@@ -1054,11 +1236,135 @@ static ZgResult createPipelineRenderInternal(
 	}
 
 	// Copy render target info to signature
-	signatureOut->numRenderTargets = numRenderTargets;
+	reflectionOut.signature.numRenderTargets = numRenderTargets;
 	for (uint32_t i = 0; i < numRenderTargets; i++) {
-		signatureOut->renderTargets[i] = createInfo.renderTargets[i];
+		reflectionOut.signature.renderTargets[i] = createInfo.renderTargets[i];
 	}
 
+	// Copy out which shader stages access each constant buffer
+	for (uint32_t i = 0; i < numConstBuffers; i++) {
+		reflectionOut.constBufferVertexAccess[i] = constBuffers[i].vertexAccess;
+		reflectionOut.constBufferPixelAccess[i] = constBuffers[i].pixelAccess;
+	}
+
+	return ZG_SUCCESS;
+}
+
+static ZgResult compilePipelineRender(
+	CompiledPipelineRender& compiledOut,
+	uint64_t cacheKey,
+	const ZgPipelineRenderCreateInfoCommon& createInfo,
+	ZgShaderModel shaderModel,
+	const char* const dxcCompilerFlags[],
+	const ZgShaderDefine* defines,
+	uint32_t numDefines,
+	const ComPtr<IDxcBlobEncoding>& vertexEncodingBlob,
+	const ComPtr<IDxcBlobEncoding> pixelEncodingBlob,
+	const char* vertexShaderName,
+	const char* pixelShaderName,
+	IDxcCompiler& dxcCompiler,
+	IDxcIncludeHandler* dxcIncludeHandler,
+	const PipelineRenderReflection* knownReflection) noexcept
+{
+	// Record included files so the pipeline cache can tell when they change
+	RecordingIncludeHandler includeHandler(dxcIncludeHandler);
+
+	// Pick out which vertex and pixel shader type to compile with
+	HlslShaderType vertexShaderType = HlslShaderType::VERTEX_SHADER_6_0;
+	HlslShaderType pixelShaderType = HlslShaderType::PIXEL_SHADER_6_0;
+	switch (shaderModel) {
+	case ZG_SHADER_MODEL_6_0:
+		vertexShaderType = HlslShaderType::VERTEX_SHADER_6_0;
+		pixelShaderType = HlslShaderType::PIXEL_SHADER_6_0;
+		break;
+	case ZG_SHADER_MODEL_6_1:
+		vertexShaderType = HlslShaderType::VERTEX_SHADER_6_1;
+		pixelShaderType = HlslShaderType::PIXEL_SHADER_6_1;
+		break;
+	case ZG_SHADER_MODEL_6_2:
+		vertexShaderType = HlslShaderType::VERTEX_SHADER_6_2;
+		pixelShaderType = HlslShaderType::PIXEL_SHADER_6_2;
+		break;
+	case ZG_SHADER_MODEL_6_3:
+		vertexShaderType = HlslShaderType::VERTEX_SHADER_6_3;
+		pixelShaderType = HlslShaderType::PIXEL_SHADER_6_3;
+		break;
+	}
+
+	// Compile vertex shader
+	ComPtr<IDxcBlob> vertexBlob;
+	ComPtr<ID3D12ShaderReflection> vertexReflection;
+	ZgResult vertexShaderRes = compileHlslShader(
+		dxcCompiler,
+		&includeHandler,
+		vertexBlob,
+		vertexReflection,
+		vertexEncodingBlob,
+		vertexShaderName,
+		createInfo.vertexShaderEntry,
+		dxcCompilerFlags,
+		defines,
+		numDefines,
+		vertexShaderType);
+	if (vertexShaderRes != ZG_SUCCESS) return vertexShaderRes;
+
+	// Compile pixel shader
+	ComPtr<IDxcBlob> pixelBlob;
+	ComPtr<ID3D12ShaderReflection> pixelReflection;
+	ZgResult pixelShaderRes = compileHlslShader(
+		dxcCompiler,
+		&includeHandler,
+		pixelBlob,
+		pixelReflection,
+		pixelEncodingBlob,
+		pixelShaderName,
+		createInfo.pixelShaderEntry,
+		dxcCompilerFlags,
+		defines,
+		numDefines,
+		pixelShaderType);
+	if (pixelShaderRes != ZG_SUCCESS) return pixelShaderRes;
+
+	// Reflect the compiled DXIL, unless the pipeline has already been reflected from its source
+	if (knownReflection != nullptr) {
+		compiledOut.reflection = *knownReflection;
+	}
+	else {
+		ZgResult reflectRes = reflectDxilPipelineRender(
+			compiledOut.reflection, createInfo, *vertexReflection.Get(), *pixelReflection.Get());
+		if (reflectRes != ZG_SUCCESS) return reflectRes;
+	}
+
+	// Copy out bytecode
+	if (!copyBytecode(compiledOut.vertexBytecode,
+			vertexBlob->GetBufferPointer(), uint32_t(vertexBlob->GetBufferSize())) ||
+		!copyBytecode(compiledOut.pixelBytecode,
+			pixelBlob->GetBufferPointer(), uint32_t(pixelBlob->GetBufferSize()))) {
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+
+	// Store in pipeline cache, unless we failed to keep track of an included file
+	if (includeHandler.allRecorded()) {
+		const SmallVector<PipelineCacheDependency, 8>& dependencies =
+			includeHandler.dependencies();
+		storeInPipelineCache(cacheKey, compiledOut, dependencies.data(), dependencies.size());
+	}
+
+	return ZG_SUCCESS;
+}
+
+static ZgResult createPipelineRenderFromCompiled(
+	D3D12PipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoCommon& createInfo,
+	const CompiledPipelineRender& compiled,
+	time_point compileStartTime,
+	const char* vertexShaderName,
+	const char* pixelShaderName,
+	D3D12RootSignatureCache& rootSignatureCache,
+	ID3D12Device3& device) noexcept
+{
+	*signatureOut = compiled.reflection.signature;
 
 	// Convert ZgVertexAttribute's to D3D12_INPUT_ELEMENT_DESC
 	// This is the "input layout"
@@ -1081,6 +1387,10 @@ static ZgResult createPipelineRenderInternal(
 	D3D12PushConstantMapping pushConstantMappings[ZG_MAX_NUM_CONSTANT_BUFFERS] = {};
 	uint32_t numPushConstantsMappings = 0;
 
+	// List of root constant buffer mappings to be filled in when creating root signature
+	D3D12RootConstantBufferMapping rootConstBufferMappings[ZG_MAX_NUM_CONSTANT_BUFFERS] = {};
+	uint32_t numRootConstBufferMappings = 0;
+
 	// List of constant buffer mappings to be filled in when creating root signature
 	D3D12ConstantBufferMapping constBufferMappings[ZG_MAX_NUM_CONSTANT_BUFFERS] = {};
 	uint32_t numConstBufferMappings = 0;
@@ -1090,6 +1400,8 @@ static ZgResult createPipelineRenderInternal(
 	uint32_t numTexMappings = 0;
 
 	uint32_t dynamicBuffersParameterIndex = ~0u;
+	uint32_t bindlessTexturesParameterIndex = ~0u;
+	uint32_t bindlessBuffersParameterIndex = ~0u;
 
 	// Create root signature
 	ComPtr<ID3D12RootSignature> rootSignature;
@@ -1106,9 +1418,8 @@ static ZgResult createPipelineRenderInternal(
 
 		// Add push constants
 		for (uint32_t i = 0; i < signatureOut->numConstantBuffers; i++) {
-			const ConstBufferMeta& cbuffer = constBuffers[i];
-			//const ZgConstantBufferDesc& cbuffer = signatureOut->constantBuffers[i];
-			if (cbuffer.desc.pushConstant == ZG_FALSE) continue;
+			const ZgConstantBufferDesc& cbuffer = signatureOut->constantBuffers[i];
+			if (cbuffer.pushConstant == ZG_FALSE) continue;
 
 			// Get parameter index for the push constant
 			uint32_t parameterIndex = numParameters;
@@ -1116,31 +1427,53 @@ static ZgResult createPipelineRenderInternal(
 			ZG_ASSERT(numParameters <= MAX_NUM_ROOT_PARAMETERS);
 
 			// Calculate the correct shader visibility for the constant
-			D3D12_SHADER_VISIBILITY visibility = D3D12_SHADER_VISIBILITY_ALL;
-			if (cbuffer.vertexAccess && !cbuffer.pixelAccess) {
-				visibility = D3D12_SHADER_VISIBILITY_VERTEX;
-			}
-			else if (!cbuffer.vertexAccess && cbuffer.pixelAccess) {
-				visibility = D3D12_SHADER_VISIBILITY_PIXEL;
-			}
+			D3D12_SHADER_VISIBILITY visibility = constBufferVisibility(
+				compiled.reflection.constBufferVertexAccess[i],
+				compiled.reflection.constBufferPixelAccess[i]);
 
-			ZG_ASSERT((cbuffer.desc.sizeInBytes % 4) == 0);
-			ZG_ASSERT(cbuffer.desc.sizeInBytes <= 1024);
+			ZG_ASSERT((cbuffer.sizeInBytes % 4) == 0);
+			ZG_ASSERT(cbuffer.sizeInBytes <= 1024);
 			parameters[parameterIndex].InitAsConstants(
-				cbuffer.desc.sizeInBytes / 4, cbuffer.desc.shaderRegister, 0, visibility);
+				cbuffer.sizeInBytes / 4, cbuffer.shaderRegister, 0, visibility);
 
 			// Add to push constants mappings
-			pushConstantMappings[numPushConstantsMappings].shaderRegister = cbuffer.desc.shaderRegister;
+			pushConstantMappings[numPushConstantsMappings].shaderRegister = cbuffer.shaderRegister;
 			pushConstantMappings[numPushConstantsMappings].parameterIndex = parameterIndex;
-			pushConstantMappings[numPushConstantsMappings].sizeInBytes = cbuffer.desc.sizeInBytes;
+			pushConstantMappings[numPushConstantsMappings].sizeInBytes = cbuffer.sizeInBytes;
 			numPushConstantsMappings += 1;
 		}
 
+		// Add root constant buffers, bound directly by GPU virtual address so no descriptor is
+		// needed when switching buffer or offset
+		for (uint32_t i = 0; i < signatureOut->numConstantBuffers; i++) {
+			const ZgConstantBufferDesc& cbuffer = signatureOut->constantBuffers[i];
+			if (cbuffer.rootConstantBuffer == ZG_FALSE) continue;
+
+			// Get parameter index for the root constant buffer
+			uint32_t parameterIndex = numParameters;
+			numParameters += 1;
+			ZG_ASSERT(numParameters <= MAX_NUM_ROOT_PARAMETERS);
+
+			D3D12_SHADER_VISIBILITY visibility = constBufferVisibility(
+				compiled.reflection.constBufferVertexAccess[i],
+				compiled.reflection.constBufferPixelAccess[i]);
+			parameters[parameterIndex].InitAsConstantBufferView(
+				cbuffer.shaderRegister, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, visibility);
+
+			// Add to root constant buffer mappings
+			uint32_t mappingIdx = numRootConstBufferMappings;
+			numRootConstBufferMappings += 1;
+			rootConstBufferMappings[mappingIdx].shaderRegister = cbuffer.shaderRegister;
+			rootConstBufferMappings[mappingIdx].parameterIndex = parameterIndex;
+			rootConstBufferMappings[mappingIdx].sizeInBytes = cbuffer.sizeInBytes;
+		}
+
 		// Add dynamic constant buffers (non-push constants)
 		uint32_t dynamicConstBuffersFirstRegister = ~0u; // TODO: THIS IS PROBABLY BAD
 		for (uint32_t i = 0; i < signatureOut->numConstantBuffers; i++) {
 			const ZgConstantBufferDesc& cbuffer = signatureOut->constantBuffers[i];
 			if (cbuffer.pushConstant == ZG_TRUE) continue;
+			if (cbuffer.rootConstantBuffer == ZG_TRUE) continue;
 
 			if (dynamicConstBuffersFirstRegister == ~0u) {
 				dynamicConstBuffersFirstRegister = cbuffer.shaderRegister;
@@ -1194,6 +1527,33 @@ static ZgResult createPipelineRenderInternal(
 		}
 		parameters[dynamicBuffersParameterIndex].InitAsDescriptorTable(numRanges, ranges);
 
+		// Add bindless tables, both point to the start of the bindless part of the descriptor heap.
+		// The descriptors may change while the table is bound, as resources are created and
+		// released, so they are declared volatile.
+		const D3D12_DESCRIPTOR_RANGE_FLAGS bindlessFlags =
+			D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE |
+			D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE;
+		CD3DX12_DESCRIPTOR_RANGE1 bindlessTexturesRange;
+		bindlessTexturesRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0,
+			ZG_BINDLESS_TEXTURES_REGISTER_SPACE, bindlessFlags);
+		CD3DX12_DESCRIPTOR_RANGE1 bindlessBuffersRange;
+		bindlessBuffersRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0,
+			ZG_BINDLESS_BUFFERS_REGISTER_SPACE, bindlessFlags);
+		if (signatureOut->bindlessTextures) {
+			bindlessTexturesParameterIndex = numParameters;
+			numParameters += 1;
+			ZG_ASSERT(numParameters <= MAX_NUM_ROOT_PARAMETERS);
+			parameters[bindlessTexturesParameterIndex].InitAsDescriptorTable(
+				1, &bindlessTexturesRange);
+		}
+		if (signatureOut->bindlessBuffers) {
+			bindlessBuffersParameterIndex = numParameters;
+			numParameters += 1;
+			ZG_ASSERT(numParameters <= MAX_NUM_ROOT_PARAMETERS);
+			parameters[bindlessBuffersParameterIndex].InitAsDescriptorTable(
+				1, &bindlessBuffersRange);
+		}
+
 		// Add static samplers
 		D3D12_STATIC_SAMPLER_DESC samplers[ZG_MAX_NUM_SAMPLERS] = {};
 		for (uint32_t i = 0; i < createInfo.numSamplers; i++) {
@@ -1228,13 +1588,19 @@ static ZgResult createPipelineRenderInternal(
 			return ZG_ERROR_GENERIC;
 		}
 
-		// Create root signature
-		if (D3D12_FAIL(device.CreateRootSignature(
-			0, blob->GetBufferPointer(), blob->GetBufferSize(), IID_PPV_ARGS(&rootSignature)))) {
-			return ZG_ERROR_GENERIC;
-		}
+		// Get root signature, shared with all other pipelines with the same layout
+		ZgResult rootSignatureRes =
+			rootSignatureCache.getOrCreate(rootSignature, *blob.Get(), device);
+		if (rootSignatureRes != ZG_SUCCESS) return rootSignatureRes;
 	}
 
+	// Hash the descriptor table layout, command lists can keep a bound descriptor table when
+	// switching between pipelines with the same root signature and table layout
+	uint64_t tableLayoutHash = hashBytes(
+		constBufferMappings, sizeof(D3D12ConstantBufferMapping) * numConstBufferMappings);
+	tableLayoutHash = hashBytes(
+		texMappings, sizeof(D3D12TextureMapping) * numTexMappings, tableLayoutHash);
+
 	// Create Pipeline State Object (PSO)
 	ComPtr<ID3D12PipelineState> pipelineState;
 	{
@@ -1270,11 +1636,11 @@ static ZgResult createPipelineRenderInternal(
 
 		// Set vertex shader
 		stream.vertexShader = CD3DX12_SHADER_BYTECODE(
-			vertexBlob->GetBufferPointer(), vertexBlob->GetBufferSize());
+			compiled.vertexBytecode.data(), compiled.vertexBytecode.size());
 
 		// Set pixel shader
 		stream.pixelShader = CD3DX12_SHADER_BYTECODE(
-			pixelBlob->GetBufferPointer(), pixelBlob->GetBufferSize());
+			compiled.pixelBytecode.data(), compiled.pixelBytecode.size());
 
 		// Set render target formats
 		D3D12_RT_FORMAT_ARRAY rtvFormats = {};
@@ -1359,16 +1725,38 @@ static ZgResult createPipelineRenderInternal(
 	pipeline->rootSignature = rootSignature;
 	pipeline->signature = *signatureOut;
 	pipeline->numPushConstants = numPushConstantsMappings;
+	pipeline->numRootConstantBuffers = numRootConstBufferMappings;
 	pipeline->numConstantBuffers = numConstBufferMappings;
 	for (uint32_t i = 0; i < ZG_MAX_NUM_CONSTANT_BUFFERS; i++) {
 		pipeline->pushConstants[i] = pushConstantMappings[i];
+		pipeline->rootConstBuffers[i] = rootConstBufferMappings[i];
 		pipeline->constBuffers[i] = constBufferMappings[i];
 	}
 	pipeline->numTextures = numTexMappings;
 	for (uint32_t i = 0; i < ZG_MAX_NUM_TEXTURES; i++) {
 		pipeline->textures[i] = texMappings[i];
 	}
+
+	// Build register lookups
+	for (uint32_t i = 0; i < numPushConstantsMappings; i++) {
+		pipeline->pushConstantLookup.add(pushConstantMappings[i].shaderRegister);
+	}
+	for (uint32_t i = 0; i < numRootConstBufferMappings; i++) {
+		pipeline->rootConstBufferLookup.add(rootConstBufferMappings[i].shaderRegister);
+	}
+	for (uint32_t i = 0; i < numConstBufferMappings; i++) {
+		pipeline->constBufferLookup.add(constBufferMappings[i].shaderRegister);
+	}
+	for (uint32_t i = 0; i < numTexMappings; i++) {
+		pipeline->textureLookup.add(texMappings[i].textureRegister);
+	}
 	pipeline->dynamicBuffersParameterIndex = dynamicBuffersParameterIndex;
+	pipeline->bindlessTexturesParameterIndex = bindlessTexturesParameterIndex;
+	pipeline->bindlessBuffersParameterIndex = bindlessBuffersParameterIndex;
+	pipeline->tableLayoutHash = tableLayoutHash;
+	pipeline->bytecodeHash = hashDxilProgram(
+		compiled.pixelBytecode.data(), compiled.pixelBytecode.size(),
+		hashDxilProgram(compiled.vertexBytecode.data(), compiled.vertexBytecode.size(), HASH_SEED));
 	pipeline->createInfo = createInfo;
 
 	// Return pipeline
@@ -1384,81 +1772,217 @@ D3D12PipelineRender::~D3D12PipelineRender() noexcept
 	// Do nothing
 }
 
+void D3D12PipelineRender::swap(D3D12PipelineRender& other) noexcept
+{
+	std::swap(this->pipelineState, other.pipelineState);
+	std::swap(this->rootSignature, other.rootSignature);
+	std::swap(this->signature, other.signature);
+	std::swap(this->numPushConstants, other.numPushConstants);
+	std::swap(this->pushConstants, other.pushConstants);
+	std::swap(this->numRootConstantBuffers, other.numRootConstantBuffers);
+	std::swap(this->rootConstBuffers, other.rootConstBuffers);
+	std::swap(this->numConstantBuffers, other.numConstantBuffers);
+	std::swap(this->constBuffers, other.constBuffers);
+	std::swap(this->numTextures, other.numTextures);
+	std::swap(this->textures, other.textures);
+	std::swap(this->pushConstantLookup, other.pushConstantLookup);
+	std::swap(this->rootConstBufferLookup, other.rootConstBufferLookup);
+	std::swap(this->constBufferLookup, other.constBufferLookup);
+	std::swap(this->textureLookup, other.textureLookup);
+	std::swap(this->dynamicBuffersParameterIndex, other.dynamicBuffersParameterIndex);
+	std::swap(this->bindlessTexturesParameterIndex, other.bindlessTexturesParameterIndex);
+	std::swap(this->bindlessBuffersParameterIndex, other.bindlessBuffersParameterIndex);
+	std::swap(this->tableLayoutHash, other.tableLayoutHash);
+	std::swap(this->bytecodeHash, other.bytecodeHash);
+	std::swap(this->createInfo, other.createInfo);
+}
+
+static ZgResult createPipelineRenderSpirv(
+	D3D12PipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	ZgPipelineRenderCreateInfoCommon createInfo,
+	time_point compileStartTime,
+	const uint8_t* vertexSpirv,
+	uint32_t vertexSpirvSizeBytes,
+	const uint8_t* pixelSpirv,
+	uint32_t pixelSpirvSizeBytes,
+	const char* vertexShaderName,
+	const char* pixelShaderName,
+	const ZgSpecializationConstant* specializationConstants,
+	uint32_t numSpecializationConstants,
+	IDxcLibrary& dxcLibrary,
+	IDxcCompiler& dxcCompiler,
+	IDxcIncludeHandler* dxcIncludeHandler,
+	D3D12RootSignatureCache& rootSignatureCache,
+	ID3D12Device3& device) noexcept
+{
+	// Fake some compiler flags
+	const char* dxcCompilerFlags[ZG_MAX_NUM_DXC_COMPILER_FLAGS] = {};
+	dxcCompilerFlags[0] = "-Zi";
+	dxcCompilerFlags[1] = "-O3";
+
+	// Modify entry points in create info to always be "main", because that seems to be what
+	// SPIRV-Cross generates
+	createInfo.vertexShaderEntry = "main";
+	createInfo.pixelShaderEntry = "main";
+
+	// Check pipeline cache, on a hit both cross-compilation and DXC can be skipped
+	uint64_t cacheKey = pipelineCacheKey("SPIRV",
+		vertexSpirv, vertexSpirvSizeBytes, pixelSpirv, pixelSpirvSizeBytes,
+		createInfo, ZG_SHADER_MODEL_6_0, dxcCompilerFlags,
+		nullptr, 0, specializationConstants, numSpecializationConstants);
+	CompiledPipelineRender compiled;
+	if (!loadFromPipelineCache(cacheKey, compiled)) {
+
+		// Reflect the SPIR-V directly, the DXIL compiled from it does not need to be reflected
+		SpirvPipelineReflection spirvReflection;
+		ZgResult reflectRes = reflectSpirvPipelineRender(
+			spirvReflection,
+			vertexSpirv,
+			vertexSpirvSizeBytes,
+			pixelSpirv,
+			pixelSpirvSizeBytes);
+		if (reflectRes != ZG_SUCCESS) return reflectRes;
+		PipelineRenderReflection reflection;
+		ZgResult validateRes =
+			validateSpirvPipelineRender(reflection, spirvReflection, createInfo);
+		if (validateRes != ZG_SUCCESS) return validateRes;
+
+		// Cross-compile vertex and pixel shader to HLSL in parallel
+		CrossCompileTaskData crossCompileData;
+		crossCompileData.spirv[0] = vertexSpirv;
+		crossCompileData.spirvSizeBytes[0] = vertexSpirvSizeBytes;
+		crossCompileData.spirv[1] = pixelSpirv;
+		crossCompileData.spirvSizeBytes[1] = pixelSpirvSizeBytes;
+		crossCompileData.pushConstantRegister = spirvReflection.pushConstantRegister;
+		crossCompileData.specializationConstants = specializationConstants;
+		crossCompileData.numSpecializationConstants = numSpecializationConstants;
+		parallelFor(2, crossCompileSpirvToHLSLTask, &crossCompileData);
+		Vector<char> vertexHlslSrc = std::move(crossCompileData.hlslSrc[0]);
+		if (vertexHlslSrc.size() == 0) return ZG_ERROR_SHADER_COMPILE_ERROR;
+		Vector<char> pixelHlslSrc = std::move(crossCompileData.hlslSrc[1]);
+		if (pixelHlslSrc.size() == 0) return ZG_ERROR_SHADER_COMPILE_ERROR;
+
+		// Log the modified source code
+		ZG_NOISE("SPIRV-Cross compiled vertex HLSL source:\n\n%s", vertexHlslSrc.data());
+		ZG_NOISE("SPIRV-Cross compiled pixel HLSL source:\n\n%s", pixelHlslSrc.data());
+
+		// Create encoding blob from source
+		ComPtr<IDxcBlobEncoding> vertexEncodingBlob;
+		ZgResult vertexBlobReadRes =
+			dxcCreateHlslBlobFromSource(dxcLibrary, vertexHlslSrc.data(), vertexEncodingBlob);
+		if (vertexBlobReadRes != ZG_SUCCESS) return vertexBlobReadRes;
+
+		// Create encoding blob from source
+		ComPtr<IDxcBlobEncoding> pixelEncodingBlob;
+		ZgResult pixelBlobReadRes =
+			dxcCreateHlslBlobFromSource(dxcLibrary, pixelHlslSrc.data(), pixelEncodingBlob);
+		if (pixelBlobReadRes != ZG_SUCCESS) return pixelBlobReadRes;
+
+		ZgResult compileRes = compilePipelineRender(
+			compiled,
+			cacheKey,
+			createInfo,
+			ZG_SHADER_MODEL_6_0,
+			dxcCompilerFlags,
+			nullptr,
+			0,
+			vertexEncodingBlob,
+			pixelEncodingBlob,
+			vertexShaderName,
+			pixelShaderName,
+			dxcCompiler,
+			dxcIncludeHandler,
+			&reflection);
+		if (compileRes != ZG_SUCCESS) return compileRes;
+	}
+
+	return createPipelineRenderFromCompiled(
+		pipelineOut,
+		signatureOut,
+		createInfo,
+		compiled,
+		compileStartTime,
+		vertexShaderName,
+		pixelShaderName,
+		rootSignatureCache,
+		device);
+}
+
 // D3D12 PipelineRender functions
 // ------------------------------------------------------------------------------------------------
 
 ZgResult createPipelineRenderFileSPIRV(
 	D3D12PipelineRender** pipelineOut,
 	ZgPipelineRenderSignature* signatureOut,
-	ZgPipelineRenderCreateInfoFileSPIRV createInfo,
+	const ZgPipelineRenderCreateInfoFileSPIRV& createInfo,
 	IDxcLibrary& dxcLibrary,
 	IDxcCompiler& dxcCompiler,
 	IDxcIncludeHandler* dxcIncludeHandler,
+	D3D12RootSignatureCache& rootSignatureCache,
 	ID3D12Device3& device) noexcept
 {
 	// Start measuring compile-time
 	time_point compileStartTime;
 	calculateDeltaMillis(compileStartTime);
 
-	// Initialize SPIRV-Cross
-	spvc_context spvcContext = nullptr;
-	spvc_result res = CHECK_SPIRV_CROSS(nullptr) spvc_context_create(&spvcContext);
-	if (res != SPVC_SUCCESS) return ZG_ERROR_GENERIC;
-
-	// Read vertex SPIRV binary and cross-compile to HLSL
+	// Read vertex and pixel SPIRV binaries
 	Vector<uint8_t> vertexData = readBinaryFile(createInfo.vertexShaderPath);
 	if (vertexData.size() == 0) return ZG_ERROR_INVALID_ARGUMENT;
-	Vector<char> vertexHlslSrc = crossCompileSpirvToHLSL(spvcContext, vertexData);
-	if (vertexHlslSrc.size() == 0) return ZG_ERROR_SHADER_COMPILE_ERROR;
-
-	// Read pixel SPIRV binary and cross-compile to HLSL
 	Vector<uint8_t> pixelData = readBinaryFile(createInfo.pixelShaderPath);
 	if (pixelData.size() == 0) return ZG_ERROR_INVALID_ARGUMENT;
-	Vector<char> pixelHlslSrc = crossCompileSpirvToHLSL(spvcContext, pixelData);
-	if (pixelHlslSrc.size() == 0) return ZG_ERROR_SHADER_COMPILE_ERROR;
-
-	// Log the modified source code
-	ZG_NOISE("SPIRV-Cross compiled vertex HLSL source:\n\n%s", vertexHlslSrc.data());
-	ZG_NOISE("SPIRV-Cross compiled pixel HLSL source:\n\n%s", pixelHlslSrc.data());
-
-	// Deinitialize SPIRV-Cross
-	spvc_context_destroy(spvcContext);
-
-	// Create encoding blob from source
-	ComPtr<IDxcBlobEncoding> vertexEncodingBlob;
-	ZgResult vertexBlobReadRes =
-		dxcCreateHlslBlobFromSource(dxcLibrary, vertexHlslSrc.data(), vertexEncodingBlob);
-	if (vertexBlobReadRes != ZG_SUCCESS) return vertexBlobReadRes;
-
-	// Create encoding blob from source
-	ComPtr<IDxcBlobEncoding> pixelEncodingBlob;
-	ZgResult pixelBlobReadRes =
-		dxcCreateHlslBlobFromSource(dxcLibrary, pixelHlslSrc.data(), pixelEncodingBlob);
-	if (pixelBlobReadRes != ZG_SUCCESS) return pixelBlobReadRes;
-
-	// Fake some compiler flags
-	const char* dxcCompilerFlags[ZG_MAX_NUM_DXC_COMPILER_FLAGS] = {};
-	dxcCompilerFlags[0] = "-Zi";
-	dxcCompilerFlags[1] = "-O3";
 
-	// Modify entry points in create info to always be "main", because that seems to be what
-	// SPIRV-Cross generates
-	createInfo.common.vertexShaderEntry = "main";
-	createInfo.common.pixelShaderEntry = "main";
-
-	return createPipelineRenderInternal(
+	return createPipelineRenderSpirv(
 		pipelineOut,
 		signatureOut,
 		createInfo.common,
 		compileStartTime,
-		ZG_SHADER_MODEL_6_0,
-		dxcCompilerFlags,
-		vertexEncodingBlob,
-		pixelEncodingBlob,
+		vertexData.data(),
+		vertexData.size(),
+		pixelData.data(),
+		pixelData.size(),
 		createInfo.vertexShaderPath,
 		createInfo.pixelShaderPath,
+		createInfo.specializationConstants,
+		createInfo.numSpecializationConstants,
+		dxcLibrary,
+		dxcCompiler,
+		dxcIncludeHandler,
+		rootSignatureCache,
+		device);
+}
+
+ZgResult createPipelineRenderMemorySPIRV(
+	D3D12PipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo,
+	IDxcLibrary& dxcLibrary,
+	IDxcCompiler& dxcCompiler,
+	IDxcIncludeHandler* dxcIncludeHandler,
+	D3D12RootSignatureCache& rootSignatureCache,
+	ID3D12Device3& device) noexcept
+{
+	// Start measuring compile-time
+	time_point compileStartTime;
+	calculateDeltaMillis(compileStartTime);
+
+	return createPipelineRenderSpirv(
+		pipelineOut,
+		signatureOut,
+		createInfo.common,
+		compileStartTime,
+		reinterpret_cast<const uint8_t*>(createInfo.vertexShaderSpirv),
+		createInfo.vertexShaderSpirvSizeBytes,
+		reinterpret_cast<const uint8_t*>(createInfo.pixelShaderSpirv),
+		createInfo.pixelShaderSpirvSizeBytes,
+		"<From memory, no vertex name>",
+		"<From memory, no pixel name>",
+		createInfo.specializationConstants,
+		createInfo.numSpecializationConstants,
+		dxcLibrary,
 		dxcCompiler,
 		dxcIncludeHandler,
+		rootSignatureCache,
 		device);
 }
 
@@ -1469,6 +1993,7 @@ ZgResult createPipelineRenderFileHLSL(
 	IDxcLibrary& dxcLibrary,
 	IDxcCompiler& dxcCompiler,
 	IDxcIncludeHandler* dxcIncludeHandler,
+	D3D12RootSignatureCache& rootSignatureCache,
 	ID3D12Device3& device) noexcept
 {
 	// Start measuring compile-time
@@ -1494,19 +2019,41 @@ ZgResult createPipelineRenderFileHLSL(
 		if (pixelBlobReadRes != ZG_SUCCESS) return pixelBlobReadRes;
 	}
 
-	return createPipelineRenderInternal(
+	// Check pipeline cache, compile shaders on a miss
+	uint64_t cacheKey = pipelineCacheKey("HLSL",
+		vertexEncodingBlob->GetBufferPointer(), vertexEncodingBlob->GetBufferSize(),
+		pixelEncodingBlob->GetBufferPointer(), pixelEncodingBlob->GetBufferSize(),
+		createInfo.common, createInfo.shaderModel, createInfo.dxcCompilerFlags,
+		createInfo.defines, createInfo.numDefines, nullptr, 0);
+	CompiledPipelineRender compiled;
+	if (!loadFromPipelineCache(cacheKey, compiled)) {
+		ZgResult compileRes = compilePipelineRender(
+			compiled,
+			cacheKey,
+			createInfo.common,
+			createInfo.shaderModel,
+			createInfo.dxcCompilerFlags,
+			createInfo.defines,
+			createInfo.numDefines,
+			vertexEncodingBlob,
+			pixelEncodingBlob,
+			createInfo.vertexShaderPath,
+			createInfo.pixelShaderPath,
+			dxcCompiler,
+			dxcIncludeHandler,
+			nullptr);
+		if (compileRes != ZG_SUCCESS) return compileRes;
+	}
+
+	return createPipelineRenderFromCompiled(
 		pipelineOut,
 		signatureOut,
 		createInfo.common,
+		compiled,
 		compileStartTime,
-		createInfo.shaderModel,
-		createInfo.dxcCompilerFlags,
-		vertexEncodingBlob,
-		pixelEncodingBlob,
 		createInfo.vertexShaderPath,
 		createInfo.pixelShaderPath,
-		dxcCompiler,
-		dxcIncludeHandler,
+		rootSignatureCache,
 		device);
 }
 
@@ -1517,6 +2064,7 @@ ZgResult createPipelineRenderSourceHLSL(
 	IDxcLibrary& dxcLibrary,
 	IDxcCompiler& dxcCompiler,
 	IDxcIncludeHandler* dxcIncludeHandler,
+	D3D12RootSignatureCache& rootSignatureCache,
 	ID3D12Device3& device) noexcept
 {
 	// Start measuring compile-time
@@ -1535,19 +2083,188 @@ ZgResult createPipelineRenderSourceHLSL(
 		dxcCreateHlslBlobFromSource(dxcLibrary, createInfo.pixelShaderSrc, pixelEncodingBlob);
 	if (pixelBlobReadRes != ZG_SUCCESS) return pixelBlobReadRes;
 
-	return createPipelineRenderInternal(
+	const char* vertexShaderName = "<From source, no vertex name>";
+	const char* pixelShaderName = "<From source, no pixel name>";
+
+	// Check pipeline cache, compile shaders on a miss
+	uint64_t cacheKey = pipelineCacheKey("HLSL",
+		vertexEncodingBlob->GetBufferPointer(), vertexEncodingBlob->GetBufferSize(),
+		pixelEncodingBlob->GetBufferPointer(), pixelEncodingBlob->GetBufferSize(),
+		createInfo.common, createInfo.shaderModel, createInfo.dxcCompilerFlags,
+		createInfo.defines, createInfo.numDefines, nullptr, 0);
+	CompiledPipelineRender compiled;
+	if (!loadFromPipelineCache(cacheKey, compiled)) {
+		ZgResult compileRes = compilePipelineRender(
+			compiled,
+			cacheKey,
+			createInfo.common,
+			createInfo.shaderModel,
+			createInfo.dxcCompilerFlags,
+			createInfo.defines,
+			createInfo.numDefines,
+			vertexEncodingBlob,
+			pixelEncodingBlob,
+			vertexShaderName,
+			pixelShaderName,
+			dxcCompiler,
+			dxcIncludeHandler,
+			nullptr);
+		if (compileRes != ZG_SUCCESS) return compileRes;
+	}
+
+	return createPipelineRenderFromCompiled(
 		pipelineOut,
 		signatureOut,
 		createInfo.common,
+		compiled,
 		compileStartTime,
-		createInfo.shaderModel,
-		createInfo.dxcCompilerFlags,
-		vertexEncodingBlob,
-		pixelEncodingBlob,
-		"<From source, no vertex name>",
-		"<From source, no pixel name>",
-		dxcCompiler,
-		dxcIncludeHandler,
+		vertexShaderName,
+		pixelShaderName,
+		rootSignatureCache,
+		device);
+}
+
+ZgResult createPipelineRenderMemoryDXIL(
+	D3D12PipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoMemoryDXIL& createInfoIn,
+	IDxcLibrary& dxcLibrary,
+	D3D12RootSignatureCache& rootSignatureCache,
+	ID3D12Device3& device) noexcept
+{
+	// Start measuring creation time, there is nothing to compile
+	time_point compileStartTime;
+	calculateDeltaMillis(compileStartTime);
+
+	// The entry points are already compiled into the DXIL, they are only used for logging
+	ZgPipelineRenderCreateInfoCommon createInfo = createInfoIn.common;
+	if (createInfo.vertexShaderEntry == nullptr) createInfo.vertexShaderEntry = "<DXIL>";
+	if (createInfo.pixelShaderEntry == nullptr) createInfo.pixelShaderEntry = "<DXIL>";
+	const char* vertexShaderName = "<From memory, no vertex name>";
+	const char* pixelShaderName = "<From memory, no pixel name>";
+
+	// Wrap the DXIL in blobs so they can be reflected
+	ComPtr<IDxcBlob> vertexBlob;
+	ZgResult vertexBlobRes = dxcCreateDxilBlob(dxcLibrary,
+		createInfoIn.vertexShaderDxil, createInfoIn.vertexShaderDxilSizeBytes, vertexBlob);
+	if (vertexBlobRes != ZG_SUCCESS) return vertexBlobRes;
+	ComPtr<IDxcBlob> pixelBlob;
+	ZgResult pixelBlobRes = dxcCreateDxilBlob(dxcLibrary,
+		createInfoIn.pixelShaderDxil, createInfoIn.pixelShaderDxilSizeBytes, pixelBlob);
+	if (pixelBlobRes != ZG_SUCCESS) return pixelBlobRes;
+
+	// Reflect the DXIL, fails if the containers are invalid or the reflection has been stripped
+	ComPtr<ID3D12ShaderReflection> vertexReflection;
+	if (D3D12_FAIL(getShaderReflection(vertexBlob, vertexReflection))) {
+		ZG_ERROR("Could not reflect vertex shader DXIL, is it a complete DXIL container?");
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+	ComPtr<ID3D12ShaderReflection> pixelReflection;
+	if (D3D12_FAIL(getShaderReflection(pixelBlob, pixelReflection))) {
+		ZG_ERROR("Could not reflect pixel shader DXIL, is it a complete DXIL container?");
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	CompiledPipelineRender compiled;
+	ZgResult reflectRes = reflectDxilPipelineRender(
+		compiled.reflection, createInfo, *vertexReflection.Get(), *pixelReflection.Get());
+	if (reflectRes != ZG_SUCCESS) return reflectRes;
+
+	// Copy out bytecode
+	if (!copyBytecode(compiled.vertexBytecode,
+			createInfoIn.vertexShaderDxil, createInfoIn.vertexShaderDxilSizeBytes) ||
+		!copyBytecode(compiled.pixelBytecode,
+			createInfoIn.pixelShaderDxil, createInfoIn.pixelShaderDxilSizeBytes)) {
+		return ZG_ERROR_CPU_OUT_OF_MEMORY;
+	}
+
+	return createPipelineRenderFromCompiled(
+		pipelineOut,
+		signatureOut,
+		createInfo,
+		compiled,
+		compileStartTime,
+		vertexShaderName,
+		pixelShaderName,
+		rootSignatureCache,
+		device);
+}
+
+ZgResult createPipelineRenderArchive(
+	D3D12PipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoCommon& createInfoIn,
+	const ShaderArchivePipeline& pipeline,
+	IDxcLibrary& dxcLibrary,
+	IDxcCompiler& dxcCompiler,
+	IDxcIncludeHandler* dxcIncludeHandler,
+	D3D12RootSignatureCache& rootSignatureCache,
+	ID3D12Device3& device) noexcept
+{
+	// Start measuring compile-time
+	time_point compileStartTime;
+	calculateDeltaMillis(compileStartTime);
+
+	// Same compiler flags and entry points as when creating the pipeline from SPIR-V files
+	const char* dxcCompilerFlags[ZG_MAX_NUM_DXC_COMPILER_FLAGS] = {};
+	dxcCompilerFlags[0] = "-Zi";
+	dxcCompilerFlags[1] = "-O3";
+	ZgPipelineRenderCreateInfoCommon createInfo = createInfoIn;
+	createInfo.vertexShaderEntry = "main";
+	createInfo.pixelShaderEntry = "main";
+
+	// Check pipeline cache, the HLSL is what DXC compiles so it is what the key is built from
+	uint64_t cacheKey = pipelineCacheKey("HLSL",
+		pipeline.vertexHlsl, pipeline.vertexHlslSizeBytes,
+		pipeline.pixelHlsl, pipeline.pixelHlslSizeBytes,
+		createInfo, ZG_SHADER_MODEL_6_0, dxcCompilerFlags, nullptr, 0, nullptr, 0);
+	CompiledPipelineRender compiled;
+	if (!loadFromPipelineCache(cacheKey, compiled)) {
+
+		// The SPIR-V was reflected when the archive was compiled, only validate the create info
+		PipelineRenderReflection reflection;
+		ZgResult validateRes =
+			validateSpirvPipelineRender(reflection, *pipeline.reflection, createInfo);
+		if (validateRes != ZG_SUCCESS) return validateRes;
+
+		// The HLSL was cross-compiled when the archive was compiled, go directly to DXC
+		ComPtr<IDxcBlobEncoding> vertexEncodingBlob;
+		ZgResult vertexBlobReadRes =
+			dxcCreateHlslBlobFromSource(dxcLibrary, pipeline.vertexHlsl, vertexEncodingBlob);
+		if (vertexBlobReadRes != ZG_SUCCESS) return vertexBlobReadRes;
+
+		ComPtr<IDxcBlobEncoding> pixelEncodingBlob;
+		ZgResult pixelBlobReadRes =
+			dxcCreateHlslBlobFromSource(dxcLibrary, pipeline.pixelHlsl, pixelEncodingBlob);
+		if (pixelBlobReadRes != ZG_SUCCESS) return pixelBlobReadRes;
+
+		ZgResult compileRes = compilePipelineRender(
+			compiled,
+			cacheKey,
+			createInfo,
+			ZG_SHADER_MODEL_6_0,
+			dxcCompilerFlags,
+			nullptr,
+			0,
+			vertexEncodingBlob,
+			pixelEncodingBlob,
+			pipeline.name,
+			pipeline.name,
+			dxcCompiler,
+			dxcIncludeHandler,
+			&reflection);
+		if (compileRes != ZG_SUCCESS) return compileRes;
+	}
+
+	return createPipelineRenderFromCompiled(
+		pipelineOut,
+		signatureOut,
+		createInfo,
+		compiled,
+		compileStartTime,
+		pipeline.name,
+		pipeline.name,
+		rootSignatureCache,
 		device);
 }
 
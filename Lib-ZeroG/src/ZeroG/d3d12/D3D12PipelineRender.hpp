@@ -22,6 +22,8 @@
 
 #include "ZeroG.h"
 #include "ZeroG/d3d12/D3D12Common.hpp"
+#include "ZeroG/d3d12/D3D12RootSignatureCache.hpp"
+#include "ZeroG/util/RegisterLookup.hpp"
 #include "ZeroG/BackendInterface.hpp"
 
 namespace zg {
@@ -35,6 +37,12 @@ struct D3D12PushConstantMapping {
 	uint32_t sizeInBytes = ~0u;
 };
 
+struct D3D12RootConstantBufferMapping {
+	uint32_t shaderRegister = ~0u;
+	uint32_t parameterIndex = ~0u;
+	uint32_t sizeInBytes = ~0u;
+};
+
 struct D3D12ConstantBufferMapping {
 	uint32_t shaderRegister = ~0u;
 	uint32_t tableOffset = ~0u;
@@ -59,16 +67,30 @@ public:
 	D3D12PipelineRender& operator= (D3D12PipelineRender&&) = delete;
 	~D3D12PipelineRender() noexcept;
 
+	// Swaps the contents (but not the identities) of two pipelines
+	void swap(D3D12PipelineRender& other) noexcept;
+
 	ComPtr<ID3D12PipelineState> pipelineState;
 	ComPtr<ID3D12RootSignature> rootSignature;
 	ZgPipelineRenderSignature signature = {};
 	uint32_t numPushConstants = 0;
 	D3D12PushConstantMapping pushConstants[ZG_MAX_NUM_CONSTANT_BUFFERS] = {};
+	uint32_t numRootConstantBuffers = 0;
+	D3D12RootConstantBufferMapping rootConstBuffers[ZG_MAX_NUM_CONSTANT_BUFFERS] = {};
 	uint32_t numConstantBuffers = 0;
 	D3D12ConstantBufferMapping constBuffers[ZG_MAX_NUM_CONSTANT_BUFFERS] = {};
 	uint32_t numTextures = 0;
 	D3D12TextureMapping textures[ZG_MAX_NUM_TEXTURES] = {};
+	// Map shader registers to the index of their mapping in the corresponding array above
+	RegisterLookup<ZG_MAX_NUM_CONSTANT_BUFFERS> pushConstantLookup;
+	RegisterLookup<ZG_MAX_NUM_CONSTANT_BUFFERS> rootConstBufferLookup;
+	RegisterLookup<ZG_MAX_NUM_CONSTANT_BUFFERS> constBufferLookup;
+	RegisterLookup<ZG_MAX_NUM_TEXTURES> textureLookup;
 	uint32_t dynamicBuffersParameterIndex = ~0u;
+	uint32_t bindlessTexturesParameterIndex = ~0u; // ~0u if the pipeline has no bindless textures
+	uint32_t bindlessBuffersParameterIndex = ~0u; // ~0u if the pipeline has no bindless buffers
+	uint64_t tableLayoutHash = 0; // Hash of the constant buffer and texture mappings
+	uint64_t bytecodeHash = 0; // Hash of the vertex and pixel shader DXIL programs
 	ZgPipelineRenderCreateInfoCommon createInfo = {}; // The info used to create the pipeline 
 };
 
@@ -78,10 +100,21 @@ public:
 ZgResult createPipelineRenderFileSPIRV(
 	D3D12PipelineRender** pipelineOut,
 	ZgPipelineRenderSignature* signatureOut,
-	ZgPipelineRenderCreateInfoFileSPIRV createInfo,
+	const ZgPipelineRenderCreateInfoFileSPIRV& createInfo,
+	IDxcLibrary& dxcLibrary,
+	IDxcCompiler& dxcCompiler,
+	IDxcIncludeHandler* dxcIncludeHandler,
+	D3D12RootSignatureCache& rootSignatureCache,
+	ID3D12Device3& device) noexcept;
+
+ZgResult createPipelineRenderMemorySPIRV(
+	D3D12PipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo,
 	IDxcLibrary& dxcLibrary,
 	IDxcCompiler& dxcCompiler,
 	IDxcIncludeHandler* dxcIncludeHandler,
+	D3D12RootSignatureCache& rootSignatureCache,
 	ID3D12Device3& device) noexcept;
 
 ZgResult createPipelineRenderFileHLSL(
@@ -91,6 +124,7 @@ ZgResult createPipelineRenderFileHLSL(
 	IDxcLibrary& dxcLibrary,
 	IDxcCompiler& dxcCompiler,
 	IDxcIncludeHandler* dxcIncludeHandler,
+	D3D12RootSignatureCache& rootSignatureCache,
 	ID3D12Device3& device) noexcept;
 
 ZgResult createPipelineRenderSourceHLSL(
@@ -100,6 +134,26 @@ ZgResult createPipelineRenderSourceHLSL(
 	IDxcLibrary& dxcLibrary,
 	IDxcCompiler& dxcCompiler,
 	IDxcIncludeHandler* dxcIncludeHandler,
+	D3D12RootSignatureCache& rootSignatureCache,
+	ID3D12Device3& device) noexcept;
+
+ZgResult createPipelineRenderMemoryDXIL(
+	D3D12PipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoMemoryDXIL& createInfo,
+	IDxcLibrary& dxcLibrary,
+	D3D12RootSignatureCache& rootSignatureCache,
+	ID3D12Device3& device) noexcept;
+
+ZgResult createPipelineRenderArchive(
+	D3D12PipelineRender** pipelineOut,
+	ZgPipelineRenderSignature* signatureOut,
+	const ZgPipelineRenderCreateInfoCommon& createInfo,
+	const ShaderArchivePipeline& pipeline,
+	IDxcLibrary& dxcLibrary,
+	IDxcCompiler& dxcCompiler,
+	IDxcIncludeHandler* dxcIncludeHandler,
+	D3D12RootSignatureCache& rootSignatureCache,
 	ID3D12Device3& device) noexcept;
 
 } // namespace zg
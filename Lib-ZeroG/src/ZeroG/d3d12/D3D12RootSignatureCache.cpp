@@ -0,0 +1,80 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/d3d12/D3D12RootSignatureCache.hpp"
+
+#include <cstring>
+
+#include "ZeroG/util/Hash.hpp"
+
+namespace zg {
+
+// D3D12RootSignatureCache: State methods
+// ------------------------------------------------------------------------------------------------
+
+void D3D12RootSignatureCache::destroy() noexcept
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mEntries.destroy();
+}
+
+// D3D12RootSignatureCache: Methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult D3D12RootSignatureCache::getOrCreate(
+	ComPtr<ID3D12RootSignature>& rootSignatureOut,
+	ID3DBlob& serializedDesc,
+	ID3D12Device3& device) noexcept
+{
+	const void* descData = serializedDesc.GetBufferPointer();
+	size_t descSizeBytes = serializedDesc.GetBufferSize();
+	uint64_t hash = hashBytes(descData, descSizeBytes);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	// Check if there already is a root signature with the same layout
+	for (uint32_t i = 0; i < mEntries.size(); i++) {
+		const Entry& entry = mEntries[i];
+		if (entry.hash != hash) continue;
+		if (entry.serializedDesc->GetBufferSize() != descSizeBytes) continue;
+		if (std::memcmp(entry.serializedDesc->GetBufferPointer(), descData, descSizeBytes) != 0) {
+			continue;
+		}
+		rootSignatureOut = entry.rootSignature;
+		return ZG_SUCCESS;
+	}
+
+	// Create root signature. Done while holding the lock so that two threads creating pipelines
+	// with the same layout don't both create it, root signature creation is cheap.
+	Entry entry;
+	entry.hash = hash;
+	entry.serializedDesc = &serializedDesc;
+	if (D3D12_FAIL(device.CreateRootSignature(
+		0, descData, descSizeBytes, IID_PPV_ARGS(&entry.rootSignature)))) {
+		return ZG_ERROR_GENERIC;
+	}
+	rootSignatureOut = entry.rootSignature;
+
+	// Store it so later pipelines with the same layout can share it
+	if (mEntries.size() == 0) mEntries.create(16, "ZeroG - D3D12RootSignatureCache");
+	mEntries.add(std::move(entry));
+	ZG_NOISE("Created root signature, %u unique root signatures", mEntries.size());
+	return ZG_SUCCESS;
+}
+
+} // namespace zg
@@ -0,0 +1,81 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <mutex>
+
+#include "ZeroG.h"
+#include "ZeroG/d3d12/D3D12Common.hpp"
+#include "ZeroG/util/SmallVector.hpp"
+
+namespace zg {
+
+// D3D12RootSignatureCache
+// ------------------------------------------------------------------------------------------------
+
+// Root signatures shared between all pipelines with the same layout, i.e. the same push
+// constants, descriptor table ranges and static samplers.
+//
+// Keyed by a hash of the serialized root signature description, the serialized bytes are kept and
+// compared on a hash match, so two different layouts can never share a root signature. Entries are
+// never evicted, the number of distinct layouts in an application is small. Thread-safe.
+class D3D12RootSignatureCache final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	D3D12RootSignatureCache() noexcept = default;
+	D3D12RootSignatureCache(const D3D12RootSignatureCache&) = delete;
+	D3D12RootSignatureCache& operator= (const D3D12RootSignatureCache&) = delete;
+	D3D12RootSignatureCache(D3D12RootSignatureCache&&) = delete;
+	D3D12RootSignatureCache& operator= (D3D12RootSignatureCache&&) = delete;
+	~D3D12RootSignatureCache() noexcept { this->destroy(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	void destroy() noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	// Returns the root signature for the serialized description, creating it on a miss
+	ZgResult getOrCreate(
+		ComPtr<ID3D12RootSignature>& rootSignatureOut,
+		ID3DBlob& serializedDesc,
+		ID3D12Device3& device) noexcept;
+
+private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	struct Entry final {
+		uint64_t hash = 0;
+		ComPtr<ID3DBlob> serializedDesc;
+		ComPtr<ID3D12RootSignature> rootSignature;
+	};
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	std::mutex mMutex;
+	SmallVector<Entry, 0> mEntries;
+};
+
+} // namespace zg
@@ -26,7 +26,11 @@ namespace zg {
 
 D3D12Texture2D::~D3D12Texture2D() noexcept
 {
-
+	if (heapRangeTracker != nullptr) {
+		heapRangeTracker->removeRange(offsetInHeapBytes, sizeInHeapBytes);
+		heapRangeTracker->release();
+	}
+	if (bindlessIndex != ~0u) bindlessDescriptors->release(bindlessIndex);
 }
 
 // D3D12Texture2D: Methods
@@ -48,4 +52,32 @@ ZgResult D3D12Texture2D::setDebugName(const char* name) noexcept
 	return ZG_SUCCESS;
 }
 
+ZgResult D3D12Texture2D::getBindlessIndex(uint32_t& indexOut) const noexcept
+{
+	if (bindlessIndex == ~0u) {
+		ZG_ERROR("Texture has no bindless index, bindless is not enabled");
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+	indexOut = bindlessIndex;
+	return ZG_SUCCESS;
+}
+
+ZgResult D3D12Texture2D::getUploadSizeInBytes(uint64_t& sizeOut) const noexcept
+{
+	sizeOut = ((mipChainUploadSizeBytes() + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) /
+		D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT) * D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+	return ZG_SUCCESS;
+}
+
+uint64_t D3D12Texture2D::mipChainUploadSizeBytes() const noexcept
+{
+	// The footprints are calculated with the texture's heap offset as base offset
+	const uint64_t footprintsBaseOffset = subresourceFootprints[0].Offset;
+	const uint32_t lastMip = numMipmaps - 1;
+	const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& lastFootprint = subresourceFootprints[lastMip];
+	return (lastFootprint.Offset - footprintsBaseOffset) +
+		uint64_t(lastFootprint.Footprint.RowPitch) * (numRows[lastMip] - 1) +
+		rowSizesInBytes[lastMip];
+}
+
 } // namespace zg
@@ -21,8 +21,10 @@
 #include <atomic>
 
 #include "ZeroG.h"
+#include "ZeroG/d3d12/D3D12BindlessDescriptors.hpp"
 #include "ZeroG/d3d12/D3D12Common.hpp"
 #include "ZeroG/BackendInterface.hpp"
+#include "ZeroG/util/HeapRangeTracker.hpp"
 
 namespace zg {
 
@@ -51,6 +53,12 @@ public:
 
 	D3D12MemoryHeap* textureHeap = nullptr;
 	ComPtr<ID3D12Resource> resource;
+
+	// The range occupied by the texture in the heap, for heap statistics. The tracker is shared
+	// with (and may outlive) the heap.
+	HeapRangeTracker* heapRangeTracker = nullptr;
+	uint64_t offsetInHeapBytes = 0;
+	uint64_t sizeInHeapBytes = 0;
 	ZgTextureFormat zgFormat = ZG_TEXTURE_FORMAT_UNDEFINED;
 	ZgTextureUsage usage = ZG_TEXTURE_USAGE_DEFAULT;
 	ZgOptimalClearValue optimalClearValue = ZG_OPTIMAL_CLEAR_VALUE_UNDEFINED;
@@ -65,6 +73,10 @@ public:
 	uint64_t rowSizesInBytes[ZG_MAX_NUM_MIPMAPS] = {};
 	uint64_t totalSizeInBytes = 0;
 
+	// The view of the texture in the bindless descriptor table, ~0u if it has none
+	D3D12BindlessDescriptors* bindlessDescriptors = nullptr;
+	uint32_t bindlessIndex = ~0u;
+
 	// The current resource state of the texture. Committed because the state has been committed
 	// in a command list which has been executed on a queue. There may be pending state changes
 	// in command lists not yet executed.
@@ -75,6 +87,12 @@ public:
 	// --------------------------------------------------------------------------------------------
 
 	ZgResult setDebugName(const char* name) noexcept override final;
+	ZgResult getBindlessIndex(uint32_t& indexOut) const noexcept override final;
+	ZgResult getUploadSizeInBytes(uint64_t& sizeOut) const noexcept override final;
+
+	// The number of bytes of the full mip chain when laid out in an upload buffer according to
+	// the footprints, relative to the first footprint
+	uint64_t mipChainUploadSizeBytes() const noexcept;
 };
 
 } // namespace zg
@@ -148,6 +148,17 @@ public:
 		return ZG_WARNING_UNIMPLEMENTED;
 	}
 
+	ZgResult pipelineRenderCreateFromMemorySPIRV(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept override final
+	{
+		(void)pipelineOut;
+		(void)signatureOut;
+		(void)createInfo;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
 	ZgResult pipelineRenderCreateFromFileHLSL(
 		ZgPipelineRender** pipelineOut,
 		ZgPipelineRenderSignature* signatureOut,
@@ -170,6 +181,30 @@ public:
 		return ZG_WARNING_UNIMPLEMENTED;
 	}
 
+	ZgResult pipelineRenderCreateFromMemoryDXIL(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoMemoryDXIL& createInfo) noexcept override final
+	{
+		(void)pipelineOut;
+		(void)signatureOut;
+		(void)createInfo;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
+	ZgResult pipelineRenderCreateFromArchive(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoCommon& createInfo,
+		const ShaderArchivePipeline& pipeline) noexcept override final
+	{
+		(void)pipelineOut;
+		(void)signatureOut;
+		(void)createInfo;
+		(void)pipeline;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
 	ZgResult pipelineRenderRelease(
 		ZgPipelineRender* pipeline) noexcept override final
 	{
@@ -177,6 +212,15 @@ public:
 		return ZG_WARNING_UNIMPLEMENTED;
 	}
 
+	ZgResult pipelineRenderReplace(
+		ZgPipelineRender* pipeline,
+		ZgPipelineRender* replacement) noexcept override final
+	{
+		(void)pipeline;
+		(void)replacement;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
 	ZgResult pipelineRenderGetSignature(
 		const ZgPipelineRender* pipeline,
 		ZgPipelineRenderSignature* signatureOut) const noexcept override final
@@ -186,6 +230,15 @@ public:
 		return ZG_WARNING_UNIMPLEMENTED;
 	}
 
+	ZgResult pipelineRenderGetBytecodeHash(
+		const ZgPipelineRender* pipeline,
+		uint64_t& hashOut) const noexcept override final
+	{
+		(void)pipeline;
+		(void)hashOut;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
 	// Memory methods
 	// --------------------------------------------------------------------------------------------
 
@@ -205,6 +258,15 @@ public:
 		return ZG_WARNING_UNIMPLEMENTED;
 	}
 
+	ZgResult memoryHeapSetResidencyPriority(
+		ZgMemoryHeap* memoryHeap,
+		ZgResidencyPriority priority) noexcept override final
+	{
+		(void)memoryHeap;
+		(void)priority;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
 	ZgResult bufferMemcpyTo(
 		ZgBuffer* dstBufferInterface,
 		uint64_t bufferOffsetBytes,
@@ -218,6 +280,23 @@ public:
 		return ZG_WARNING_UNIMPLEMENTED;
 	}
 
+	ZgResult bufferReadFile(
+		ZgBuffer* dstBufferInterface,
+		uint64_t bufferOffsetBytes,
+		const char* path,
+		uint64_t fileOffsetBytes,
+		uint64_t numBytes,
+		ZgFileRead** fileReadOut) noexcept override final
+	{
+		(void)dstBufferInterface;
+		(void)bufferOffsetBytes;
+		(void)path;
+		(void)fileOffsetBytes;
+		(void)numBytes;
+		(void)fileReadOut;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
 	// Texture methods
 	// --------------------------------------------------------------------------------------------
 
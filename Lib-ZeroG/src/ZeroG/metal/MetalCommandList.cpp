@@ -53,6 +53,21 @@ ZgResult MetalCommandList::memcpyToTexture(
 	return ZG_WARNING_UNIMPLEMENTED;
 }
 
+ZgResult MetalCommandList::memcpyToTextureMipChain(
+	ZgTexture2D* dstTexture,
+	const ZgImageViewConstCpu* srcImagesCpu,
+	uint32_t numMipLevels,
+	ZgBuffer* tempUploadBuffer,
+	uint64_t tempUploadBufferOffsetBytes) noexcept
+{
+	(void)dstTexture;
+	(void)srcImagesCpu;
+	(void)numMipLevels;
+	(void)tempUploadBuffer;
+	(void)tempUploadBufferOffsetBytes;
+	return ZG_WARNING_UNIMPLEMENTED;
+}
+
 ZgResult MetalCommandList::enableQueueTransitionBuffer(ZgBuffer* buffer) noexcept
 {
 	(void)buffer;
@@ -65,6 +80,12 @@ ZgResult MetalCommandList::enableQueueTransitionTexture(ZgTexture2D* texture) no
 	return ZG_WARNING_UNIMPLEMENTED;
 }
 
+ZgResult MetalCommandList::activateTransientTexture(ZgTexture2D* texture) noexcept
+{
+	(void)texture;
+	return ZG_WARNING_UNIMPLEMENTED;
+}
+
 ZgResult MetalCommandList::setPushConstant(
 	uint32_t shaderRegister,
 	const void* data,
@@ -76,6 +97,17 @@ ZgResult MetalCommandList::setPushConstant(
 	return ZG_WARNING_UNIMPLEMENTED;
 }
 
+ZgResult MetalCommandList::setRootConstantBuffer(
+	uint32_t shaderRegister,
+	ZgBuffer* buffer,
+	uint64_t offsetInBytes) noexcept
+{
+	(void)shaderRegister;
+	(void)buffer;
+	(void)offsetInBytes;
+	return ZG_WARNING_UNIMPLEMENTED;
+}
+
 ZgResult MetalCommandList::setPipelineBindings(
 	const ZgPipelineBindings& bindings) noexcept
 {
@@ -83,6 +115,19 @@ ZgResult MetalCommandList::setPipelineBindings(
 	return ZG_WARNING_UNIMPLEMENTED;
 }
 
+ZgResult MetalCommandList::useBindlessResources(
+	ZgBuffer* const* buffers,
+	uint32_t numBuffers,
+	ZgTexture2D* const* textures,
+	uint32_t numTextures) noexcept
+{
+	(void)buffers;
+	(void)numBuffers;
+	(void)textures;
+	(void)numTextures;
+	return ZG_WARNING_UNIMPLEMENTED;
+}
+
 ZgResult MetalCommandList::setPipelineRender(
 	ZgPipelineRender* pipeline) noexcept
 {
@@ -58,18 +58,38 @@ public:
 		const ZgImageViewConstCpu& srcImageCpu,
 		ZgBuffer* tempUploadBuffer) noexcept override final;
 
+	ZgResult memcpyToTextureMipChain(
+		ZgTexture2D* dstTexture,
+		const ZgImageViewConstCpu* srcImagesCpu,
+		uint32_t numMipLevels,
+		ZgBuffer* tempUploadBuffer,
+		uint64_t tempUploadBufferOffsetBytes) noexcept override final;
+
 	ZgResult enableQueueTransitionBuffer(ZgBuffer* buffer) noexcept override final;
 
 	ZgResult enableQueueTransitionTexture(ZgTexture2D* texture) noexcept override final;
 
+	ZgResult activateTransientTexture(ZgTexture2D* texture) noexcept override final;
+
 	ZgResult setPushConstant(
 		uint32_t shaderRegister,
 		const void* data,
 		uint32_t dataSizeInBytes) noexcept override final;
 
+	ZgResult setRootConstantBuffer(
+		uint32_t shaderRegister,
+		ZgBuffer* buffer,
+		uint64_t offsetInBytes) noexcept override final;
+
 	ZgResult setPipelineBindings(
 		const ZgPipelineBindings& bindings) noexcept override final;
 
+	ZgResult useBindlessResources(
+		ZgBuffer* const* buffers,
+		uint32_t numBuffers,
+		ZgTexture2D* const* textures,
+		uint32_t numTextures) noexcept override final;
+
 	ZgResult setPipelineRender(
 		ZgPipelineRender* pipeline) noexcept override final;
 
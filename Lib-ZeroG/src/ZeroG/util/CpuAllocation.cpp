@@ -18,6 +18,13 @@
 
 #include "ZeroG/util/CpuAllocation.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <new>
+
 #ifdef _WIN32
 #include <malloc.h>
 #else
@@ -29,30 +36,237 @@ namespace zg {
 // Default allocator
 // ------------------------------------------------------------------------------------------------
 
-static void* defaultAllocate(void* userPtr, uint32_t size, const char* name)
+// Small allocations are served from per-thread free lists of fixed size classes. When a thread's
+// list runs empty it is refilled with a batch of blocks from a central free list (or freshly
+// carved from a slab) under a mutex, when it grows too long half of it is given back. Larger
+// allocations go straight to the system allocator. Every allocation is preceded by a 32-byte
+// header, this keeps the allocation 32-byte aligned and tells deallocate() where it came from.
+
+constexpr uint32_t DEFAULT_ALLOC_ALIGNMENT = 32;
+constexpr uint32_t DEFAULT_ALLOC_SLAB_SIZE = 64 * 1024;
+constexpr uint32_t DEFAULT_ALLOC_REFILL_NUM_BLOCKS = 32;
+constexpr uint32_t DEFAULT_ALLOC_MAX_NUM_CACHED_BLOCKS = 128;
+constexpr uint32_t DEFAULT_ALLOC_LARGE_SIZE_CLASS = ~0u;
+
+// Block sizes, including the header. Must all be multiples of the alignment.
+constexpr uint32_t DEFAULT_ALLOC_NUM_SIZE_CLASSES = 10;
+constexpr uint32_t DEFAULT_ALLOC_SIZE_CLASSES[DEFAULT_ALLOC_NUM_SIZE_CLASSES] = {
+	64, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048
+};
+
+struct alignas(DEFAULT_ALLOC_ALIGNMENT) BlockHeader final {
+	uint32_t sizeClassIdx;
+	BlockHeader* next; // Only valid while the block is in a free list
+};
+static_assert(sizeof(BlockHeader) == DEFAULT_ALLOC_ALIGNMENT, "BlockHeader must be 32 bytes");
+
+static void* systemAllocate(uint32_t size) noexcept
 {
-	(void)userPtr;
-	(void)name;
 #ifdef _WIN32
-	return reinterpret_cast<void*>(_aligned_malloc(size, 32));
+	return _aligned_malloc(size, DEFAULT_ALLOC_ALIGNMENT);
 #else
 	void* ptr = nullptr;
-	posix_memalign(&ptr, 32, size);
-	return reinterpret_cast<void*>(ptr);
+	if (posix_memalign(&ptr, DEFAULT_ALLOC_ALIGNMENT, size) != 0) return nullptr;
+	return ptr;
 #endif
 }
 
-static void defaultDeallocate(void* userPtr, void* allocation)
+static void systemDeallocate(void* ptr) noexcept
 {
-	(void)userPtr;
-	if (allocation == nullptr) return;
 #ifdef _WIN32
-	_aligned_free(allocation);
+	_aligned_free(ptr);
 #else
-	free(allocation);
+	free(ptr);
 #endif
 }
 
+static uint32_t sizeClassIdxFromSize(uint32_t blockSize) noexcept
+{
+	for (uint32_t i = 0; i < DEFAULT_ALLOC_NUM_SIZE_CLASSES; i++) {
+		if (blockSize <= DEFAULT_ALLOC_SIZE_CLASSES[i]) return i;
+	}
+	return DEFAULT_ALLOC_LARGE_SIZE_CLASS;
+}
+
+struct CentralSizeClass final {
+	BlockHeader* freeList = nullptr;
+	uint8_t* slabCursor = nullptr;
+	uint8_t* slabEnd = nullptr;
+};
+
+struct CentralAllocator final {
+	std::mutex mutex;
+	CentralSizeClass sizeClasses[DEFAULT_ALLOC_NUM_SIZE_CLASSES];
+
+	// All slabs ever allocated, linked through their first bytes. Slabs are never returned to the
+	// system, the cached blocks are reused instead.
+	void* slabs = nullptr;
+};
+
+// Constructed on first use and intentionally never destroyed, memory may be deallocated from
+// other static destructors or exiting threads.
+static CentralAllocator& centralAllocator() noexcept
+{
+	alignas(CentralAllocator) static uint8_t storage[sizeof(CentralAllocator)];
+	static CentralAllocator* central = new (storage) CentralAllocator();
+	return *central;
+}
+
+// Fetches up to numBlocks blocks of a given size class, returns number of blocks retrieved
+static uint32_t centralAllocateBlocks(
+	uint32_t sizeClassIdx, uint32_t numBlocks, BlockHeader*& listOut) noexcept
+{
+	CentralAllocator& central = centralAllocator();
+	std::lock_guard<std::mutex> lock(central.mutex);
+	CentralSizeClass& sizeClass = central.sizeClasses[sizeClassIdx];
+	const uint32_t blockSize = DEFAULT_ALLOC_SIZE_CLASSES[sizeClassIdx];
+
+	listOut = nullptr;
+	uint32_t numRetrieved = 0;
+	while (numRetrieved < numBlocks) {
+
+		// Reuse previously freed blocks first
+		if (sizeClass.freeList != nullptr) {
+			BlockHeader* block = sizeClass.freeList;
+			sizeClass.freeList = block->next;
+			block->next = listOut;
+			listOut = block;
+			numRetrieved += 1;
+			continue;
+		}
+
+		// Allocate new slab if current one is exhausted
+		if ((sizeClass.slabCursor + blockSize) > sizeClass.slabEnd) {
+			uint8_t* slab = reinterpret_cast<uint8_t*>(systemAllocate(DEFAULT_ALLOC_SLAB_SIZE));
+			if (slab == nullptr) break;
+			*reinterpret_cast<void**>(slab) = central.slabs;
+			central.slabs = slab;
+			sizeClass.slabCursor = slab + DEFAULT_ALLOC_ALIGNMENT;
+			sizeClass.slabEnd = slab + DEFAULT_ALLOC_SLAB_SIZE;
+		}
+
+		BlockHeader* block = reinterpret_cast<BlockHeader*>(sizeClass.slabCursor);
+		sizeClass.slabCursor += blockSize;
+		block->sizeClassIdx = sizeClassIdx;
+		block->next = listOut;
+		listOut = block;
+		numRetrieved += 1;
+	}
+
+	return numRetrieved;
+}
+
+// Returns a list of blocks (linked through next, first to last) of a given size class
+static void centralDeallocateBlocks(
+	uint32_t sizeClassIdx, BlockHeader* first, BlockHeader* last) noexcept
+{
+	CentralAllocator& central = centralAllocator();
+	std::lock_guard<std::mutex> lock(central.mutex);
+	CentralSizeClass& sizeClass = central.sizeClasses[sizeClassIdx];
+	last->next = sizeClass.freeList;
+	sizeClass.freeList = first;
+}
+
+struct ThreadCacheSizeClass final {
+	BlockHeader* freeList = nullptr;
+	uint32_t numBlocks = 0;
+};
+
+struct ThreadCache final {
+	ThreadCacheSizeClass sizeClasses[DEFAULT_ALLOC_NUM_SIZE_CLASSES];
+	~ThreadCache() noexcept;
+};
+
+static thread_local ThreadCache threadCache;
+
+// Set when the thread cache has been destroyed (i.e. thread is exiting), blocks are then returned
+// directly to the central allocator. Trivially destructible so it is safe to read at any time.
+static thread_local bool threadCacheDestroyed = false;
+
+ThreadCache::~ThreadCache() noexcept
+{
+	for (uint32_t i = 0; i < DEFAULT_ALLOC_NUM_SIZE_CLASSES; i++) {
+		ThreadCacheSizeClass& sizeClass = sizeClasses[i];
+		if (sizeClass.freeList == nullptr) continue;
+		BlockHeader* last = sizeClass.freeList;
+		while (last->next != nullptr) last = last->next;
+		centralDeallocateBlocks(i, sizeClass.freeList, last);
+		sizeClass = {};
+	}
+	threadCacheDestroyed = true;
+}
+
+static void* defaultAllocate(void* userPtr, uint32_t size, const char* name)
+{
+	(void)userPtr;
+	(void)name;
+
+	const uint64_t blockSize = uint64_t(size) + sizeof(BlockHeader);
+	if (blockSize > UINT32_MAX) return nullptr;
+	const uint32_t sizeClassIdx = sizeClassIdxFromSize(uint32_t(blockSize));
+
+	BlockHeader* block = nullptr;
+	if (sizeClassIdx == DEFAULT_ALLOC_LARGE_SIZE_CLASS) {
+		block = reinterpret_cast<BlockHeader*>(systemAllocate(uint32_t(blockSize)));
+		if (block == nullptr) return nullptr;
+		block->sizeClassIdx = DEFAULT_ALLOC_LARGE_SIZE_CLASS;
+	}
+	else if (threadCacheDestroyed) {
+		if (centralAllocateBlocks(sizeClassIdx, 1, block) == 0) return nullptr;
+	}
+	else {
+		ThreadCacheSizeClass& sizeClass = threadCache.sizeClasses[sizeClassIdx];
+		if (sizeClass.freeList == nullptr) {
+			sizeClass.numBlocks = centralAllocateBlocks(
+				sizeClassIdx, DEFAULT_ALLOC_REFILL_NUM_BLOCKS, sizeClass.freeList);
+			if (sizeClass.freeList == nullptr) return nullptr;
+		}
+		block = sizeClass.freeList;
+		sizeClass.freeList = block->next;
+		sizeClass.numBlocks -= 1;
+	}
+
+	return reinterpret_cast<uint8_t*>(block) + sizeof(BlockHeader);
+}
+
+static void defaultDeallocate(void* userPtr, void* allocation)
+{
+	(void)userPtr;
+	if (allocation == nullptr) return;
+
+	BlockHeader* block =
+		reinterpret_cast<BlockHeader*>(reinterpret_cast<uint8_t*>(allocation) - sizeof(BlockHeader));
+	const uint32_t sizeClassIdx = block->sizeClassIdx;
+
+	if (sizeClassIdx == DEFAULT_ALLOC_LARGE_SIZE_CLASS) {
+		systemDeallocate(block);
+		return;
+	}
+
+	if (threadCacheDestroyed) {
+		centralDeallocateBlocks(sizeClassIdx, block, block);
+		return;
+	}
+
+	// Blocks are returned to the cache of the deallocating thread, not necessarily the thread that
+	// allocated them.
+	ThreadCacheSizeClass& sizeClass = threadCache.sizeClasses[sizeClassIdx];
+	block->next = sizeClass.freeList;
+	sizeClass.freeList = block;
+	sizeClass.numBlocks += 1;
+
+	// Give back half the cached blocks if the cache grows too large
+	if (sizeClass.numBlocks > DEFAULT_ALLOC_MAX_NUM_CACHED_BLOCKS) {
+		const uint32_t numToKeep = DEFAULT_ALLOC_MAX_NUM_CACHED_BLOCKS / 2;
+		BlockHeader* first = sizeClass.freeList;
+		BlockHeader* last = first;
+		for (uint32_t i = 1; i < (sizeClass.numBlocks - numToKeep); i++) last = last->next;
+		sizeClass.freeList = last->next;
+		sizeClass.numBlocks = numToKeep;
+		centralDeallocateBlocks(sizeClassIdx, first, last);
+	}
+}
+
 ZgAllocator getDefaultAllocator() noexcept
 {
 	ZgAllocator allocator = {};
@@ -61,4 +275,218 @@ ZgAllocator getDefaultAllocator() noexcept
 	return allocator;
 }
 
+// Allocation tracking
+// ------------------------------------------------------------------------------------------------
+
+// Allocation names are resolved to a tag index the first time a name pointer is seen, under a
+// mutex. After that the index is found in a lock-free open addressing table keyed by the pointer,
+// and the stats of the tag are updated with atomics. All names used inside ZeroG are string
+// literals, so the pointer identifies the name.
+
+constexpr uint32_t TRACKING_NAME_TABLE_SIZE = 1024; // Must be power of two
+constexpr uint32_t TRACKING_OTHER_TAG_IDX = ZG_MAX_NUM_CPU_ALLOCATION_TAGS - 1;
+static_assert((TRACKING_NAME_TABLE_SIZE & (TRACKING_NAME_TABLE_SIZE - 1)) == 0, "");
+
+// Placed in front of each allocation, 32 bytes so the allocation itself stays 32-byte aligned
+struct alignas(32) AllocationHeader final {
+	uint32_t tagIdx;
+	uint32_t generation;
+	uint32_t sizeBytes;
+};
+static_assert(sizeof(AllocationHeader) == 32, "AllocationHeader must be 32 bytes");
+
+struct alignas(64) AllocationTag final {
+	char name[sizeof(ZgCpuAllocationTagStats::name)] = {};
+	std::atomic_uint64_t numLiveAllocations = 0;
+	std::atomic_uint64_t liveBytes = 0;
+	std::atomic_uint64_t peakLiveBytes = 0;
+	std::atomic_uint64_t totalNumAllocations = 0;
+};
+
+struct NameTableEntry final {
+	std::atomic<const char*> namePtr = nullptr; // Published last, after tagIdx is written
+	uint32_t tagIdx = 0;
+};
+
+struct AllocationTracker final {
+	ZgAllocator allocator = {};
+	std::atomic_uint32_t generation = 0;
+
+	// Only taken when a name pointer is seen for the first time
+	std::mutex mutex;
+	std::atomic_uint32_t numTags = 0;
+	std::atomic_bool hasOtherTag = false;
+	AllocationTag tags[ZG_MAX_NUM_CPU_ALLOCATION_TAGS];
+	NameTableEntry nameTable[TRACKING_NAME_TABLE_SIZE];
+};
+
+static AllocationTracker tracker;
+
+static uint32_t nameTableSlot(const char* name) noexcept
+{
+	uint64_t hash = uint64_t(reinterpret_cast<uintptr_t>(name)) * 0x9E3779B97F4A7C15ull;
+	return uint32_t(hash >> 32) & (TRACKING_NAME_TABLE_SIZE - 1);
+}
+
+static uint32_t findOrCreateTagSlow(const char* name) noexcept
+{
+	std::lock_guard<std::mutex> lock(tracker.mutex);
+
+	// Find tag by string, the same name can come from multiple pointers (e.g. different DLLs)
+	uint32_t tagIdx = ~0u;
+	const uint32_t numTags = tracker.numTags.load(std::memory_order_relaxed);
+	for (uint32_t i = 0; i < numTags; i++) {
+		if (strncmp(tracker.tags[i].name, name, sizeof(tracker.tags[i].name) - 1) == 0) {
+			tagIdx = i;
+			break;
+		}
+	}
+
+	// Create new tag if not found, the last tag is reserved for allocations that don't fit
+	if (tagIdx == ~0u) {
+		if (numTags == TRACKING_OTHER_TAG_IDX) {
+			tagIdx = TRACKING_OTHER_TAG_IDX;
+			if (!tracker.hasOtherTag.load(std::memory_order_relaxed)) {
+				snprintf(tracker.tags[tagIdx].name, sizeof(tracker.tags[tagIdx].name), "Other");
+				tracker.hasOtherTag.store(true, std::memory_order_release);
+			}
+		}
+		else {
+			tagIdx = numTags;
+			snprintf(tracker.tags[tagIdx].name, sizeof(tracker.tags[tagIdx].name), "%s", name);
+			tracker.numTags.store(numTags + 1, std::memory_order_release);
+		}
+	}
+
+	// Insert pointer into name table. If it is full the slow path is taken for this name.
+	uint32_t slot = nameTableSlot(name);
+	for (uint32_t i = 0; i < TRACKING_NAME_TABLE_SIZE; i++) {
+		NameTableEntry& entry = tracker.nameTable[(slot + i) & (TRACKING_NAME_TABLE_SIZE - 1)];
+		const char* entryName = entry.namePtr.load(std::memory_order_relaxed);
+		if (entryName == name) break;
+		if (entryName != nullptr) continue;
+		entry.tagIdx = tagIdx;
+		entry.namePtr.store(name, std::memory_order_release);
+		break;
+	}
+
+	return tagIdx;
+}
+
+static uint32_t findOrCreateTag(const char* name) noexcept
+{
+	uint32_t slot = nameTableSlot(name);
+	for (uint32_t i = 0; i < TRACKING_NAME_TABLE_SIZE; i++) {
+		const NameTableEntry& entry =
+			tracker.nameTable[(slot + i) & (TRACKING_NAME_TABLE_SIZE - 1)];
+		const char* entryName = entry.namePtr.load(std::memory_order_acquire);
+		if (entryName == name) return entry.tagIdx;
+		if (entryName == nullptr) break;
+	}
+	return findOrCreateTagSlow(name);
+}
+
+static void* trackingAllocate(void* userPtr, uint32_t size, const char* name)
+{
+	(void)userPtr;
+	if (name == nullptr) name = "Unnamed";
+	uint8_t* ptr = reinterpret_cast<uint8_t*>(tracker.allocator.allocate(
+		tracker.allocator.userPtr, size + uint32_t(sizeof(AllocationHeader)), name));
+	if (ptr == nullptr) return nullptr;
+
+	AllocationHeader* header = reinterpret_cast<AllocationHeader*>(ptr);
+	header->tagIdx = findOrCreateTag(name);
+	header->generation = tracker.generation.load(std::memory_order_relaxed);
+	header->sizeBytes = size;
+
+	AllocationTag& tag = tracker.tags[header->tagIdx];
+	tag.numLiveAllocations.fetch_add(1, std::memory_order_relaxed);
+	tag.totalNumAllocations.fetch_add(1, std::memory_order_relaxed);
+	uint64_t liveBytes = tag.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+	uint64_t peakLiveBytes = tag.peakLiveBytes.load(std::memory_order_relaxed);
+	while (peakLiveBytes < liveBytes) {
+		bool swapped = tag.peakLiveBytes.compare_exchange_weak(
+			peakLiveBytes, liveBytes, std::memory_order_relaxed);
+		if (swapped) break;
+	}
+
+	return ptr + sizeof(AllocationHeader);
+}
+
+static void trackingDeallocate(void* userPtr, void* allocation)
+{
+	(void)userPtr;
+	if (allocation == nullptr) return;
+
+	uint8_t* ptr = reinterpret_cast<uint8_t*>(allocation) - sizeof(AllocationHeader);
+	const AllocationHeader* header = reinterpret_cast<const AllocationHeader*>(ptr);
+
+	// Allocations made before the stats were last reset are not counted
+	if (header->generation == tracker.generation.load(std::memory_order_relaxed)) {
+		AllocationTag& tag = tracker.tags[header->tagIdx];
+		tag.numLiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+		tag.liveBytes.fetch_sub(header->sizeBytes, std::memory_order_relaxed);
+	}
+
+	tracker.allocator.deallocate(tracker.allocator.userPtr, ptr);
+}
+
+ZgAllocator createTrackingAllocator(const ZgAllocator& allocator) noexcept
+{
+	{
+		std::lock_guard<std::mutex> lock(tracker.mutex);
+		tracker.allocator = allocator;
+		tracker.generation.fetch_add(1, std::memory_order_relaxed);
+		tracker.numTags.store(0, std::memory_order_relaxed);
+		tracker.hasOtherTag.store(false, std::memory_order_relaxed);
+		for (AllocationTag& tag : tracker.tags) {
+			std::memset(tag.name, 0, sizeof(tag.name));
+			tag.numLiveAllocations.store(0, std::memory_order_relaxed);
+			tag.liveBytes.store(0, std::memory_order_relaxed);
+			tag.peakLiveBytes.store(0, std::memory_order_relaxed);
+			tag.totalNumAllocations.store(0, std::memory_order_relaxed);
+		}
+		for (NameTableEntry& entry : tracker.nameTable) {
+			entry.namePtr.store(nullptr, std::memory_order_relaxed);
+			entry.tagIdx = 0;
+		}
+	}
+
+	ZgAllocator trackingAllocator = {};
+	trackingAllocator.allocate = trackingAllocate;
+	trackingAllocator.deallocate = trackingDeallocate;
+	return trackingAllocator;
+}
+
+bool isTrackingAllocator(const ZgAllocator& allocator) noexcept
+{
+	return allocator.allocate == trackingAllocate;
+}
+
+void getCpuAllocationStats(
+	ZgCpuAllocationTagStats* statsOut, uint32_t maxNumStats, uint32_t& numStatsOut) noexcept
+{
+	// The "Other" tag is stored last, separately from the others
+	const uint32_t numTags = tracker.numTags.load(std::memory_order_acquire);
+	const bool hasOther = tracker.hasOtherTag.load(std::memory_order_acquire);
+	numStatsOut = numTags + (hasOther ? 1 : 0);
+	if (statsOut == nullptr) return;
+
+	uint32_t numWritten = 0;
+	auto writeStats = [&](const AllocationTag& tag) {
+		ZgCpuAllocationTagStats& stats = statsOut[numWritten++];
+		std::memcpy(stats.name, tag.name, sizeof(stats.name));
+		stats.numLiveAllocations = tag.numLiveAllocations.load(std::memory_order_relaxed);
+		stats.liveBytes = tag.liveBytes.load(std::memory_order_relaxed);
+		stats.peakLiveBytes = tag.peakLiveBytes.load(std::memory_order_relaxed);
+		stats.totalNumAllocations = tag.totalNumAllocations.load(std::memory_order_relaxed);
+	};
+	for (uint32_t i = 0; i < numTags && numWritten < maxNumStats; i++) {
+		writeStats(tracker.tags[i]);
+	}
+	if (hasOther && numWritten < maxNumStats) {
+		writeStats(tracker.tags[TRACKING_OTHER_TAG_IDX]);
+	}
+}
+
 } // namespace zg
@@ -34,6 +34,7 @@ T* zgNew(const char* name, Args&&... args) noexcept
 {
 	ZgAllocator allocator = getAllocator();
 	void* memPtr = allocator.allocate(allocator.userPtr, sizeof(T), name);
+	if (memPtr == nullptr) return nullptr;
 	T* objPtr = nullptr;
 	objPtr = new(memPtr) T(std::forward<Args>(args)...);
 	// If constructor throws exception std::terminate() will be called since function is noexcept
@@ -53,6 +54,22 @@ void zgDelete(T* pointer) noexcept
 // Default allocator
 // ------------------------------------------------------------------------------------------------
 
+// Thread-safe, all allocations are 32-byte aligned. Small allocations are served from thread-local
+// caches, see CpuAllocation.cpp.
 ZgAllocator getDefaultAllocator() noexcept;
 
+// Allocation tracking
+// ------------------------------------------------------------------------------------------------
+
+// Wraps an allocator so that all allocations made through it are aggregated by name, see
+// zgContextGetCpuAllocationStats(). Adds a small header to each allocation. Resets the stats, only
+// one tracking allocator can be in use at a time. Names are identified by pointer, so they must
+// be string literals (or otherwise never change).
+ZgAllocator createTrackingAllocator(const ZgAllocator& allocator) noexcept;
+
+bool isTrackingAllocator(const ZgAllocator& allocator) noexcept;
+
+void getCpuAllocationStats(
+	ZgCpuAllocationTagStats* statsOut, uint32_t maxNumStats, uint32_t& numStatsOut) noexcept;
+
 } // namespace zg
@@ -0,0 +1,385 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/util/FileIO.hpp"
+
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ZeroG/util/CpuAllocation.hpp"
+#include "ZeroG/util/Logging.hpp"
+
+namespace zg {
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _WIN32
+// Memory maps the specified file range and copies it to the destination memory.
+static ZgResult mmapCopyFileRange(
+	int fd, uint64_t fileOffsetBytes, uint64_t numBytes, void* dstMemory) noexcept
+{
+	// mmap() offset must be page aligned
+	uint64_t pageSize = uint64_t(sysconf(_SC_PAGESIZE));
+	uint64_t alignedOffset = (fileOffsetBytes / pageSize) * pageSize;
+	uint64_t offsetDiff = fileOffsetBytes - alignedOffset;
+	size_t mappedSize = size_t(numBytes + offsetDiff);
+
+	void* mapped = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, off_t(alignedOffset));
+	if (mapped == MAP_FAILED) return ZG_ERROR_GENERIC;
+	madvise(mapped, mappedSize, MADV_SEQUENTIAL);
+	std::memcpy(dstMemory, reinterpret_cast<const uint8_t*>(mapped) + offsetDiff, numBytes);
+	munmap(mapped, mappedSize);
+	return ZG_SUCCESS;
+}
+#endif
+
+// File size
+// ------------------------------------------------------------------------------------------------
+
+uint64_t fileSize(const char* path) noexcept
+{
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attributes = {};
+	if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes)) return 0;
+	return (uint64_t(attributes.nFileSizeHigh) << uint64_t(32)) | uint64_t(attributes.nFileSizeLow);
+#else
+	struct stat fileStat = {};
+	if (stat(path, &fileStat) != 0) return 0;
+	return uint64_t(fileStat.st_size);
+#endif
+}
+
+// Synchronous file reading
+// ------------------------------------------------------------------------------------------------
+
+ZgResult readFileRange(
+	const char* path, uint64_t fileOffsetBytes, uint64_t numBytes, void* dstMemory) noexcept
+{
+	AsyncFileRead read;
+	ZgResult res = read.start(path, fileOffsetBytes, numBytes, dstMemory);
+	if (res != ZG_SUCCESS) return res;
+	return read.waitBlocking();
+}
+
+Vector<uint8_t> readBinaryFile(const char* path) noexcept
+{
+	// Get size of file
+	uint64_t size = fileSize(path);
+	if (size == 0 || size > uint64_t(UINT32_MAX)) return Vector<uint8_t>();
+
+	// Allocate memory for file
+	Vector<uint8_t> data;
+	if (!data.create(uint32_t(size), "binary file")) return Vector<uint8_t>();
+	data.addMany(uint32_t(size));
+
+	// Read file directly into vector
+	if (readFileRange(path, 0, size, data.data()) != ZG_SUCCESS) return Vector<uint8_t>();
+	return data;
+}
+
+// AsyncFileRead: State methods
+// ------------------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+struct AsyncFileRead::PlatformState final {
+	HANDLE file = INVALID_HANDLE_VALUE;
+	OVERLAPPED overlapped = {};
+	DWORD numBytes = 0;
+};
+
+ZgResult AsyncFileRead::start(
+	const char* path, uint64_t fileOffsetBytes, uint64_t numBytes, void* dstMemory) noexcept
+{
+	this->destroy();
+
+	// A single overlapped read is limited to 32-bit sizes
+	if (numBytes > uint64_t(UINT32_MAX)) return ZG_ERROR_INVALID_ARGUMENT;
+
+	// Open file for overlapped reading
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		ZG_ERROR("Could not open file \"%s\"", path);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	mState = zgNew<PlatformState>("ZeroG - AsyncFileRead");
+	mState->file = file;
+	mState->numBytes = DWORD(numBytes);
+	mState->overlapped.Offset = DWORD(fileOffsetBytes & 0xFFFFFFFFull);
+	mState->overlapped.OffsetHigh = DWORD(fileOffsetBytes >> 32ull);
+	mState->overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	mDone = false;
+	mResult = ZG_SUCCESS;
+
+	// Start read
+	BOOL readRes = ReadFile(file, dstMemory, DWORD(numBytes), nullptr, &mState->overlapped);
+	if (!readRes && GetLastError() != ERROR_IO_PENDING) {
+		ZG_ERROR("Failed to start read of file \"%s\"", path);
+		mDone = true; // Nothing to wait for in destroy()
+		this->destroy();
+		return ZG_ERROR_GENERIC;
+	}
+
+	return ZG_SUCCESS;
+}
+
+void AsyncFileRead::destroy() noexcept
+{
+	if (mState != nullptr) {
+
+		// Cancel read and wait until OS no longer uses destination memory
+		if (!mDone) {
+			CancelIoEx(mState->file, &mState->overlapped);
+			DWORD bytesRead = 0;
+			GetOverlappedResult(mState->file, &mState->overlapped, &bytesRead, TRUE);
+		}
+
+		CloseHandle(mState->overlapped.hEvent);
+		CloseHandle(mState->file);
+		zgDelete(mState);
+	}
+	mState = nullptr;
+	mDone = false;
+	mResult = ZG_SUCCESS;
+}
+
+// AsyncFileRead: Methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult AsyncFileRead::checkIfDone(bool& doneOut) noexcept
+{
+	if (mState == nullptr) return ZG_ERROR_INVALID_ARGUMENT;
+	if (!mDone) {
+		DWORD bytesRead = 0;
+		if (GetOverlappedResult(mState->file, &mState->overlapped, &bytesRead, FALSE)) {
+			mDone = true;
+			mResult = bytesRead == mState->numBytes ? ZG_SUCCESS : ZG_ERROR_GENERIC;
+		}
+		else if (GetLastError() != ERROR_IO_INCOMPLETE) {
+			mDone = true;
+			mResult = ZG_ERROR_GENERIC;
+		}
+	}
+	doneOut = mDone;
+	return mDone ? mResult : ZG_SUCCESS;
+}
+
+ZgResult AsyncFileRead::waitBlocking() noexcept
+{
+	if (mState == nullptr) return ZG_ERROR_INVALID_ARGUMENT;
+	if (!mDone) {
+		DWORD bytesRead = 0;
+		BOOL res = GetOverlappedResult(mState->file, &mState->overlapped, &bytesRead, TRUE);
+		mDone = true;
+		mResult = (res && bytesRead == mState->numBytes) ? ZG_SUCCESS : ZG_ERROR_GENERIC;
+	}
+	return mResult;
+}
+
+#else
+
+struct AsyncFileRead::PlatformState final {
+	int fd = -1;
+};
+
+ZgResult AsyncFileRead::start(
+	const char* path, uint64_t fileOffsetBytes, uint64_t numBytes, void* dstMemory) noexcept
+{
+	this->destroy();
+
+	// Open file
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		ZG_ERROR("Could not open file \"%s\"", path);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Check that range is inside file
+	struct stat fileStat = {};
+	if (fstat(fd, &fileStat) != 0 || (fileOffsetBytes + numBytes) > uint64_t(fileStat.st_size)) {
+		close(fd);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// No native asynchronous path, memory map file and copy range immediately
+	mState = zgNew<PlatformState>("ZeroG - AsyncFileRead");
+	mState->fd = fd;
+	mResult = mmapCopyFileRange(fd, fileOffsetBytes, numBytes, dstMemory);
+	mDone = true;
+
+	return mResult;
+}
+
+void AsyncFileRead::destroy() noexcept
+{
+	if (mState != nullptr) {
+		close(mState->fd);
+		zgDelete(mState);
+	}
+	mState = nullptr;
+	mDone = false;
+	mResult = ZG_SUCCESS;
+}
+
+// AsyncFileRead: Methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult AsyncFileRead::checkIfDone(bool& doneOut) noexcept
+{
+	if (mState == nullptr) return ZG_ERROR_INVALID_ARGUMENT;
+	doneOut = mDone;
+	return mResult;
+}
+
+ZgResult AsyncFileRead::waitBlocking() noexcept
+{
+	if (mState == nullptr) return ZG_ERROR_INVALID_ARGUMENT;
+	return mResult;
+}
+
+#endif
+
+// MappedFile: State methods
+// ------------------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+struct MappedFile::PlatformState final {
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+};
+
+ZgResult MappedFile::map(const char* path) noexcept
+{
+	this->destroy();
+
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		ZG_ERROR("Could not open file \"%s\"", path);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Empty files can not be mapped
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		ZG_ERROR("Could not map empty or unreadable file \"%s\"", path);
+		CloseHandle(file);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* data = nullptr;
+	if (mapping != nullptr) data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr) {
+		ZG_ERROR("Could not memory map file \"%s\"", path);
+		if (mapping != nullptr) CloseHandle(mapping);
+		CloseHandle(file);
+		return ZG_ERROR_GENERIC;
+	}
+
+	mState = zgNew<PlatformState>("ZeroG - MappedFile");
+	mState->file = file;
+	mState->mapping = mapping;
+	mData = reinterpret_cast<const uint8_t*>(data);
+	mSize = uint64_t(size.QuadPart);
+	return ZG_SUCCESS;
+}
+
+void MappedFile::destroy() noexcept
+{
+	if (mState != nullptr) {
+		UnmapViewOfFile(mData);
+		CloseHandle(mState->mapping);
+		CloseHandle(mState->file);
+		zgDelete(mState);
+	}
+	mState = nullptr;
+	mData = nullptr;
+	mSize = 0;
+}
+
+#else
+
+struct MappedFile::PlatformState final {
+	void* mapped = nullptr;
+	size_t mappedSize = 0;
+};
+
+ZgResult MappedFile::map(const char* path) noexcept
+{
+	this->destroy();
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		ZG_ERROR("Could not open file \"%s\"", path);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// Empty files can not be mapped
+	struct stat fileStat = {};
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+		ZG_ERROR("Could not map empty or unreadable file \"%s\"", path);
+		close(fd);
+		return ZG_ERROR_INVALID_ARGUMENT;
+	}
+
+	// The mapping keeps its own reference to the file, so it can be closed right away
+	size_t mappedSize = size_t(fileStat.st_size);
+	void* mapped = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED) {
+		ZG_ERROR("Could not memory map file \"%s\"", path);
+		return ZG_ERROR_GENERIC;
+	}
+
+	mState = zgNew<PlatformState>("ZeroG - MappedFile");
+	mState->mapped = mapped;
+	mState->mappedSize = mappedSize;
+	mData = reinterpret_cast<const uint8_t*>(mapped);
+	mSize = uint64_t(mappedSize);
+	return ZG_SUCCESS;
+}
+
+void MappedFile::destroy() noexcept
+{
+	if (mState != nullptr) {
+		munmap(mState->mapped, mState->mappedSize);
+		zgDelete(mState);
+	}
+	mState = nullptr;
+	mData = nullptr;
+	mSize = 0;
+}
+
+#endif
+
+} // namespace zg
@@ -0,0 +1,133 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+
+#include "ZeroG.h"
+#include "ZeroG/util/Vector.hpp"
+
+namespace zg {
+
+// File size
+// ------------------------------------------------------------------------------------------------
+
+// Returns the size of the file in bytes, or 0 if it could not be opened.
+uint64_t fileSize(const char* path) noexcept;
+
+// Synchronous file reading
+// ------------------------------------------------------------------------------------------------
+
+// Reads a range of a file directly into the specified memory, without any intermediate buffering.
+ZgResult readFileRange(
+	const char* path, uint64_t fileOffsetBytes, uint64_t numBytes, void* dstMemory) noexcept;
+
+// Reads an entire binary file. Returns an empty vector on failure.
+Vector<uint8_t> readBinaryFile(const char* path) noexcept;
+
+// Asynchronous file reading
+// ------------------------------------------------------------------------------------------------
+
+// Reads a range of a file directly into the specified memory (typically a mapped upload buffer).
+//
+// On Windows this is implemented using overlapped I/O, i.e. the read is performed by the OS in
+// the background. On other platforms the file range is memory mapped and copied immediately, in
+// which case the read is already done when start() returns.
+class AsyncFileRead final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	AsyncFileRead() noexcept = default;
+	AsyncFileRead(const AsyncFileRead&) = delete;
+	AsyncFileRead& operator= (const AsyncFileRead&) = delete;
+	AsyncFileRead(AsyncFileRead&&) = delete;
+	AsyncFileRead& operator= (AsyncFileRead&&) = delete;
+	~AsyncFileRead() noexcept { this->destroy(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	// Starts reading, dstMemory must be kept alive until the read is done (or destroy() is called)
+	ZgResult start(
+		const char* path, uint64_t fileOffsetBytes, uint64_t numBytes, void* dstMemory) noexcept;
+
+	// Cancels the read if it is still in progress, waits until the OS is no longer using the
+	// destination memory.
+	void destroy() noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	// Checks if the read is done. Returns the result of the read once done.
+	ZgResult checkIfDone(bool& doneOut) noexcept;
+
+	// Blocks until read is done and returns its result.
+	ZgResult waitBlocking() noexcept;
+
+private:
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	struct PlatformState;
+	PlatformState* mState = nullptr;
+	bool mDone = false;
+	ZgResult mResult = ZG_SUCCESS;
+};
+
+// Memory mapped files
+// ------------------------------------------------------------------------------------------------
+
+// A read-only memory mapping of an entire file. The OS pages in the contents on demand, so mapping
+// is cheap regardless of file size and only the parts actually accessed are ever read.
+class MappedFile final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	MappedFile() noexcept = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator= (const MappedFile&) = delete;
+	MappedFile(MappedFile&&) = delete;
+	MappedFile& operator= (MappedFile&&) = delete;
+	~MappedFile() noexcept { this->destroy(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	ZgResult map(const char* path) noexcept;
+	void destroy() noexcept;
+
+	// Getters
+	// --------------------------------------------------------------------------------------------
+
+	const uint8_t* data() const noexcept { return mData; }
+	uint64_t size() const noexcept { return mSize; }
+
+private:
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	struct PlatformState;
+	PlatformState* mState = nullptr;
+	const uint8_t* mData = nullptr;
+	uint64_t mSize = 0;
+};
+
+} // namespace zg
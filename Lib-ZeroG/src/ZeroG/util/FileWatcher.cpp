@@ -0,0 +1,171 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/util/FileWatcher.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "ZeroG/util/Logging.hpp"
+
+namespace zg {
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+namespace fs = std::filesystem;
+
+static int64_t lastWriteTime(const char* path) noexcept
+{
+	std::error_code ec;
+	fs::file_time_type time = fs::last_write_time(path, ec);
+	if (ec) return 0;
+	return int64_t(time.time_since_epoch().count());
+}
+
+static void addUnique(SmallVector<uint32_t, 16>& indices, uint32_t index) noexcept
+{
+	for (uint32_t i = 0; i < indices.size(); i++) {
+		if (indices[i] == index) return;
+	}
+	indices.add(index);
+}
+
+// FileWatcher: State methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult FileWatcher::create() noexcept
+{
+	this->destroy();
+
+#ifdef __linux__
+	mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (mInotifyFd < 0) {
+		ZG_ERROR("FileWatcher: Could not initialize inotify");
+		return ZG_ERROR_GENERIC;
+	}
+#endif
+
+	mFiles.create(16, "ZeroG - FileWatcher");
+	mCreated = true;
+	return ZG_SUCCESS;
+}
+
+void FileWatcher::destroy() noexcept
+{
+#ifdef __linux__
+	// Closing the inotify instance removes all its watches
+	if (mInotifyFd >= 0) close(mInotifyFd);
+#endif
+	mInotifyFd = -1;
+	mFiles.destroy();
+	mCreated = false;
+}
+
+// FileWatcher: Methods
+// ------------------------------------------------------------------------------------------------
+
+uint32_t FileWatcher::addFile(const char* pathIn) noexcept
+{
+	if (!mCreated) return ~0u;
+
+	std::string path = fs::path(pathIn).lexically_normal().generic_string();
+	if (path.empty() || path.size() >= FILE_WATCHER_MAX_PATH_LENGTH) {
+		ZG_ERROR("FileWatcher: Invalid or too long path \"%s\"", pathIn);
+		return ~0u;
+	}
+
+	// Check if already watched
+	for (uint32_t i = 0; i < mFiles.size(); i++) {
+		if (std::strcmp(mFiles[i].path, path.c_str()) == 0) return i;
+	}
+
+	File file;
+	std::memcpy(file.path, path.c_str(), path.size() + 1);
+	size_t lastSlash = path.find_last_of('/');
+	file.filenameOffset = lastSlash == std::string::npos ? 0 : uint32_t(lastSlash + 1);
+	file.lastWriteTime = lastWriteTime(file.path);
+
+#ifdef __linux__
+	// Watch the containing directory, inotify returns the same watch descriptor if it is already
+	// watched. Editors often save by renaming a temporary file over the original, which would
+	// leave a watch on the file itself pointing at the old (deleted) inode.
+	std::string directory = lastSlash == std::string::npos ? "." : path.substr(0, lastSlash);
+	if (directory.empty()) directory = "/";
+	file.watchDescriptor = inotify_add_watch(
+		mInotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (file.watchDescriptor < 0) {
+		ZG_ERROR("FileWatcher: Could not watch directory \"%s\"", directory.c_str());
+		return ~0u;
+	}
+#endif
+
+	uint32_t fileIdx = mFiles.size();
+	if (!mFiles.add(file)) return ~0u;
+	return fileIdx;
+}
+
+void FileWatcher::poll(SmallVector<uint32_t, 16>& modifiedOut) noexcept
+{
+	if (!mCreated) return;
+
+#ifdef __linux__
+	alignas(inotify_event) char buffer[4096];
+	while (true) {
+		ssize_t numBytesRead = read(mInotifyFd, buffer, sizeof(buffer));
+		if (numBytesRead <= 0) break; // EAGAIN, no more events
+
+		for (ssize_t offset = 0; offset < numBytesRead;) {
+			const inotify_event& event = *reinterpret_cast<const inotify_event*>(buffer + offset);
+			offset += sizeof(inotify_event) + event.len;
+
+			// Events were dropped, assume everything was modified
+			if ((event.mask & IN_Q_OVERFLOW) != 0) {
+				for (uint32_t i = 0; i < mFiles.size(); i++) addUnique(modifiedOut, i);
+				continue;
+			}
+			if (event.len == 0) continue;
+
+			for (uint32_t i = 0; i < mFiles.size(); i++) {
+				const File& file = mFiles[i];
+				if (file.watchDescriptor != event.wd) continue;
+				if (std::strcmp(file.path + file.filenameOffset, event.name) != 0) continue;
+				addUnique(modifiedOut, i);
+			}
+		}
+	}
+#else
+	for (uint32_t i = 0; i < mFiles.size(); i++) {
+		File& file = mFiles[i];
+
+		// Skip files that can't be accessed, e.g. because they are in the middle of being saved
+		int64_t writeTime = lastWriteTime(file.path);
+		if (writeTime == 0 || writeTime == file.lastWriteTime) continue;
+		file.lastWriteTime = writeTime;
+		addUnique(modifiedOut, i);
+	}
+#endif
+}
+
+} // namespace zg
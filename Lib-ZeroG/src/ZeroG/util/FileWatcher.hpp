@@ -0,0 +1,93 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+
+#include "ZeroG.h"
+#include "ZeroG/util/SmallVector.hpp"
+
+namespace zg {
+
+// FileWatcher
+// ------------------------------------------------------------------------------------------------
+
+constexpr uint32_t FILE_WATCHER_MAX_PATH_LENGTH = 320;
+
+// Watches a set of files for modifications. Files are identified by the index returned when they
+// were added, adding the same (normalized) path twice returns the same index.
+//
+// On Linux this uses inotify on the directories containing the files, so that files replaced by
+// editors that save to a temporary file and rename it over the original are still detected. On
+// other platforms the last write time of every file is compared each time poll() is called.
+// Not thread-safe.
+class FileWatcher final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	FileWatcher() noexcept = default;
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator= (const FileWatcher&) = delete;
+	FileWatcher(FileWatcher&&) = delete;
+	FileWatcher& operator= (FileWatcher&&) = delete;
+	~FileWatcher() noexcept { this->destroy(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	ZgResult create() noexcept;
+	void destroy() noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	// Starts watching the file (which does not need to exist yet) and returns its index, or ~0u
+	// on failure.
+	uint32_t addFile(const char* path) noexcept;
+
+	// Appends the index of every file that has been modified since the last call. Each index is
+	// appended at most once per call.
+	void poll(SmallVector<uint32_t, 16>& modifiedOut) noexcept;
+
+	// Getters
+	// --------------------------------------------------------------------------------------------
+
+	const char* path(uint32_t fileIdx) const noexcept { return mFiles[fileIdx].path; }
+
+private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	struct File final {
+		char path[FILE_WATCHER_MAX_PATH_LENGTH] = {};
+		uint32_t filenameOffset = 0; // Offset of the filename (without directory) into path
+		int watchDescriptor = -1; // inotify watch of the containing directory
+		int64_t lastWriteTime = 0;
+	};
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	bool mCreated = false;
+	int mInotifyFd = -1;
+	SmallVector<File, 0> mFiles;
+};
+
+} // namespace zg
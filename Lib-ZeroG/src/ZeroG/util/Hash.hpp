@@ -0,0 +1,59 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace zg {
+
+// Hashing
+// ------------------------------------------------------------------------------------------------
+
+// 64-bit FNV-1a. Not cryptographic, but fast and good enough to key caches with. Hashes can be
+// chained by passing the previous hash as the seed.
+constexpr uint64_t HASH_SEED = 0xCBF29CE484222325ull;
+
+inline uint64_t hashBytes(const void* data, uint64_t numBytes, uint64_t seed = HASH_SEED) noexcept
+{
+	constexpr uint64_t FNV_PRIME = 0x100000001B3ull;
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+	uint64_t hash = seed;
+	for (uint64_t i = 0; i < numBytes; i++) {
+		hash ^= uint64_t(bytes[i]);
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+// Hashes a string including its null-terminator, so that e.g. ("ab", "c") and ("a", "bc") hash
+// differently when chained. A null string hashes as an empty one.
+inline uint64_t hashString(const char* str, uint64_t seed = HASH_SEED) noexcept
+{
+	if (str == nullptr) str = "";
+	return hashBytes(str, std::strlen(str) + 1, seed);
+}
+
+template<typename T>
+uint64_t hashValue(const T& value, uint64_t seed = HASH_SEED) noexcept
+{
+	return hashBytes(&value, sizeof(T), seed);
+}
+
+} // namespace zg
@@ -0,0 +1,133 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/util/HeapRangeTracker.hpp"
+
+#include <algorithm>
+
+#include "ZeroG/util/CpuAllocation.hpp"
+
+namespace zg {
+
+// HeapRangeTracker: State methods
+// ------------------------------------------------------------------------------------------------
+
+HeapRangeTracker* HeapRangeTracker::create(uint64_t heapSizeBytes) noexcept
+{
+	HeapRangeTracker* tracker = zgNew<HeapRangeTracker>("ZeroG - HeapRangeTracker");
+	tracker->mRefCount = 1;
+	tracker->mHeapSizeBytes = heapSizeBytes;
+	return tracker;
+}
+
+void HeapRangeTracker::retain() noexcept
+{
+	mRefCount.fetch_add(1);
+}
+
+void HeapRangeTracker::release() noexcept
+{
+	if (mRefCount.fetch_sub(1) == 1) {
+		zgDelete(this);
+	}
+}
+
+// HeapRangeTracker: Methods
+// ------------------------------------------------------------------------------------------------
+
+ZgResult HeapRangeTracker::addRange(uint64_t offsetBytes, uint64_t sizeBytes) noexcept
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	// Grow storage if necessary
+	if (mRanges.size() == mRanges.capacity()) {
+		Vector<Range> newRanges;
+		uint32_t newCapacity = std::max(mRanges.capacity() * 2, 16u);
+		if (!newRanges.create(newCapacity, "ZeroG - HeapRangeTracker - Ranges")) {
+			return ZG_ERROR_CPU_OUT_OF_MEMORY;
+		}
+		for (uint32_t i = 0; i < mRanges.size(); i++) {
+			newRanges.add(mRanges[i]);
+		}
+		mRanges.swap(newRanges);
+	}
+
+	// Insert range sorted by offset
+	Range range;
+	range.offsetBytes = offsetBytes;
+	range.sizeBytes = sizeBytes;
+	mRanges.add(range);
+	for (uint32_t i = mRanges.size() - 1; i > 0; i--) {
+		if (mRanges[i - 1].offsetBytes <= offsetBytes) break;
+		std::swap(mRanges[i - 1], mRanges[i]);
+	}
+
+	return ZG_SUCCESS;
+}
+
+void HeapRangeTracker::removeRange(uint64_t offsetBytes, uint64_t sizeBytes) noexcept
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (uint32_t i = 0; i < mRanges.size(); i++) {
+		const Range& range = mRanges[i];
+		if (range.offsetBytes != offsetBytes || range.sizeBytes != sizeBytes) continue;
+
+		// Shift remaining ranges down to keep them sorted
+		for (uint32_t j = i + 1; j < mRanges.size(); j++) {
+			mRanges[j - 1] = mRanges[j];
+		}
+		mRanges.pop();
+		return;
+	}
+}
+
+void HeapRangeTracker::getStats(ZgMemoryHeapStats& statsOut) noexcept
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	statsOut = {};
+	statsOut.sizeInBytes = mHeapSizeBytes;
+	statsOut.numAllocations = mRanges.size();
+
+	// Walk ranges in order, the cursor is the end of the occupied memory seen so far
+	uint64_t cursor = 0;
+	auto addFreeBlock = [&](uint64_t sizeBytes) {
+		if (sizeBytes == 0) return;
+		statsOut.numFreeBlocks += 1;
+		statsOut.largestFreeBlockInBytes = std::max(statsOut.largestFreeBlockInBytes, sizeBytes);
+	};
+	for (uint32_t i = 0; i < mRanges.size(); i++) {
+		uint64_t begin = std::min(mRanges[i].offsetBytes, mHeapSizeBytes);
+		uint64_t end = std::min(mRanges[i].offsetBytes + mRanges[i].sizeBytes, mHeapSizeBytes);
+		if (begin > cursor) addFreeBlock(begin - cursor);
+		if (end > cursor) {
+			statsOut.usedBytes += end - std::max(begin, cursor);
+			cursor = end;
+		}
+	}
+	addFreeBlock(mHeapSizeBytes - cursor);
+
+	statsOut.freeBytes = mHeapSizeBytes - statsOut.usedBytes;
+	if (statsOut.freeBytes != 0) {
+		statsOut.fragmentation =
+			1.0f - float(double(statsOut.largestFreeBlockInBytes) / double(statsOut.freeBytes));
+	}
+}
+
+} // namespace zg
@@ -0,0 +1,87 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "ZeroG.h"
+#include "ZeroG/util/Vector.hpp"
+
+namespace zg {
+
+// Heap range tracker
+// ------------------------------------------------------------------------------------------------
+
+// Keeps track of which ranges of a memory heap are occupied by live resources, used to calculate
+// memory heap statistics (used and free memory, fragmentation, etc).
+//
+// Shared between a heap and all resources placed in it, because resources may outlive the heap
+// (the underlying API keeps the heap alive as long as a resource references it). Reference
+// counted, destroys itself when the last reference is released.
+class HeapRangeTracker final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	HeapRangeTracker() noexcept = default;
+	HeapRangeTracker(const HeapRangeTracker&) = delete;
+	HeapRangeTracker& operator= (const HeapRangeTracker&) = delete;
+	HeapRangeTracker(HeapRangeTracker&&) = delete;
+	HeapRangeTracker& operator= (HeapRangeTracker&&) = delete;
+	~HeapRangeTracker() noexcept = default;
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	// Creates a new tracker with a reference count of 1.
+	static HeapRangeTracker* create(uint64_t heapSizeBytes) noexcept;
+
+	void retain() noexcept;
+	void release() noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	// Ranges may overlap (i.e. aliased resources), overlapping parts are only counted once.
+	ZgResult addRange(uint64_t offsetBytes, uint64_t sizeBytes) noexcept;
+	void removeRange(uint64_t offsetBytes, uint64_t sizeBytes) noexcept;
+
+	void getStats(ZgMemoryHeapStats& statsOut) noexcept;
+
+private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	struct Range final {
+		uint64_t offsetBytes = 0;
+		uint64_t sizeBytes = 0;
+	};
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	std::atomic_uint32_t mRefCount = 0;
+	uint64_t mHeapSizeBytes = 0;
+	std::mutex mMutex;
+	Vector<Range> mRanges; // Sorted by offset
+};
+
+} // namespace zg
@@ -0,0 +1,219 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "ZeroG/Context.hpp"
+#include "ZeroG/util/CpuAllocation.hpp"
+
+namespace zg {
+
+// MpmcQueue
+// ------------------------------------------------------------------------------------------------
+
+/// A bounded lock-free multi-producer multi-consumer FIFO queue.
+///
+/// Based on Dmitry Vyukov's bounded MPMC queue. Each cell holds a sequence number which tells
+/// producers and consumers whether it is ready to be written to or read from, so the only shared
+/// state contended on is the enqueue and dequeue positions (kept on separate cache lines). Capacity
+/// is rounded up to a power of two so indices can be masked.
+///
+/// Any number of threads may call add() and pop() concurrently. create() and destroy() must not be
+/// called concurrently with anything else.
+template<typename T>
+class MpmcQueue final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	MpmcQueue() noexcept = default;
+	MpmcQueue(const MpmcQueue&) = delete;
+	MpmcQueue& operator= (const MpmcQueue&) = delete;
+	MpmcQueue(MpmcQueue&&) = delete;
+	MpmcQueue& operator= (MpmcQueue&&) = delete;
+	~MpmcQueue() noexcept { this->destroy(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	/// Calls destroy() and allocates memory for at least the specified number of elements. Returns
+	/// false if out of memory.
+	bool create(uint32_t capacity, const char* allocationName) noexcept
+	{
+		this->destroy();
+		if (capacity == 0) return true;
+
+		// Round capacity up to closest power of two
+		uint32_t powerOfTwoCapacity = 1;
+		while (powerOfTwoCapacity < capacity) powerOfTwoCapacity *= 2;
+
+		// Allocate memory
+		ZgAllocator& allocator = getAllocator();
+		mCells = reinterpret_cast<Cell*>(allocator.allocate(
+			allocator.userPtr, uint32_t(sizeof(Cell) * powerOfTwoCapacity), allocationName));
+		if (mCells == nullptr) return false;
+
+		// Initialize sequence numbers, cell i is first writable at position i
+		for (uint32_t i = 0; i < powerOfTwoCapacity; i++) {
+			new (&mCells[i].sequence) std::atomic_uint64_t(i);
+		}
+		mMask = powerOfTwoCapacity - 1;
+		mEnqueuePos.store(0, std::memory_order_relaxed);
+		mDequeuePos.store(0, std::memory_order_relaxed);
+		return true;
+	}
+
+	/// Destroys all remaining elements and deallocates memory.
+	void destroy() noexcept
+	{
+		if (mCells == nullptr) return;
+
+		// Destroy remaining elements
+		while (this->pop());
+
+		ZgAllocator& allocator = getAllocator();
+		allocator.deallocate(allocator.userPtr, reinterpret_cast<uint8_t*>(mCells));
+		mCells = nullptr;
+		mMask = 0;
+	}
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	/// Adds an element to the end of the queue. Returns false if the queue is full.
+	bool add(const T& value) noexcept { return this->addInternal<const T&>(value); }
+	bool add(T&& value) noexcept { return this->addInternal<T>(std::move(value)); }
+
+	/// Removes the element at the front of the queue. Returns false if the queue is empty.
+	bool pop(T& out) noexcept { return this->popInternal(&out); }
+	bool pop() noexcept { return this->popInternal(nullptr); }
+
+	// Getters
+	// --------------------------------------------------------------------------------------------
+
+	/// Approximate number of elements in the queue, exact if no other thread is modifying it.
+	uint32_t size() const noexcept
+	{
+		uint64_t dequeuePos = mDequeuePos.load(std::memory_order_acquire);
+		uint64_t enqueuePos = mEnqueuePos.load(std::memory_order_acquire);
+		return enqueuePos > dequeuePos ? uint32_t(enqueuePos - dequeuePos) : 0;
+	}
+
+	uint32_t capacity() const noexcept { return mCells == nullptr ? 0 : (mMask + 1); }
+
+private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	static constexpr uint32_t CACHE_LINE_SIZE = 64;
+
+	struct Cell final {
+		std::atomic_uint64_t sequence;
+		T data;
+	};
+
+	// Private methods
+	// --------------------------------------------------------------------------------------------
+
+	template<typename PerfectT>
+	bool addInternal(PerfectT&& value) noexcept
+	{
+		if (mCells == nullptr) return false;
+
+		Cell* cell = nullptr;
+		uint64_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &mCells[pos & mMask];
+			uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+			int64_t diff = int64_t(sequence) - int64_t(pos);
+
+			// Cell is free, attempt to claim it
+			if (diff == 0) {
+				if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+
+			// Cell still holds an element from the previous lap, queue is full
+			else if (diff < 0) {
+				return false;
+			}
+
+			// Another producer claimed the cell, reload position
+			else {
+				pos = mEnqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		new (&cell->data) T(std::forward<PerfectT>(value));
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool popInternal(T* out) noexcept
+	{
+		if (mCells == nullptr) return false;
+
+		Cell* cell = nullptr;
+		uint64_t pos = mDequeuePos.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &mCells[pos & mMask];
+			uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+			int64_t diff = int64_t(sequence) - int64_t(pos + 1);
+
+			// Cell holds an element, attempt to claim it
+			if (diff == 0) {
+				if (mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+
+			// Cell has not been written to yet, queue is empty
+			else if (diff < 0) {
+				return false;
+			}
+
+			// Another consumer claimed the cell, reload position
+			else {
+				pos = mDequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		if (out != nullptr) *out = std::move(cell->data);
+		cell->data.~T();
+
+		// Mark cell as writable for the next lap
+		cell->sequence.store(pos + uint64_t(mMask) + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	Cell* mCells = nullptr;
+	uint32_t mMask = 0;
+	alignas(CACHE_LINE_SIZE) std::atomic_uint64_t mEnqueuePos = 0;
+	alignas(CACHE_LINE_SIZE) std::atomic_uint64_t mDequeuePos = 0;
+};
+
+} // namespace zg
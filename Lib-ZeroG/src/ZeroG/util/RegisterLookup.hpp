@@ -0,0 +1,160 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "ZeroG/util/Assert.hpp"
+
+namespace zg {
+
+// RegisterLookup
+// ------------------------------------------------------------------------------------------------
+
+// Index returned by RegisterLookup::find() for registers without a mapping
+constexpr uint8_t REGISTER_LOOKUP_NO_MAPPING = 0xFF;
+
+// Registers below this are looked up in a dense table, higher registers are searched for linearly
+constexpr uint32_t REGISTER_LOOKUP_TABLE_SIZE = 64;
+
+// Maps shader registers to the index of their mapping in a pipeline (e.g. push constants, constant
+// buffers or textures), so command lists don't have to search through the mappings each time
+// something is bound. Shaders almost always use low registers, which are looked up directly in a
+// table. The rare higher registers are kept in a small list which is searched linearly.
+template<uint32_t MaxNumMappings>
+struct RegisterLookup final {
+	static_assert(MaxNumMappings <= 32, "Bit masks of the mappings must fit in uint32_t");
+
+	uint32_t numMappings;
+	uint32_t registers[MaxNumMappings]; // The register of each mapping
+	uint8_t byRegister[REGISTER_LOOKUP_TABLE_SIZE];
+	uint32_t numHighRegisters;
+	uint32_t highRegisters[MaxNumMappings];
+	uint8_t highRegisterMappings[MaxNumMappings];
+
+	RegisterLookup() noexcept { this->clear(); }
+
+	void clear() noexcept
+	{
+		numMappings = 0;
+		std::memset(byRegister, REGISTER_LOOKUP_NO_MAPPING, REGISTER_LOOKUP_TABLE_SIZE);
+		numHighRegisters = 0;
+	}
+
+	// Adds the next mapping, i.e. the first added mapping gets index 0. Registers must be unique.
+	void add(uint32_t shaderRegister) noexcept
+	{
+		ZG_ASSERT(numMappings < MaxNumMappings);
+		ZG_ASSERT(find(shaderRegister) == REGISTER_LOOKUP_NO_MAPPING);
+		const uint8_t mappingIdx = uint8_t(numMappings);
+		registers[numMappings] = shaderRegister;
+		numMappings += 1;
+		if (shaderRegister < REGISTER_LOOKUP_TABLE_SIZE) {
+			byRegister[shaderRegister] = mappingIdx;
+			return;
+		}
+		highRegisters[numHighRegisters] = shaderRegister;
+		highRegisterMappings[numHighRegisters] = mappingIdx;
+		numHighRegisters += 1;
+	}
+
+	// Returns the index of the mapping for the register, or REGISTER_LOOKUP_NO_MAPPING
+	uint8_t find(uint32_t shaderRegister) const noexcept
+	{
+		if (shaderRegister < REGISTER_LOOKUP_TABLE_SIZE) return byRegister[shaderRegister];
+		for (uint32_t i = 0; i < numHighRegisters; i++) {
+			if (highRegisters[i] == shaderRegister) return highRegisterMappings[i];
+		}
+		return REGISTER_LOOKUP_NO_MAPPING;
+	}
+};
+
+// Ordering bindings by mapping
+// ------------------------------------------------------------------------------------------------
+
+// Below this many (mappings * bindings) searching the bindings linearly for each mapping is
+// cheaper than going through the lookup, see Bench-RegisterLookup in Tests-ZeroG
+constexpr uint32_t REGISTER_LOOKUP_MAX_LINEAR_SEARCH_WORK = 48;
+
+// Searches the bindings linearly for the register of each mapping
+template<uint32_t MaxNumMappings, typename Binding, typename GetRegisterFunc>
+void orderBindingsLinearSearch(
+	const Binding* orderedOut[],
+	const RegisterLookup<MaxNumMappings>& lookup,
+	const Binding* bindings,
+	uint32_t numBindings,
+	GetRegisterFunc getRegister) noexcept
+{
+	for (uint32_t i = 0; i < lookup.numMappings; i++) {
+		orderedOut[i] = nullptr;
+		for (uint32_t j = 0; j < numBindings; j++) {
+			if (getRegister(bindings[j]) == lookup.registers[i]) {
+				orderedOut[i] = &bindings[j];
+				break;
+			}
+		}
+	}
+}
+
+// Scatters the bindings to their mappings using the lookup
+template<uint32_t MaxNumMappings, typename Binding, typename GetRegisterFunc>
+void orderBindingsScatter(
+	const Binding* orderedOut[],
+	const RegisterLookup<MaxNumMappings>& lookup,
+	const Binding* bindings,
+	uint32_t numBindings,
+	GetRegisterFunc getRegister) noexcept
+{
+	// Which mappings have a binding is tracked in a bit mask instead of clearing orderedOut first,
+	// clearing a variable number of pointers compiles into a comparatively expensive memset() call
+	uint32_t boundMask = 0;
+	for (uint32_t i = 0; i < numBindings; i++) {
+		const uint8_t mappingIdx = lookup.find(getRegister(bindings[i]));
+		if (mappingIdx == REGISTER_LOOKUP_NO_MAPPING) continue;
+		const uint32_t mappingBit = 1u << mappingIdx;
+		if ((boundMask & mappingBit) != 0) continue;
+		boundMask |= mappingBit;
+		orderedOut[mappingIdx] = &bindings[i];
+	}
+	for (uint32_t i = 0; i < lookup.numMappings; i++) {
+		if ((boundMask & (1u << i)) == 0) orderedOut[i] = nullptr;
+	}
+}
+
+// Puts the bindings in the same order as the mappings of the lookup, i.e. orderedOut[i] is the
+// binding for the i:th mapping, or nullptr if it has none. Bindings to registers without a mapping
+// are ignored, if a register is bound more than once the first binding is used.
+template<uint32_t MaxNumMappings, typename Binding, typename GetRegisterFunc>
+void orderBindingsByMapping(
+	const Binding* orderedOut[],
+	const RegisterLookup<MaxNumMappings>& lookup,
+	const Binding* bindings,
+	uint32_t numBindings,
+	GetRegisterFunc getRegister) noexcept
+{
+	if ((lookup.numMappings * numBindings) <= REGISTER_LOOKUP_MAX_LINEAR_SEARCH_WORK) {
+		orderBindingsLinearSearch(orderedOut, lookup, bindings, numBindings, getRegister);
+	}
+	else {
+		orderBindingsScatter(orderedOut, lookup, bindings, numBindings, getRegister);
+	}
+}
+
+} // namespace zg
@@ -44,6 +44,10 @@ constexpr uint64_t RINGBUFFER_BASE_IDX = (UINT64_MAX >> uint64_t(1)) + uint64_t(
 /// this should never become a problem, as it would take several years of runtime to overflow if you
 /// move many billions of elements per second through the buffer.
 ///
+/// The backing array is rounded up to a power of two elements, so that the indices can be mapped
+/// into it with a mask instead of a (64-bit) modulo operation. The capacity is still exactly what
+/// was requested, the RingBuffer reports being full once it holds that many elements.
+///
 /// Has some multi-threading guarantees. It is safe to have one thread add elements using add() and
 /// another removing elements using pop() at the same time (likewise for the addFirst() & popLast()
 /// pair). It is not safe to have multiple threads add elements at the same time, or have multiple
@@ -85,12 +89,18 @@ public:
 
 		// If capacity is 0, do nothing.
 		if (capacity == 0) return;
-		mCapacity = capacity;
+
+		// Round size of backing array up to closest power of two
+		uint64_t arraySize = 1;
+		while (arraySize < capacity) arraySize *= 2;
 
 		// Allocate memory
 		ZgAllocator allocator = getAllocator();
 		mDataPtr = reinterpret_cast<T*>(
-			allocator.allocate(allocator.userPtr, mCapacity * sizeof(T), allocationName));
+			allocator.allocate(allocator.userPtr, arraySize * sizeof(T), allocationName));
+		if (mDataPtr == nullptr) return;
+		mCapacity = capacity;
+		mIndexMask = arraySize - 1;
 	}
 
 	/// Swaps the contents of two RingBuffers, including the allocator pointers.
@@ -108,6 +118,7 @@ public:
 		other.mLastIndex.exchange(thisLastIndexCopy);
 		
 		std::swap(this->mCapacity, other.mCapacity);
+		std::swap(this->mIndexMask, other.mIndexMask);
 	}
 
 	/// Destroys all elements stored in this RingBuffer, deallocates all memory and removes
@@ -127,6 +138,7 @@ public:
 		allocator.deallocate(allocator.userPtr, reinterpret_cast<uint8_t*>(mDataPtr));
 		mDataPtr = nullptr;
 		mCapacity = 0;
+		mIndexMask = 0;
 	}
 
 	/// Removes all elements from this RingBuffer without deallocating memory, changing capacity or
@@ -202,8 +214,8 @@ private:
 	// Private methods
 	// --------------------------------------------------------------------------------------------
 
-	/// Maps an "infinite" index into an index into the data array
-	uint64_t mapIndex(uint64_t index) const noexcept { return index % uint64_t(mCapacity); }
+	/// Maps an "infinite" index into an index into the data array.
+	uint64_t mapIndex(uint64_t index) const noexcept { return index & mIndexMask; }
 
 	/// Internal implementation of add(). Utilizes perfect forwarding in order to select whether to
 	/// use const& or &&.
@@ -218,17 +230,11 @@ private:
 		// Do nothing if no memory is allocated.
 		if (mCapacity == 0) return false;
 
-		// Map indices
-		uint64_t firstArrayIndex = mapIndex(mFirstIndex);
-		uint64_t lastArrayIndex = mapIndex(mLastIndex);
-
 		// Don't insert if buffer is full
-		if (firstArrayIndex == lastArrayIndex) {
-			// Don't exit if buffer is empty
-			if (mFirstIndex  != mLastIndex) return false;
-		}
+		if ((mLastIndex - mFirstIndex) >= mCapacity) return false;
 
 		// Add element to buffer
+		uint64_t lastArrayIndex = mapIndex(mLastIndex);
 		new (mDataPtr + lastArrayIndex) T(std::forward<PerfectT>(value));
 		mLastIndex += 1; // Must increment after element creation, due to multi-threading
 		return true;
@@ -247,18 +253,11 @@ private:
 		// Do nothing if no memory is allocated.
 		if (mCapacity == 0) return false;
 
-		// Map indices
-		uint64_t firstArrayIndex = mapIndex(mFirstIndex);
-		uint64_t lastArrayIndex = mapIndex(mLastIndex);
-
 		// Don't insert if buffer is full
-		if (firstArrayIndex == lastArrayIndex) {
-			// Don't exit if buffer is empty
-			if (mFirstIndex != mLastIndex) return false;
-		}
+		if ((mLastIndex - mFirstIndex) >= mCapacity) return false;
 
 		// Add element to buffer
-		firstArrayIndex = mapIndex(mFirstIndex - 1);
+		uint64_t firstArrayIndex = mapIndex(mFirstIndex - 1);
 		new (mDataPtr + firstArrayIndex) T(std::forward<PerfectT>(value));
 		mFirstIndex -= 1; // Must decrement after element creation, due to multi-threading
 		return true;
@@ -305,6 +304,7 @@ private:
 
 	T* mDataPtr = nullptr;
 	uint32_t mCapacity = 0;
+	uint64_t mIndexMask = 0; // Size of data array (power of two) - 1
 	std::atomic_uint64_t mFirstIndex = RINGBUFFER_BASE_IDX;
 	std::atomic_uint64_t mLastIndex = RINGBUFFER_BASE_IDX;
 };
@@ -0,0 +1,122 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "ZeroG/util/ScopedArena.hpp"
+
+#include <algorithm>
+
+#include "ZeroG/util/CpuAllocation.hpp"
+
+namespace zg {
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+constexpr uint64_t ARENA_ALIGNMENT = 32;
+constexpr uint64_t ARENA_MIN_CHUNK_SIZE = 64 * 1024;
+constexpr uint64_t ARENA_MAX_CHUNK_SIZE = 4 * 1024 * 1024;
+
+static thread_local ScopedArena* currentArena = nullptr;
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) noexcept
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// ScopedArena: Private types
+// ------------------------------------------------------------------------------------------------
+
+struct alignas(ARENA_ALIGNMENT) ScopedArena::Chunk final {
+	Chunk* next = nullptr;
+	uint64_t sizeBytes = 0; // Including this header
+};
+
+// ScopedArena: Constructors & destructors
+// ------------------------------------------------------------------------------------------------
+
+ScopedArena::ScopedArena() noexcept
+{
+	mPrevious = currentArena;
+	mNextChunkSize = ARENA_MIN_CHUNK_SIZE;
+	currentArena = this;
+}
+
+ScopedArena::~ScopedArena() noexcept
+{
+	// Restore previous arena before deallocating, so the allocator is not routed back to us
+	currentArena = mPrevious;
+
+	ZgAllocator& allocator = getAllocator();
+	Chunk* chunk = mChunks;
+	while (chunk != nullptr) {
+		Chunk* next = chunk->next;
+		allocator.deallocate(allocator.userPtr, chunk);
+		chunk = next;
+	}
+}
+
+// ScopedArena: Methods
+// ------------------------------------------------------------------------------------------------
+
+void* ScopedArena::allocate(uint64_t size) noexcept
+{
+	size = alignUp(std::max(size, uint64_t(1)), ARENA_ALIGNMENT);
+
+	// Allocate a new chunk if the current one is full
+	if (mCursor == nullptr || (mCursor + size) > mEnd) {
+		uint64_t chunkSize = std::max(mNextChunkSize, size + sizeof(Chunk));
+		if (chunkSize > UINT32_MAX) return nullptr;
+		ZgAllocator& allocator = getAllocator();
+		Chunk* chunk = reinterpret_cast<Chunk*>(
+			allocator.allocate(allocator.userPtr, uint32_t(chunkSize), "ZeroG - ScopedArena"));
+		if (chunk == nullptr) return nullptr;
+		chunk->next = mChunks;
+		chunk->sizeBytes = chunkSize;
+		mChunks = chunk;
+		mCursor = reinterpret_cast<uint8_t*>(chunk) + sizeof(Chunk);
+		mEnd = reinterpret_cast<uint8_t*>(chunk) + chunkSize;
+		mNextChunkSize = std::min(mNextChunkSize * 2, ARENA_MAX_CHUNK_SIZE);
+	}
+
+	void* ptr = mCursor;
+	mCursor += size;
+	mNumBytesAllocated += size;
+	return ptr;
+}
+
+bool ScopedArena::owns(const void* ptr) const noexcept
+{
+	const uint8_t* p = reinterpret_cast<const uint8_t*>(ptr);
+	for (const ScopedArena* arena = this; arena != nullptr; arena = arena->mPrevious) {
+		for (const Chunk* chunk = arena->mChunks; chunk != nullptr; chunk = chunk->next) {
+			const uint8_t* begin = reinterpret_cast<const uint8_t*>(chunk);
+			if (begin <= p && p < (begin + chunk->sizeBytes)) return true;
+		}
+	}
+	return false;
+}
+
+// ScopedArena: Getters
+// ------------------------------------------------------------------------------------------------
+
+ScopedArena* ScopedArena::current() noexcept
+{
+	return currentArena;
+}
+
+} // namespace zg
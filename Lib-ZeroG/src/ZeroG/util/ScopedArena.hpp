@@ -0,0 +1,86 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+
+#include "ZeroG.h"
+
+namespace zg {
+
+// ScopedArena
+// ------------------------------------------------------------------------------------------------
+
+// A bump allocator which, while alive, is used for all operator new calls made by ZeroG on the
+// creating thread (see NewOverloads.cpp). Deleting memory owned by the arena is a no-op, all of it
+// is freed in bulk when the arena is destroyed.
+//
+// Intended for third-party code (i.e. SPIRV-Cross) which does a lot of small allocations during a
+// short, well-defined period. Nothing allocated with operator new inside the scope may be used
+// (or deleted) after the arena is destroyed. Arenas may be nested, the innermost one is used.
+//
+// Operator new is only redirected on Windows. On other platforms the arena can still be used
+// directly through allocate(), but operator new inside the scope uses the global heap as usual.
+class ScopedArena final {
+public:
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	ScopedArena() noexcept;
+	ScopedArena(const ScopedArena&) = delete;
+	ScopedArena& operator= (const ScopedArena&) = delete;
+	ScopedArena(ScopedArena&&) = delete;
+	ScopedArena& operator= (ScopedArena&&) = delete;
+	~ScopedArena() noexcept;
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	// Returns nullptr if out of memory. Allocations are 32-byte aligned.
+	void* allocate(uint64_t size) noexcept;
+
+	// Whether the pointer was allocated from this arena or any arena it is nested inside
+	bool owns(const void* ptr) const noexcept;
+
+	// Getters
+	// --------------------------------------------------------------------------------------------
+
+	// Returns the innermost arena active on the calling thread, or nullptr if there is none
+	static ScopedArena* current() noexcept;
+
+	uint64_t numBytesAllocated() const noexcept { return mNumBytesAllocated; }
+
+private:
+	// Private types
+	// --------------------------------------------------------------------------------------------
+
+	struct Chunk;
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	ScopedArena* mPrevious = nullptr;
+	Chunk* mChunks = nullptr; // Newest first
+	uint8_t* mCursor = nullptr;
+	uint8_t* mEnd = nullptr;
+	uint64_t mNextChunkSize = 0;
+	uint64_t mNumBytesAllocated = 0;
+};
+
+} // namespace zg
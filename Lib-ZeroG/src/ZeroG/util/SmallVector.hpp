@@ -0,0 +1,257 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "ZeroG/Context.hpp"
+#include "ZeroG/util/CpuAllocation.hpp"
+
+namespace zg {
+
+// SmallVector
+// ------------------------------------------------------------------------------------------------
+
+// Growable vector which stores up to N elements inline without allocating any memory. When more
+// elements are added the storage is moved to the heap (through the ZeroG allocator) and grown
+// geometrically. Use N = 0 for a plain growable vector.
+//
+// Unlike Vector, add() only fails if out of memory. Growing invalidates pointers to elements.
+template<typename T, uint32_t N>
+class SmallVector final {
+public:
+
+	// Constructors & destructors
+	// --------------------------------------------------------------------------------------------
+
+	SmallVector() noexcept : mDataPtr(inlineData()), mCapacity(N) {}
+	SmallVector(const SmallVector&) = delete;
+	SmallVector& operator= (const SmallVector&) = delete;
+	SmallVector(SmallVector&& other) noexcept : SmallVector() { this->moveFrom(other); }
+	SmallVector& operator= (SmallVector&& other) noexcept
+	{
+		if (this != &other) {
+			this->destroy();
+			this->moveFrom(other);
+		}
+		return *this;
+	}
+	~SmallVector() noexcept { this->destroy(); }
+
+	// State methods
+	// --------------------------------------------------------------------------------------------
+
+	// Sets the name used for heap allocations and reserves memory for at least the given number of
+	// elements. Returns false if out of memory.
+	bool create(uint32_t capacity, const char* allocationName) noexcept
+	{
+		mAllocationName = allocationName;
+		return this->reserve(capacity);
+	}
+
+	void swap(SmallVector& other) noexcept
+	{
+		SmallVector tmp = std::move(other);
+		other = std::move(*this);
+		*this = std::move(tmp);
+	}
+
+	void destroy() noexcept
+	{
+		this->clear();
+		if (!this->isInline()) {
+			ZgAllocator& allocator = getAllocator();
+			allocator.deallocate(allocator.userPtr, reinterpret_cast<uint8_t*>(mDataPtr));
+		}
+		mDataPtr = inlineData();
+		mCapacity = N;
+	}
+
+	// Methods
+	// --------------------------------------------------------------------------------------------
+
+	bool reserve(uint32_t capacity) noexcept
+	{
+		if (capacity <= mCapacity) return true;
+
+		// Allocate new memory
+		ZgAllocator& allocator = getAllocator();
+		T* newDataPtr = reinterpret_cast<T*>(allocator.allocate(
+			allocator.userPtr, uint32_t(sizeof(T) * capacity), mAllocationName));
+		if (newDataPtr == nullptr) return false;
+
+		// Move elements to new memory
+		for (uint32_t i = 0; i < mSize; i++) {
+			new (newDataPtr + i) T(std::move(mDataPtr[i]));
+			mDataPtr[i].~T();
+		}
+
+		// Deallocate old memory
+		if (!this->isInline()) {
+			allocator.deallocate(allocator.userPtr, reinterpret_cast<uint8_t*>(mDataPtr));
+		}
+
+		mDataPtr = newDataPtr;
+		mCapacity = capacity;
+		return true;
+	}
+
+	bool addMany(uint32_t numElements) noexcept
+	{
+		if (numElements == 0) return false;
+		if (!this->ensureCapacity(mSize + numElements)) return false;
+		for (uint32_t i = 0; i < numElements; i++) {
+			new (mDataPtr + mSize + i) T();
+		}
+		mSize += numElements;
+		return true;
+	}
+
+	bool add(const T& value) noexcept
+	{
+		if (mSize >= mCapacity) {
+			// Value might be an element in this vector, copy it before growing
+			T tmp = value;
+			return this->add(std::move(tmp));
+		}
+		new (mDataPtr + mSize) T(value);
+		mSize += 1;
+		return true;
+	}
+
+	bool add(T&& value) noexcept
+	{
+		if (!this->ensureCapacity(mSize + 1)) return false;
+		new (mDataPtr + mSize) T(std::move(value));
+		mSize += 1;
+		return true;
+	}
+
+	bool pop(T& out) noexcept
+	{
+		if (mSize == 0) return false;
+		mSize -= 1;
+		out = std::move(mDataPtr[mSize]);
+		mDataPtr[mSize].~T();
+		return true;
+	}
+
+	bool pop() noexcept
+	{
+		if (mSize == 0) return false;
+		mSize -= 1;
+		mDataPtr[mSize].~T();
+		return true;
+	}
+
+	bool remove(uint32_t position) noexcept
+	{
+		if (position >= mSize) return false;
+		mDataPtr[position].~T();
+
+		uint32_t numElementsToMove = mSize - position - 1;
+		for (uint32_t i = 0; i < numElementsToMove; i++) {
+			uint32_t dstIndex = position + i;
+			uint32_t srcIndex = position + i + 1;
+			new (mDataPtr + dstIndex) T(std::move(mDataPtr[srcIndex]));
+			mDataPtr[srcIndex].~T();
+		}
+
+		mSize -= 1;
+		return true;
+	}
+
+	void clear() noexcept
+	{
+		// Call destructor for each element if not trivially destructible
+		if (!std::is_trivially_destructible<T>::value) {
+			for (uint32_t i = 0; i < mSize; ++i) {
+				mDataPtr[i].~T();
+			}
+		}
+		mSize = 0;
+	}
+
+	T& operator[] (uint32_t index) noexcept { return mDataPtr[index]; }
+	const T& operator[] (uint32_t index) const noexcept { return mDataPtr[index]; }
+
+	// Getters
+	// --------------------------------------------------------------------------------------------
+
+	uint32_t size() const noexcept { return mSize; }
+	uint32_t capacity() const noexcept { return mCapacity; }
+	T* data() noexcept { return mDataPtr; }
+	const T* data() const noexcept { return mDataPtr; }
+	T& last() noexcept { return mDataPtr[mSize - 1]; }
+	const T& last() const noexcept { return mDataPtr[mSize - 1]; }
+
+	// Whether the elements are stored inline, i.e. no memory has been allocated
+	bool isInline() const noexcept { return mDataPtr == inlineData(); }
+
+private:
+	// Private methods
+	// --------------------------------------------------------------------------------------------
+
+	T* inlineData() noexcept { return reinterpret_cast<T*>(mInlineStorage); }
+	const T* inlineData() const noexcept { return reinterpret_cast<const T*>(mInlineStorage); }
+
+	bool ensureCapacity(uint32_t requiredCapacity) noexcept
+	{
+		if (requiredCapacity <= mCapacity) return true;
+		uint32_t newCapacity = mCapacity < 4 ? 4 : mCapacity * 2;
+		if (newCapacity < requiredCapacity) newCapacity = requiredCapacity;
+		return this->reserve(newCapacity);
+	}
+
+	// Expects this vector to be empty and inline
+	void moveFrom(SmallVector& other) noexcept
+	{
+		mAllocationName = other.mAllocationName;
+		if (other.isInline()) {
+			for (uint32_t i = 0; i < other.mSize; i++) {
+				new (mDataPtr + i) T(std::move(other.mDataPtr[i]));
+			}
+			mSize = other.mSize;
+			other.clear();
+		}
+		else {
+			// Steal heap allocation
+			mDataPtr = other.mDataPtr;
+			mSize = other.mSize;
+			mCapacity = other.mCapacity;
+			other.mDataPtr = other.inlineData();
+			other.mSize = 0;
+			other.mCapacity = N;
+		}
+	}
+
+	// Private members
+	// --------------------------------------------------------------------------------------------
+
+	T* mDataPtr = nullptr;
+	uint32_t mSize = 0;
+	uint32_t mCapacity = 0;
+	const char* mAllocationName = "ZeroG - SmallVector";
+	alignas(T) uint8_t mInlineStorage[N == 0 ? 1 : sizeof(T) * N];
+};
+
+} // namespace zg
@@ -21,8 +21,11 @@
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 
+#include "ZeroG.h"
 #include "ZeroG/util/Assert.hpp"
+#include "ZeroG/util/Vector.hpp"
 
 namespace zg {
 
@@ -50,4 +53,56 @@ inline void printfAppend(char*& str, uint32_t& bytesLeft, const char* format, ..
 	str += res;
 }
 
+// Copies the strings (which may be null) into storage and points the given string pointers to the
+// copies. Storage must be empty, it is allocated once with room for all strings so it can never
+// grow and invalidate the pointers.
+inline bool copyStrings(
+	Vector<char>& storage,
+	const char** strings[],
+	uint32_t numStrings,
+	const char* allocationName) noexcept
+{
+	uint32_t numBytes = 0;
+	for (uint32_t i = 0; i < numStrings; i++) {
+		if (*strings[i] != nullptr) numBytes += uint32_t(std::strlen(*strings[i])) + 1;
+	}
+	if (numBytes == 0) return true;
+	if (!storage.create(numBytes, allocationName)) return false;
+
+	for (uint32_t i = 0; i < numStrings; i++) {
+		const char* str = *strings[i];
+		if (str == nullptr) continue;
+		uint32_t len = uint32_t(std::strlen(str)) + 1;
+		uint32_t offset = storage.size();
+		storage.addMany(len);
+		std::memcpy(storage.data() + offset, str, len);
+		*strings[i] = storage.data() + offset;
+	}
+	return true;
+}
+
+inline const char* vertexAttributeTypeToString(ZgVertexAttributeType type) noexcept
+{
+	switch (type) {
+	case ZG_VERTEX_ATTRIBUTE_F32: return "ZG_VERTEX_ATTRIBUTE_F32";
+	case ZG_VERTEX_ATTRIBUTE_F32_2: return "ZG_VERTEX_ATTRIBUTE_F32_2";
+	case ZG_VERTEX_ATTRIBUTE_F32_3: return "ZG_VERTEX_ATTRIBUTE_F32_3";
+	case ZG_VERTEX_ATTRIBUTE_F32_4: return "ZG_VERTEX_ATTRIBUTE_F32_4";
+
+	case ZG_VERTEX_ATTRIBUTE_S32: return "ZG_VERTEX_ATTRIBUTE_S32";
+	case ZG_VERTEX_ATTRIBUTE_S32_2: return "ZG_VERTEX_ATTRIBUTE_S32_2";
+	case ZG_VERTEX_ATTRIBUTE_S32_3: return "ZG_VERTEX_ATTRIBUTE_S32_3";
+	case ZG_VERTEX_ATTRIBUTE_S32_4: return "ZG_VERTEX_ATTRIBUTE_S32_4";
+
+	case ZG_VERTEX_ATTRIBUTE_U32: return "ZG_VERTEX_ATTRIBUTE_U32";
+	case ZG_VERTEX_ATTRIBUTE_U32_2: return "ZG_VERTEX_ATTRIBUTE_U32_2";
+	case ZG_VERTEX_ATTRIBUTE_U32_3: return "ZG_VERTEX_ATTRIBUTE_U32_3";
+	case ZG_VERTEX_ATTRIBUTE_U32_4: return "ZG_VERTEX_ATTRIBUTE_U32_4";
+
+	default: break;
+	}
+	ZG_ASSERT(false);
+	return "";
+}
+
 } // namespace zg
@@ -28,6 +28,8 @@ namespace zg {
 // Vector
 // ------------------------------------------------------------------------------------------------
 
+// Vector with a fixed capacity set by create(), add() fails when it is full. Pointers to elements
+// are never invalidated by adding. See SmallVector for a growable alternative.
 template<typename T>
 class Vector final {
 public:
@@ -151,6 +153,7 @@ public:
 		}
 
 		mSize -= 1;
+		return true;
 	}
 
 	void clear() noexcept
@@ -293,6 +293,17 @@ public:
 		return ZG_WARNING_UNIMPLEMENTED;
 	}
 
+	ZgResult pipelineRenderCreateFromMemorySPIRV(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept override final
+	{
+		(void)pipelineOut;
+		(void)signatureOut;
+		(void)createInfo;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
 	ZgResult pipelineRenderCreateFromFileHLSL(
 		ZgPipelineRender** pipelineOut,
 		ZgPipelineRenderSignature* signatureOut,
@@ -315,6 +326,30 @@ public:
 		return ZG_WARNING_UNIMPLEMENTED;
 	}
 
+	ZgResult pipelineRenderCreateFromMemoryDXIL(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoMemoryDXIL& createInfo) noexcept override final
+	{
+		(void)pipelineOut;
+		(void)signatureOut;
+		(void)createInfo;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
+	ZgResult pipelineRenderCreateFromArchive(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoCommon& createInfo,
+		const ShaderArchivePipeline& pipeline) noexcept override final
+	{
+		(void)pipelineOut;
+		(void)signatureOut;
+		(void)createInfo;
+		(void)pipeline;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
 	ZgResult pipelineRenderRelease(
 		ZgPipelineRender* pipeline) noexcept override final
 	{
@@ -322,6 +357,15 @@ public:
 		return ZG_WARNING_UNIMPLEMENTED;
 	}
 
+	ZgResult pipelineRenderReplace(
+		ZgPipelineRender* pipeline,
+		ZgPipelineRender* replacement) noexcept override final
+	{
+		(void)pipeline;
+		(void)replacement;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
 	ZgResult pipelineRenderGetSignature(
 		const ZgPipelineRender* pipeline,
 		ZgPipelineRenderSignature* signatureOut) const noexcept override final
@@ -331,6 +375,15 @@ public:
 		return ZG_WARNING_UNIMPLEMENTED;
 	}
 
+	ZgResult pipelineRenderGetBytecodeHash(
+		const ZgPipelineRender* pipeline,
+		uint64_t& hashOut) const noexcept override final
+	{
+		(void)pipeline;
+		(void)hashOut;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
 	// Memory methods
 	// --------------------------------------------------------------------------------------------
 
@@ -350,6 +403,15 @@ public:
 		return ZG_WARNING_UNIMPLEMENTED;
 	}
 
+	ZgResult memoryHeapSetResidencyPriority(
+		ZgMemoryHeap* memoryHeap,
+		ZgResidencyPriority priority) noexcept override final
+	{
+		(void)memoryHeap;
+		(void)priority;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
 	ZgResult bufferMemcpyTo(
 		ZgBuffer* dstBufferInterface,
 		uint64_t bufferOffsetBytes,
@@ -363,6 +425,23 @@ public:
 		return ZG_WARNING_UNIMPLEMENTED;
 	}
 
+	ZgResult bufferReadFile(
+		ZgBuffer* dstBufferInterface,
+		uint64_t bufferOffsetBytes,
+		const char* path,
+		uint64_t fileOffsetBytes,
+		uint64_t numBytes,
+		ZgFileRead** fileReadOut) noexcept override final
+	{
+		(void)dstBufferInterface;
+		(void)bufferOffsetBytes;
+		(void)path;
+		(void)fileOffsetBytes;
+		(void)numBytes;
+		(void)fileReadOut;
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+
 	// Texture methods
 	// --------------------------------------------------------------------------------------------
 
@@ -346,52 +346,30 @@ static void realMain(SDL_Window* window) noexcept
 	// Fill texture with some random data
 	{
 		// Allocates images
-		ZgImageViewConstCpu imageLvl0 = allocateRgbaTex(256, 256);
-		ZgImageViewConstCpu imageLvl1 =
-			copyDownsample(imageLvl0.data, imageLvl0.width, imageLvl0.height);
-		ZgImageViewConstCpu imageLvl2 =
-			copyDownsample(imageLvl1.data, imageLvl1.width, imageLvl1.height);
-		ZgImageViewConstCpu imageLvl3 =
-			copyDownsample(imageLvl2.data, imageLvl2.width, imageLvl2.height);
-
-
-		// Create temporary upload buffer (accessible from CPU)
-		zg::MemoryHeap uploadHeapLvl0;
-		zg::Buffer uploadBufferLvl0;
-		allocateMemoryHeapAndBuffer(uploadHeapLvl0, uploadBufferLvl0,
-			ZG_MEMORY_TYPE_UPLOAD, textureAllocInfo.sizeInBytes);
-
-		zg::MemoryHeap uploadHeapLvl1;
-		zg::Buffer uploadBufferLvl1;
-		allocateMemoryHeapAndBuffer(uploadHeapLvl1, uploadBufferLvl1,
-			ZG_MEMORY_TYPE_UPLOAD, textureAllocInfo.sizeInBytes);
-
-		zg::MemoryHeap uploadHeapLvl2;
-		zg::Buffer uploadBufferLvl2;
-		allocateMemoryHeapAndBuffer(uploadHeapLvl2, uploadBufferLvl2,
-			ZG_MEMORY_TYPE_UPLOAD, textureAllocInfo.sizeInBytes);
-
-		zg::MemoryHeap uploadHeapLvl3;
-		zg::Buffer uploadBufferLvl3;
-		allocateMemoryHeapAndBuffer(uploadHeapLvl3, uploadBufferLvl3,
-			ZG_MEMORY_TYPE_UPLOAD, textureAllocInfo.sizeInBytes);
+		ZgImageViewConstCpu images[4] = {};
+		images[0] = allocateRgbaTex(256, 256);
+		for (uint32_t i = 1; i < 4; i++) {
+			images[i] = copyDownsample(images[i - 1].data, images[i - 1].width, images[i - 1].height);
+		}
+
+		// Create temporary upload buffer (accessible from CPU), all mip levels share it
+		zg::MemoryHeap uploadHeap;
+		zg::Buffer uploadBuffer;
+		allocateMemoryHeapAndBuffer(uploadHeap, uploadBuffer,
+			ZG_MEMORY_TYPE_UPLOAD, textureAllocInfo.uploadSizeInBytes);
 
 		// Copy to the texture
 		zg::CommandList commandList;
 		CHECK_ZG copyQueue.beginCommandListRecording(commandList);
-		CHECK_ZG commandList.memcpyToTexture(texture, 0, imageLvl0, uploadBufferLvl0);
-		CHECK_ZG commandList.memcpyToTexture(texture, 1, imageLvl1, uploadBufferLvl1);
-		CHECK_ZG commandList.memcpyToTexture(texture, 2, imageLvl2, uploadBufferLvl2);
-		CHECK_ZG commandList.memcpyToTexture(texture, 3, imageLvl3, uploadBufferLvl3);
+		CHECK_ZG commandList.memcpyToTextureMipChain(texture, images, 4, uploadBuffer);
 		CHECK_ZG commandList.enableQueueTransition(texture);
 		CHECK_ZG copyQueue.executeCommandList(commandList);
 		CHECK_ZG copyQueue.flush();
 
 		// Free images
-		delete[] imageLvl0.data;
-		delete[] imageLvl1.data;
-		delete[] imageLvl2.data;
-		delete[] imageLvl3.data;
+		for (uint32_t i = 0; i < 4; i++) {
+			delete[] images[i].data;
+		}
 	}
 
 	// Run our main loop
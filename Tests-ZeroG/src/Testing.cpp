@@ -0,0 +1,110 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include <atomic>
+#include <cstdio>
+
+#include "ZeroG/Context.hpp"
+#include "ZeroG/util/CpuAllocation.hpp"
+
+namespace zg {
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+struct TestCase final {
+	const char* name = nullptr;
+	void (*func)() noexcept = nullptr;
+};
+
+constexpr uint32_t MAX_NUM_TEST_CASES = 256;
+static TestCase testCases[MAX_NUM_TEST_CASES];
+static uint32_t numTestCases = 0;
+
+static std::atomic_uint32_t numFailedChecks = 0;
+static std::atomic_uint32_t numLogged[4] = {};
+
+static void testLog(
+	void* userPtr, const char* file, int line, ZgLogLevel level, const char* message) noexcept
+{
+	(void)userPtr;
+	numLogged[level] += 1;
+	if (level == ZG_LOG_LEVEL_ERROR) {
+		printf("    [logged error] -- [%s:%i]: %s\n", file, line, message);
+	}
+}
+
+// Test registration
+// ------------------------------------------------------------------------------------------------
+
+TestRegistration::TestRegistration(const char* name, void (*func)() noexcept) noexcept
+{
+	if (numTestCases >= MAX_NUM_TEST_CASES) {
+		printf("Too many test cases, can't register %s\n", name);
+		numFailedChecks += 1;
+		return;
+	}
+	testCases[numTestCases].name = name;
+	testCases[numTestCases].func = func;
+	numTestCases += 1;
+}
+
+void reportCheckFailure(const char* file, int line, const char* condition) noexcept
+{
+	numFailedChecks += 1;
+	printf("    CHECK FAILED -- [%s:%i]: %s\n", file, line, condition);
+	fflush(stdout);
+}
+
+// Test context
+// ------------------------------------------------------------------------------------------------
+
+uint32_t numLoggedMessages(ZgLogLevel level) noexcept
+{
+	return numLogged[level];
+}
+
+} // namespace zg
+
+// Main
+// ------------------------------------------------------------------------------------------------
+
+int main()
+{
+	uint32_t numFailedTestCases = 0;
+	for (uint32_t i = 0; i < zg::numTestCases; i++) {
+		const zg::TestCase& testCase = zg::testCases[i];
+
+		ZgContext context = {};
+		context.allocator = zg::getDefaultAllocator();
+		context.logger.log = zg::testLog;
+		zg::setContext(context);
+		for (std::atomic_uint32_t& numLogged : zg::numLogged) numLogged = 0;
+
+		printf("%s\n", testCase.name);
+		fflush(stdout);
+		uint32_t numFailedChecksBefore = zg::numFailedChecks;
+		testCase.func();
+		if (zg::numFailedChecks != numFailedChecksBefore) numFailedTestCases += 1;
+	}
+
+	printf("\n%u/%u test cases passed\n", zg::numTestCases - numFailedTestCases, zg::numTestCases);
+	return (numFailedTestCases == 0 && zg::numFailedChecks == 0) ? 0 : 1;
+}
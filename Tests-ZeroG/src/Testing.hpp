@@ -0,0 +1,64 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <cstdint>
+
+#include "ZeroG.h"
+
+// Minimal test framework
+// ------------------------------------------------------------------------------------------------
+
+// Each test executable consists of one or more test cases, all of which are run by the main()
+// in Testing.cpp. A failed CHECK() is reported but does not abort the test case.
+//
+// TEST_CASE(ringBufferWrapsAround)
+// {
+//     CHECK(1 + 1 == 2);
+// }
+
+#define TEST_CASE(name) \
+	static void name() noexcept; \
+	static zg::TestRegistration name##Registration(#name, name); \
+	static void name() noexcept
+
+#define CHECK(condition) \
+	do { if (!(condition)) zg::reportCheckFailure(__FILE__, __LINE__, #condition); } while (false)
+
+namespace zg {
+
+// Test registration
+// ------------------------------------------------------------------------------------------------
+
+struct TestRegistration final {
+	TestRegistration(const char* name, void (*func)() noexcept) noexcept;
+};
+
+void reportCheckFailure(const char* file, int line, const char* condition) noexcept;
+
+// Test context
+// ------------------------------------------------------------------------------------------------
+
+// Before each test case the implicit context is reset to the default allocator and a logger that
+// only counts messages (errors are also printed). Tests can replace parts of it as needed.
+
+// Number of messages of the specified level logged since the test case started
+uint32_t numLoggedMessages(ZgLogLevel level) noexcept;
+
+} // namespace zg
@@ -0,0 +1,128 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+// Random alloc/free churn of small allocations (16 to 527 bytes), each thread keeps up to 4096
+// allocations alive. Compares the system allocator, the default allocator and the default
+// allocator wrapped by the tracking allocator (ZgContextInitSettings::trackCpuAllocations).
+//
+// Usage: Bench-CpuAllocation [num operations per thread]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "ZeroG/util/CpuAllocation.hpp"
+
+using namespace zg;
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+constexpr uint32_t MAX_NUM_THREADS = 16;
+constexpr uint32_t NUM_LIVE_SLOTS = 4096;
+
+static void* systemAllocate(void* userPtr, uint32_t size, const char* name)
+{
+	(void)userPtr;
+	(void)name;
+#ifdef _WIN32
+	return _aligned_malloc(size, 32);
+#else
+	void* ptr = nullptr;
+	if (posix_memalign(&ptr, 32, size) != 0) return nullptr;
+	return ptr;
+#endif
+}
+
+static void systemDeallocate(void* userPtr, void* allocation)
+{
+	(void)userPtr;
+#ifdef _WIN32
+	_aligned_free(allocation);
+#else
+	free(allocation);
+#endif
+}
+
+static void churn(ZgAllocator allocator, uint32_t seed, uint32_t numOperations) noexcept
+{
+	void** live = reinterpret_cast<void**>(calloc(NUM_LIVE_SLOTS, sizeof(void*)));
+	uint32_t rng = 1234567u + seed;
+	for (uint32_t i = 0; i < numOperations; i++) {
+		rng = rng * 1664525u + 1013904223u;
+		uint32_t idx = (rng >> 8) & (NUM_LIVE_SLOTS - 1);
+		if (live[idx] != nullptr) {
+			allocator.deallocate(allocator.userPtr, live[idx]);
+			live[idx] = nullptr;
+		}
+		else {
+			uint32_t size = 16 + ((rng >> 20) & 511);
+			live[idx] = allocator.allocate(allocator.userPtr, size, "Bench-CpuAllocation");
+			std::memset(live[idx], 0xAB, 16);
+		}
+	}
+	for (uint32_t i = 0; i < NUM_LIVE_SLOTS; i++) {
+		allocator.deallocate(allocator.userPtr, live[i]);
+	}
+	free(live);
+}
+
+static double runMs(ZgAllocator allocator, uint32_t numThreads, uint32_t numOperations) noexcept
+{
+	auto begin = std::chrono::steady_clock::now();
+	std::thread threads[MAX_NUM_THREADS];
+	for (uint32_t i = 0; i < numThreads; i++) {
+		threads[i] = std::thread(churn, allocator, i, numOperations);
+	}
+	for (uint32_t i = 0; i < numThreads; i++) threads[i].join();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// Main
+// ------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+	uint32_t numOperations = 2000000;
+	if (argc > 1) numOperations = uint32_t(std::strtoul(argv[1], nullptr, 10));
+
+	ZgAllocator system = {};
+	system.allocate = systemAllocate;
+	system.deallocate = systemDeallocate;
+	ZgAllocator defaultAllocator = getDefaultAllocator();
+	ZgAllocator tracking = createTrackingAllocator(getDefaultAllocator());
+
+	printf("%u operations per thread, %u hardware threads\n",
+		numOperations, std::thread::hardware_concurrency());
+	printf("threads      system     default    default+tracking\n");
+	for (uint32_t numThreads : { 1u, 2u, 4u, 8u, 16u }) {
+		double systemMs = runMs(system, numThreads, numOperations);
+		double defaultMs = runMs(defaultAllocator, numThreads, numOperations);
+		double trackingMs = runMs(tracking, numThreads, numOperations);
+		printf("%7u  %7.1f ms  %7.1f ms  %7.1f ms\n",
+			numThreads, systemMs, defaultMs, trackingMs);
+	}
+	return 0;
+}
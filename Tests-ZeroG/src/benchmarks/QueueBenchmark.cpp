@@ -0,0 +1,133 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+// Throughput of MpmcQueue compared to a mutex protected RingBuffer, with N producer threads and
+// one consumer thread. Also measures single threaded RingBuffer add() + pop().
+//
+// Usage: Bench-Queues [num items per producer]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#include "ZeroG/util/MpmcQueue.hpp"
+#include "ZeroG/util/RingBuffer.hpp"
+
+using namespace zg;
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+constexpr uint32_t MAX_NUM_PRODUCERS = 16;
+constexpr uint32_t QUEUE_CAPACITY = 1024;
+
+template<typename AddFunc, typename PopFunc>
+static double runSeconds(
+	uint32_t numProducers, uint64_t numPerProducer, AddFunc add, PopFunc pop) noexcept
+{
+	const uint64_t numTotal = numProducers * numPerProducer;
+	uint64_t sum = 0;
+
+	auto begin = std::chrono::steady_clock::now();
+	std::thread producers[MAX_NUM_PRODUCERS];
+	for (uint32_t p = 0; p < numProducers; p++) {
+		producers[p] = std::thread([&, p]() {
+			for (uint64_t i = 0; i < numPerProducer; i++) {
+				while (!add(p * numPerProducer + i + 1)) std::this_thread::yield();
+			}
+		});
+	}
+	for (uint64_t numPopped = 0; numPopped < numTotal;) {
+		uint64_t value = 0;
+		if (pop(value)) {
+			sum += value;
+			numPopped += 1;
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+	for (uint32_t p = 0; p < numProducers; p++) producers[p].join();
+	auto end = std::chrono::steady_clock::now();
+
+	if (sum != numTotal * (numTotal + 1) / 2) {
+		printf("Error: Wrong sum of popped items\n");
+		exit(1);
+	}
+	return std::chrono::duration<double>(end - begin).count();
+}
+
+// Main
+// ------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+	uint64_t numPerProducer = 200000;
+	if (argc > 1) numPerProducer = std::strtoull(argv[1], nullptr, 10);
+
+	ZgContext context = {};
+	context.allocator = getDefaultAllocator();
+	setContext(context);
+
+	printf("%llu items per producer, 1 consumer, %u hardware threads\n",
+		(unsigned long long)numPerProducer, std::thread::hardware_concurrency());
+	printf("producers  MpmcQueue       mutex + RingBuffer\n");
+	for (uint32_t numProducers : { 1u, 2u, 4u, 8u, 16u }) {
+		MpmcQueue<uint64_t> queue;
+		queue.create(QUEUE_CAPACITY, "Bench-Queues");
+		double queueSecs = runSeconds(numProducers, numPerProducer,
+			[&](uint64_t value) { return queue.add(value); },
+			[&](uint64_t& value) { return queue.pop(value); });
+
+		RingBuffer<uint64_t> buffer(QUEUE_CAPACITY, "Bench-Queues");
+		std::mutex mutex;
+		double bufferSecs = runSeconds(numProducers, numPerProducer,
+			[&](uint64_t value) {
+				std::lock_guard<std::mutex> lock(mutex);
+				return buffer.add(value);
+			},
+			[&](uint64_t& value) {
+				std::lock_guard<std::mutex> lock(mutex);
+				return buffer.pop(value);
+			});
+
+		double numItems = double(numProducers * numPerProducer);
+		printf("%9u  %6.1f Mops/s  %6.1f Mops/s\n",
+			numProducers, numItems / queueSecs / 1e6, numItems / bufferSecs / 1e6);
+	}
+
+	// Single threaded RingBuffer, capacity is not a power of two
+	constexpr uint64_t NUM_SINGLE_THREADED = 50000000;
+	RingBuffer<uint64_t> buffer(1000, "Bench-Queues");
+	uint64_t sum = 0;
+	auto begin = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < NUM_SINGLE_THREADED; i++) {
+		buffer.add(i);
+		uint64_t value = 0;
+		buffer.pop(value);
+		sum += value;
+	}
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+	printf("RingBuffer add() + pop(): %.2f ns (checksum %llu)\n",
+		ns / double(NUM_SINGLE_THREADED), (unsigned long long)sum);
+	return 0;
+}
@@ -0,0 +1,131 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+// Cost of putting a pipeline's bindings in the same order as its mappings, which the D3D12 command
+// list does in setPipelineBindings(). Compares searching the bindings linearly for each mapping
+// with scattering them through a RegisterLookup, and orderBindingsByMapping() which picks between
+// the two. Bindings are given in register order and in reverse register order.
+//
+// Usage: Bench-RegisterLookup [num iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+
+#include "ZeroG/util/RegisterLookup.hpp"
+
+using namespace zg;
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+constexpr uint32_t MAX_NUM_MAPPINGS = 16;
+
+struct Binding final {
+	uint32_t shaderRegister = 0;
+	uint64_t value = 0;
+};
+
+#if defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+enum class Strategy {
+	LINEAR_SEARCH,
+	SCATTER,
+	BY_MAPPING
+};
+
+template<Strategy strategy>
+NOINLINE static uint64_t sumOrdered(
+	const RegisterLookup<MAX_NUM_MAPPINGS>& lookup,
+	const Binding* bindings,
+	uint32_t numBindings) noexcept
+{
+	auto getRegister = [](const Binding& binding) { return binding.shaderRegister; };
+	const Binding* ordered[MAX_NUM_MAPPINGS];
+	if (strategy == Strategy::LINEAR_SEARCH) {
+		orderBindingsLinearSearch(ordered, lookup, bindings, numBindings, getRegister);
+	}
+	else if (strategy == Strategy::SCATTER) {
+		orderBindingsScatter(ordered, lookup, bindings, numBindings, getRegister);
+	}
+	else {
+		orderBindingsByMapping(ordered, lookup, bindings, numBindings, getRegister);
+	}
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < lookup.numMappings; i++) {
+		if (ordered[i] != nullptr) sum += ordered[i]->value;
+	}
+	return sum;
+}
+
+template<typename Func>
+static double runNs(uint32_t numIterations, Binding* bindings, uint64_t& sum, Func func) noexcept
+{
+	auto begin = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < numIterations; i++) {
+		bindings[0].value = i;
+		sum += func();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - begin).count() / numIterations;
+}
+
+// Main
+// ------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+	uint32_t numIterations = 20000000;
+	if (argc > 1) numIterations = uint32_t(std::strtoul(argv[1], nullptr, 10));
+
+	printf("%u iterations\n", numIterations);
+	printf("bindings  order    linear search     scatter  orderBindingsByMapping\n");
+	uint64_t sum = 0;
+	for (uint32_t num : { 1u, 2u, 4u, 6u, 8u, 12u, 16u }) {
+		RegisterLookup<MAX_NUM_MAPPINGS> lookup;
+		for (uint32_t i = 0; i < num; i++) lookup.add(i);
+
+		for (bool reverse : { false, true }) {
+			Binding bindings[MAX_NUM_MAPPINGS];
+			for (uint32_t i = 0; i < num; i++) {
+				bindings[i].shaderRegister = reverse ? (num - 1 - i) : i;
+				bindings[i].value = i + 1;
+			}
+			double linearNs = runNs(numIterations, bindings, sum, [&]() {
+				return sumOrdered<Strategy::LINEAR_SEARCH>(lookup, bindings, num);
+			});
+			double scatterNs = runNs(numIterations, bindings, sum, [&]() {
+				return sumOrdered<Strategy::SCATTER>(lookup, bindings, num);
+			});
+			double combinedNs = runNs(numIterations, bindings, sum, [&]() {
+				return sumOrdered<Strategy::BY_MAPPING>(lookup, bindings, num);
+			});
+			printf("%8u  %-7s  %10.1f ns  %7.1f ns  %19.1f ns\n",
+				num, reverse ? "reverse" : "forward", linearNs, scatterNs, combinedNs);
+		}
+	}
+
+	// Print the sum so the work can't be optimized away
+	printf("(%llu)\n", (unsigned long long)(sum & 1));
+	return 0;
+}
@@ -0,0 +1,198 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "ZeroG/util/CpuAllocation.hpp"
+
+using namespace zg;
+
+// Helpers
+// ------------------------------------------------------------------------------------------------
+
+static ZgCpuAllocationTagStats findStats(const char* name) noexcept
+{
+	ZgCpuAllocationTagStats stats[ZG_MAX_NUM_CPU_ALLOCATION_TAGS] = {};
+	uint32_t numStats = 0;
+	getCpuAllocationStats(stats, ZG_MAX_NUM_CPU_ALLOCATION_TAGS, numStats);
+	for (uint32_t i = 0; i < numStats; i++) {
+		if (std::strcmp(stats[i].name, name) == 0) return stats[i];
+	}
+	return {};
+}
+
+// Default allocator
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(defaultAllocatorAlignmentAndSizes)
+{
+	ZgAllocator allocator = getDefaultAllocator();
+	constexpr uint32_t SIZES[] = { 1, 16, 31, 32, 33, 100, 1000, 2016, 2017, 4096, 1 << 20 };
+	void* ptrs[sizeof(SIZES) / sizeof(uint32_t)] = {};
+	for (uint32_t i = 0; i < sizeof(SIZES) / sizeof(uint32_t); i++) {
+		ptrs[i] = allocator.allocate(allocator.userPtr, SIZES[i], "Test");
+		CHECK(ptrs[i] != nullptr);
+		CHECK((uintptr_t(ptrs[i]) % 32) == 0);
+		std::memset(ptrs[i], int(i), SIZES[i]);
+	}
+	for (uint32_t i = 0; i < sizeof(SIZES) / sizeof(uint32_t); i++) {
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(ptrs[i]);
+		CHECK(bytes[0] == uint8_t(i) && bytes[SIZES[i] - 1] == uint8_t(i));
+		allocator.deallocate(allocator.userPtr, ptrs[i]);
+	}
+	allocator.deallocate(allocator.userPtr, nullptr);
+}
+
+TEST_CASE(defaultAllocatorReusesFreedBlocks)
+{
+	ZgAllocator allocator = getDefaultAllocator();
+	void* first = allocator.allocate(allocator.userPtr, 40, "Test");
+	allocator.deallocate(allocator.userPtr, first);
+	void* second = allocator.allocate(allocator.userPtr, 40, "Test");
+	CHECK(first == second);
+	allocator.deallocate(allocator.userPtr, second);
+}
+
+TEST_CASE(defaultAllocatorFreeOnOtherThread)
+{
+	// Blocks allocated on one thread and freed on another, including after the allocating thread
+	// has exited and destroyed its cache
+	ZgAllocator allocator = getDefaultAllocator();
+	constexpr uint32_t NUM_ALLOCS = 1000;
+	void* ptrs[NUM_ALLOCS] = {};
+	std::thread producer([&]() {
+		for (uint32_t i = 0; i < NUM_ALLOCS; i++) {
+			ptrs[i] = allocator.allocate(allocator.userPtr, 16 + (i % 500), "Test");
+		}
+	});
+	producer.join();
+	std::thread consumer([&]() {
+		for (uint32_t i = 0; i < NUM_ALLOCS; i++) {
+			CHECK(ptrs[i] != nullptr);
+			allocator.deallocate(allocator.userPtr, ptrs[i]);
+		}
+	});
+	consumer.join();
+}
+
+// Tracking allocator
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(trackingAllocatorAggregatesByName)
+{
+	ZgAllocator allocator = createTrackingAllocator(getDefaultAllocator());
+	CHECK(isTrackingAllocator(allocator));
+	CHECK(!isTrackingAllocator(getDefaultAllocator()));
+
+	void* a = allocator.allocate(allocator.userPtr, 100, "Tag A");
+	void* b = allocator.allocate(allocator.userPtr, 200, "Tag A");
+	void* c = allocator.allocate(allocator.userPtr, 50, "Tag B");
+	CHECK((uintptr_t(a) % 32) == 0 && (uintptr_t(b) % 32) == 0 && (uintptr_t(c) % 32) == 0);
+
+	// Same name through a different pointer ends up in the same tag
+	char nameCopy[] = "Tag A";
+	void* d = allocator.allocate(allocator.userPtr, 10, nameCopy);
+
+	ZgCpuAllocationTagStats statsA = findStats("Tag A");
+	CHECK(statsA.numLiveAllocations == 3);
+	CHECK(statsA.liveBytes == 310);
+	CHECK(statsA.totalNumAllocations == 3);
+	allocator.deallocate(allocator.userPtr, b);
+	allocator.deallocate(allocator.userPtr, d);
+	statsA = findStats("Tag A");
+	CHECK(statsA.numLiveAllocations == 1);
+	CHECK(statsA.liveBytes == 100);
+	CHECK(statsA.peakLiveBytes == 310);
+
+	ZgCpuAllocationTagStats statsB = findStats("Tag B");
+	CHECK(statsB.numLiveAllocations == 1 && statsB.liveBytes == 50);
+
+	uint32_t numStats = 0;
+	getCpuAllocationStats(nullptr, 0, numStats);
+	CHECK(numStats == 2);
+
+	allocator.deallocate(allocator.userPtr, a);
+	allocator.deallocate(allocator.userPtr, c);
+}
+
+TEST_CASE(trackingAllocatorOtherTag)
+{
+	ZgAllocator allocator = createTrackingAllocator(getDefaultAllocator());
+	constexpr uint32_t NUM_NAMES = ZG_MAX_NUM_CPU_ALLOCATION_TAGS + 10;
+	static char names[NUM_NAMES][16] = {};
+	void* ptrs[NUM_NAMES] = {};
+	for (uint32_t i = 0; i < NUM_NAMES; i++) {
+		snprintf(names[i], sizeof(names[i]), "Name %u", i);
+		ptrs[i] = allocator.allocate(allocator.userPtr, 8, names[i]);
+	}
+
+	uint32_t numStats = 0;
+	getCpuAllocationStats(nullptr, 0, numStats);
+	CHECK(numStats == ZG_MAX_NUM_CPU_ALLOCATION_TAGS);
+	ZgCpuAllocationTagStats other = findStats("Other");
+	CHECK(other.numLiveAllocations == NUM_NAMES - (ZG_MAX_NUM_CPU_ALLOCATION_TAGS - 1));
+
+	for (uint32_t i = 0; i < NUM_NAMES; i++) allocator.deallocate(allocator.userPtr, ptrs[i]);
+	CHECK(findStats("Other").liveBytes == 0);
+}
+
+TEST_CASE(trackingAllocatorResetIgnoresOldAllocations)
+{
+	ZgAllocator allocator = createTrackingAllocator(getDefaultAllocator());
+	void* old = allocator.allocate(allocator.userPtr, 64, "Tag A");
+	allocator = createTrackingAllocator(getDefaultAllocator());
+	void* current = allocator.allocate(allocator.userPtr, 32, "Tag A");
+	allocator.deallocate(allocator.userPtr, old);
+	ZgCpuAllocationTagStats stats = findStats("Tag A");
+	CHECK(stats.numLiveAllocations == 1 && stats.liveBytes == 32);
+	allocator.deallocate(allocator.userPtr, current);
+}
+
+TEST_CASE(trackingAllocatorConcurrent)
+{
+	ZgAllocator allocator = createTrackingAllocator(getDefaultAllocator());
+	constexpr uint32_t NUM_THREADS = 8;
+	constexpr uint32_t NUM_ITERATIONS = 20000;
+	static const char* const NAMES[4] = { "Tag 0", "Tag 1", "Tag 2", "Tag 3" };
+	std::thread threads[NUM_THREADS];
+	for (uint32_t t = 0; t < NUM_THREADS; t++) {
+		threads[t] = std::thread([&allocator, t]() {
+			void* live[4] = {};
+			for (uint32_t i = 0; i < NUM_ITERATIONS; i++) {
+				uint32_t idx = (i + t) % 4;
+				if (live[idx] != nullptr) allocator.deallocate(allocator.userPtr, live[idx]);
+				live[idx] = allocator.allocate(allocator.userPtr, 24, NAMES[idx]);
+			}
+			for (void* ptr : live) allocator.deallocate(allocator.userPtr, ptr);
+		});
+	}
+	for (std::thread& thread : threads) thread.join();
+
+	uint64_t totalNumAllocations = 0;
+	for (const char* name : NAMES) {
+		ZgCpuAllocationTagStats stats = findStats(name);
+		CHECK(stats.numLiveAllocations == 0 && stats.liveBytes == 0);
+		CHECK(stats.peakLiveBytes >= 24 && stats.peakLiveBytes <= 24 * NUM_THREADS);
+		totalNumAllocations += stats.totalNumAllocations;
+	}
+	CHECK(totalNumAllocations == uint64_t(NUM_THREADS) * NUM_ITERATIONS);
+}
@@ -0,0 +1,161 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include <atomic>
+
+#include "ZeroG/Context.hpp"
+#include "ZeroG/JobSystem.hpp"
+#include "ZeroG/util/CpuAllocation.hpp"
+
+using namespace zg;
+
+// Helpers
+// ------------------------------------------------------------------------------------------------
+
+// Wraps the default allocator, fails all allocations once the budget has run out
+struct FailingAllocator final {
+	std::atomic_int32_t numAllocationsLeft = 0;
+	std::atomic_int32_t numLive = 0;
+};
+
+static void* failingAllocate(void* userPtr, uint32_t size, const char* name)
+{
+	FailingAllocator& state = *reinterpret_cast<FailingAllocator*>(userPtr);
+	if (state.numAllocationsLeft.fetch_sub(1) <= 0) return nullptr;
+	state.numLive += 1;
+	ZgAllocator allocator = getDefaultAllocator();
+	return allocator.allocate(allocator.userPtr, size, name);
+}
+
+static void failingDeallocate(void* userPtr, void* allocation)
+{
+	if (allocation == nullptr) return;
+	FailingAllocator& state = *reinterpret_cast<FailingAllocator*>(userPtr);
+	state.numLive -= 1;
+	ZgAllocator allocator = getDefaultAllocator();
+	allocator.deallocate(allocator.userPtr, allocation);
+}
+
+struct SumData final {
+	std::atomic_uint64_t sum = 0;
+	std::atomic_uint32_t numCalls = 0;
+};
+
+static void addTaskIdx(void* taskData, uint32_t taskIdx)
+{
+	SumData& data = *reinterpret_cast<SumData*>(taskData);
+	data.sum += taskIdx;
+	data.numCalls += 1;
+}
+
+// Tests
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(jobSystemParallelFor)
+{
+	for (uint32_t numWorkerThreads : { 0u, 1u, 4u }) {
+		ZgJobSystemSettings settings = {};
+		settings.numWorkerThreads = numWorkerThreads;
+		JobSystem jobSystem;
+		CHECK(jobSystem.create(settings) == ZG_SUCCESS);
+		CHECK(jobSystem.numWorkerThreads() == numWorkerThreads);
+
+		for (uint32_t numTasks : { 0u, 1u, 2u, 100u, 10000u }) {
+			SumData data;
+			jobSystem.parallelFor(numTasks, addTaskIdx, &data);
+			CHECK(data.numCalls == numTasks);
+			CHECK(data.sum == uint64_t(numTasks) * (numTasks == 0 ? 0 : numTasks - 1) / 2);
+		}
+	}
+}
+
+TEST_CASE(jobSystemSubmitAndWait)
+{
+	ZgJobSystemSettings settings = {};
+	settings.numWorkerThreads = 3;
+	JobSystem jobSystem;
+	CHECK(jobSystem.create(settings) == ZG_SUCCESS);
+
+	SumData data;
+	std::atomic_uint32_t numRemaining = 0;
+	for (uint32_t i = 0; i < 1000; i++) jobSystem.submit(addTaskIdx, &data, numRemaining);
+	jobSystem.waitFor(numRemaining);
+	CHECK(numRemaining == 0);
+	CHECK(data.numCalls == 1000);
+}
+
+TEST_CASE(jobSystemNestedParallelFor)
+{
+	ZgJobSystemSettings settings = {};
+	settings.numWorkerThreads = 4;
+	JobSystem jobSystem;
+	CHECK(jobSystem.create(settings) == ZG_SUCCESS);
+
+	struct NestedData final {
+		JobSystem* jobSystem = nullptr;
+		SumData inner;
+	};
+	NestedData data;
+	data.jobSystem = &jobSystem;
+	jobSystem.parallelFor(16, [](void* taskData, uint32_t) {
+		NestedData& data = *reinterpret_cast<NestedData*>(taskData);
+		data.jobSystem->parallelFor(64, addTaskIdx, &data.inner);
+	}, &data);
+	CHECK(data.inner.numCalls == 16 * 64);
+	CHECK(data.inner.sum == 16 * (64 * 63 / 2));
+}
+
+TEST_CASE(jobSystemFailsCleanlyWhenOutOfMemory)
+{
+	FailingAllocator state;
+	ZgContext context = getContext();
+	context.allocator.userPtr = &state;
+	context.allocator.allocate = failingAllocate;
+	context.allocator.deallocate = failingDeallocate;
+	setContext(context);
+
+	// Worker list + (worker + deque) per worker thread
+	constexpr uint32_t NUM_WORKER_THREADS = 3;
+	constexpr int32_t NUM_ALLOCATIONS_NEEDED = 1 + 2 * NUM_WORKER_THREADS;
+
+	ZgJobSystemSettings settings = {};
+	settings.numWorkerThreads = NUM_WORKER_THREADS;
+	for (int32_t numAllocations = 0; numAllocations <= NUM_ALLOCATIONS_NEEDED; numAllocations++) {
+		state.numAllocationsLeft = numAllocations;
+		{
+			JobSystem jobSystem;
+			ZgResult res = jobSystem.create(settings);
+			if (numAllocations < NUM_ALLOCATIONS_NEEDED) {
+				CHECK(res == ZG_ERROR_CPU_OUT_OF_MEMORY);
+				CHECK(jobSystem.numWorkerThreads() == 0);
+			}
+			else {
+				CHECK(res == ZG_SUCCESS);
+				CHECK(jobSystem.numWorkerThreads() == NUM_WORKER_THREADS);
+			}
+
+			// Still usable, runs serially on the calling thread if creation failed
+			SumData data;
+			jobSystem.parallelFor(10, addTaskIdx, &data);
+			CHECK(data.numCalls == 10);
+		}
+		CHECK(state.numLive == 0);
+	}
+}
@@ -0,0 +1,163 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "ZeroG/PipelineCache.hpp"
+#include "ZeroG/util/Hash.hpp"
+
+using namespace zg;
+
+namespace fs = std::filesystem;
+
+// Helpers
+// ------------------------------------------------------------------------------------------------
+
+// Creates an empty directory for the cache, removed again when the test case ends
+struct TmpDirectory final {
+	char path[256] = {};
+
+	TmpDirectory(const char* name) noexcept
+	{
+		std::error_code ec;
+		std::snprintf(path, sizeof(path), "%s/%s",
+			fs::temp_directory_path(ec).string().c_str(), name);
+		fs::remove_all(path, ec);
+	}
+	~TmpDirectory() noexcept
+	{
+		std::error_code ec;
+		fs::remove_all(path, ec);
+	}
+};
+
+static bool writeFile(const char* path, const char* contents) noexcept
+{
+	std::FILE* file = std::fopen(path, "wb");
+	if (file == nullptr) return false;
+	bool success = std::fwrite(contents, std::strlen(contents), 1, file) == 1;
+	return std::fclose(file) == 0 && success;
+}
+
+static bool payloadEquals(const Vector<uint8_t>& payload, const char* expected) noexcept
+{
+	uint32_t size = uint32_t(std::strlen(expected));
+	return payload.size() == size && std::memcmp(payload.data(), expected, size) == 0;
+}
+
+// Tests
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(pipelineCacheDisabledWithoutDirectory)
+{
+	PipelineCache cache;
+	CHECK(cache.create({}) == ZG_SUCCESS);
+	CHECK(!cache.enabled());
+	cache.store(1, "abc", 3, nullptr, 0);
+	Vector<uint8_t> payload;
+	CHECK(!cache.load(1, payload));
+}
+
+TEST_CASE(pipelineCacheStoreLoadAndPersist)
+{
+	TmpDirectory dir("zg-test-pipeline-cache-persist");
+	ZgPipelineCacheSettings settings = {};
+	settings.directory = dir.path;
+
+	{
+		PipelineCache cache;
+		CHECK(cache.create(settings) == ZG_SUCCESS);
+		CHECK(cache.enabled());
+
+		Vector<uint8_t> payload;
+		CHECK(!cache.load(1, payload));
+		cache.store(1, "first", 5, nullptr, 0);
+		cache.store(2, "second", 6, nullptr, 0);
+		CHECK(cache.load(1, payload) && payloadEquals(payload, "first"));
+
+		// Replacing an entry
+		cache.store(1, "replaced", 8, nullptr, 0);
+		Vector<uint8_t> replaced;
+		CHECK(cache.load(1, replaced) && payloadEquals(replaced, "replaced"));
+
+		PipelineCacheStats stats = cache.stats();
+		CHECK(stats.numHits == 2 && stats.numMisses == 1 && stats.numEvictions == 0);
+	}
+
+	// Entries are found again by a new cache using the same directory
+	PipelineCache cache;
+	CHECK(cache.create(settings) == ZG_SUCCESS);
+	Vector<uint8_t> payload;
+	CHECK(cache.load(2, payload) && payloadEquals(payload, "second"));
+	CHECK(!cache.load(3, payload));
+}
+
+TEST_CASE(pipelineCacheDependencyChanged)
+{
+	TmpDirectory dir("zg-test-pipeline-cache-dependency");
+	ZgPipelineCacheSettings settings = {};
+	settings.directory = dir.path;
+	PipelineCache cache;
+	CHECK(cache.create(settings) == ZG_SUCCESS);
+
+	PipelineCacheDependency dependency;
+	std::snprintf(dependency.path, sizeof(dependency.path), "%s/include.hlsl", dir.path);
+	const char* INCLUDE_CONTENTS = "float4 color;";
+	CHECK(writeFile(dependency.path, INCLUDE_CONTENTS));
+	dependency.contentHash = hashBytes(INCLUDE_CONTENTS, std::strlen(INCLUDE_CONTENTS));
+	cache.store(7, "payload", 7, &dependency, 1);
+
+	Vector<uint8_t> payload;
+	CHECK(cache.load(7, payload) && payloadEquals(payload, "payload"));
+
+	CHECK(writeFile(dependency.path, "float3 color;"));
+	Vector<uint8_t> stale;
+	CHECK(!cache.load(7, stale));
+}
+
+TEST_CASE(pipelineCacheEvictsLeastRecentlyUsed)
+{
+	TmpDirectory dir("zg-test-pipeline-cache-evict");
+	constexpr uint32_t PAYLOAD_SIZE = 1000;
+	uint8_t payloadBytes[PAYLOAD_SIZE] = {};
+
+	// Room for two entries (header + payload), but not three
+	ZgPipelineCacheSettings settings = {};
+	settings.directory = dir.path;
+	settings.maxSizeBytes = 2 * PAYLOAD_SIZE + 200;
+	PipelineCache cache;
+	CHECK(cache.create(settings) == ZG_SUCCESS);
+
+	cache.store(1, payloadBytes, PAYLOAD_SIZE, nullptr, 0);
+	cache.store(2, payloadBytes, PAYLOAD_SIZE, nullptr, 0);
+	Vector<uint8_t> payload1;
+	CHECK(cache.load(1, payload1));
+	cache.store(3, payloadBytes, PAYLOAD_SIZE, nullptr, 0);
+
+	PipelineCacheStats stats = cache.stats();
+	CHECK(stats.numEvictions == 1);
+	CHECK(stats.sizeBytes <= settings.maxSizeBytes);
+	Vector<uint8_t> payload2, payload3, payload1Again;
+	CHECK(!cache.load(2, payload2));
+	CHECK(cache.load(3, payload3));
+	CHECK(cache.load(1, payload1Again));
+}
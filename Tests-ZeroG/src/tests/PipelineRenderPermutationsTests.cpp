@@ -0,0 +1,433 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "ZeroG/BackendInterface.hpp"
+#include "ZeroG/Context.hpp"
+#include "ZeroG/PipelineRenderPermutations.hpp"
+#include "ZeroG/util/CpuAllocation.hpp"
+#include "ZeroG/util/Hash.hpp"
+
+using namespace zg;
+
+// Mock backend
+// ------------------------------------------------------------------------------------------------
+
+// A "compiled" pipeline is just a hash of the defines or specialization constants it was created
+// with, in the order the backend received them
+struct MockPipeline final : ZgPipelineRender {
+	uint64_t inputHash = 0;
+	uint64_t bytecodeHash = 0;
+};
+
+// Only implements what permutations use, everything else fails. Defines named "FAIL" make the
+// compile fail, and defines named "UNUSED" don't change the resulting bytecode.
+struct MockBackend final : ZgBackend {
+	std::atomic_uint32_t numCompiles = 0;
+	std::atomic_int32_t numLivePipelines = 0;
+	std::atomic_bool blockCompiles = false;
+
+	ZgResult createPipeline(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		uint64_t inputHash,
+		uint64_t bytecodeHash) noexcept
+	{
+		MockPipeline* pipeline = zgNew<MockPipeline>("MockPipeline");
+		if (pipeline == nullptr) return ZG_ERROR_CPU_OUT_OF_MEMORY;
+		pipeline->inputHash = inputHash;
+		pipeline->bytecodeHash = bytecodeHash;
+		numLivePipelines += 1;
+		*pipelineOut = pipeline;
+		*signatureOut = {};
+		return ZG_SUCCESS;
+	}
+
+	void beginCompile() noexcept
+	{
+		numCompiles += 1;
+		while (blockCompiles) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	ZgResult swapchainResize(uint32_t, uint32_t) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult swapchainBeginFrame(ZgFramebuffer**) noexcept override { return ZG_ERROR_GENERIC; }
+	ZgResult swapchainFinishFrame() noexcept override { return ZG_ERROR_GENERIC; }
+	ZgResult fenceCreate(ZgFence**) noexcept override { return ZG_ERROR_GENERIC; }
+	ZgResult getStats(ZgStats&) noexcept override { return ZG_ERROR_GENERIC; }
+
+	ZgResult pipelineRenderCreateFromFileSPIRV(ZgPipelineRender**, ZgPipelineRenderSignature*,
+		const ZgPipelineRenderCreateInfoFileSPIRV&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult pipelineRenderCreateFromMemorySPIRV(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoMemorySPIRV& createInfo) noexcept override
+	{
+		beginCompile();
+		uint64_t hash = HASH_SEED;
+		for (uint32_t i = 0; i < createInfo.numSpecializationConstants; i++) {
+			hash = hashValue(createInfo.specializationConstants[i].constantId, hash);
+			hash = hashValue(createInfo.specializationConstants[i].value, hash);
+		}
+		return createPipeline(pipelineOut, signatureOut, hash, hash);
+	}
+	ZgResult pipelineRenderCreateFromFileHLSL(ZgPipelineRender**, ZgPipelineRenderSignature*,
+		const ZgPipelineRenderCreateInfoFileHLSL&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult pipelineRenderCreateFromSourceHLSL(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoSourceHLSL& createInfo) noexcept override
+	{
+		beginCompile();
+		uint64_t inputHash = hashString(createInfo.vertexShaderSrc);
+		uint64_t bytecodeHash = inputHash;
+		for (uint32_t i = 0; i < createInfo.numDefines; i++) {
+			const ZgShaderDefine& define = createInfo.defines[i];
+			if (std::strcmp(define.name, "FAIL") == 0) return ZG_ERROR_SHADER_COMPILE_ERROR;
+			const char* value = define.value == nullptr ? "1" : define.value;
+			inputHash = hashString(value, hashString(define.name, inputHash));
+			if (std::strcmp(define.name, "UNUSED") == 0) continue;
+			bytecodeHash = hashString(value, hashString(define.name, bytecodeHash));
+		}
+		return createPipeline(pipelineOut, signatureOut, inputHash, bytecodeHash);
+	}
+	ZgResult pipelineRenderCreateFromMemoryDXIL(ZgPipelineRender**, ZgPipelineRenderSignature*,
+		const ZgPipelineRenderCreateInfoMemoryDXIL&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult pipelineRenderCreateFromArchive(ZgPipelineRender**, ZgPipelineRenderSignature*,
+		const ZgPipelineRenderCreateInfoCommon&, const ShaderArchivePipeline&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult pipelineRenderRelease(ZgPipelineRender* pipeline) noexcept override
+	{
+		numLivePipelines -= 1;
+		zgDelete(pipeline);
+		return ZG_SUCCESS;
+	}
+	ZgResult pipelineRenderReplace(ZgPipelineRender*, ZgPipelineRender*) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult pipelineRenderGetSignature(
+		const ZgPipelineRender*, ZgPipelineRenderSignature*) const noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult pipelineRenderGetBytecodeHash(
+		const ZgPipelineRender* pipeline, uint64_t& hashOut) const noexcept override
+	{
+		hashOut = static_cast<const MockPipeline*>(pipeline)->bytecodeHash;
+		return ZG_SUCCESS;
+	}
+
+	ZgResult memoryHeapCreate(ZgMemoryHeap**, const ZgMemoryHeapCreateInfo&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult memoryHeapRelease(ZgMemoryHeap*) noexcept override { return ZG_ERROR_GENERIC; }
+	ZgResult memoryHeapSetResidencyPriority(
+		ZgMemoryHeap*, ZgResidencyPriority) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult bufferMemcpyTo(ZgBuffer*, uint64_t, const uint8_t*, uint64_t) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult bufferReadFile(ZgBuffer*, uint64_t, const char*, uint64_t, uint64_t,
+		ZgFileRead**) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult texture2DGetAllocationInfo(
+		ZgTexture2DAllocationInfo&, const ZgTexture2DCreateInfo&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult framebufferCreate(ZgFramebuffer**, const ZgFramebufferCreateInfo&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	void framebufferRelease(ZgFramebuffer*) noexcept override {}
+	ZgResult getPresentQueue(ZgCommandQueue**) noexcept override { return ZG_ERROR_GENERIC; }
+	ZgResult getCopyQueue(ZgCommandQueue**) noexcept override { return ZG_ERROR_GENERIC; }
+};
+
+// Helpers
+// ------------------------------------------------------------------------------------------------
+
+static MockBackend* setMockBackend() noexcept
+{
+	MockBackend* backend = zgNew<MockBackend>("MockBackend");
+	ZgContext context = getContext();
+	context.backend = backend;
+	setContext(context);
+	return backend;
+}
+
+static ZgPipelineRenderCreateInfoSourceHLSL baseCreateInfoHLSL() noexcept
+{
+	ZgPipelineRenderCreateInfoSourceHLSL createInfo = {};
+	createInfo.common.vertexShaderEntry = "VSMain";
+	createInfo.common.pixelShaderEntry = "PSMain";
+	createInfo.vertexShaderSrc = "float4 VSMain() { return 0; }";
+	createInfo.pixelShaderSrc = "float4 PSMain() { return 0; }";
+	createInfo.shaderModel = ZG_SHADER_MODEL_6_0;
+	createInfo.numDefines = 1;
+	createInfo.defines[0] = { "BASE", "1" };
+	return createInfo;
+}
+
+static ZgPipelineRenderPermutation definesPermutation(
+	const ZgShaderDefine* defines, uint32_t numDefines) noexcept
+{
+	ZgPipelineRenderPermutation permutation = {};
+	permutation.numDefines = numDefines;
+	for (uint32_t i = 0; i < numDefines; i++) {
+		permutation.defines[i] = defines[i];
+	}
+	return permutation;
+}
+
+// Tests
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(pipelineRenderPermutationsSameKeySamePipeline)
+{
+	MockBackend* backend = setMockBackend();
+	{
+		ZgPipelineRenderPermutations permutations;
+		CHECK(permutations.createFromSourceHLSL(baseCreateInfoHLSL()) == ZG_SUCCESS);
+
+		const ZgShaderDefine defines[] = { { "SHADOWS", "1" } };
+		ZgPipelineRenderPermutation permutation = definesPermutation(defines, 1);
+		ZgPipelineRender* pipelines[2] = {};
+		ZgPipelineRenderSignature signature = {};
+		CHECK(permutations.get(&permutation, &pipelines[0], &signature) == ZG_SUCCESS);
+		CHECK(permutations.get(&permutation, &pipelines[1], &signature) == ZG_SUCCESS);
+		CHECK(pipelines[0] != nullptr && pipelines[0] == pipelines[1]);
+		CHECK(backend->numCompiles == 1);
+
+		// No permutation is the base create info, a different key
+		ZgPipelineRender* basePipeline = nullptr;
+		CHECK(permutations.get(nullptr, &basePipeline, &signature) == ZG_SUCCESS);
+		CHECK(basePipeline != nullptr && basePipeline != pipelines[0]);
+		CHECK(backend->numCompiles == 2);
+
+		ZgPipelineRenderPermutationsStats stats = permutations.stats();
+		CHECK(stats.numPermutations == 2);
+		CHECK(stats.numFailedPermutations == 0);
+		CHECK(stats.numPipelines == 2);
+		CHECK(backend->numLivePipelines == 2);
+	}
+
+	// The set owns its pipelines
+	CHECK(backend->numLivePipelines == 0);
+	zgDelete(backend);
+}
+
+TEST_CASE(pipelineRenderPermutationsDefineOrderIndependent)
+{
+	MockBackend* backend = setMockBackend();
+	{
+		ZgPipelineRenderPermutations permutations;
+		CHECK(permutations.createFromSourceHLSL(baseCreateInfoHLSL()) == ZG_SUCCESS);
+
+		const ZgShaderDefine definesAB[] = { { "A", "1" }, { "B", "2" } };
+		const ZgShaderDefine definesBA[] = { { "B", "2" }, { "A", "1" } };
+		ZgPipelineRenderPermutation permutationAB = definesPermutation(definesAB, 2);
+		ZgPipelineRenderPermutation permutationBA = definesPermutation(definesBA, 2);
+		ZgPipelineRender* pipelineAB = nullptr;
+		ZgPipelineRender* pipelineBA = nullptr;
+		ZgPipelineRenderSignature signature = {};
+		CHECK(permutations.get(&permutationAB, &pipelineAB, &signature) == ZG_SUCCESS);
+		CHECK(permutations.get(&permutationBA, &pipelineBA, &signature) == ZG_SUCCESS);
+		CHECK(pipelineAB != nullptr && pipelineAB == pipelineBA);
+		CHECK(backend->numCompiles == 1);
+		CHECK(permutations.stats().numPermutations == 1);
+
+		// Redefining a base define with its own value is the same permutation as not doing so
+		const ZgShaderDefine definesBase[] = { { "B", "2" }, { "BASE", "1" }, { "A", "1" } };
+		ZgPipelineRenderPermutation permutationBase = definesPermutation(definesBase, 3);
+		ZgPipelineRender* pipelineBase = nullptr;
+		CHECK(permutations.get(&permutationBase, &pipelineBase, &signature) == ZG_SUCCESS);
+		CHECK(pipelineBase == pipelineAB);
+
+		// A different value is a different permutation
+		const ZgShaderDefine definesOther[] = { { "B", "3" }, { "A", "1" } };
+		ZgPipelineRenderPermutation permutationOther = definesPermutation(definesOther, 2);
+		ZgPipelineRender* pipelineOther = nullptr;
+		CHECK(permutations.get(&permutationOther, &pipelineOther, &signature) == ZG_SUCCESS);
+		CHECK(pipelineOther != nullptr && pipelineOther != pipelineAB);
+		CHECK(backend->numCompiles == 2);
+	}
+	zgDelete(backend);
+}
+
+TEST_CASE(pipelineRenderPermutationsSpecializationConstantOrderIndependent)
+{
+	MockBackend* backend = setMockBackend();
+	{
+		const uint32_t spirv[] = { 0x07230203, 0x00010000 };
+		ZgPipelineRenderCreateInfoMemorySPIRV createInfo = {};
+		createInfo.common.vertexShaderEntry = "main";
+		createInfo.common.pixelShaderEntry = "main";
+		createInfo.vertexShaderSpirv = spirv;
+		createInfo.vertexShaderSpirvSizeBytes = sizeof(spirv);
+		createInfo.pixelShaderSpirv = spirv;
+		createInfo.pixelShaderSpirvSizeBytes = sizeof(spirv);
+
+		ZgPipelineRenderPermutations permutations;
+		CHECK(permutations.createFromMemorySPIRV(createInfo) == ZG_SUCCESS);
+
+		ZgPipelineRenderPermutation permutation12 = {};
+		permutation12.numSpecializationConstants = 2;
+		permutation12.specializationConstants[0] = { 1, 10 };
+		permutation12.specializationConstants[1] = { 2, 20 };
+		ZgPipelineRenderPermutation permutation21 = {};
+		permutation21.numSpecializationConstants = 2;
+		permutation21.specializationConstants[0] = { 2, 20 };
+		permutation21.specializationConstants[1] = { 1, 10 };
+
+		ZgPipelineRender* pipeline12 = nullptr;
+		ZgPipelineRender* pipeline21 = nullptr;
+		ZgPipelineRenderSignature signature = {};
+		CHECK(permutations.get(&permutation12, &pipeline12, &signature) == ZG_SUCCESS);
+		CHECK(permutations.get(&permutation21, &pipeline21, &signature) == ZG_SUCCESS);
+		CHECK(pipeline12 != nullptr && pipeline12 == pipeline21);
+		CHECK(backend->numCompiles == 1);
+	}
+	zgDelete(backend);
+}
+
+TEST_CASE(pipelineRenderPermutationsSharePipelinesWithSameBytecode)
+{
+	MockBackend* backend = setMockBackend();
+	{
+		ZgPipelineRenderPermutations permutations;
+		CHECK(permutations.createFromSourceHLSL(baseCreateInfoHLSL()) == ZG_SUCCESS);
+
+		// Different keys, but the define doesn't affect the compiled shaders
+		const ZgShaderDefine defines0[] = { { "UNUSED", "0" } };
+		const ZgShaderDefine defines1[] = { { "UNUSED", "1" } };
+		ZgPipelineRenderPermutation permutation0 = definesPermutation(defines0, 1);
+		ZgPipelineRenderPermutation permutation1 = definesPermutation(defines1, 1);
+		ZgPipelineRender* pipeline0 = nullptr;
+		ZgPipelineRender* pipeline1 = nullptr;
+		ZgPipelineRenderSignature signature = {};
+		CHECK(permutations.get(&permutation0, &pipeline0, &signature) == ZG_SUCCESS);
+		CHECK(permutations.get(&permutation1, &pipeline1, &signature) == ZG_SUCCESS);
+		CHECK(pipeline0 != nullptr && pipeline0 == pipeline1);
+		CHECK(backend->numCompiles == 2);
+
+		// The duplicate was released
+		ZgPipelineRenderPermutationsStats stats = permutations.stats();
+		CHECK(stats.numPermutations == 2);
+		CHECK(stats.numPipelines == 1);
+		CHECK(backend->numLivePipelines == 1);
+	}
+	CHECK(backend->numLivePipelines == 0);
+	zgDelete(backend);
+}
+
+TEST_CASE(pipelineRenderPermutationsFailuresAreCached)
+{
+	MockBackend* backend = setMockBackend();
+	{
+		ZgPipelineRenderPermutations permutations;
+		CHECK(permutations.createFromSourceHLSL(baseCreateInfoHLSL()) == ZG_SUCCESS);
+
+		const ZgShaderDefine defines[] = { { "FAIL", nullptr } };
+		ZgPipelineRenderPermutation permutation = definesPermutation(defines, 1);
+		ZgPipelineRender* pipeline = nullptr;
+		ZgPipelineRenderSignature signature = {};
+		CHECK(permutations.get(&permutation, &pipeline, &signature) ==
+			ZG_ERROR_SHADER_COMPILE_ERROR);
+		CHECK(backend->numCompiles == 1);
+
+		// Not compiled again
+		CHECK(permutations.get(&permutation, &pipeline, &signature) ==
+			ZG_ERROR_SHADER_COMPILE_ERROR);
+		CHECK(backend->numCompiles == 1);
+		CHECK(pipeline == nullptr);
+
+		ZgPipelineRenderPermutationsStats stats = permutations.stats();
+		CHECK(stats.numPermutations == 1);
+		CHECK(stats.numFailedPermutations == 1);
+		CHECK(stats.numPipelines == 0);
+
+		// Other permutations are unaffected
+		CHECK(permutations.get(nullptr, &pipeline, &signature) == ZG_SUCCESS);
+		CHECK(pipeline != nullptr);
+		CHECK(backend->numCompiles == 2);
+	}
+	zgDelete(backend);
+}
+
+TEST_CASE(pipelineRenderPermutationsConcurrentRequestsCompileOnce)
+{
+	MockBackend* backend = setMockBackend();
+	{
+		ZgPipelineRenderPermutations permutations;
+		CHECK(permutations.createFromSourceHLSL(baseCreateInfoHLSL()) == ZG_SUCCESS);
+
+		const ZgShaderDefine defines[] = { { "SHADOWS", "1" } };
+		const ZgPipelineRenderPermutation permutation = definesPermutation(defines, 1);
+
+		// Hold the first compile until the second thread has had time to request the same key
+		backend->blockCompiles = true;
+		constexpr uint32_t NUM_THREADS = 2;
+		ZgPipelineRender* pipelines[NUM_THREADS] = {};
+		ZgResult results[NUM_THREADS] = { ZG_ERROR_GENERIC, ZG_ERROR_GENERIC };
+		auto request = [&](uint32_t idx) {
+			ZgPipelineRenderSignature signature = {};
+			results[idx] = permutations.get(&permutation, &pipelines[idx], &signature);
+		};
+		std::thread first(request, 0);
+		while (backend->numCompiles == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		std::thread second(request, 1);
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		backend->blockCompiles = false;
+		first.join();
+		second.join();
+
+		CHECK(results[0] == ZG_SUCCESS && results[1] == ZG_SUCCESS);
+		CHECK(pipelines[0] != nullptr && pipelines[0] == pipelines[1]);
+		CHECK(backend->numCompiles == 1);
+		CHECK(permutations.stats().numPermutations == 1);
+		CHECK(backend->numLivePipelines == 1);
+	}
+	zgDelete(backend);
+}
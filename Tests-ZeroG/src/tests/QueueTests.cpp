@@ -0,0 +1,187 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include <atomic>
+#include <thread>
+
+#include "ZeroG/util/MpmcQueue.hpp"
+#include "ZeroG/util/RingBuffer.hpp"
+
+using namespace zg;
+
+// Helpers
+// ------------------------------------------------------------------------------------------------
+
+// Counts the number of live instances, to check that destructors are called
+struct Counted final {
+	static int numAlive;
+	uint32_t value = 0;
+	Counted() noexcept { numAlive += 1; }
+	Counted(uint32_t value) noexcept : value(value) { numAlive += 1; }
+	Counted(const Counted& other) noexcept : value(other.value) { numAlive += 1; }
+	Counted& operator= (const Counted& other) noexcept { value = other.value; return *this; }
+	~Counted() noexcept { numAlive -= 1; }
+};
+int Counted::numAlive = 0;
+
+// RingBuffer
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(ringBufferKeepsRequestedCapacity)
+{
+	for (uint32_t capacity : { 1u, 3u, 4u, 5u, 100u, 1000u }) {
+		RingBuffer<uint32_t> buffer(capacity, "Test");
+		CHECK(buffer.capacity() == capacity);
+		for (uint32_t i = 0; i < capacity; i++) CHECK(buffer.add(i));
+		CHECK(buffer.size() == capacity);
+		CHECK(!buffer.add(capacity));
+		CHECK(!buffer.addFirst(capacity));
+		for (uint32_t i = 0; i < capacity; i++) CHECK(buffer[i] == i);
+	}
+
+	RingBuffer<uint32_t> empty;
+	CHECK(empty.capacity() == 0);
+	CHECK(!empty.add(1));
+	CHECK(!empty.addFirst(1));
+	CHECK(!empty.pop());
+}
+
+TEST_CASE(ringBufferWrapsAround)
+{
+	RingBuffer<uint32_t> buffer(5, "Test");
+	uint32_t nextAdd = 0;
+	uint32_t nextPop = 0;
+	for (uint32_t i = 0; i < 1000; i++) {
+		while (buffer.add(nextAdd)) nextAdd += 1;
+		CHECK(buffer.size() == 5);
+		CHECK(buffer.first() == nextPop && buffer.last() == nextAdd - 1);
+		uint32_t numToPop = 1 + (i % 5);
+		for (uint32_t j = 0; j < numToPop; j++) {
+			uint32_t value = ~0u;
+			CHECK(buffer.pop(value));
+			CHECK(value == nextPop);
+			nextPop += 1;
+		}
+	}
+}
+
+TEST_CASE(ringBufferBothEnds)
+{
+	RingBuffer<uint32_t> buffer(3, "Test");
+	CHECK(buffer.add(2));
+	CHECK(buffer.addFirst(1));
+	CHECK(buffer.add(3));
+	CHECK(!buffer.addFirst(0));
+	CHECK(buffer[0] == 1 && buffer[1] == 2 && buffer[2] == 3);
+
+	uint32_t value = 0;
+	CHECK(buffer.popLast(value) && value == 3);
+	CHECK(buffer.pop(value) && value == 1);
+	CHECK(buffer.popLast(value) && value == 2);
+	CHECK(!buffer.pop(value) && !buffer.popLast(value));
+}
+
+TEST_CASE(ringBufferDestroysElements)
+{
+	{
+		RingBuffer<Counted> buffer(6, "Test");
+		for (uint32_t i = 0; i < 6; i++) CHECK(buffer.add(Counted(i)));
+		CHECK(Counted::numAlive == 6);
+		CHECK(buffer.pop());
+		CHECK(buffer.popLast());
+		CHECK(Counted::numAlive == 4);
+
+		RingBuffer<Counted> other = std::move(buffer);
+		CHECK(other.size() == 4 && other.capacity() == 6);
+		CHECK(buffer.size() == 0 && buffer.capacity() == 0);
+		CHECK(other.first().value == 1 && other.last().value == 4);
+	}
+	CHECK(Counted::numAlive == 0);
+}
+
+// MpmcQueue
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(mpmcQueueSingleThread)
+{
+	MpmcQueue<uint32_t> queue;
+	CHECK(queue.capacity() == 0);
+	CHECK(!queue.add(1));
+
+	CHECK(queue.create(5, "Test"));
+	CHECK(queue.capacity() == 8);
+	for (uint32_t i = 0; i < 8; i++) CHECK(queue.add(i));
+	CHECK(!queue.add(8));
+	CHECK(queue.size() == 8);
+
+	for (uint32_t lap = 0; lap < 100; lap++) {
+		for (uint32_t i = 0; i < 8; i++) {
+			uint32_t value = ~0u;
+			CHECK(queue.pop(value));
+			CHECK(value == lap * 8 + i);
+			CHECK(queue.add((lap + 1) * 8 + i));
+		}
+	}
+
+	queue.destroy();
+	CHECK(queue.capacity() == 0);
+	CHECK(!queue.pop());
+}
+
+TEST_CASE(mpmcQueueMultipleProducersAndConsumers)
+{
+	constexpr uint32_t NUM_PRODUCERS = 4;
+	constexpr uint32_t NUM_CONSUMERS = 4;
+	constexpr uint64_t NUM_PER_PRODUCER = 50000;
+	constexpr uint64_t NUM_TOTAL = NUM_PRODUCERS * NUM_PER_PRODUCER;
+
+	MpmcQueue<uint64_t> queue;
+	CHECK(queue.create(64, "Test"));
+
+	std::atomic_uint64_t sum = 0;
+	std::atomic_uint64_t numPopped = 0;
+	std::thread threads[NUM_PRODUCERS + NUM_CONSUMERS];
+	for (uint32_t p = 0; p < NUM_PRODUCERS; p++) {
+		threads[p] = std::thread([&queue, p]() {
+			for (uint64_t i = 0; i < NUM_PER_PRODUCER; i++) {
+				while (!queue.add(p * NUM_PER_PRODUCER + i + 1)) std::this_thread::yield();
+			}
+		});
+	}
+	for (uint32_t c = 0; c < NUM_CONSUMERS; c++) {
+		threads[NUM_PRODUCERS + c] = std::thread([&]() {
+			while (numPopped.load() < NUM_TOTAL) {
+				uint64_t value = 0;
+				if (queue.pop(value)) {
+					sum += value;
+					numPopped += 1;
+				}
+				else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads) thread.join();
+
+	CHECK(numPopped.load() == NUM_TOTAL);
+	CHECK(sum.load() == NUM_TOTAL * (NUM_TOTAL + 1) / 2);
+	CHECK(queue.size() == 0);
+}
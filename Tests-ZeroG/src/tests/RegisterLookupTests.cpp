@@ -0,0 +1,122 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include "ZeroG/util/RegisterLookup.hpp"
+
+using namespace zg;
+
+// Helpers
+// ------------------------------------------------------------------------------------------------
+
+struct Binding final {
+	uint32_t shaderRegister = 0;
+};
+
+static uint32_t getRegister(const Binding& binding) noexcept { return binding.shaderRegister; }
+
+// Tests
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(registerLookupFind)
+{
+	RegisterLookup<4> lookup;
+	CHECK(lookup.find(0) == REGISTER_LOOKUP_NO_MAPPING);
+
+	lookup.add(3);
+	lookup.add(0);
+	CHECK(lookup.numMappings == 2);
+	CHECK(lookup.find(3) == 0);
+	CHECK(lookup.find(0) == 1);
+	CHECK(lookup.find(1) == REGISTER_LOOKUP_NO_MAPPING);
+	CHECK(lookup.find(REGISTER_LOOKUP_TABLE_SIZE - 1) == REGISTER_LOOKUP_NO_MAPPING);
+
+	lookup.clear();
+	CHECK(lookup.numMappings == 0);
+	CHECK(lookup.find(3) == REGISTER_LOOKUP_NO_MAPPING);
+	CHECK(lookup.find(0) == REGISTER_LOOKUP_NO_MAPPING);
+}
+
+TEST_CASE(registerLookupHighRegisters)
+{
+	// Registers outside the table must still be found
+	RegisterLookup<4> lookup;
+	lookup.add(REGISTER_LOOKUP_TABLE_SIZE);
+	lookup.add(2);
+	lookup.add(1000);
+	lookup.add(~0u - 1);
+	CHECK(lookup.numHighRegisters == 3);
+	CHECK(lookup.find(REGISTER_LOOKUP_TABLE_SIZE) == 0);
+	CHECK(lookup.find(2) == 1);
+	CHECK(lookup.find(1000) == 2);
+	CHECK(lookup.find(~0u - 1) == 3);
+	CHECK(lookup.find(999) == REGISTER_LOOKUP_NO_MAPPING);
+	CHECK(lookup.find(~0u) == REGISTER_LOOKUP_NO_MAPPING);
+
+	lookup.clear();
+	CHECK(lookup.numHighRegisters == 0);
+	CHECK(lookup.find(1000) == REGISTER_LOOKUP_NO_MAPPING);
+}
+
+TEST_CASE(registerLookupOrderBindings)
+{
+	RegisterLookup<4> lookup;
+	lookup.add(5);
+	lookup.add(100);
+	lookup.add(0);
+	lookup.add(7);
+
+	// Out of order, one unused register, one mapping without binding and a duplicate
+	Binding bindings[5];
+	bindings[0].shaderRegister = 0;
+	bindings[1].shaderRegister = 3;
+	bindings[2].shaderRegister = 100;
+	bindings[3].shaderRegister = 5;
+	bindings[4].shaderRegister = 0;
+
+	// Both strategies must give the same result, orderBindingsByMapping() picks one of them
+	for (uint32_t strategy = 0; strategy < 2; strategy++) {
+		const Binding* ordered[4] = {};
+		for (uint32_t i = 0; i < 4; i++) ordered[i] = &bindings[1]; // Garbage, must be overwritten
+		if (strategy == 0) orderBindingsLinearSearch(ordered, lookup, bindings, 5, getRegister);
+		else orderBindingsScatter(ordered, lookup, bindings, 5, getRegister);
+		CHECK(ordered[0] == &bindings[3]);
+		CHECK(ordered[1] == &bindings[2]);
+		CHECK(ordered[2] == &bindings[0]); // First binding of a register is used
+		CHECK(ordered[3] == nullptr);
+
+		if (strategy == 0) orderBindingsLinearSearch(ordered, lookup, bindings, 0, getRegister);
+		else orderBindingsScatter(ordered, lookup, bindings, 0, getRegister);
+		for (uint32_t i = 0; i < 4; i++) CHECK(ordered[i] == nullptr);
+	}
+}
+
+TEST_CASE(registerLookupOrderManyBindings)
+{
+	// Enough bindings that orderBindingsByMapping() scatters them through the lookup
+	constexpr uint32_t NUM = 16;
+	RegisterLookup<NUM> lookup;
+	for (uint32_t i = 0; i < NUM; i++) lookup.add(NUM - 1 - i);
+	Binding bindings[NUM];
+	for (uint32_t i = 0; i < NUM; i++) bindings[i].shaderRegister = i;
+
+	const Binding* ordered[NUM] = {};
+	orderBindingsByMapping(ordered, lookup, bindings, NUM, getRegister);
+	for (uint32_t i = 0; i < NUM; i++) CHECK(ordered[i] == &bindings[NUM - 1 - i]);
+}
@@ -0,0 +1,300 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include "ZeroG/ResidencyPolicy.hpp"
+
+using namespace zg;
+
+// Simulated GPU memory
+// ------------------------------------------------------------------------------------------------
+
+// A heap in simulated GPU memory. The memory usage reported to the policy is the sum of the sizes
+// of all resident heaps, same as what the OS reports for a real device.
+struct SimulatedHeap final : ZgMemoryHeap {
+	ZgResult bufferCreate(ZgBuffer**, const ZgBufferCreateInfo&) noexcept override
+	{
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+	ZgResult texture2DCreate(ZgTexture2D**, const ZgTexture2DCreateInfo&) noexcept override
+	{
+		return ZG_WARNING_UNIMPLEMENTED;
+	}
+	ZgResult getStats(ZgMemoryHeapStats&) noexcept override { return ZG_WARNING_UNIMPLEMENTED; }
+
+	uint64_t sizeBytes = 0;
+	bool resident = true;
+	uint32_t numEvictions = 0;
+	uint32_t numCallbacks = 0;
+};
+
+struct SimulatedGpu final {
+	static constexpr uint32_t MAX_NUM_HEAPS = 64;
+	SimulatedHeap heaps[MAX_NUM_HEAPS];
+	uint32_t numHeaps = 0;
+	uint64_t budgetBytes = 0;
+	uint64_t nextFenceValue[RESIDENCY_POLICY_MAX_NUM_QUEUES] = { 1, 1 };
+	uint64_t completedFenceValues[RESIDENCY_POLICY_MAX_NUM_QUEUES] = {};
+	ResidencyPolicy policy;
+
+	uint64_t usageBytes() const noexcept
+	{
+		uint64_t usage = 0;
+		for (uint32_t i = 0; i < numHeaps; i++) {
+			if (heaps[i].resident) usage += heaps[i].sizeBytes;
+		}
+		return usage;
+	}
+
+	SimulatedHeap& addHeap(uint64_t sizeBytes, ZgResidencyPriority priority) noexcept
+	{
+		SimulatedHeap& heap = heaps[numHeaps];
+		numHeaps += 1;
+		heap.sizeBytes = sizeBytes;
+		CHECK(policy.addHeap(&heap, sizeBytes, priority) == ZG_SUCCESS);
+		return heap;
+	}
+
+	// Submits work using the heaps on the queue, making evicted heaps resident again the same
+	// way the backend does. Returns the fence value signaled once the work is done.
+	uint64_t submit(uint32_t queueIdx, SimulatedHeap* const* used, uint32_t numUsed) noexcept
+	{
+		ZgMemoryHeap* usedHeaps[MAX_NUM_HEAPS] = {};
+		for (uint32_t i = 0; i < numUsed; i++) {
+			used[i]->resident = true;
+			usedHeaps[i] = used[i];
+		}
+		uint64_t fenceValue = nextFenceValue[queueIdx];
+		nextFenceValue[queueIdx] += 1;
+		policy.markUsed(usedHeaps, numUsed, queueIdx, fenceValue);
+		return fenceValue;
+	}
+
+	void completeAll() noexcept
+	{
+		for (uint32_t q = 0; q < RESIDENCY_POLICY_MAX_NUM_QUEUES; q++) {
+			completedFenceValues[q] = nextFenceValue[q] - 1;
+		}
+	}
+
+	void newFrame() noexcept
+	{
+		policy.newFrame(budgetBytes, usageBytes(), completedFenceValues);
+	}
+};
+
+static void evictSimulatedHeap(void* userPtr, ZgMemoryHeap* heap) noexcept
+{
+	(void)userPtr;
+	SimulatedHeap* simulatedHeap = static_cast<SimulatedHeap*>(heap);
+	CHECK(simulatedHeap->resident);
+	simulatedHeap->resident = false;
+	simulatedHeap->numEvictions += 1;
+}
+
+static void evictionCallback(void* userPtr, ZgMemoryHeap* heap, uint64_t sizeBytes) noexcept
+{
+	(void)userPtr;
+	SimulatedHeap* simulatedHeap = static_cast<SimulatedHeap*>(heap);
+	CHECK(simulatedHeap->sizeBytes == sizeBytes);
+	simulatedHeap->numCallbacks += 1;
+}
+
+static void createPolicy(SimulatedGpu& gpu, float evictionThreshold) noexcept
+{
+	ZgResidencySettings settings = {};
+	settings.enabled = ZG_TRUE;
+	settings.evictionThreshold = evictionThreshold;
+	settings.evictionCallback = evictionCallback;
+	CHECK(gpu.policy.create(settings, evictSimulatedHeap, nullptr) == ZG_SUCCESS);
+}
+
+// Tests
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(disabledPolicyNeverEvicts)
+{
+	SimulatedGpu gpu;
+	ZgResidencySettings settings = {};
+	CHECK(gpu.policy.create(settings, evictSimulatedHeap, nullptr) == ZG_SUCCESS);
+	CHECK(!gpu.policy.isEnabled());
+	gpu.addHeap(100, ZG_RESIDENCY_PRIORITY_NORMAL);
+	gpu.budgetBytes = 10;
+	gpu.newFrame();
+	CHECK(gpu.heaps[0].resident);
+}
+
+TEST_CASE(nothingEvictedBelowThreshold)
+{
+	SimulatedGpu gpu;
+	createPolicy(gpu, 0.5f);
+	for (uint32_t i = 0; i < 4; i++) gpu.addHeap(100, ZG_RESIDENCY_PRIORITY_NORMAL);
+	gpu.budgetBytes = 800;
+	gpu.newFrame();
+	gpu.newFrame();
+	CHECK(gpu.usageBytes() == 400);
+	CHECK(gpu.policy.lastFrameCounters().numHeapsEvicted == 0);
+}
+
+TEST_CASE(evictsLowPriorityThenLeastRecentlyUsed)
+{
+	SimulatedGpu gpu;
+	createPolicy(gpu, 0.5f);
+	SimulatedHeap* normalOld = &gpu.addHeap(100, ZG_RESIDENCY_PRIORITY_NORMAL);
+	SimulatedHeap* low = &gpu.addHeap(100, ZG_RESIDENCY_PRIORITY_LOW);
+	SimulatedHeap* normalNew = &gpu.addHeap(100, ZG_RESIDENCY_PRIORITY_NORMAL);
+	SimulatedHeap* high = &gpu.addHeap(100, ZG_RESIDENCY_PRIORITY_HIGH);
+	gpu.submit(0, &normalOld, 1);
+	gpu.submit(0, &high, 1);
+	gpu.submit(0, &normalNew, 1);
+	gpu.completeAll();
+
+	// Threshold 300 with 400 resident, the low priority heap goes first even if least used
+	gpu.budgetBytes = 600;
+	gpu.newFrame();
+	CHECK(!low->resident && normalOld->resident && normalNew->resident && high->resident);
+
+	// Threshold 100 with 300 resident, normal before high, least recently used first
+	gpu.budgetBytes = 200;
+	gpu.newFrame();
+	CHECK(!normalOld->resident && !normalNew->resident && high->resident);
+	CHECK(gpu.usageBytes() <= 100);
+
+	// One heap evicted the previous frame, and the callback was called for all of them
+	gpu.budgetBytes = 1000;
+	gpu.newFrame();
+	ResidencyCounters counters = gpu.policy.lastFrameCounters();
+	CHECK(counters.numHeapsEvicted == 2);
+	CHECK(counters.bytesEvicted == 200);
+	CHECK(low->numCallbacks == 1 && normalOld->numCallbacks == 1 && normalNew->numCallbacks == 1);
+	CHECK(high->numCallbacks == 0);
+}
+
+TEST_CASE(heapsInUseByGpuAreNotEvicted)
+{
+	SimulatedGpu gpu;
+	createPolicy(gpu, 0.5f);
+	SimulatedHeap* heapCopy = &gpu.addHeap(100, ZG_RESIDENCY_PRIORITY_LOW);
+	SimulatedHeap* heapPresent = &gpu.addHeap(100, ZG_RESIDENCY_PRIORITY_LOW);
+	SimulatedHeap* heapIdle = &gpu.addHeap(100, ZG_RESIDENCY_PRIORITY_HIGH);
+
+	// In flight on two different queues, only the idle high priority heap can be evicted
+	gpu.submit(0, &heapPresent, 1);
+	gpu.submit(1, &heapCopy, 1);
+	gpu.budgetBytes = 100;
+	gpu.newFrame();
+	CHECK(heapCopy->resident && heapPresent->resident && !heapIdle->resident);
+
+	// Once the present queue is done its heap can be evicted, the copy queue is still busy
+	gpu.completedFenceValues[0] = gpu.nextFenceValue[0] - 1;
+	gpu.newFrame();
+	CHECK(heapCopy->resident && !heapPresent->resident);
+}
+
+TEST_CASE(evictedHeapsAreMadeResidentWhenUsed)
+{
+	SimulatedGpu gpu;
+	createPolicy(gpu, 0.9f);
+	SimulatedHeap* heap = &gpu.addHeap(100, ZG_RESIDENCY_PRIORITY_NORMAL);
+	gpu.budgetBytes = 50;
+	gpu.newFrame();
+	CHECK(!heap->resident);
+
+	gpu.submit(1, &heap, 1);
+	CHECK(heap->resident);
+	gpu.budgetBytes = 1000;
+	gpu.newFrame();
+	ResidencyCounters counters = gpu.policy.lastFrameCounters();
+	CHECK(counters.numHeapsMadeResident == 1);
+	CHECK(counters.bytesMadeResident == 100);
+
+	// Removed heaps are never evicted again
+	gpu.policy.removeHeap(heap);
+	gpu.budgetBytes = 10;
+	gpu.newFrame();
+	CHECK(heap->resident);
+}
+
+TEST_CASE(simulatedBudgetOverManyFrames)
+{
+	// A working set that doesn't fit in the budget. Every frame renders with a sliding window of
+	// heaps, and the budget shrinks halfway through as if another application started.
+	SimulatedGpu gpu;
+	constexpr float THRESHOLD = 0.8f;
+	createPolicy(gpu, THRESHOLD);
+	constexpr uint32_t NUM_HEAPS = 48;
+	constexpr uint64_t HEAP_SIZE = 64;
+	for (uint32_t i = 0; i < NUM_HEAPS; i++) {
+		ZgResidencyPriority priority = ZG_RESIDENCY_PRIORITY_NORMAL;
+		if (i % 8 == 0) priority = ZG_RESIDENCY_PRIORITY_HIGH;
+		if (i % 8 == 1) priority = ZG_RESIDENCY_PRIORITY_LOW;
+		gpu.addHeap(HEAP_SIZE, priority);
+	}
+
+	constexpr uint32_t NUM_FRAMES = 200;
+	constexpr uint32_t WINDOW_SIZE = 12;
+	constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+	uint64_t frameFenceValues[FRAMES_IN_FLIGHT] = {};
+	uint64_t heapFenceValues[NUM_HEAPS] = {};
+	uint64_t totalEvicted = 0;
+	for (uint32_t frame = 0; frame < NUM_FRAMES; frame++) {
+		gpu.budgetBytes = frame < NUM_FRAMES / 2 ? 30 * HEAP_SIZE : 20 * HEAP_SIZE;
+
+		// The GPU lags FRAMES_IN_FLIGHT frames behind
+		gpu.completedFenceValues[0] = frameFenceValues[frame % FRAMES_IN_FLIGHT];
+		gpu.newFrame();
+		totalEvicted += gpu.policy.lastFrameCounters().numHeapsEvicted;
+
+		// Heaps used by frames still in flight must never be evicted
+		uint64_t inFlightBytes = 0;
+		for (uint32_t i = 0; i < NUM_HEAPS; i++) {
+			if (heapFenceValues[i] <= gpu.completedFenceValues[0]) continue;
+			CHECK(gpu.heaps[i].resident);
+			inFlightBytes += gpu.heaps[i].sizeBytes;
+		}
+
+		// Usage is brought below the threshold, unless the in-flight work alone exceeds it
+		uint64_t thresholdBytes = uint64_t(double(gpu.budgetBytes) * double(THRESHOLD));
+		CHECK(gpu.usageBytes() <= thresholdBytes || gpu.usageBytes() == inFlightBytes);
+
+		// Render this frame with a window of heaps, moving 3 heaps per frame
+		SimulatedHeap* used[WINDOW_SIZE] = {};
+		uint32_t start = (frame * 3) % NUM_HEAPS;
+		for (uint32_t i = 0; i < WINDOW_SIZE; i++) {
+			used[i] = &gpu.heaps[(start + i) % NUM_HEAPS];
+		}
+		uint64_t fenceValue = gpu.submit(0, used, WINDOW_SIZE);
+		frameFenceValues[frame % FRAMES_IN_FLIGHT] = fenceValue;
+		for (uint32_t i = 0; i < WINDOW_SIZE; i++) {
+			heapFenceValues[(start + i) % NUM_HEAPS] = fenceValue;
+		}
+	}
+
+	// The working set doesn't fit, so heaps are evicted continuously
+	CHECK(totalEvicted > NUM_FRAMES);
+
+	// High priority heaps are evicted less often than low priority heaps
+	uint32_t highEvictions = 0;
+	uint32_t lowEvictions = 0;
+	for (uint32_t i = 0; i < NUM_HEAPS; i++) {
+		if (i % 8 == 0) highEvictions += gpu.heaps[i].numEvictions;
+		if (i % 8 == 1) lowEvictions += gpu.heaps[i].numEvictions;
+	}
+	CHECK(highEvictions < lowEvictions);
+}
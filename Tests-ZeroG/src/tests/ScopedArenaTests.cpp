@@ -0,0 +1,104 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include <cstring>
+
+#include "ZeroG/Context.hpp"
+#include "ZeroG/util/CpuAllocation.hpp"
+#include "ZeroG/util/ScopedArena.hpp"
+
+using namespace zg;
+
+// Helpers
+// ------------------------------------------------------------------------------------------------
+
+static uint64_t arenaLiveBytes() noexcept
+{
+	ZgCpuAllocationTagStats stats[ZG_MAX_NUM_CPU_ALLOCATION_TAGS] = {};
+	uint32_t numStats = 0;
+	getCpuAllocationStats(stats, ZG_MAX_NUM_CPU_ALLOCATION_TAGS, numStats);
+	for (uint32_t i = 0; i < numStats; i++) {
+		if (std::strcmp(stats[i].name, "ZeroG - ScopedArena") == 0) return stats[i].liveBytes;
+	}
+	return 0;
+}
+
+// Tests
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(arenaAllocatesAlignedAndOwnsMemory)
+{
+	CHECK(ScopedArena::current() == nullptr);
+	{
+		ScopedArena arena;
+		CHECK(ScopedArena::current() == &arena);
+
+		uint8_t* a = reinterpret_cast<uint8_t*>(arena.allocate(1));
+		uint8_t* b = reinterpret_cast<uint8_t*>(arena.allocate(100));
+		uint8_t* c = reinterpret_cast<uint8_t*>(arena.allocate(0));
+		CHECK(a != nullptr && b != nullptr && c != nullptr);
+		CHECK((uintptr_t(a) % 32) == 0 && (uintptr_t(b) % 32) == 0 && (uintptr_t(c) % 32) == 0);
+		CHECK(a != b && b != c);
+		std::memset(b, 0xFF, 100);
+		CHECK(arena.owns(a) && arena.owns(b) && arena.owns(c));
+		CHECK(arena.numBytesAllocated() == 32 + 128 + 32);
+
+		int notOwned = 0;
+		CHECK(!arena.owns(&notOwned));
+	}
+	CHECK(ScopedArena::current() == nullptr);
+}
+
+TEST_CASE(arenaGrowsAndFreesChunks)
+{
+	ZgContext context = getContext();
+	context.allocator = createTrackingAllocator(getDefaultAllocator());
+	setContext(context);
+
+	{
+		ScopedArena arena;
+		void* first = arena.allocate(64);
+		void* large = arena.allocate(8 * 1024 * 1024);
+		CHECK(large != nullptr);
+		for (uint32_t i = 0; i < 10000; i++) {
+			CHECK(arena.allocate(200) != nullptr);
+		}
+		CHECK(arena.owns(first) && arena.owns(large));
+		CHECK(arenaLiveBytes() >= 8 * 1024 * 1024 + 10000 * 200);
+	}
+	CHECK(arenaLiveBytes() == 0);
+}
+
+TEST_CASE(arenasNest)
+{
+	ScopedArena outer;
+	void* outerPtr = outer.allocate(32);
+	{
+		ScopedArena inner;
+		CHECK(ScopedArena::current() == &inner);
+		void* innerPtr = inner.allocate(32);
+
+		// An inner arena owns the memory of the arenas it is nested inside, not the other way
+		CHECK(inner.owns(innerPtr) && inner.owns(outerPtr));
+		CHECK(!outer.owns(innerPtr));
+	}
+	CHECK(ScopedArena::current() == &outer);
+	CHECK(outer.owns(outerPtr));
+}
@@ -0,0 +1,360 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "ZeroG/ShaderArchive.hpp"
+#include "ZeroG/util/FileIO.hpp"
+
+using namespace zg;
+
+namespace fs = std::filesystem;
+
+// Helpers
+// ------------------------------------------------------------------------------------------------
+
+constexpr uint32_t NUM_BLOB_TYPES = uint32_t(ShaderArchiveBlobType::COUNT);
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) noexcept
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Builds an archive with the same layout as the shader compiler, with placeholder shaders. Each
+// entry gets one vertex attribute in its reflection so entries can be told apart.
+static Vector<uint8_t> buildArchive(const char* const* names, uint32_t numEntries) noexcept
+{
+	static const uint32_t spirv[] = { 0x07230203, 0x00010000 };
+	static const char hlsl[] = "float4 main() : SV_Position { return 0; }";
+	static const char msl[] = "vertex float4 main_0() { return 0; }";
+
+	uint32_t numSlots = 1;
+	while (numSlots < numEntries * 2) numSlots *= 2;
+	if (numSlots == numEntries) numSlots *= 2;
+
+	// Every entry has the same blob sizes apart from the name
+	uint64_t sizes[NUM_BLOB_TYPES] = {};
+	sizes[uint32_t(ShaderArchiveBlobType::REFLECTION)] = sizeof(SpirvPipelineReflection);
+	sizes[uint32_t(ShaderArchiveBlobType::VERTEX_SPIRV)] = sizeof(spirv);
+	sizes[uint32_t(ShaderArchiveBlobType::PIXEL_SPIRV)] = sizeof(spirv);
+	sizes[uint32_t(ShaderArchiveBlobType::VERTEX_HLSL)] = sizeof(hlsl);
+	sizes[uint32_t(ShaderArchiveBlobType::PIXEL_HLSL)] = sizeof(hlsl);
+	sizes[uint32_t(ShaderArchiveBlobType::VERTEX_MSL)] = sizeof(msl);
+	sizes[uint32_t(ShaderArchiveBlobType::PIXEL_MSL)] = sizeof(msl);
+
+	uint64_t slotsOffset = sizeof(ShaderArchiveHeader);
+	uint64_t entriesOffset = slotsOffset + uint64_t(numSlots) * sizeof(ShaderArchiveSlot);
+	uint64_t blobsOffset = alignUp(
+		entriesOffset + uint64_t(numEntries) * sizeof(ShaderArchiveEntry),
+		SHADER_ARCHIVE_BLOB_ALIGNMENT);
+	uint64_t fileSizeBytes = blobsOffset;
+	for (uint32_t i = 0; i < numEntries; i++) {
+		sizes[uint32_t(ShaderArchiveBlobType::NAME)] = std::strlen(names[i]) + 1;
+		for (uint32_t j = 0; j < NUM_BLOB_TYPES; j++) {
+			fileSizeBytes = alignUp(fileSizeBytes + sizes[j], SHADER_ARCHIVE_BLOB_ALIGNMENT);
+		}
+	}
+
+	Vector<uint8_t> archive;
+	archive.create(uint32_t(fileSizeBytes), "Shader archive");
+	archive.addMany(uint32_t(fileSizeBytes));
+	std::memset(archive.data(), 0, fileSizeBytes);
+
+	ShaderArchiveHeader& header = *reinterpret_cast<ShaderArchiveHeader*>(archive.data());
+	header.magic = SHADER_ARCHIVE_MAGIC;
+	header.version = SHADER_ARCHIVE_VERSION;
+	header.numEntries = numEntries;
+	header.numSlots = numSlots;
+	header.reflectionSizeBytes = sizeof(SpirvPipelineReflection);
+	header.fileSizeBytes = fileSizeBytes;
+	header.slotsOffset = slotsOffset;
+	header.entriesOffset = entriesOffset;
+
+	ShaderArchiveSlot* slots = reinterpret_cast<ShaderArchiveSlot*>(archive.data() + slotsOffset);
+	ShaderArchiveEntry* entries =
+		reinterpret_cast<ShaderArchiveEntry*>(archive.data() + entriesOffset);
+	for (uint32_t i = 0; i < numSlots; i++) {
+		slots[i].entryIdx = SHADER_ARCHIVE_EMPTY_SLOT;
+	}
+
+	uint64_t blobOffset = blobsOffset;
+	for (uint32_t i = 0; i < numEntries; i++) {
+		ShaderArchiveEntry& entry = entries[i];
+		entry.nameHash = shaderArchiveNameHash(names[i]);
+
+		SpirvPipelineReflection reflection;
+		reflection.reflection.signature.numVertexAttributes = 1;
+		reflection.reflection.signature.vertexAttributes[0].location = i;
+
+		const void* data[NUM_BLOB_TYPES] = {};
+		data[uint32_t(ShaderArchiveBlobType::NAME)] = names[i];
+		data[uint32_t(ShaderArchiveBlobType::REFLECTION)] = &reflection;
+		data[uint32_t(ShaderArchiveBlobType::VERTEX_SPIRV)] = spirv;
+		data[uint32_t(ShaderArchiveBlobType::PIXEL_SPIRV)] = spirv;
+		data[uint32_t(ShaderArchiveBlobType::VERTEX_HLSL)] = hlsl;
+		data[uint32_t(ShaderArchiveBlobType::PIXEL_HLSL)] = hlsl;
+		data[uint32_t(ShaderArchiveBlobType::VERTEX_MSL)] = msl;
+		data[uint32_t(ShaderArchiveBlobType::PIXEL_MSL)] = msl;
+		sizes[uint32_t(ShaderArchiveBlobType::NAME)] = std::strlen(names[i]) + 1;
+		for (uint32_t j = 0; j < NUM_BLOB_TYPES; j++) {
+			entry.blobs[j].offset = blobOffset;
+			entry.blobs[j].sizeBytes = sizes[j];
+			std::memcpy(archive.data() + blobOffset, data[j], sizes[j]);
+			blobOffset = alignUp(blobOffset + sizes[j], SHADER_ARCHIVE_BLOB_ALIGNMENT);
+		}
+
+		uint32_t mask = numSlots - 1;
+		uint32_t slotIdx = uint32_t(entry.nameHash) & mask;
+		while (slots[slotIdx].entryIdx != SHADER_ARCHIVE_EMPTY_SLOT) {
+			slotIdx = (slotIdx + 1) & mask;
+		}
+		slots[slotIdx].nameHash = entry.nameHash;
+		slots[slotIdx].entryIdx = i;
+	}
+
+	return archive;
+}
+
+static const char* const TEST_NAMES[] = { "Default", "Shadow", "Sky" };
+constexpr uint32_t NUM_TEST_NAMES = sizeof(TEST_NAMES) / sizeof(TEST_NAMES[0]);
+
+static Vector<uint8_t> buildTestArchive() noexcept
+{
+	return buildArchive(TEST_NAMES, NUM_TEST_NAMES);
+}
+
+static ShaderArchiveHeader& getHeader(Vector<uint8_t>& archive) noexcept
+{
+	return *reinterpret_cast<ShaderArchiveHeader*>(archive.data());
+}
+
+static ShaderArchiveEntry& getEntry(Vector<uint8_t>& archive, uint32_t idx) noexcept
+{
+	return reinterpret_cast<ShaderArchiveEntry*>(
+		archive.data() + getHeader(archive).entriesOffset)[idx];
+}
+
+static ShaderArchiveBlob& getBlob(
+	Vector<uint8_t>& archive, uint32_t entryIdx, ShaderArchiveBlobType type) noexcept
+{
+	return getEntry(archive, entryIdx).blobs[uint32_t(type)];
+}
+
+static SpirvPipelineReflection& getReflection(Vector<uint8_t>& archive, uint32_t entryIdx) noexcept
+{
+	const ShaderArchiveBlob& blob = getBlob(archive, entryIdx, ShaderArchiveBlobType::REFLECTION);
+	return *reinterpret_cast<SpirvPipelineReflection*>(archive.data() + blob.offset);
+}
+
+static bool isValid(const Vector<uint8_t>& archive) noexcept
+{
+	return validateShaderArchive(archive.data(), archive.size()) == ZG_SUCCESS;
+}
+
+// Tests
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(shaderArchiveValid)
+{
+	Vector<uint8_t> archive = buildTestArchive();
+	CHECK(isValid(archive));
+	CHECK(numLoggedMessages(ZG_LOG_LEVEL_ERROR) == 0);
+
+	ShaderArchivePipeline pipeline;
+	CHECK(getShaderArchivePipeline(pipeline, archive.data(), "Shadow"));
+	CHECK(std::strcmp(pipeline.name, "Shadow") == 0);
+	CHECK(pipeline.reflection->reflection.signature.vertexAttributes[0].location == 1);
+	CHECK(pipeline.vertexSpirvSizeBytes == 8 && pipeline.pixelSpirvSizeBytes == 8);
+	CHECK(pipeline.vertexHlslSizeBytes == std::strlen(pipeline.vertexHlsl));
+	CHECK(pipeline.pixelMslSizeBytes == std::strlen(pipeline.pixelMsl));
+}
+
+TEST_CASE(shaderArchiveFindByName)
+{
+	// Enough entries that several of them share home slots
+	char names[40][16] = {};
+	const char* namePtrs[40] = {};
+	for (uint32_t i = 0; i < 40; i++) {
+		std::snprintf(names[i], sizeof(names[i]), "Pipeline%u", i);
+		namePtrs[i] = names[i];
+	}
+	Vector<uint8_t> archive = buildArchive(namePtrs, 40);
+	CHECK(isValid(archive));
+
+	for (uint32_t i = 0; i < 40; i++) {
+		ShaderArchivePipeline pipeline;
+		CHECK(getShaderArchivePipeline(pipeline, archive.data(), names[i]));
+		CHECK(std::strcmp(pipeline.name, names[i]) == 0);
+		CHECK(pipeline.reflection->reflection.signature.vertexAttributes[0].location == i);
+	}
+
+	ShaderArchivePipeline pipeline;
+	CHECK(!getShaderArchivePipeline(pipeline, archive.data(), "Pipeline40"));
+	CHECK(pipeline.name == nullptr);
+	CHECK(findShaderArchiveEntry(archive.data(), "") == nullptr);
+	CHECK(findShaderArchiveEntry(archive.data(), "pipeline0") == nullptr);
+}
+
+TEST_CASE(shaderArchiveTruncated)
+{
+	Vector<uint8_t> archive = buildTestArchive();
+	const uint64_t sizes[] = { 0, sizeof(ShaderArchiveHeader) - 1, sizeof(ShaderArchiveHeader),
+		archive.size() / 2, archive.size() - 1 };
+	for (uint64_t size : sizes) {
+		CHECK(validateShaderArchive(archive.data(), size) != ZG_SUCCESS);
+	}
+	CHECK(validateShaderArchive(nullptr, archive.size()) != ZG_SUCCESS);
+
+	// Truncated files on disk, the way archives are actually loaded
+	std::error_code ec;
+	fs::path path = fs::temp_directory_path(ec) / "zg-test-shader-archive-truncated.zgsa";
+	const uint64_t fileSizes[] = { sizeof(ShaderArchiveHeader) + 8, archive.size() - 16u };
+	for (uint64_t size : fileSizes) {
+		std::FILE* file = std::fopen(path.string().c_str(), "wb");
+		CHECK(file != nullptr);
+		if (file == nullptr) return;
+		CHECK(std::fwrite(archive.data(), size, 1, file) == 1);
+		std::fclose(file);
+
+		MappedFile mapped;
+		CHECK(mapped.map(path.string().c_str()) == ZG_SUCCESS);
+		CHECK(mapped.size() == size);
+		CHECK(validateShaderArchive(mapped.data(), mapped.size()) != ZG_SUCCESS);
+	}
+	fs::remove(path, ec);
+}
+
+TEST_CASE(shaderArchiveCorruptHeader)
+{
+	Vector<uint8_t> archive;
+
+	archive = buildTestArchive();
+	getHeader(archive).magic += 1;
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getHeader(archive).version += 1;
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getHeader(archive).reflectionSizeBytes -= 4;
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getHeader(archive).numSlots = 3;
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getHeader(archive).numEntries = getHeader(archive).numSlots;
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getHeader(archive).entriesOffset = archive.size() - 8;
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getHeader(archive).slotsOffset = ~0ull - 8;
+	CHECK(!isValid(archive));
+
+	// Slot pointing past the entries
+	archive = buildTestArchive();
+	ShaderArchiveSlot* slots =
+		reinterpret_cast<ShaderArchiveSlot*>(archive.data() + getHeader(archive).slotsOffset);
+	for (uint32_t i = 0; i < getHeader(archive).numSlots; i++) {
+		if (slots[i].entryIdx != SHADER_ARCHIVE_EMPTY_SLOT) slots[i].entryIdx = NUM_TEST_NAMES;
+	}
+	CHECK(!isValid(archive));
+}
+
+TEST_CASE(shaderArchiveCorruptBlobs)
+{
+	Vector<uint8_t> archive;
+
+	// Out of bounds and misaligned
+	archive = buildTestArchive();
+	getBlob(archive, 1, ShaderArchiveBlobType::VERTEX_SPIRV).offset = archive.size();
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getBlob(archive, 1, ShaderArchiveBlobType::PIXEL_SPIRV).sizeBytes = ~0ull;
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getBlob(archive, 2, ShaderArchiveBlobType::VERTEX_MSL).offset += 4;
+	CHECK(!isValid(archive));
+
+	// Text that is not null-terminated
+	archive = buildTestArchive();
+	{
+		ShaderArchiveBlob& blob = getBlob(archive, 0, ShaderArchiveBlobType::PIXEL_HLSL);
+		archive[uint32_t(blob.offset + blob.sizeBytes - 1)] = 'x';
+	}
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getBlob(archive, 0, ShaderArchiveBlobType::NAME).sizeBytes -= 1;
+	CHECK(!isValid(archive));
+
+	// Reflection of the wrong size, or with counts larger than the signature's arrays
+	archive = buildTestArchive();
+	getBlob(archive, 0, ShaderArchiveBlobType::REFLECTION).sizeBytes -= 4;
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getReflection(archive, 1).reflection.signature.numVertexAttributes =
+		ZG_MAX_NUM_VERTEX_ATTRIBUTES + 1;
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getReflection(archive, 1).reflection.signature.numConstantBuffers = ~0u;
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getReflection(archive, 2).reflection.signature.numTextures = ZG_MAX_NUM_TEXTURES + 1;
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getReflection(archive, 2).reflection.signature.numRenderTargets =
+		ZG_MAX_NUM_RENDER_TARGETS + 1;
+	CHECK(!isValid(archive));
+
+	archive = buildTestArchive();
+	getReflection(archive, 2).reflection.signature.numTextures = ZG_MAX_NUM_TEXTURES;
+	CHECK(isValid(archive));
+}
+
+TEST_CASE(shaderArchiveMissingBlob)
+{
+	// Every backend needs some of the blobs, so all of them are required
+	for (uint32_t i = 0; i < NUM_BLOB_TYPES; i++) {
+		Vector<uint8_t> archive = buildTestArchive();
+		getBlob(archive, 1, ShaderArchiveBlobType(i)).sizeBytes = 0;
+		CHECK(!isValid(archive));
+	}
+
+	// Empty text, only the null-terminator
+	Vector<uint8_t> archive = buildTestArchive();
+	ShaderArchiveBlob& blob = getBlob(archive, 1, ShaderArchiveBlobType::VERTEX_HLSL);
+	archive[uint32_t(blob.offset)] = '\0';
+	blob.sizeBytes = 1;
+	CHECK(!isValid(archive));
+}
@@ -0,0 +1,384 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#include "ZeroG/BackendInterface.hpp"
+#include "ZeroG/Context.hpp"
+#include "ZeroG/ShaderHotReload.hpp"
+#include "ZeroG/util/CpuAllocation.hpp"
+#include "ZeroG/util/FileIO.hpp"
+#include "ZeroG/util/Hash.hpp"
+
+using namespace zg;
+
+namespace fs = std::filesystem;
+
+// Mock backend
+// ------------------------------------------------------------------------------------------------
+
+// A "compiled" pipeline is just the hash of its vertex shader source
+struct MockPipeline final : ZgPipelineRender {
+	uint64_t sourceHash = 0;
+};
+
+// Only implements what shader hot-reload uses, everything else fails
+struct MockBackend final : ZgBackend {
+	std::atomic_uint32_t numCompiles = 0;
+	std::atomic_int32_t numLivePipelines = 0;
+	bool recording = false;
+
+	ZgResult swapchainResize(uint32_t, uint32_t) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult swapchainBeginFrame(ZgFramebuffer**) noexcept override { return ZG_ERROR_GENERIC; }
+	ZgResult swapchainFinishFrame() noexcept override { return ZG_ERROR_GENERIC; }
+	ZgResult fenceCreate(ZgFence**) noexcept override { return ZG_ERROR_GENERIC; }
+	ZgResult getStats(ZgStats&) noexcept override { return ZG_ERROR_GENERIC; }
+
+	ZgResult pipelineRenderCreateFromFileSPIRV(ZgPipelineRender**, ZgPipelineRenderSignature*,
+		const ZgPipelineRenderCreateInfoFileSPIRV&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult pipelineRenderCreateFromMemorySPIRV(ZgPipelineRender**, ZgPipelineRenderSignature*,
+		const ZgPipelineRenderCreateInfoMemorySPIRV&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult pipelineRenderCreateFromFileHLSL(
+		ZgPipelineRender** pipelineOut,
+		ZgPipelineRenderSignature* signatureOut,
+		const ZgPipelineRenderCreateInfoFileHLSL& createInfo) noexcept override
+	{
+		numCompiles += 1;
+		Vector<uint8_t> source = readBinaryFile(createInfo.vertexShaderPath);
+		if (source.size() == 0) return ZG_ERROR_SHADER_COMPILE_ERROR;
+		MockPipeline* pipeline = zgNew<MockPipeline>("MockPipeline");
+		pipeline->sourceHash = hashBytes(source.data(), source.size());
+		numLivePipelines += 1;
+		*pipelineOut = pipeline;
+		*signatureOut = {};
+		return ZG_SUCCESS;
+	}
+	ZgResult pipelineRenderCreateFromSourceHLSL(ZgPipelineRender**, ZgPipelineRenderSignature*,
+		const ZgPipelineRenderCreateInfoSourceHLSL&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult pipelineRenderCreateFromMemoryDXIL(ZgPipelineRender**, ZgPipelineRenderSignature*,
+		const ZgPipelineRenderCreateInfoMemoryDXIL&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult pipelineRenderCreateFromArchive(ZgPipelineRender**, ZgPipelineRenderSignature*,
+		const ZgPipelineRenderCreateInfoCommon&, const ShaderArchivePipeline&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult pipelineRenderRelease(ZgPipelineRender* pipeline) noexcept override
+	{
+		numLivePipelines -= 1;
+		zgDelete(pipeline);
+		return ZG_SUCCESS;
+	}
+	ZgResult pipelineRenderReplace(
+		ZgPipelineRender* pipeline, ZgPipelineRender* replacement) noexcept override
+	{
+		if (recording) return ZG_WARNING_GENERIC;
+		static_cast<MockPipeline*>(pipeline)->sourceHash =
+			static_cast<MockPipeline*>(replacement)->sourceHash;
+		return this->pipelineRenderRelease(replacement);
+	}
+	ZgResult pipelineRenderGetSignature(
+		const ZgPipelineRender*, ZgPipelineRenderSignature*) const noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult pipelineRenderGetBytecodeHash(
+		const ZgPipelineRender*, uint64_t&) const noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+
+	ZgResult memoryHeapCreate(ZgMemoryHeap**, const ZgMemoryHeapCreateInfo&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult memoryHeapRelease(ZgMemoryHeap*) noexcept override { return ZG_ERROR_GENERIC; }
+	ZgResult memoryHeapSetResidencyPriority(
+		ZgMemoryHeap*, ZgResidencyPriority) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult bufferMemcpyTo(ZgBuffer*, uint64_t, const uint8_t*, uint64_t) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult bufferReadFile(ZgBuffer*, uint64_t, const char*, uint64_t, uint64_t,
+		ZgFileRead**) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult texture2DGetAllocationInfo(
+		ZgTexture2DAllocationInfo&, const ZgTexture2DCreateInfo&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	ZgResult framebufferCreate(ZgFramebuffer**, const ZgFramebufferCreateInfo&) noexcept override
+	{
+		return ZG_ERROR_GENERIC;
+	}
+	void framebufferRelease(ZgFramebuffer*) noexcept override {}
+	ZgResult getPresentQueue(ZgCommandQueue**) noexcept override { return ZG_ERROR_GENERIC; }
+	ZgResult getCopyQueue(ZgCommandQueue**) noexcept override { return ZG_ERROR_GENERIC; }
+};
+
+// Helpers
+// ------------------------------------------------------------------------------------------------
+
+static bool writeFile(const char* path, const char* contents) noexcept
+{
+	std::FILE* file = std::fopen(path, "wb");
+	if (file == nullptr) return false;
+	bool success = std::fwrite(contents, std::strlen(contents), 1, file) == 1;
+	return std::fclose(file) == 0 && success;
+}
+
+// Allocator wrapping the default one, fails allocations with the specified name
+struct TestAllocatorState final {
+	ZgAllocator inner = {};
+	const char* failName = nullptr;
+	std::atomic_int32_t numLiveAllocations = 0;
+};
+
+static TestAllocatorState testAllocatorState;
+
+static void useTestAllocator() noexcept
+{
+	testAllocatorState.inner = getDefaultAllocator();
+	testAllocatorState.failName = nullptr;
+	testAllocatorState.numLiveAllocations = 0;
+
+	ZgContext context = getContext();
+	context.allocator.userPtr = &testAllocatorState;
+	context.allocator.allocate = [](void* userPtr, uint32_t size, const char* name) -> void* {
+		TestAllocatorState& state = *reinterpret_cast<TestAllocatorState*>(userPtr);
+		if (state.failName != nullptr && std::strcmp(state.failName, name) == 0) return nullptr;
+		state.numLiveAllocations += 1;
+		return state.inner.allocate(state.inner.userPtr, size, name);
+	};
+	context.allocator.deallocate = [](void* userPtr, void* allocation) {
+		TestAllocatorState& state = *reinterpret_cast<TestAllocatorState*>(userPtr);
+		state.numLiveAllocations -= 1;
+		state.inner.deallocate(state.inner.userPtr, allocation);
+	};
+	setContext(context);
+}
+
+// Waits (at most 5 seconds) until the hot-reload thread has compiled the specified number of times
+static bool waitForCompiles(const MockBackend& backend, uint32_t numCompiles) noexcept
+{
+	for (uint32_t i = 0; i < 500; i++) {
+		if (backend.numCompiles >= numCompiles) return true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	return false;
+}
+
+// Tests
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(shaderHotReloadPostponesSwapWhileRecording)
+{
+	std::error_code ec;
+	fs::path dir = fs::temp_directory_path(ec) / "zg-test-shader-hot-reload";
+	fs::remove_all(dir, ec);
+	fs::create_directories(dir, ec);
+	std::string vertexPath = (dir / "vertex.hlsl").string();
+	std::string pixelPath = (dir / "pixel.hlsl").string();
+	CHECK(writeFile(vertexPath.c_str(), "float4 VSMain() { return 0; }"));
+	CHECK(writeFile(pixelPath.c_str(), "float4 PSMain() { return 0; }"));
+
+	MockBackend* backend = zgNew<MockBackend>("MockBackend");
+	ZgContext context = getContext();
+	context.backend = backend;
+	setContext(context);
+
+	{
+		ShaderHotReload hotReload;
+		ZgShaderHotReloadSettings settings = {};
+		settings.enabled = ZG_TRUE;
+		settings.pollIntervalMs = 5;
+		CHECK(hotReload.create(settings) == ZG_SUCCESS);
+
+		ZgPipelineRenderCreateInfoFileHLSL createInfo = {};
+		createInfo.common.vertexShaderEntry = "VSMain";
+		createInfo.common.pixelShaderEntry = "PSMain";
+		createInfo.vertexShaderPath = vertexPath.c_str();
+		createInfo.pixelShaderPath = pixelPath.c_str();
+		createInfo.shaderModel = ZG_SHADER_MODEL_6_0;
+
+		ZgPipelineRender* pipeline = nullptr;
+		ZgPipelineRenderSignature signature = {};
+		CHECK(backend->pipelineRenderCreateFromFileHLSL(&pipeline, &signature, createInfo)
+			== ZG_SUCCESS);
+		CHECK(hotReload.registerPipeline(pipeline, signature, createInfo) == ZG_SUCCESS);
+		const uint64_t originalHash = static_cast<MockPipeline*>(pipeline)->sourceHash;
+
+		// Modify shader, wait for it to be recompiled
+		CHECK(writeFile(vertexPath.c_str(), "float4 VSMain() { return 1; }"));
+		CHECK(waitForCompiles(*backend, 2));
+
+		// The backend refuses to swap while command lists are recording, try again next frame
+		backend->recording = true;
+		hotReload.applyReloaded();
+		CHECK(static_cast<MockPipeline*>(pipeline)->sourceHash == originalHash);
+		CHECK(hotReload.stats().numReloads == 0 && hotReload.stats().numFailures == 0);
+		CHECK(backend->numLivePipelines == 2);
+
+		backend->recording = false;
+		hotReload.applyReloaded();
+		CHECK(static_cast<MockPipeline*>(pipeline)->sourceHash != originalHash);
+		CHECK(hotReload.stats().numReloads == 1 && hotReload.stats().numFailures == 0);
+		CHECK(backend->numLivePipelines == 1);
+
+		// Nothing more to swap in
+		hotReload.applyReloaded();
+		CHECK(hotReload.stats().numReloads == 1);
+
+		hotReload.unregisterPipeline(pipeline);
+		backend->pipelineRenderRelease(pipeline);
+	}
+
+	CHECK(backend->numLivePipelines == 0);
+	zgDelete(backend);
+	fs::remove_all(dir, ec);
+}
+
+TEST_CASE(shaderHotReloadReleasesPostponedPipelines)
+{
+	std::error_code ec;
+	fs::path dir = fs::temp_directory_path(ec) / "zg-test-shader-hot-reload-release";
+	fs::remove_all(dir, ec);
+	fs::create_directories(dir, ec);
+	std::string vertexPath = (dir / "vertex.hlsl").string();
+	std::string pixelPath = (dir / "pixel.hlsl").string();
+	CHECK(writeFile(vertexPath.c_str(), "float4 VSMain() { return 0; }"));
+	CHECK(writeFile(pixelPath.c_str(), "float4 PSMain() { return 0; }"));
+
+	MockBackend* backend = zgNew<MockBackend>("MockBackend");
+	ZgContext context = getContext();
+	context.backend = backend;
+	setContext(context);
+
+	ZgPipelineRender* pipeline = nullptr;
+	{
+		ShaderHotReload hotReload;
+		ZgShaderHotReloadSettings settings = {};
+		settings.enabled = ZG_TRUE;
+		settings.pollIntervalMs = 5;
+		CHECK(hotReload.create(settings) == ZG_SUCCESS);
+
+		ZgPipelineRenderCreateInfoFileHLSL createInfo = {};
+		createInfo.vertexShaderPath = vertexPath.c_str();
+		createInfo.pixelShaderPath = pixelPath.c_str();
+		ZgPipelineRenderSignature signature = {};
+		CHECK(backend->pipelineRenderCreateFromFileHLSL(&pipeline, &signature, createInfo)
+			== ZG_SUCCESS);
+		CHECK(hotReload.registerPipeline(pipeline, signature, createInfo) == ZG_SUCCESS);
+
+		CHECK(writeFile(vertexPath.c_str(), "float4 VSMain() { return 1; }"));
+		CHECK(waitForCompiles(*backend, 2));
+		backend->recording = true;
+		hotReload.applyReloaded();
+		CHECK(backend->numLivePipelines == 2);
+	}
+
+	// Destroying hot-reload releases the recompiled pipeline that was never swapped in
+	CHECK(backend->numLivePipelines == 1);
+	backend->pipelineRenderRelease(pipeline);
+	zgDelete(backend);
+	fs::remove_all(dir, ec);
+}
+
+TEST_CASE(shaderHotReloadRegisterOutOfMemory)
+{
+	std::error_code ec;
+	fs::path dir = fs::temp_directory_path(ec) / "zg-test-shader-hot-reload-oom";
+	fs::remove_all(dir, ec);
+	fs::create_directories(dir, ec);
+	std::string vertexPath = (dir / "vertex.hlsl").string();
+	std::string pixelPath = (dir / "pixel.hlsl").string();
+	CHECK(writeFile(vertexPath.c_str(), "float4 VSMain() { return 0; }"));
+	CHECK(writeFile(pixelPath.c_str(), "float4 PSMain() { return 0; }"));
+
+	useTestAllocator();
+	MockBackend* backend = zgNew<MockBackend>("MockBackend");
+	ZgContext context = getContext();
+	context.backend = backend;
+	setContext(context);
+
+	ZgPipelineRender* pipeline = nullptr;
+	{
+		ShaderHotReload hotReload;
+		ZgShaderHotReloadSettings settings = {};
+		settings.enabled = ZG_TRUE;
+		settings.pollIntervalMs = 5;
+		CHECK(hotReload.create(settings) == ZG_SUCCESS);
+
+		ZgPipelineRenderCreateInfoFileHLSL createInfo = {};
+		createInfo.common.vertexShaderEntry = "VSMain";
+		createInfo.common.pixelShaderEntry = "PSMain";
+		createInfo.vertexShaderPath = vertexPath.c_str();
+		createInfo.pixelShaderPath = pixelPath.c_str();
+		ZgPipelineRenderSignature signature = {};
+		CHECK(backend->pipelineRenderCreateFromFileHLSL(&pipeline, &signature, createInfo)
+			== ZG_SUCCESS);
+		const int32_t numLiveAllocations = testAllocatorState.numLiveAllocations;
+
+		// Neither the entry nor its copied strings can be allocated, nothing is leaked
+		testAllocatorState.failName = "ZeroG - ShaderHotReload - Entry";
+		CHECK(hotReload.registerPipeline(pipeline, signature, createInfo)
+			== ZG_ERROR_CPU_OUT_OF_MEMORY);
+		testAllocatorState.failName = "ZeroG - ShaderHotReload - Strings";
+		CHECK(hotReload.registerPipeline(pipeline, signature, createInfo)
+			== ZG_ERROR_CPU_OUT_OF_MEMORY);
+		CHECK(numLoggedMessages(ZG_LOG_LEVEL_ERROR) == 2);
+		CHECK(testAllocatorState.numLiveAllocations == numLiveAllocations);
+
+		// Once memory is available again the pipeline can be registered
+		testAllocatorState.failName = nullptr;
+		CHECK(hotReload.registerPipeline(pipeline, signature, createInfo) == ZG_SUCCESS);
+		hotReload.unregisterPipeline(pipeline);
+	}
+
+	backend->pipelineRenderRelease(pipeline);
+	CHECK(backend->numLivePipelines == 0);
+	zgDelete(backend);
+	CHECK(testAllocatorState.numLiveAllocations == 0);
+	fs::remove_all(dir, ec);
+}
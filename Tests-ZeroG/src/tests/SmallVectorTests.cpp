@@ -0,0 +1,291 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include <initializer_list>
+
+#include "ZeroG/Context.hpp"
+#include "ZeroG/util/CpuAllocation.hpp"
+#include "ZeroG/util/SmallVector.hpp"
+
+using namespace zg;
+
+// Helpers
+// ------------------------------------------------------------------------------------------------
+
+// Element that keeps track of how many instances are alive, to catch missing or double
+// destruction. Moved-from elements have value -1.
+struct Tracked final {
+	static int32_t numLive;
+	int32_t value = 0;
+
+	Tracked() noexcept { numLive += 1; }
+	Tracked(int32_t value) noexcept : value(value) { numLive += 1; }
+	Tracked(const Tracked& other) noexcept : value(other.value) { numLive += 1; }
+	Tracked(Tracked&& other) noexcept : value(other.value) { other.value = -1; numLive += 1; }
+	Tracked& operator= (const Tracked& other) noexcept { value = other.value; return *this; }
+	Tracked& operator= (Tracked&& other) noexcept
+	{
+		value = other.value;
+		other.value = -1;
+		return *this;
+	}
+	~Tracked() noexcept { numLive -= 1; }
+};
+
+int32_t Tracked::numLive = 0;
+
+// Allocator wrapping the default one, which can be told to fail
+struct TestAllocatorState final {
+	ZgAllocator inner = {};
+	bool fail = false;
+	int32_t numLiveAllocations = 0;
+};
+
+static TestAllocatorState testAllocatorState;
+
+static void useTestAllocator() noexcept
+{
+	testAllocatorState = {};
+	testAllocatorState.inner = getDefaultAllocator();
+
+	ZgContext context = getContext();
+	context.allocator.userPtr = &testAllocatorState;
+	context.allocator.allocate = [](void* userPtr, uint32_t size, const char* name) -> void* {
+		TestAllocatorState& state = *reinterpret_cast<TestAllocatorState*>(userPtr);
+		if (state.fail) return nullptr;
+		state.numLiveAllocations += 1;
+		return state.inner.allocate(state.inner.userPtr, size, name);
+	};
+	context.allocator.deallocate = [](void* userPtr, void* allocation) {
+		TestAllocatorState& state = *reinterpret_cast<TestAllocatorState*>(userPtr);
+		state.numLiveAllocations -= 1;
+		state.inner.deallocate(state.inner.userPtr, allocation);
+	};
+	setContext(context);
+}
+
+template<uint32_t N>
+static void addRange(SmallVector<Tracked, N>& vec, int32_t first, int32_t last) noexcept
+{
+	for (int32_t i = first; i <= last; i++) {
+		CHECK(vec.add(Tracked(i)));
+	}
+}
+
+template<uint32_t N>
+static bool contentsEqual(
+	const SmallVector<Tracked, N>& vec, std::initializer_list<int32_t> expected) noexcept
+{
+	if (vec.size() != expected.size()) return false;
+	uint32_t i = 0;
+	for (int32_t value : expected) {
+		if (vec[i++].value != value) return false;
+	}
+	return true;
+}
+
+// Tests
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(smallVectorGrowsFromInlineToHeap)
+{
+	useTestAllocator();
+	{
+		SmallVector<Tracked, 4> vec;
+		CHECK(vec.isInline() && vec.capacity() == 4 && vec.size() == 0);
+
+		addRange(vec, 0, 3);
+		CHECK(vec.isInline());
+		CHECK(testAllocatorState.numLiveAllocations == 0);
+		CHECK(contentsEqual(vec, { 0, 1, 2, 3 }));
+
+		// Fifth element moves the storage to the heap
+		CHECK(vec.add(Tracked(4)));
+		CHECK(!vec.isInline());
+		CHECK(vec.capacity() >= 5);
+		CHECK(testAllocatorState.numLiveAllocations == 1);
+		CHECK(contentsEqual(vec, { 0, 1, 2, 3, 4 }));
+
+		// Adding an element of the vector itself while growing
+		addRange(vec, 5, int32_t(vec.capacity()) - 1);
+		CHECK(vec.add(vec[0]));
+		CHECK(vec.last().value == 0 && vec[0].value == 0);
+		CHECK(Tracked::numLive == int32_t(vec.size()));
+
+		CHECK(vec.addMany(2));
+		CHECK(vec.last().value == 0);
+		CHECK(Tracked::numLive == int32_t(vec.size()));
+
+		vec.destroy();
+		CHECK(vec.isInline() && vec.size() == 0 && vec.capacity() == 4);
+		CHECK(testAllocatorState.numLiveAllocations == 0);
+		CHECK(Tracked::numLive == 0);
+
+		// Also usable as a plain growable vector
+		SmallVector<Tracked, 0> heapOnly;
+		CHECK(heapOnly.capacity() == 0);
+		addRange(heapOnly, 0, 9);
+		CHECK(!heapOnly.isInline());
+		CHECK(contentsEqual(heapOnly, { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+	}
+	CHECK(testAllocatorState.numLiveAllocations == 0);
+	CHECK(Tracked::numLive == 0);
+}
+
+TEST_CASE(smallVectorMoveAndSwap)
+{
+	useTestAllocator();
+	{
+		// Move-construct from inline, elements are moved one by one
+		SmallVector<Tracked, 4> inlineVec;
+		addRange(inlineVec, 0, 2);
+		SmallVector<Tracked, 4> movedInline = std::move(inlineVec);
+		CHECK(movedInline.isInline() && contentsEqual(movedInline, { 0, 1, 2 }));
+		CHECK(inlineVec.isInline() && inlineVec.size() == 0);
+		CHECK(Tracked::numLive == 3);
+
+		// Move-construct from heap, the allocation is stolen
+		SmallVector<Tracked, 4> heapVec;
+		addRange(heapVec, 10, 15);
+		const Tracked* heapData = heapVec.data();
+		SmallVector<Tracked, 4> movedHeap = std::move(heapVec);
+		CHECK(movedHeap.data() == heapData && contentsEqual(movedHeap, { 10, 11, 12, 13, 14, 15 }));
+		CHECK(heapVec.isInline() && heapVec.size() == 0 && heapVec.capacity() == 4);
+		CHECK(testAllocatorState.numLiveAllocations == 1);
+		CHECK(Tracked::numLive == 9);
+
+		// Move-assign heap into inline, the old elements are destroyed
+		movedInline = std::move(movedHeap);
+		CHECK(!movedInline.isInline() && movedInline.data() == heapData);
+		CHECK(contentsEqual(movedInline, { 10, 11, 12, 13, 14, 15 }));
+		CHECK(movedHeap.isInline() && movedHeap.size() == 0);
+		CHECK(Tracked::numLive == 6);
+
+		// Move-assign inline into heap, the old allocation is freed
+		SmallVector<Tracked, 4> small;
+		addRange(small, 20, 21);
+		movedInline = std::move(small);
+		CHECK(movedInline.isInline() && contentsEqual(movedInline, { 20, 21 }));
+		CHECK(testAllocatorState.numLiveAllocations == 0);
+		CHECK(Tracked::numLive == 2);
+
+		// Swap inline with heap, and back
+		SmallVector<Tracked, 4> big;
+		addRange(big, 30, 34);
+		const Tracked* bigData = big.data();
+		movedInline.swap(big);
+		CHECK(!movedInline.isInline() && movedInline.data() == bigData);
+		CHECK(contentsEqual(movedInline, { 30, 31, 32, 33, 34 }));
+		CHECK(big.isInline() && contentsEqual(big, { 20, 21 }));
+		big.swap(movedInline);
+		CHECK(contentsEqual(big, { 30, 31, 32, 33, 34 }) && big.data() == bigData);
+		CHECK(contentsEqual(movedInline, { 20, 21 }));
+
+		// Swap heap with heap
+		SmallVector<Tracked, 4> other;
+		addRange(other, 40, 46);
+		const Tracked* otherData = other.data();
+		big.swap(other);
+		CHECK(big.data() == otherData && contentsEqual(big, { 40, 41, 42, 43, 44, 45, 46 }));
+		CHECK(other.data() == bigData && contentsEqual(other, { 30, 31, 32, 33, 34 }));
+		CHECK(testAllocatorState.numLiveAllocations == 2);
+		CHECK(Tracked::numLive == 14);
+	}
+	CHECK(testAllocatorState.numLiveAllocations == 0);
+	CHECK(Tracked::numLive == 0);
+}
+
+TEST_CASE(smallVectorRemoveAndPop)
+{
+	useTestAllocator();
+	{
+		SmallVector<Tracked, 4> vec;
+		addRange(vec, 0, 5);
+
+		CHECK(vec.remove(2));
+		CHECK(contentsEqual(vec, { 0, 1, 3, 4, 5 }));
+		CHECK(vec.remove(0));
+		CHECK(contentsEqual(vec, { 1, 3, 4, 5 }));
+		CHECK(vec.remove(3));
+		CHECK(contentsEqual(vec, { 1, 3, 4 }));
+		CHECK(!vec.remove(3));
+		CHECK(Tracked::numLive == 3);
+
+		Tracked popped;
+		CHECK(vec.pop(popped));
+		CHECK(popped.value == 4 && contentsEqual(vec, { 1, 3 }));
+		CHECK(vec.pop());
+		CHECK(contentsEqual(vec, { 1 }));
+		CHECK(vec.pop(popped) && popped.value == 1);
+		CHECK(vec.size() == 0);
+		CHECK(!vec.pop());
+		CHECK(!vec.pop(popped) && popped.value == 1);
+		CHECK(Tracked::numLive == 1);
+
+		// Removing doesn't shrink the storage
+		CHECK(!vec.isInline());
+	}
+	CHECK(Tracked::numLive == 0);
+}
+
+TEST_CASE(smallVectorAddFailsWhenOutOfMemory)
+{
+	useTestAllocator();
+	{
+		// Inline storage full, growing to the heap fails
+		SmallVector<Tracked, 2> vec;
+		addRange(vec, 0, 1);
+		testAllocatorState.fail = true;
+		CHECK(!vec.add(Tracked(2)));
+		Tracked value(3);
+		CHECK(!vec.add(value));
+		CHECK(value.value == 3);
+		CHECK(!vec.addMany(1));
+		CHECK(vec.isInline() && vec.capacity() == 2);
+		CHECK(contentsEqual(vec, { 0, 1 }));
+		CHECK(Tracked::numLive == 3);
+
+		// Heap storage full, growing it fails
+		testAllocatorState.fail = false;
+		addRange(vec, 2, int32_t(vec.capacity()) + 1);
+		addRange(vec, int32_t(vec.size()), int32_t(vec.capacity()) - 1);
+		const uint32_t size = vec.size();
+		const uint32_t capacity = vec.capacity();
+		const Tracked* data = vec.data();
+		CHECK(size == capacity);
+		testAllocatorState.fail = true;
+		CHECK(!vec.add(Tracked(100)));
+		CHECK(!vec.add(vec[0]));
+		CHECK(!vec.reserve(capacity + 1));
+		CHECK(vec.size() == size && vec.capacity() == capacity && vec.data() == data);
+		for (uint32_t i = 0; i < size; i++) {
+			CHECK(vec[i].value == int32_t(i));
+		}
+		CHECK(Tracked::numLive == int32_t(size) + 1);
+
+		// Space that is already reserved doesn't need the allocator
+		CHECK(vec.pop());
+		CHECK(vec.add(Tracked(200)));
+		CHECK(vec.last().value == 200);
+		testAllocatorState.fail = false;
+	}
+	CHECK(testAllocatorState.numLiveAllocations == 0);
+	CHECK(Tracked::numLive == 0);
+}
@@ -0,0 +1,193 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "Testing.hpp"
+
+#include <cstring>
+
+#include "ZeroG/SpirvCross.hpp"
+#include "ZeroG/util/FileIO.hpp"
+
+using namespace zg;
+
+// Helpers
+// ------------------------------------------------------------------------------------------------
+
+// The Sample-2 shaders, compiled from Samples/res/Sample-2/test.hlsl
+struct Sample2Shaders final {
+	Vector<uint8_t> vertexSpirv = readBinaryFile(ZEROG_SAMPLES_RES_DIR "/Sample-2/test_vs.spv");
+	Vector<uint8_t> pixelSpirv = readBinaryFile(ZEROG_SAMPLES_RES_DIR "/Sample-2/test_ps.spv");
+};
+
+static ZgPipelineRenderCreateInfoCommon sample2CreateInfo() noexcept
+{
+	ZgPipelineRenderCreateInfoCommon createInfo = {};
+	createInfo.vertexShaderEntry = "VSMain";
+	createInfo.pixelShaderEntry = "PSMain";
+	createInfo.numVertexAttributes = 3;
+	createInfo.vertexAttributes[0] = { 0, 0, ZG_VERTEX_ATTRIBUTE_F32_3, 0 };
+	createInfo.vertexAttributes[1] = { 1, 0, ZG_VERTEX_ATTRIBUTE_F32_3, 12 };
+	createInfo.vertexAttributes[2] = { 2, 0, ZG_VERTEX_ATTRIBUTE_F32_2, 24 };
+	createInfo.numVertexBufferSlots = 1;
+	createInfo.vertexBufferStridesBytes[0] = 32;
+	createInfo.numSamplers = 1;
+	createInfo.numRenderTargets = 1;
+	createInfo.renderTargets[0] = ZG_TEXTURE_FORMAT_RGBA_U8_UNORM;
+	return createInfo;
+}
+
+static ZgResult reflectSample2(SpirvPipelineReflection& reflectionOut) noexcept
+{
+	Sample2Shaders shaders;
+	return reflectSpirvPipelineRender(reflectionOut,
+		shaders.vertexSpirv.data(), shaders.vertexSpirv.size(),
+		shaders.pixelSpirv.data(), shaders.pixelSpirv.size());
+}
+
+// Tests
+// ------------------------------------------------------------------------------------------------
+
+TEST_CASE(spirvReflectSample2)
+{
+	SpirvPipelineReflection spirvReflection;
+	CHECK(reflectSample2(spirvReflection) == ZG_SUCCESS);
+	CHECK(spirvReflection.pushConstantRegister == ~0u);
+	CHECK(spirvReflection.samplerRegisterMask == 1);
+
+	const PipelineRenderReflection& reflection = spirvReflection.reflection;
+	const ZgPipelineRenderSignature& signature = reflection.signature;
+	CHECK(signature.numVertexAttributes == 3);
+	CHECK(signature.vertexAttributes[0].location == 0);
+	CHECK(signature.vertexAttributes[0].type == ZG_VERTEX_ATTRIBUTE_F32_3);
+	CHECK(signature.vertexAttributes[1].location == 1);
+	CHECK(signature.vertexAttributes[1].type == ZG_VERTEX_ATTRIBUTE_F32_3);
+	CHECK(signature.vertexAttributes[2].location == 2);
+	CHECK(signature.vertexAttributes[2].type == ZG_VERTEX_ATTRIBUTE_F32_2);
+
+	// transforms : register(b0) and AnotherCB : register(b1), both only used by the vertex shader
+	CHECK(signature.numConstantBuffers == 2);
+	for (uint32_t i = 0; i < signature.numConstantBuffers; i++) {
+		const ZgConstantBufferDesc& cb = signature.constantBuffers[i];
+		CHECK(cb.shaderRegister == i);
+		CHECK(cb.sizeInBytes == (i == 0 ? 128 : 16));
+		CHECK(cb.pushConstant == ZG_FALSE && cb.rootConstantBuffer == ZG_FALSE);
+		CHECK(reflection.constBufferVertexAccess[i] && !reflection.constBufferPixelAccess[i]);
+	}
+
+	// texture : register(t0)
+	CHECK(signature.numTextures == 1);
+	CHECK(signature.textures[0].textureRegister == 0);
+	CHECK(signature.bindlessTextures == ZG_FALSE && signature.bindlessBuffers == ZG_FALSE);
+	CHECK(signature.numRenderTargets == 1);
+}
+
+TEST_CASE(spirvValidateSample2)
+{
+	SpirvPipelineReflection spirvReflection;
+	CHECK(reflectSample2(spirvReflection) == ZG_SUCCESS);
+
+	// Matching create info
+	ZgPipelineRenderCreateInfoCommon createInfo = sample2CreateInfo();
+	PipelineRenderReflection reflection;
+	CHECK(validateSpirvPipelineRender(reflection, spirvReflection, createInfo) == ZG_SUCCESS);
+	CHECK(reflection.signature.numVertexAttributes == 3);
+	CHECK(reflection.signature.vertexAttributes[1].offsetToFirstElementInBytes == 12);
+	CHECK(reflection.signature.numRenderTargets == 1);
+	CHECK(reflection.signature.renderTargets[0] == ZG_TEXTURE_FORMAT_RGBA_U8_UNORM);
+	CHECK(numLoggedMessages(ZG_LOG_LEVEL_ERROR) == 0);
+
+	// Push constant in b1
+	createInfo.numPushConstants = 1;
+	createInfo.pushConstantRegisters[0] = 1;
+	CHECK(validateSpirvPipelineRender(reflection, spirvReflection, createInfo) == ZG_SUCCESS);
+	CHECK(reflection.signature.constantBuffers[1].pushConstant == ZG_TRUE);
+	CHECK(reflection.signature.constantBuffers[0].pushConstant == ZG_FALSE);
+
+	// Root constant buffer in b0
+	createInfo = sample2CreateInfo();
+	createInfo.numRootConstantBuffers = 1;
+	createInfo.rootConstantBufferRegisters[0] = 0;
+	CHECK(validateSpirvPipelineRender(reflection, spirvReflection, createInfo) == ZG_SUCCESS);
+	CHECK(reflection.signature.constantBuffers[0].rootConstantBuffer == ZG_TRUE);
+	CHECK(reflection.signature.constantBuffers[1].rootConstantBuffer == ZG_FALSE);
+}
+
+TEST_CASE(spirvValidateSample2Mismatches)
+{
+	SpirvPipelineReflection spirvReflection;
+	CHECK(reflectSample2(spirvReflection) == ZG_SUCCESS);
+	PipelineRenderReflection reflection;
+
+	// Wrong vertex attribute type
+	ZgPipelineRenderCreateInfoCommon createInfo = sample2CreateInfo();
+	createInfo.vertexAttributes[2].type = ZG_VERTEX_ATTRIBUTE_F32_3;
+	CHECK(validateSpirvPipelineRender(reflection, spirvReflection, createInfo) != ZG_SUCCESS);
+
+	// Missing vertex attribute
+	createInfo = sample2CreateInfo();
+	createInfo.numVertexAttributes = 2;
+	CHECK(validateSpirvPipelineRender(reflection, spirvReflection, createInfo) != ZG_SUCCESS);
+
+	// Sampler used by the shader not specified
+	createInfo = sample2CreateInfo();
+	createInfo.numSamplers = 0;
+	CHECK(validateSpirvPipelineRender(reflection, spirvReflection, createInfo) != ZG_SUCCESS);
+
+	// Wrong number of render targets
+	createInfo = sample2CreateInfo();
+	createInfo.numRenderTargets = 2;
+	CHECK(validateSpirvPipelineRender(reflection, spirvReflection, createInfo) != ZG_SUCCESS);
+
+	// Root constant buffer in a register not used by the shaders
+	createInfo = sample2CreateInfo();
+	createInfo.numRootConstantBuffers = 1;
+	createInfo.rootConstantBufferRegisters[0] = 5;
+	CHECK(validateSpirvPipelineRender(reflection, spirvReflection, createInfo) != ZG_SUCCESS);
+
+	CHECK(numLoggedMessages(ZG_LOG_LEVEL_ERROR) == 5);
+}
+
+TEST_CASE(spirvReflectInvalidSpirv)
+{
+	Sample2Shaders shaders;
+	uint32_t garbage[16] = {};
+	SpirvPipelineReflection spirvReflection;
+	CHECK(reflectSpirvPipelineRender(spirvReflection,
+		reinterpret_cast<const uint8_t*>(garbage), sizeof(garbage),
+		shaders.pixelSpirv.data(), shaders.pixelSpirv.size()) != ZG_SUCCESS);
+}
+
+TEST_CASE(spirvCrossCompileSample2)
+{
+	Sample2Shaders shaders;
+	spvc_context context = nullptr;
+	CHECK(spvc_context_create(&context) == SPVC_SUCCESS);
+
+	Vector<char> hlsl = crossCompileSpirvToHLSL(
+		context, shaders.vertexSpirv.data(), shaders.vertexSpirv.size(), ~0u, nullptr, 0);
+	CHECK(hlsl.size() != 0);
+	CHECK(hlsl.size() != 0 && std::strstr(hlsl.data(), "register(b0, space0)") != nullptr);
+	CHECK(hlsl.size() != 0 && std::strstr(hlsl.data(), "register(b1, space0)") != nullptr);
+
+	Vector<char> msl = crossCompileSpirvToMSL(
+		context, shaders.pixelSpirv.data(), shaders.pixelSpirv.size());
+	CHECK(msl.size() != 0);
+	CHECK(msl.size() != 0 && std::strstr(msl.data(), "fragment") != nullptr);
+
+	spvc_context_destroy(context);
+}
@@ -0,0 +1,313 @@
+// Copyright (c) Peter Hillerström (skipifzero.com, peter@hstroem.se)
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+// ZeroG offline shader compiler
+// ------------------------------------------------------------------------------------------------
+
+// Compiles SPIR-V render pipelines into a shader archive (see ZeroG/ShaderArchive.hpp) at build
+// time. Each pipeline is reflected and cross-compiled to HLSL and MSL using the same SPIRV-Cross
+// code paths as the runtime, so the runtime only has to look the results up. Any shader that
+// fails to reflect or cross-compile fails the build.
+//
+// Usage:
+//
+//     ZeroG-ShaderCompiler <archive> <name> <vertex.spv> <pixel.spv> [<name> <vertex.spv> ...]
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "spirv_cross_c.h"
+
+#include "ZeroG.h"
+#include "ZeroG/Context.hpp"
+#include "ZeroG/ShaderArchive.hpp"
+#include "ZeroG/SpirvCross.hpp"
+#include "ZeroG/util/CpuAllocation.hpp"
+#include "ZeroG/util/FileIO.hpp"
+#include "ZeroG/util/Logging.hpp"
+#include "ZeroG/util/Vector.hpp"
+
+using namespace zg;
+
+// Statics
+// ------------------------------------------------------------------------------------------------
+
+struct CompiledPipeline final {
+	const char* name = nullptr;
+	SpirvPipelineReflection reflection;
+	Vector<uint8_t> vertexSpirv;
+	Vector<uint8_t> pixelSpirv;
+	Vector<char> vertexHlsl;
+	Vector<char> pixelHlsl;
+	Vector<char> vertexMsl;
+	Vector<char> pixelMsl;
+};
+
+static void printUsage() noexcept
+{
+	std::printf("Usage: ZeroG-ShaderCompiler <archive> "
+		"<name> <vertex.spv> <pixel.spv> [<name> <vertex.spv> <pixel.spv> ...]\n");
+}
+
+static bool compilePipeline(
+	CompiledPipeline& pipeline,
+	const char* name,
+	const char* vertexPath,
+	const char* pixelPath) noexcept
+{
+	pipeline.name = name;
+
+	pipeline.vertexSpirv = readBinaryFile(vertexPath);
+	if (pipeline.vertexSpirv.size() == 0) {
+		ZG_ERROR("%s: Could not read vertex shader \"%s\"", name, vertexPath);
+		return false;
+	}
+	pipeline.pixelSpirv = readBinaryFile(pixelPath);
+	if (pipeline.pixelSpirv.size() == 0) {
+		ZG_ERROR("%s: Could not read pixel shader \"%s\"", name, pixelPath);
+		return false;
+	}
+
+	ZgResult reflectRes = reflectSpirvPipelineRender(
+		pipeline.reflection,
+		pipeline.vertexSpirv.data(),
+		pipeline.vertexSpirv.size(),
+		pipeline.pixelSpirv.data(),
+		pipeline.pixelSpirv.size());
+	if (reflectRes != ZG_SUCCESS) {
+		ZG_ERROR("%s: Could not reflect SPIR-V", name);
+		return false;
+	}
+
+	spvc_context context = nullptr;
+	if (CHECK_SPIRV_CROSS(nullptr) spvc_context_create(&context) != SPVC_SUCCESS) return false;
+
+	// Specialization constants keep the default values from the SPIR-V
+	uint32_t pushConstantRegister = pipeline.reflection.pushConstantRegister;
+	pipeline.vertexHlsl = crossCompileSpirvToHLSL(context, pipeline.vertexSpirv.data(),
+		pipeline.vertexSpirv.size(), pushConstantRegister, nullptr, 0);
+	pipeline.pixelHlsl = crossCompileSpirvToHLSL(context, pipeline.pixelSpirv.data(),
+		pipeline.pixelSpirv.size(), pushConstantRegister, nullptr, 0);
+	pipeline.vertexMsl = crossCompileSpirvToMSL(context,
+		pipeline.vertexSpirv.data(), pipeline.vertexSpirv.size());
+	pipeline.pixelMsl = crossCompileSpirvToMSL(context,
+		pipeline.pixelSpirv.data(), pipeline.pixelSpirv.size());
+
+	spvc_context_destroy(context);
+
+	bool success =
+		pipeline.vertexHlsl.size() != 0 &&
+		pipeline.pixelHlsl.size() != 0 &&
+		pipeline.vertexMsl.size() != 0 &&
+		pipeline.pixelMsl.size() != 0;
+	if (!success) ZG_ERROR("%s: Could not cross-compile SPIR-V", name);
+	return success;
+}
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) noexcept
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static Vector<uint8_t> buildArchive(const Vector<CompiledPipeline>& pipelines) noexcept
+{
+	const uint32_t numEntries = pipelines.size();
+
+	// Keep the hash table at most half full so probe sequences stay short
+	uint32_t numSlots = 1;
+	while (numSlots < numEntries * 2) numSlots *= 2;
+	if (numSlots == numEntries) numSlots *= 2;
+
+	// Calculate blob sizes, text blobs include their null-terminator (which the cross-compiled
+	// sources have right after their last element)
+	auto blobSizes = [](const CompiledPipeline& pipeline, uint64_t* sizesOut) {
+		sizesOut[uint32_t(ShaderArchiveBlobType::NAME)] = std::strlen(pipeline.name) + 1;
+		sizesOut[uint32_t(ShaderArchiveBlobType::REFLECTION)] = sizeof(SpirvPipelineReflection);
+		sizesOut[uint32_t(ShaderArchiveBlobType::VERTEX_SPIRV)] = pipeline.vertexSpirv.size();
+		sizesOut[uint32_t(ShaderArchiveBlobType::PIXEL_SPIRV)] = pipeline.pixelSpirv.size();
+		sizesOut[uint32_t(ShaderArchiveBlobType::VERTEX_HLSL)] = pipeline.vertexHlsl.size() + 1;
+		sizesOut[uint32_t(ShaderArchiveBlobType::PIXEL_HLSL)] = pipeline.pixelHlsl.size() + 1;
+		sizesOut[uint32_t(ShaderArchiveBlobType::VERTEX_MSL)] = pipeline.vertexMsl.size() + 1;
+		sizesOut[uint32_t(ShaderArchiveBlobType::PIXEL_MSL)] = pipeline.pixelMsl.size() + 1;
+	};
+	auto blobData = [](const CompiledPipeline& pipeline, const void** dataOut) {
+		dataOut[uint32_t(ShaderArchiveBlobType::NAME)] = pipeline.name;
+		dataOut[uint32_t(ShaderArchiveBlobType::REFLECTION)] = &pipeline.reflection;
+		dataOut[uint32_t(ShaderArchiveBlobType::VERTEX_SPIRV)] = pipeline.vertexSpirv.data();
+		dataOut[uint32_t(ShaderArchiveBlobType::PIXEL_SPIRV)] = pipeline.pixelSpirv.data();
+		dataOut[uint32_t(ShaderArchiveBlobType::VERTEX_HLSL)] = pipeline.vertexHlsl.data();
+		dataOut[uint32_t(ShaderArchiveBlobType::PIXEL_HLSL)] = pipeline.pixelHlsl.data();
+		dataOut[uint32_t(ShaderArchiveBlobType::VERTEX_MSL)] = pipeline.vertexMsl.data();
+		dataOut[uint32_t(ShaderArchiveBlobType::PIXEL_MSL)] = pipeline.pixelMsl.data();
+	};
+	constexpr uint32_t NUM_BLOB_TYPES = uint32_t(ShaderArchiveBlobType::COUNT);
+
+	// Calculate layout
+	uint64_t slotsOffset = sizeof(ShaderArchiveHeader);
+	uint64_t entriesOffset = slotsOffset + uint64_t(numSlots) * sizeof(ShaderArchiveSlot);
+	uint64_t blobsOffset = alignUp(
+		entriesOffset + uint64_t(numEntries) * sizeof(ShaderArchiveEntry),
+		SHADER_ARCHIVE_BLOB_ALIGNMENT);
+	uint64_t fileSizeBytes = blobsOffset;
+	for (uint32_t i = 0; i < numEntries; i++) {
+		uint64_t sizes[NUM_BLOB_TYPES] = {};
+		blobSizes(pipelines[i], sizes);
+		for (uint32_t j = 0; j < NUM_BLOB_TYPES; j++) {
+			fileSizeBytes = alignUp(fileSizeBytes + sizes[j], SHADER_ARCHIVE_BLOB_ALIGNMENT);
+		}
+	}
+
+	Vector<uint8_t> archive;
+	if (fileSizeBytes > UINT32_MAX) {
+		ZG_ERROR("Shader archive would be %llu bytes, which is too large",
+			(unsigned long long)fileSizeBytes);
+		return archive;
+	}
+	if (!archive.create(uint32_t(fileSizeBytes), "Shader archive")) return archive;
+	archive.addMany(uint32_t(fileSizeBytes));
+	std::memset(archive.data(), 0, fileSizeBytes);
+
+	// Header
+	ShaderArchiveHeader& header = *reinterpret_cast<ShaderArchiveHeader*>(archive.data());
+	header.magic = SHADER_ARCHIVE_MAGIC;
+	header.version = SHADER_ARCHIVE_VERSION;
+	header.numEntries = numEntries;
+	header.numSlots = numSlots;
+	header.reflectionSizeBytes = sizeof(SpirvPipelineReflection);
+	header.fileSizeBytes = fileSizeBytes;
+	header.slotsOffset = slotsOffset;
+	header.entriesOffset = entriesOffset;
+
+	ShaderArchiveSlot* slots =
+		reinterpret_cast<ShaderArchiveSlot*>(archive.data() + slotsOffset);
+	ShaderArchiveEntry* entries =
+		reinterpret_cast<ShaderArchiveEntry*>(archive.data() + entriesOffset);
+	for (uint32_t i = 0; i < numSlots; i++) {
+		slots[i].entryIdx = SHADER_ARCHIVE_EMPTY_SLOT;
+	}
+
+	// Entries and blobs
+	uint64_t blobOffset = blobsOffset;
+	for (uint32_t i = 0; i < numEntries; i++) {
+		ShaderArchiveEntry& entry = entries[i];
+		entry.nameHash = shaderArchiveNameHash(pipelines[i].name);
+
+		uint64_t sizes[NUM_BLOB_TYPES] = {};
+		const void* data[NUM_BLOB_TYPES] = {};
+		blobSizes(pipelines[i], sizes);
+		blobData(pipelines[i], data);
+		for (uint32_t j = 0; j < NUM_BLOB_TYPES; j++) {
+			entry.blobs[j].offset = blobOffset;
+			entry.blobs[j].sizeBytes = sizes[j];
+			std::memcpy(archive.data() + blobOffset, data[j], sizes[j]);
+			blobOffset = alignUp(blobOffset + sizes[j], SHADER_ARCHIVE_BLOB_ALIGNMENT);
+		}
+
+		// Insert into hash table, probing linearly from the home slot
+		uint32_t mask = numSlots - 1;
+		uint32_t slotIdx = uint32_t(entry.nameHash) & mask;
+		while (slots[slotIdx].entryIdx != SHADER_ARCHIVE_EMPTY_SLOT) {
+			slotIdx = (slotIdx + 1) & mask;
+		}
+		slots[slotIdx].nameHash = entry.nameHash;
+		slots[slotIdx].entryIdx = i;
+	}
+
+	return archive;
+}
+
+static bool writeArchive(const char* path, const Vector<uint8_t>& archive) noexcept
+{
+	// Write to a temporary file first and then rename it, so that a failed build never leaves a
+	// partially written archive behind that looks up to date.
+	namespace fs = std::filesystem;
+	std::error_code ec;
+	fs::path tmpPath = fs::path(path);
+	tmpPath += ".tmp";
+	if (tmpPath.has_parent_path()) fs::create_directories(tmpPath.parent_path(), ec);
+
+	std::FILE* file = std::fopen(tmpPath.string().c_str(), "wb");
+	if (file == nullptr) {
+		ZG_ERROR("Could not open \"%s\" for writing", tmpPath.string().c_str());
+		return false;
+	}
+	bool success = std::fwrite(archive.data(), archive.size(), 1, file) == 1;
+	success = std::fclose(file) == 0 && success;
+	if (success) fs::rename(tmpPath, fs::path(path), ec);
+	if (!success || ec) {
+		ZG_ERROR("Could not write shader archive \"%s\"", path);
+		fs::remove(tmpPath, ec);
+		return false;
+	}
+	return true;
+}
+
+// Main
+// ------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+	if (argc < 5 || ((argc - 2) % 3) != 0) {
+		printUsage();
+		return 1;
+	}
+	const char* archivePath = argv[1];
+	const uint32_t numPipelines = uint32_t(argc - 2) / 3;
+
+	// The ZeroG internals used require a context with an allocator and a logger
+	ZgContext context = {};
+	context.allocator = getDefaultAllocator();
+	context.logger = getDefaultLogger();
+	setContext(context);
+
+	// Check that names are unique, otherwise all but one entry would be unreachable
+	for (uint32_t i = 0; i < numPipelines; i++) {
+		for (uint32_t j = i + 1; j < numPipelines; j++) {
+			if (std::strcmp(argv[2 + i * 3], argv[2 + j * 3]) == 0) {
+				ZG_ERROR("Pipeline name \"%s\" is used more than once", argv[2 + i * 3]);
+				return 1;
+			}
+		}
+	}
+
+	// Compile pipelines
+	Vector<CompiledPipeline> pipelines;
+	pipelines.create(numPipelines, "Compiled pipelines");
+	pipelines.addMany(numPipelines);
+	for (uint32_t i = 0; i < numPipelines; i++) {
+		const char* const* args = argv + 2 + i * 3;
+		if (!compilePipeline(pipelines[i], args[0], args[1], args[2])) return 1;
+	}
+
+	// Build archive and verify that all pipelines can be found in it before writing it
+	Vector<uint8_t> archive = buildArchive(pipelines);
+	if (archive.size() == 0) return 1;
+	if (validateShaderArchive(archive.data(), archive.size()) != ZG_SUCCESS) return 1;
+	for (uint32_t i = 0; i < numPipelines; i++) {
+		if (findShaderArchiveEntry(archive.data(), pipelines[i].name) == nullptr) {
+			ZG_ERROR("%s: Not found in built archive", pipelines[i].name);
+			return 1;
+		}
+	}
+	if (!writeArchive(archivePath, archive)) return 1;
+
+	std::printf("ZeroG-ShaderCompiler: Wrote %u pipelines (%u bytes) to \"%s\"\n",
+		numPipelines, archive.size(), archivePath);
+	return 0;
+}
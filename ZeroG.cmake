@@ -35,6 +35,13 @@
 # And link ZeroG to a CMake target with:
 #
 #     linkZeroG(<target>)
+#
+# SPIR-V shaders can be precompiled into a shader archive at build time with the offline shader
+# compiler:
+#
+#     addZeroGShaderCompiler()
+#     zgCompileShaderArchive(<target> <archive path>
+#         PIPELINES <name> <vertex.spv> <pixel.spv> [<name> <vertex.spv> <pixel.spv> ...])
 
 # Misc initialization
 # ------------------------------------------------------------------------------------------------
@@ -100,6 +107,70 @@ function(linkZeroGcpp linkTarget)
 	target_link_libraries(${linkTarget} ${ZEROG_CPP_LIBRARIES})
 endfunction()
 
+# ZeroG-ShaderCompiler
+# ------------------------------------------------------------------------------------------------
+
+function(addZeroGShaderCompiler)
+	if (NOT ZEROG_FOUND)
+		message(FATAL_ERROR "-- [ZeroG]: Attempting to addZeroGShaderCompiler(), but ZeroG is not found")
+	endif()
+	message("-- [ZeroG]: Adding ZeroG-ShaderCompiler target")
+
+	add_subdirectory(
+		${ZEROG_REPO_ROOT}/Tool-ZeroG-ShaderCompiler
+		${CMAKE_BINARY_DIR}/Tool-ZeroG-ShaderCompiler
+	)
+
+	set(ZEROG_SHADER_COMPILER_FOUND ${ZEROG_SHADER_COMPILER_FOUND} PARENT_SCOPE)
+endfunction()
+
+# Compiles the specified SPIR-V pipelines into a shader archive when building the target. The
+# archive is only rebuilt if any of the SPIR-V files (or the shader compiler) changes, and any
+# shader that fails to reflect or cross-compile fails the build.
+function(zgCompileShaderArchive target archivePath)
+	if (NOT ZEROG_SHADER_COMPILER_FOUND)
+		message(FATAL_ERROR "-- [ZeroG]: Attempting to zgCompileShaderArchive(), but ZeroG-ShaderCompiler is not found")
+	endif()
+
+	cmake_parse_arguments(ARCHIVE "" "" "PIPELINES" ${ARGN})
+	list(LENGTH ARCHIVE_PIPELINES numArgs)
+	math(EXPR numArgsMod3 "${numArgs} % 3")
+	if (numArgs EQUAL 0 OR NOT numArgsMod3 EQUAL 0)
+		message(FATAL_ERROR "-- [ZeroG]: zgCompileShaderArchive() expects PIPELINES <name> <vertex.spv> <pixel.spv> ...")
+	endif()
+
+	# Relative SPIR-V paths are relative to the current source directory and relative archive
+	# paths to the current binary directory, same as for other CMake inputs and outputs
+	get_filename_component(archivePath ${archivePath} ABSOLUTE BASE_DIR ${CMAKE_CURRENT_BINARY_DIR})
+	set(compilerArgs)
+	set(spirvFiles)
+	set(idx 0)
+	foreach(arg ${ARCHIVE_PIPELINES})
+		math(EXPR argType "${idx} % 3")
+		if (argType EQUAL 0)
+			list(APPEND compilerArgs ${arg})
+		else()
+			get_filename_component(spirvPath ${arg} ABSOLUTE BASE_DIR ${CMAKE_CURRENT_SOURCE_DIR})
+			list(APPEND compilerArgs ${spirvPath})
+			list(APPEND spirvFiles ${spirvPath})
+		endif()
+		math(EXPR idx "${idx} + 1")
+	endforeach()
+
+	get_filename_component(archiveName ${archivePath} NAME)
+	message("-- [ZeroG]: Compiling shader archive ${archiveName} for target: ${target}")
+
+	add_custom_command(
+		OUTPUT ${archivePath}
+		COMMAND ZeroG-ShaderCompiler ${archivePath} ${compilerArgs}
+		DEPENDS ZeroG-ShaderCompiler ${spirvFiles}
+		COMMENT "[ZeroG]: Compiling shader archive ${archiveName}"
+		VERBATIM
+	)
+	add_custom_target(${target}-ShaderArchive-${archiveName} DEPENDS ${archivePath})
+	add_dependencies(${target} ${target}-ShaderArchive-${archiveName})
+endfunction()
+
 # Misc helper functions
 # ------------------------------------------------------------------------------------------------
 